@@ -55,6 +55,13 @@
   #include <ctype.h>
 #endif /* HAVE_CTYPE_H */
 
+#ifdef HAVE_SYS_MMAN_H
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif /* HAVE_SYS_MMAN_H */
+
 #include <bltAlloc.h>
 #include "bltMath.h"
 #include <bltHash.h>
@@ -63,6 +70,7 @@
 #include <bltArrayObj.h>
 #include <bltTags.h>
 #include <bltDataTable.h>
+#include "bltVecInt.h"
 
 /*
  * Row and Column Information Structures
@@ -132,16 +140,24 @@
 #define TABLE_THREAD_KEY                "BLT DataTable Data"
 #define TABLE_MAGIC                     ((unsigned int) 0xfaceface)
 #define TABLE_DESTROYED                 (1<<0)
+#define TABLE_READONLY                  (1<<1)  /* Table is a snapshot. */
 
 #define TABLE_ALLOC_MAX_DOUBLE_SIZE     (1<<16)
 #define TABLE_ALLOC_MAX_CHUNK           (1<<16)
 #define TABLE_ALLOC_INIT_SIZE           (32)
 
+/* Minimum # of rows given to each worker thread. Below this, starting a
+ * thread costs more than it saves. */
+#define TABLE_WORKER_MIN_ITEMS          (1<<14)
+#define TABLE_MAX_THREADS               64
+
 #define TABLE_KEYS_DIRTY                (1<<0)
 #define TABLE_KEYS_UNIQUE               (1<<1)
 
-/* Column flag. */
+/* Column flags. */
 #define TABLE_COLUMN_PRIMARY_KEY        (1<<0)
+#define TABLE_COLUMN_PACKED             (1<<1)
+#define TABLE_COLUMN_MAPPED             (1<<2)
 
 #define REINDEX                         (1<<21)
 
@@ -164,7 +180,7 @@ typedef struct _BLT_TABLE_TRACE Trace;
 typedef struct _BLT_TABLE_NOTIFIER Notifier;
 
 static const char *valueTypes[] = {
-    "string", "double", "long", "time", "boolean", "blob", 
+    "string", "double", "long", "int64", "time", "boolean", "blob", 
 };
 
 /*
@@ -177,16 +193,16 @@ static const char *valueTypes[] = {
  *      and stored by clients of a table.  Tags can also be shared between
  *      clients of the same table.
  *      
- *      Both rowTable and columnTable are hash tables keyed by the physical
- *      row or column location in the table respectively.  This is not the
- *      same as the client's view (the order of rows or columns as seen by
- *      the client).  This is so that clients (which may have different
- *      views) can share tags without sharing the same view.
+ *      Row tags are bitmaps keyed by the physical row location (offset)
+ *      and column tags are hash tables keyed by the column location.  This
+ *      is not the same as the client's view (the order of rows or columns
+ *      as seen by the client).  This is so that clients (which may have
+ *      different views) can share tags without sharing the same view.
  */
 struct _BLT_TABLE_TAGS {
-    struct _Blt_Tags rowTags;           /* Table of row indices.  Each
-                                         * entry is itself a hash table of
-                                         * tag names. */
+    Blt_HashTable rowTagTable;          /* Table of row tags.  Each entry
+                                         * is a bitmap of the rows with
+                                         * the tag. */
     struct _Blt_Tags columnTags;        /* Table of column indices.  Each
                                          * entry is itself a hash table of
                                          * tag names. */
@@ -201,6 +217,10 @@ typedef struct {
     Blt_HashTable clientTable;          /* Tracks all table clients. */
     unsigned int nextId;
     Tcl_Interp *interp;
+    int numThreads;                     /* # of threads used to scan and
+                                         * sort large tables. */
+    Blt_HashTable bindingTable;         /* Maps vectors to the columns
+                                         * bound to them. */
 } InterpData;
 
 typedef struct _BLT_TABLE_ROW Row;
@@ -217,6 +237,26 @@ typedef struct {
 static Tcl_InterpDeleteProc TableInterpDeleteProc;
 static void DestroyClient(Table *tablePtr);
 static void NotifyClients(Table *tablePtr, BLT_TABLE_NOTIFY_EVENT *eventPtr);
+static void FreeBatch(Table *tablePtr);
+static void ForgetBatchItems(TableObject *corePtr, Row *rowPtr, 
+        Column *colPtr);
+static void ReleaseSnapshots(TableObject *corePtr);
+static void ResizePackedColumn(Column *colPtr, long newSize);
+static void ResizeEncodedColumn(Column *colPtr, size_t oldSize, 
+                                size_t newSize);
+typedef struct _BLT_TABLE_BINDING ColumnBinding;
+static void MarkBindingStale(ColumnBinding *bindPtr);
+static void FreeBinding(ColumnBinding *bindPtr);
+typedef struct _BLT_TABLE_STATS ColumnStats;
+static void StatsRemoveValue(Column *colPtr, Row *rowPtr);
+static void StatsAddValue(Column *colPtr, Row *rowPtr);
+static void FreeColumnStats(Column *colPtr);
+static void FreeRowOffsetMap(Rows *rowsPtr);
+static void UnshareColumn(Column *colPtr);
+static void UnshareLastChunk(Column *colPtr);
+static Value **ResizeChunks(Value **chunks, long oldSize, long newSize);
+static void SetValueString(Value *valuePtr, const char *s, int length);
+static uint64_t HashString(const char *string, int length);
 
 static void
 UnsetRowLabel(Rows *rowsPtr, Row *rowPtr)
@@ -227,20 +267,29 @@ UnsetRowLabel(Rows *rowsPtr, Row *rowPtr)
     hPtr = Blt_FindHashEntry(&rowsPtr->labelTable, rowPtr->label);
     assert(hPtr != NULL);
     if (hPtr != NULL) {
-        Blt_HashTable *tablePtr;
-        Blt_HashEntry *hPtr2;
+        Row *headPtr;
 
-        tablePtr = Blt_GetHashValue(hPtr);
-        hPtr2 = Blt_FindHashEntry(tablePtr, rowPtr);
-        if (hPtr2 != NULL) {
-            Blt_DeleteHashEntry(tablePtr, hPtr2);
-        }
-        if (tablePtr->numEntries == 0) {
-            Blt_DeleteHashEntry(&rowsPtr->labelTable, hPtr);
-            Blt_DeleteHashTable(tablePtr);
-            Blt_Free(tablePtr);
+        /* Unlink the row from the list of rows with the same label. */
+        headPtr = Blt_GetHashValue(hPtr);
+        if (headPtr == rowPtr) {
+            if (rowPtr->nextLabelPtr == NULL) {
+                Blt_DeleteHashEntry(&rowsPtr->labelTable, hPtr);
+            } else {
+                Blt_SetHashValue(hPtr, rowPtr->nextLabelPtr);
+            }
+        } else {
+            Row *prevPtr;
+
+            for (prevPtr = headPtr; prevPtr != NULL; 
+                 prevPtr = prevPtr->nextLabelPtr) {
+                if (prevPtr->nextLabelPtr == rowPtr) {
+                    prevPtr->nextLabelPtr = rowPtr->nextLabelPtr;
+                    break;
+                }
+            }
         }
     }   
+    rowPtr->nextLabelPtr = NULL;
     rowPtr->label = NULL;
 }
 
@@ -283,6 +332,8 @@ UnsetColumnLabel(Columns *columnsPtr, Column *colPtr)
  *      can't apriori change the labels.  We could add #n to make the label
  *      unique, but detecting and changing them is a pain.
  *      
+ *      Rows with the same label are linked together from the label's
+ *      hash entry, so there's no secondary table for each label.
  *
  * Results:
  *      Returns a pointer to the new object is successful, NULL otherwise.
@@ -294,8 +345,7 @@ UnsetColumnLabel(Columns *columnsPtr, Column *colPtr)
 static void
 SetRowLabel(Rows *rowsPtr, Row *rowPtr, const char *newLabel)
 {
-    Blt_HashEntry *hPtr, *hPtr2;
-    Blt_HashTable *tablePtr;            /* Secondary table. */
+    Blt_HashEntry *hPtr;
     int isNew;
 
     if (rowPtr->label != NULL) {
@@ -304,24 +354,19 @@ SetRowLabel(Rows *rowsPtr, Row *rowPtr, const char *newLabel)
     if (newLabel == NULL) {
         return;
     }
-    /* Check the primary label table for the bucket.  */
     hPtr = Blt_CreateHashEntry(&rowsPtr->labelTable, newLabel, &isNew);
     if (isNew) {
-        tablePtr = Blt_AssertMalloc(sizeof(Blt_HashTable));
-        Blt_InitHashTable(tablePtr, BLT_ONE_WORD_KEYS);
-        Blt_SetHashValue(hPtr, tablePtr);
+        Blt_SetHashValue(hPtr, rowPtr);
     } else {
-        tablePtr = Blt_GetHashValue(hPtr);
+        Row *headPtr;
+
+        /* Keep the first row with the label at the head of the list. */
+        headPtr = Blt_GetHashValue(hPtr);
+        rowPtr->nextLabelPtr = headPtr->nextLabelPtr;
+        headPtr->nextLabelPtr = rowPtr;
     }
     /* Save the label as the hash entry key.  */
     rowPtr->label = Blt_GetHashKey(&rowsPtr->labelTable, hPtr);
-    /* Now look for the row in the secondary table. */
-    hPtr2 = Blt_CreateHashEntry(tablePtr, rowPtr, &isNew);
-    if (!isNew) {
-        return;                         /* It's already there. */
-    }
-    /* Add it to the secondary table. */
-    Blt_SetHashValue(hPtr2, rowPtr);
 }
 
 
@@ -543,16 +588,22 @@ ExtendRows(Table *tablePtr, size_t numExtraRows, Blt_Chain chain)
         }
         rowsPtr->map = map;
         rowsPtr->numAllocated = newSize;
+        /* The offset map is rebuilt when it's next needed. */
+        FreeRowOffsetMap(rowsPtr);
 
         /* Resize the individual column vectors.  */
         for (colPtr = tablePtr->corePtr->columns.headPtr; colPtr != NULL;
              colPtr = colPtr->nextPtr) {
-            if (colPtr->vector != NULL) {
-                Value *vector;
-                
-                vector = Blt_Realloc(colPtr->vector, newSize * sizeof(Value));
-                memset(vector + oldSize, 0, (newSize-oldSize) * sizeof(Value));
-                colPtr->vector = vector;
+            UnshareLastChunk(colPtr);
+            if (colPtr->chunks != NULL) {
+                colPtr->chunks = ResizeChunks(colPtr->chunks, oldSize, 
+                        newSize);
+            }
+            if (colPtr->flags & TABLE_COLUMN_PACKED) {
+                ResizePackedColumn(colPtr, newSize);
+            }
+            if (colPtr->encodingPtr != NULL) {
+                ResizeEncodedColumn(colPtr, oldSize, newSize);
             }
         }        
     }
@@ -578,6 +629,9 @@ ExtendRows(Table *tablePtr, size_t numExtraRows, Blt_Chain chain)
         }
         rowsPtr->map[nextIndex] = rowPtr;
         rowPtr->offset = offset;
+        if (rowsPtr->offsetMap != NULL) {
+            rowsPtr->offsetMap[offset] = rowPtr;
+        }
     }
     return TRUE;
 }
@@ -809,6415 +863,14602 @@ IsEmptyValue(Value *valuePtr)
     return ((valuePtr == NULL) || (valuePtr->string == NULL));
 }
 
-static INLINE int
-IsEmpty(Row *rowPtr, Column *colPtr)
+/* 
+ * Chunked column storage.
+ *
+ *      The values of an unpacked column are kept in chunks of
+ *      TABLE_CHUNK_SIZE Value structures, found through a directory of
+ *      chunk pointers indexed by the high bits of the row offset.  Adding
+ *      rows only grows the directory and allocates new chunks, so the
+ *      values already in the column are never copied.  The last chunk is
+ *      only as long as the number of rows allocated, so that small tables
+ *      don't pay for a whole chunk.
+ */
+#define TABLE_CHUNK_SHIFT       16
+#define TABLE_CHUNK_SIZE        (1L << TABLE_CHUNK_SHIFT)
+#define TABLE_CHUNK_MASK        (TABLE_CHUNK_SIZE - 1)
+#define NumChunks(n)            (((n) + TABLE_CHUNK_MASK) >> TABLE_CHUNK_SHIFT)
+#define ChunkValue(chunks,o)    \
+    ((chunks)[(o) >> TABLE_CHUNK_SHIFT] + ((o) & TABLE_CHUNK_MASK))
+#define ColumnValue(c,o)        ChunkValue((c)->chunks, o)
+
+static INLINE long
+ChunkLength(long numValues, long i)
 {
-    if (colPtr->vector != NULL) {
-        Value *valuePtr;
+    long length;
 
-        valuePtr = colPtr->vector + rowPtr->offset;
-        return IsEmptyValue(valuePtr);
+    length = numValues - (i << TABLE_CHUNK_SHIFT);
+    return (length > TABLE_CHUNK_SIZE) ? TABLE_CHUNK_SIZE : length;
+}
+
+static Value **
+AllocChunks(long numValues)
+{
+    Value **chunks;
+    long i, numChunks;
+
+    numChunks = NumChunks(numValues);
+    chunks = Blt_AssertMalloc(numChunks * sizeof(Value *));
+    for (i = 0; i < numChunks; i++) {
+        chunks[i] = Blt_AssertCalloc(ChunkLength(numValues, i), 
+                sizeof(Value));
     }
-    return TRUE;
+    return chunks;
 }
 
-static INLINE void
-ResetValue(Value *valuePtr)
+static void
+FreeChunks(Value **chunks, long numValues)
 {
-    if ((valuePtr->string != NULL) &&
-        (valuePtr->string != TABLE_VALUE_STORE)) {
-        Blt_Free(valuePtr->string);
+    long i;
+
+    for (i = 0; i < NumChunks(numValues); i++) {
+        Blt_Free(chunks[i]);
     }
-    valuePtr->length = 0;
-    valuePtr->string = NULL;
+    Blt_Free(chunks);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ResizeChunks --
+ *
+ *      Grows the storage of a column from oldSize to newSize values.  A
+ *      partial last chunk is reallocated, up to the full chunk size.
+ *      Otherwise only new, empty chunks are added.
+ *
+ *---------------------------------------------------------------------------
+ */
+static Value **
+ResizeChunks(Value **chunks, long oldSize, long newSize)
+{
+    long i, oldNumChunks, newNumChunks;
+
+    oldNumChunks = NumChunks(oldSize);
+    newNumChunks = NumChunks(newSize);
+    chunks = Blt_AssertRealloc(chunks, newNumChunks * sizeof(Value *));
+    if (oldNumChunks > 0) {
+        long oldLength, newLength;
+
+        i = oldNumChunks - 1;
+        oldLength = ChunkLength(oldSize, i);
+        newLength = ChunkLength(newSize, i);
+        if (newLength > oldLength) {
+            chunks[i] = Blt_AssertRealloc(chunks[i], newLength*sizeof(Value));
+            memset(chunks[i] + oldLength, 0, 
+                   (newLength - oldLength) * sizeof(Value));
+        }
+    }
+    for (i = oldNumChunks; i < newNumChunks; i++) {
+        chunks[i] = Blt_AssertCalloc(ChunkLength(newSize, i), sizeof(Value));
+    }
+    return chunks;
+}
+
+/* 
+ * Packed columns.
+ *
+ *      Numeric columns (double, time, long, and int64) may be packed.  A
+ *      packed column keeps its values in chunks of TABLE_CHUNK_SIZE
+ *      doubles or 64-bit integers indexed by row offset, with a bitmap
+ *      per chunk of which row offsets have a value.  Like chunks of
+ *      Values, adding rows never moves the values already there.  The
+ *      column has no chunks of Value structures, so there is no string
+ *      representation stored.  Strings are generated from the numeric
+ *      value when they are needed.
+ *
+ *      Getting, setting, appending, and unsetting values, sorting, and
+ *      column limits work directly on the arrays.  The strings returned by
+ *      blt_table_get_string are formatted on demand and kept in the
+ *      column's packedStrings table, so that they stay good while the value
+ *      is unchanged.  Each string records the bits of the value it was
+ *      formatted from and is reformatted if they differ, so writes to the
+ *      arrays don't need to know about it.  blt_table_get_value formats
+ *      into the table's scratch value instead.  Only writers that store a
+ *      Value (see GetValue) and string comparisons unpack the column.
+ *      Indexed columns can't be packed.  Columns bound to a vector are
+ *      kept packed: they can't be unpacked, indexed, or change type, and
+ *      are packed again after they're compared as strings.
+ */
+#define PackedMapSize(n)        (((n) + 31) >> 5)
+#define PackedSlot(c,o)         \
+    ((c)->packed.d[(o) >> TABLE_CHUNK_SHIFT] + ((o) & TABLE_CHUNK_MASK))
+#define PackedDouble(c,o)       (*PackedSlot(c,o))
+#define PackedInt64(c,o)        \
+    ((c)->packed.i64[(o) >> TABLE_CHUNK_SHIFT][(o) & TABLE_CHUNK_MASK])
+#define PackedWord(c,o)         \
+    ((c)->validMap[(o) >> TABLE_CHUNK_SHIFT][((o) & TABLE_CHUNK_MASK) >> 5])
+#define PackedBit(o)            (1U << ((o) & 31))
+#define PackedExists(c,o)       (PackedWord(c,o) & PackedBit(o))
+#define PackedSetExists(c,o)    (PackedWord(c,o) |= PackedBit(o))
+#define PackedClearExists(c,o)  (PackedWord(c,o) &= ~PackedBit(o))
+#define IsPackedDouble(c)       (((c)->type == TABLE_COLUMN_TYPE_DOUBLE) || \
+                                 ((c)->type == TABLE_COLUMN_TYPE_TIME))
 
-static Value *
-GetValue(Table *tablePtr, Row *rowPtr, Column *colPtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PutPackedSlots --
+ *
+ *      Copies values into the packed column at consecutive row offsets,
+ *      a chunk at a time.  GetPackedSlots copies them back out.  Doubles
+ *      and 64-bit integers are the same size, so either may be copied.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+PutPackedSlots(Column *colPtr, long offset, const double *values, 
+               long numValues)
 {
-    if (colPtr->vector == NULL) {
-        Value *vector;
-        Rows *rowsPtr;
+    while (numValues > 0) {
+        long count;
 
-        rowsPtr = &tablePtr->corePtr->rows;
-        assert(rowsPtr->numAllocated > 0);
-        vector = Blt_Calloc(rowsPtr->numAllocated, sizeof(Value));
-        if (vector == NULL) {
-            return NULL;
+        count = TABLE_CHUNK_SIZE - (offset & TABLE_CHUNK_MASK);
+        if (count > numValues) {
+            count = numValues;
         }
-        colPtr->vector = vector;
+        memcpy(PackedSlot(colPtr, offset), values, count * sizeof(double));
+        values += count, offset += count, numValues -= count;
     }
-    return colPtr->vector + rowPtr->offset;
 }
 
-static Tcl_Obj *
-GetObjFromValue(BLT_TABLE_COLUMN_TYPE type, Value *valuePtr)
+static void
+GetPackedSlots(Column *colPtr, long offset, double *values, long numValues)
 {
-    Tcl_Obj *objPtr;
+    while (numValues > 0) {
+        long count;
 
-    assert(!IsEmptyValue(valuePtr));
-    objPtr = NULL;                      /* Suppress compiler warning. */
-    assert(type != TABLE_COLUMN_TYPE_UNKNOWN);
-    switch (type) {
-    case TABLE_COLUMN_TYPE_BLOB:
-        objPtr = Tcl_NewByteArrayObj(GetValueBytes(valuePtr),
-                                     GetValueLength(valuePtr));
-        break;
-    case TABLE_COLUMN_TYPE_TIME:        /* time */
-    case TABLE_COLUMN_TYPE_DOUBLE:      /* double */
-        objPtr = Tcl_NewDoubleObj(valuePtr->datum.d);
-        break;
-    case TABLE_COLUMN_TYPE_INT64:        /* long */
-        objPtr = Blt_NewInt64Obj(valuePtr->datum.i64);
-        break;
-    case TABLE_COLUMN_TYPE_LONG:        /* long */
-        objPtr = Blt_NewLongObj(valuePtr->datum.l);
-        break;
-    case TABLE_COLUMN_TYPE_BOOLEAN:      /* boolean */
-        objPtr = Tcl_NewBooleanObj((int)valuePtr->datum.i);
-        break;
-    default:
-    case TABLE_COLUMN_TYPE_STRING:      /* string */
-        objPtr = Tcl_NewStringObj(GetValueString(valuePtr),
-                                  GetValueLength(valuePtr));
-        break;
+        count = TABLE_CHUNK_SIZE - (offset & TABLE_CHUNK_MASK);
+        if (count > numValues) {
+            count = numValues;
+        }
+        memcpy(values, PackedSlot(colPtr, offset), count * sizeof(double));
+        values += count, offset += count, numValues -= count;
     }
-    return objPtr;
 }
 
-static int
-SetValueFromObj(Tcl_Interp *interp, BLT_TABLE_COLUMN_TYPE type, 
-                Tcl_Obj *objPtr, Value *valuePtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * CopyPackedChunks --
+ *
+ *      Gives the packed column its own copy of its chunks and bitmaps.
+ *      The old directories are left to the caller.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+CopyPackedChunks(Column *colPtr)
 {
-    int length;
-    const char *s;
+    double **chunks;
+    unsigned int **validMap;
+    long i, numChunks;
 
-    if (objPtr == NULL) {
-        return TCL_OK;
+    numChunks = NumChunks(colPtr->numPacked);
+    /* Doubles and 64-bit integers are the same size, so the double
+     * pointers are used for either. */
+    chunks = Blt_AssertMalloc(MAX(numChunks, 1) * sizeof(double *));
+    validMap = Blt_AssertMalloc(MAX(numChunks, 1) * sizeof(unsigned int *));
+    for (i = 0; i < numChunks; i++) {
+        long length;
+
+        length = ChunkLength(colPtr->numPacked, i);
+        chunks[i] = Blt_AssertMalloc(length * sizeof(double));
+        memcpy(chunks[i], colPtr->packed.d[i], length * sizeof(double));
+        validMap[i] = Blt_AssertMalloc(PackedMapSize(length) * 
+                sizeof(unsigned int));
+        memcpy(validMap[i], colPtr->validMap[i], 
+               PackedMapSize(length) * sizeof(unsigned int));
     }
-    ResetValue(valuePtr);
-    switch (type) {
-    case TABLE_COLUMN_TYPE_TIME:        /* time */
-        if (Blt_GetTimeFromObj(interp, objPtr, &valuePtr->datum.d) != TCL_OK) {
-            return TCL_ERROR;
-        }
-        break;
+    colPtr->packed.d = chunks;
+    colPtr->validMap = validMap;
+}
 
-    case TABLE_COLUMN_TYPE_BOOLEAN:     /* boolean */
-        { 
-            int i;
-            
-            if (Tcl_GetBooleanFromObj(interp, objPtr, &i) != TCL_OK) {
-                return TCL_ERROR;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FreePackedChunks --
+ *
+ *      Frees the chunks and bitmaps of the packed column.  Chunks that
+ *      point into a snapshot are released when the table is destroyed,
+ *      so only their directories are freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+FreePackedChunks(Column *colPtr)
+{
+    if (colPtr->packed.d != NULL) {
+        if ((colPtr->flags & TABLE_COLUMN_MAPPED) == 0) {
+            long i;
+
+            for (i = 0; i < NumChunks(colPtr->numPacked); i++) {
+                Blt_Free(colPtr->packed.d[i]);
+                Blt_Free(colPtr->validMap[i]);
             }
-            valuePtr->datum.i = i;
         }
-        break;
+        Blt_Free(colPtr->packed.d);
+        Blt_Free(colPtr->validMap);
+    }
+    colPtr->packed.d = NULL;
+    colPtr->validMap = NULL;
+    colPtr->numPacked = 0;
+    colPtr->flags &= ~TABLE_COLUMN_MAPPED;
+}
 
-    case TABLE_COLUMN_TYPE_DOUBLE:      /* double */
-        if (Blt_GetDoubleFromObj(interp, objPtr, &valuePtr->datum.d)!=TCL_OK) {
-            return TCL_ERROR;
-        }
-        break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ResizePackedColumn --
+ *
+ *      Grows the chunks of a packed column to hold the given number of
+ *      row offsets.  New slots are empty.  As with ResizeChunks, only a
+ *      partial last chunk is reallocated.  If the chunks point into a
+ *      snapshot, they are first copied into allocated memory.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ResizePackedColumn(Column *colPtr, long newSize)
+{
+    long i, oldSize, oldNumChunks, newNumChunks;
 
-    case TABLE_COLUMN_TYPE_INT64:        /* int64 */
-        if (Blt_GetInt64FromObj(interp, objPtr, &valuePtr->datum.i64)!=TCL_OK) {
-            return TCL_ERROR;
-        }
-        break;
+    if (colPtr->flags & TABLE_COLUMN_MAPPED) {
+        double **chunks;
+        unsigned int **validMap;
 
-    case TABLE_COLUMN_TYPE_LONG:        /* long */
-        if (Blt_GetLongFromObj(interp, objPtr, &valuePtr->datum.l) != TCL_OK) {
-            return TCL_ERROR;
-        }
-        break;
-    default:
-        break;
+        chunks = colPtr->packed.d;
+        validMap = colPtr->validMap;
+        CopyPackedChunks(colPtr);
+        Blt_Free(chunks);
+        Blt_Free(validMap);
+        colPtr->flags &= ~TABLE_COLUMN_MAPPED;
     }
-    s = Tcl_GetStringFromObj(objPtr, &length);
-    if (length >= TABLE_VALUE_LENGTH) {
-        valuePtr->string = Blt_Strndup(s, length);
-        valuePtr->length = length;
-    } else {
-        strncpy(valuePtr->store, s, length);
-        valuePtr->store[length] = '\0';
-        valuePtr->string = TABLE_VALUE_STORE;
-        valuePtr->length = length;
+    oldSize = colPtr->numPacked;
+    if (newSize <= oldSize) {
+        return;
     }
-    return TCL_OK;
+    oldNumChunks = NumChunks(oldSize);
+    newNumChunks = NumChunks(newSize);
+    colPtr->packed.d = Blt_AssertRealloc(colPtr->packed.d, 
+                newNumChunks * sizeof(double *));
+    colPtr->validMap = Blt_AssertRealloc(colPtr->validMap, 
+                newNumChunks * sizeof(unsigned int *));
+    if (oldNumChunks > 0) {
+        long oldLength, newLength, oldWords, newWords;
+
+        i = oldNumChunks - 1;
+        oldLength = ChunkLength(oldSize, i);
+        newLength = ChunkLength(newSize, i);
+        if (newLength > oldLength) {
+            colPtr->packed.d[i] = Blt_AssertRealloc(colPtr->packed.d[i], 
+                newLength * sizeof(double));
+            oldWords = PackedMapSize(oldLength);
+            newWords = PackedMapSize(newLength);
+            colPtr->validMap[i] = Blt_AssertRealloc(colPtr->validMap[i], 
+                newWords * sizeof(unsigned int));
+            memset(colPtr->validMap[i] + oldWords, 0, 
+                   (newWords - oldWords) * sizeof(unsigned int));
+        }
+    }
+    for (i = oldNumChunks; i < newNumChunks; i++) {
+        long length;
+
+        length = ChunkLength(newSize, i);
+        colPtr->packed.d[i] = Blt_AssertMalloc(length * sizeof(double));
+        colPtr->validMap[i] = Blt_AssertCalloc(PackedMapSize(length), 
+                sizeof(unsigned int));
+    }
+    colPtr->numPacked = newSize;
+}
+
+/* 
+ * Dictionary-encoded string columns.
+ *
+ *      A string column with few distinct values may be encoded.  Each
+ *      distinct string is kept once, in the column's dictionary, and is
+ *      given a code.  The column stores only the code of each row's value
+ *      in an array indexed by row offset.  Code 0 is an empty value.
+ *
+ *      Codes are assigned in the order strings are first seen.  To sort,
+ *      the dictionary computes the rank of each code for the comparison
+ *      used, and rows are radix sorted by rank.  The ranks are kept until
+ *      a new string is added.  Rows of the column are grouped and
+ *      compared for equality by code.  blt_table_get_value copies the
+ *      string into the table's scratch value.  Anything else that needs a
+ *      Value (see GetValue) first decodes the column.  Indexed columns
+ *      can't be encoded.
+ */
+typedef struct {
+    const char *string;                 /* The string, NUL terminated. */
+    unsigned int length;                /* # of bytes in string. */
+    unsigned int next;                  /* Code of the next string with
+                                         * the same hash. 0 if none. */
+    uint64_t hash;                      /* Hash of the string, used by
+                                         * joins and group-bys. */
+} EncodedString;
+
+typedef struct _BLT_TABLE_ENCODING {
+    unsigned int *codes;                /* Code of the value at each row
+                                         * offset.  0 if the value is
+                                         * empty. */
+    Blt_HashTable stringTable;          /* Maps the hashes of strings to
+                                         * the first code with that
+                                         * hash. */
+    EncodedString *strings;             /* Strings indexed by code.  The
+                                         * first entry is unused. */
+    unsigned int numStrings;            /* # of entries used in the
+                                         * strings array. */
+    unsigned int numAllocated;          /* Length of the strings array. */
+    unsigned int *ranks;                /* Sort rank of each code. NULL if
+                                         * not computed or stale. */
+    int rankType;                       /* Comparison (SortKeyType) the
+                                         * ranks were computed for. */
+} ColumnEncoding;
+
+#define EncodedCode(c,o)        ((c)->encodingPtr->codes[(o)])
+#define EncodedStringAt(c,o)    \
+    ((c)->encodingPtr->strings + EncodedCode(c,o))
+
+static INLINE int
+IsEmpty(Row *rowPtr, Column *colPtr)
+{
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        return !PackedExists(colPtr, rowPtr->offset);
+    }
+    if (colPtr->encodingPtr != NULL) {
+        return (EncodedCode(colPtr, rowPtr->offset) == 0);
+    }
+    if (colPtr->chunks != NULL) {
+        Value *valuePtr;
+
+        valuePtr = ColumnValue(colPtr, rowPtr->offset);
+        return IsEmptyValue(valuePtr);
+    }
+    return TRUE;
+}
+
+static INLINE void
+ResetValue(Value *valuePtr)
+{
+    if ((valuePtr->string != NULL) &&
+        (valuePtr->string != TABLE_VALUE_STORE)) {
+        Blt_Free(valuePtr->string);
+    }
+    valuePtr->length = 0;
+    valuePtr->string = NULL;
 }
 
+/* 
+ * Shared column storage.
+ *
+ *      A snapshot of a table (see blt_table_snapshot) is a new table with
+ *      the same rows, at the same row offsets, whose columns share the
+ *      chunks (of values or of packed values) of the table's columns.
+ *      Each column has its own directory of chunk pointers, so nothing is
+ *      copied until a value changes.  Before a value in a shared chunk is
+ *      changed, the column changing it takes its own copy of that chunk
+ *      alone.  The other columns keep the original.
+ *
+ *      The columns using a chunk share a count of them.  The last column
+ *      using a chunk owns it and may change it in place.  Rows added to
+ *      the table after a snapshot go into new chunks, except for those
+ *      filling out a partial last chunk, which is copied before it's
+ *      grown.
+ */
+typedef struct _BLT_TABLE_SHARE {
+    long numValues;                     /* # of row offsets in the shared
+                                         * chunks. */
+    long numChunks;                     /* # of chunks in the array
+                                         * below. */
+    int **refCounts;                    /* For each chunk, the # of columns
+                                         * using it, shared by those
+                                         * columns. NULL if the column has
+                                         * the chunk to itself. */
+} ColumnShare;
 
-static int
-SetValueFromString(Tcl_Interp *interp, BLT_TABLE_COLUMN_TYPE type, 
-                   const char *s, int length, Value *valuePtr)
+static void
+FreeShare(Column *colPtr)
 {
-    double d;
-    long l;
-    Tcl_Obj *objPtr;
+    ColumnShare *sharePtr;
 
-    if (length < 0) {
-        length = strlen(s);
+    sharePtr = colPtr->sharePtr;
+    colPtr->sharePtr = NULL;
+    Blt_Free(sharePtr->refCounts);
+    Blt_Free(sharePtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * UnshareChunk --
+ *
+ *      Gives the column its own copy of a chunk it shares.  If it's the
+ *      last column using the chunk, the chunk is simply kept.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+UnshareChunk(Column *colPtr, long i)
+{
+    ColumnShare *sharePtr;
+    int *countPtr;
+    long length;
+
+    sharePtr = colPtr->sharePtr;
+    countPtr = sharePtr->refCounts[i];
+    sharePtr->refCounts[i] = NULL;
+    (*countPtr)--;
+    if (*countPtr == 0) {
+        Blt_Free(countPtr);
+        return;
     }
-    objPtr = NULL;
-    if ((type != TABLE_COLUMN_TYPE_STRING) &&
-        (type != TABLE_COLUMN_TYPE_BLOB)) {
+    length = ChunkLength(sharePtr->numValues, i);
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        double *chunk;
+        unsigned int *validMap;
+
+        chunk = Blt_AssertMalloc(length * sizeof(double));
+        memcpy(chunk, colPtr->packed.d[i], length * sizeof(double));
+        validMap = Blt_AssertMalloc(PackedMapSize(length) * 
+                sizeof(unsigned int));
+        memcpy(validMap, colPtr->validMap[i], 
+               PackedMapSize(length) * sizeof(unsigned int));
+        colPtr->packed.d[i] = chunk;
+        colPtr->validMap[i] = validMap;
+    } else {
+        Value *chunk;
+        long j;
 
-        /* For the non-string types, make a copy of the string as a
-         * Tcl_Obj.  This will give us a canonical string representation
-         * and also verify that the string is valid.  */
-        objPtr = Tcl_NewStringObj(s, length);
-        Tcl_IncrRefCount(objPtr);
-        
-        switch (type) {
-        case TABLE_COLUMN_TYPE_TIME:    
-            if (Blt_GetTimeFromObj(interp, objPtr, &d) != TCL_OK) {
-                Tcl_DecrRefCount(objPtr);
-                return TCL_ERROR;
+        chunk = Blt_AssertMalloc(length * sizeof(Value));
+        memcpy(chunk, colPtr->chunks[i], length * sizeof(Value));
+        for (j = 0; j < length; j++) {
+            Value *valuePtr;
+
+            valuePtr = chunk + j;
+            if ((valuePtr->string != NULL) && 
+                (valuePtr->string != TABLE_VALUE_STORE)) {
+                char *bytes;
+
+                /* Blobs may hold null bytes. */
+                bytes = Blt_AssertMalloc(valuePtr->length + 1);
+                memcpy(bytes, valuePtr->string, valuePtr->length + 1);
+                valuePtr->string = bytes;
             }
-            valuePtr->datum.d = d;      /* double */
-            break;
-            
-        case TABLE_COLUMN_TYPE_DOUBLE:  
-            if (Blt_GetDoubleFromObj(interp, objPtr, &d) != TCL_OK) {
-                Tcl_DecrRefCount(objPtr);
-                return TCL_ERROR;
-            }
-            valuePtr->datum.d = d;      /* double */
-            break;
-
-        case TABLE_COLUMN_TYPE_LONG:    
-            if (Blt_GetLongFromObj(interp, objPtr, &l) != TCL_OK) {
-                Tcl_DecrRefCount(objPtr);
-                return TCL_ERROR;
-            }
-            valuePtr->datum.l = l;      /* long */
-            break;
-
-        case TABLE_COLUMN_TYPE_INT64:    
-            {
-                int64_t i;
-                
-                if (Blt_GetInt64FromObj(interp, objPtr, &i) != TCL_OK) {
-                    Tcl_DecrRefCount(objPtr);
-                    return TCL_ERROR;
-                }
-                valuePtr->datum.i64 = i;      /* long */
-            }
-            break;
-
-        case TABLE_COLUMN_TYPE_BOOLEAN: 
-            {
-                int ival;
-                
-                if (Tcl_GetBooleanFromObj(interp, objPtr, &ival) != TCL_OK) {
-                    Tcl_DecrRefCount(objPtr);
-                    return TCL_ERROR;
-                }
-                valuePtr->datum.i = ival; /* boolean */
-            }
-            break;
-        default:
-            break;
         }
-        s = Tcl_GetStringFromObj(objPtr, &length);
-    }        
-
-    ResetValue(valuePtr);
-    if (length >= TABLE_VALUE_LENGTH) {
-        valuePtr->string = Blt_Strndup(s, length);
-        valuePtr->length = length;
-    } else {
-        strncpy(valuePtr->store, s, length);
-        valuePtr->store[length] = '\0';
-        valuePtr->string = TABLE_VALUE_STORE;
-        valuePtr->length = length;
+        colPtr->chunks[i] = chunk;
     }
-    if (objPtr != NULL) {
-        Tcl_DecrRefCount(objPtr);
-    }
-    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * NewTableObject --
- *
- *      Creates and initializes a new table object. 
+ * UnshareColumn --
  *
- * Results:
- *      Returns a pointer to the new object is successful, NULL otherwise.
- *      If a table object can't be generated, interp->result will contain
- *      an error message.
+ *      Gives the column its own copy of every chunk it shares.  Used
+ *      before the column's storage is replaced as a whole.
  *
- * -------------------------------------------------------------------------- 
+ *---------------------------------------------------------------------------
  */
-static TableObject *
-NewTableObject(void)
+static void
+UnshareColumn(Column *colPtr)
 {
-    TableObject *corePtr;
+    ColumnShare *sharePtr;
+    long i;
 
-    corePtr = Blt_Calloc(1, sizeof(TableObject));
-    if (corePtr == NULL) {
-        return NULL;
+    sharePtr = colPtr->sharePtr;
+    if (sharePtr == NULL) {
+        return;
     }
-    corePtr->clients = Blt_Chain_Create();
-
-    Blt_InitHashTableWithPool(&corePtr->columns.labelTable, BLT_STRING_KEYS);
-    Blt_InitHashTableWithPool(&corePtr->rows.labelTable, BLT_STRING_KEYS);
-    corePtr->columns.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
-    corePtr->columns.nextColumnId = 1;
-    corePtr->rows.freeList = Blt_Chain_Create();
-    corePtr->rows.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
-    corePtr->rows.nextRowId = 1;
-    return corePtr;
+    for (i = 0; i < sharePtr->numChunks; i++) {
+        if (sharePtr->refCounts[i] != NULL) {
+            UnshareChunk(colPtr, i);
+        }
+    }
+    FreeShare(colPtr);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * UnshareLastChunk --
+ *
+ *      Called before the column's storage is grown.  A partial last chunk
+ *      is reallocated, so the column takes its own copy if it's shared.
+ *
+ *---------------------------------------------------------------------------
+ */
 static void
-DestroyTraces(Table *tablePtr)
+UnshareLastChunk(Column *colPtr)
 {
-    Blt_HashEntry *hPtr;
-    Blt_HashSearch iter;
-
-    for (hPtr = Blt_FirstHashEntry(&tablePtr->traces, &iter); hPtr != NULL; 
-         hPtr = Blt_NextHashEntry(&iter)) {
-        Trace *tracePtr;
+    ColumnShare *sharePtr;
+    long i;
 
-        tracePtr = Blt_GetHashValue(hPtr);
-        blt_table_delete_trace(tablePtr, tracePtr);
+    sharePtr = colPtr->sharePtr;
+    if (sharePtr == NULL) {
+        return;
+    }
+    i = sharePtr->numChunks - 1;
+    if ((i >= 0) && (sharePtr->refCounts[i] != NULL) &&
+        (ChunkLength(sharePtr->numValues, i) < TABLE_CHUNK_SIZE)) {
+        UnshareChunk(colPtr, i);
     }
-    Blt_Chain_Destroy(tablePtr->readTraces);
-    Blt_Chain_Destroy(tablePtr->writeTraces);
-    Blt_DeleteHashTable(&tablePtr->traces);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * DoTrace --
- *
- *      Fires a trace set by a client of the table object.  Trace
- *      procedures should return a standard TCL result.
- *
- *         TCL_OK       procedure executed successfully.
- *         TCL_ERROR    procedure failed.
- *         TCL_BREAK    don't execute any further trace procedures.
- *         TCL_CONTINUE treat like TCL_OK.
- *
- *      A trace procedure can in turn trigger more traces.  Traces are
- *      prohibited from recursively reentering their own trace procedures.
- *      A hash table in the trace structure tracks the cells currently
- *      actively traced.  If a cell is already being traced, the trace
- *      procedure is not called and TCL_OK is blindly returned.
- *
- * Results:
- *      Returns the result of trace procedure.  If the trace is already
- *      active, then TCL_OK is returned.
+ * LeaveShare --
  *
- * Side Effects:
- *      Traces on the table location may be fired.
+ *      Called before the column's storage is freed.  Chunks that other
+ *      columns still use are let go of without freeing them: their
+ *      pointers in the column's directory are set to NULL.  The rest are
+ *      left for the caller to free.
  *
  *---------------------------------------------------------------------------
  */
-static int
-DoTrace(Trace *tracePtr, BLT_TABLE_TRACE_EVENT *eventPtr)
+static void
+LeaveShare(Column *colPtr)
 {
-    int result;
+    ColumnShare *sharePtr;
+    long i;
 
-    /* 
-     * Check for individual traces on a cell.  Each trace has a hash table
-     * that tracks what cells are actively being traced. This is to prevent
-     * traces from triggering recursive callbacks.
-     */
-    Tcl_Preserve(tracePtr);
-    tracePtr->flags |= TABLE_TRACE_ACTIVE;
-    result = (*tracePtr->proc)(tracePtr->clientData, eventPtr);
-    tracePtr->flags &= ~TABLE_TRACE_ACTIVE;
-    Tcl_Release(tracePtr);
+    sharePtr = colPtr->sharePtr;
+    if (sharePtr == NULL) {
+        return;
+    }
+    for (i = 0; i < sharePtr->numChunks; i++) {
+        int *countPtr;
 
-    if (result == TCL_ERROR) {
-        Blt_Warn("error in trace callback: %s\n", 
-                 Tcl_GetString(Tcl_GetObjResult(eventPtr->interp)));
-        Tcl_BackgroundError(eventPtr->interp);
+        countPtr = sharePtr->refCounts[i];
+        if (countPtr == NULL) {
+            continue;
+        }
+        (*countPtr)--;
+        if (*countPtr == 0) {
+            Blt_Free(countPtr);
+            continue;
+        }
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            colPtr->packed.d[i] = NULL;
+            colPtr->validMap[i] = NULL;
+        } else if (colPtr->chunks != NULL) {
+            colPtr->chunks[i] = NULL;
+        }
     }
-    return result;
+    FreeShare(colPtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * TraceIdleProc --
+ * CopyOnWrite --
  *
- *      Used to invoke a table trace handler routines at some idle point.
- *      This routine is called from the TCL event loop.  Errors generated
- *      by the event handler routines are backgrounded.
- *      
- * Results:
- *      None.
+ *      Called before the value of the column at the row is changed.  If
+ *      the chunk holding the value is shared, the column first takes its
+ *      own copy of the chunk.
  *
  *---------------------------------------------------------------------------
  */
-static void
-TraceIdleProc(ClientData clientData)
+static INLINE void
+CopyChunkOnWrite(Column *colPtr, long i)
 {
-    Trace *tracePtr = clientData;
+    ColumnShare *sharePtr;
 
-    tracePtr->flags &= ~TABLE_TRACE_PENDING;
+    sharePtr = colPtr->sharePtr;
+    if ((sharePtr != NULL) && (i < sharePtr->numChunks) &&
+        (sharePtr->refCounts[i] != NULL)) {
+        UnshareChunk(colPtr, i);
+    }
+}
 
-    /* Protect the notifier in case it's deleted by the callback. */
-    Tcl_Preserve(tracePtr);
-    DoTrace(tracePtr, &tracePtr->event);
-    Tcl_Release(tracePtr);
+static INLINE void
+CopyOnWrite(Column *colPtr, Row *rowPtr)
+{
+    CopyChunkOnWrite(colPtr, rowPtr->offset >> TABLE_CHUNK_SHIFT);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * NotifyIdleProc --
+ * FreeColumnValues --
  *
- *      Used to invoke event handler routines at some idle point.  This
- *      routine is called from the TCL event loop.  Errors generated by the
- *      event handler routines are backgrounded.
- *      
- * Results:
- *      None.
+ *      Frees the values of an unpacked column and their chunks.  Chunks
+ *      still used by other columns were let go of by LeaveShare and are
+ *      skipped.
  *
  *---------------------------------------------------------------------------
  */
 static void
-NotifyIdleProc(ClientData clientData)
+FreeColumnValues(Rows *rowsPtr, Column *colPtr)
 {
-    Notifier *notifierPtr = clientData;
-    int result;
-
-    notifierPtr->flags &= ~TABLE_NOTIFY_PENDING;
+    Row *rowPtr;
 
-    /* Protect the notifier in case it's deleted by the callback. */
-    Tcl_Preserve(notifierPtr);
-    notifierPtr->flags |= TABLE_NOTIFY_ACTIVE;
-    result = (*notifierPtr->proc)(notifierPtr->clientData, &notifierPtr->event);
-    notifierPtr->flags &= ~TABLE_NOTIFY_ACTIVE;
-    if (result == TCL_ERROR) {
-        Tcl_BackgroundError(notifierPtr->interp);
+    if (colPtr->chunks == NULL) {
+        return;
     }
-    Tcl_Release(notifierPtr);
+    for (rowPtr = rowsPtr->headPtr; rowPtr != NULL; 
+         rowPtr = rowPtr->nextPtr) {
+        assert(rowPtr->offset < rowsPtr->numAllocated);
+        if (colPtr->chunks[rowPtr->offset >> TABLE_CHUNK_SHIFT] != NULL) {
+            ResetValue(ColumnValue(colPtr, rowPtr->offset));
+        }
+    }
+    FreeChunks(colPtr->chunks, rowsPtr->numAllocated);
+    colPtr->chunks = NULL;
 }
 
-static void
-FreeNotifier(Notifier *notifierPtr) 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * IsReadOnly --
+ *
+ *      Indicates if the table is a snapshot and so can't be modified.
+ *      If so, an error message is left in the interpreter.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+IsReadOnly(Tcl_Interp *interp, Table *tablePtr)
 {
-    if (notifierPtr->tag != NULL) {
-        Blt_Free(notifierPtr->tag);
+    if ((tablePtr->corePtr->flags & TABLE_READONLY) == 0) {
+        return FALSE;
     }
-    if (notifierPtr->link != NULL){
-        Blt_Chain_DeleteLink(notifierPtr->chain, notifierPtr->link);
+    if (interp != NULL) {
+        Tcl_AppendResult(interp, "table \"", tablePtr->name, 
+                "\" is a read-only snapshot", (char *)NULL);
     }
-    Blt_Free(notifierPtr);
+    return TRUE;
 }
 
-static void
-DestroyNotifiers(Table *tablePtr, Blt_Chain chain)
+static int
+IsPackableType(BLT_TABLE_COLUMN_TYPE type)
 {
-    Blt_ChainLink link;
-
-    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
-         link = Blt_Chain_NextLink(link)) {
-        Notifier *notifierPtr;
-
-        notifierPtr = Blt_Chain_GetValue(link);
-        notifierPtr->link = NULL;
-        blt_table_delete_notifier(tablePtr, notifierPtr);
+    switch (type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+    case TABLE_COLUMN_TYPE_LONG:
+    case TABLE_COLUMN_TYPE_INT64:
+        return TRUE;
+    default:
+        return FALSE;
     }
-    Blt_Chain_Destroy(chain);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FormatPackedSlot --
+ *
+ *      Fills in the value structure from a packed value of the given
+ *      type, generating its string representation.  The value must be
+ *      released with ResetValue.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+PrintPackedSlot(BLT_TABLE_COLUMN_TYPE type, const void *slotPtr, 
+                char *string)
+{
+    switch (type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+        Tcl_PrintDouble(NULL, *(const double *)slotPtr, string);
+        break;
+    case TABLE_COLUMN_TYPE_LONG:
+        sprintf(string, "%ld", (long)*(const int64_t *)slotPtr);
+        break;
+    default:
+    case TABLE_COLUMN_TYPE_INT64:
+        sprintf(string, "%" PRId64, *(const int64_t *)slotPtr);
+        break;
+    }
+    return strlen(string);
+}
 
 static void
-FreeRows(TableObject *corePtr)
+FormatPackedSlot(BLT_TABLE_COLUMN_TYPE type, const void *slotPtr, 
+                 Value *valuePtr)
 {
-    Blt_HashEntry *hPtr;
-    Blt_HashSearch iter;
-    Rows *rowsPtr;
+    char string[TCL_DOUBLE_SPACE + 1];
+    int length;
 
-    rowsPtr = &corePtr->rows;
-    for (hPtr = Blt_FirstHashEntry(&rowsPtr->labelTable, &iter); hPtr != NULL;
-         hPtr = Blt_NextHashEntry(&iter)) {
-        Blt_HashTable *tablePtr;
-        
-        tablePtr = Blt_GetHashValue(hPtr);
-        Blt_DeleteHashTable(tablePtr);
-        Blt_Free(tablePtr);
-    }
-    Blt_DeleteHashTable(&rowsPtr->labelTable);
-    Blt_Pool_Destroy(rowsPtr->pool);
-    if (rowsPtr->freeList != NULL) {
-        Blt_Chain_Destroy(rowsPtr->freeList);
+    switch (type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+        valuePtr->datum.d = *(const double *)slotPtr;
+        break;
+    case TABLE_COLUMN_TYPE_LONG:
+        valuePtr->datum.l = (long)*(const int64_t *)slotPtr;
+        break;
+    default:
+    case TABLE_COLUMN_TYPE_INT64:
+        valuePtr->datum.i64 = *(const int64_t *)slotPtr;
+        break;
     }
-    if (rowsPtr->map != NULL) {
-        Blt_Free(rowsPtr->map);
-        rowsPtr->map = NULL;
+    length = PrintPackedSlot(type, slotPtr, string);
+    if (length >= TABLE_VALUE_LENGTH) {
+        valuePtr->string = Blt_AssertStrdup(string);
+    } else {
+        strcpy(valuePtr->store, string);
+        valuePtr->string = TABLE_VALUE_STORE;
     }
-    rowsPtr->numAllocated = rowsPtr->numUsed = 0;
+    valuePtr->length = length;
 }
 
-static void
-FreeColumns(TableObject *corePtr)
+static INLINE void
+FormatPackedValue(Column *colPtr, long offset, Value *valuePtr)
 {
-    Blt_HashEntry *hPtr;
-    Blt_HashSearch iter;
-    Column *colPtr;
-    Columns *columnsPtr;
-
-    columnsPtr = &corePtr->columns;
-    for (colPtr = columnsPtr->headPtr; colPtr != NULL; 
-         colPtr = colPtr->nextPtr) {
-        if (colPtr->vector != NULL) {
-            Row *rowPtr;
-
-            for (rowPtr = corePtr->rows.headPtr; rowPtr != NULL;
-                 rowPtr = rowPtr->nextPtr) {
-                assert(rowPtr->offset < corePtr->rows.numAllocated);
-                ResetValue(colPtr->vector + rowPtr->offset);
-            }
-            Blt_Free(colPtr->vector);
-            colPtr->vector = NULL;
-        }
-    }
-    for (hPtr = Blt_FirstHashEntry(&columnsPtr->labelTable, &iter); 
-         hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
-        Blt_HashTable *tablePtr;
-        
-        tablePtr = Blt_GetHashValue(hPtr);
-        Blt_DeleteHashTable(tablePtr);
-        Blt_Free(tablePtr);
-    }
-    Blt_DeleteHashTable(&columnsPtr->labelTable);
-    if (columnsPtr->pool != NULL) {
-        Blt_Pool_Destroy(columnsPtr->pool);
-    }
-    if (columnsPtr->map != NULL) {
-        Blt_Free(columnsPtr->map);
-        columnsPtr->map = NULL;
-    }
-    columnsPtr->numAllocated = columnsPtr->numUsed = 0;
+    FormatPackedSlot(colPtr->type, PackedSlot(colPtr, offset), valuePtr);
 }
 
+typedef struct {
+    int64_t bits;                       /* Packed value the string was
+                                         * formatted from. */
+    char string[TCL_DOUBLE_SPACE + 1];
+} PackedString;
+
 /*
  *---------------------------------------------------------------------------
  *
- * DestroyTableObject --
- *
- *      Destroys the table object.  This is the final clean up of the
- *      object.  The object's entry is removed from the hash table of
- *      tables.
+ * GetPackedString --
  *
- * Results: 
- *      None.
+ *      Returns the string of the packed value at the given row offset,
+ *      formatting it if the value has changed since it was last asked for.
+ *      The string belongs to the column.
  *
- * -------------------------------------------------------------------------- 
+ *---------------------------------------------------------------------------
  */
+static const char *
+GetPackedString(Column *colPtr, long offset)
+{
+    Blt_HashEntry *hPtr;
+    PackedString *strPtr;
+    int isNew;
+
+    if (colPtr->packedStrings == NULL) {
+        colPtr->packedStrings = Blt_AssertMalloc(sizeof(Blt_HashTable));
+        Blt_InitHashTable(colPtr->packedStrings, BLT_ONE_WORD_KEYS);
+    }
+    hPtr = Blt_CreateHashEntry(colPtr->packedStrings, (char *)offset, &isNew);
+    if (isNew) {
+        strPtr = Blt_AssertMalloc(sizeof(PackedString));
+        Blt_SetHashValue(hPtr, strPtr);
+    } else {
+        strPtr = Blt_GetHashValue(hPtr);
+        if (strPtr->bits == PackedInt64(colPtr, offset)) {
+            return strPtr->string;
+        }
+    }
+    /* Both arrays are 8 bytes per slot, so compare the bits of either. */
+    strPtr->bits = PackedInt64(colPtr, offset);
+    PrintPackedSlot(colPtr->type, PackedSlot(colPtr, offset), 
+                    strPtr->string);
+    return strPtr->string;
+}
+
 static void
-DestroyTableObject(TableObject *corePtr)
+FreePackedStrings(Column *colPtr)
 {
-    corePtr->flags |= TABLE_DESTROYED;
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
 
-    assert(Blt_Chain_GetLength(corePtr->clients) == 0);
-    Blt_Chain_Destroy(corePtr->clients);
+    if (colPtr->packedStrings == NULL) {
+        return;
+    }
+    for (hPtr = Blt_FirstHashEntry(colPtr->packedStrings, &iter); 
+         hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+        Blt_Free(Blt_GetHashValue(hPtr));
+    }
+    Blt_DeleteHashTable(colPtr->packedStrings);
+    Blt_Free(colPtr->packedStrings);
+    colPtr->packedStrings = NULL;
+}
 
-    FreeColumns(corePtr);
-    FreeRows(corePtr);
-    Blt_Free(corePtr);
+static Tcl_Obj *
+GetObjFromPacked(Column *colPtr, long offset)
+{
+    switch (colPtr->type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+        return Tcl_NewDoubleObj(PackedDouble(colPtr, offset));
+    case TABLE_COLUMN_TYPE_LONG:
+        return Blt_NewLongObj((long)PackedInt64(colPtr, offset));
+    default:
+    case TABLE_COLUMN_TYPE_INT64:
+        return Blt_NewInt64Obj(PackedInt64(colPtr, offset));
+    }
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * TableInterpDeleteProc --
+ * SetPackedFromObj --
  *
- *      This is called when the interpreter hosting the table object is
- *      deleted from the interpreter.
+ *      Converts the object to the column's type and stores it in the
+ *      packed column at the row's offset.  
  *
  * Results:
- *      None.
- *
- * Side effects:
- *      Destroys all remaining tables and removes the hash table used to
- *      register table names.
+ *      A standard TCL result.  If the object can't be converted, the old
+ *      value is left unchanged.
  *
  *---------------------------------------------------------------------------
  */
-/* ARGSUSED */
-static void
-TableInterpDeleteProc(ClientData clientData, Tcl_Interp *interp)
+static int
+SetPackedFromObj(Tcl_Interp *interp, Column *colPtr, Row *rowPtr,
+                 Tcl_Obj *objPtr)
 {
-    InterpData *dataPtr;
-    Blt_HashEntry *hPtr;
-    Blt_HashSearch cursor;
-    
-    dataPtr = clientData;
-    for (hPtr = Blt_FirstHashEntry(&dataPtr->clientTable, &cursor);
-         hPtr != NULL; hPtr = Blt_NextHashEntry(&cursor)) {
-        Blt_Chain chain;
-        Blt_ChainLink link, next;
-
-        chain = Blt_GetHashValue(hPtr);
-        for (link = Blt_Chain_FirstLink(chain); link != NULL; link = next) {
-            Table *tablePtr;
+    double d;
+    long l;
+    int64_t i64;
 
-            next = Blt_Chain_NextLink(link);
-            tablePtr = Blt_Chain_GetValue(link);
-            tablePtr->link2 = NULL;
-            /* Don't destroy the client here. Let the client code close the
-             * table. */
+    if (objPtr == NULL) {
+        return TCL_OK;
+    }
+    d = 0.0, i64 = 0;
+    switch (colPtr->type) {
+    case TABLE_COLUMN_TYPE_TIME:
+        if (Blt_GetTimeFromObj(interp, objPtr, &d) != TCL_OK) {
+            return TCL_ERROR;
         }
-        Blt_Chain_Destroy(chain);
+        break;
+    case TABLE_COLUMN_TYPE_DOUBLE:
+        if (Blt_GetDoubleFromObj(interp, objPtr, &d) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        break;
+    case TABLE_COLUMN_TYPE_LONG:
+        if (Blt_GetLongFromObj(interp, objPtr, &l) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        i64 = l;
+        break;
+    default:
+    case TABLE_COLUMN_TYPE_INT64:
+        if (Blt_GetInt64FromObj(interp, objPtr, &i64) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        break;
     }
-    Blt_DeleteHashTable(&dataPtr->clientTable);
-    Tcl_DeleteAssocData(interp, TABLE_THREAD_KEY);
-    Blt_Free(dataPtr);
+    CopyOnWrite(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    if (IsPackedDouble(colPtr)) {
+        PackedDouble(colPtr, rowPtr->offset) = d;
+    } else {
+        PackedInt64(colPtr, rowPtr->offset) = i64;
+    }
+    PackedSetExists(colPtr, rowPtr->offset);
+    StatsAddValue(colPtr, rowPtr);
+    return TCL_OK;
+}
+
+static int
+SetPackedFromString(Tcl_Interp *interp, Column *colPtr, Row *rowPtr,
+                    const char *s, int length)
+{
+    Tcl_Obj *objPtr;
+    int result;
+
+    objPtr = Tcl_NewStringObj(s, length);
+    Tcl_IncrRefCount(objPtr);
+    result = SetPackedFromObj(interp, colPtr, rowPtr, objPtr);
+    Tcl_DecrRefCount(objPtr);
+    return result;
+}
+
+static void
+FreePackedColumn(Column *colPtr)
+{
+    LeaveShare(colPtr);
+    FreePackedStrings(colPtr);
+    if (colPtr->bindPtr != NULL) {
+        MarkBindingStale(colPtr->bindPtr);
+    }
+    FreePackedChunks(colPtr);
+    colPtr->flags &= ~TABLE_COLUMN_PACKED;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * GetInterpData --
+ * PackColumn --
  *
- *      Creates or retrieves data associated with tuple data objects for a
- *      particular interpreter.
+ *      Moves the values of a numeric column from its chunks of Value
+ *      structures into dense arrays.  
  *
  * Results:
- *      Returns a pointer to the tuple interpreter data.
+ *      A standard TCL result.  An error is returned if the column's type
+ *      can't be packed or the column is indexed.
  *
- * -------------------------------------------------------------------------- 
+ *---------------------------------------------------------------------------
  */
-static InterpData *
-GetInterpData(Tcl_Interp *interp)
+static int
+PackColumn(Tcl_Interp *interp, Table *tablePtr, Column *colPtr)
 {
-    Tcl_InterpDeleteProc *proc;
-    InterpData *dataPtr;
+    Row *rowPtr;
+    size_t numAllocated;
 
-    dataPtr = (InterpData *)
-        Tcl_GetAssocData(interp, TABLE_THREAD_KEY, &proc);
-    if (dataPtr == NULL) {
-        dataPtr = Blt_AssertMalloc(sizeof(InterpData));
-        dataPtr->interp = interp;
-        Tcl_SetAssocData(interp, TABLE_THREAD_KEY, TableInterpDeleteProc, 
-                dataPtr);
-        Blt_InitHashTable(&dataPtr->clientTable, BLT_STRING_KEYS);
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        return TCL_OK;                  /* Already packed. */
     }
-    return dataPtr;
-}
-
+    if (!IsPackableType(colPtr->type)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't pack column \"", colPtr->label,
+                "\": type \"", blt_table_column_type_to_name(colPtr->type),
+                "\" isn't numeric", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (colPtr->indexPtr != NULL) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't pack column \"", colPtr->label,
+                "\": column is indexed", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    /* The values are moved out of the chunks, so it can't be shared. */
+    UnshareColumn(colPtr);
+    numAllocated = NumRowsAllocated(tablePtr);
+    ResizePackedColumn(colPtr, (numAllocated > 0) ? numAllocated : 1);
+    if (colPtr->chunks != NULL) {
+        for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL;
+             rowPtr = rowPtr->nextPtr) {
+            Value *valuePtr;
 
-const char *
-blt_table_column_type_to_name(BLT_TABLE_COLUMN_TYPE type)
-{
-    return valueTypes[type];
+            valuePtr = ColumnValue(colPtr, rowPtr->offset);
+            if (IsEmptyValue(valuePtr)) {
+                continue;
+            }
+            switch (colPtr->type) {
+            case TABLE_COLUMN_TYPE_DOUBLE:
+            case TABLE_COLUMN_TYPE_TIME:
+                PackedDouble(colPtr, rowPtr->offset) = valuePtr->datum.d;
+                break;
+            case TABLE_COLUMN_TYPE_LONG:
+                PackedInt64(colPtr, rowPtr->offset) = valuePtr->datum.l;
+                break;
+            default:
+                PackedInt64(colPtr, rowPtr->offset) = valuePtr->datum.i64;
+                break;
+            }
+            PackedSetExists(colPtr, rowPtr->offset);
+            ResetValue(valuePtr);
+        }
+        FreeChunks(colPtr->chunks, numAllocated);
+        colPtr->chunks = NULL;
+    }
+    colPtr->flags |= TABLE_COLUMN_PACKED;
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * NewTags --
+ * UnpackColumn --
+ *
+ *      Moves the values of a packed column back into chunks of Value
+ *      structures, generating the string representation of each value.
  *
  *---------------------------------------------------------------------------
  */
-static BLT_TABLE_TAGS
-NewTags(void)
+static void
+UnpackColumn(Table *tablePtr, Column *colPtr)
 {
-    Tags *tagsPtr;
+    Row *rowPtr;
 
-    tagsPtr = Blt_Malloc(sizeof(Tags));
-    if (tagsPtr != NULL) {
-        Blt_Tags_Init(&tagsPtr->rowTags);
-        Blt_Tags_Init(&tagsPtr->columnTags);
-        tagsPtr->refCount = 1;
+    if ((colPtr->flags & TABLE_COLUMN_PACKED) == 0) {
+        return;
     }
-    return tagsPtr;
-}
-
-static void
-InitTags(Table *tablePtr)
-{
-    tablePtr->tags = NewTags();
-    tablePtr->rowTags = &tablePtr->tags->rowTags;
-    tablePtr->columnTags = &tablePtr->tags->columnTags;
+    assert(colPtr->chunks == NULL);
+    if (NumRowsAllocated(tablePtr) > 0) {
+        colPtr->chunks = AllocChunks(NumRowsAllocated(tablePtr));
+        for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL;
+             rowPtr = rowPtr->nextPtr) {
+            if (PackedExists(colPtr, rowPtr->offset)) {
+                FormatPackedValue(colPtr, rowPtr->offset, 
+                                  ColumnValue(colPtr, rowPtr->offset));
+            }
+        }
+    }
+    FreePackedColumn(colPtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ShareTags --
+ * RepackBoundColumn --
+ *
+ *      Packs a column bound to a vector again, after it was unpacked to
+ *      compare its values as strings.  The vector is a view of the packed
+ *      values, so bound columns are always kept packed.
  *
  *---------------------------------------------------------------------------
  */
 static void
-ShareTags(Table *srcPtr, Table *destPtr)
+RepackBoundColumn(Table *tablePtr, Column *colPtr)
 {
-    srcPtr->tags->refCount++;
-    if (destPtr->tags != NULL) {
-        blt_table_release_tags(destPtr);
+    if ((colPtr->bindPtr != NULL) && 
+        ((colPtr->flags & TABLE_COLUMN_PACKED) == 0)) {
+        PackColumn(NULL, tablePtr, colPtr);
     }
-    destPtr->tags = srcPtr->tags;
-    destPtr->rowTags = &destPtr->tags->rowTags;
-    destPtr->columnTags = &destPtr->tags->columnTags;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * FindClientInNamespace --
- *
- *      Searches for a table client in a given namespace.
- *
- * Results:
- *      Returns a pointer to the table client if found, otherwise NULL.
- *
- *---------------------------------------------------------------------------
- */
-static Table *
-FindClientInNamespace(InterpData *dataPtr, Blt_ObjectName *namePtr)
+static int
+IsBoundColumn(Tcl_Interp *interp, Column *colPtr, const char *what)
 {
-    Blt_HashEntry *hPtr;
-    Tcl_DString ds;
-    const char *qualName;
+    if (colPtr->bindPtr == NULL) {
+        return FALSE;
+    }
+    if (interp != NULL) {
+        Tcl_AppendResult(interp, "can't ", what, " column \"", colPtr->label,
+                "\": column is bound to vector \"", 
+                blt_table_column_vector(colPtr), "\"", 
+                (char *)NULL);
+    }
+    return TRUE;
+}
 
-    qualName = Blt_MakeQualifiedName(namePtr, &ds);
-    hPtr = Blt_FindHashEntry(&dataPtr->clientTable, qualName);
-    Tcl_DStringFree(&ds);
-    if (hPtr != NULL) {
-        Blt_Chain chain;
-        Blt_ChainLink link;
+static ColumnEncoding *
+NewEncoding(long numAllocated)
+{
+    ColumnEncoding *encPtr;
 
-        chain = Blt_GetHashValue(hPtr);
-        link = Blt_Chain_FirstLink(chain);
-        if (link != NULL) {
-            return Blt_Chain_GetValue(link);
-        }
+    encPtr = Blt_AssertCalloc(1, sizeof(ColumnEncoding));
+    encPtr->codes = Blt_AssertCalloc(MAX(numAllocated, 1), 
+                                     sizeof(unsigned int));
+    Blt_InitHashTable(&encPtr->stringTable, BLT_ONE_WORD_KEYS);
+    encPtr->numAllocated = 16;
+    encPtr->strings = Blt_AssertCalloc(encPtr->numAllocated, 
+                                       sizeof(EncodedString));
+    encPtr->numStrings = 1;             /* Code 0 is the empty value. */
+    return encPtr;
+}
+
+static void
+FreeEncodedColumn(Column *colPtr)
+{
+    ColumnEncoding *encPtr;
+
+    unsigned int i;
+
+    encPtr = colPtr->encodingPtr;
+    if (encPtr == NULL) {
+        return;
     }
-    return NULL;
+    for (i = 1; i < encPtr->numStrings; i++) {
+        Blt_Free(encPtr->strings[i].string);
+    }
+    Blt_DeleteHashTable(&encPtr->stringTable);
+    if (encPtr->ranks != NULL) {
+        Blt_Free(encPtr->ranks);
+    }
+    Blt_Free(encPtr->strings);
+    Blt_Free(encPtr->codes);
+    Blt_Free(encPtr);
+    colPtr->encodingPtr = NULL;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * GetTable --
- *
- *      Searches for the table client associated by the name given.
+ * FindEncodedString --
  *
- * Results:
- *      Returns a pointer to the table client if found, otherwise NULL.
+ *      Returns the code of the string in the dictionary, or 0 if it's not
+ *      there.  The string doesn't need to be NUL terminated.
  *
  *---------------------------------------------------------------------------
  */
-static BLT_TABLE
-GetTable(InterpData *dataPtr, const char *name, unsigned int flags)
+static unsigned int
+FindEncodedString(ColumnEncoding *encPtr, const char *string, int length,
+                  uint64_t hash)
 {
-    Blt_ObjectName objName;
-    BLT_TABLE table;
-    Tcl_Interp *interp;
-
-    table = NULL;
-    interp = dataPtr->interp;
-    if (!Blt_ParseObjectName(interp, name, &objName, BLT_NO_DEFAULT_NS)) {
-        return NULL;
-    }
-    if (objName.nsPtr != NULL) { 
-        table = FindClientInNamespace(dataPtr, &objName);
-    } else { 
-        if (flags & NS_SEARCH_CURRENT) {
-            /* Look first in the current namespace. */
-            objName.nsPtr = Tcl_GetCurrentNamespace(interp);
-            table = FindClientInNamespace(dataPtr, &objName);
-        }
-        if ((table == NULL) && (flags & NS_SEARCH_GLOBAL)) {
-            objName.nsPtr = Tcl_GetGlobalNamespace(interp);
-            table = FindClientInNamespace(dataPtr, &objName);
-        }
-    }
-    return table;
-}
+    Blt_HashEntry *hPtr;
+    unsigned int code;
 
-static void
-DestroyClient(Table *tablePtr)
-{
-    if (tablePtr->magic != TABLE_MAGIC) {
-        Blt_Warn("invalid table object token %p\n", tablePtr);
-        return;
-    }
-    /* Remove any traces that were set by this client. */
-    DestroyTraces(tablePtr);
-    /* Also remove all event handlers created by this client. */
-    DestroyNotifiers(tablePtr, tablePtr->rowNotifiers);
-    DestroyNotifiers(tablePtr, tablePtr->columnNotifiers);
-    blt_table_unset_keys(tablePtr);
-    if (tablePtr->tags != NULL) {
-        blt_table_release_tags(tablePtr);
+    hPtr = Blt_FindHashEntry(&encPtr->stringTable, (char *)(uintptr_t)hash);
+    if (hPtr == NULL) {
+        return 0;
     }
-    if ((tablePtr->corePtr != NULL) && (tablePtr->link != NULL)) {
-        TableObject *corePtr;
+    for (code = (unsigned int)(uintptr_t)Blt_GetHashValue(hPtr); code != 0;
+         code = encPtr->strings[code].next) {
+        EncodedString *strPtr;
 
-        corePtr = tablePtr->corePtr;
-        /* Remove the client from the server's list */
-        Blt_Chain_DeleteLink(corePtr->clients, tablePtr->link);
-        if (Blt_Chain_GetLength(corePtr->clients) == 0) {
-            DestroyTableObject(corePtr);
+        strPtr = encPtr->strings + code;
+        if ((strPtr->length == (unsigned int)length) && 
+            (memcmp(strPtr->string, string, length) == 0)) {
+            return code;
         }
     }
-    tablePtr->magic = 0;
-    Blt_Free(tablePtr);
+    return 0;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * NewTable --
+ * InternString --
  *
- *      Creates a new table client.  Clients shared a tuple data object.
- *      They individually manage traces and events on tuple objects.
- *      Returns a pointer to the malloc'ed structure.  This is passed to
- *      the client as a tuple token.
- *      
- * Results:
- *      A pointer to a Table is returned.  If one can't be allocated, NULL
- *      is returned.
+ *      Returns the code of the string in the dictionary, adding the
+ *      string if it's not already there.  The string doesn't need to be
+ *      NUL terminated.  Strings are found by their hash, so the string
+ *      isn't copied unless it's new.
  *
  *---------------------------------------------------------------------------
  */
-static Table *
-NewTable(
-    InterpData *dataPtr, 
-    TableObject *corePtr,               /* Table object serving this
-                                         * client. */
-    const char *qualName)               /* Full namespace qualified name of
-                                         * table. A table by this name may
-                                         * already exist. */
+static unsigned int
+InternString(ColumnEncoding *encPtr, const char *string, int length)
 {
-    Blt_Chain chain;                    /* List of clients using the same
-                                         * name. */
-    Table *tablePtr;
+    Blt_HashEntry *hPtr;
+    EncodedString *strPtr;
+    char *bytes;
+    uint64_t hash;
+    unsigned int code;
     int isNew;
 
-    tablePtr = Blt_Calloc(1, sizeof(Table));
-    if (tablePtr == NULL) {
-        return NULL;
-    }
-    tablePtr->magic = TABLE_MAGIC;
-    tablePtr->interp = dataPtr->interp;
-    /* Add client to table object's list of clients. */
-    tablePtr->link = Blt_Chain_Append(corePtr->clients, tablePtr);
-
-    /* Create a new set of tags. */
-    InitTags(tablePtr);
+    hash = HashString(string, length);
+    code = FindEncodedString(encPtr, string, length, hash);
+    if (code != 0) {
+        return code;
+    }
+    if (encPtr->numStrings == encPtr->numAllocated) {
+        encPtr->numAllocated += encPtr->numAllocated;
+        encPtr->strings = Blt_AssertRealloc(encPtr->strings, 
+                encPtr->numAllocated * sizeof(EncodedString));
+    }
+    code = encPtr->numStrings++;
+    strPtr = encPtr->strings + code;
+    bytes = Blt_AssertMalloc(length + 1);
+    memcpy(bytes, string, length);
+    bytes[length] = '\0';
+    strPtr->string = bytes;
+    strPtr->length = length;
+    strPtr->hash = hash;
+    /* Put the new string first in the chain of strings with its hash. */
+    hPtr = Blt_CreateHashEntry(&encPtr->stringTable, (char *)(uintptr_t)hash,
+                               &isNew);
+    strPtr->next = (isNew) ? 0 : 
+        (unsigned int)(uintptr_t)Blt_GetHashValue(hPtr);
+    Blt_SetHashValue(hPtr, (ClientData)(uintptr_t)code);
+    if (encPtr->ranks != NULL) {
+        Blt_Free(encPtr->ranks);        /* The ranks are stale. */
+        encPtr->ranks = NULL;
+    }
+    return code;
+}
 
-    tablePtr->clientTablePtr = &dataPtr->clientTable;
-    /* Table names are not unique.  More than one client may open the same
-     * table.  The name remains in use so long as one client is still using
-     * the table. This is so other clients can refer to the table, even
-     * though the original client that created the data no longer
-     * exists. */
-    tablePtr->hPtr = Blt_CreateHashEntry(&dataPtr->clientTable, qualName, 
-        &isNew);
-    if (isNew) {
-        chain = Blt_Chain_Create();
-        Blt_SetHashValue(tablePtr->hPtr, chain);
-    } else {
-        chain = Blt_GetHashValue(tablePtr->hPtr);
+static void
+SetEncodedString(Column *colPtr, Row *rowPtr, const char *string, int length)
+{
+    if (length < 0) {
+        length = strlen(string);
     }
-    tablePtr->name = Blt_GetHashKey(&dataPtr->clientTable, tablePtr->hPtr);
-    tablePtr->link2 = Blt_Chain_Append(chain, tablePtr);
-    tablePtr->rowNotifiers = Blt_Chain_Create();
-    tablePtr->columnNotifiers = Blt_Chain_Create();
-    tablePtr->readTraces = Blt_Chain_Create();
-    tablePtr->writeTraces = Blt_Chain_Create();
-    Blt_InitHashTable(&tablePtr->notifiers, BLT_ONE_WORD_KEYS);
-    Blt_InitHashTable(&tablePtr->traces, BLT_ONE_WORD_KEYS);
-
-    tablePtr->corePtr = corePtr;
-    return tablePtr;
+    StatsRemoveValue(colPtr, rowPtr);
+    EncodedCode(colPtr, rowPtr->offset) = 
+        InternString(colPtr->encodingPtr, string, length);
+    StatsAddValue(colPtr, rowPtr);
 }
 
-static Blt_HashTable *
-GetColumnLabelTable(Columns *columnsPtr, const char *label)
+static void
+UnsetEncodedValue(Column *colPtr, Row *rowPtr)
 {
-    Blt_HashEntry *hPtr;
-
-    hPtr = Blt_FindHashEntry(&columnsPtr->labelTable, label);
-    if (hPtr != NULL) {
-        return Blt_GetHashValue(hPtr);
-    }
-    return NULL;
+    StatsRemoveValue(colPtr, rowPtr);
+    EncodedCode(colPtr, rowPtr->offset) = 0;
 }
 
-static Blt_HashTable *
-GetRowLabelTable(Rows *rowsPtr, const char *label)
+static void
+ResizeEncodedColumn(Column *colPtr, size_t oldSize, size_t newSize)
 {
-    Blt_HashEntry *hPtr;
+    unsigned int *codes;
 
-    hPtr = Blt_FindHashEntry(&rowsPtr->labelTable, label);
-    if (hPtr != NULL) {
-        return Blt_GetHashValue(hPtr);
+    codes = Blt_AssertRealloc(colPtr->encodingPtr->codes, 
+                              newSize * sizeof(unsigned int));
+    if (newSize > oldSize) {
+        memset(codes + oldSize, 0, (newSize - oldSize) * sizeof(unsigned int));
     }
-    return NULL;
+    colPtr->encodingPtr->codes = codes;
 }
 
-static Row *
-FindRowLabel(Rows *rowsPtr, const char *label)
+/* Gives the column a copy of the other column's dictionary and codes. */
+static void
+CopyEncodedColumn(Column *srcPtr, Column *destPtr, long numAllocated)
 {
-    Blt_HashTable *tablePtr;
+    ColumnEncoding *srcEncPtr, *destEncPtr;
+    unsigned int i;
 
-    tablePtr = GetRowLabelTable(rowsPtr, label);
-    if (tablePtr != NULL) {
-        Blt_HashEntry *hPtr;
-        Blt_HashSearch iter;
+    srcEncPtr = srcPtr->encodingPtr;
+    destEncPtr = NewEncoding(numAllocated);
+    for (i = 1; i < srcEncPtr->numStrings; i++) {
+        EncodedString *strPtr;
 
-        hPtr = Blt_FirstHashEntry(tablePtr, &iter);
-        if (hPtr != NULL) {
-            return Blt_GetHashValue(hPtr);
-        }
+        strPtr = srcEncPtr->strings + i;
+        InternString(destEncPtr, strPtr->string, strPtr->length);
     }
-    return NULL;
+    memcpy(destEncPtr->codes, srcEncPtr->codes, 
+           numAllocated * sizeof(unsigned int));
+    destPtr->encodingPtr = destEncPtr;
 }
 
-static Column *
-FindColumnLabel(Columns *columnsPtr, const char *label)
+/* Returns the string of a non-empty value of an unpacked column. */
+static INLINE const char *
+GetCellString(Column *colPtr, long offset, unsigned int *lengthPtr)
 {
-    Blt_HashTable *tablePtr;
+    Value *valuePtr;
 
-    tablePtr = GetColumnLabelTable(columnsPtr, label);
-    if (tablePtr != NULL) {
-        Blt_HashEntry *hPtr;
-        Blt_HashSearch iter;
+    if (colPtr->encodingPtr != NULL) {
+        EncodedString *strPtr;
 
-        hPtr = Blt_FirstHashEntry(tablePtr, &iter);
-        if (hPtr != NULL) {
-            return Blt_GetHashValue(hPtr);
-        }
+        strPtr = EncodedStringAt(colPtr, offset);
+        *lengthPtr = strPtr->length;
+        return strPtr->string;
     }
-    return NULL;
+    valuePtr = ColumnValue(colPtr, offset);
+    *lengthPtr = GetValueLength(valuePtr);
+    return GetValueString(valuePtr);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * EncodeColumn --
+ *
+ *      Moves the values of a string column from its chunks of Value
+ *      structures into a dictionary of strings and an array of codes.
+ *
+ *---------------------------------------------------------------------------
+ */
 static int
-SetColumnType(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
-              BLT_TABLE_COLUMN_TYPE type)
+EncodeColumn(Tcl_Interp *interp, Table *tablePtr, Column *colPtr)
 {
+    ColumnEncoding *encPtr;
     Row *rowPtr;
+    long numAllocated;
 
-    if (type == colPtr->type) {
-        return TCL_OK;                  /* Already the requested type. */
+    if (colPtr->encodingPtr != NULL) {
+        return TCL_OK;                  /* Already encoded. */
     }
-    /* First test that every value in the column can be converted. */
-    for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
-         rowPtr = rowPtr->nextPtr) {
-        if (!IsEmpty(rowPtr, colPtr)) {
-            Value value;
+    if (colPtr->type != TABLE_COLUMN_TYPE_STRING) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't encode column \"", colPtr->label,
+                "\": type \"", blt_table_column_type_to_name(colPtr->type),
+                "\" isn't string", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (colPtr->indexPtr != NULL) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't encode column \"", colPtr->label,
+                "\": column is indexed", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    /* The values are moved out of the chunks, so they can't be shared. */
+    UnshareColumn(colPtr);
+    numAllocated = NumRowsAllocated(tablePtr);
+    encPtr = NewEncoding(numAllocated);
+    if (colPtr->chunks != NULL) {
+        for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL;
+             rowPtr = rowPtr->nextPtr) {
             Value *valuePtr;
 
-            valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-            memset(&value, 0, sizeof(Value));
-            if (SetValueFromString(interp, type, GetValueString(valuePtr),
-                        GetValueLength(valuePtr), &value) != TCL_OK) {
-                return TCL_ERROR;
+            valuePtr = ColumnValue(colPtr, rowPtr->offset);
+            if (IsEmptyValue(valuePtr)) {
+                continue;
             }
-            ResetValue(&value);
+            encPtr->codes[rowPtr->offset] = InternString(encPtr, 
+                GetValueString(valuePtr), GetValueLength(valuePtr));
+            ResetValue(valuePtr);
         }
+        FreeChunks(colPtr->chunks, numAllocated);
+        colPtr->chunks = NULL;
     }
-    /* Now replace the column with the converted the values. */
-    for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
-         rowPtr = rowPtr->nextPtr) {
-        if (!IsEmpty(rowPtr, colPtr)) {
-            Value *valuePtr;
+    colPtr->encodingPtr = encPtr;
+    return TCL_OK;
+}
 
-            valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-            if (SetValueFromString(interp, type, GetValueString(valuePtr),
-                 GetValueLength(valuePtr), valuePtr) != TCL_OK) {
-                return TCL_ERROR;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DecodeColumn --
+ *
+ *      Moves the values of an encoded column back into chunks of Value
+ *      structures.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+DecodeColumn(Table *tablePtr, Column *colPtr)
+{
+    Row *rowPtr;
+
+    if (colPtr->encodingPtr == NULL) {
+        return;
+    }
+    assert(colPtr->chunks == NULL);
+    if (NumRowsAllocated(tablePtr) > 0) {
+        colPtr->chunks = AllocChunks(NumRowsAllocated(tablePtr));
+        for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL;
+             rowPtr = rowPtr->nextPtr) {
+            if (EncodedCode(colPtr, rowPtr->offset) != 0) {
+                EncodedString *strPtr;
+
+                strPtr = EncodedStringAt(colPtr, rowPtr->offset);
+                SetValueString(ColumnValue(colPtr, rowPtr->offset), 
+                               strPtr->string, strPtr->length);
             }
         }
     }
-    colPtr->type = type;
-    return TCL_OK;
+    FreeEncodedColumn(colPtr);
+}
+
+/* 
+ * Column bindings.
+ *
+ *      A double column may be bound to a vector.  The vector gets a copy
+ *      of the column's values in row order, with empty cells set to NaN,
+ *      the vector's empty value.  The column's chunks aren't contiguous,
+ *      so the vector can't use them directly.  When the rows are in
+ *      storage order (each row's offset is its index) and the column is
+ *      packed, the copy is the column's view: a value set in the table is
+ *      copied into it as it's made.  Otherwise the copy is refreshed when
+ *      the table changes.  Changes made through the vector are written
+ *      back into the column when the vector notifies its clients.
+ */
+struct _BLT_TABLE_BINDING {
+    Tcl_Interp *interp;                 /* Interpreter of the vector. */
+    Table *tablePtr;                    /* Client that bound the column. */
+    TableObject *corePtr;
+    Column *colPtr;                     /* Bound column. */
+    Blt_VectorId vecId;                 /* Token for the vector. */
+    Blt_Vector *vecPtr;
+    Blt_ChainLink link;                 /* Link in the table's list of
+                                         * bindings. */
+    double *array;                      /* Array last given to the
+                                         * vector. */
+    int length;                         /* # of values last given to the
+                                         * vector. */
+    int dirty;                          /* Change count of the vector when
+                                         * it was last in sync with the
+                                         * column. */
+    unsigned int flags;
+};
+
+#define BIND_VIEW       (1<<0)          /* The vector's array is indexed
+                                         * by row offset, so single cells
+                                         * can be updated in place. */
+#define BIND_STALE      (1<<1)          /* The rows have changed since the
+                                         * vector was last synced. */
+#define BIND_PENDING    (1<<2)          /* An idle sync is scheduled. */
+#define BIND_SYNCING    (1<<3)          /* The vector is being reset from
+                                         * the column. */
+#define BIND_WRITING    (1<<4)          /* The vector's values are being
+                                         * written into the column. */
+
+static Blt_HashTable *
+GetBindingTable(Tcl_Interp *interp)
+{
+    InterpData *dataPtr;
+
+    dataPtr = Tcl_GetAssocData(interp, TABLE_THREAD_KEY, NULL);
+    return (dataPtr == NULL) ? NULL : &dataPtr->bindingTable;
+}
+
+static int
+RowsInOrder(Rows *rowsPtr)
+{
+    Row *rowPtr;
+    long count;
+
+    count = 0;
+    for (rowPtr = rowsPtr->headPtr; rowPtr != NULL; rowPtr = rowPtr->nextPtr) {
+        if (rowPtr->offset != count) {
+            return FALSE;
+        }
+        count++;
+    }
+    return TRUE;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * UnsetValue --
+ * ResetBindingVector --
  *
- *      Removes the value from the selected row, column location in the
- *      table.  The row, column location must be within the actual table
- *      limits, but it's okay if there isn't a value there to remove.
+ *      Gives the vector a new array of values.  If the vector hasn't been
+ *      changed by anyone else since it was last synced, the binding is
+ *      marked as up-to-date with the vector.
  *
- * Results:
- *      None.
+ *---------------------------------------------------------------------------
+ */
+static void
+ResetBindingVector(ColumnBinding *bindPtr, double *array, int length, 
+                   Tcl_FreeProc *freeProc)
+{
+    int isChanged;
+
+    isChanged = (Blt_VecDirty(bindPtr->vecPtr) != bindPtr->dirty);
+    bindPtr->flags |= BIND_SYNCING;
+    Blt_ResetVector(bindPtr->vecPtr, array, length, length, freeProc);
+    bindPtr->flags &= ~BIND_SYNCING;
+    bindPtr->array = Blt_VecData(bindPtr->vecPtr);
+    bindPtr->length = Blt_VecLength(bindPtr->vecPtr);
+    if (!isChanged) {
+        bindPtr->dirty = Blt_VecDirty(bindPtr->vecPtr);
+    }
+}
+
+/* 
+ * The view of a bound column is the vector's own array.  It's indexed by
+ * row offset, so a value set in the table is copied into it without
+ * resyncing the whole vector.  It exists only while the column is bound,
+ * packed, and its rows are in storage order.
+ */
+static INLINE int
+IsViewCurrent(ColumnBinding *bindPtr)
+{
+    return ((bindPtr->flags & BIND_VIEW) &&
+            (bindPtr->colPtr->flags & TABLE_COLUMN_PACKED) &&
+            (Blt_VecData(bindPtr->vecPtr) == bindPtr->array));
+}
+
+/*
+ *---------------------------------------------------------------------------
  *
- * Side Effects:
- *      The objPtr representing the value is released.
+ * SyncBinding --
+ *
+ *      Resets the vector from the column.  The vector gets a copy of the
+ *      values in row order.  If the column is packed and the rows are in
+ *      storage order, the copy is made a chunk at a time and is kept as
+ *      the column's view.
  *
  *---------------------------------------------------------------------------
  */
 static void
-UnsetValue(Table *tablePtr, Row *rowPtr, Column *colPtr)
+SyncBinding(ColumnBinding *bindPtr)
 {
-    Value *valuePtr;
-
-    if (colPtr->vector == NULL) {
+    Column *colPtr;
+    Row *rowPtr;
+    Rows *rowsPtr;
+    double *array;
+    long i, numRows;
+
+    colPtr = bindPtr->colPtr;
+    rowsPtr = &bindPtr->corePtr->rows;
+    numRows = rowsPtr->numUsed;
+    bindPtr->flags &= ~(BIND_STALE | BIND_VIEW);
+    if (numRows == 0) {
+        ResetBindingVector(bindPtr, NULL, 0, TCL_DYNAMIC);
         return;
     }
-    valuePtr = colPtr->vector + rowPtr->offset;
-    if (!IsEmptyValue(valuePtr)) {
-        /* Indicate the keytables need to be regenerated. */
-        if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-            tablePtr->flags |= TABLE_KEYS_DIRTY;
+    array = Blt_AssertMalloc(numRows * sizeof(double));
+    if ((colPtr->flags & TABLE_COLUMN_PACKED) && 
+        (IsPackedDouble(colPtr)) && (RowsInOrder(rowsPtr))) {
+        GetPackedSlots(colPtr, 0, array, numRows);
+        for (i = 0; i < numRows; i++) {
+            if (!PackedExists(colPtr, i)) {
+                array[i] = Blt_NaN();
+            }
         }
+        ResetBindingVector(bindPtr, array, numRows, TCL_DYNAMIC);
+        bindPtr->flags |= BIND_VIEW;
+        return;
+    } 
+    for (i = 0, rowPtr = rowsPtr->headPtr; rowPtr != NULL; 
+         rowPtr = rowPtr->nextPtr, i++) {
+        array[i] = blt_table_get_double(NULL, bindPtr->tablePtr, rowPtr,
+                colPtr);
     }
-    ResetValue(valuePtr);
+    ResetBindingVector(bindPtr, array, numRows, TCL_DYNAMIC);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * WriteBackVector --
+ *
+ *      Writes the values of the vector into the column.  Each value is set
+ *      in the row with the same index, adding rows if the vector is longer
+ *      than the table.  NaN values unset the cell.  Only cells whose
+ *      values differ are changed, and traces are fired for them.
+ *
+ *---------------------------------------------------------------------------
+ */
 static void
-UnsetRowValues(Table *tablePtr, Row *rowPtr)
+WriteBackVector(ColumnBinding *bindPtr)
 {
+    Table *tablePtr;
     Column *colPtr;
+    Row *rowPtr, *nextPtr;
+    double *values;
+    long i, length, numRows;
+
+    tablePtr = bindPtr->tablePtr;
+    colPtr = bindPtr->colPtr;
+    bindPtr->flags |= BIND_WRITING;
+    /* The vector may free its array if it's reset while the values
+     * are written, so work from a copy. */
+    length = Blt_VecLength(bindPtr->vecPtr);
+    values = Blt_AssertMalloc(MAX(length, 1) * sizeof(double));
+    memcpy(values, Blt_VecData(bindPtr->vecPtr), length * sizeof(double));
+    numRows = tablePtr->corePtr->rows.numUsed;
+    if ((length > numRows) && 
+        (blt_table_extend_rows(NULL, tablePtr, length - numRows, NULL) 
+         != TCL_OK)) {
+        length = numRows;
+    }
+    for (i = 0, rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL;
+         rowPtr = nextPtr, i++) {
+        nextPtr = rowPtr->nextPtr;
+        if ((i >= length) || (isnan(values[i]))) {
+            blt_table_unset_value(tablePtr, rowPtr, colPtr);
+        } else if ((IsEmpty(rowPtr, colPtr)) || 
+            (blt_table_get_double(NULL, tablePtr, rowPtr, colPtr) 
+             != values[i])) {
+            blt_table_set_double(NULL, tablePtr, rowPtr, colPtr, 
+                    values[i]);
+        }
+    }
+    Blt_Free(values);
+    bindPtr->flags &= ~BIND_WRITING;
+    bindPtr->dirty = Blt_VecDirty(bindPtr->vecPtr);
+    SyncBinding(bindPtr);
+}
 
-    for (colPtr = tablePtr->corePtr->columns.headPtr; colPtr != NULL;
-         colPtr = colPtr->nextPtr) {
-        if (colPtr->vector != NULL) {
-            UnsetValue(tablePtr, rowPtr, colPtr);
-        }
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RefreshBinding --
+ *
+ *      Brings the column and the vector back in sync.  Changes made
+ *      through the vector are written into the column first.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+RefreshBinding(ColumnBinding *bindPtr)
+{
+    if (Blt_VecDirty(bindPtr->vecPtr) != bindPtr->dirty) {
+        WriteBackVector(bindPtr);
+    } else {
+        SyncBinding(bindPtr);
     }
 }
 
 static void
-DeleteRow(Rows *rowsPtr, Row *rowPtr)
+BindingIdleProc(ClientData clientData)
 {
-    /* If there is a label is associated with the row, free it. */
-    if (rowPtr->label != NULL) {
-        UnsetRowLabel(rowsPtr, rowPtr);
-    }
-    /* Unlink the row from the list of rows. */
-    if (rowsPtr->headPtr == rowPtr) {
-        rowsPtr->headPtr = rowPtr->nextPtr;
-    }
-    if (rowsPtr->tailPtr == rowPtr) {
-        rowsPtr->tailPtr = rowPtr->prevPtr;
-    }
-    if (rowPtr->nextPtr != NULL) {
-        rowPtr->nextPtr->prevPtr = rowPtr->prevPtr;
-    }
-    if (rowPtr->prevPtr != NULL) {
-        rowPtr->prevPtr->nextPtr = rowPtr->nextPtr;
+    ColumnBinding *bindPtr = clientData;
+
+    bindPtr->flags &= ~BIND_PENDING;
+    if (bindPtr->flags & BIND_STALE) {
+        RefreshBinding(bindPtr);
     }
-    /* Mark the map entry as empty. */
-    rowsPtr->map[rowPtr->index] = NULL;
-    rowsPtr->flags |= REINDEX;
-    if (rowsPtr->freeList != NULL) {
-        /* We don't delete row storage, just add the row offset back onto
-         * the free list. */
-        Blt_Chain_Append(rowsPtr->freeList,
-                         (ClientData)(uintptr_t)rowPtr->offset);
+}
+
+static void
+MarkBindingStale(ColumnBinding *bindPtr)
+{
+    bindPtr->flags |= BIND_STALE;
+    if ((bindPtr->flags & BIND_PENDING) == 0) {
+        bindPtr->flags |= BIND_PENDING;
+        Tcl_DoWhenIdle(BindingIdleProc, bindPtr);
     }
-    /* Finally free the row itself. */
-    Blt_Pool_FreeItem(rowsPtr->pool, rowPtr);
-    rowsPtr->numUsed--;
 }
 
 static void
-DeleteColumn(Table *tablePtr, Column *colPtr)
+MarkBindingsStale(TableObject *corePtr)
 {
-    Columns *columnsPtr;
+    Blt_ChainLink link;
 
-    columnsPtr = &tablePtr->corePtr->columns;
-    /* If there is a label is associated with the column, free it. */
-    if (colPtr->label != NULL) {
-        UnsetColumnLabel(columnsPtr, colPtr);
-    }
-    if (columnsPtr->headPtr == colPtr) {
-        columnsPtr->headPtr = colPtr->nextPtr;
-    }
-    if (columnsPtr->tailPtr == colPtr) {
-        columnsPtr->tailPtr = colPtr->prevPtr;
-    }
-    if (colPtr->nextPtr != NULL) {
-        colPtr->nextPtr->prevPtr = colPtr->prevPtr;
-    }
-    if (colPtr->prevPtr != NULL) {
-        colPtr->prevPtr->nextPtr = colPtr->nextPtr;
+    if (corePtr->bindings == NULL) {
+        return;
     }
-    colPtr->prevPtr = colPtr->nextPtr = NULL;
-    columnsPtr->map[colPtr->index] = NULL;
-    columnsPtr->flags |= REINDEX;
-    if (colPtr->vector != NULL) {
-        Row *rowPtr;
-
-        for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL;
-             rowPtr = rowPtr->nextPtr) {
-            ResetValue(colPtr->vector + rowPtr->offset);
-        }
-        Blt_Free(colPtr->vector);
-        colPtr->vector = NULL;
+    for (link = Blt_Chain_FirstLink(corePtr->bindings); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        MarkBindingStale(Blt_Chain_GetValue(link));
     }
-    /* Finally free the column. */
-    Blt_Pool_FreeItem(columnsPtr->pool, colPtr);
-    columnsPtr->numUsed--;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ClearRowNotifiers --
+ * UpdateBinding --
  *
- *      Removes all event handlers set for the designated row.  Note that
- *      this doesn't remove handlers triggered by row or column tags.  Row
- *      and column event notifiers are stored in a chain.
+ *      Called when a cell of a bound column is set or unset.  If the
+ *      vector holds the column's view, the new value is copied into it
+ *      and the vector's clients are notified.  Otherwise the vector is
+ *      refreshed when idle.  A NULL row means that any of the cells may
+ *      have changed, so the vector is resynced unless it has changes of
+ *      its own still to be written back.
  *
  *---------------------------------------------------------------------------
  */
 static void
-ClearRowNotifiers(Table *tablePtr, Row *rowPtr)
+UpdateBinding(ColumnBinding *bindPtr, Row *rowPtr, unsigned int flags)
 {
-    Blt_ChainLink link, next;
-
-    for (link = Blt_Chain_FirstLink(tablePtr->rowNotifiers); link != NULL;
-         link = next) {
-        Notifier *notifierPtr;
+    Column *colPtr;
+    int isChanged;
 
-        next = Blt_Chain_NextLink(link);
-        notifierPtr = Blt_Chain_GetValue(link);
-        if (notifierPtr->row == rowPtr) {
-            blt_table_delete_notifier(tablePtr, notifierPtr);
+    if (bindPtr->flags & (BIND_SYNCING | BIND_WRITING)) {
+        return;
+    }
+    isChanged = (Blt_VecDirty(bindPtr->vecPtr) != bindPtr->dirty);
+    colPtr = bindPtr->colPtr;
+    if ((rowPtr == NULL) && (!isChanged)) {
+        SyncBinding(bindPtr);
+    } else if ((rowPtr != NULL) && (IsViewCurrent(bindPtr)) && 
+               (rowPtr->offset < bindPtr->length)) {
+        long offset;
+
+        /* Unset traces are called before the value is removed. */
+        offset = rowPtr->offset;
+        bindPtr->array[offset] = 
+            ((flags & TABLE_TRACE_UNSETS) || (!PackedExists(colPtr, offset))) ?
+            Blt_NaN() : PackedDouble(colPtr, offset);
+        bindPtr->flags |= BIND_SYNCING;
+        Blt_Vec_UpdateClients((Vector *)bindPtr->vecPtr);
+        bindPtr->flags &= ~BIND_SYNCING;
+        if (!isChanged) {
+            bindPtr->dirty = Blt_VecDirty(bindPtr->vecPtr);
         }
+    } else {
+        MarkBindingStale(bindPtr);
+    }
+}
+
+static void
+VectorChangedProc(Tcl_Interp *interp, ClientData clientData, 
+                  Blt_VectorNotify notify)
+{
+    ColumnBinding *bindPtr = clientData;
+
+    if (notify == BLT_VECTOR_NOTIFY_DESTROY) {
+        FreeBinding(bindPtr);
+        return;
+    }
+    if (bindPtr->flags & (BIND_SYNCING | BIND_WRITING)) {
+        return;
+    }
+    if (Blt_VecDirty(bindPtr->vecPtr) != bindPtr->dirty) {
+        WriteBackVector(bindPtr);
     }
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ClearColumnNotifiers --
+ * FreeBinding --
  *
- *      Removes all event handlers set for the designated row.  Note that
- *      this doesn't remove handlers triggered by row or column tags.  Row
- *      and column event notifiers are stored in a chain.
+ *      Removes the binding between a column and a vector.  Unless the
+ *      vector is being destroyed, it keeps a copy of the values.
  *
  *---------------------------------------------------------------------------
  */
 static void
-ClearColumnNotifiers(Table *tablePtr, Column *colPtr)
+FreeBinding(ColumnBinding *bindPtr)
 {
-    Blt_ChainLink link, next;
+    Blt_HashTable *bindTablePtr;
 
-    for (link = Blt_Chain_FirstLink(tablePtr->columnNotifiers); link != NULL; 
-        link = next) {
-        Notifier *notifierPtr;
+    if (bindPtr->flags & BIND_PENDING) {
+        Tcl_CancelIdleCall(BindingIdleProc, bindPtr);
+    }
+    bindTablePtr = GetBindingTable(bindPtr->interp);
+    if (bindTablePtr != NULL) {
+        Blt_HashEntry *hPtr;
 
-        next = Blt_Chain_NextLink(link);
-        notifierPtr = Blt_Chain_GetValue(link);
-        if (notifierPtr->column == colPtr) {
-            blt_table_delete_notifier(tablePtr, notifierPtr);
+        hPtr = Blt_FindHashEntry(bindTablePtr, bindPtr->vecPtr);
+        if (hPtr != NULL) {
+            Blt_DeleteHashEntry(bindTablePtr, hPtr);
         }
     }
+    Blt_FreeVectorId(bindPtr->vecId);
+    bindPtr->colPtr->bindPtr = NULL;
+    Blt_Chain_DeleteLink(bindPtr->corePtr->bindings, bindPtr->link);
+    Blt_Free(bindPtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * DoNotify --
- *
- *      Traverses the client's list of event callbacks and checks if one
- *      matches the given event.  A client may trigger an action that
- *      causes the itself to be notified again.  This can be prevented by
- *      setting the TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
+ * FreeBindings --
  *
- *      If a matching handler is found, a callback may be called either
- *      immediately or at the next idle time depending upon the
- *      TABLE_NOTIFY_WHENIDLE bit.
+ *      Removes the column bindings made by the client.  If the client is
+ *      NULL, all bindings of the table are removed.
  *
- *      Since a handler routine may trigger yet another call to itself,
- *      callbacks are ignored while the event handler is executing.
- *      
  *---------------------------------------------------------------------------
  */
 static void
-DoNotify(Table *tablePtr, Blt_Chain notifiers, 
-         BLT_TABLE_NOTIFY_EVENT *eventPtr)
+FreeBindings(TableObject *corePtr, Table *tablePtr)
 {
-    Blt_ChainLink link;
-    unsigned int eventMask;
+    Blt_ChainLink link, next;
 
-    /* Check the client table for matching notifiers.  Issue callbacks
-     * indicating that the structure of the table has changed.  */
-    eventMask = eventPtr->type & TABLE_NOTIFY_MASK;
-    for (link = Blt_Chain_FirstLink(notifiers); link != NULL; 
-         link = Blt_Chain_NextLink(link)) {
-        Notifier *notifierPtr;
-        int match;
+    if (corePtr->bindings == NULL) {
+        return;
+    }
+    for (link = Blt_Chain_FirstLink(corePtr->bindings); link != NULL;
+         link = next) {
+        ColumnBinding *bindPtr;
 
-        notifierPtr = Blt_Chain_GetValue(link);
-        if ((notifierPtr->flags & eventMask) == 0) {
-            continue;                   /* Event type doesn't match */
-        }
-        if ((eventPtr->self) && 
-            (notifierPtr->flags & TABLE_NOTIFY_FOREIGN_ONLY)) {
-            continue;                   /* Don't notify yourself. */
-        }
-        if (notifierPtr->flags & TABLE_NOTIFY_ACTIVE) {
-            continue;                   /* Ignore callbacks that are
-                                         * generated inside of a notify
-                                         * handler routine. */
-        }
-        match = FALSE;
-        if (notifierPtr->tag != NULL) {
-            if (notifierPtr->flags & TABLE_NOTIFY_ROW) {
-                if (blt_table_row_has_tag(tablePtr, eventPtr->row, 
-                        notifierPtr->tag)) {
-                    match++;
-                }
-            } else {
-                if (blt_table_column_has_tag(tablePtr, eventPtr->column, 
-                        notifierPtr->tag)) {
-                    match++;
-                }
-            }
-        } else if ((notifierPtr->flags & TABLE_NOTIFY_ROW) && 
-                   ((notifierPtr->row == NULL) || 
-                    (notifierPtr->row == eventPtr->row))) {
-            match++;                    /* Offsets match. */
-        } else if ((notifierPtr->flags & TABLE_NOTIFY_COLUMN) && 
-                   ((notifierPtr->column == NULL) ||
-                    (notifierPtr->column == eventPtr->column))) {
-            match++;                    /* Offsets match. */
-        }
-        if (!match) {
-            continue;                   /* Row or column doesn't match. */
-        }
-        if (notifierPtr->flags & TABLE_NOTIFY_WHENIDLE) {
-            if ((notifierPtr->flags & TABLE_NOTIFY_PENDING) == 0) {
-                notifierPtr->flags |= TABLE_NOTIFY_PENDING;
-                notifierPtr->event = *eventPtr;
-                Tcl_DoWhenIdle(NotifyIdleProc, notifierPtr);
-            }
-        } else {
-            notifierPtr->event = *eventPtr;
-            NotifyIdleProc(notifierPtr);
+        next = Blt_Chain_NextLink(link);
+        bindPtr = Blt_Chain_GetValue(link);
+        if ((tablePtr == NULL) || (bindPtr->tablePtr == tablePtr)) {
+            FreeBinding(bindPtr);
         }
     }
 }
 
-
-static void
-InitNotifyEvent(Table *tablePtr, BLT_TABLE_NOTIFY_EVENT *eventPtr)
-{
-    memset(eventPtr, 0, sizeof(BLT_TABLE_NOTIFY_EVENT));
-    eventPtr->table = tablePtr;
-    eventPtr->interp = tablePtr->interp;
-}
-
-/*
- *---------------------------------------------------------------------------
- *
- * NotifyClients --
- *
- *      Traverses the list of event callbacks and checks if one matches the
- *      given event.  A client may trigger an action that causes the table
- *      object to notify it.  This can be prevented by setting the
- *      TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
- *
- *      If a matching handler is found, a callback may be called either
- *      immediately or at the next idle time depending upon the
- *      TABLE_NOTIFY_WHENIDLE bit.
- *
- *      Since a handler routine may trigger yet another call to itself,
- *      callbacks are ignored while the event handler is executing.
- *      
- *---------------------------------------------------------------------------
- */
-static void
-NotifyClients(Table *tablePtr, BLT_TABLE_NOTIFY_EVENT *eventPtr)
+static Value *
+GetValue(Table *tablePtr, Row *rowPtr, Column *colPtr)
 {
-    Blt_ChainLink link, next;
-    
-    for (link = Blt_Chain_FirstLink(tablePtr->corePtr->clients); link != NULL; 
-         link = next) {
-        Table *clientPtr;
-        Blt_Chain chain;
-        
-        next = Blt_Chain_NextLink(link);
-        clientPtr = Blt_Chain_GetValue(link);
-        eventPtr->self = (clientPtr == tablePtr);
-        chain = (eventPtr->type & TABLE_NOTIFY_COLUMN) ?
-            clientPtr->columnNotifiers : clientPtr->rowNotifiers;
-        if (Blt_Chain_GetLength(chain) > 0) {
-            DoNotify(clientPtr, chain, eventPtr);
-        }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        UnpackColumn(tablePtr, colPtr);
     }
+    if (colPtr->encodingPtr != NULL) {
+        DecodeColumn(tablePtr, colPtr);
+    }
+    if (colPtr->chunks == NULL) {
+        assert(NumRowsAllocated(tablePtr) > 0);
+        colPtr->chunks = AllocChunks(NumRowsAllocated(tablePtr));
+    }
+    return ColumnValue(colPtr, rowPtr->offset);
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * NotifyColumnChanged --
- *
- *      Traverses the list of event callbacks and checks if one matches the
- *      given event.  A client may trigger an action that causes the table
- *      object to notify it.  This can be prevented by setting the
- *      TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
- *
- *      If a matching handler is found, a callback may be called either
- *      immediately or at the next idle time depending upon the
- *      TABLE_NOTIFY_WHENIDLE bit.
- *
- *      Since a handler routine may trigger yet another call to itself,
- *      callbacks are ignored while the event handler is executing.
- *      
- *---------------------------------------------------------------------------
- */
-static void
-NotifyColumnChanged(Table *tablePtr, Column *colPtr, unsigned int flags)
+static Tcl_Obj *
+GetObjFromValue(BLT_TABLE_COLUMN_TYPE type, Value *valuePtr)
 {
-    BLT_TABLE_NOTIFY_EVENT event;
+    Tcl_Obj *objPtr;
 
-    InitNotifyEvent(tablePtr, &event);
-    event.type = flags | TABLE_NOTIFY_COLUMN;
-    event.column = colPtr;
-    NotifyClients(tablePtr, &event);
+    assert(!IsEmptyValue(valuePtr));
+    objPtr = NULL;                      /* Suppress compiler warning. */
+    assert(type != TABLE_COLUMN_TYPE_UNKNOWN);
+    switch (type) {
+    case TABLE_COLUMN_TYPE_BLOB:
+        objPtr = Tcl_NewByteArrayObj(GetValueBytes(valuePtr),
+                                     GetValueLength(valuePtr));
+        break;
+    case TABLE_COLUMN_TYPE_TIME:        /* time */
+    case TABLE_COLUMN_TYPE_DOUBLE:      /* double */
+        objPtr = Tcl_NewDoubleObj(valuePtr->datum.d);
+        break;
+    case TABLE_COLUMN_TYPE_INT64:        /* long */
+        objPtr = Blt_NewInt64Obj(valuePtr->datum.i64);
+        break;
+    case TABLE_COLUMN_TYPE_LONG:        /* long */
+        objPtr = Blt_NewLongObj(valuePtr->datum.l);
+        break;
+    case TABLE_COLUMN_TYPE_BOOLEAN:      /* boolean */
+        objPtr = Tcl_NewBooleanObj((int)valuePtr->datum.i);
+        break;
+    default:
+    case TABLE_COLUMN_TYPE_STRING:      /* string */
+        objPtr = Tcl_NewStringObj(GetValueString(valuePtr),
+                                  GetValueLength(valuePtr));
+        break;
+    }
+    return objPtr;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * NotifyRowChanged --
- *
- *      Traverses the list of event callbacks and checks if one matches the
- *      given event.  A client may trigger an action that causes the table
- *      object to notify it.  This can be prevented by setting the
- *      TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
- *
- *      If a matching handler is found, a callback may be called either
- *      immediately or at the next idle time depending upon the
- *      TABLE_NOTIFY_WHENIDLE bit.
- *
- *      Since a handler routine may trigger yet another call to itself,
- *      callbacks are ignored while the event handler is executing.
- *      
- *---------------------------------------------------------------------------
- */
-static void
-NotifyRowChanged(Table *tablePtr, Row *rowPtr, unsigned int flags)
+static int
+SetValueFromObj(Tcl_Interp *interp, BLT_TABLE_COLUMN_TYPE type, 
+                Tcl_Obj *objPtr, Value *valuePtr)
 {
-    BLT_TABLE_NOTIFY_EVENT event;
+    int length;
+    const char *s;
 
-    InitNotifyEvent(tablePtr, &event);
-    event.type = flags | TABLE_NOTIFY_ROW;
-    event.row = rowPtr;
-    NotifyClients(tablePtr, &event);
-}
+    if (objPtr == NULL) {
+        return TCL_OK;
+    }
+    ResetValue(valuePtr);
+    switch (type) {
+    case TABLE_COLUMN_TYPE_TIME:        /* time */
+        if (Blt_GetTimeFromObj(interp, objPtr, &valuePtr->datum.d) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        break;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_clear_row_traces --
- *
- *      Removes all traces set for this row.  Note that this doesn't remove
- *      traces set for specific cells (row,column).  Row traces are stored
- *      in a chain, which in turn is held in a hash table, keyed by the
- *      row.
- *
- *---------------------------------------------------------------------------
- */
-void
-blt_table_clear_row_traces(Table *tablePtr, Row *rowPtr)
-{
-    Blt_ChainLink link, next;
+    case TABLE_COLUMN_TYPE_BOOLEAN:     /* boolean */
+        { 
+            int i;
+            
+            if (Tcl_GetBooleanFromObj(interp, objPtr, &i) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            valuePtr->datum.i = i;
+        }
+        break;
 
-    for (link = Blt_Chain_FirstLink(tablePtr->readTraces); link != NULL; 
-         link = next) {
-        Trace *tracePtr;
+    case TABLE_COLUMN_TYPE_DOUBLE:      /* double */
+        if (Blt_GetDoubleFromObj(interp, objPtr, &valuePtr->datum.d)!=TCL_OK) {
+            return TCL_ERROR;
+        }
+        break;
 
-        next = Blt_Chain_NextLink(link);
-        tracePtr = Blt_Chain_GetValue(link);
-        if (tracePtr->row == rowPtr) {
-            blt_table_delete_trace(tablePtr, tracePtr);
+    case TABLE_COLUMN_TYPE_INT64:        /* int64 */
+        if (Blt_GetInt64FromObj(interp, objPtr, &valuePtr->datum.i64)!=TCL_OK) {
+            return TCL_ERROR;
         }
-    }
-    for (link = Blt_Chain_FirstLink(tablePtr->writeTraces); link != NULL; 
-         link = next) {
-        Trace *tracePtr;
+        break;
 
-        next = Blt_Chain_NextLink(link);
-        tracePtr = Blt_Chain_GetValue(link);
-        if (tracePtr->row == rowPtr) {
-            blt_table_delete_trace(tablePtr, tracePtr);
+    case TABLE_COLUMN_TYPE_LONG:        /* long */
+        if (Blt_GetLongFromObj(interp, objPtr, &valuePtr->datum.l) != TCL_OK) {
+            return TCL_ERROR;
         }
+        break;
+    default:
+        break;
+    }
+    s = Tcl_GetStringFromObj(objPtr, &length);
+    if (length >= TABLE_VALUE_LENGTH) {
+        valuePtr->string = Blt_Strndup(s, length);
+        valuePtr->length = length;
+    } else {
+        strncpy(valuePtr->store, s, length);
+        valuePtr->store[length] = '\0';
+        valuePtr->string = TABLE_VALUE_STORE;
+        valuePtr->length = length;
     }
+    return TCL_OK;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_clear_column_traces --
- *
- *      Removes all traces set for this column.  Note that this doesn't
- *      remove traces set for specific cells (row,column).  Column traces
- *      are stored in a chain, which in turn is held in a hash table, keyed
- *      by the column.
- *
- *---------------------------------------------------------------------------
- */
-void
-blt_table_clear_column_traces(Table *tablePtr, BLT_TABLE_COLUMN column)
+
+/* Replaces the string representation of the value.  The numeric datum
+ * is left as is. */
+static void
+SetValueString(Value *valuePtr, const char *s, int length)
 {
-    Blt_ChainLink link, next;
+    char *bp;
 
-    for (link = Blt_Chain_FirstLink(tablePtr->readTraces); link != NULL; 
-         link = next) {
-        Trace *tracePtr;
+    ResetValue(valuePtr);
+    /* Copy the bytes rather than the string, since blobs may hold null
+     * bytes. */
+    if (length >= TABLE_VALUE_LENGTH) {
+        bp = Blt_AssertMalloc(length + 1);
+        valuePtr->string = bp;
+    } else {
+        bp = valuePtr->store;
+        valuePtr->string = TABLE_VALUE_STORE;
+    }
+    memcpy(bp, s, length);
+    bp[length] = '\0';
+    valuePtr->length = length;
+}
 
-        next = Blt_Chain_NextLink(link);
-        tracePtr = Blt_Chain_GetValue(link);
-        if (tracePtr->column == column) {
-            blt_table_delete_trace(tablePtr, tracePtr);
+static int
+SetValueFromString(Tcl_Interp *interp, BLT_TABLE_COLUMN_TYPE type, 
+                   const char *s, int length, Value *valuePtr)
+{
+    double d;
+    long l;
+    Tcl_Obj *objPtr;
+
+    if (length < 0) {
+        length = strlen(s);
+    }
+    objPtr = NULL;
+    if ((type != TABLE_COLUMN_TYPE_STRING) &&
+        (type != TABLE_COLUMN_TYPE_BLOB)) {
+
+        /* For the non-string types, make a copy of the string as a
+         * Tcl_Obj.  This will give us a canonical string representation
+         * and also verify that the string is valid.  */
+        objPtr = Tcl_NewStringObj(s, length);
+        Tcl_IncrRefCount(objPtr);
+        
+        switch (type) {
+        case TABLE_COLUMN_TYPE_TIME:    
+            if (Blt_GetTimeFromObj(interp, objPtr, &d) != TCL_OK) {
+                Tcl_DecrRefCount(objPtr);
+                return TCL_ERROR;
+            }
+            valuePtr->datum.d = d;      /* double */
+            break;
+            
+        case TABLE_COLUMN_TYPE_DOUBLE:  
+            if (Blt_GetDoubleFromObj(interp, objPtr, &d) != TCL_OK) {
+                Tcl_DecrRefCount(objPtr);
+                return TCL_ERROR;
+            }
+            valuePtr->datum.d = d;      /* double */
+            break;
+
+        case TABLE_COLUMN_TYPE_LONG:    
+            if (Blt_GetLongFromObj(interp, objPtr, &l) != TCL_OK) {
+                Tcl_DecrRefCount(objPtr);
+                return TCL_ERROR;
+            }
+            valuePtr->datum.l = l;      /* long */
+            break;
+
+        case TABLE_COLUMN_TYPE_INT64:    
+            {
+                int64_t i;
+                
+                if (Blt_GetInt64FromObj(interp, objPtr, &i) != TCL_OK) {
+                    Tcl_DecrRefCount(objPtr);
+                    return TCL_ERROR;
+                }
+                valuePtr->datum.i64 = i;      /* long */
+            }
+            break;
+
+        case TABLE_COLUMN_TYPE_BOOLEAN: 
+            {
+                int ival;
+                
+                if (Tcl_GetBooleanFromObj(interp, objPtr, &ival) != TCL_OK) {
+                    Tcl_DecrRefCount(objPtr);
+                    return TCL_ERROR;
+                }
+                valuePtr->datum.i = ival; /* boolean */
+            }
+            break;
+        default:
+            break;
         }
+        s = Tcl_GetStringFromObj(objPtr, &length);
+    }        
+    SetValueString(valuePtr, s, length);
+    if (objPtr != NULL) {
+        Tcl_DecrRefCount(objPtr);
     }
-    for (link = Blt_Chain_FirstLink(tablePtr->writeTraces); link != NULL; 
-         link = next) {
-        Trace *tracePtr;
+    return TCL_OK;
+}
 
-        next = Blt_Chain_NextLink(link);
-        tracePtr = Blt_Chain_GetValue(link);
-        if (tracePtr->column == column) {
-            blt_table_delete_trace(tablePtr, tracePtr);
+/*
+ * Secondary indexes.
+ *
+ *      A column may have a secondary index to speed equality and range
+ *      lookups.  Indexes are kept in the column (and so are shared by all
+ *      clients of the table) and are updated whenever a value in the
+ *      column is set or unset.  Empty values aren't indexed.
+ *
+ *      Hash indexes map each value to a hash table of the rows holding
+ *      that value (the same scheme as row and column labels).  Ordered
+ *      indexes are an array of rows sorted by value, and then by row
+ *      offset for equal values.  Small numbers of changes are made in
+ *      place.  After TABLE_INDEX_MAX_UPDATES changes the index is marked
+ *      dirty and rebuilt with the next lookup, so bulk loads don't pay
+ *      for moving the array on every change.
+ */
+#define TABLE_INDEX_DIRTY               (1<<0)
+#define TABLE_INDEX_MAX_UPDATES         64
+
+struct _BLT_TABLE_INDEX {
+    int type;                           /* TABLE_INDEX_HASH or
+                                         * TABLE_INDEX_ORDERED. */
+    unsigned int flags;
+    BLT_TABLE_COLUMN_TYPE colType;      /* Column type when the index was
+                                         * built. Determines the hash key
+                                         * type. */
+    Blt_HashTable valueTable;           /* Hash index: maps values to a
+                                         * hash table of rows. */
+    Row **rows;                         /* Ordered index: array of rows
+                                         * sorted by value. */
+    long numRows;                       /* # of rows in above array. */
+    long numAllocated;                  /* Size of above array. */
+    int numUpdates;                     /* # of changes made to the
+                                         * array since it was built. */
+};
+
+typedef struct _BLT_TABLE_INDEX TableIndex;
+
+typedef struct {
+    Value *valuePtr;
+    Row *rowPtr;
+} IndexEntry;
+
+static int
+CompareIndexValues(BLT_TABLE_COLUMN_TYPE type, Value *valuePtr1, 
+                   Value *valuePtr2)
+{
+    switch (type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+        /* NaNs sort after numbers, so that the order is total. */
+        if (isnan(valuePtr1->datum.d)) {
+            return !isnan(valuePtr2->datum.d);
+        }
+        if (isnan(valuePtr2->datum.d)) {
+            return -1;
+        }
+        if (valuePtr1->datum.d < valuePtr2->datum.d) {
+            return -1;
+        } 
+        return (valuePtr1->datum.d > valuePtr2->datum.d);
+    case TABLE_COLUMN_TYPE_INT64:
+        if (valuePtr1->datum.i64 < valuePtr2->datum.i64) {
+            return -1;
+        } 
+        return (valuePtr1->datum.i64 > valuePtr2->datum.i64);
+    case TABLE_COLUMN_TYPE_LONG:
+        if (valuePtr1->datum.l < valuePtr2->datum.l) {
+            return -1;
+        } 
+        return (valuePtr1->datum.l > valuePtr2->datum.l);
+    case TABLE_COLUMN_TYPE_BOOLEAN:
+        return (valuePtr1->datum.i != 0) - (valuePtr2->datum.i != 0);
+    default:
+        {
+            unsigned int len1, len2;
+            int result;
+
+            len1 = GetValueLength(valuePtr1);
+            len2 = GetValueLength(valuePtr2);
+            result = memcmp(GetValueString(valuePtr1), 
+                            GetValueString(valuePtr2), MIN(len1, len2));
+            if (result == 0) {
+                result = (len1 > len2) - (len1 < len2);
+            }
+            return result;
         }
     }
 }
 
+#define INDEX_COMPARE_PROC(name, type)                                  \
+static int                                                              \
+name(const void *a, const void *b)                                      \
+{                                                                       \
+    const IndexEntry *entryPtr1 = a;                                    \
+    const IndexEntry *entryPtr2 = b;                                    \
+    int result;                                                         \
+                                                                        \
+    result = CompareIndexValues(type, entryPtr1->valuePtr,              \
+                                entryPtr2->valuePtr);                   \
+    if (result == 0) {                                                  \
+        result = (entryPtr1->rowPtr->offset > entryPtr2->rowPtr->offset) - \
+            (entryPtr1->rowPtr->offset < entryPtr2->rowPtr->offset);    \
+    }                                                                   \
+    return result;                                                      \
+}
+
+INDEX_COMPARE_PROC(CompareIndexDoubles, TABLE_COLUMN_TYPE_DOUBLE)
+INDEX_COMPARE_PROC(CompareIndexInt64s, TABLE_COLUMN_TYPE_INT64)
+INDEX_COMPARE_PROC(CompareIndexLongs, TABLE_COLUMN_TYPE_LONG)
+INDEX_COMPARE_PROC(CompareIndexBooleans, TABLE_COLUMN_TYPE_BOOLEAN)
+INDEX_COMPARE_PROC(CompareIndexStrings, TABLE_COLUMN_TYPE_STRING)
+
+static Blt_HashEntry *
+GetIndexEntry(TableIndex *indexPtr, Value *valuePtr, int create)
+{
+    const void *key;
+    double d;
+    int isNew;
+
+    switch (indexPtr->colType) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+        d = valuePtr->datum.d;
+        if (d == 0.0) {
+            d = 0.0;                    /* -0.0 and 0.0 are equal. */
+        }
+        key = &d;
+        break;
+    case TABLE_COLUMN_TYPE_INT64:
+        key = &valuePtr->datum.i64;
+        break;
+    case TABLE_COLUMN_TYPE_LONG:
+        key = (const void *)(intptr_t)valuePtr->datum.l;
+        break;
+    case TABLE_COLUMN_TYPE_BOOLEAN:
+        key = (const void *)(intptr_t)(valuePtr->datum.i != 0);
+        break;
+    default:
+        key = GetValueString(valuePtr);
+        break;
+    }
+    if (create) {
+        return Blt_CreateHashEntry(&indexPtr->valueTable, key, &isNew);
+    }
+    return Blt_FindHashEntry(&indexPtr->valueTable, key);
+}
 
 /*
  *---------------------------------------------------------------------------
  *
- * CallClientTraces --
- *
- *      Examines the traces set for a specific client of the table object
- *      and fires any matching traces.
- *
- *      Traces match on row and column tag and indices and flags.
- *      Traces can match on
- *           flag               type of trace (read, write, unset, create)
- *           row index
- *           column index
- *           row tag
- *           column tag
+ * SearchIndex --
  *
- *      If the TABLE_TRACE_FOREIGN_ONLY is set in the handler, it means to
- *      ignore actions that are initiated by that client of the object.
- *      Only actions by other clients are handled.
+ *      Binary searches the ordered index for the first row whose value is
+ *      greater than (or equal to, if inclusive is TRUE) the given value.
+ *      If rowPtr isn't NULL, rows with equal values are also ordered by
+ *      their offset.
  *
  * Results:
- *      Always returns TCL_OK.
- *
- * Side Effects:
- *      Traces on the tuple table location may be fired.
+ *      Returns the position in the array of rows.
  *
  *---------------------------------------------------------------------------
  */
+static long
+SearchIndex(TableIndex *indexPtr, Column *colPtr, Value *valuePtr, 
+            Row *rowPtr, int inclusive)
+{
+    long low, high;
+
+    low = 0, high = indexPtr->numRows;
+    while (low < high) {
+        long mid;
+        int result;
+        Row *midPtr;
+
+        mid = (low + high) / 2;
+        midPtr = indexPtr->rows[mid];
+        result = CompareIndexValues(indexPtr->colType, 
+                ColumnValue(colPtr, midPtr->offset), valuePtr);
+        if ((result == 0) && (rowPtr != NULL)) {
+            result = (midPtr->offset > rowPtr->offset) - 
+                (midPtr->offset < rowPtr->offset);
+        }
+        if ((result < 0) || ((result == 0) && (!inclusive))) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
 static void
-CallClientTraces(Table *tablePtr, Table *clientPtr, Row *rowPtr, Column *colPtr,
-                 unsigned int flags)
+ClearIndex(TableIndex *indexPtr)
 {
-    Blt_Chain chain;
-    Blt_ChainLink link, next;
-    BLT_TABLE_TRACE_EVENT event;
+    if (indexPtr->type == TABLE_INDEX_HASH) {
+        Blt_HashEntry *hPtr;
+        Blt_HashSearch iter;
 
-    /* Initialize trace event information. */
-    event.table = clientPtr;
-    event.row = rowPtr;
-    event.column = colPtr;
-    event.interp = clientPtr->interp;
-    if (tablePtr == clientPtr) {
-        flags |= TABLE_TRACE_SELF;
+        for (hPtr = Blt_FirstHashEntry(&indexPtr->valueTable, &iter); 
+             hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+            Blt_HashTable *rowTablePtr;
+
+            rowTablePtr = Blt_GetHashValue(hPtr);
+            Blt_DeleteHashTable(rowTablePtr);
+            Blt_Free(rowTablePtr);
+        }
+        Blt_DeleteHashTable(&indexPtr->valueTable);
+    } else if (indexPtr->rows != NULL) {
+        Blt_Free(indexPtr->rows);
+        indexPtr->rows = NULL;
     }
-    event.mask = flags;
-    if (flags & TABLE_TRACE_READS) {
-        chain = clientPtr->readTraces;
-    } else {
-        chain = clientPtr->writeTraces;
+    indexPtr->numRows = indexPtr->numAllocated = 0;
+}
+
+static void
+FreeIndex(Column *colPtr)
+{
+    if (colPtr->indexPtr != NULL) {
+        if ((colPtr->indexPtr->flags & TABLE_INDEX_DIRTY) == 0) {
+            ClearIndex(colPtr->indexPtr);
+        }
+        Blt_Free(colPtr->indexPtr);
+        colPtr->indexPtr = NULL;
     }
-    for (link = Blt_Chain_FirstLink(chain); link != NULL; link = next) {
-        Trace *tracePtr;
-        int match;
+}
 
-        next = Blt_Chain_NextLink(link);
-        tracePtr = Blt_Chain_GetValue(link);
+static void
+AddToHashIndex(TableIndex *indexPtr, Value *valuePtr, Row *rowPtr)
+{
+    Blt_HashEntry *hPtr;
+    Blt_HashTable *rowTablePtr;
+    int isNew;
 
-        if ((tracePtr->flags & flags) == 0) {
-            continue;                   /* Doesn't match trace flags. */
-        }
-        if (tracePtr->flags & TABLE_TRACE_ACTIVE) {
-            continue;                   /* Ignore callbacks that were
-                                         * triggered from the active trace
-                                         * handler routine. */
-        }
-        match = 0;
-        if (tracePtr->colTag != NULL) {
-            if (blt_table_column_has_tag(clientPtr, colPtr, 
-                        tracePtr->colTag)) {
-                match++;
-            }
-        } else if ((tracePtr->column == colPtr) || (tracePtr->column == NULL)) {
-            match++;
-        }
-        if (tracePtr->rowTag != NULL) {
-            if (blt_table_row_has_tag(clientPtr, rowPtr, tracePtr->rowTag)) {
-                match++;
-            }
-        } else if ((tracePtr->row == rowPtr) || (tracePtr->row == NULL)) {
-            match++;
-        }
-        if (match < 2) {
-            continue;                   /* Must match both row and
-                                         * column.  */
-        }
-        if (tracePtr->flags & TABLE_TRACE_WHENIDLE) {
-            if ((tracePtr->flags & TABLE_TRACE_PENDING) == 0) {
-                tracePtr->flags |= TABLE_TRACE_PENDING;
-                tracePtr->event = event;
-                Tcl_DoWhenIdle(TraceIdleProc, tracePtr);
-            }
-        } else {
-            if (DoTrace(tracePtr, &event) == TCL_BREAK) {
-                return;                 /* Don't complete traces on
-                                         * break. */
-            }
-        }
+    hPtr = GetIndexEntry(indexPtr, valuePtr, TRUE);
+    rowTablePtr = Blt_GetHashValue(hPtr);
+    if (rowTablePtr == NULL) {
+        rowTablePtr = Blt_AssertMalloc(sizeof(Blt_HashTable));
+        Blt_InitHashTable(rowTablePtr, BLT_ONE_WORD_KEYS);
+        Blt_SetHashValue(hPtr, rowTablePtr);
+    }
+    Blt_CreateHashEntry(rowTablePtr, (char *)rowPtr, &isNew);
+    if (isNew) {
+        indexPtr->numRows++;
     }
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * CallTraces --
+ * BuildIndex --
  *
- *      Examines the traces set for each client of the table object and
- *      fires any matching traces.
- *
- *      Traces match on row and column indices and flags.
- *      The order is 
- *        1. column traces.
- *        2. row traces.
- *        3. cell (row,column) traces.
- *
- *      If no matching criteria is specified (no tag, key, or tuple
- *      address) then only the bit flag has to match.
- *
- *      If the TABLE_TRACE_FOREIGN_ONLY is set in the handler, it means to
- *      ignore actions that are initiated by that client of the object.
- *      Only actions by other clients are handled.
- *
- * Results:
- *      Always returns TCL_OK.
- *
- * Side Effects:
- *      Traces on the tuple table location may be fired.
+ *      (Re)generates the index from the current values of the column.
  *
  *---------------------------------------------------------------------------
  */
 static void
-CallTraces(Table *tablePtr, Row *rowPtr, Column *colPtr, unsigned int flags)
+BuildIndex(Table *tablePtr, Column *colPtr)
 {
-    Blt_ChainLink link, next;
-
-    for (link = Blt_Chain_FirstLink(tablePtr->corePtr->clients); link != NULL; 
-         link = next) {
-        Table *clientPtr;
+    TableIndex *indexPtr;
+    Row *rowPtr;
 
-        next = Blt_Chain_NextLink(link);
-        clientPtr = Blt_Chain_GetValue(link);
-        CallClientTraces(tablePtr, clientPtr, rowPtr, colPtr, flags);
+    indexPtr = colPtr->indexPtr;
+    if ((indexPtr->flags & TABLE_INDEX_DIRTY) == 0) {
+        ClearIndex(indexPtr);
     }
-}
-
-
-typedef struct {
-    BLT_TABLE table;
-    BLT_TABLE_SORT_ORDER *order;
-    size_t numColumns;
-    unsigned int flags;
-} TableSortData;
-
-
-static TableSortData sortData;
+    indexPtr->flags &= ~TABLE_INDEX_DIRTY;
+    indexPtr->colType = colPtr->type;
+    indexPtr->numUpdates = 0;
+    if (indexPtr->type == TABLE_INDEX_HASH) {
+        size_t keyType;
 
-static int
-CompareDictionaryStrings(ClientData clientData, Column *colPtr, Row *rowPtr1, 
-                         Row *rowPtr2)
-{
-    Value *valuePtr1, *valuePtr2;
-    
-    valuePtr1 = valuePtr2 = NULL;
-    if (colPtr->vector != NULL) {
-        valuePtr1 = colPtr->vector + rowPtr1->offset;
-        if (IsEmptyValue(valuePtr1)) {
-            valuePtr1 = NULL;
-        }
-        valuePtr2 = colPtr->vector + rowPtr2->offset;
-        if (IsEmptyValue(valuePtr2)) {
-            valuePtr2 = NULL;
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_DOUBLE:
+        case TABLE_COLUMN_TYPE_TIME:
+            keyType = sizeof(double) / sizeof(int);
+            break;
+        case TABLE_COLUMN_TYPE_INT64:
+            keyType = sizeof(int64_t) / sizeof(int);
+            break;
+        case TABLE_COLUMN_TYPE_LONG:
+        case TABLE_COLUMN_TYPE_BOOLEAN:
+            keyType = BLT_ONE_WORD_KEYS;
+            break;
+        default:
+            keyType = BLT_STRING_KEYS;
+            break;
         }
-    }
-    if (IsEmptyValue(valuePtr1)) {
-        if (IsEmptyValue(valuePtr2)) {
-            return 0;
+        Blt_InitHashTable(&indexPtr->valueTable, keyType);
+        if (colPtr->chunks == NULL) {
+            return;
         }
-        return 1;
-    } else if (IsEmptyValue(valuePtr2)) {
-        return -1;
-    }
-    assert(valuePtr1 != NULL);
-    assert(valuePtr2 != NULL);
-    return Blt_DictionaryCompare(GetValueString(valuePtr1),
-                                 GetValueString(valuePtr2));
-}
+        for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
+             rowPtr = rowPtr->nextPtr) {
+            Value *valuePtr;
 
-static int
-CompareAsciiStrings(ClientData clientData, Column *colPtr, Row *rowPtr1, 
-                    Row *rowPtr2)
-{
-    Value *valuePtr1, *valuePtr2;
+            valuePtr = ColumnValue(colPtr, rowPtr->offset);
+            if (!IsEmptyValue(valuePtr)) {
+                AddToHashIndex(indexPtr, valuePtr, rowPtr);
+            }
+        }
+    } else {
+        IndexEntry *entries;
+        long i, count;
+        int (*proc)(const void *, const void *);
+
+        count = tablePtr->corePtr->rows.numUsed;
+        indexPtr->numAllocated = MAX(count, 1);
+        indexPtr->rows = Blt_AssertMalloc(sizeof(Row *) * 
+                                          indexPtr->numAllocated);
+        if ((colPtr->chunks == NULL) || (count == 0)) {
+            return;
+        }
+        entries = Blt_AssertMalloc(sizeof(IndexEntry) * count);
+        i = 0;
+        for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
+             rowPtr = rowPtr->nextPtr) {
+            Value *valuePtr;
 
-    valuePtr1 = valuePtr2 = NULL;
-    if (colPtr->vector != NULL) {
-        valuePtr1 = colPtr->vector + rowPtr1->offset;
-        if (IsEmptyValue(valuePtr1)) {
-            valuePtr1 = NULL;
+            valuePtr = ColumnValue(colPtr, rowPtr->offset);
+            if (!IsEmptyValue(valuePtr)) {
+                entries[i].valuePtr = valuePtr;
+                entries[i].rowPtr = rowPtr;
+                i++;
+            }
         }
-        valuePtr2 = colPtr->vector + rowPtr2->offset;
-        if (IsEmptyValue(valuePtr2)) {
-            valuePtr2 = NULL;
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_DOUBLE:
+        case TABLE_COLUMN_TYPE_TIME:
+            proc = CompareIndexDoubles;         break;
+        case TABLE_COLUMN_TYPE_INT64:
+            proc = CompareIndexInt64s;          break;
+        case TABLE_COLUMN_TYPE_LONG:
+            proc = CompareIndexLongs;           break;
+        case TABLE_COLUMN_TYPE_BOOLEAN:
+            proc = CompareIndexBooleans;        break;
+        default:
+            proc = CompareIndexStrings;         break;
         }
-    }
-    if (IsEmptyValue(valuePtr1)) {
-        if (IsEmptyValue(valuePtr2)) {
-            return 0;
+        qsort(entries, i, sizeof(IndexEntry), proc);
+        for (count = 0; count < i; count++) {
+            indexPtr->rows[count] = entries[count].rowPtr;
         }
-        return 1;
-    } else if (IsEmptyValue(valuePtr2)) {
-        return -1;
+        indexPtr->numRows = i;
+        Blt_Free(entries);
     }
-    return strcmp(GetValueString(valuePtr1), GetValueString(valuePtr2));
 }
 
-static int
-CompareAsciiStringsIgnoreCase(ClientData clientData, Column *colPtr,
-                              Row *rowPtr1, Row *rowPtr2)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * IndexRemoveValue --
+ *
+ *      Removes the row's current value in the column from the column's
+ *      index.  This must be called before the value is changed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+IndexRemoveValue(Column *colPtr, Row *rowPtr)
 {
-    Value *valuePtr1, *valuePtr2;
+    TableIndex *indexPtr;
+    Value *valuePtr;
 
-    valuePtr1 = valuePtr2 = NULL;
-    if (colPtr->vector != NULL) {
-        valuePtr1 = colPtr->vector + rowPtr1->offset;
-        if (IsEmptyValue(valuePtr1)) {
-            valuePtr1 = NULL;
-        }
-        valuePtr2 = colPtr->vector + rowPtr2->offset;
-        if (IsEmptyValue(valuePtr2)) {
-            valuePtr2 = NULL;
-        }
+    indexPtr = colPtr->indexPtr;
+    if ((indexPtr == NULL) || (indexPtr->flags & TABLE_INDEX_DIRTY) ||
+        (colPtr->chunks == NULL)) {
+        return;
     }
-    if (IsEmptyValue(valuePtr1)) {
-        if (IsEmptyValue(valuePtr2)) {
-            return 0;
-        }
-        return 1;
-    } else if (IsEmptyValue(valuePtr2)) {
-        return -1;
+    valuePtr = ColumnValue(colPtr, rowPtr->offset);
+    if (IsEmptyValue(valuePtr)) {
+        return;
     }
-    return strcasecmp(GetValueString(valuePtr1), GetValueString(valuePtr2));
-}
-
-static int
-CompareInt64s(ClientData clientData, Column *colPtr, Row *rowPtr1, 
-              Row *rowPtr2)
-{
-    Value *valuePtr1, *valuePtr2;
+    if (indexPtr->type == TABLE_INDEX_HASH) {
+        Blt_HashEntry *hPtr;
 
-    valuePtr1 = valuePtr2 = NULL;
-    if (colPtr->vector != NULL) {
-        valuePtr1 = colPtr->vector + rowPtr1->offset;
-        if (IsEmptyValue(valuePtr1)) {
-            valuePtr1 = NULL;
+        hPtr = GetIndexEntry(indexPtr, valuePtr, FALSE);
+        if (hPtr != NULL) {
+            Blt_HashTable *rowTablePtr;
+            Blt_HashEntry *hPtr2;
+
+            rowTablePtr = Blt_GetHashValue(hPtr);
+            hPtr2 = Blt_FindHashEntry(rowTablePtr, (char *)rowPtr);
+            if (hPtr2 != NULL) {
+                Blt_DeleteHashEntry(rowTablePtr, hPtr2);
+                indexPtr->numRows--;
+            }
+            if (rowTablePtr->numEntries == 0) {
+                Blt_DeleteHashEntry(&indexPtr->valueTable, hPtr);
+                Blt_DeleteHashTable(rowTablePtr);
+                Blt_Free(rowTablePtr);
+            }
         }
-        valuePtr2 = colPtr->vector + rowPtr2->offset;
-        if (IsEmptyValue(valuePtr2)) {
-            valuePtr2 = NULL;
+    } else {
+        long pos;
+
+        if (indexPtr->numUpdates++ >= TABLE_INDEX_MAX_UPDATES) {
+            ClearIndex(indexPtr);
+            indexPtr->flags |= TABLE_INDEX_DIRTY;
+            return;
         }
-    }
-    if (IsEmptyValue(valuePtr1)) {
-        if (IsEmptyValue(valuePtr2)) {
-            return 0;
+        pos = SearchIndex(indexPtr, colPtr, valuePtr, rowPtr, TRUE);
+        if ((pos < indexPtr->numRows) && (indexPtr->rows[pos] == rowPtr)) {
+            memmove(indexPtr->rows + pos, indexPtr->rows + pos + 1,
+                    (indexPtr->numRows - pos - 1) * sizeof(Row *));
+            indexPtr->numRows--;
         }
-        return 1;
-    } else if (IsEmptyValue(valuePtr2)) {
-        return -1;
     }
-    return valuePtr1->datum.i64 - valuePtr2->datum.i64;
 }
 
-static int
-CompareLongs(ClientData clientData, Column *colPtr, Row *rowPtr1, 
-             Row *rowPtr2)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * IndexAddValue --
+ *
+ *      Adds the row's current value in the column to the column's index.
+ *      This is called after the value has been changed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+IndexAddValue(Column *colPtr, Row *rowPtr)
 {
-    Value *valuePtr1, *valuePtr2;
+    TableIndex *indexPtr;
+    Value *valuePtr;
 
-    valuePtr1 = valuePtr2 = NULL;
-    if (colPtr->vector != NULL) {
-        valuePtr1 = colPtr->vector + rowPtr1->offset;
-        if (IsEmptyValue(valuePtr1)) {
-            valuePtr1 = NULL;
-        }
-        valuePtr2 = colPtr->vector + rowPtr2->offset;
-        if (IsEmptyValue(valuePtr2)) {
-            valuePtr2 = NULL;
-        }
+    indexPtr = colPtr->indexPtr;
+    if ((indexPtr == NULL) || (indexPtr->flags & TABLE_INDEX_DIRTY) ||
+        (colPtr->chunks == NULL)) {
+        return;
     }
-    if (IsEmptyValue(valuePtr1)) {
-        if (IsEmptyValue(valuePtr2)) {
-            return 0;
-        }
-        return 1;
-    } else if (IsEmptyValue(valuePtr2)) {
-        return -1;
+    valuePtr = ColumnValue(colPtr, rowPtr->offset);
+    if (IsEmptyValue(valuePtr)) {
+        return;
     }
-    return valuePtr1->datum.l - valuePtr2->datum.l;
-}
-
-static int
-CompareDoubles(ClientData clientData, Column *colPtr, Row *rowPtr1, 
-                    Row *rowPtr2)
-{
-    Value *valuePtr1, *valuePtr2;
-
+    if (indexPtr->type == TABLE_INDEX_HASH) {
+        AddToHashIndex(indexPtr, valuePtr, rowPtr);
+    } else {
+        long pos;
 
-    valuePtr1 = valuePtr2 = NULL;
-    if (colPtr->vector != NULL) {
-        valuePtr1 = colPtr->vector + rowPtr1->offset;
-        if (IsEmptyValue(valuePtr1)) {
-            valuePtr1 = NULL;
+        if (indexPtr->numUpdates++ >= TABLE_INDEX_MAX_UPDATES) {
+            ClearIndex(indexPtr);
+            indexPtr->flags |= TABLE_INDEX_DIRTY;
+            return;
         }
-        valuePtr2 = colPtr->vector + rowPtr2->offset;
-        if (IsEmptyValue(valuePtr2)) {
-            valuePtr2 = NULL;
-        }
-    }
-    if (IsEmptyValue(valuePtr1)) {
-        if (IsEmptyValue(valuePtr2)) {
-            return 0;
+        if (indexPtr->numRows >= indexPtr->numAllocated) {
+            indexPtr->numAllocated += indexPtr->numAllocated;
+            indexPtr->rows = Blt_AssertRealloc(indexPtr->rows, 
+                sizeof(Row *) * indexPtr->numAllocated);
         }
-        return 1;
-    } else if (IsEmptyValue(valuePtr2)) {
-        return -1;
-    }
-    if (valuePtr1->datum.d < valuePtr2->datum.d) {
-        return -1;
-    } else if (valuePtr1->datum.d > valuePtr2->datum.d) {
-        return 1;
+        pos = SearchIndex(indexPtr, colPtr, valuePtr, rowPtr, TRUE);
+        memmove(indexPtr->rows + pos + 1, indexPtr->rows + pos,
+                (indexPtr->numRows - pos) * sizeof(Row *));
+        indexPtr->rows[pos] = rowPtr;
+        indexPtr->numRows++;
     }
-    return 0;
 }
 
-static int
-CompareRows(void *a, void *b)
+static void
+IndexMarkDirty(Column *colPtr)
 {
-    Row *rowPtr1, *rowPtr2;
-    size_t i;
-    int result;
-
-    rowPtr1 = *(Row **)a;
-    rowPtr2 = *(Row **)b;
-    for (i = 0; i < sortData.numColumns; i++) {
-        BLT_TABLE_SORT_ORDER *sp;
-
-        sp = sortData.order + i;
-        result = (*sp->cmpProc)(sp->clientData, sp->column, rowPtr1, rowPtr2);
-        if (result != 0) {
-            return (sortData.flags & TABLE_SORT_DECREASING) ? -result : result;
-        }
+    if ((colPtr->indexPtr != NULL) && 
+        ((colPtr->indexPtr->flags & TABLE_INDEX_DIRTY) == 0)) {
+        ClearIndex(colPtr->indexPtr);
+        colPtr->indexPtr->flags |= TABLE_INDEX_DIRTY;
     }
-    result = rowPtr1->index - rowPtr2->index;
-    return (sortData.flags & TABLE_SORT_DECREASING) ? -result : result;
 }
 
-
-BLT_TABLE_COMPARE_PROC *
-blt_table_get_compare_proc(Table *tablePtr, Column *colPtr, unsigned int flags)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NewTableObject --
+ *
+ *      Creates and initializes a new table object. 
+ *
+ * Results:
+ *      Returns a pointer to the new object is successful, NULL otherwise.
+ *      If a table object can't be generated, interp->result will contain
+ *      an error message.
+ *
+ * -------------------------------------------------------------------------- 
+ */
+static TableObject *
+NewTableObject(void)
 {
-    BLT_TABLE_COMPARE_PROC *proc;
+    TableObject *corePtr;
 
-    if ((flags & TABLE_SORT_TYPE_MASK) == TABLE_SORT_AUTO) {
-        switch (colPtr->type) {
-        case TABLE_COLUMN_TYPE_INT64:
-            proc = CompareInt64s;
-            break;
+    corePtr = Blt_Calloc(1, sizeof(TableObject));
+    if (corePtr == NULL) {
+        return NULL;
+    }
+    corePtr->clients = Blt_Chain_Create();
 
-        case TABLE_COLUMN_TYPE_LONG:
-        case TABLE_COLUMN_TYPE_BOOLEAN:
-            proc = CompareLongs;
-            break;
+    Blt_InitHashTableWithPool(&corePtr->columns.labelTable, BLT_STRING_KEYS);
+    Blt_InitHashTableWithPool(&corePtr->rows.labelTable, BLT_STRING_KEYS);
+    corePtr->columns.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
+    corePtr->columns.nextColumnId = 1;
+    corePtr->rows.freeList = Blt_Chain_Create();
+    corePtr->rows.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
+    corePtr->rows.nextRowId = 1;
+    return corePtr;
+}
 
-        case TABLE_COLUMN_TYPE_TIME:
-        case TABLE_COLUMN_TYPE_DOUBLE:
-            proc = CompareDoubles;
-            break;
-        case TABLE_COLUMN_TYPE_STRING:
-        default:
-            proc = CompareDictionaryStrings;
-            break;
-        }
-    } else {
-        switch (flags & TABLE_SORT_TYPE_MASK) {
-        case TABLE_SORT_DICTIONARY:
-            proc = CompareDictionaryStrings;
-            break;
-        default:
-        case TABLE_SORT_ASCII:
-            if (flags & TABLE_SORT_IGNORECASE) {
-                proc = CompareAsciiStringsIgnoreCase;
-            } else {
-                proc = CompareAsciiStrings;
-            }
-            break;
-        }
+static void
+DestroyTraces(Table *tablePtr)
+{
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+
+    for (hPtr = Blt_FirstHashEntry(&tablePtr->traces, &iter); hPtr != NULL; 
+         hPtr = Blt_NextHashEntry(&iter)) {
+        Trace *tracePtr;
+
+        tracePtr = Blt_GetHashValue(hPtr);
+        blt_table_delete_trace(tablePtr, tracePtr);
     }
-    return proc;
+    Blt_Chain_Destroy(tablePtr->readTraces);
+    Blt_Chain_Destroy(tablePtr->writeTraces);
+    Blt_DeleteHashTable(&tablePtr->traces);
 }
 
-static Row **
-SortRows(Rows *rowsPtr, QSortCompareProc *proc)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DoTrace --
+ *
+ *      Fires a trace set by a client of the table object.  Trace
+ *      procedures should return a standard TCL result.
+ *
+ *         TCL_OK       procedure executed successfully.
+ *         TCL_ERROR    procedure failed.
+ *         TCL_BREAK    don't execute any further trace procedures.
+ *         TCL_CONTINUE treat like TCL_OK.
+ *
+ *      A trace procedure can in turn trigger more traces.  Traces are
+ *      prohibited from recursively reentering their own trace procedures.
+ *      A hash table in the trace structure tracks the cells currently
+ *      actively traced.  If a cell is already being traced, the trace
+ *      procedure is not called and TCL_OK is blindly returned.
+ *
+ * Results:
+ *      Returns the result of trace procedure.  If the trace is already
+ *      active, then TCL_OK is returned.
+ *
+ * Side Effects:
+ *      Traces on the table location may be fired.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+DoTrace(Trace *tracePtr, BLT_TABLE_TRACE_EVENT *eventPtr)
 {
-    size_t i;
-    Row **map;
+    int result;
 
-    /* Make a copy of the current row map. */
-    map = Blt_Malloc(sizeof(Row *) * rowsPtr->numAllocated);
-    if (map == NULL) {
-        return NULL;
-    }
-    for (i = 0; i < rowsPtr->numAllocated; i++) {
-        map[i] = rowsPtr->map[i];
+    /* 
+     * Check for individual traces on a cell.  Each trace has a hash table
+     * that tracks what cells are actively being traced. This is to prevent
+     * traces from triggering recursive callbacks.
+     */
+    Tcl_Preserve(tracePtr);
+    tracePtr->flags |= TABLE_TRACE_ACTIVE;
+    result = (*tracePtr->proc)(tracePtr->clientData, eventPtr);
+    tracePtr->flags &= ~TABLE_TRACE_ACTIVE;
+    Tcl_Release(tracePtr);
+
+    if (result == TCL_ERROR) {
+        Blt_Warn("error in trace callback: %s\n", 
+                 Tcl_GetString(Tcl_GetObjResult(eventPtr->interp)));
+        Tcl_BackgroundError(eventPtr->interp);
     }
-    /* Sort the map and return it. */
-    qsort((char *)map, rowsPtr->numUsed, sizeof(Row *), proc);
-    return map;
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * TraceIdleProc --
+ *
+ *      Used to invoke a table trace handler routines at some idle point.
+ *      This routine is called from the TCL event loop.  Errors generated
+ *      by the event handler routines are backgrounded.
+ *      
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+TraceIdleProc(ClientData clientData)
+{
+    Trace *tracePtr = clientData;
+
+    tracePtr->flags &= ~TABLE_TRACE_PENDING;
+
+    /* Protect the notifier in case it's deleted by the callback. */
+    Tcl_Preserve(tracePtr);
+    DoTrace(tracePtr, &tracePtr->event);
+    Tcl_Release(tracePtr);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NotifyIdleProc --
+ *
+ *      Used to invoke event handler routines at some idle point.  This
+ *      routine is called from the TCL event loop.  Errors generated by the
+ *      event handler routines are backgrounded.
+ *      
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
 static void
-ReplaceRowMap(Rows *rowsPtr, Row **map)
+NotifyIdleProc(ClientData clientData)
 {
-    size_t i;
+    Notifier *notifierPtr = clientData;
+    int result;
 
-    if (rowsPtr->numUsed == 0) {
-        return;
+    notifierPtr->flags &= ~TABLE_NOTIFY_PENDING;
+
+    /* Protect the notifier in case it's deleted by the callback. */
+    Tcl_Preserve(notifierPtr);
+    notifierPtr->flags |= TABLE_NOTIFY_ACTIVE;
+    result = (*notifierPtr->proc)(notifierPtr->clientData, &notifierPtr->event);
+    notifierPtr->flags &= ~TABLE_NOTIFY_ACTIVE;
+    if (result == TCL_ERROR) {
+        Tcl_BackgroundError(notifierPtr->interp);
     }
-    /* Rethread list according to the map. */
-    for (i = 0; i < rowsPtr->numUsed; i++) {
-        Row *rowPtr;
-        Row *prevPtr, *nextPtr;
+    Tcl_Release(notifierPtr);
+}
 
-        prevPtr = (i > 0) ? map[i-1] : NULL;
-        nextPtr = ((i+i) < rowsPtr->numUsed) ? map[i+1] : NULL;
-        rowPtr = map[i];
-        rowPtr->prevPtr = prevPtr;
-        rowPtr->nextPtr = nextPtr;
-        rowPtr->index = i;
+static void
+FreeNotifier(Notifier *notifierPtr) 
+{
+    if (notifierPtr->tag != NULL) {
+        Blt_Free(notifierPtr->tag);
     }
-    rowsPtr->headPtr = map[0];
-    rowsPtr->tailPtr = map[rowsPtr->numUsed-1];
-    if (rowsPtr->map != NULL) {
-        Blt_Free(rowsPtr->map);
+    if (notifierPtr->link != NULL){
+        Blt_Chain_DeleteLink(notifierPtr->chain, notifierPtr->link);
     }
-    rowsPtr->map = map;
+    Blt_Free(notifierPtr);
 }
 
 static void
-ReplaceColumnMap(Columns *columnsPtr, Column **map)
+DestroyNotifiers(Table *tablePtr, Blt_Chain chain)
 {
-    size_t i;
-    Column *prevPtr;
-    Column *colPtr;
+    Blt_ChainLink link;
 
-    if (columnsPtr->numUsed == 0) {
-        return;
-    }
-    /* Rethread column list according to the map. */
-    prevPtr = NULL;
-    for (i = 0; i < (columnsPtr->numUsed - 1); i++) {
-        colPtr = map[i];
-        colPtr->index = i;
-        colPtr->nextPtr = map[i + 1];
-        colPtr->prevPtr = prevPtr;
-        prevPtr =  map[i];
-    }
-    colPtr = map[i];
-    colPtr->nextPtr = NULL;
-    colPtr->prevPtr = prevPtr;
-    columnsPtr->headPtr = map[0];
-    columnsPtr->tailPtr = colPtr;
-    if (columnsPtr->map != NULL) {
-        Blt_Free(columnsPtr->map);
+    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
+         link = Blt_Chain_NextLink(link)) {
+        Notifier *notifierPtr;
+
+        notifierPtr = Blt_Chain_GetValue(link);
+        notifierPtr->link = NULL;
+        blt_table_delete_notifier(tablePtr, notifierPtr);
     }
-    columnsPtr->map = map;
+    Blt_Chain_Destroy(chain);
 }
 
-static int
-MoveRows(Rows *rowsPtr, Row *destPtr, Row *firstPtr, Row *lastPtr, int after)
+
+static void
+FreeRows(TableObject *corePtr)
 {
-    if (rowsPtr->flags & REINDEX) {
-        ResetRowMap(rowsPtr);
-    }
-    /* Check is destination outside the range of rows to be moved. */
-    assert ((destPtr->index < firstPtr->index) ||
-            (destPtr->index > lastPtr->index));
+    Rows *rowsPtr;
 
-    /* Unlink the sub-list from the list of rows. */
-    if (rowsPtr->headPtr == firstPtr) {
-        rowsPtr->headPtr = lastPtr->nextPtr;
-        lastPtr->nextPtr->prevPtr = NULL;
-    }
-    if (rowsPtr->tailPtr == lastPtr) {
-        rowsPtr->tailPtr = lastPtr->prevPtr;
-        lastPtr->prevPtr->nextPtr = NULL;
+    rowsPtr = &corePtr->rows;
+    Blt_DeleteHashTable(&rowsPtr->labelTable);
+    Blt_Pool_Destroy(rowsPtr->pool);
+    if (rowsPtr->freeList != NULL) {
+        Blt_Chain_Destroy(rowsPtr->freeList);
     }
-    if (lastPtr->nextPtr != NULL) {
-        lastPtr->nextPtr->prevPtr = firstPtr->prevPtr;
-    }
-    if (firstPtr->prevPtr != NULL) {
-        firstPtr->prevPtr->nextPtr = lastPtr->nextPtr;
-    }
-    firstPtr->prevPtr = lastPtr->nextPtr = NULL;
-    /* Now attach the detached list to the destination. */
-    if (after) {
-        if (destPtr->nextPtr == NULL) {
-            rowsPtr->tailPtr = lastPtr; /* Append to the end. */
-        } else {
-            destPtr->nextPtr->prevPtr = lastPtr;
-        }
-        firstPtr->prevPtr = destPtr;
-        lastPtr->nextPtr = destPtr->nextPtr;
-        destPtr->nextPtr = firstPtr;
-    } else {
-        if (destPtr->prevPtr == NULL) {
-            rowsPtr->headPtr = firstPtr; /* Prepend to the beginning. */
-        } else {
-            destPtr->prevPtr->nextPtr = firstPtr;
-        }
-        firstPtr->prevPtr = destPtr->prevPtr;
-        lastPtr->nextPtr = destPtr;
-        destPtr->prevPtr = lastPtr;
+    if (rowsPtr->map != NULL) {
+        Blt_Free(rowsPtr->map);
+        rowsPtr->map = NULL;
     }
-    /* FIXME: You don't have to reset the entire map. */
-    ResetRowMap(rowsPtr);
-    return TRUE;
+    FreeRowOffsetMap(rowsPtr);
+    rowsPtr->numAllocated = rowsPtr->numUsed = 0;
 }
 
-static int
-MoveColumns(Columns *columnsPtr, Column *destPtr, Column *firstPtr, 
-            Column *lastPtr, int after)
+static void
+FreeColumns(TableObject *corePtr)
 {
-    if (columnsPtr->flags & REINDEX) {
-        ResetColumnMap(columnsPtr);
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+    Column *colPtr;
+    Columns *columnsPtr;
+
+    columnsPtr = &corePtr->columns;
+    for (colPtr = columnsPtr->headPtr; colPtr != NULL; 
+         colPtr = colPtr->nextPtr) {
+        FreeIndex(colPtr);
+        FreeColumnStats(colPtr);
+        FreePackedColumn(colPtr);
+        FreeEncodedColumn(colPtr);
+        FreeColumnValues(&corePtr->rows, colPtr);
     }
-    assert (firstPtr->index <= lastPtr->index);
-    /* Unlink the sub-list from the list of columns. */
-    if (columnsPtr->headPtr == firstPtr) {
-        columnsPtr->headPtr = lastPtr->nextPtr;
-        lastPtr->nextPtr->prevPtr = NULL;
-    } else {
-        firstPtr->prevPtr->nextPtr = lastPtr->nextPtr;
+    for (hPtr = Blt_FirstHashEntry(&columnsPtr->labelTable, &iter); 
+         hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+        Blt_HashTable *tablePtr;
+        
+        tablePtr = Blt_GetHashValue(hPtr);
+        Blt_DeleteHashTable(tablePtr);
+        Blt_Free(tablePtr);
     }
-    if (columnsPtr->tailPtr == lastPtr) {
-        columnsPtr->tailPtr = firstPtr->prevPtr;
-        firstPtr->prevPtr->nextPtr = NULL;
-    } else {
-        lastPtr->nextPtr->prevPtr = firstPtr->prevPtr;
+    Blt_DeleteHashTable(&columnsPtr->labelTable);
+    if (columnsPtr->pool != NULL) {
+        Blt_Pool_Destroy(columnsPtr->pool);
     }
-    firstPtr->prevPtr = lastPtr->nextPtr = NULL;
-
-    /* Now attach the detached list to the destination. */
-    if (after) { 
-        /* [a]->[dest]->[b] */
-        /*            [first]->[last] */
-        if (destPtr->nextPtr == NULL) {
-            assert(destPtr == columnsPtr->tailPtr);
-            columnsPtr->tailPtr = lastPtr; /* Append to the end. */
-        } else {
-            destPtr->nextPtr->prevPtr = lastPtr;
-        }
-        lastPtr->nextPtr = destPtr->nextPtr;
-        destPtr->nextPtr = firstPtr;
-        firstPtr->prevPtr = destPtr;
-    } else {
-        /*           [a]->[dest]->[b] */
-        /* [first]->[last] */
-        if (destPtr->prevPtr == NULL) {
-            columnsPtr->headPtr = firstPtr;
-        } else {
-            destPtr->prevPtr->nextPtr = firstPtr;
-        }
-        firstPtr->prevPtr = destPtr->prevPtr;
-        destPtr->prevPtr = lastPtr;
-        lastPtr->nextPtr = destPtr;
+    if (columnsPtr->map != NULL) {
+        Blt_Free(columnsPtr->map);
+        columnsPtr->map = NULL;
     }
-    /* FIXME: You don't have to reset the entire map. */
-    ResetColumnMap(columnsPtr);
-    return TRUE;
+    columnsPtr->numAllocated = columnsPtr->numUsed = 0;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ParseDumpRecord --
+ * DestroyTableObject --
  *
- *      Gets the next full record in the dump string, returning the
- *      record as a list. Blank lines and comments are ignored.
+ *      Destroys the table object.  This is the final clean up of the
+ *      object.  The object's entry is removed from the hash table of
+ *      tables.
  *
  * Results: 
- *      TCL_RETURN      The end of the string is reached.
- *      TCL_ERROR       An error occurred and an error message 
- *                      is left in the interpreter result.  
- *      TCL_OK          The next record has been successfully parsed.
+ *      None.
  *
- *---------------------------------------------------------------------------
+ * -------------------------------------------------------------------------- 
  */
-static int
-ParseDumpRecord(
-    Tcl_Interp *interp,
-    char **sp,                          /* (in/out) points to current
-                                         * location in in dump
-                                         * string. Updated after parsing
-                                         * record. */
-    RestoreData *restorePtr)
+static void
+DestroyTableObject(TableObject *corePtr)
 {
-    char *entry, *eol;
-    char saved;
-    int result;
-
-    restorePtr->argc = 0;
-    entry = *sp;
-    /* Get first line, ignoring blank lines and comments. */
-    for (;;) {
-        char *first;
+    corePtr->flags |= TABLE_DESTROYED;
 
-        first = NULL;
-        restorePtr->numLines++;
-        /* Find the end of the first line. */
-        for (eol = entry; (*eol != '\n') && (*eol != '\0'); eol++) {
-            if ((first == NULL) && (!isspace(UCHAR(*eol)))) {
-                first = eol;    /* Track first non-whitespace
-                                 * character. */
-            }
-        }
-        if (first == NULL) {
-            if (*eol == '\0') {
-                return TCL_RETURN;
-            }
-        } else if (*first != '#') {
-            break;                      /* Not a comment or blank line. */
-        }
-        entry = eol + 1;
-    }
-    saved = *eol;
-    *eol = '\0';
-    while (!Tcl_CommandComplete(entry)) {
-        *eol = saved;
-        if (*eol == '\0') {
-            Tcl_AppendResult(interp, "incomplete dump record: \"", entry, 
-                "\"", (char *)NULL);
-            return TCL_ERROR;           /* Found EOF (incomplete entry) or
-                                         * error. */
-        }
-        /* Get the next line. */
-        for (eol = eol + 1; (*eol != '\n') && (*eol != '\0'); eol++) {
-            /*empty*/
-        }
-        restorePtr->numLines++;
-        saved = *eol;
-        *eol = '\0';
-    }
-    if (entry == eol) {
-        return TCL_RETURN;
+    assert(Blt_Chain_GetLength(corePtr->clients) == 0);
+    Blt_Chain_Destroy(corePtr->clients);
+    FreeBindings(corePtr, NULL);
+    if (corePtr->bindings != NULL) {
+        Blt_Chain_Destroy(corePtr->bindings);
     }
-    result = Tcl_SplitList(interp, entry, &restorePtr->argc, &restorePtr->argv);
-    *eol = saved;
-    *sp = eol + 1;
-    return result;
+
+    FreeColumns(corePtr);
+    FreeRows(corePtr);
+    ReleaseSnapshots(corePtr);
+    ResetValue(&corePtr->scratch);
+    Blt_Free(corePtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ReadDumpRecord --
+ * TableInterpDeleteProc --
  *
- *      Reads the next full record from the given channel, returning the
- *      record as a list. Blank lines and comments are ignored.
+ *      This is called when the interpreter hosting the table object is
+ *      deleted from the interpreter.
  *
- * Results: 
- *      TCL_RETURN      The end of the file has been reached.
- *      TCL_ERROR       A read error has occurred and an error message 
- *                      is left in the interpreter result.  
- *      TCL_OK          The next record has been successfully parsed.
+ * Results:
+ *      None.
+ *
+ * Side effects:
+ *      Destroys all remaining tables and removes the hash table used to
+ *      register table names.
  *
  *---------------------------------------------------------------------------
  */
-static int
-ReadDumpRecord(Tcl_Interp *interp, Tcl_Channel channel, RestoreData *restorePtr)
+/* ARGSUSED */
+static void
+TableInterpDeleteProc(ClientData clientData, Tcl_Interp *interp)
 {
-    int result;
-    Tcl_DString ds;
+    InterpData *dataPtr;
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch cursor;
+    
+    dataPtr = clientData;
+    for (hPtr = Blt_FirstHashEntry(&dataPtr->clientTable, &cursor);
+         hPtr != NULL; hPtr = Blt_NextHashEntry(&cursor)) {
+        Blt_Chain chain;
+        Blt_ChainLink link, next;
 
-    Tcl_DStringInit(&ds);
-    /* Get first line, ignoring blank lines and comments. */
-    for (;;) {
-        const char *cp;
-        int numChars;
+        chain = Blt_GetHashValue(hPtr);
+        for (link = Blt_Chain_FirstLink(chain); link != NULL; link = next) {
+            Table *tablePtr;
 
-        Tcl_DStringSetLength(&ds, 0);
-        numChars = Tcl_Gets(channel, &ds);
-        if (numChars < 0) {
-            if (Tcl_Eof(channel)) {
-                return TCL_RETURN;
-            }
-            return TCL_ERROR;
-        }
-        restorePtr->numLines++;
-        for (cp = Tcl_DStringValue(&ds); *cp != '\0'; cp++) {
-            if (!isspace(UCHAR(*cp))) {
-                break;
-            }
-        }
-        if ((*cp != '\0') && (*cp != '#')) {
-            break;              /* Not a comment or blank line. */
+            next = Blt_Chain_NextLink(link);
+            tablePtr = Blt_Chain_GetValue(link);
+            tablePtr->link2 = NULL;
+            /* Don't destroy the client here. Let the client code close the
+             * table. */
         }
+        Blt_Chain_Destroy(chain);
     }
+    Blt_DeleteHashTable(&dataPtr->clientTable);
+    Blt_DeleteHashTable(&dataPtr->bindingTable);
+    Tcl_DeleteAssocData(interp, TABLE_THREAD_KEY);
+    Blt_Free(dataPtr);
+}
 
-    Tcl_DStringAppend(&ds, "\n", 1);
-    while (!Tcl_CommandComplete(Tcl_DStringValue(&ds))) {
-        int numChars;
-
-        /* Process additional lines if needed */
-        numChars = Tcl_Gets(channel, &ds);
-        if (numChars < 0) {
-            Tcl_AppendResult(interp, "error reading file: ", 
-                             Tcl_PosixError(interp), (char *)NULL);
-            Tcl_DStringFree(&ds);
-            return TCL_ERROR;           /* Found EOF (incomplete entry) or
-                                         * error. */
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetInterpData --
+ *
+ *      Creates or retrieves data associated with tuple data objects for a
+ *      particular interpreter.
+ *
+ * Results:
+ *      Returns a pointer to the tuple interpreter data.
+ *
+ * -------------------------------------------------------------------------- 
+ */
+static InterpData *
+GetInterpData(Tcl_Interp *interp)
+{
+    Tcl_InterpDeleteProc *proc;
+    InterpData *dataPtr;
+
+    dataPtr = (InterpData *)
+        Tcl_GetAssocData(interp, TABLE_THREAD_KEY, &proc);
+    if (dataPtr == NULL) {
+        dataPtr = Blt_AssertMalloc(sizeof(InterpData));
+        dataPtr->interp = interp;
+        dataPtr->numThreads = 1;
+        Tcl_SetAssocData(interp, TABLE_THREAD_KEY, TableInterpDeleteProc, 
+                dataPtr);
+        Blt_InitHashTable(&dataPtr->clientTable, BLT_STRING_KEYS);
+        Blt_InitHashTable(&dataPtr->bindingTable, BLT_ONE_WORD_KEYS);
+    }
+    return dataPtr;
+}
+
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_threads, blt_table_get_threads --
+ *
+ *      Sets or gets the # of threads used to scan and sort large tables
+ *      in the interpreter.  One (the default) means that everything is
+ *      done in the calling thread.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_set_threads(Tcl_Interp *interp, int numThreads)
+{
+    InterpData *dataPtr;
+
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    if (numThreads > TABLE_MAX_THREADS) {
+        numThreads = TABLE_MAX_THREADS;
+    }
+    dataPtr = GetInterpData(interp);
+    dataPtr->numThreads = numThreads;
+}
+
+int
+blt_table_get_threads(Tcl_Interp *interp)
+{
+    return GetInterpData(interp)->numThreads;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_num_workers --
+ *
+ *      Determines how many workers to split the given # of items among.
+ *      Each worker gets at least TABLE_WORKER_MIN_ITEMS items.
+ *
+ * Results:
+ *      Returns the # of workers.  One means the items should be processed
+ *      in the calling thread.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_num_workers(Table *tablePtr, long numItems)
+{
+    long numWorkers;
+
+#ifdef TCL_THREADS
+    if (tablePtr->interp == NULL) {
+        return 1;
+    }
+    numWorkers = numItems / TABLE_WORKER_MIN_ITEMS;
+    if (numWorkers > blt_table_get_threads(tablePtr->interp)) {
+        numWorkers = blt_table_get_threads(tablePtr->interp);
+    }
+#else
+    numWorkers = 1;
+#endif  /* TCL_THREADS */
+    return (numWorkers < 1) ? 1 : (int)numWorkers;
+}
+
+#ifdef TCL_THREADS
+/*
+ * WorkerPool --
+ *
+ *      Threads that run the chunks of blt_table_run_workers.  The threads
+ *      are created the first time they are needed (only if more than one
+ *      thread is configured) and then wait for the next job, so sorting or
+ *      scanning a table doesn't create and join threads each time.  The
+ *      pool is shared by all interpreters and runs one job at a time.
+ *      The threads are stopped when TCL exits.
+ */
+typedef struct {
+    BLT_TABLE_WORKER_PROC *proc;        /* Procedure to call. NULL if the
+                                         * thread has no chunk to do. */
+    ClientData clientData;
+    long first, last;                   /* Range of items of the chunk. */
+    int worker;                         /* Index of the chunk. */
+    Tcl_ThreadId threadId;
+} PoolWorker;
+
+typedef struct {
+    PoolWorker workers[TABLE_MAX_THREADS];
+    int numThreads;                     /* # of threads running.  Thread
+                                         * i runs workers[i + 1]. */
+    int numPending;                     /* # of chunks of the current job
+                                         * not finished. */
+    int isBusy;                         /* Indicates a job is running. */
+    int isShutdown;                     /* Indicates the threads should
+                                         * exit. */
+    Tcl_Condition workCond;             /* Signaled when a job starts or
+                                         * the pool shuts down. */
+    Tcl_Condition doneCond;             /* Signaled when the last chunk
+                                         * of a job is done. */
+} WorkerPool;
+
+static WorkerPool workerPool;
+TCL_DECLARE_MUTEX(poolMutex)
+
+static Tcl_ThreadCreateType
+PoolThreadProc(ClientData clientData)
+{
+    PoolWorker *workerPtr = clientData;
+
+    Tcl_MutexLock(&poolMutex);
+    for (;;) {
+        while ((workerPtr->proc == NULL) && (!workerPool.isShutdown)) {
+            Tcl_ConditionWait(&workerPool.workCond, &poolMutex, NULL);
+        }
+        if (workerPool.isShutdown) {
+            break;
+        }
+        Tcl_MutexUnlock(&poolMutex);
+        (*workerPtr->proc)(workerPtr->clientData, workerPtr->first, 
+                           workerPtr->last, workerPtr->worker);
+        Tcl_MutexLock(&poolMutex);
+        workerPtr->proc = NULL;
+        workerPool.numPending--;
+        if (workerPool.numPending == 0) {
+            Tcl_ConditionNotify(&workerPool.doneCond);
         }
-        restorePtr->numLines++;
-        Tcl_DStringAppend(&ds, "\n", 1);
     }
-    result = Tcl_SplitList(interp, Tcl_DStringValue(&ds), &restorePtr->argc, 
-                           &restorePtr->argv);
-    Tcl_DStringFree(&ds);
-    return result;
+    Tcl_MutexUnlock(&poolMutex);
+    TCL_THREAD_CREATE_RETURN;
 }
 
 static void
-RestoreError(Tcl_Interp *interp, RestoreData *restorePtr)
+PoolExitProc(ClientData clientData)
 {
-    Tcl_DString ds;
+    int i, numThreads;
 
-    Tcl_DStringInit(&ds);
-    Tcl_DStringGetResult(interp, &ds);
-    Tcl_AppendResult(interp, restorePtr->fileName, ":", 
-        Blt_Ltoa(restorePtr->numLines), ": error: ", Tcl_DStringValue(&ds), 
-        (char *)NULL);
-    Tcl_DStringFree(&ds);
+    Tcl_MutexLock(&poolMutex);
+    workerPool.isShutdown = TRUE;
+    numThreads = workerPool.numThreads;
+    Tcl_ConditionNotify(&workerPool.workCond);
+    Tcl_MutexUnlock(&poolMutex);
+    for (i = 1; i <= numThreads; i++) {
+        int result;
+
+        Tcl_JoinThread(workerPool.workers[i].threadId, &result);
+    }
+    workerPool.numThreads = 0;
+    Tcl_ConditionFinalize(&workerPool.workCond);
+    Tcl_ConditionFinalize(&workerPool.doneCond);
 }
 
+/* 
+ * Starts threads until the pool has at least the given number.  Called
+ * with the pool locked.  Returns the # of threads running, which may be
+ * more or (if a thread can't be created) fewer than asked for.
+ */
 static int
-RestoreHeader(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+GrowPool(int numThreads)
 {
-    long numCols, numRows, count;
-    int64_t time;
+    if (numThreads >= TABLE_MAX_THREADS) {
+        numThreads = TABLE_MAX_THREADS - 1;
+    }
+    while (workerPool.numThreads < numThreads) {
+        PoolWorker *workerPtr;
 
-    /* i rows columns ctime mtime */
-    if (restorePtr->argc != 5) {
-        RestoreError(interp, restorePtr);
-        Tcl_AppendResult(interp, "wrong # of elements in restore header.", 
-                (char *)NULL);
-        return TCL_ERROR;
-    }   
-    if (Blt_GetCount(interp, restorePtr->argv[1], COUNT_POS, &count)
-        != TCL_OK) {
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
+        workerPtr = workerPool.workers + workerPool.numThreads + 1;
+        workerPtr->proc = NULL;
+        if (Tcl_CreateThread(&workerPtr->threadId, PoolThreadProc, workerPtr,
+                TCL_THREAD_STACK_DEFAULT, TCL_THREAD_JOINABLE) != TCL_OK) {
+            break;
+        }
+        if (workerPool.numThreads == 0) {
+            Tcl_CreateExitHandler(PoolExitProc, NULL);
+        }
+        workerPool.numThreads++;
     }
-    /* FIXME: What are you doing w/ numRows and numCols? */
-    numRows = count;
-    if (Blt_GetCount(interp, restorePtr->argv[2], COUNT_POS, &count)!=TCL_OK) {
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
+    return workerPool.numThreads;
+}
+#endif  /* TCL_THREADS */
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_run_workers --
+ *
+ *      Splits the items into numWorkers contiguous ranges and calls proc
+ *      for each range.  The first range is handled by the calling thread,
+ *      the others by the threads of the worker pool.  Returns when all the
+ *      ranges are done.  If the pool is already running a job or doesn't
+ *      have enough threads, the remaining ranges are handled by the
+ *      calling thread, so the results are always the same.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_run_workers(int numWorkers, long numItems, 
+                      BLT_TABLE_WORKER_PROC *proc, ClientData clientData)
+{
+#ifdef TCL_THREADS
+    int i, numPooled;
+
+    if (numWorkers > TABLE_MAX_THREADS) {
+        numWorkers = TABLE_MAX_THREADS;
+    }
+    numPooled = 0;
+    if (numWorkers > 1) {
+        Tcl_MutexLock(&poolMutex);
+        if ((!workerPool.isBusy) && (!workerPool.isShutdown)) {
+            numPooled = MIN(GrowPool(numWorkers - 1), numWorkers - 1);
+            workerPool.isBusy = (numPooled > 0);
+            for (i = 1; i <= numPooled; i++) {
+                PoolWorker *workerPtr;
+
+                workerPtr = workerPool.workers + i;
+                workerPtr->clientData = clientData;
+                workerPtr->worker = i;
+                workerPtr->first = numItems * i / numWorkers;
+                workerPtr->last = numItems * (i + 1) / numWorkers;
+                workerPtr->proc = proc;
+            }
+            workerPool.numPending = numPooled;
+            if (numPooled > 0) {
+                Tcl_ConditionNotify(&workerPool.workCond);
+            }
+        }
+        Tcl_MutexUnlock(&poolMutex);
     }
-    numCols = count;
-    if ((restorePtr->flags & TABLE_RESTORE_OVERWRITE) == 0) {
-        numRows += restorePtr->numRows;
-        numCols += restorePtr->numCols;
+    if (numWorkers < 1) {
+        numWorkers = 1;
     }
-    if (Blt_GetInt64(interp, restorePtr->argv[3], &time) != TCL_OK){
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
+    /* Handle the first range and any ranges without a thread. */
+    (*proc)(clientData, 0, numItems / numWorkers, 0);
+    for (i = numPooled + 1; i < numWorkers; i++) {
+        (*proc)(clientData, numItems * i / numWorkers, 
+                numItems * (i + 1) / numWorkers, i);
     }
-    restorePtr->ctime = time;
-    if (Blt_GetInt64(interp, restorePtr->argv[4], &time) != TCL_OK){
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
+    if (numPooled > 0) {
+        Tcl_MutexLock(&poolMutex);
+        while (workerPool.numPending > 0) {
+            Tcl_ConditionWait(&workerPool.doneCond, &poolMutex, NULL);
+        }
+        workerPool.isBusy = FALSE;
+        Tcl_MutexUnlock(&poolMutex);
     }
-    restorePtr->mtime = time;
-    return TCL_OK;
+#else
+    (*proc)(clientData, 0, numItems, 0);
+#endif  /* TCL_THREADS */
 }
 
-static int
-RestoreColumn(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+const char *
+blt_table_column_type_to_name(BLT_TABLE_COLUMN_TYPE type)
 {
-    long index;
-    Column *colPtr;
-    int type;
-    const char *label;
-    int isNew;
-    Blt_HashEntry *hPtr;
+    return valueTypes[type];
+}
 
-    /* c index label type ?tagList? */
-    if ((restorePtr->argc < 4) || (restorePtr->argc > 5)) {
-        RestoreError(interp, restorePtr);
-        Tcl_AppendResult(interp, "wrong # elements in restore column entry", 
-                (char *)NULL);
-        return TCL_ERROR;
-    }   
-    if (Blt_GetLong(interp, restorePtr->argv[1], &index) != TCL_OK) {
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
+/*
+ * RowTag --
+ *
+ *      Represents a row tag.  The tag is a bitmap indexed by row offset,
+ *      so testing, setting, or clearing a tag for a row is a bit
+ *      operation rather than a hash table lookup.  The rows with the tag
+ *      are found by walking the set bits.  Since row offsets are reused,
+ *      the bits of a deleted row are cleared from every client's tags.
+ */
+typedef struct {
+    unsigned int *bits;                 /* Bitmap indexed by row
+                                         * offset. */
+    long numWords;                      /* # of words in the bitmap. */
+    long numRows;                       /* # of rows with the tag. */
+    Blt_Chain chain;                    /* List of the tagged rows.  Built
+                                         * on demand and freed whenever
+                                         * the tag changes.  May be
+                                         * NULL. */
+} RowTag;
+
+#define RowTagHas(t,o) \
+    ((((o) >> 5) < (t)->numWords) && \
+     ((t)->bits[(o) >> 5] & (1U << ((o) & 31))))
+
+static void
+InvalidateRowTag(RowTag *tagPtr)
+{
+    if (tagPtr->chain != NULL) {
+        Blt_Chain_Destroy(tagPtr->chain);
+        tagPtr->chain = NULL;
     }
-    label = restorePtr->argv[2];
-    colPtr = blt_table_get_column_by_label(table, label);
-    if ((colPtr == NULL) || 
-        ((restorePtr->flags & TABLE_RESTORE_OVERWRITE) == 0)) {
-        colPtr = blt_table_create_column(interp, table, label);
-        if (colPtr == NULL) {
-            RestoreError(interp, restorePtr);
-            Tcl_AppendResult(interp, "can't append column \"", label, "\"",
-                             (char *)NULL);
-            return TCL_ERROR;
-        }
+}
+
+static void
+FreeRowTag(RowTag *tagPtr)
+{
+    InvalidateRowTag(tagPtr);
+    if (tagPtr->bits != NULL) {
+        Blt_Free(tagPtr->bits);
     }
-    hPtr = Blt_CreateHashEntry(&restorePtr->colIndices,(intptr_t)index, &isNew);
-    Blt_SetHashValue(hPtr, colPtr);
+    Blt_Free(tagPtr);
+}
 
-    type = blt_table_name_to_column_type(restorePtr->argv[3]);
-    if (type == TABLE_COLUMN_TYPE_UNKNOWN) {
-        RestoreError(interp, restorePtr);
-        Tcl_AppendResult(interp, "bad column type \"", restorePtr->argv[3], 
-                         "\"", (char *)NULL);
-        return TCL_ERROR;
+static void
+ResetRowTags(Blt_HashTable *tablePtr)
+{
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+
+    for (hPtr = Blt_FirstHashEntry(tablePtr, &iter); hPtr != NULL;
+         hPtr = Blt_NextHashEntry(&iter)) {
+        FreeRowTag(Blt_GetHashValue(hPtr));
     }
-    colPtr->type = type;
-    if ((restorePtr->argc == 5) && 
-        ((restorePtr->flags & TABLE_RESTORE_NO_TAGS) == 0)) {
-        int i, argc;
-        const char **argv;
+    Blt_DeleteHashTable(tablePtr);
+}
 
-        if (Tcl_SplitList(interp, restorePtr->argv[4], &argc, &argv)!= TCL_OK) {
-            RestoreError(interp, restorePtr);
-            return TCL_ERROR;
-        }
-        
-        for (i = 0; i < argc; i++) {
-            if (blt_table_set_column_tag(interp, table, colPtr, argv[i]) 
-                != TCL_OK) {
-                Tcl_Free((char *)argv);
-                return TCL_ERROR;
-            }
-        }
-        Tcl_Free((char *)argv);
+static RowTag *
+FindRowTag(Blt_HashTable *tablePtr, const char *tag)
+{
+    Blt_HashEntry *hPtr;
+
+    hPtr = Blt_FindHashEntry(tablePtr, tag);
+    if (hPtr == NULL) {
+        return NULL;
     }
-    return TCL_OK;
+    return Blt_GetHashValue(hPtr);
 }
 
-static int
-RestoreRow(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+static RowTag *
+GetRowTag(Blt_HashTable *tablePtr, const char *tag)
 {
-    BLT_TABLE_ROW row;
     Blt_HashEntry *hPtr;
-    const char *label;
     int isNew;
-    long index;
 
-    /* r index label ?tagList? */
-    if ((restorePtr->argc < 3) || (restorePtr->argc > 4)) {
-        RestoreError(interp, restorePtr);
-        Tcl_AppendResult(interp, "wrong # of elements in restore row entry", 
-                         (char *)NULL);
-        return TCL_ERROR;
-    }   
-    if (Blt_GetLong(interp, restorePtr->argv[1], &index) != TCL_OK) {
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
+    hPtr = Blt_CreateHashEntry(tablePtr, tag, &isNew);
+    if (isNew) {
+        Blt_SetHashValue(hPtr, Blt_AssertCalloc(1, sizeof(RowTag)));
     }
-    label = restorePtr->argv[2];
-    row = blt_table_get_row_by_label(table, label);
-    if ((row == NULL) || ((restorePtr->flags & TABLE_RESTORE_OVERWRITE) == 0)) {
-        row = blt_table_create_row(interp, table, label);
-        if (row == NULL) {
-            RestoreError(interp, restorePtr);
-            Tcl_AppendResult(interp, "can't append row \"", label, "\"",
-                     (char *)NULL);
-            return TCL_ERROR;
-        }
-    }
-    hPtr = Blt_CreateHashEntry(&restorePtr->rowIndices,(intptr_t)index, &isNew);
-    Blt_SetHashValue(hPtr, row);
-    if ((restorePtr->argc == 5) && 
-        ((restorePtr->flags & TABLE_RESTORE_NO_TAGS) == 0)) {
-        const char **argv;
-        int argc;
-        int i;
-
-        if (Tcl_SplitList(interp, restorePtr->argv[3], &argc, &argv)!= TCL_OK) {
-            RestoreError(interp, restorePtr);
-            return TCL_ERROR;
-        }
-        for (i = 0; i < argc; i++) {
-            if (blt_table_set_row_tag(interp, table, row, argv[i]) != TCL_OK) {
-                Tcl_Free((char *)argv);
-                return TCL_ERROR;
-            }
-        }
-        Tcl_Free((char *)argv);
-    }
-    return TCL_OK;
+    return Blt_GetHashValue(hPtr);
 }
 
-static int
-RestoreValue(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+static void
+SetRowTagBit(RowTag *tagPtr, long offset)
 {
-    Blt_HashEntry *hPtr;
-    int result;
-    Row *rowPtr;
-    Column *colPtr;
-    Value *valuePtr;
-    long index;
+    long word;
+    unsigned int mask;
 
-    /* d row column value */
-    if (restorePtr->argc != 4) {
-        RestoreError(interp, restorePtr);
-        Tcl_AppendResult(interp, "wrong # elements in restore data entry", 
-                (char *)NULL);
-        return TCL_ERROR;
-    }   
-    if (Blt_GetLong(interp, restorePtr->argv[1], &index) != TCL_OK) {
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
-    }
-    hPtr = Blt_FindHashEntry(&restorePtr->rowIndices, (intptr_t)index);
-    if (hPtr == NULL) {
-        RestoreError(interp, restorePtr);
-        Tcl_AppendResult(interp, "bad row index \"", restorePtr->argv[1], "\"",
-                         (char *)NULL);
-        return TCL_ERROR;
-    }
-    rowPtr = Blt_GetHashValue(hPtr);
-    if (Blt_GetLong(interp, restorePtr->argv[2], &index) != TCL_OK) {
-        RestoreError(interp, restorePtr);
-        return TCL_ERROR;
-    }
-    hPtr = Blt_FindHashEntry(&restorePtr->colIndices, (intptr_t)index);
-    if (hPtr == NULL) {
-        RestoreError(interp, restorePtr);
-        Tcl_AppendResult(interp, "bad column index \"", restorePtr->argv[2], 
-                "\"", (char *)NULL);
-        return TCL_ERROR;
+    word = offset >> 5;
+    mask = 1U << (offset & 31);
+    if (word >= tagPtr->numWords) {
+        long numWords;
+
+        /* Grow the bitmap to include the offset. */
+        numWords = (tagPtr->numWords > 0) ? tagPtr->numWords : 1;
+        while (numWords <= word) {
+            numWords += numWords;
+        }
+        if (tagPtr->bits == NULL) {
+            tagPtr->bits = Blt_AssertMalloc(numWords * sizeof(unsigned int));
+        } else {
+            tagPtr->bits = Blt_AssertRealloc(tagPtr->bits, 
+                numWords * sizeof(unsigned int));
+        }
+        memset(tagPtr->bits + tagPtr->numWords, 0, 
+               (numWords - tagPtr->numWords) * sizeof(unsigned int));
+        tagPtr->numWords = numWords;
     }
-    colPtr = Blt_GetHashValue(hPtr);
-    valuePtr = GetValue(table, rowPtr, colPtr);
-    result = SetValueFromString(interp, colPtr->type, restorePtr->argv[3], -1,
-        valuePtr);
-    if (result != TCL_OK) {
-        RestoreError(interp, restorePtr);
+    if ((tagPtr->bits[word] & mask) == 0) {
+        tagPtr->bits[word] |= mask;
+        tagPtr->numRows++;
+        InvalidateRowTag(tagPtr);
     }
-    return result;
 }
 
-BLT_TABLE_ROW *
-blt_table_get_row_map(Table *tablePtr)  
+static void
+ClearRowTagBit(RowTag *tagPtr, long offset)
 {
-    if (tablePtr->corePtr->rows.flags & REINDEX) {
-        ResetRowMap(&tablePtr->corePtr->rows);
+    if (RowTagHas(tagPtr, offset)) {
+        tagPtr->bits[offset >> 5] &= ~(1U << (offset & 31));
+        tagPtr->numRows--;
+        InvalidateRowTag(tagPtr);
     }
-    return tablePtr->corePtr->rows.map;
 }
 
-BLT_TABLE_COLUMN *
-blt_table_get_column_map(Table *tablePtr)  
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetRowOffsetMap --
+ *
+ *      Returns an array of rows indexed by row offset.  The array is
+ *      built the first time it's needed and then kept up to date as rows
+ *      are added or deleted.  Slots of unused offsets are NULL.
+ *
+ *---------------------------------------------------------------------------
+ */
+static Row **
+GetRowOffsetMap(Rows *rowsPtr)
 {
-    if (tablePtr->corePtr->columns.flags & REINDEX) {
-        ResetColumnMap(&tablePtr->corePtr->columns);
+    if (rowsPtr->offsetMap == NULL) {
+        Row *rowPtr;
+
+        rowsPtr->offsetMap = Blt_AssertCalloc(MAX(rowsPtr->numAllocated, 1),
+                                              sizeof(Row *));
+        for (rowPtr = rowsPtr->headPtr; rowPtr != NULL; 
+             rowPtr = rowPtr->nextPtr) {
+            rowsPtr->offsetMap[rowPtr->offset] = rowPtr;
+        }
     }
-    return tablePtr->corePtr->columns.map;
+    return rowsPtr->offsetMap;
 }
 
-Blt_Chain
-blt_table_get_row_tags(Table *tablePtr, Row *rowPtr)  
+static void
+FreeRowOffsetMap(Rows *rowsPtr)
 {
-    Blt_Chain chain;
-
-    chain = Blt_Chain_Create();
-    Blt_Tags_AppendTagsToChain(tablePtr->rowTags, rowPtr, chain);
-    return chain;
+    if (rowsPtr->offsetMap != NULL) {
+        Blt_Free(rowsPtr->offsetMap);
+        rowsPtr->offsetMap = NULL;
+    }
 }
 
-Blt_HashTable *
-blt_table_get_row_tag_table(Table *tablePtr)  
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NextTaggedRow --
+ *
+ *      Returns the row with the tag at the given offset or the first one
+ *      after it.  Whole words of untagged rows are skipped at once.
+ *
+ * Results:
+ *      Returns the row found or NULL if there are no more tagged rows.
+ *
+ *---------------------------------------------------------------------------
+ */
+static Row *
+NextTaggedRow(Rows *rowsPtr, RowTag *tagPtr, long offset)
 {
-    return Blt_Tags_GetTable(tablePtr->rowTags);
-}
+    Row **map;
+    long word;
+    unsigned int bits;
 
-Blt_HashTable *
-blt_table_get_column_tag_table(Table *tablePtr)  
-{
-    return Blt_Tags_GetTable(tablePtr->columnTags);
+    word = offset >> 5;
+    if ((tagPtr->numRows == 0) || (word >= tagPtr->numWords)) {
+        return NULL;
+    }
+    map = GetRowOffsetMap(rowsPtr);
+    bits = tagPtr->bits[word] & (~0U << (offset & 31));
+    for (;;) {
+        int bit;
+
+        for (bit = 0; bits != 0; bit++, bits >>= 1) {
+            if (bits & 1) {
+                offset = (word << 5) + bit;
+                if ((offset < rowsPtr->numAllocated) && (map[offset] != NULL)){
+                    return map[offset];
+                }
+            }
+        }
+        word++;
+        if (word >= tagPtr->numWords) {
+            break;
+        }
+        bits = tagPtr->bits[word];
+    }
+    return NULL;
 }
 
-Blt_Chain
-blt_table_get_column_tags(Table *tablePtr, Column *colPtr)  
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ClearRowFromTags --
+ *
+ *      Removes the row from the tags of every client of the table.  The
+ *      row's offset will be reused, so its bits must be cleared from all
+ *      the tags, not just the client deleting the row.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ClearRowFromTags(TableObject *corePtr, Row *rowPtr)
 {
-    Blt_Chain chain;
+    Blt_ChainLink link;
 
-    chain = Blt_Chain_Create();
-    Blt_Tags_AppendTagsToChain(tablePtr->columnTags, colPtr, chain);
-    return chain;
-}
+    for (link = Blt_Chain_FirstLink(corePtr->clients); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        Blt_HashEntry *hPtr;
+        Blt_HashSearch iter;
+        Table *tablePtr;
 
-Blt_Chain
-blt_table_get_tagged_columns(Table *tablePtr, const char *tag)  
-{
-    return Blt_Tags_GetItemList(tablePtr->columnTags, tag);
+        tablePtr = Blt_Chain_GetValue(link);
+        if (tablePtr->rowTags == NULL) {
+            continue;
+        }
+        for (hPtr = Blt_FirstHashEntry(tablePtr->rowTags, &iter); 
+             hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+            ClearRowTagBit(Blt_GetHashValue(hPtr), rowPtr->offset);
+        }
+    }
 }
 
-Blt_Chain
-blt_table_get_tagged_rows(Table *tablePtr, const char *tag)  
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RemapRowTags --
+ *
+ *      Rebuilds the row tags of every client of the table when the rows
+ *      are about to be renumbered by blt_table_pack.  Each row's new
+ *      offset is its position in the list of rows.  If the flag is set,
+ *      the tags are cleared instead (the rows are all being freed).
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+RemapRowTags(TableObject *corePtr, int clear)
 {
-    return Blt_Tags_GetItemList(tablePtr->rowTags, tag);
-}
+    Blt_ChainLink link;
+    Blt_HashTable seenTable;
+    Rows *rowsPtr;
 
+    rowsPtr = &corePtr->rows;
+    /* Clients may share tags.  Only remap each tag table once. */
+    Blt_InitHashTable(&seenTable, BLT_ONE_WORD_KEYS);
+    for (link = Blt_Chain_FirstLink(corePtr->clients); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        Blt_HashEntry *hPtr;
+        Blt_HashSearch iter;
+        Table *tablePtr;
+        int isNew;
 
-int 
-blt_table_same_object(Table *tablePtr1, Table *tablePtr2)  
-{
-    return tablePtr1->corePtr == tablePtr2->corePtr;
+        tablePtr = Blt_Chain_GetValue(link);
+        if (tablePtr->rowTags == NULL) {
+            continue;
+        }
+        Blt_CreateHashEntry(&seenTable, tablePtr->rowTags, &isNew);
+        if (!isNew) {
+            continue;
+        }
+        for (hPtr = Blt_FirstHashEntry(tablePtr->rowTags, &iter); 
+             hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+            RowTag *tagPtr;
+            unsigned int *bits;
+            long numWords;
+
+            tagPtr = Blt_GetHashValue(hPtr);
+            InvalidateRowTag(tagPtr);
+            if ((clear) || (tagPtr->numRows == 0)) {
+                if (tagPtr->bits != NULL) {
+                    Blt_Free(tagPtr->bits);
+                }
+                tagPtr->bits = NULL;
+                tagPtr->numWords = tagPtr->numRows = 0;
+                continue;
+            }
+            numWords = PackedMapSize(MAX(rowsPtr->numUsed, 1));
+            bits = Blt_AssertCalloc(numWords, sizeof(unsigned int));
+            {
+                Row *rowPtr;
+                long count;
+
+                count = 0;
+                for (rowPtr = rowsPtr->headPtr; rowPtr != NULL; 
+                     rowPtr = rowPtr->nextPtr) {
+                    if (RowTagHas(tagPtr, rowPtr->offset)) {
+                        bits[count >> 5] |= (1U << (count & 31));
+                    }
+                    count++;
+                }
+            }
+            Blt_Free(tagPtr->bits);
+            tagPtr->bits = bits;
+            tagPtr->numWords = numWords;
+        }
+    }
+    Blt_DeleteHashTable(&seenTable);
 }
 
-BLT_TABLE_ROW
-blt_table_get_row_by_index(Table *tablePtr, long index)  
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NewTags --
+ *
+ *---------------------------------------------------------------------------
+ */
+static BLT_TABLE_TAGS
+NewTags(void)
 {
-    if (tablePtr->corePtr->rows.flags & REINDEX) {
-        ResetRowMap(&tablePtr->corePtr->rows);
-    }
-    if (index < blt_table_num_rows(tablePtr)) {
-        return blt_table_row(tablePtr, index);
+    Tags *tagsPtr;
+
+    tagsPtr = Blt_Malloc(sizeof(Tags));
+    if (tagsPtr != NULL) {
+        Blt_InitHashTable(&tagsPtr->rowTagTable, BLT_STRING_KEYS);
+        Blt_Tags_Init(&tagsPtr->columnTags);
+        tagsPtr->refCount = 1;
     }
-    return NULL;
+    return tagsPtr;
 }
 
-BLT_TABLE_COLUMN
-blt_table_get_column_by_index(Table *tablePtr, long index)  
+static void
+InitTags(Table *tablePtr)
 {
-    if (tablePtr->corePtr->columns.flags & REINDEX) {
-        ResetColumnMap(&tablePtr->corePtr->columns);
-    }
-    if (index < blt_table_num_columns(tablePtr)) {
-        return blt_table_column(tablePtr, index);
-    }
-    return NULL;
+    tablePtr->tags = NewTags();
+    tablePtr->rowTags = &tablePtr->tags->rowTagTable;
+    tablePtr->columnTags = &tablePtr->tags->columnTags;
 }
 
-BLT_TABLE_ROWCOLUMN_SPEC
-blt_table_row_spec(BLT_TABLE table, Tcl_Obj *objPtr, const char **sp)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ShareTags --
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ShareTags(Table *srcPtr, Table *destPtr)
 {
-    const char *p;
-    const char *string;
-    long index;
-    char c;
+    srcPtr->tags->refCount++;
+    if (destPtr->tags != NULL) {
+        blt_table_release_tags(destPtr);
+    }
+    destPtr->tags = srcPtr->tags;
+    destPtr->rowTags = &destPtr->tags->rowTagTable;
+    destPtr->columnTags = &destPtr->tags->columnTags;
+}
 
-    string = Tcl_GetString(objPtr);
-    *sp = string;
-    c = string[0];
-    if (c == '@') {
-        *sp = string + 1;
-        return TABLE_SPEC_TAG;
-    } else if ((isdigit(UCHAR(c))) && 
-               (Blt_GetLongFromObj(NULL, objPtr, &index) == TCL_OK)) {
-        return TABLE_SPEC_INDEX;
-    } else if ((c == 'r') && (strncmp(string, "range:", 6) == 0)) {
-        *sp = string + 6;
-        return TABLE_SPEC_RANGE;
-    } else if ((c == 'i') && (strncmp(string, "index:", 6) == 0)) {
-        *sp = string + 6;
-        return TABLE_SPEC_INDEX;
-    } else if ((c == 'l') && (strncmp(string, "label:", 6) == 0)) {
-        *sp = string + 6;
-        return TABLE_SPEC_LABEL;
-    } else if ((c == 't') && (strncmp(string, "tag:", 4) == 0)) {
-        *sp = string + 4;
-        return TABLE_SPEC_TAG;
-    } else if (blt_table_get_row_by_label(table, string) != NULL) {
-        return TABLE_SPEC_LABEL;
-    }
-    p = strchr(string, '-');
-    if (p != NULL) {
-        Tcl_Obj *rangeObjPtr;
-        BLT_TABLE_ROW row;
-
-        rangeObjPtr = Tcl_NewStringObj(string, p - string);
-        row = blt_table_get_row((Tcl_Interp *)NULL, table, rangeObjPtr);
-        Tcl_DecrRefCount(rangeObjPtr);
-        if (row != NULL) {
-            rangeObjPtr = Tcl_NewStringObj(p + 1, -1);
-            row = blt_table_get_row((Tcl_Interp *)NULL, table, rangeObjPtr);
-            Tcl_DecrRefCount(rangeObjPtr);
-            if (row != NULL) {
-                return TABLE_SPEC_RANGE;
-            }
-        }
-    } 
-    return TABLE_SPEC_UNKNOWN;
-}
-
-BLT_TABLE_COLUMN
-blt_table_first_column(Table *tablePtr)  
-{
-    return tablePtr->corePtr->columns.headPtr;
-}
-
-BLT_TABLE_COLUMN
-blt_table_last_column(Table *tablePtr)  
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FindClientInNamespace --
+ *
+ *      Searches for a table client in a given namespace.
+ *
+ * Results:
+ *      Returns a pointer to the table client if found, otherwise NULL.
+ *
+ *---------------------------------------------------------------------------
+ */
+static Table *
+FindClientInNamespace(InterpData *dataPtr, Blt_ObjectName *namePtr)
 {
-    return tablePtr->corePtr->columns.tailPtr;
-}
+    Blt_HashEntry *hPtr;
+    Tcl_DString ds;
+    const char *qualName;
 
-BLT_TABLE_COLUMN
-blt_table_next_column(Column *colPtr)  
-{
-    return colPtr->nextPtr;
-}
+    qualName = Blt_MakeQualifiedName(namePtr, &ds);
+    hPtr = Blt_FindHashEntry(&dataPtr->clientTable, qualName);
+    Tcl_DStringFree(&ds);
+    if (hPtr != NULL) {
+        Blt_Chain chain;
+        Blt_ChainLink link;
 
-BLT_TABLE_COLUMN
-blt_table_previous_column(Column *colPtr)  
-{
-    return colPtr->prevPtr;
+        chain = Blt_GetHashValue(hPtr);
+        link = Blt_Chain_FirstLink(chain);
+        if (link != NULL) {
+            return Blt_Chain_GetValue(link);
+        }
+    }
+    return NULL;
 }
 
-BLT_TABLE_ROW
-blt_table_first_row(Table *tablePtr)  
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetTable --
+ *
+ *      Searches for the table client associated by the name given.
+ *
+ * Results:
+ *      Returns a pointer to the table client if found, otherwise NULL.
+ *
+ *---------------------------------------------------------------------------
+ */
+static BLT_TABLE
+GetTable(InterpData *dataPtr, const char *name, unsigned int flags)
 {
-    return tablePtr->corePtr->rows.headPtr;
-}
+    Blt_ObjectName objName;
+    BLT_TABLE table;
+    Tcl_Interp *interp;
 
-BLT_TABLE_ROW
-blt_table_last_row(Table *tablePtr)  
-{
-    return tablePtr->corePtr->rows.tailPtr;
+    table = NULL;
+    interp = dataPtr->interp;
+    if (!Blt_ParseObjectName(interp, name, &objName, BLT_NO_DEFAULT_NS)) {
+        return NULL;
+    }
+    if (objName.nsPtr != NULL) { 
+        table = FindClientInNamespace(dataPtr, &objName);
+    } else { 
+        if (flags & NS_SEARCH_CURRENT) {
+            /* Look first in the current namespace. */
+            objName.nsPtr = Tcl_GetCurrentNamespace(interp);
+            table = FindClientInNamespace(dataPtr, &objName);
+        }
+        if ((table == NULL) && (flags & NS_SEARCH_GLOBAL)) {
+            objName.nsPtr = Tcl_GetGlobalNamespace(interp);
+            table = FindClientInNamespace(dataPtr, &objName);
+        }
+    }
+    return table;
 }
 
-BLT_TABLE_ROW
-blt_table_next_row(Row *rowPtr)  
+static void
+DestroyClient(Table *tablePtr)
 {
-    return rowPtr->nextPtr;
-}
+    if (tablePtr->magic != TABLE_MAGIC) {
+        Blt_Warn("invalid table object token %p\n", tablePtr);
+        return;
+    }
+    /* Discard any traces and events deferred by a batch. */
+    FreeBatch(tablePtr);
+    if (tablePtr->corePtr != NULL) {
+        FreeBindings(tablePtr->corePtr, tablePtr);
+    }
+    /* Remove any traces that were set by this client. */
+    DestroyTraces(tablePtr);
+    /* Also remove all event handlers created by this client. */
+    DestroyNotifiers(tablePtr, tablePtr->rowNotifiers);
+    DestroyNotifiers(tablePtr, tablePtr->columnNotifiers);
+    blt_table_unset_keys(tablePtr);
+    if (tablePtr->tags != NULL) {
+        blt_table_release_tags(tablePtr);
+    }
+    if ((tablePtr->corePtr != NULL) && (tablePtr->link != NULL)) {
+        TableObject *corePtr;
 
-BLT_TABLE_ROW
-blt_table_previous_row(Row *rowPtr)  
-{
-    return rowPtr->prevPtr;
+        corePtr = tablePtr->corePtr;
+        /* Remove the client from the server's list */
+        Blt_Chain_DeleteLink(corePtr->clients, tablePtr->link);
+        if (Blt_Chain_GetLength(corePtr->clients) == 0) {
+            DestroyTableObject(corePtr);
+        }
+    }
+    tablePtr->magic = 0;
+    Blt_Free(tablePtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_iterate_rows --
- *
- *      Returns the id of the first row derived from the given tag,
- *      label or index represented in objPtr.  
+ * NewTable --
  *
+ *      Creates a new table client.  Clients shared a tuple data object.
+ *      They individually manage traces and events on tuple objects.
+ *      Returns a pointer to the malloc'ed structure.  This is passed to
+ *      the client as a tuple token.
+ *      
  * Results:
- *      Returns the row location of the first item.  If no row 
- *      can be found, then -1 is returned and an error message is
- *      left in the interpreter.
+ *      A pointer to a Table is returned.  If one can't be allocated, NULL
+ *      is returned.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_iterate_rows(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr, 
-                      BLT_TABLE_ITERATOR *iterPtr)
+static Table *
+NewTable(
+    InterpData *dataPtr, 
+    TableObject *corePtr,               /* Table object serving this
+                                         * client. */
+    const char *qualName)               /* Full namespace qualified name of
+                                         * table. A table by this name may
+                                         * already exist. */
 {
-    const char *tag, *p;
-    long index;
-    BLT_TABLE_ROWCOLUMN_SPEC spec;
-    Rows *rowsPtr;
-    memset(iterPtr, 0, sizeof(BLT_TABLE_ITERATOR));
-    iterPtr->table = table;
-    iterPtr->type = TABLE_ITERATOR_INDEX;
-    iterPtr->link = NULL;
-    iterPtr->numEntries = 0;
+    Blt_Chain chain;                    /* List of clients using the same
+                                         * name. */
+    Table *tablePtr;
+    int isNew;
 
-    spec = blt_table_row_spec(table, objPtr, &tag);
-    rowsPtr = blt_table_rows(table);
-    if (rowsPtr->flags & REINDEX) {
-        ResetRowMap(rowsPtr);
+    tablePtr = Blt_Calloc(1, sizeof(Table));
+    if (tablePtr == NULL) {
+        return NULL;
     }
-    switch (spec) {
-    case TABLE_SPEC_INDEX:
-        {
-            int result;
+    tablePtr->magic = TABLE_MAGIC;
+    tablePtr->interp = dataPtr->interp;
+    /* Add client to table object's list of clients. */
+    tablePtr->link = Blt_Chain_Append(corePtr->clients, tablePtr);
 
-            p = Tcl_GetString(objPtr);
-            if (p == tag) {
-                result = Blt_GetLongFromObj(NULL, objPtr, &index);
-            } else {
-                result = Blt_GetLong(NULL, (char *)tag, &index);
-            }
-            if (result != TCL_OK) {
-                if (interp != NULL) {
-                    Tcl_AppendResult(interp, "badly formed row index \"", tag, 
-                                     "\"", (char *)NULL);
-                }
-                return TCL_ERROR;
-            }
-            if (index >= blt_table_num_rows(table)) {
-                if (interp != NULL) {
-                    Tcl_AppendResult(interp, "bad row index \"", 
-                                     Tcl_GetString(objPtr), "\"", (char *)NULL);
-                }
-                return TCL_ERROR;
-            }               
-            iterPtr->firstPtr = iterPtr->lastPtr = blt_table_row(table, index);
-            if (iterPtr->firstPtr != NULL) {
-                iterPtr->numEntries = 1;
-            }
-            iterPtr->tag = tag;
-            return TCL_OK;
-        }
-        break;
+    /* Create a new set of tags. */
+    InitTags(tablePtr);
 
-    case TABLE_SPEC_LABEL:
-        iterPtr->tablePtr = blt_table_row_get_label_table(table, tag);
-        if (iterPtr->tablePtr != NULL) {
-            iterPtr->type = TABLE_ITERATOR_LABEL;
-            iterPtr->tag = tag;
-            iterPtr->numEntries = iterPtr->tablePtr->numEntries;
-            return TCL_OK;
+    tablePtr->clientTablePtr = &dataPtr->clientTable;
+    /* Table names are not unique.  More than one client may open the same
+     * table.  The name remains in use so long as one client is still using
+     * the table. This is so other clients can refer to the table, even
+     * though the original client that created the data no longer
+     * exists. */
+    tablePtr->hPtr = Blt_CreateHashEntry(&dataPtr->clientTable, qualName, 
+        &isNew);
+    if (isNew) {
+        chain = Blt_Chain_Create();
+        Blt_SetHashValue(tablePtr->hPtr, chain);
+    } else {
+        chain = Blt_GetHashValue(tablePtr->hPtr);
+    }
+    tablePtr->name = Blt_GetHashKey(&dataPtr->clientTable, tablePtr->hPtr);
+    tablePtr->link2 = Blt_Chain_Append(chain, tablePtr);
+    tablePtr->rowNotifiers = Blt_Chain_Create();
+    tablePtr->columnNotifiers = Blt_Chain_Create();
+    tablePtr->readTraces = Blt_Chain_Create();
+    tablePtr->writeTraces = Blt_Chain_Create();
+    Blt_InitHashTable(&tablePtr->notifiers, BLT_ONE_WORD_KEYS);
+    Blt_InitHashTable(&tablePtr->traces, BLT_ONE_WORD_KEYS);
+
+    tablePtr->corePtr = corePtr;
+    return tablePtr;
+}
+
+static Blt_HashTable *
+GetColumnLabelTable(Columns *columnsPtr, const char *label)
+{
+    Blt_HashEntry *hPtr;
+
+    hPtr = Blt_FindHashEntry(&columnsPtr->labelTable, label);
+    if (hPtr != NULL) {
+        return Blt_GetHashValue(hPtr);
+    }
+    return NULL;
+}
+
+static Row *
+FindRowLabel(Rows *rowsPtr, const char *label)
+{
+    Blt_HashEntry *hPtr;
+
+    hPtr = Blt_FindHashEntry(&rowsPtr->labelTable, label);
+    if (hPtr != NULL) {
+        return Blt_GetHashValue(hPtr);
+    }
+    return NULL;
+}
+
+static Column *
+FindColumnLabel(Columns *columnsPtr, const char *label)
+{
+    Blt_HashTable *tablePtr;
+
+    tablePtr = GetColumnLabelTable(columnsPtr, label);
+    if (tablePtr != NULL) {
+        Blt_HashEntry *hPtr;
+        Blt_HashSearch iter;
+
+        hPtr = Blt_FirstHashEntry(tablePtr, &iter);
+        if (hPtr != NULL) {
+            return Blt_GetHashValue(hPtr);
         }
-        break;
-        
-    case TABLE_SPEC_TAG:
-        {
-            Blt_Chain chain;
+    }
+    return NULL;
+}
 
-            if (strcmp(tag, "all") == 0) {
-                Row *firstPtr, *lastPtr;
-                
-                iterPtr->type = TABLE_ITERATOR_ALL;
-                firstPtr = blt_table_first_row(table);
-                lastPtr = blt_table_last_row(table);
-                iterPtr->tag = tag;
-                if (firstPtr != NULL) {
-                    iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
+static int
+SetColumnType(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+              BLT_TABLE_COLUMN_TYPE type)
+{
+    Row *rowPtr;
+    int wasPacked, wasEncoded;
+
+    if (type == colPtr->type) {
+        return TCL_OK;                  /* Already the requested type. */
+    }
+    if (IsBoundColumn(interp, colPtr, "change the type of")) {
+        return TCL_ERROR;
+    }
+    /* Packed columns are converted from their string representations, so
+     * unpack the column first.  It's repacked below if the new type is
+     * numeric.  Only string columns can be encoded. */
+    wasPacked = (colPtr->flags & TABLE_COLUMN_PACKED);
+    wasEncoded = (colPtr->encodingPtr != NULL);
+    UnpackColumn(tablePtr, colPtr);
+    DecodeColumn(tablePtr, colPtr);
+    UnshareColumn(colPtr);
+    FreeColumnStats(colPtr);
+    /* First test that every value in the column can be converted. */
+    for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
+         rowPtr = rowPtr->nextPtr) {
+        if (!IsEmpty(rowPtr, colPtr)) {
+            Value value;
+            Value *valuePtr;
+
+            valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+            memset(&value, 0, sizeof(Value));
+            if (SetValueFromString(interp, type, GetValueString(valuePtr),
+                        GetValueLength(valuePtr), &value) != TCL_OK) {
+                if (wasPacked) {
+                    PackColumn(NULL, tablePtr, colPtr);
                 }
-                iterPtr->firstPtr = firstPtr;
-                iterPtr->lastPtr = lastPtr;
-                return TCL_OK;
-            }
-            if (strcmp(tag, "end") == 0) {
-                iterPtr->tag = tag;
-                iterPtr->firstPtr = iterPtr->lastPtr = 
-                    blt_table_last_row(table);
-                if (iterPtr->firstPtr != NULL) {
-                    iterPtr->numEntries = 1;
+                if (wasEncoded) {
+                    EncodeColumn(NULL, tablePtr, colPtr);
                 }
-                return TCL_OK;
-            }
-            chain = blt_table_get_tagged_rows(iterPtr->table, tag);
-            if (chain != NULL) {
-                iterPtr->link = Blt_Chain_FirstLink(chain);
-                iterPtr->type = TABLE_ITERATOR_TAG;
-                iterPtr->tag = tag;
-                iterPtr->chain = NULL;  /* Don't free row tag chain. */
-                iterPtr->numEntries = Blt_Chain_GetLength(chain);
+                return TCL_ERROR;
             }
+            ResetValue(&value);
         }
-        return TCL_OK;
-        
-    case TABLE_SPEC_RANGE:
-        {
-            Row *firstPtr, *lastPtr;
-            Tcl_Obj *rangeObjPtr;
+    }
+    /* Now replace the column with the converted the values. */
+    for (rowPtr = tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
+         rowPtr = rowPtr->nextPtr) {
+        if (!IsEmpty(rowPtr, colPtr)) {
+            Value *valuePtr;
 
-            p = strchr(tag, '-');
-            if (p == NULL) {
-                if (interp != NULL) {
-                    Tcl_AppendResult(interp, "bad range specification \"", tag, 
-                                     "\"", (char *)NULL);
-                }
-                return TCL_ERROR;
-            }
-            rangeObjPtr = Tcl_NewStringObj(tag, p - tag);
-            firstPtr = blt_table_get_row(interp, table, rangeObjPtr);
-            Tcl_DecrRefCount(rangeObjPtr);
-            if (firstPtr == NULL) {
-                return TCL_ERROR;
-            }
-            rangeObjPtr = Tcl_NewStringObj(p + 1, -1);
-            lastPtr = blt_table_get_row(interp, table, rangeObjPtr);
-            Tcl_DecrRefCount(rangeObjPtr);
-            if (lastPtr == NULL) {
+            valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+            if (SetValueFromString(interp, type, GetValueString(valuePtr),
+                 GetValueLength(valuePtr), valuePtr) != TCL_OK) {
                 return TCL_ERROR;
             }
-            if (firstPtr->index > lastPtr->index) {
-                return TCL_OK;
-            }
-            iterPtr->firstPtr = firstPtr;
-            iterPtr->lastPtr = lastPtr;
-            iterPtr->type = TABLE_ITERATOR_RANGE;
-            iterPtr->table = table;
-            iterPtr->tag = tag;
-            iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
         }
-        return TCL_OK;
-
-    default:
-        break;
     }
-    if (interp != NULL) {
-        Tcl_AppendResult(interp, "unknown row specification \"", tag, 
-                         "\" in ", blt_table_name(table), (char *)NULL);
+    colPtr->type = type;
+    IndexMarkDirty(colPtr);
+    if ((wasPacked) && (IsPackableType(type))) {
+        PackColumn(NULL, tablePtr, colPtr);
     }
-    return TCL_ERROR;
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_first_tagged_row --
+ * UnsetValue --
  *
- *      Returns the id of the next row derived from the given tag.
+ *      Removes the value from the selected row, column location in the
+ *      table.  The row, column location must be within the actual table
+ *      limits, but it's okay if there isn't a value there to remove.
  *
  * Results:
- *      Returns the row location of the first item.  If no more rows
- *      can be found, then -1 is returned.
+ *      None.
+ *
+ * Side Effects:
+ *      The objPtr representing the value is released.
  *
  *---------------------------------------------------------------------------
  */
-BLT_TABLE_ROW
-blt_table_first_tagged_row(BLT_TABLE_ITERATOR *iterPtr)
+static void
+UnsetValue(Table *tablePtr, Row *rowPtr, Column *colPtr)
 {
-    switch (iterPtr->type) {
-    case TABLE_ITERATOR_TAG:
-    case TABLE_ITERATOR_CHAIN:
-        /* iterPtr->link is already set by blt_table_row_iterator */
-        if (iterPtr->link != NULL) {
-            BLT_TABLE_ROW row;
+    Value *valuePtr;
 
-            row = Blt_Chain_GetValue(iterPtr->link);
-            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
-            return row;
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        if (PackedExists(colPtr, rowPtr->offset)) {
+            if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+                tablePtr->flags |= TABLE_KEYS_DIRTY;
+            }
+            CopyOnWrite(colPtr, rowPtr);
+            StatsRemoveValue(colPtr, rowPtr);
+            PackedClearExists(colPtr, rowPtr->offset);
         }
-        break;
-    case TABLE_ITERATOR_LABEL:
-        {
-            Blt_HashEntry *hPtr;
-
-            hPtr = Blt_FirstHashEntry(iterPtr->tablePtr, &iterPtr->cursor);
-            if (hPtr == NULL) {
-                return NULL;
+        return;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        if (EncodedCode(colPtr, rowPtr->offset) != 0) {
+            if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+                tablePtr->flags |= TABLE_KEYS_DIRTY;
             }
-            return Blt_GetHashValue(hPtr);
+            UnsetEncodedValue(colPtr, rowPtr);
         }
-        break;
+        return;
+    }
+    if (colPtr->chunks == NULL) {
+        return;
+    }
+    valuePtr = ColumnValue(colPtr, rowPtr->offset);
+    if (!IsEmptyValue(valuePtr)) {
+        /* Indicate the keytables need to be regenerated. */
+        if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+            tablePtr->flags |= TABLE_KEYS_DIRTY;
+        }
+        CopyOnWrite(colPtr, rowPtr);
+        valuePtr = ColumnValue(colPtr, rowPtr->offset);
+        IndexRemoveValue(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+    }
+    ResetValue(valuePtr);
+}
 
-    default:
-        if (iterPtr->firstPtr != NULL) {
-            Row *rowPtr;
+static void
+UnsetRowValues(Table *tablePtr, Row *rowPtr)
+{
+    Column *colPtr;
 
-            rowPtr = iterPtr->firstPtr;
-            if (rowPtr == iterPtr->lastPtr) {
-                iterPtr->nextPtr = NULL;
-            } else {
-                iterPtr->nextPtr = rowPtr->nextPtr;
-            }
-            return rowPtr;
-        } 
+    for (colPtr = tablePtr->corePtr->columns.headPtr; colPtr != NULL;
+         colPtr = colPtr->nextPtr) {
+        if ((colPtr->chunks != NULL) || (colPtr->encodingPtr != NULL) ||
+            (colPtr->flags & TABLE_COLUMN_PACKED)) {
+            UnsetValue(tablePtr, rowPtr, colPtr);
+        }
     }
-    return NULL;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_next_tagged_row --
- *
- *      Returns the id of the next row derived from the given tag.
- *
- * Results:
- *      Returns the row location of the first item.  If no more rows can be
- *      found, then -1 is returned.
- *
- *---------------------------------------------------------------------------
- */
-BLT_TABLE_ROW
-blt_table_next_tagged_row(BLT_TABLE_ITERATOR *iterPtr)
+static void
+DeleteRow(Rows *rowsPtr, Row *rowPtr)
 {
-    switch (iterPtr->type) {
-    case TABLE_ITERATOR_CHAIN:
-    case TABLE_ITERATOR_TAG:
-        if (iterPtr->link != NULL) {
-            BLT_TABLE_ROW row;
-            
-            row = Blt_Chain_GetValue(iterPtr->link);
-            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
-            return row;
-        }
-        break;
-    case TABLE_ITERATOR_LABEL:
-        {
-            Blt_HashEntry *hPtr;
-            
-            hPtr = Blt_NextHashEntry(&iterPtr->cursor); 
-            if (hPtr == NULL) {
-                return NULL;
-            }
-            return Blt_GetHashValue(hPtr);
-        }
-        break;
-    default:
-        if (iterPtr->nextPtr != NULL) {
-            Row *rowPtr;
+    /* If there is a label is associated with the row, free it. */
+    if (rowPtr->label != NULL) {
+        UnsetRowLabel(rowsPtr, rowPtr);
+    }
+    /* Unlink the row from the list of rows. */
+    if (rowsPtr->headPtr == rowPtr) {
+        rowsPtr->headPtr = rowPtr->nextPtr;
+    }
+    if (rowsPtr->tailPtr == rowPtr) {
+        rowsPtr->tailPtr = rowPtr->prevPtr;
+    }
+    if (rowPtr->nextPtr != NULL) {
+        rowPtr->nextPtr->prevPtr = rowPtr->prevPtr;
+    }
+    if (rowPtr->prevPtr != NULL) {
+        rowPtr->prevPtr->nextPtr = rowPtr->nextPtr;
+    }
+    /* Mark the map entries as empty. */
+    rowsPtr->map[rowPtr->index] = NULL;
+    if (rowsPtr->offsetMap != NULL) {
+        rowsPtr->offsetMap[rowPtr->offset] = NULL;
+    }
+    rowsPtr->flags |= REINDEX;
+    if (rowsPtr->freeList != NULL) {
+        /* We don't delete row storage, just add the row offset back onto
+         * the free list. */
+        Blt_Chain_Append(rowsPtr->freeList,
+                         (ClientData)(uintptr_t)rowPtr->offset);
+    }
+    /* Finally free the row itself. */
+    Blt_Pool_FreeItem(rowsPtr->pool, rowPtr);
+    rowsPtr->numUsed--;
+}
 
-            rowPtr = iterPtr->nextPtr;
-            if (rowPtr == iterPtr->lastPtr) {
-                iterPtr->nextPtr = NULL;
-            } else {
-                iterPtr->nextPtr = rowPtr->nextPtr;
-            }
-            return rowPtr;
-        }       
+static void
+DeleteColumn(Table *tablePtr, Column *colPtr)
+{
+    Columns *columnsPtr;
+
+    columnsPtr = &tablePtr->corePtr->columns;
+    /* If there is a label is associated with the column, free it. */
+    if (colPtr->label != NULL) {
+        UnsetColumnLabel(columnsPtr, colPtr);
     }
-    return NULL;
+    if (columnsPtr->headPtr == colPtr) {
+        columnsPtr->headPtr = colPtr->nextPtr;
+    }
+    if (columnsPtr->tailPtr == colPtr) {
+        columnsPtr->tailPtr = colPtr->prevPtr;
+    }
+    if (colPtr->nextPtr != NULL) {
+        colPtr->nextPtr->prevPtr = colPtr->prevPtr;
+    }
+    if (colPtr->prevPtr != NULL) {
+        colPtr->prevPtr->nextPtr = colPtr->nextPtr;
+    }
+    colPtr->prevPtr = colPtr->nextPtr = NULL;
+    columnsPtr->map[colPtr->index] = NULL;
+    columnsPtr->flags |= REINDEX;
+    if (colPtr->bindPtr != NULL) {
+        FreeBinding(colPtr->bindPtr);
+    }
+    FreeIndex(colPtr);
+    FreeColumnStats(colPtr);
+    FreePackedColumn(colPtr);
+    FreeEncodedColumn(colPtr);
+    FreeColumnValues(&tablePtr->corePtr->rows, colPtr);
+    /* Finally free the column. */
+    Blt_Pool_FreeItem(columnsPtr->pool, colPtr);
+    columnsPtr->numUsed--;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_get_row --
+ * ClearRowNotifiers --
  *
- *      Gets the row offset associated the given row index, tag, or label.
- *      This routine is used when you want only one row index.  It's an
- *      error if more than one row is specified (e.g. "all" tag or range
- *      "1-4").  It's also an error if the row tag is empty (no rows are
- *      currently tagged).
+ *      Removes all event handlers set for the designated row.  Note that
+ *      this doesn't remove handlers triggered by row or column tags.  Row
+ *      and column event notifiers are stored in a chain.
  *
  *---------------------------------------------------------------------------
  */
-BLT_TABLE_ROW
-blt_table_get_row(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr)
-{
-    BLT_TABLE_ITERATOR iter;
-    BLT_TABLE_ROW first, next;
-    
-    if (blt_table_iterate_rows(interp, table, objPtr, &iter) != TCL_OK) {
-        return NULL;
-    }
-    first = blt_table_first_tagged_row(&iter);
-    if (first == NULL) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "no rows specified by \"", 
-                             Tcl_GetString(objPtr), "\"", (char *)NULL);
-        }
-        return NULL;
-    }
-    next = blt_table_next_tagged_row(&iter);
-    if (next != NULL) {
-        if (interp != NULL) {
-            const char *tag;
-            
-            blt_table_row_spec(table, objPtr, &tag);
-            Tcl_AppendResult(interp, "multiple rows specified by \"", 
-                             tag, "\"", (char *)NULL);
-        }
-        return NULL;
-    }
-    return first;
-}
-
-BLT_TABLE_ROWCOLUMN_SPEC
-blt_table_column_spec(BLT_TABLE table, Tcl_Obj *objPtr, const char **sp)
+static void
+ClearRowNotifiers(Table *tablePtr, Row *rowPtr)
 {
-    const char *p;
-    const char *string;
-    long index;
-    char c;
+    Blt_ChainLink link, next;
 
-    string = Tcl_GetString(objPtr);
-    *sp = string;
-    c = string[0];
-    if (c == '@') {
-        *sp = string + 1;
-        return TABLE_SPEC_TAG;
-    } else if ((isdigit(c)) &&
-               (Blt_GetLongFromObj(NULL, objPtr, &index) == TCL_OK)) {
-        return TABLE_SPEC_INDEX;
-    } else if ((c == 'r') && (strncmp(string, "range:", 6) == 0)) {
-        *sp = string + 6;
-        return TABLE_SPEC_RANGE;
-    } else if ((c == 'i') && (strncmp(string, "index:", 6) == 0)) {
-        *sp = string + 6;
-        return TABLE_SPEC_INDEX;
-    } else if ((c == 'l') && (strncmp(string, "label:", 6) == 0)) {
-        *sp = string + 6;
-        return TABLE_SPEC_LABEL;
-    } else if ((c == 't') && (strncmp(string, "tag:", 4) == 0)) {
-        *sp = string + 4;
-        return TABLE_SPEC_TAG;
-    } else if (blt_table_get_column_by_label(table, string) != NULL) {
-        return TABLE_SPEC_LABEL;
-    }
-    p = strchr(string, '-');
-    if (p != NULL) {
-        Tcl_Obj *objPtr;
-        BLT_TABLE_COLUMN col;
+    for (link = Blt_Chain_FirstLink(tablePtr->rowNotifiers); link != NULL;
+         link = next) {
+        Notifier *notifierPtr;
 
-        objPtr = Tcl_NewStringObj(string, p - string);
-        Tcl_IncrRefCount(objPtr);
-        col = blt_table_get_column(NULL, table, objPtr);
-        Tcl_DecrRefCount(objPtr);
-        if (col != NULL) {
-            objPtr = Tcl_NewStringObj(p + 1, -1);
-            col = blt_table_get_column(NULL, table, objPtr);
-            Tcl_DecrRefCount(objPtr);
-            if (col != NULL) {
-                return TABLE_SPEC_RANGE;
-            }
+        next = Blt_Chain_NextLink(link);
+        notifierPtr = Blt_Chain_GetValue(link);
+        if (notifierPtr->row == rowPtr) {
+            blt_table_delete_notifier(tablePtr, notifierPtr);
         }
     }
-    return TABLE_SPEC_UNKNOWN;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_iterate_columns --
- *
- *      Returns the id of the first column derived from the given tag,
- *      label or index represented in objPtr.
+ * ClearColumnNotifiers --
  *
- * Results:
- *      Returns the column location of the first item.  If no column can be
- *      found, then -1 is returned and an error message is left in the
- *      interpreter.
+ *      Removes all event handlers set for the designated row.  Note that
+ *      this doesn't remove handlers triggered by row or column tags.  Row
+ *      and column event notifiers are stored in a chain.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_iterate_columns(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr, 
-                         BLT_TABLE_ITERATOR *iterPtr)
+static void
+ClearColumnNotifiers(Table *tablePtr, Column *colPtr)
 {
-    const char *tag, *p;
-    int result;
-    long index;
-    BLT_TABLE_ROWCOLUMN_SPEC spec;
-    Columns *columnsPtr;
+    Blt_ChainLink link, next;
 
-    columnsPtr = blt_table_columns(table);
-    if (columnsPtr->flags & REINDEX) {
-        ResetColumnMap(columnsPtr);
-    }
-    iterPtr->table = table;
-    iterPtr->type = TABLE_ITERATOR_INDEX;
-    iterPtr->link = NULL;
-    iterPtr->numEntries = 0;
+    for (link = Blt_Chain_FirstLink(tablePtr->columnNotifiers); link != NULL; 
+        link = next) {
+        Notifier *notifierPtr;
 
-    spec = blt_table_column_spec(table, objPtr, &tag);
-    switch (spec) {
-    case TABLE_SPEC_INDEX:
-        p = Tcl_GetString(objPtr);
-        if (p == tag) {
-            result = Blt_GetLongFromObj(NULL, objPtr, &index);
-        } else {
-            result = Blt_GetLong(NULL, (const char *)tag, &index);
-        }
-        if (result != TCL_OK) {
-            if (interp != NULL) {
-                Tcl_AppendResult(interp, "badly formed column index \"", 
-                        tag, "\"", (char *)NULL);
-            }
-            return TCL_ERROR;
+        next = Blt_Chain_NextLink(link);
+        notifierPtr = Blt_Chain_GetValue(link);
+        if (notifierPtr->column == colPtr) {
+            blt_table_delete_notifier(tablePtr, notifierPtr);
         }
-        if ((index < 0) || (index >= blt_table_num_columns(table))) {
-            if (interp != NULL) {
-                Tcl_AppendResult(interp, "bad column index \"", 
-                        Tcl_GetString(objPtr), "\"", (char *)NULL);
-            }
-            return TCL_ERROR;
-        }               
-        iterPtr->firstPtr = iterPtr->lastPtr = blt_table_column(table, index);
-        if (iterPtr->firstPtr != NULL) {
-            iterPtr->numEntries = 1;
-        }
-        iterPtr->tag = tag;
-        return TCL_OK;
+    }
+}
 
-    case TABLE_SPEC_LABEL:
-        iterPtr->tablePtr = blt_table_column_get_label_table(table, tag);
-        if (iterPtr->tablePtr != NULL) {
-            iterPtr->type = TABLE_ITERATOR_LABEL;
-            iterPtr->tag = tag;
-            iterPtr->numEntries = iterPtr->tablePtr->numEntries;
-            return TCL_OK;
-        }
-        break;
-        
-    case TABLE_SPEC_TAG:
-        {
-            Blt_Chain chain;
+/*
+ * TableBatch --
+ *
+ *      Traces and notifier events deferred while a client makes a batch of
+ *      changes to the table.  Each changed cell is traced once, with the
+ *      flags of all its changes.  Repeated notifier events for the same
+ *      row or column are merged, as are move events.  Delete events are
+ *      never deferred, since the row or column is about to be freed.
+ *      Instead, pending traces and events for it are discarded.
+ */
+typedef struct _TableBatch {
+    int depth;                          /* # of nested batches in
+                                         * progress. */
+    int isCommitting;                   /* Indicates the deferred traces and
+                                         * events are being delivered. */
+    Blt_HashTable cellTable;            /* Deferred cell traces, keyed by
+                                         * row and column. */
+    Blt_Chain cells;                    /* Deferred cell traces, in the
+                                         * order the cells were first
+                                         * changed. */
+    Blt_HashTable eventTable;           /* Deferred notifier events, keyed
+                                         * by event type and row or
+                                         * column. */
+    Blt_Chain events;                   /* Deferred notifier events in
+                                         * order. */
+} TableBatch;
 
-            if (strcmp(tag, "all") == 0) {
-                Column *firstPtr, *lastPtr;
+typedef struct {
+    Row *rowPtr;
+    Column *colPtr;
+    unsigned int flags;                 /* Trace flags of the changes to
+                                         * the cell. */
+    Blt_HashEntry *hashPtr;
+    Blt_ChainLink link;
+} BatchCell;
 
-                iterPtr->type = TABLE_ITERATOR_ALL;
-                iterPtr->tag = tag;
-                firstPtr = blt_table_first_column(table);
-                lastPtr = blt_table_last_column(table);
-                if (firstPtr != NULL) {
-                    iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
-                }
-                iterPtr->firstPtr = firstPtr;
-                iterPtr->lastPtr = lastPtr;
-                return TCL_OK;
-            }
-            if (strcmp(tag, "end") == 0) {
-                iterPtr->tag = tag;
-                iterPtr->firstPtr = iterPtr->lastPtr = 
-                    blt_table_last_column(table);
-                if (iterPtr->firstPtr != NULL) {
-                    iterPtr->numEntries = 1;
-                }
-                return TCL_OK;
-            }
-            
-            chain = blt_table_get_tagged_columns(iterPtr->table, tag);
-            if (chain != NULL) {
-                iterPtr->link = Blt_Chain_FirstLink(chain);
-                iterPtr->type = TABLE_ITERATOR_TAG;
-                iterPtr->tag = tag;
-                iterPtr->chain = NULL;  /* Don't free column tag chain.  */
-                iterPtr->numEntries = Blt_Chain_GetLength(chain);
-                return TCL_OK;
-            }
-        }
-        break;
+typedef struct {
+    void *item;                         /* Row or column of the event.
+                                         * NULL for move events. */
+    size_t type;                        /* Event type. */
+} BatchEventKey;
 
-    case TABLE_SPEC_RANGE:
-        {
-            Column *firstPtr, *lastPtr;
-            Tcl_Obj *fromObjPtr, *toObjPtr;
-            
-            p = strchr(tag, '-');
-            if (p == NULL) {
-                if (interp != NULL) {
-                    Tcl_AppendResult(interp, "bad range specification \"", tag, 
-                                     "\"", (char *)NULL);
-                }
-                return TCL_ERROR;
-            }
-            fromObjPtr = Tcl_NewStringObj(tag, p - tag);
-            firstPtr = blt_table_get_column(interp, table, fromObjPtr);
-            Tcl_DecrRefCount(fromObjPtr);
-            if (firstPtr == NULL) {
-                return TCL_ERROR;
-            }
-            toObjPtr = Tcl_NewStringObj(p + 1, -1);
-            lastPtr = blt_table_get_column(interp, table, toObjPtr);
-            Tcl_DecrRefCount(toObjPtr);
-            if (lastPtr == NULL) {
-                return TCL_ERROR;
-            }
-            iterPtr->firstPtr = firstPtr;
-            iterPtr->lastPtr = lastPtr;
-            iterPtr->type  = TABLE_ITERATOR_RANGE;
-            iterPtr->tag = tag;
-            if (firstPtr != NULL) {
-                iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
-            }
-        }
-        return TCL_OK;
+typedef struct {
+    BLT_TABLE_NOTIFY_EVENT event;
+    Blt_HashEntry *hashPtr;
+    Blt_ChainLink link;
+} BatchEvent;
 
-    default:
-        break;
+static INLINE int
+IsBatching(Table *tablePtr)
+{
+    return ((tablePtr->batchPtr != NULL) && (tablePtr->batchPtr->depth > 0));
+}
+
+static void
+FreeBatch(Table *tablePtr)
+{
+    TableBatch *batchPtr;
+    Blt_ChainLink link;
+
+    batchPtr = tablePtr->batchPtr;
+    if (batchPtr == NULL) {
+        return;
     }
-    if (interp != NULL) {
-        Tcl_AppendResult(interp, "unknown column specification \"", 
-                         tag, "\" in ", blt_table_name(table),(char *)NULL);
+    for (link = Blt_Chain_FirstLink(batchPtr->cells); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        Blt_Free(Blt_Chain_GetValue(link));
     }
-    return TCL_ERROR;
+    for (link = Blt_Chain_FirstLink(batchPtr->events); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        Blt_Free(Blt_Chain_GetValue(link));
+    }
+    Blt_Chain_Destroy(batchPtr->cells);
+    Blt_Chain_Destroy(batchPtr->events);
+    Blt_DeleteHashTable(&batchPtr->cellTable);
+    Blt_DeleteHashTable(&batchPtr->eventTable);
+    Blt_Free(batchPtr);
+    tablePtr->batchPtr = NULL;
+}
+
+static void
+DeferTrace(Table *tablePtr, Row *rowPtr, Column *colPtr, unsigned int flags)
+{
+    TableBatch *batchPtr = tablePtr->batchPtr;
+    BatchCell *cellPtr;
+    Blt_HashEntry *hPtr;
+    RowColumnKey key;
+    int isNew;
+
+    memset(&key, 0, sizeof(key));
+    key.row = rowPtr;
+    key.column = colPtr;
+    hPtr = Blt_CreateHashEntry(&batchPtr->cellTable, (char *)&key, &isNew);
+    if (isNew) {
+        cellPtr = Blt_AssertMalloc(sizeof(BatchCell));
+        cellPtr->rowPtr = rowPtr;
+        cellPtr->colPtr = colPtr;
+        cellPtr->flags = 0;
+        cellPtr->hashPtr = hPtr;
+        cellPtr->link = Blt_Chain_Append(batchPtr->cells, cellPtr);
+        Blt_SetHashValue(hPtr, cellPtr);
+    } else {
+        cellPtr = Blt_GetHashValue(hPtr);
+    }
+    cellPtr->flags |= flags;
+}
+
+static BatchEvent *
+FindBatchEvent(TableBatch *batchPtr, void *item, unsigned int type)
+{
+    BatchEventKey key;
+    Blt_HashEntry *hPtr;
+
+    memset(&key, 0, sizeof(key));
+    key.item = item;
+    key.type = type;
+    hPtr = Blt_FindHashEntry(&batchPtr->eventTable, (char *)&key);
+    if (hPtr == NULL) {
+        return NULL;
+    }
+    return Blt_GetHashValue(hPtr);
+}
+
+static void
+DeleteBatchEvent(TableBatch *batchPtr, BatchEvent *eventPtr)
+{
+    Blt_DeleteHashEntry(&batchPtr->eventTable, eventPtr->hashPtr);
+    Blt_Chain_DeleteLink(batchPtr->events, eventPtr->link);
+    Blt_Free(eventPtr);
 }
 
 /*
- *---------------------------------------------------------------------------
- *
- * blt_table_first_tagged_column --
- *
- *      Returns the first column based upon given iterator.
- *
- * Results:
- *      Returns the column location of the first item.  If no more columns
- *      can be found, then -1 is returned.
+ * DeferNotify --
  *
- *---------------------------------------------------------------------------
+ *      Saves the notifier event until the batch ends.  Returns TRUE if the
+ *      event has been handled: either it was deferred or it deletes a row
+ *      or column that was created in the batch (and so no client has been
+ *      told about yet).  Delete events for other rows or columns are sent
+ *      right away.
  */
-BLT_TABLE_COLUMN
-blt_table_first_tagged_column(BLT_TABLE_ITERATOR *iterPtr)
+static int
+DeferNotify(Table *tablePtr, BLT_TABLE_NOTIFY_EVENT *eventPtr)
 {
-    switch (iterPtr->type) {
-    case TABLE_ITERATOR_TAG:
-    case TABLE_ITERATOR_CHAIN:
-        /* iterPtr->link is already set by blt_table_column_iterator */
-        if (iterPtr->link != NULL) {
-            BLT_TABLE_COLUMN col;
+    TableBatch *batchPtr = tablePtr->batchPtr;
+    BatchEvent *batchEventPtr;
+    BatchEventKey key;
+    Blt_HashEntry *hPtr;
+    int isNew;
 
-            col = Blt_Chain_GetValue(iterPtr->link);
-            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
-            return col;
-        }
-        break;
-    case TABLE_ITERATOR_LABEL:
-        {
-            Blt_HashEntry *hPtr;
-            
-            hPtr = Blt_FirstHashEntry(iterPtr->tablePtr, &iterPtr->cursor);
-            if (hPtr == NULL) {
-                return NULL;
-            }
-            return Blt_GetHashValue(hPtr);
+    memset(&key, 0, sizeof(key));
+    key.item = (eventPtr->type & TABLE_NOTIFY_COLUMN) ? 
+        (void *)eventPtr->column : (void *)eventPtr->row;
+    if (eventPtr->type & TABLE_NOTIFY_DELETE) {
+        if ((key.item != NULL) && 
+            (FindBatchEvent(batchPtr, key.item, (eventPtr->type & 
+                ~TABLE_NOTIFY_DELETE) | TABLE_NOTIFY_CREATE) != NULL)) {
+            return TRUE;
         }
-        break;
-    default:
-        if (iterPtr->firstPtr != NULL) {
-            Column *colPtr;
-
-            colPtr = iterPtr->firstPtr;
-            if (colPtr == iterPtr->lastPtr) {
-                iterPtr->nextPtr = NULL;
-            } else {
-                iterPtr->nextPtr = colPtr->nextPtr;
-            }
-            return colPtr;
-        } 
-        break;
+        return FALSE;
     }
-    return NULL;
+    key.type = eventPtr->type;
+    hPtr = Blt_CreateHashEntry(&batchPtr->eventTable, (char *)&key, &isNew);
+    if (!isNew) {
+        return TRUE;                    /* Already have the same event. */
+    }
+    batchEventPtr = Blt_AssertMalloc(sizeof(BatchEvent));
+    batchEventPtr->event = *eventPtr;
+    batchEventPtr->hashPtr = hPtr;
+    batchEventPtr->link = Blt_Chain_Append(batchPtr->events, batchEventPtr);
+    Blt_SetHashValue(hPtr, batchEventPtr);
+    return TRUE;
 }
 
 /*
- *---------------------------------------------------------------------------
- *
- * blt_table_next_tagged_column --
- *
- *      Returns the column location of the next column using the given
- *      iterator.
- *
- * Results:
- *      Returns the column location of the next item.  If no more columns
- *      can be found, then -1 is returned.
+ * ForgetBatchItems --
  *
- *---------------------------------------------------------------------------
+ *      Discards the deferred traces and notifier events of every client
+ *      that refer to a row or column about to be deleted.  If both rowPtr
+ *      and colPtr are NULL, all rows and columns are being deleted.
  */
-BLT_TABLE_COLUMN
-blt_table_next_tagged_column(BLT_TABLE_ITERATOR *iterPtr)
+static void
+ForgetBatchItems(TableObject *corePtr, Row *rowPtr, Column *colPtr)
 {
-    switch (iterPtr->type) {
-    case TABLE_ITERATOR_TAG:
-    case TABLE_ITERATOR_CHAIN:
-        if (iterPtr->link != NULL) {
-            BLT_TABLE_COLUMN col;
-            
-            col = Blt_Chain_GetValue(iterPtr->link);
-            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
-            return col;
-        }
-        break;
-    case TABLE_ITERATOR_LABEL:
-        {
-            Blt_HashEntry *hPtr;
+    Blt_ChainLink link;
 
-            hPtr = Blt_NextHashEntry(&iterPtr->cursor); 
-            if (hPtr == NULL) {
-                return NULL;
+    for (link = Blt_Chain_FirstLink(corePtr->clients); link != NULL; 
+         link = Blt_Chain_NextLink(link)) {
+        Table *clientPtr;
+        TableBatch *batchPtr;
+        Blt_ChainLink link2, next;
+
+        clientPtr = Blt_Chain_GetValue(link);
+        batchPtr = clientPtr->batchPtr;
+        if (batchPtr == NULL) {
+            continue;
+        }
+        for (link2 = Blt_Chain_FirstLink(batchPtr->cells); link2 != NULL;
+             link2 = next) {
+            BatchCell *cellPtr;
+
+            next = Blt_Chain_NextLink(link2);
+            cellPtr = Blt_Chain_GetValue(link2);
+            if (((rowPtr == NULL) && (colPtr == NULL)) ||
+                (cellPtr->rowPtr == rowPtr) || (cellPtr->colPtr == colPtr)) {
+                Blt_DeleteHashEntry(&batchPtr->cellTable, cellPtr->hashPtr);
+                Blt_Chain_DeleteLink(batchPtr->cells, link2);
+                Blt_Free(cellPtr);
             }
-            return Blt_GetHashValue(hPtr);
         }
-        break;
-    default:
-        if (iterPtr->nextPtr != NULL) {
-            Column *colPtr;
+        for (link2 = Blt_Chain_FirstLink(batchPtr->events); link2 != NULL;
+             link2 = next) {
+            BatchEvent *eventPtr;
+            void *item;
 
-            colPtr = iterPtr->nextPtr;
-            if (colPtr == iterPtr->lastPtr) {
-                iterPtr->nextPtr = NULL;
+            next = Blt_Chain_NextLink(link2);
+            eventPtr = Blt_Chain_GetValue(link2);
+            if (eventPtr->event.type & TABLE_NOTIFY_COLUMN) {
+                item = eventPtr->event.column;
             } else {
-                iterPtr->nextPtr = colPtr->nextPtr;
+                item = eventPtr->event.row;
             }
-            return colPtr;
-        }       
-        break;
+            if (item == NULL) {
+                continue;               /* Move events. */
+            }
+            if (((rowPtr == NULL) && (colPtr == NULL)) ||
+                (item == (void *)rowPtr) || (item == (void *)colPtr)) {
+                DeleteBatchEvent(batchPtr, eventPtr);
+            }
+        }
     }
-    return NULL;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_get_column --
+ * DoNotify --
  *
- *---------------------------------------------------------------------------
- */
-BLT_TABLE_COLUMN
-blt_table_get_column(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr)
-{
-    BLT_TABLE_ITERATOR iter;
-    BLT_TABLE_COLUMN first, next;
-
-    if (blt_table_iterate_columns(interp, table, objPtr, &iter) != TCL_OK) {
-        return NULL;
-    }
-    first = blt_table_first_tagged_column(&iter);
-    if (first == NULL) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "no columns specified by \"", 
-                Tcl_GetString(objPtr), "\"", (char *)NULL);
-        }
-        return NULL;
-    }
-    next = blt_table_next_tagged_column(&iter);
-    if (next != NULL) {
-        if (interp != NULL) {
-            const char *tag;
-            
-            blt_table_column_spec(table, objPtr, &tag);
-            Tcl_AppendResult(interp, "multiple columns specified by \"", 
-                tag, "\"", (char *)NULL);
-        }
-        return NULL;
-    }
-    return first;
-}
-
-
-int
-blt_table_list_columns(Tcl_Interp *interp, BLT_TABLE table, int objc, 
-                       Tcl_Obj *const *objv, Blt_Chain chain)
+ *      Traverses the client's list of event callbacks and checks if one
+ *      matches the given event.  A client may trigger an action that
+ *      causes the itself to be notified again.  This can be prevented by
+ *      setting the TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
+ *
+ *      If a matching handler is found, a callback may be called either
+ *      immediately or at the next idle time depending upon the
+ *      TABLE_NOTIFY_WHENIDLE bit.
+ *
+ *      Since a handler routine may trigger yet another call to itself,
+ *      callbacks are ignored while the event handler is executing.
+ *      
+ *---------------------------------------------------------------------------
+ */
+static void
+DoNotify(Table *tablePtr, Blt_Chain notifiers, 
+         BLT_TABLE_NOTIFY_EVENT *eventPtr)
 {
     Blt_ChainLink link;
-    Blt_HashTable cols;
-    int i;
+    unsigned int eventMask;
 
-    Blt_InitHashTableWithPool(&cols, BLT_ONE_WORD_KEYS);
-    /* Initialize the hash table with the existing entries. */
-    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
+    /* Check the client table for matching notifiers.  Issue callbacks
+     * indicating that the structure of the table has changed.  */
+    eventMask = eventPtr->type & TABLE_NOTIFY_MASK;
+    for (link = Blt_Chain_FirstLink(notifiers); link != NULL; 
          link = Blt_Chain_NextLink(link)) {
-        int isNew;
-        BLT_TABLE_COLUMN col;
-
-        col = Blt_Chain_GetValue(link);
-        Blt_CreateHashEntry(&cols, col, &isNew);
-    }
-    /* Collect the columns into a hash table. */
-    for (i = 0; i < objc; i++) {
-        BLT_TABLE_ITERATOR iter;
-        BLT_TABLE_COLUMN col;
+        Notifier *notifierPtr;
+        int match;
 
-        if (blt_table_iterate_columns(interp, table, objv[i], &iter) 
-            != TCL_OK) {
-            Blt_DeleteHashTable(&cols);
-            return TCL_ERROR;
+        notifierPtr = Blt_Chain_GetValue(link);
+        if ((notifierPtr->flags & eventMask) == 0) {
+            continue;                   /* Event type doesn't match */
         }
-        for (col = blt_table_first_tagged_column(&iter); col != NULL; 
-             col = blt_table_next_tagged_column(&iter)) {
-            int isNew;
-
-            Blt_CreateHashEntry(&cols, col, &isNew);
-            if (isNew) {
-                Blt_Chain_Append(chain, col);
+        if ((eventPtr->self) && 
+            (notifierPtr->flags & TABLE_NOTIFY_FOREIGN_ONLY)) {
+            continue;                   /* Don't notify yourself. */
+        }
+        if (notifierPtr->flags & TABLE_NOTIFY_ACTIVE) {
+            continue;                   /* Ignore callbacks that are
+                                         * generated inside of a notify
+                                         * handler routine. */
+        }
+        match = FALSE;
+        if (notifierPtr->tag != NULL) {
+            if (notifierPtr->flags & TABLE_NOTIFY_ROW) {
+                if (blt_table_row_has_tag(tablePtr, eventPtr->row, 
+                        notifierPtr->tag)) {
+                    match++;
+                }
+            } else {
+                if (blt_table_column_has_tag(tablePtr, eventPtr->column, 
+                        notifierPtr->tag)) {
+                    match++;
+                }
             }
+        } else if ((notifierPtr->flags & TABLE_NOTIFY_ROW) && 
+                   ((notifierPtr->row == NULL) || 
+                    (notifierPtr->row == eventPtr->row))) {
+            match++;                    /* Offsets match. */
+        } else if ((notifierPtr->flags & TABLE_NOTIFY_COLUMN) && 
+                   ((notifierPtr->column == NULL) ||
+                    (notifierPtr->column == eventPtr->column))) {
+            match++;                    /* Offsets match. */
         }
-    }
-    Blt_DeleteHashTable(&cols);
-    return TCL_OK;
-}
-
-int
-blt_table_list_rows(Tcl_Interp *interp, BLT_TABLE table, int objc, 
-                    Tcl_Obj *const *objv, Blt_Chain chain)
-{
-    Blt_ChainLink link;
-    Blt_HashTable rows;
-    int i;
-
-    Blt_InitHashTableWithPool(&rows, BLT_ONE_WORD_KEYS);
-    /* Initialize the hash table with the existing entries. */
-    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
-         link = Blt_Chain_NextLink(link)) {
-        int isNew;
-        BLT_TABLE_ROW row;
-
-        row = Blt_Chain_GetValue(link);
-        Blt_CreateHashEntry(&rows, row, &isNew);
-    }
-    for (i = 0; i < objc; i++) {
-        BLT_TABLE_ITERATOR iter;
-        BLT_TABLE_ROW row;
-
-        if (blt_table_iterate_rows(interp, table, objv[i], &iter) != TCL_OK){
-            Blt_DeleteHashTable(&rows);
-            return TCL_ERROR;
+        if (!match) {
+            continue;                   /* Row or column doesn't match. */
         }
-        /* Append the new rows onto the chain. */
-        for (row = blt_table_first_tagged_row(&iter); row != NULL; 
-             row = blt_table_next_tagged_row(&iter)) {
-            int isNew;
-
-            Blt_CreateHashEntry(&rows, row, &isNew);
-            if (isNew) {
-                Blt_Chain_Append(chain, row);
+        if (notifierPtr->flags & TABLE_NOTIFY_WHENIDLE) {
+            if ((notifierPtr->flags & TABLE_NOTIFY_PENDING) == 0) {
+                notifierPtr->flags |= TABLE_NOTIFY_PENDING;
+                notifierPtr->event = *eventPtr;
+                Tcl_DoWhenIdle(NotifyIdleProc, notifierPtr);
             }
+        } else {
+            notifierPtr->event = *eventPtr;
+            NotifyIdleProc(notifierPtr);
         }
     }
-    Blt_DeleteHashTable(&rows);
-    return TCL_OK;
 }
 
-int
-blt_table_iterate_rows_objv(Tcl_Interp *interp, BLT_TABLE table, int objc, 
-                            Tcl_Obj *const *objv, BLT_TABLE_ITERATOR *iterPtr)
-{
-    Blt_Chain chain;
 
-    chain = Blt_Chain_Create();
-    if (blt_table_list_rows(interp, table, objc, objv, chain) != TCL_OK) {
-        Blt_Chain_Destroy(chain);
-        return TCL_ERROR;
-    }
-    iterPtr->type = TABLE_ITERATOR_CHAIN;
-    iterPtr->link = Blt_Chain_FirstLink(chain);
-    /* Indicate to free created chain. */
-    iterPtr->chain = chain;
-    iterPtr->numEntries = Blt_Chain_GetLength(chain);
-    iterPtr->tag = "";
-    return TCL_OK;
+static void
+InitNotifyEvent(Table *tablePtr, BLT_TABLE_NOTIFY_EVENT *eventPtr)
+{
+    memset(eventPtr, 0, sizeof(BLT_TABLE_NOTIFY_EVENT));
+    eventPtr->table = tablePtr;
+    eventPtr->interp = tablePtr->interp;
 }
 
-void
-blt_table_iterate_all_rows(BLT_TABLE table, BLT_TABLE_ITERATOR *iterPtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NotifyClients --
+ *
+ *      Traverses the list of event callbacks and checks if one matches the
+ *      given event.  A client may trigger an action that causes the table
+ *      object to notify it.  This can be prevented by setting the
+ *      TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
+ *
+ *      If a matching handler is found, a callback may be called either
+ *      immediately or at the next idle time depending upon the
+ *      TABLE_NOTIFY_WHENIDLE bit.
+ *
+ *      Since a handler routine may trigger yet another call to itself,
+ *      callbacks are ignored while the event handler is executing.
+ *      
+ *---------------------------------------------------------------------------
+ */
+static void
+NotifyClients(Table *tablePtr, BLT_TABLE_NOTIFY_EVENT *eventPtr)
 {
-    Row *firstPtr, *lastPtr;
-    Rows *rowsPtr;
+    Blt_ChainLink link, next;
     
-    rowsPtr = blt_table_rows(table);
-    if (rowsPtr->flags & REINDEX) {
-        ResetRowMap(rowsPtr);
+    if ((IsBatching(tablePtr)) && (DeferNotify(tablePtr, eventPtr))) {
+        return;
+    }
+    for (link = Blt_Chain_FirstLink(tablePtr->corePtr->clients); link != NULL; 
+         link = next) {
+        Table *clientPtr;
+        Blt_Chain chain;
+        
+        next = Blt_Chain_NextLink(link);
+        clientPtr = Blt_Chain_GetValue(link);
+        eventPtr->self = (clientPtr == tablePtr);
+        chain = (eventPtr->type & TABLE_NOTIFY_COLUMN) ?
+            clientPtr->columnNotifiers : clientPtr->rowNotifiers;
+        if (Blt_Chain_GetLength(chain) > 0) {
+            DoNotify(clientPtr, chain, eventPtr);
+        }
     }
-
-    iterPtr->chain = NULL;
-    iterPtr->link = NULL;
-    iterPtr->numEntries = 0;
-    iterPtr->table = table;
-    iterPtr->tag = "all";
-    iterPtr->type = TABLE_ITERATOR_ALL;
-
-    firstPtr = blt_table_first_row(table);
-    lastPtr = blt_table_last_row(table);
-    if (firstPtr != NULL) {
-        iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
-    } 
-    iterPtr->firstPtr = firstPtr;
-    iterPtr->lastPtr = lastPtr;
 }
 
-int
-blt_table_iterate_columns_objv(Tcl_Interp *interp, BLT_TABLE table, int objc, 
-                               Tcl_Obj *const *objv,
-                               BLT_TABLE_ITERATOR *iterPtr)
-{
-    Blt_Chain chain;
-
-    chain = Blt_Chain_Create();
-    if (blt_table_list_columns(interp, table, objc, objv, chain) != TCL_OK) {
-        Blt_Chain_Destroy(chain);
-        return TCL_ERROR;
-    }
-    iterPtr->table = table;
-    iterPtr->type = TABLE_ITERATOR_CHAIN;
-    iterPtr->link = Blt_Chain_FirstLink(chain);    
-    /* Indicate to free created chain. */
-    iterPtr->chain = chain;
-    iterPtr->numEntries = Blt_Chain_GetLength(chain);
-    iterPtr->tag = "";
-    return TCL_OK;
-}
-
-void
-blt_table_iterate_all_columns(BLT_TABLE table, BLT_TABLE_ITERATOR *iterPtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NotifyColumnChanged --
+ *
+ *      Traverses the list of event callbacks and checks if one matches the
+ *      given event.  A client may trigger an action that causes the table
+ *      object to notify it.  This can be prevented by setting the
+ *      TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
+ *
+ *      If a matching handler is found, a callback may be called either
+ *      immediately or at the next idle time depending upon the
+ *      TABLE_NOTIFY_WHENIDLE bit.
+ *
+ *      Since a handler routine may trigger yet another call to itself,
+ *      callbacks are ignored while the event handler is executing.
+ *      
+ *---------------------------------------------------------------------------
+ */
+static void
+NotifyColumnChanged(Table *tablePtr, Column *colPtr, unsigned int flags)
 {
-    Column *firstPtr, *lastPtr;
-    Columns *columnsPtr;
-
-    columnsPtr = blt_table_columns(table);
-    if (columnsPtr->flags & REINDEX) { 
-        ResetColumnMap(columnsPtr);
-    }
-
-    iterPtr->chain = NULL;
-    iterPtr->link = NULL;
-    iterPtr->numEntries = 0;
-    iterPtr->table = table;
-    iterPtr->tag = "all";
-    iterPtr->type = TABLE_ITERATOR_ALL;
+    BLT_TABLE_NOTIFY_EVENT event;
 
-    firstPtr = blt_table_first_column(table);
-    lastPtr = blt_table_last_column(table);
-    if (firstPtr != NULL) {
-        iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
-    } 
-    iterPtr->firstPtr = firstPtr;
-    iterPtr->lastPtr = lastPtr;
+    InitNotifyEvent(tablePtr, &event);
+    event.type = flags | TABLE_NOTIFY_COLUMN;
+    event.column = colPtr;
+    NotifyClients(tablePtr, &event);
 }
 
-void
-blt_table_free_iterator_objv(BLT_TABLE_ITERATOR *iterPtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NotifyRowChanged --
+ *
+ *      Traverses the list of event callbacks and checks if one matches the
+ *      given event.  A client may trigger an action that causes the table
+ *      object to notify it.  This can be prevented by setting the
+ *      TABLE_NOTIFY_FOREIGN_ONLY bit in the event handler.
+ *
+ *      If a matching handler is found, a callback may be called either
+ *      immediately or at the next idle time depending upon the
+ *      TABLE_NOTIFY_WHENIDLE bit.
+ *
+ *      Since a handler routine may trigger yet another call to itself,
+ *      callbacks are ignored while the event handler is executing.
+ *      
+ *---------------------------------------------------------------------------
+ */
+static void
+NotifyRowChanged(Table *tablePtr, Row *rowPtr, unsigned int flags)
 {
-    if ((iterPtr->type == TABLE_ITERATOR_CHAIN) && (iterPtr->chain != NULL)) {
-        Blt_Chain_Destroy(iterPtr->chain);
-        iterPtr->chain = NULL;
-    }
+    BLT_TABLE_NOTIFY_EVENT event;
+
+    /* Vectors bound to columns follow the order of the rows. */
+    MarkBindingsStale(tablePtr->corePtr);
+    InitNotifyEvent(tablePtr, &event);
+    event.type = flags | TABLE_NOTIFY_ROW;
+    event.row = rowPtr;
+    NotifyClients(tablePtr, &event);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * FreeTrace --
- *
- *      Memory is deallocated for the trace.
+ * blt_table_clear_row_traces --
  *
- * Results:
- *      None.
+ *      Removes all traces set for this row.  Note that this doesn't remove
+ *      traces set for specific cells (row,column).  Row traces are stored
+ *      in a chain, which in turn is held in a hash table, keyed by the
+ *      row.
  *
  *---------------------------------------------------------------------------
  */
-static void
-FreeTrace(Trace *tracePtr)
+void
+blt_table_clear_row_traces(Table *tablePtr, Row *rowPtr)
 {
-    if (tracePtr->rowTag != NULL) {
-        Blt_Free(tracePtr->rowTag);
+    Blt_ChainLink link, next;
+
+    for (link = Blt_Chain_FirstLink(tablePtr->readTraces); link != NULL; 
+         link = next) {
+        Trace *tracePtr;
+
+        next = Blt_Chain_NextLink(link);
+        tracePtr = Blt_Chain_GetValue(link);
+        if (tracePtr->row == rowPtr) {
+            blt_table_delete_trace(tablePtr, tracePtr);
+        }
     }
-    if (tracePtr->colTag != NULL) {
-        Blt_Free(tracePtr->colTag);
+    for (link = Blt_Chain_FirstLink(tablePtr->writeTraces); link != NULL; 
+         link = next) {
+        Trace *tracePtr;
+
+        next = Blt_Chain_NextLink(link);
+        tracePtr = Blt_Chain_GetValue(link);
+        if (tracePtr->row == rowPtr) {
+            blt_table_delete_trace(tablePtr, tracePtr);
+        }
     }
-    Blt_Free(tracePtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_delete_trace --
- *
- *      Deletes a trace.
- *
- * Results:
- *      None.
+ * blt_table_clear_column_traces --
  *
- * Side Effects:
- *      Memory is deallocated for the trace.
+ *      Removes all traces set for this column.  Note that this doesn't
+ *      remove traces set for specific cells (row,column).  Column traces
+ *      are stored in a chain, which in turn is held in a hash table, keyed
+ *      by the column.
  *
  *---------------------------------------------------------------------------
  */
 void
-blt_table_delete_trace(Table *tablePtr, Trace *tracePtr)
+blt_table_clear_column_traces(Table *tablePtr, BLT_TABLE_COLUMN column)
 {
-    Blt_HashEntry *hPtr;
+    Blt_ChainLink link, next;
 
-    hPtr = Blt_FindHashEntry(&tablePtr->traces, tracePtr);
-    if (hPtr == NULL) {
-        return;                         /* Invalid trace token. */
-    }
-    Blt_DeleteHashEntry(&tablePtr->traces, hPtr);
-    if ((tracePtr->flags & TABLE_TRACE_DESTROYED) == 0) {
-        if (tracePtr->deleteProc != NULL) {
-            (*tracePtr->deleteProc)(tracePtr->clientData);
-        }
-        if (tracePtr->flags & TABLE_TRACE_PENDING) {
-            Tcl_CancelIdleCall(TraceIdleProc, tracePtr);
-        }
-        /* 
-         * This accomplishes two things.  
-         * 1) It doesn't let it anything match the trace and 
-         * 2) marks the trace as invalid. 
-         */
-        /* Take it out of the list so you can't use it anymore. */
-        if (tracePtr->readLink != NULL) {
-            Blt_Chain_DeleteLink(tablePtr->readTraces, tracePtr->readLink);
-            tracePtr->readLink = NULL;
+    for (link = Blt_Chain_FirstLink(tablePtr->readTraces); link != NULL; 
+         link = next) {
+        Trace *tracePtr;
+
+        next = Blt_Chain_NextLink(link);
+        tracePtr = Blt_Chain_GetValue(link);
+        if (tracePtr->column == column) {
+            blt_table_delete_trace(tablePtr, tracePtr);
         }
-        if (tracePtr->writeLink != NULL) {
-            Blt_Chain_DeleteLink(tablePtr->writeTraces, tracePtr->writeLink);
-            tracePtr->writeLink = NULL;
+    }
+    for (link = Blt_Chain_FirstLink(tablePtr->writeTraces); link != NULL; 
+         link = next) {
+        Trace *tracePtr;
+
+        next = Blt_Chain_NextLink(link);
+        tracePtr = Blt_Chain_GetValue(link);
+        if (tracePtr->column == column) {
+            blt_table_delete_trace(tablePtr, tracePtr);
         }
-        tracePtr->flags = TABLE_TRACE_DESTROYED;        
-        Tcl_EventuallyFree(tracePtr, (Tcl_FreeProc *)FreeTrace);
     }
 }
 
+
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_create_trace --
+ * CallClientTraces --
  *
- *      Creates a trace for one or more rows/columns in the table based
- *      upon the given criteria.  Whenever a matching action occurs in the
- *      table object, the specified procedure is executed.
+ *      Examines the traces set for a specific client of the table object
+ *      and fires any matching traces.
  *
- *      The trace may be put into 1 or 2 callback lists: one for read
- *      traces and another for write, create, and/or unset traces.  This is
- *      done to improve performance on reads.  We only examine the list of
- *      read traces, which in most cases will me empty.
+ *      Traces match on row and column tag and indices and flags.
+ *      Traces can match on
+ *           flag               type of trace (read, write, unset, create)
+ *           row index
+ *           column index
+ *           row tag
+ *           column tag
+ *
+ *      If the TABLE_TRACE_FOREIGN_ONLY is set in the handler, it means to
+ *      ignore actions that are initiated by that client of the object.
+ *      Only actions by other clients are handled.
  *
  * Results:
- *      Returns a token for the trace.
+ *      Always returns TCL_OK.
  *
  * Side Effects:
- *      Memory is allocated for the trace.
+ *      Traces on the tuple table location may be fired.
  *
  *---------------------------------------------------------------------------
  */
-BLT_TABLE_TRACE
-blt_table_create_trace(
-    Table *tablePtr,                    /* Table to be traced. */
-    Row *rowPtr, 
-    Column *colPtr,                     /* Row/column in table. */
-    const char *rowTag, 
-    const char *colTag,
-    unsigned int flags,                 /* Bit mask indicating what actions
-                                         * to trace. */
-    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
-                                         * trace. */
-    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
-    ClientData clientData)              /* One-word of data passed along
-                                         * when the callback is
-                                         * executed. */
+static void
+CallClientTraces(Table *tablePtr, Table *clientPtr, Row *rowPtr, Column *colPtr,
+                 unsigned int flags)
 {
-    Blt_HashEntry *hPtr;
-    Trace *tracePtr;
-    int isNew;
+    Blt_Chain chain;
+    Blt_ChainLink link, next;
+    BLT_TABLE_TRACE_EVENT event;
 
-    tracePtr = Blt_Calloc(1, sizeof (Trace));
-    if (tracePtr == NULL) {
-        return NULL;
+    /* Initialize trace event information. */
+    event.table = clientPtr;
+    event.row = rowPtr;
+    event.column = colPtr;
+    event.interp = clientPtr->interp;
+    if (tablePtr == clientPtr) {
+        flags |= TABLE_TRACE_SELF;
     }
-    tracePtr->row = rowPtr;
-    tracePtr->column = colPtr;
-    if (rowTag != NULL) {
-        tracePtr->rowTag = Blt_AssertStrdup(rowTag);
-    }
-    if (colTag != NULL) {
-        tracePtr->colTag = Blt_AssertStrdup(colTag);
-    }
-    tracePtr->flags = flags;
-    tracePtr->proc = proc;
-    tracePtr->deleteProc = deleteProc;
-    tracePtr->clientData = clientData;
-    if (tracePtr->flags & TABLE_TRACE_READS) {
-        tracePtr->readLink = Blt_Chain_Append(tablePtr->readTraces, tracePtr);
-    }
-    if (tracePtr->flags & 
-        (TABLE_TRACE_WRITES | TABLE_TRACE_UNSETS | TABLE_TRACE_CREATES)) {
-        tracePtr->writeLink = Blt_Chain_Append(tablePtr->writeTraces, tracePtr);
+    event.mask = flags;
+    if (flags & TABLE_TRACE_READS) {
+        chain = clientPtr->readTraces;
+    } else {
+        chain = clientPtr->writeTraces;
     }
-    hPtr = Blt_CreateHashEntry(&tablePtr->traces, tracePtr, &isNew);
-    Tcl_SetHashValue(hPtr, tracePtr);
-    assert(isNew);
-    tracePtr->table = tablePtr;
-    return tracePtr;
-}
-
-void
-blt_table_trace_column(
-    Table *tablePtr,                    /* Table to be traced. */
-    Column *colPtr,                     /* Cell in table. */
-    unsigned int flags,                 /* Bit mask indicating what actions
-                                         * to trace. */
-    BLT_TABLE_TRACE_PROC *proc,        /* Callback procedure for the
-                                        * trace. */
-    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
-    ClientData clientData)              /* One-word of data passed along
-                                         * when the callback is
-                                         * executed. */
-{
-    blt_table_create_trace(tablePtr, NULL, colPtr, NULL, NULL, flags,
-                           proc, deleteProc, clientData);
-}
-
-BLT_TABLE_TRACE
-blt_table_create_column_trace(
-    Table *tablePtr,                    /* Table to be traced. */
-    Column *colPtr,                     /* Cell in table. */
-    unsigned int flags,                 /* Bit mask indicating what actions
-                                         * to trace. */
-    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
-                                         * trace. */
-    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
-    ClientData clientData)              /* One-word of data passed along
-                                         * when the callback is
-                                         * executed. */
-{
-    return blt_table_create_trace(tablePtr, NULL, colPtr, NULL, NULL, flags,
-                proc, deleteProc, clientData);
-}
-
-BLT_TABLE_TRACE
-blt_table_create_column_tag_trace(
-    Table *tablePtr,                    /* Table to be traced. */
-    const char *colTag,                 /* Cell in table. */
-    unsigned int flags,                 /* Bit mask indicating what actions
-                                         * to trace. */
-    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
-                                         * trace. */
-    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
-    ClientData clientData)              /* One-word of data passed along
-                                         * when the callback is
-                                         * executed. */
-{
-    return blt_table_create_trace(tablePtr, NULL, NULL, NULL, colTag, flags,
-                proc, deleteProc, clientData);
-}
-
-void
-blt_table_trace_row(
-    Table *tablePtr,                    /* Table to be traced. */
-    Row *rowPtr,                        /* Cell in table. */
-    unsigned int flags,                 /* Bit mask indicating what actions
-                                         * to trace. */
-    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
-                                         * trace. */
-    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
-    ClientData clientData)              /* One-word of data passed along
-                                         * when the callback is
-                                         * executed. */
-{
-    blt_table_create_trace(tablePtr, 
-        rowPtr,                         /* Row */
-        (BLT_TABLE_COLUMN)NULL,         /* Column */
-        (const char *)NULL,             /* Row tag. */
-        (const char *)NULL,             /* Column tag. */
-        flags,                          /* Flags. */
-        proc,                           /* Callback procedure. */
-        deleteProc,                     /* Delete callback procedure. */
-        clientData);                    /* Data passed to callbacks. */
-}
+    for (link = Blt_Chain_FirstLink(chain); link != NULL; link = next) {
+        Trace *tracePtr;
+        int match;
 
-BLT_TABLE_TRACE
-blt_table_create_row_trace(
-    Table *tablePtr,                    /* Table to be traced. */
-    Row *rowPtr,                        /* Cell in table. */
-    unsigned int flags,                 /* Bit mask indicating what actions
-                                         * to trace. */
-    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
-                                         * trace. */
-    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
-    ClientData clientData)              /* One-word of data passed along
-                                         * when the callback is
-                                         * executed. */
-{
-    return blt_table_create_trace(tablePtr, 
-        rowPtr, 
-        (Column *)NULL, 
-        (const char *)NULL, 
-        (const char *)NULL, 
-        flags,
-        proc, 
-        deleteProc, 
-        clientData);
-}
+        next = Blt_Chain_NextLink(link);
+        tracePtr = Blt_Chain_GetValue(link);
 
-BLT_TABLE_TRACE
-blt_table_create_row_tag_trace(
-    Table *tablePtr,                    /* Table to be traced. */
-    const char *rowTag,                 /* Cell in table. */
-    unsigned int flags,                 /* Bit mask indicating what actions
-                                         * to trace. */
-    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
-                                         * trace. */
-    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
-    ClientData clientData)              /* One-word of data passed along
-                                         * when the callback is
-                                         * executed. */
-{
-    return blt_table_create_trace(tablePtr, NULL, NULL, rowTag, NULL, flags,
-                proc, deleteProc, clientData);
+        if ((tracePtr->flags & flags) == 0) {
+            continue;                   /* Doesn't match trace flags. */
+        }
+        if (tracePtr->flags & TABLE_TRACE_ACTIVE) {
+            continue;                   /* Ignore callbacks that were
+                                         * triggered from the active trace
+                                         * handler routine. */
+        }
+        match = 0;
+        if (tracePtr->colTag != NULL) {
+            if (blt_table_column_has_tag(clientPtr, colPtr, 
+                        tracePtr->colTag)) {
+                match++;
+            }
+        } else if ((tracePtr->column == colPtr) || (tracePtr->column == NULL)) {
+            match++;
+        }
+        if (tracePtr->rowTag != NULL) {
+            if (blt_table_row_has_tag(clientPtr, rowPtr, tracePtr->rowTag)) {
+                match++;
+            }
+        } else if ((tracePtr->row == rowPtr) || (tracePtr->row == NULL)) {
+            match++;
+        }
+        if (match < 2) {
+            continue;                   /* Must match both row and
+                                         * column.  */
+        }
+        if (tracePtr->flags & TABLE_TRACE_WHENIDLE) {
+            if ((tracePtr->flags & TABLE_TRACE_PENDING) == 0) {
+                tracePtr->flags |= TABLE_TRACE_PENDING;
+                tracePtr->event = event;
+                Tcl_DoWhenIdle(TraceIdleProc, tracePtr);
+            }
+        } else {
+            if (DoTrace(tracePtr, &event) == TCL_BREAK) {
+                return;                 /* Don't complete traces on
+                                         * break. */
+            }
+        }
+    }
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_release_tags --
+ * CallTraces --
  *
- *      Releases the tag table used by this client.  
+ *      Examines the traces set for each client of the table object and
+ *      fires any matching traces.
+ *
+ *      Traces match on row and column indices and flags.
+ *      The order is 
+ *        1. column traces.
+ *        2. row traces.
+ *        3. cell (row,column) traces.
+ *
+ *      If no matching criteria is specified (no tag, key, or tuple
+ *      address) then only the bit flag has to match.
+ *
+ *      If the TABLE_TRACE_FOREIGN_ONLY is set in the handler, it means to
+ *      ignore actions that are initiated by that client of the object.
+ *      Only actions by other clients are handled.
  *
  * Results:
- *      None.
+ *      Always returns TCL_OK.
  *
  * Side Effects:
- *      If no client is using the table, then it is freed.
+ *      Traces on the tuple table location may be fired.
  *
  *---------------------------------------------------------------------------
  */
-void
-blt_table_release_tags(Table *tablePtr)
+static void
+CallTraces(Table *tablePtr, Row *rowPtr, Column *colPtr, unsigned int flags)
 {
-    Tags *tagsPtr;
+    Blt_ChainLink link, next;
 
-    tagsPtr = tablePtr->tags;
-    tagsPtr->refCount--;
-    if (tagsPtr->refCount <= 0) {
-        Blt_Tags_Reset(&tagsPtr->rowTags);
-        tablePtr->rowTags = NULL;
-        Blt_Tags_Reset(&tagsPtr->columnTags);
-        tablePtr->columnTags = NULL;
-        Blt_Free(tagsPtr);
+    if (((flags & TABLE_TRACE_READS) == 0) && (colPtr->bindPtr != NULL)) {
+        UpdateBinding(colPtr->bindPtr, rowPtr, flags);
+    }
+    if (((flags & TABLE_TRACE_READS) == 0) && (IsBatching(tablePtr))) {
+        /* Only remember the cell if some client has a write trace. */
+        for (link = Blt_Chain_FirstLink(tablePtr->corePtr->clients); 
+             link != NULL; link = Blt_Chain_NextLink(link)) {
+            Table *clientPtr;
+
+            clientPtr = Blt_Chain_GetValue(link);
+            if (Blt_Chain_GetLength(clientPtr->writeTraces) > 0) {
+                DeferTrace(tablePtr, rowPtr, colPtr, flags);
+                break;
+            }
+        }
+        return;
+    }
+    for (link = Blt_Chain_FirstLink(tablePtr->corePtr->clients); link != NULL; 
+         link = next) {
+        Table *clientPtr;
+
+        next = Blt_Chain_NextLink(link);
+        clientPtr = Blt_Chain_GetValue(link);
+        CallClientTraces(tablePtr, clientPtr, rowPtr, colPtr, flags);
     }
 }
 
+
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_tags_are_shared --
- *
- *      Returns whether the tag table is shared with another client.
+ * blt_table_begin_batch --
  *
- * Results:
- *      Returns TRUE if the current tag table is shared with another
- *      client, FALSE otherwise.
+ *      Starts a batch of changes to the table by this client.  Until the
+ *      batch ends, write, create, and unset traces and notifier events
+ *      aren't delivered.  Batches may be nested.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_tags_are_shared(Table *tablePtr)
+void
+blt_table_begin_batch(Table *tablePtr)
 {
-    return (tablePtr->tags->refCount > 1);
-}   
+    if (tablePtr->batchPtr == NULL) {
+        TableBatch *batchPtr;
+
+        batchPtr = Blt_AssertCalloc(1, sizeof(TableBatch));
+        Blt_InitHashTable(&batchPtr->cellTable, 
+                          sizeof(RowColumnKey) / sizeof(int));
+        Blt_InitHashTable(&batchPtr->eventTable, 
+                          sizeof(BatchEventKey) / sizeof(int));
+        batchPtr->cells = Blt_Chain_Create();
+        batchPtr->events = Blt_Chain_Create();
+        tablePtr->batchPtr = batchPtr;
+    }
+    tablePtr->batchPtr->depth++;
+}
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_new_tags --
+ * blt_table_end_batch --
  *
- *      Releases the old tag table (if it exists) and creates a new empty
- *      tag table.
- *
- * Results:
- *      None.
- *
- * Side Effects:
- *      Possible frees memory for the old tag table (if no one else is
- *      using it) and resets the pointers to the new tag tables.
+ *      Ends a batch of changes.  When the outermost batch ends, the
+ *      deferred notifier events are delivered, followed by one trace for
+ *      each changed cell.
  *
  *---------------------------------------------------------------------------
  */
 void
-blt_table_new_tags(Table *tablePtr)
+blt_table_end_batch(Table *tablePtr)
 {
-    if (tablePtr->tags != NULL) {
-        blt_table_release_tags(tablePtr);
-    }
-    tablePtr->tags = NewTags();
-    tablePtr->rowTags = &tablePtr->tags->rowTags;
-    tablePtr->columnTags = &tablePtr->tags->columnTags;
-}
+    TableBatch *batchPtr;
+    Blt_ChainLink link;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_forget_row_tag --
- *
- *      Removes a tag from the row tag table.  Row tags are contained in
- *      hash tables keyed by the tag name.  Each table is in turn hashed by
- *      the row index in the row tag table.
- *
- * Results:
- *      None.
- *
- * Side Effects:
- *      Entries for the given tag in the corresponding row in hash tables
- *      may be removed.
- *      
- *---------------------------------------------------------------------------
- */
-int
-blt_table_forget_row_tag(Tcl_Interp *interp, Table *tablePtr, const char *tag)
-{
-    if ((strcmp(tag, "all") == 0) || (strcmp(tag, "end") == 0)) {
-        return TCL_OK;                  /* Can't forget reserved tags. */
+    batchPtr = tablePtr->batchPtr;
+    if ((batchPtr == NULL) || (batchPtr->depth == 0)) {
+        return;
     }
-    Blt_Tags_ForgetTag(tablePtr->rowTags, tag);
-    return TCL_OK;
-}
+    batchPtr->depth--;
+    if ((batchPtr->depth > 0) || (batchPtr->isCommitting)) {
+        return;
+    }
+    /* Callbacks may change the table again, so remove each trace or
+     * event before it's delivered. */
+    batchPtr->isCommitting = TRUE;
+    while ((link = Blt_Chain_FirstLink(batchPtr->events)) != NULL) {
+        BatchEvent *eventPtr;
+        BLT_TABLE_NOTIFY_EVENT event;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_forget_column_tag --
- *
- *      Removes a tag from the column tag table.  Column tags are contained
- *      in hash tables keyed by the tag name.  Each table is in turn hashed
- *      by the column offset in the column tag table.
- *
- * Results:
- *      None.
- *
- * Side Effects:
- *      Entries for the given tag in the corresponding column in hash tables
- *      may be removed.
- *      
- *---------------------------------------------------------------------------
- */
-int
-blt_table_forget_column_tag(Tcl_Interp *interp, Table *tablePtr, 
-                            const char *tag)
-{
-    if ((strcmp(tag, "all") == 0) || (strcmp(tag, "end") == 0)) {
-        return TCL_OK;                  /* Can't forget reserved tags. */
+        eventPtr = Blt_Chain_GetValue(link);
+        event = eventPtr->event;
+        DeleteBatchEvent(batchPtr, eventPtr);
+        NotifyClients(tablePtr, &event);
+    }
+    while ((link = Blt_Chain_FirstLink(batchPtr->cells)) != NULL) {
+        BatchCell *cellPtr;
+        Row *rowPtr;
+        Column *colPtr;
+        unsigned int flags;
+
+        cellPtr = Blt_Chain_GetValue(link);
+        rowPtr = cellPtr->rowPtr;
+        colPtr = cellPtr->colPtr;
+        flags = cellPtr->flags;
+        Blt_DeleteHashEntry(&batchPtr->cellTable, cellPtr->hashPtr);
+        Blt_Chain_DeleteLink(batchPtr->cells, link);
+        Blt_Free(cellPtr);
+        CallTraces(tablePtr, rowPtr, colPtr, flags);
+    }
+    batchPtr->isCommitting = FALSE;
+    if (batchPtr->depth == 0) {
+        FreeBatch(tablePtr);
     }
-    Blt_Tags_ForgetTag(tablePtr->columnTags, tag);
-    return TCL_OK;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_set_row_tag --
- *
- *      Associates a tag with a given row.  Individual row tags are stored
- *      in hash tables keyed by the tag name.  Each table is in turn stored
- *      in a hash table keyed by the row location. If the row is NULL, this
- *      indicates to simply create the tag entry.
- *
- * Results:
- *      None.
- *
- * Side Effects:
- *      A tag is stored for a particular row.
- *
- *---------------------------------------------------------------------------
- */
-int
-blt_table_set_row_tag(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
-                    const char *tag)
+typedef struct {
+    BLT_TABLE table;
+    BLT_TABLE_SORT_ORDER *order;
+    size_t numColumns;
+    unsigned int flags;
+} TableSortData;
+
+
+static TableSortData sortData;
+
+static int
+CompareDictionaryStrings(ClientData clientData, Column *colPtr, Row *rowPtr1, 
+                         Row *rowPtr2)
 {
-    char c;
-    long dummy;
+    Value *valuePtr1, *valuePtr2;
     
-    c = tag[0];
-    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
-        ((c == 'e') && (strcmp(tag, "end") == 0))) {
-        return TCL_OK;          /* Don't need to create reserved tags. */
-    }
-    if (c == '\0') {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be empty.", 
-                (char *)NULL);
+    valuePtr1 = valuePtr2 = NULL;
+    if (colPtr->chunks != NULL) {
+        valuePtr1 = ColumnValue(colPtr, rowPtr1->offset);
+        if (IsEmptyValue(valuePtr1)) {
+            valuePtr1 = NULL;
         }
-        return TCL_ERROR;
-    }
-    if (c == '-') {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "tag \"", tag, 
-                "\" can't start with a '-'.", (char *)NULL);
+        valuePtr2 = ColumnValue(colPtr, rowPtr2->offset);
+        if (IsEmptyValue(valuePtr2)) {
+            valuePtr2 = NULL;
         }
-        return TCL_ERROR;
     }
-    if ((isdigit(c)) && Blt_GetLong(NULL, (char *)tag, &dummy) == TCL_OK) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be a number.",
-                             (char *)NULL);
+    if (IsEmptyValue(valuePtr1)) {
+        if (IsEmptyValue(valuePtr2)) {
+            return 0;
         }
-        return TCL_ERROR;
-    }
-    if (rowPtr == NULL) {
-        Blt_Tags_AddTag(tablePtr->rowTags, tag);
-    } else {
-        Blt_Tags_AddItemToTag(tablePtr->rowTags, tag, rowPtr);
+        return 1;
+    } else if (IsEmptyValue(valuePtr2)) {
+        return -1;
     }
-    return TCL_OK;
+    assert(valuePtr1 != NULL);
+    assert(valuePtr2 != NULL);
+    return Blt_DictionaryCompare(GetValueString(valuePtr1),
+                                 GetValueString(valuePtr2));
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_set_column_tag --
- *
- *      Associates a tag with a given column.  Individual column tags are
- *      stored in hash tables keyed by the tag name.  Each table is in turn
- *      stored in a hash table keyed by the column location.  If the column
- *      is NULL, then this means to simply create the tag.
- *
- * Results:
- *      None.
- *
- * Side Effects:
- *      A tag is stored for a particular column.
- *
- *---------------------------------------------------------------------------
- */
-int
-blt_table_set_column_tag(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
-                         const char *tag)
+static int
+CompareAsciiStrings(ClientData clientData, Column *colPtr, Row *rowPtr1, 
+                    Row *rowPtr2)
 {
-    long dummy;
-    char c;
+    Value *valuePtr1, *valuePtr2;
 
-    c = tag[0];
-    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
-        ((c == 'e') && (strcmp(tag, "end") == 0))) {
-        return TCL_OK;                  /* Don't create reserved tags. */
-    }
-    if (c == '\0') {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be empty.", 
-                             (char *)NULL);
+    valuePtr1 = valuePtr2 = NULL;
+    if (colPtr->chunks != NULL) {
+        valuePtr1 = ColumnValue(colPtr, rowPtr1->offset);
+        if (IsEmptyValue(valuePtr1)) {
+            valuePtr1 = NULL;
         }
-        return TCL_ERROR;
-    }
-    if (c == '-') {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "tag \"", tag, 
-                "\" can't start with a '-'.", (char *)NULL);
+        valuePtr2 = ColumnValue(colPtr, rowPtr2->offset);
+        if (IsEmptyValue(valuePtr2)) {
+            valuePtr2 = NULL;
         }
-        return TCL_ERROR;
     }
-    if ((isdigit(c)) &&(Blt_GetLong(NULL, (const char *)tag, &dummy)==TCL_OK)) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be a number.",
-                             (char *)NULL);
+    if (IsEmptyValue(valuePtr1)) {
+        if (IsEmptyValue(valuePtr2)) {
+            return 0;
         }
-        return TCL_ERROR;
-    }
-    if (colPtr == NULL) {
-        Blt_Tags_AddTag(tablePtr->columnTags, tag);
-    } else {
-        Blt_Tags_AddItemToTag(tablePtr->columnTags, tag, colPtr);
+        return 1;
+    } else if (IsEmptyValue(valuePtr2)) {
+        return -1;
     }
-    return TCL_OK;
+    return strcmp(GetValueString(valuePtr1), GetValueString(valuePtr2));
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_row_has_tag --
- *
- *      Checks if a tag is associated with the given row.  
- *
- * Results:
- *      Returns TRUE if the tag is found, FALSE otherwise.
- *
- *---------------------------------------------------------------------------
- */
-int
-blt_table_row_has_tag(Table *tablePtr, Row *rowPtr, const char *tag)
+static int
+CompareAsciiStringsIgnoreCase(ClientData clientData, Column *colPtr,
+                              Row *rowPtr1, Row *rowPtr2)
 {
-    char c;
+    Value *valuePtr1, *valuePtr2;
 
-    c = tag[0];
-    if ((c == 'a') && (strcmp(tag, "all") == 0)) {
-        return TRUE;            /* "all" tags matches every row. */
+    valuePtr1 = valuePtr2 = NULL;
+    if (colPtr->chunks != NULL) {
+        valuePtr1 = ColumnValue(colPtr, rowPtr1->offset);
+        if (IsEmptyValue(valuePtr1)) {
+            valuePtr1 = NULL;
+        }
+        valuePtr2 = ColumnValue(colPtr, rowPtr2->offset);
+        if (IsEmptyValue(valuePtr2)) {
+            valuePtr2 = NULL;
+        }
     }
-    if ((c == 'e') && (strcmp(tag, "end") == 0)) {
-        return (blt_table_row_index(tablePtr, rowPtr)==
-                (blt_table_num_rows(tablePtr)-1));
+    if (IsEmptyValue(valuePtr1)) {
+        if (IsEmptyValue(valuePtr2)) {
+            return 0;
+        }
+        return 1;
+    } else if (IsEmptyValue(valuePtr2)) {
+        return -1;
     }
-    return Blt_Tags_ItemHasTag(tablePtr->rowTags, rowPtr, tag);
+    return strcasecmp(GetValueString(valuePtr1), GetValueString(valuePtr2));
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_column_has_tag --
- *
- *      Checks if a tag is associated with the given column.  
- *
- * Results:
- *      Returns TRUE if the tag is found, FALSE otherwise.
- *
- *---------------------------------------------------------------------------
- */
-int
-blt_table_column_has_tag(Table *tablePtr, Column *colPtr, const char *tag)
+static int
+CompareInt64s(ClientData clientData, Column *colPtr, Row *rowPtr1, 
+              Row *rowPtr2)
 {
-    char c;
+    Value *valuePtr1, *valuePtr2;
 
-    c = tag[0];
-    if ((c == 'a') && (strcmp(tag, "all") == 0)) {
-        return TRUE;                    /* "all" tags matches every column. */
+    valuePtr1 = valuePtr2 = NULL;
+    if (colPtr->chunks != NULL) {
+        valuePtr1 = ColumnValue(colPtr, rowPtr1->offset);
+        if (IsEmptyValue(valuePtr1)) {
+            valuePtr1 = NULL;
+        }
+        valuePtr2 = ColumnValue(colPtr, rowPtr2->offset);
+        if (IsEmptyValue(valuePtr2)) {
+            valuePtr2 = NULL;
+        }
     }
-    if ((c == 'e') && (strcmp(tag, "end") == 0)) {
-        return (colPtr == (Column *)tablePtr->corePtr->columns.tailPtr);
+    if (IsEmptyValue(valuePtr1)) {
+        if (IsEmptyValue(valuePtr2)) {
+            return 0;
+        }
+        return 1;
+    } else if (IsEmptyValue(valuePtr2)) {
+        return -1;
     }
-    return Blt_Tags_ItemHasTag(tablePtr->columnTags, colPtr, tag);
+    if (valuePtr1->datum.i64 < valuePtr2->datum.i64) {
+        return -1;
+    } else if (valuePtr1->datum.i64 > valuePtr2->datum.i64) {
+        return 1;
+    }
+    return 0;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_unset_row_tag --
- *
- *      Removes a tag from a given row.  
- *
- * Results:
- *      A standard TCL result.  If an error occurred, TCL_ERROR is returned
- *      and the interpreter result contains the error message.
- *
- * Side Effects:
- *      The tag associated with the row is freed.
- *
- *---------------------------------------------------------------------------
- */
-int
-blt_table_unset_row_tag(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
-                        const char *tag)
+static int
+CompareLongs(ClientData clientData, Column *colPtr, Row *rowPtr1, 
+             Row *rowPtr2)
 {
-    char c;
+    Value *valuePtr1, *valuePtr2;
 
-    c = tag[0];
-    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
-        ((c == 'e') && (strcmp(tag, "end") == 0))) {
-        return TCL_OK;                  /* Can't remove reserved tags. */
-    } 
-    Blt_Tags_RemoveItemFromTag(tablePtr->rowTags, tag, rowPtr);
-    return TCL_OK;
-}    
+    valuePtr1 = valuePtr2 = NULL;
+    if (colPtr->chunks != NULL) {
+        valuePtr1 = ColumnValue(colPtr, rowPtr1->offset);
+        if (IsEmptyValue(valuePtr1)) {
+            valuePtr1 = NULL;
+        }
+        valuePtr2 = ColumnValue(colPtr, rowPtr2->offset);
+        if (IsEmptyValue(valuePtr2)) {
+            valuePtr2 = NULL;
+        }
+    }
+    if (IsEmptyValue(valuePtr1)) {
+        if (IsEmptyValue(valuePtr2)) {
+            return 0;
+        }
+        return 1;
+    } else if (IsEmptyValue(valuePtr2)) {
+        return -1;
+    }
+    if (valuePtr1->datum.l < valuePtr2->datum.l) {
+        return -1;
+    } else if (valuePtr1->datum.l > valuePtr2->datum.l) {
+        return 1;
+    }
+    return 0;
+}
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_unset_column_tag --
- *
- *      Removes a tag from a given column.  
- *
- * Results:
- *      A standard TCL result.  If an error occurred, TCL_ERROR
- *      is returned and the interpreter result contains the error
- *      message.
- *
- * Side Effects:
- *      The tag associated with the column is freed.
- *
- *---------------------------------------------------------------------------
- */
-int
-blt_table_unset_column_tag(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
-                         const char *tag)
+static int
+CompareDoubles(ClientData clientData, Column *colPtr, Row *rowPtr1, 
+                    Row *rowPtr2)
 {
-    char c;
+    Value *valuePtr1, *valuePtr2;
 
-    c = tag[0];
-    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
-        ((c == 'e') && (strcmp(tag, "end") == 0))) {
-        return TCL_OK;                  /* Can't remove reserved tags. */
-    } 
-    Blt_Tags_RemoveItemFromTag(tablePtr->columnTags, tag, colPtr);
-    return TCL_OK;
-}    
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_clear_row_tags --
- *
- *      Removes all tags for a given row.  
- *
- * Results:
- *      None.
- *
- * Side Effects:
- *      All tags associated with the row are freed.
- *
- *---------------------------------------------------------------------------
- */
-void
-blt_table_clear_row_tags(Table *tablePtr, Row *rowPtr)
-{
-    Blt_Tags_ClearTagsFromItem(tablePtr->rowTags, rowPtr);
+    valuePtr1 = valuePtr2 = NULL;
+    if (colPtr->chunks != NULL) {
+        valuePtr1 = ColumnValue(colPtr, rowPtr1->offset);
+        if (IsEmptyValue(valuePtr1)) {
+            valuePtr1 = NULL;
+        }
+        valuePtr2 = ColumnValue(colPtr, rowPtr2->offset);
+        if (IsEmptyValue(valuePtr2)) {
+            valuePtr2 = NULL;
+        }
+    }
+    if (IsEmptyValue(valuePtr1)) {
+        if (IsEmptyValue(valuePtr2)) {
+            return 0;
+        }
+        return 1;
+    } else if (IsEmptyValue(valuePtr2)) {
+        return -1;
+    }
+    if (valuePtr1->datum.d < valuePtr2->datum.d) {
+        return -1;
+    } else if (valuePtr1->datum.d > valuePtr2->datum.d) {
+        return 1;
+    }
+    return 0;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_clear_column_tags --
- *
- *      Removes all tags for a given column.  
- *
- * Results:
- *      None.
- *
- * Side Effects:
- *      All tags associated with the column are freed.
- *
- *---------------------------------------------------------------------------
- */
-void
-blt_table_clear_column_tags(Table *tablePtr, Column *colPtr)
+static int
+ComparePackedDoubles(ClientData clientData, Column *colPtr, Row *rowPtr1, 
+                     Row *rowPtr2)
 {
-    Blt_Tags_ClearTagsFromItem(tablePtr->columnTags, colPtr);
+    double d1, d2;
+
+    if (!PackedExists(colPtr, rowPtr1->offset)) {
+        return (PackedExists(colPtr, rowPtr2->offset)) ? 1 : 0;
+    } else if (!PackedExists(colPtr, rowPtr2->offset)) {
+        return -1;
+    }
+    d1 = PackedDouble(colPtr, rowPtr1->offset);
+    d2 = PackedDouble(colPtr, rowPtr2->offset);
+    if (d1 < d2) {
+        return -1;
+    } else if (d1 > d2) {
+        return 1;
+    }
+    return 0;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_get_value --
- *
- *      Gets a scalar Tcl_Obj value from the table at the designated
- *      row, column location.  "Read" traces may be fired *before* the
- *      value is retrieved.  If no value exists at that location,
- *      *objPtrPtr is set to NULL.
- *
- * Results:
- *      A standard TCL result.  Returns TCL_OK if successful accessing
- *      the table location.  If an error occurs, TCL_ERROR is returned
- *      and an error message is left in the interpreter.
- *
- * -------------------------------------------------------------------------- 
- */
-BLT_TABLE_VALUE
-blt_table_get_value(Table *tablePtr, Row *rowPtr, Column *colPtr)
+static int
+ComparePackedInt64s(ClientData clientData, Column *colPtr, Row *rowPtr1, 
+                    Row *rowPtr2)
 {
-    return GetValue(tablePtr, rowPtr, colPtr);
+    int64_t i1, i2;
+
+    if (!PackedExists(colPtr, rowPtr1->offset)) {
+        return (PackedExists(colPtr, rowPtr2->offset)) ? 1 : 0;
+    } else if (!PackedExists(colPtr, rowPtr2->offset)) {
+        return -1;
+    }
+    i1 = PackedInt64(colPtr, rowPtr1->offset);
+    i2 = PackedInt64(colPtr, rowPtr2->offset);
+    if (i1 < i2) {
+        return -1;
+    } else if (i1 > i2) {
+        return 1;
+    }
+    return 0;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_set_value --
- *
- *      Sets a scalar Tcl_Obj value in the table at the designated row and
- *      column.  "Write" and possibly "create" or "unset" traces may be fired
- *      *after* the value is set.  If valuePtr is NULL, this indicates to
- *      unset the old value.
- *
- * Results:
- *      A standard TCL result.  Returns TCL_OK if successful setting the value
- *      at the table location.  If an error occurs, TCL_ERROR is returned and
- *      an error message is left in the interpreter.
- *
- * -------------------------------------------------------------------------- 
- */
-int
-blt_table_set_value(Table *tablePtr, Row *rowPtr, Column *colPtr, Value *newPtr)
+static INLINE int
+CompareEncodedCodes(Column *colPtr, Row *rowPtr1, Row *rowPtr2, 
+                    const char **s1Ptr, const char **s2Ptr)
 {
-    Value *valuePtr;
-    int flags;
+    unsigned int code1, code2;
 
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    flags = TABLE_TRACE_WRITES;
-    if (IsEmptyValue(newPtr)) {         /* New value is empty. This is the
-                                         * same as unsetting the value. */
-        flags |= TABLE_TRACE_UNSETS;
-    } else if (IsEmptyValue(valuePtr)) {
-        flags |= TABLE_TRACE_CREATES;   /* Old value was empty. */
+    code1 = EncodedCode(colPtr, rowPtr1->offset);
+    code2 = EncodedCode(colPtr, rowPtr2->offset);
+    if (code1 == 0) {
+        return (code2 == 0) ? 0 : 1;
+    } else if (code2 == 0) {
+        return -1;
     } 
-    if (newPtr != valuePtr) {
-        ResetValue(valuePtr);
-        *valuePtr = *newPtr;            /* Copy the value. */
-        if ((newPtr->string != NULL) &&
-            (newPtr->string != TABLE_VALUE_STORE)) {
-            valuePtr->string = Blt_AssertStrdup(newPtr->string);
-        }
-        CallTraces(tablePtr, rowPtr, colPtr, flags);
+    if (code1 == code2) {
+        return 0;
     }
-    return TCL_OK;
+    *s1Ptr = colPtr->encodingPtr->strings[code1].string;
+    *s2Ptr = colPtr->encodingPtr->strings[code2].string;
+    return 2;                           /* Compare the strings. */
 }
 
+static int
+CompareEncodedDictionaryStrings(ClientData clientData, Column *colPtr, 
+                                Row *rowPtr1, Row *rowPtr2)
+{
+    const char *s1, *s2;
+    int result;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_get_obj --
- *
- *      Gets a scalar Tcl_Obj value from the table at the designated row,
- *      column location.  "Read" traces may be fired *before* the value is
- *      retrieved.  If no value exists at that location, the return value
- *      is NULL.
- *
- * Results:
- *      A standard TCL result.  Returns TCL_OK if successful accessing the
- *      table location.  If an error occurs, TCL_ERROR is returned.
- *
- * -------------------------------------------------------------------------- 
- */
-Tcl_Obj *
-blt_table_get_obj(Table *tablePtr, Row *rowPtr, Column *colPtr)
+    result = CompareEncodedCodes(colPtr, rowPtr1, rowPtr2, &s1, &s2);
+    return (result == 2) ? Blt_DictionaryCompare(s1, s2) : result;
+}
+
+static int
+CompareEncodedAsciiStrings(ClientData clientData, Column *colPtr, 
+                           Row *rowPtr1, Row *rowPtr2)
 {
-    Value *valuePtr;
-    Tcl_Obj *objPtr;
+    const char *s1, *s2;
+    int result;
 
-    CallTraces(tablePtr, rowPtr, colPtr, TABLE_TRACE_READS);
-    if (IsEmpty(rowPtr, colPtr)) {
-        return NULL;
+    result = CompareEncodedCodes(colPtr, rowPtr1, rowPtr2, &s1, &s2);
+    return (result == 2) ? strcmp(s1, s2) : result;
+}
+
+static int
+CompareEncodedAsciiStringsIgnoreCase(ClientData clientData, Column *colPtr, 
+                                     Row *rowPtr1, Row *rowPtr2)
+{
+    const char *s1, *s2;
+    int result;
+
+    result = CompareEncodedCodes(colPtr, rowPtr1, rowPtr2, &s1, &s2);
+    return (result == 2) ? strcasecmp(s1, s2) : result;
+}
+
+BLT_TABLE_COMPARE_PROC *
+blt_table_get_compare_proc(Table *tablePtr, Column *colPtr, unsigned int flags)
+{
+    BLT_TABLE_COMPARE_PROC *proc;
+
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        if ((flags & TABLE_SORT_TYPE_MASK) == TABLE_SORT_AUTO) {
+            return (IsPackedDouble(colPtr)) ? ComparePackedDoubles :
+                ComparePackedInt64s;
+        }
+        /* String comparisons need the string representations. */
+        UnpackColumn(tablePtr, colPtr);
     }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    objPtr = GetObjFromValue(colPtr->type, valuePtr);
-    return objPtr;
+    if (colPtr->encodingPtr != NULL) {
+        switch (flags & TABLE_SORT_TYPE_MASK) {
+        case TABLE_SORT_AUTO:
+        case TABLE_SORT_DICTIONARY:
+            return CompareEncodedDictionaryStrings;
+        default:
+            return (flags & TABLE_SORT_IGNORECASE) ?
+                CompareEncodedAsciiStringsIgnoreCase :
+                CompareEncodedAsciiStrings;
+        }
+    }
+    if ((flags & TABLE_SORT_TYPE_MASK) == TABLE_SORT_AUTO) {
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_INT64:
+            proc = CompareInt64s;
+            break;
+
+        case TABLE_COLUMN_TYPE_LONG:
+        case TABLE_COLUMN_TYPE_BOOLEAN:
+            proc = CompareLongs;
+            break;
+
+        case TABLE_COLUMN_TYPE_TIME:
+        case TABLE_COLUMN_TYPE_DOUBLE:
+            proc = CompareDoubles;
+            break;
+        case TABLE_COLUMN_TYPE_STRING:
+        default:
+            proc = CompareDictionaryStrings;
+            break;
+        }
+    } else {
+        switch (flags & TABLE_SORT_TYPE_MASK) {
+        case TABLE_SORT_DICTIONARY:
+            proc = CompareDictionaryStrings;
+            break;
+        default:
+        case TABLE_SORT_ASCII:
+            if (flags & TABLE_SORT_IGNORECASE) {
+                proc = CompareAsciiStringsIgnoreCase;
+            } else {
+                proc = CompareAsciiStrings;
+            }
+            break;
+        }
+    }
+    return proc;
 }
 
 /*
- *---------------------------------------------------------------------------
- *
- * blt_table_set_obj --
- *
- *      Sets a scalar Tcl_Obj value in the table at the designated row and
- *      column.  "Write" and possibly "create" or "unset" traces may be fired
- *      *after* the value is set.  If valueObjPtr is NULL, this indicates to
- *      unset the old value.
- *
- * Results:
- *      A standard TCL result.  Returns TCL_OK if successful setting the value
- *      at the table location.  If an error occurs, TCL_ERROR is returned and
- *      an error message is left in the interpreter.
- *
- * -------------------------------------------------------------------------- 
+ * Sort engine.
+ *
+ *      Rows are sorted one column at a time, starting with the last sort
+ *      column, using a stable sort for each pass.  This gives the same
+ *      order as comparing each pair of rows column by column.  Before the
+ *      first pass the rows are put in index order, which is the final
+ *      tie breaker.
+ *
+ *      Each pass extracts the column's keys once.  Numeric columns
+ *      (double, time, long, and int64) sorted in the default mode are
+ *      mapped to unsigned 64-bit integers that keep their order and are
+ *      sorted with an LSD radix sort.  String columns are sorted with a
+ *      merge sort.  For ASCII comparisons the first 8 bytes of each
+ *      string are packed into an integer, so most comparisons don't
+ *      touch the strings.  Encoded string columns are radix sorted by
+ *      the rank of each row's string in the column's dictionary.  Other
+ *      columns are merge sorted using their comparison procedure.
+ *
+ *      Empty values sort after all other values.  A decreasing sort is
+ *      the reverse of the increasing sort.  All the state of a sort is
+ *      kept in a TableSorter on the caller's stack, so sorts can be
+ *      nested.
+ *
+ *      With worker threads, each pass sorts a run of rows per thread,
+ *      then merges pairs of runs in parallel until one run is left.
+ *      Merges are stable, so the order is the same as a serial sort.
  */
-int
-blt_table_set_obj(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                  Column *colPtr, Tcl_Obj *objPtr)
-{
-    unsigned int flags;
-    Value *valuePtr;
+typedef enum {
+    SORT_KEY_DOUBLE,                    /* Double or time value. */
+    SORT_KEY_INT64,                     /* Long or int64 value. */
+    SORT_KEY_ASCII,                     /* strcmp */
+    SORT_KEY_NOCASE,                    /* strcasecmp */
+    SORT_KEY_DICTIONARY,                /* Blt_DictionaryCompare */
+    SORT_KEY_PROC,                      /* Column's comparison proc. */
+    SORT_KEY_CODE                       /* Rank of an encoded string. */
+} SortKeyType;
 
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    flags = TABLE_TRACE_WRITES;
-    if (objPtr == NULL) {               /* New value is empty. This is the 
-                                         * same as unsetting the value. */
-        flags |= TABLE_TRACE_UNSETS;
-    } else if (IsEmptyValue(valuePtr)) {
-        flags |= TABLE_TRACE_CREATES;
-    } 
-    if (SetValueFromObj(interp, colPtr->type, objPtr, valuePtr) != TCL_OK) {
-        return TCL_ERROR;
+typedef struct {
+    uint64_t key;                       /* Order-preserving numeric key. */
+    Row *rowPtr;
+} RadixEntry;
+
+typedef struct {
+    uint64_t prefix;                    /* First 8 bytes of the string,
+                                         * big-endian. */
+    const char *string;                 /* NULL if the value is empty. */
+    Row *rowPtr;
+} MergeEntry;
+
+typedef struct {
+    Table *tablePtr;
+    BLT_TABLE_SORT_ORDER *sortPtr;      /* Column of the current pass. */
+    SortKeyType keyType;                /* Type of key of the current
+                                         * pass. */
+    Row **rows;                         /* Rows being sorted. */
+    size_t numRows;
+    void *buffer;                       /* Scratch space for the keys. */
+    int numWorkers;                     /* # of threads sorting runs of
+                                         * rows. */
+    size_t *runs;                       /* Start of each sorted run of
+                                         * entries, and the end of the
+                                         * last. */
+    size_t *numValues;                  /* # of non-empty values at the
+                                         * front of each run of radix
+                                         * entries. */
+    int numRuns;
+    void *src, *dst;                    /* Arrays merged from and to. */
+} TableSorter;
+
+#define SORT_SIGN_BIT           ((uint64_t)1 << 63)
+#define SORT_RADIX_BITS         11
+#define SORT_MIN_MERGE          16
+
+#define IsRadixKey(k)   \
+    (((k) == SORT_KEY_DOUBLE) || ((k) == SORT_KEY_INT64) || \
+     ((k) == SORT_KEY_CODE))
+
+static INLINE uint64_t
+GetDoubleSortKey(double d)
+{
+    union {
+        double d;
+        uint64_t u;
+    } x;
+
+    if (isnan(d)) {
+        return ~(uint64_t)0;            /* NaNs sort after numbers. */
+    }
+    if (d == 0.0) {
+        d = 0.0;                        /* -0.0 sorts with 0.0 */
+    }
+    x.d = d;
+    /* Flip all the bits of negative numbers and the sign bit of positive
+     * numbers, so that the bits compare as unsigned integers. */
+    return (x.u & SORT_SIGN_BIT) ? ~x.u : (x.u | SORT_SIGN_BIT);
+}
+
+static INLINE uint64_t
+GetInt64SortKey(int64_t i)
+{
+    return (uint64_t)i ^ SORT_SIGN_BIT;
+}
+
+static INLINE uint64_t
+GetStringSortPrefix(const char *string, int noCase)
+{
+    const unsigned char *s;
+    uint64_t prefix;
+    int i;
+
+    s = (const unsigned char *)string;
+    prefix = 0;
+    for (i = 0; i < 8; i++) {
+        unsigned int c;
+
+        c = s[i];
+        if (c == '\0') {
+            if (i > 0) {
+                prefix <<= 8 * (8 - i);
+            }
+            break;
+        }
+        if (noCase) {
+            c = tolower(c);
+        }
+        prefix = (prefix << 8) | c;
+    }
+    return prefix;
+}
+
+static SortKeyType
+GetSortKeyType(Column *colPtr, unsigned int flags)
+{
+    switch (flags & TABLE_SORT_TYPE_MASK) {
+    case TABLE_SORT_AUTO:
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_DOUBLE:
+        case TABLE_COLUMN_TYPE_TIME:
+            return SORT_KEY_DOUBLE;
+        case TABLE_COLUMN_TYPE_LONG:
+        case TABLE_COLUMN_TYPE_INT64:
+            return SORT_KEY_INT64;
+        case TABLE_COLUMN_TYPE_BOOLEAN:
+            return SORT_KEY_PROC;
+        default:
+            return SORT_KEY_DICTIONARY;
+        }
+    case TABLE_SORT_DICTIONARY:
+        return SORT_KEY_DICTIONARY;
+    default:
+        return (flags & TABLE_SORT_IGNORECASE) ? SORT_KEY_NOCASE : 
+            SORT_KEY_ASCII;
     }
-    CallTraces(tablePtr, rowPtr, colPtr, flags);
-    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_unset_value --
+ * RadixSortEntries --
  *
- *      Unsets a scalar Tcl_Obj value in the table at the designated row,
- *      column location.  It's okay is there is presently no value at the
- *      location. Unset traces may be fired *before* the value is unset.
+ *      Sorts the entries by their 64-bit keys using an LSD radix sort.
+ *      Only the range of bits that differ between keys is sorted: the
+ *      high bits of timestamps are usually the same, and the low bits of
+ *      whole numbers stored as doubles are zero.  The range is split into
+ *      as few passes of at most SORT_RADIX_BITS bits as possible.  The
+ *      counts for every pass are computed in a single scan.  The sort is
+ *      stable.
  *
  * Results:
- *      A standard TCL result.  Returns TCL_OK if successful unsetting the
- *      value at the table location.  If an error occurs, TCL_ERROR is
- *      returned and an error message is left in the interpreter.
+ *      Returns the array holding the sorted entries, either entries or
+ *      tmp.
  *
- * -------------------------------------------------------------------------- 
+ *---------------------------------------------------------------------------
  */
-int
-blt_table_unset_value(Table *tablePtr, Row *rowPtr, Column *colPtr)
+static RadixEntry *
+RadixSortEntries(RadixEntry *entries, RadixEntry *tmp, size_t numEntries)
 {
-    if (!IsEmpty(rowPtr, colPtr)) {
-        Value *valuePtr;
+    size_t *counts;
+    size_t i;
+    uint64_t diff, first, mask;
+    int pass, numPasses, numBits, low, high, radixBits;
+    RadixEntry *src, *dst;
 
-        valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-        CallTraces(tablePtr, rowPtr, colPtr, TABLE_TRACE_UNSETS);
-        /* Indicate the keytables need to be regenerated. */
-        if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-            tablePtr->flags |= TABLE_KEYS_DIRTY;
+    if (numEntries < 2) {
+        return entries;
+    }
+    /* Find the bits that aren't the same in every key. */
+    diff = 0;
+    first = entries[0].key;
+    for (i = 1; i < numEntries; i++) {
+        diff |= entries[i].key ^ first;
+    }
+    if (diff == 0) {
+        return entries;                 /* All keys are the same. */
+    }
+    for (low = 0; ((diff >> low) & 1) == 0; low++) {
+        /*empty*/
+    }
+    for (high = 63; ((diff >> high) & 1) == 0; high--) {
+        /*empty*/
+    }
+    numBits = high - low + 1;
+    numPasses = (numBits + SORT_RADIX_BITS - 1) / SORT_RADIX_BITS;
+    radixBits = (numBits + numPasses - 1) / numPasses;
+    mask = ((uint64_t)1 << radixBits) - 1;
+    counts = Blt_AssertCalloc(numPasses << radixBits, sizeof(size_t));
+    for (i = 0; i < numEntries; i++) {
+        uint64_t key;
+
+        key = entries[i].key >> low;
+        for (pass = 0; pass < numPasses; pass++) {
+            counts[(pass << radixBits) + (key & mask)]++;
+            key >>= radixBits;
         }
-        ResetValue(valuePtr);
     }
-    return TCL_OK;
+    src = entries, dst = tmp;
+    for (pass = 0; pass < numPasses; pass++) {
+        size_t *countPtr;
+        size_t offset;
+        int shift, j;
+        RadixEntry *hold;
+
+        shift = low + pass * radixBits;
+        countPtr = counts + (pass << radixBits);
+        offset = 0;
+        for (j = 0; j <= mask; j++) {
+            size_t count;
+
+            count = countPtr[j];
+            countPtr[j] = offset;
+            offset += count;
+        }
+        for (i = 0; i < numEntries; i++) {
+            dst[countPtr[(src[i].key >> shift) & mask]++] = src[i];
+        }
+        hold = src, src = dst, dst = hold;
+    }
+    Blt_Free(counts);
+    return src;
+}
+
+static INLINE int
+CompareMergeEntries(TableSorter *sorterPtr, MergeEntry *entryPtr1, 
+                    MergeEntry *entryPtr2)
+{
+    const char *s1, *s2;
+
+    if (sorterPtr->keyType == SORT_KEY_PROC) {
+        BLT_TABLE_SORT_ORDER *sortPtr;
+
+        sortPtr = sorterPtr->sortPtr;
+        return (*sortPtr->cmpProc)(sortPtr->clientData, sortPtr->column, 
+                entryPtr1->rowPtr, entryPtr2->rowPtr);
+    }
+    s1 = entryPtr1->string, s2 = entryPtr2->string;
+    if (s1 == NULL) {
+        return (s2 == NULL) ? 0 : 1;
+    } else if (s2 == NULL) {
+        return -1;
+    }
+    if (sorterPtr->keyType == SORT_KEY_DICTIONARY) {
+        return Blt_DictionaryCompare(s1, s2);
+    }
+    if (entryPtr1->prefix != entryPtr2->prefix) {
+        return (entryPtr1->prefix < entryPtr2->prefix) ? -1 : 1;
+    }
+    if (entryPtr1->prefix & 0xFF) {
+        /* Both strings start with the same 8 non-NUL characters. */
+        s1 += 8, s2 += 8;
+    }
+    if (sorterPtr->keyType == SORT_KEY_NOCASE) {
+        return strcasecmp(s1, s2);
+    }
+    return strcmp(s1, s2);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_create --
- *
- *      Creates a table object by the designated name.  It's an error if a
- *      table object already exists by that name.
- *
- * Results:
- *      A standard TCL result.  If successful, a new table object is created
- *      and TCL_OK is returned.  If an object already exists or the table
- *      object can't be allocated, then TCL_ERROR is returned and an error
- *      message is left in the interpreter.
+ * MergeSortEntries --
  *
- * Side Effects:
- *      A new table object is created.
+ *      Sorts the entries with a stable merge sort.  Short runs are sorted
+ *      with an insertion sort.  The tmp array must hold at least half as
+ *      many entries.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_create(
-    Tcl_Interp *interp,                 /* Interpreter to report errors back
-                                         * to. */
-    const char *name,                   /* Name of tuple in namespace.  Object
-                                         * must not already exist. */
-    Table **tablePtrPtr)                /* (out) Client token of newly created
-                                         * table object.  Releasing the token
-                                         * will free the tuple.  If NULL, no
-                                         * token is generated. */
+static void
+MergeSortEntries(TableSorter *sorterPtr, MergeEntry *entries, MergeEntry *tmp,
+                 size_t numEntries)
 {
-    InterpData *dataPtr;
-    TableObject *corePtr;
-    Blt_ObjectName objName;
-    Table *newClientPtr;
-    Tcl_DString ds;
-    const char *qualName;
-    char string[200];
+    size_t half, i, j, k;
 
-    dataPtr = GetInterpData(interp);
-    if (name != NULL) {
-        /* Check if a client by this name already exist in the current
-         * namespace. */
-        if (GetTable(dataPtr, name, NS_SEARCH_CURRENT) != NULL) {
-            Tcl_AppendResult(interp, "a table object \"", name,
-                "\" already exists", (char *)NULL);
-            return TCL_ERROR;
+    if (numEntries <= SORT_MIN_MERGE) {
+        for (i = 1; i < numEntries; i++) {
+            MergeEntry entry;
+
+            entry = entries[i];
+            for (j = i; j > 0; j--) {
+                if (CompareMergeEntries(sorterPtr, entries + j - 1, &entry) 
+                    <= 0) {
+                    break;
+                }
+                entries[j] = entries[j - 1];
+            }
+            entries[j] = entry;
         }
-    } else {
-        /* Generate a unique name in the current namespace. */
-        do  {
-            Blt_FmtString(string, 200, "datatable%d", dataPtr->nextId++);
-        } while (GetTable(dataPtr, name, NS_SEARCH_CURRENT) != NULL);
-        name = string;
-    } 
-    /* 
-     * Tear apart and put back together the namespace-qualified name of the
-     * object.  This is to ensure that naming is consistent.
-     */ 
-    if (!Blt_ParseObjectName(interp, name, &objName, 0)) {
-        return TCL_ERROR;
-    }
-    corePtr = NewTableObject();
-    if (corePtr == NULL) {
-        Tcl_AppendResult(interp, "can't allocate table object.", (char *)NULL);
-        Tcl_DStringFree(&ds);
-        return TCL_ERROR;
+        return;
     }
-    qualName = Blt_MakeQualifiedName(&objName, &ds);
-    newClientPtr = NewTable(dataPtr, corePtr, qualName);
-    Tcl_DStringFree(&ds);
-    if (newClientPtr == NULL) {
-        Tcl_AppendResult(interp, "can't allocate table token", (char *)NULL);
-        return TCL_ERROR;
+    half = numEntries / 2;
+    MergeSortEntries(sorterPtr, entries, tmp, half);
+    MergeSortEntries(sorterPtr, entries + half, tmp, numEntries - half);
+    if (CompareMergeEntries(sorterPtr, entries + half - 1, entries + half) 
+        <= 0) {
+        return;                         /* Runs are already in order. */
+    }
+    memcpy(tmp, entries, half * sizeof(MergeEntry));
+    i = 0, j = half, k = 0;
+    while ((i < half) && (j < numEntries)) {
+        /* Take from the left run when equal to keep the sort stable. */
+        if (CompareMergeEntries(sorterPtr, entries + j, tmp + i) < 0) {
+            entries[k++] = entries[j++];
+        } else {
+            entries[k++] = tmp[i++];
+        }
     }
-    
-    if (tablePtrPtr != NULL) {
-        *tablePtrPtr = newClientPtr;
+    if (i < half) {
+        memcpy(entries + k, tmp + i, (half - i) * sizeof(MergeEntry));
     }
-    return TCL_OK;
+}
+
+static int
+CompareEncodedAscii(const void *a, const void *b)
+{
+    return strcmp((*(EncodedString **)a)->string, 
+                  (*(EncodedString **)b)->string);
+}
+
+static int
+CompareEncodedNoCase(const void *a, const void *b)
+{
+    return strcasecmp((*(EncodedString **)a)->string, 
+                      (*(EncodedString **)b)->string);
+}
+
+static int
+CompareEncodedDictionary(const void *a, const void *b)
+{
+    return Blt_DictionaryCompare((*(EncodedString **)a)->string, 
+                                 (*(EncodedString **)b)->string);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_open --
- *
- *      Allocates a token for the table object designated by name.  It's an
- *      error if no table object exists by that name.  The token returned is
- *      passed to various routines to manipulate the object.  Traces and event
- *      notifications are also made through the token.
- *
- * Results:
- *      A new token is returned representing the table object.  
+ * RankEncodedStrings --
  *
- * Side Effects:
- *      If this is the remaining client, then the table object itself is
- *      freed.
+ *      Computes the rank of each string in the dictionary of an encoded
+ *      column for the type of comparison.  Strings that compare equal
+ *      get the same rank, so a radix sort by rank orders rows just as
+ *      comparing their strings would.  The dictionary is sorted once,
+ *      instead of comparing the strings of every row.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_open(
-    Tcl_Interp *interp,                 /* Interpreter to report errors back
-                                         * to. */
-    const char *name,                   /* Name of table object in
-                                         * namespace. */
-    Table **tablePtrPtr)
+static void
+RankEncodedStrings(ColumnEncoding *encPtr, SortKeyType keyType)
 {
-    Table *tablePtr, *newClientPtr;
-    InterpData *dataPtr;
+    EncodedString **sorted;
+    int (*proc)(const void *, const void *);
+    unsigned int i, rank;
 
-    dataPtr = GetInterpData(interp);
-    tablePtr = GetTable(dataPtr, name, NS_SEARCH_BOTH);
-    if ((tablePtr == NULL) || (tablePtr->corePtr == NULL)) {
-        Tcl_AppendResult(interp, "can't find a table object \"", name, "\"", 
-                (char *)NULL);
-        return TCL_ERROR;
+    if ((encPtr->ranks != NULL) && (encPtr->rankType == (int)keyType)) {
+        return;                         /* Ranks are current. */
     }
-    newClientPtr = NewTable(dataPtr, tablePtr->corePtr, name);
-    if (newClientPtr == NULL) {
-        Tcl_AppendResult(interp, "can't allocate token for table \"", name, 
-                "\"", (char *)NULL);
-        return TCL_ERROR;
+    switch (keyType) {
+    case SORT_KEY_ASCII:
+        proc = CompareEncodedAscii;
+        break;
+    case SORT_KEY_NOCASE:
+        proc = CompareEncodedNoCase;
+        break;
+    default:
+        proc = CompareEncodedDictionary;
+        break;
+    }
+    if (encPtr->ranks == NULL) {
+        encPtr->ranks = Blt_AssertMalloc(encPtr->numAllocated * 
+                                         sizeof(unsigned int));
+    }
+    encPtr->rankType = keyType;
+    encPtr->ranks[0] = 0;
+    if (encPtr->numStrings < 2) {
+        return;
+    }
+    sorted = Blt_AssertMalloc((encPtr->numStrings - 1) * 
+                              sizeof(EncodedString *));
+    for (i = 1; i < encPtr->numStrings; i++) {
+        sorted[i - 1] = encPtr->strings + i;
+    }
+    qsort(sorted, encPtr->numStrings - 1, sizeof(EncodedString *), proc);
+    rank = 0;
+    for (i = 0; i < (encPtr->numStrings - 1); i++) {
+        if ((i == 0) || ((*proc)(sorted + i - 1, sorted + i) != 0)) {
+            rank++;
+        }
+        encPtr->ranks[sorted[i] - encPtr->strings] = rank;
+    }
+    Blt_Free(sorted);
+}
+
+static void
+SortRowsByIndex(TableSorter *sorterPtr)
+{
+    RadixEntry *entries, *sorted;
+    size_t i;
+
+    entries = sorterPtr->buffer;
+    for (i = 0; i < sorterPtr->numRows; i++) {
+        entries[i].key = (uint64_t)sorterPtr->rows[i]->index;
+        entries[i].rowPtr = sorterPtr->rows[i];
+    }
+    sorted = RadixSortEntries(entries, entries + sorterPtr->numRows, 
+                              sorterPtr->numRows);
+    for (i = 0; i < sorterPtr->numRows; i++) {
+        sorterPtr->rows[i] = sorted[i].rowPtr;
     }
-    /* By default, share tags with an existing table. Clients can can
-     * blt_table_new_tags to get a new tags table. */
-    ShareTags(tablePtr, newClientPtr);
-    *tablePtrPtr = newClientPtr;
-    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_close --
- *
- *      Releases the tuple token, indicating this the client is no longer
- *      using the object. The client is removed from the tuple object's client
- *      list.  If this is the last client, then the object itself is destroyed
- *      and memory is freed.
- *
- * Results:
- *      None.
+ * RadixSortRun --
  *
- * Side Effects:
- *      If this is the remaining client, then the table object itself
- *      is freed.
+ *      Sorts a run of rows by the numeric values of the current column.
+ *      Rows with empty values are moved after the others, keeping their
+ *      order.  With worker threads, the sorted entries are left in the
+ *      first half of the buffer to be merged.
  *
  *---------------------------------------------------------------------------
  */
-void
-blt_table_close(Table *tablePtr)
+static void
+RadixSortRun(TableSorter *sorterPtr, size_t first, size_t last, int run)
 {
-    if (tablePtr->magic != TABLE_MAGIC) {
-        Blt_Warn("invalid table object token %p\n", tablePtr);
-        return;
-    }
-    if (tablePtr->link2 != NULL) {
-        Blt_Chain chain;
+    Column *colPtr;
+    Row **rows;
+    RadixEntry *entries, *sorted;
+    size_t i, numValues, numEmpty;
+
+    colPtr = sorterPtr->sortPtr->column;
+    rows = sorterPtr->rows + first;
+    entries = (RadixEntry *)sorterPtr->buffer + first;
+    numValues = numEmpty = 0;
+    for (i = 0; i < (last - first); i++) {
+        Row *rowPtr;
+        long offset;
+        uint64_t key;
+
+        rowPtr = rows[i];
+        offset = rowPtr->offset;
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            if (!PackedExists(colPtr, offset)) {
+                rows[numEmpty++] = rowPtr;
+                continue;
+            }
+            key = (sorterPtr->keyType == SORT_KEY_DOUBLE) ?
+                GetDoubleSortKey(PackedDouble(colPtr, offset)) :
+                GetInt64SortKey(PackedInt64(colPtr, offset));
+        } else if (colPtr->encodingPtr != NULL) {
+            unsigned int code;
+
+            code = EncodedCode(colPtr, offset);
+            if (code == 0) {
+                rows[numEmpty++] = rowPtr;
+                continue;
+            }
+            key = colPtr->encodingPtr->ranks[code];
+        } else {
+            Value *valuePtr;
 
-        /* Remove the client from the list of clients using the table name.
-         * This is different from the table core. */
-        chain = Blt_GetHashValue(tablePtr->hPtr);
-        Blt_Chain_DeleteLink(chain, tablePtr->link2);
-        if (Blt_Chain_GetLength(chain) == 0) {
-            /* If no more clients are using this name, then remove it from the
-             * interpreter-specific hash table. */      
-            Blt_DeleteHashEntry(tablePtr->clientTablePtr, tablePtr->hPtr);
+            valuePtr = (colPtr->chunks != NULL) ? ColumnValue(colPtr, offset) :
+                NULL;
+            if (IsEmptyValue(valuePtr)) {
+                /* Empty rows are saved at the front of the row array,
+                 * which is never ahead of the current row. */
+                rows[numEmpty++] = rowPtr;
+                continue;
+            }
+            switch (colPtr->type) {
+            case TABLE_COLUMN_TYPE_LONG:
+                key = GetInt64SortKey(valuePtr->datum.l);
+                break;
+            case TABLE_COLUMN_TYPE_INT64:
+                key = GetInt64SortKey(valuePtr->datum.i64);
+                break;
+            default:
+                key = GetDoubleSortKey(valuePtr->datum.d);
+                break;
+            }
         }
+        entries[numValues].key = key;
+        entries[numValues].rowPtr = rowPtr;
+        numValues++;
+    }
+    sorted = RadixSortEntries(entries, 
+        (RadixEntry *)sorterPtr->buffer + sorterPtr->numRows + first, 
+        numValues);
+    if (sorterPtr->numWorkers > 1) {
+        /* Leave the run in the buffer, with the empty rows last. */
+        if (sorted != entries) {
+            memcpy(entries, sorted, numValues * sizeof(RadixEntry));
+        }
+        for (i = 0; i < numEmpty; i++) {
+            entries[numValues + i].key = 0;
+            entries[numValues + i].rowPtr = rows[i];
+        }
+        sorterPtr->numValues[run] = numValues;
+        return;
+    }
+    if (numEmpty > 0) {
+        memmove(rows + numValues, rows, numEmpty * sizeof(Row *));
+    }
+    for (i = 0; i < numValues; i++) {
+        rows[i] = sorted[i].rowPtr;
     }
-    DestroyClient(tablePtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_exists --
- *
- *      Indicates if a table object by the given name exists in either the
- *      current or global namespace.
+ * MergeSortRun --
  *
- * Results:
- *      Returns 1 if a table object exists and 0 otherwise.
+ *      Sorts a run of rows by the strings or comparison procedure of the
+ *      current column.  With worker threads, the sorted entries are left
+ *      in the first half of the buffer to be merged.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_exists(Tcl_Interp *interp, const char *name)
-{
-    InterpData *dataPtr;
-
-    dataPtr = GetInterpData(interp);
-    return (GetTable(dataPtr, name, NS_SEARCH_BOTH) != NULL);
-}
-
-static Notifier *
-CreateNotifier(Tcl_Interp *interp, Blt_Chain chain, unsigned int mask,
-               BLT_TABLE_NOTIFY_EVENT_PROC *proc, 
-               BLT_TABLE_NOTIFIER_DELETE_PROC *deleteProc, 
-               ClientData clientData)
+static void
+MergeSortRun(TableSorter *sorterPtr, size_t first, size_t last)
 {
-    Notifier *notifierPtr;
+    Column *colPtr;
+    MergeEntry *entries;
+    size_t i, numEntries;
+    int noCase;
+
+    colPtr = sorterPtr->sortPtr->column;
+    entries = (MergeEntry *)sorterPtr->buffer + first;
+    numEntries = last - first;
+    noCase = (sorterPtr->keyType == SORT_KEY_NOCASE);
+    for (i = 0; i < numEntries; i++) {
+        MergeEntry *entryPtr;
+        Value *valuePtr;
 
-    notifierPtr = Blt_AssertMalloc(sizeof (Notifier));
-    notifierPtr->proc = proc;
-    notifierPtr->deleteProc = deleteProc;
-    notifierPtr->chain = chain;
-    notifierPtr->clientData = clientData;
-    notifierPtr->column = NULL;         /* All columns. */
-    notifierPtr->row = NULL;            /* All rows. */
-    notifierPtr->tag = NULL;            /* No tag. */
-    notifierPtr->flags = mask | TABLE_NOTIFY_COLUMN | TABLE_NOTIFY_ROW;
-    notifierPtr->interp = interp;
-    notifierPtr->link = Blt_Chain_Append(chain, notifierPtr);
-    return notifierPtr;
+        entryPtr = entries + i;
+        entryPtr->rowPtr = sorterPtr->rows[first + i];
+        entryPtr->string = NULL;
+        entryPtr->prefix = 0;
+        if (sorterPtr->keyType == SORT_KEY_PROC) {
+            continue;
+        }
+        valuePtr = (colPtr->chunks != NULL) ? 
+            ColumnValue(colPtr, entryPtr->rowPtr->offset) : NULL;
+        if (IsEmptyValue(valuePtr)) {
+            continue;
+        }
+        entryPtr->string = GetValueString(valuePtr);
+        if (sorterPtr->keyType != SORT_KEY_DICTIONARY) {
+            entryPtr->prefix = GetStringSortPrefix(entryPtr->string, noCase);
+        }
+    }
+    MergeSortEntries(sorterPtr, entries, 
+        (MergeEntry *)sorterPtr->buffer + sorterPtr->numRows + first, 
+        numEntries);
+    if (sorterPtr->numWorkers == 1) {
+        for (i = 0; i < numEntries; i++) {
+            sorterPtr->rows[first + i] = entries[i].rowPtr;
+        }
+    }
 }
 
-static Notifier *
-CreateNotifierForRows(Tcl_Interp *interp, Blt_Chain chain, unsigned int mask,
-                      Row *rowPtr, const char *tag, 
-                      BLT_TABLE_NOTIFY_EVENT_PROC *proc,
-                      BLT_TABLE_NOTIFIER_DELETE_PROC *deleteProc, 
-                      ClientData clientData)
+static void
+SortRunsProc(ClientData clientData, long first, long last, int worker)
 {
-    Notifier *notifierPtr;
-
-    notifierPtr = Blt_AssertMalloc(sizeof (Notifier));
-    notifierPtr->proc = proc;
-    notifierPtr->deleteProc = deleteProc;
-    notifierPtr->chain = chain;
-    notifierPtr->clientData = clientData;
-    notifierPtr->row = rowPtr;
-    notifierPtr->column = NULL;
-    notifierPtr->tag = (tag != NULL) ? Blt_AssertStrdup(tag) : NULL;
-    notifierPtr->flags = mask | TABLE_NOTIFY_ROW;
-    notifierPtr->interp = interp;
-    notifierPtr->link = Blt_Chain_Append(chain, notifierPtr);
-    return notifierPtr;
-}
+    TableSorter *sorterPtr = clientData;
+    long i;
 
-static Notifier *
-CreateNotifierForColumns(Tcl_Interp *interp, Blt_Chain chain, unsigned int mask,
-        Column *colPtr, const char *tag, BLT_TABLE_NOTIFY_EVENT_PROC *proc,
-        BLT_TABLE_NOTIFIER_DELETE_PROC *deleteProc, ClientData clientData)
-{
-    Notifier *notifierPtr;
+    for (i = first; i < last; i++) {
+        size_t runFirst, runLast;
 
-    notifierPtr = Blt_AssertMalloc(sizeof (Notifier));
-    notifierPtr->proc = proc;
-    notifierPtr->deleteProc = deleteProc;
-    notifierPtr->chain = chain;
-    notifierPtr->clientData = clientData;
-    notifierPtr->column = colPtr;
-    notifierPtr->row = NULL;
-    notifierPtr->tag = (tag != NULL) ? Blt_AssertStrdup(tag) : NULL;
-    notifierPtr->flags = mask | TABLE_NOTIFY_COLUMN;
-    notifierPtr->interp = interp;
-    notifierPtr->link = Blt_Chain_Append(chain, notifierPtr);
-    return notifierPtr;
+        runFirst = sorterPtr->runs[i];
+        runLast = sorterPtr->runs[i + 1];
+        if (IsRadixKey(sorterPtr->keyType)) {
+            RadixSortRun(sorterPtr, runFirst, runLast, i);
+        } else {
+            MergeSortRun(sorterPtr, runFirst, runLast);
+        }
+    }
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_create_notifier --
- *
- *      Creates an event handler using the following three pieces of
- *      information: 
- *              1. C function pointer, 
- *              2. one-word of data passed on each call, and 
- *              3. event mask indicating which events are of interest.  
- *      If an event already exists matching all of the above criteria,
- *      it is repositioned on the end of the event handler list.  This
- *      means that it will be the last to fire.
+ * MergeRunsProc --
  *
- * Results:
- *      Returns a pointer to the event handler.
- *
- * Side Effects:
- *      Memory for the event handler is possibly allocated.
+ *      Merges pairs of adjacent sorted runs from the source array into
+ *      the destination array.  Entries from the left run are taken first
+ *      when equal, so the merge is stable.  Radix runs are merged by
+ *      their values, followed by the empty rows of the left run and then
+ *      the right run.  An odd run at the end is copied.
  *
  *---------------------------------------------------------------------------
  */
-BLT_TABLE_NOTIFIER
-blt_table_create_notifier(Tcl_Interp *interp, Table *tablePtr, 
-                          unsigned int mask, BLT_TABLE_NOTIFY_EVENT_PROC *proc,
-                          BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
-                          ClientData clientData)
-{
-    return CreateNotifier(interp, tablePtr->columnNotifiers, mask,  proc, 
-                          deletedProc, clientData);
+static void
+MergeRunsProc(ClientData clientData, long first, long last, int worker)
+{
+    TableSorter *sorterPtr = clientData;
+    long pair;
+
+    for (pair = first; pair < last; pair++) {
+        size_t lo, mid, hi;
+        int run;
+
+        run = pair * 2;
+        lo = sorterPtr->runs[run];
+        if ((run + 1) >= sorterPtr->numRuns) {
+            hi = sorterPtr->runs[run + 1];
+            if (IsRadixKey(sorterPtr->keyType)) {
+                memcpy((RadixEntry *)sorterPtr->dst + lo, 
+                       (RadixEntry *)sorterPtr->src + lo,
+                       (hi - lo) * sizeof(RadixEntry));
+            } else {
+                memcpy((MergeEntry *)sorterPtr->dst + lo, 
+                       (MergeEntry *)sorterPtr->src + lo,
+                       (hi - lo) * sizeof(MergeEntry));
+            }
+            continue;
+        }
+        mid = sorterPtr->runs[run + 1];
+        hi = sorterPtr->runs[run + 2];
+        if (IsRadixKey(sorterPtr->keyType)) {
+            RadixEntry *src, *dst;
+            size_t i, j, k, iEnd, jEnd;
+
+            src = sorterPtr->src, dst = sorterPtr->dst;
+            iEnd = lo + sorterPtr->numValues[run];
+            jEnd = mid + sorterPtr->numValues[run + 1];
+            i = lo, j = mid, k = lo;
+            while ((i < iEnd) && (j < jEnd)) {
+                if (src[j].key < src[i].key) {
+                    dst[k++] = src[j++];
+                } else {
+                    dst[k++] = src[i++];
+                }
+            }
+            memcpy(dst + k, src + i, (iEnd - i) * sizeof(RadixEntry));
+            k += iEnd - i;
+            memcpy(dst + k, src + j, (jEnd - j) * sizeof(RadixEntry));
+            k += jEnd - j;
+            /* Empty rows of the left run, then the right run. */
+            memcpy(dst + k, src + iEnd, (mid - iEnd) * sizeof(RadixEntry));
+            k += mid - iEnd;
+            memcpy(dst + k, src + jEnd, (hi - jEnd) * sizeof(RadixEntry));
+        } else {
+            MergeEntry *src, *dst;
+            size_t i, j, k;
+
+            src = sorterPtr->src, dst = sorterPtr->dst;
+            i = lo, j = mid, k = lo;
+            while ((i < mid) && (j < hi)) {
+                if (CompareMergeEntries(sorterPtr, src + j, src + i) < 0) {
+                    dst[k++] = src[j++];
+                } else {
+                    dst[k++] = src[i++];
+                }
+            }
+            memcpy(dst + k, src + i, (mid - i) * sizeof(MergeEntry));
+            k += mid - i;
+            memcpy(dst + k, src + j, (hi - j) * sizeof(MergeEntry));
+        }
+    }
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_create_column_notifier --
- *
- *      Creates an event handler using the following three pieces of
- *      information: 
- *              1. C function pointer, 
- *              2. one-word of data passed on each call, and 
- *              3. event mask indicating which events are of interest.  
- *      If an event already exists matching all of the above criteria,
- *      it is repositioned on the end of the event handler list.  This
- *      means that it will be the last to fire.
- *
- * Results:
- *      Returns a pointer to the event handler.
+ * SortColumn --
  *
- * Side Effects:
- *      Memory for the event handler is possibly allocated.
+ *      Sorts the rows by the current column.  With worker threads, the
+ *      rows are split into runs that are sorted in parallel and then
+ *      merged, a pair of runs per thread, until one run is left.
  *
  *---------------------------------------------------------------------------
  */
-BLT_TABLE_NOTIFIER
-blt_table_create_column_notifier(Tcl_Interp *interp, Table *tablePtr,
-                               BLT_TABLE_COLUMN col, unsigned int mask,
-                               BLT_TABLE_NOTIFY_EVENT_PROC *proc,
-                               BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
-                               ClientData clientData)
+static void
+SortColumn(TableSorter *sorterPtr)
 {
-    return CreateNotifierForColumns(interp, tablePtr->columnNotifiers, mask, 
-                col, NULL, proc, deletedProc, clientData);
-}
+    size_t entrySize, i;
+    void *hold;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_create_column_tag_notifier --
- *
- *      Creates an event handler using the following three pieces of
- *      information: 
- *              1. C function pointer, 
- *              2. one-word of data passed on each call, and 
- *              3. event mask indicating which events are of interest.  
- *      If an event already exists matching all of the above criteria,
- *      it is repositioned on the end of the event handler list.  This
- *      means that it will be the last to fire.
- *
- * Results:
- *      Returns a pointer to the event handler.
- *
- * Side Effects:
- *      Memory for the event handler is possibly allocated.
- *
- *---------------------------------------------------------------------------
- */
-BLT_TABLE_NOTIFIER
-blt_table_create_column_tag_notifier(Tcl_Interp *interp, Table *tablePtr,
-                                  const char *tag, unsigned int mask,
-                                  BLT_TABLE_NOTIFY_EVENT_PROC *proc,
-                                  BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
-                                  ClientData clientData)
-{
-    return CreateNotifierForColumns(interp, tablePtr->columnNotifiers, mask, 
-        NULL, tag, proc, deletedProc, clientData);
-}
+    if (sorterPtr->numWorkers == 1) {
+        if (IsRadixKey(sorterPtr->keyType)) {
+            RadixSortRun(sorterPtr, 0, sorterPtr->numRows, 0);
+        } else {
+            MergeSortRun(sorterPtr, 0, sorterPtr->numRows);
+        }
+        return;
+    }
+    sorterPtr->numRuns = sorterPtr->numWorkers;
+    for (i = 0; i <= sorterPtr->numRuns; i++) {
+        sorterPtr->runs[i] = sorterPtr->numRows * i / sorterPtr->numRuns;
+    }
+    blt_table_run_workers(sorterPtr->numWorkers, sorterPtr->numRuns, 
+                          SortRunsProc, sorterPtr);
+    entrySize = (IsRadixKey(sorterPtr->keyType)) ? sizeof(RadixEntry) :
+        sizeof(MergeEntry);
+    sorterPtr->src = sorterPtr->buffer;
+    sorterPtr->dst = (char *)sorterPtr->buffer + 
+        sorterPtr->numRows * entrySize;
+    while (sorterPtr->numRuns > 1) {
+        int numPairs, run;
+
+        numPairs = (sorterPtr->numRuns + 1) / 2;
+        blt_table_run_workers(numPairs, numPairs, MergeRunsProc, sorterPtr);
+        /* Every other run boundary is gone. */
+        for (run = 0; run < numPairs; run++) {
+            sorterPtr->runs[run] = sorterPtr->runs[run * 2];
+            if ((run * 2 + 1) < sorterPtr->numRuns) {
+                sorterPtr->numValues[run] = sorterPtr->numValues[run * 2] +
+                    sorterPtr->numValues[run * 2 + 1];
+            } else {
+                sorterPtr->numValues[run] = sorterPtr->numValues[run * 2];
+            }
+        }
+        sorterPtr->runs[numPairs] = sorterPtr->numRows;
+        sorterPtr->numRuns = numPairs;
+        hold = sorterPtr->src;
+        sorterPtr->src = sorterPtr->dst;
+        sorterPtr->dst = hold;
+    }
+    if (IsRadixKey(sorterPtr->keyType)) {
+        RadixEntry *entries;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_create_row_notifier --
- *
- *      Creates an event handler using the following three pieces of
- *      information: 
- *              1. C function pointer, 
- *              2. one-word of data passed on each call, and 
- *              3. event mask indicating which events are of interest.  
- *      If an event already exists matching all of the above criteria,
- *      it is repositioned on the end of the event handler list.  This
- *      means that it will be the last to fire.
- *
- * Results:
- *      Returns a pointer to the event handler.
- *
- * Side Effects:
- *      Memory for the event handler is possibly allocated.
- *
- *---------------------------------------------------------------------------
- */
-BLT_TABLE_NOTIFIER
-blt_table_create_row_notifier(Tcl_Interp *interp, Table *tablePtr, 
-                            BLT_TABLE_ROW row, unsigned int mask,
-                            BLT_TABLE_NOTIFY_EVENT_PROC *proc,
-                            BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
-                            ClientData clientData)
-{
-    return CreateNotifierForRows(interp, tablePtr->rowNotifiers, mask, row, 
-        NULL, proc, deletedProc, clientData);
-}
+        entries = sorterPtr->src;
+        for (i = 0; i < sorterPtr->numRows; i++) {
+            sorterPtr->rows[i] = entries[i].rowPtr;
+        }
+    } else {
+        MergeEntry *entries;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_create_column_tag_notifier --
- *
- *      Creates an event handler using the following three pieces of
- *      information: 
- *              1. C function pointer, 
- *              2. one-word of data passed on each call, and 
- *              3. event mask indicating which events are of interest.  
- *      If an event already exists matching all of the above criteria,
- *      it is repositioned on the end of the event handler list.  This
- *      means that it will be the last to fire.
- *
- * Results:
- *      Returns a pointer to the event handler.
- *
- * Side Effects:
- *      Memory for the event handler is possibly allocated.
- *
- *---------------------------------------------------------------------------
- */
-BLT_TABLE_NOTIFIER
-blt_table_create_row_tag_notifier(Tcl_Interp *interp, Table *tablePtr,
-                               const  char *tag, unsigned int mask,
-                               BLT_TABLE_NOTIFY_EVENT_PROC *proc,
-                               BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
-                               ClientData clientData)
-{
-    return CreateNotifierForRows(interp, tablePtr->rowNotifiers, mask, NULL, 
-        tag, proc, deletedProc, clientData);
+        entries = sorterPtr->src;
+        for (i = 0; i < sorterPtr->numRows; i++) {
+            sorterPtr->rows[i] = entries[i].rowPtr;
+        }
+    }
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_delete_notifier --
+ * SortRowMap --
  *
- *      Removes the event handler designated by following three pieces
- *      of information: 
- *         1. C function pointer, 
- *         2. one-word of data passed on each call, and 
- *         3. event mask indicating which events are of interest.
+ *      Sorts the array of rows by the columns in the sort order.
  *
  * Results:
- *      Nothing.
+ *      None.
  *
  * Side Effects:
- *      Memory for the event handler is freed.
+ *      The rows in the array are reordered.  Packed columns sorted as
+ *      strings are unpacked.
  *
  *---------------------------------------------------------------------------
  */
-void
-blt_table_delete_notifier(Table *tablePtr, Notifier *notifierPtr)
+static void
+SortRowMap(Table *tablePtr, BLT_TABLE_SORT_ORDER *order, size_t numColumns,
+           unsigned int flags, size_t numRows, Row **rows)
 {
-    /* Check if notifier is already being deleted. */
-    if ((notifierPtr->flags & TABLE_NOTIFY_DESTROYED) == 0) {
-        if (notifierPtr->deleteProc != NULL) {
-            (*notifierPtr->deleteProc)(notifierPtr->clientData);
+    TableSorter sorter;
+    size_t i, size;
+
+    for (i = 0; i < numColumns; i++) {
+        order[i].clientData = tablePtr;
+        order[i].cmpProc = blt_table_get_compare_proc(tablePtr, 
+                order[i].column, flags);
+    }
+    if (numRows < 2) {
+        return;
+    }
+    memset(&sorter, 0, sizeof(sorter));
+    sorter.tablePtr = tablePtr;
+    sorter.rows = rows;
+    sorter.numRows = numRows;
+    sorter.numWorkers = blt_table_num_workers(tablePtr, numRows);
+
+    /* Allocate enough scratch space for the largest pass. A radix pass
+     * needs two arrays of entries, a merge pass an array and a half, or
+     * two arrays if runs are merged. */
+    size = 2 * numRows * sizeof(RadixEntry);
+    for (i = 0; i < numColumns; i++) {
+        if ((order[i].column->encodingPtr == NULL) &&
+            (!IsRadixKey(GetSortKeyType(order[i].column, flags)))) {
+            size_t mergeSize;
+
+            mergeSize = (sorter.numWorkers > 1) ? 
+                2 * numRows * sizeof(MergeEntry) :
+                (numRows + numRows / 2 + 1) * sizeof(MergeEntry);
+            if (mergeSize > size) {
+                size = mergeSize;
+            }
+            break;
         }
-        if (notifierPtr->flags & TABLE_NOTIFY_PENDING) {
-            Tcl_CancelIdleCall(NotifyIdleProc, notifierPtr);
+    }
+    sorter.buffer = Blt_AssertMalloc(size);
+    if (sorter.numWorkers > 1) {
+        sorter.runs = Blt_AssertCalloc(sorter.numWorkers + 1, sizeof(size_t));
+        sorter.numValues = Blt_AssertCalloc(sorter.numWorkers, 
+                                            sizeof(size_t));
+    }
+
+    /* Start with the rows in index order, the final tie breaker. */
+    for (i = 1; i < numRows; i++) {
+        if (rows[i]->index < rows[i - 1]->index) {
+            SortRowsByIndex(&sorter);
+            break;
         }
-        notifierPtr->flags = TABLE_NOTIFY_DESTROYED;
-        Tcl_EventuallyFree(notifierPtr, (Tcl_FreeProc *)FreeNotifier);
     }
+    /* Stable sort by each column, from the last to the first. */
+    for (i = numColumns; i > 0; i--) {
+        sorter.sortPtr = order + i - 1;
+        sorter.keyType = GetSortKeyType(sorter.sortPtr->column, flags);
+        if (sorter.sortPtr->column->encodingPtr != NULL) {
+            /* Radix sort the rows by the ranks of their strings. */
+            RankEncodedStrings(sorter.sortPtr->column->encodingPtr, 
+                               sorter.keyType);
+            sorter.keyType = SORT_KEY_CODE;
+        }
+        SortColumn(&sorter);
+    }
+    if (flags & TABLE_SORT_DECREASING) {
+        size_t j;
+
+        for (i = 0, j = numRows - 1; i < j; i++, j--) {
+            Row *hold;
+
+            hold = rows[i], rows[i] = rows[j], rows[j] = hold;
+        }
+    }
+    if (sorter.runs != NULL) {
+        Blt_Free(sorter.runs);
+        Blt_Free(sorter.numValues);
+    }
+    Blt_Free(sorter.buffer);
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_get_row_by_label --
- *
- *      Returns the offset of the row given its label.  If the row label is
- *      invalid, then -1 is returned.
- *
- * Results:
- *      Returns the offset of the row or -1 if not found.
- *
- *---------------------------------------------------------------------------
- */
-BLT_TABLE_ROW
-blt_table_get_row_by_label(Table *tablePtr, const char *label)
+static void
+ReplaceRowMap(Rows *rowsPtr, Row **map)
 {
-    return FindRowLabel(&tablePtr->corePtr->rows, label);
-}
+    size_t i;
 
+    if (rowsPtr->numUsed == 0) {
+        return;
+    }
+    /* Rethread list according to the map. */
+    for (i = 0; i < rowsPtr->numUsed; i++) {
+        Row *rowPtr;
+        Row *prevPtr, *nextPtr;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_get_column_by_label --
- *
- *      Returns the offset of the column given its label.  If the column label
- *      is invalid, then -1 is returned.
- *
- * Results:
- *      Returns the offset of the column or -1 if not found.
- *
- *---------------------------------------------------------------------------
- */
-BLT_TABLE_COLUMN
-blt_table_get_column_by_label(Table *tablePtr, const char *label)
-{
-    return FindColumnLabel(&tablePtr->corePtr->columns, label);
+        prevPtr = (i > 0) ? map[i-1] : NULL;
+        nextPtr = ((i+1) < rowsPtr->numUsed) ? map[i+1] : NULL;
+        rowPtr = map[i];
+        rowPtr->prevPtr = prevPtr;
+        rowPtr->nextPtr = nextPtr;
+        rowPtr->index = i;
+    }
+    rowsPtr->headPtr = map[0];
+    rowsPtr->tailPtr = map[rowsPtr->numUsed-1];
+    if (map == rowsPtr->map) {
+        return;
+    }
+    if (rowsPtr->map != NULL) {
+        Blt_Free(rowsPtr->map);
+    }
+    /* The new map may only hold the used rows.  The map must be as large
+     * as the number of allocated rows. */
+    if (rowsPtr->numAllocated > rowsPtr->numUsed) {
+        map = Blt_AssertRealloc(map, rowsPtr->numAllocated * sizeof(Row *));
+    }
+    rowsPtr->map = map;
 }
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_column_get_label_table --
- *
- *      Returns the offset of the column given its label.  If the column label
- *      is invalid, then -1 is returned.
- *
- * Results:
- *      Returns the offset of the column or -1 if not found.
- *
- *---------------------------------------------------------------------------
- */
-Blt_HashTable *
-blt_table_column_get_label_table(Table *tablePtr, const char *label)
+static void
+ReplaceColumnMap(Columns *columnsPtr, Column **map)
 {
-    return GetColumnLabelTable(&tablePtr->corePtr->columns, label);
-}
+    size_t i;
+    Column *prevPtr;
+    Column *colPtr;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_row_get_label_table --
- *
- *      Returns the offset of the column given its label.  If the column label
- *      is invalid, then -1 is returned.
- *
- * Results:
- *      Returns the offset of the column or -1 if not found.
- *
- *---------------------------------------------------------------------------
- */
-Blt_HashTable *
-blt_table_row_get_label_table(Table *tablePtr, const char *label)
-{
-    return GetRowLabelTable(&tablePtr->corePtr->rows, label);
-}
+    if (columnsPtr->numUsed == 0) {
+        return;
+    }
+    /* Rethread column list according to the map. */
+    prevPtr = NULL;
+    for (i = 0; i < (columnsPtr->numUsed - 1); i++) {
+        colPtr = map[i];
+        colPtr->index = i;
+        colPtr->nextPtr = map[i + 1];
+        colPtr->prevPtr = prevPtr;
+        prevPtr =  map[i];
+    }
+    colPtr = map[i];
+    colPtr->nextPtr = NULL;
+    colPtr->prevPtr = prevPtr;
+    columnsPtr->headPtr = map[0];
+    columnsPtr->tailPtr = colPtr;
+    if (columnsPtr->map != NULL) {
+        Blt_Free(columnsPtr->map);
+    }
+    columnsPtr->map = map;
+}
+
+static int
+MoveRows(Rows *rowsPtr, Row *destPtr, Row *firstPtr, Row *lastPtr, int after)
+{
+    if (rowsPtr->flags & REINDEX) {
+        ResetRowMap(rowsPtr);
+    }
+    /* Check is destination outside the range of rows to be moved. */
+    assert ((destPtr->index < firstPtr->index) ||
+            (destPtr->index > lastPtr->index));
+
+    /* Unlink the sub-list from the list of rows. */
+    if (rowsPtr->headPtr == firstPtr) {
+        rowsPtr->headPtr = lastPtr->nextPtr;
+        lastPtr->nextPtr->prevPtr = NULL;
+    }
+    if (rowsPtr->tailPtr == lastPtr) {
+        rowsPtr->tailPtr = lastPtr->prevPtr;
+        lastPtr->prevPtr->nextPtr = NULL;
+    }
+    if (lastPtr->nextPtr != NULL) {
+        lastPtr->nextPtr->prevPtr = firstPtr->prevPtr;
+    }
+    if (firstPtr->prevPtr != NULL) {
+        firstPtr->prevPtr->nextPtr = lastPtr->nextPtr;
+    }
+    firstPtr->prevPtr = lastPtr->nextPtr = NULL;
+    /* Now attach the detached list to the destination. */
+    if (after) {
+        if (destPtr->nextPtr == NULL) {
+            rowsPtr->tailPtr = lastPtr; /* Append to the end. */
+        } else {
+            destPtr->nextPtr->prevPtr = lastPtr;
+        }
+        firstPtr->prevPtr = destPtr;
+        lastPtr->nextPtr = destPtr->nextPtr;
+        destPtr->nextPtr = firstPtr;
+    } else {
+        if (destPtr->prevPtr == NULL) {
+            rowsPtr->headPtr = firstPtr; /* Prepend to the beginning. */
+        } else {
+            destPtr->prevPtr->nextPtr = firstPtr;
+        }
+        firstPtr->prevPtr = destPtr->prevPtr;
+        lastPtr->nextPtr = destPtr;
+        destPtr->prevPtr = lastPtr;
+    }
+    /* FIXME: You don't have to reset the entire map. */
+    ResetRowMap(rowsPtr);
+    return TRUE;
+}
+
+static int
+MoveColumns(Columns *columnsPtr, Column *destPtr, Column *firstPtr, 
+            Column *lastPtr, int after)
+{
+    if (columnsPtr->flags & REINDEX) {
+        ResetColumnMap(columnsPtr);
+    }
+    assert (firstPtr->index <= lastPtr->index);
+    /* Unlink the sub-list from the list of columns. */
+    if (columnsPtr->headPtr == firstPtr) {
+        columnsPtr->headPtr = lastPtr->nextPtr;
+        lastPtr->nextPtr->prevPtr = NULL;
+    } else {
+        firstPtr->prevPtr->nextPtr = lastPtr->nextPtr;
+    }
+    if (columnsPtr->tailPtr == lastPtr) {
+        columnsPtr->tailPtr = firstPtr->prevPtr;
+        firstPtr->prevPtr->nextPtr = NULL;
+    } else {
+        lastPtr->nextPtr->prevPtr = firstPtr->prevPtr;
+    }
+    firstPtr->prevPtr = lastPtr->nextPtr = NULL;
+
+    /* Now attach the detached list to the destination. */
+    if (after) { 
+        /* [a]->[dest]->[b] */
+        /*            [first]->[last] */
+        if (destPtr->nextPtr == NULL) {
+            assert(destPtr == columnsPtr->tailPtr);
+            columnsPtr->tailPtr = lastPtr; /* Append to the end. */
+        } else {
+            destPtr->nextPtr->prevPtr = lastPtr;
+        }
+        lastPtr->nextPtr = destPtr->nextPtr;
+        destPtr->nextPtr = firstPtr;
+        firstPtr->prevPtr = destPtr;
+    } else {
+        /*           [a]->[dest]->[b] */
+        /* [first]->[last] */
+        if (destPtr->prevPtr == NULL) {
+            columnsPtr->headPtr = firstPtr;
+        } else {
+            destPtr->prevPtr->nextPtr = firstPtr;
+        }
+        firstPtr->prevPtr = destPtr->prevPtr;
+        destPtr->prevPtr = lastPtr;
+        lastPtr->nextPtr = destPtr;
+    }
+    /* FIXME: You don't have to reset the entire map. */
+    ResetColumnMap(columnsPtr);
+    return TRUE;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ParseDumpRecord --
+ *
+ *      Gets the next full record in the dump string, returning the
+ *      record as a list. Blank lines and comments are ignored.
+ *
+ * Results: 
+ *      TCL_RETURN      The end of the string is reached.
+ *      TCL_ERROR       An error occurred and an error message 
+ *                      is left in the interpreter result.  
+ *      TCL_OK          The next record has been successfully parsed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ParseDumpRecord(
+    Tcl_Interp *interp,
+    char **sp,                          /* (in/out) points to current
+                                         * location in in dump
+                                         * string. Updated after parsing
+                                         * record. */
+    RestoreData *restorePtr)
+{
+    char *entry, *eol;
+    char saved;
+    int result;
+
+    restorePtr->argc = 0;
+    entry = *sp;
+    /* Get first line, ignoring blank lines and comments. */
+    for (;;) {
+        char *first;
+
+        first = NULL;
+        restorePtr->numLines++;
+        /* Find the end of the first line. */
+        for (eol = entry; (*eol != '\n') && (*eol != '\0'); eol++) {
+            if ((first == NULL) && (!isspace(UCHAR(*eol)))) {
+                first = eol;    /* Track first non-whitespace
+                                 * character. */
+            }
+        }
+        if (first == NULL) {
+            if (*eol == '\0') {
+                return TCL_RETURN;
+            }
+        } else if (*first != '#') {
+            break;                      /* Not a comment or blank line. */
+        }
+        entry = eol + 1;
+    }
+    saved = *eol;
+    *eol = '\0';
+    while (!Tcl_CommandComplete(entry)) {
+        *eol = saved;
+        if (*eol == '\0') {
+            Tcl_AppendResult(interp, "incomplete dump record: \"", entry, 
+                "\"", (char *)NULL);
+            return TCL_ERROR;           /* Found EOF (incomplete entry) or
+                                         * error. */
+        }
+        /* Get the next line. */
+        for (eol = eol + 1; (*eol != '\n') && (*eol != '\0'); eol++) {
+            /*empty*/
+        }
+        restorePtr->numLines++;
+        saved = *eol;
+        *eol = '\0';
+    }
+    if (entry == eol) {
+        return TCL_RETURN;
+    }
+    result = Tcl_SplitList(interp, entry, &restorePtr->argc, &restorePtr->argv);
+    *eol = saved;
+    *sp = eol + 1;
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ReadDumpRecord --
+ *
+ *      Reads the next full record from the given channel, returning the
+ *      record as a list. Blank lines and comments are ignored.
+ *
+ * Results: 
+ *      TCL_RETURN      The end of the file has been reached.
+ *      TCL_ERROR       A read error has occurred and an error message 
+ *                      is left in the interpreter result.  
+ *      TCL_OK          The next record has been successfully parsed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ReadDumpRecord(Tcl_Interp *interp, Tcl_Channel channel, RestoreData *restorePtr)
+{
+    int result;
+    Tcl_DString ds;
+
+    Tcl_DStringInit(&ds);
+    /* Get first line, ignoring blank lines and comments. */
+    for (;;) {
+        const char *cp;
+        int numChars;
+
+        Tcl_DStringSetLength(&ds, 0);
+        numChars = Tcl_Gets(channel, &ds);
+        if (numChars < 0) {
+            if (Tcl_Eof(channel)) {
+                return TCL_RETURN;
+            }
+            return TCL_ERROR;
+        }
+        restorePtr->numLines++;
+        for (cp = Tcl_DStringValue(&ds); *cp != '\0'; cp++) {
+            if (!isspace(UCHAR(*cp))) {
+                break;
+            }
+        }
+        if ((*cp != '\0') && (*cp != '#')) {
+            break;              /* Not a comment or blank line. */
+        }
+    }
+
+    Tcl_DStringAppend(&ds, "\n", 1);
+    while (!Tcl_CommandComplete(Tcl_DStringValue(&ds))) {
+        int numChars;
+
+        /* Process additional lines if needed */
+        numChars = Tcl_Gets(channel, &ds);
+        if (numChars < 0) {
+            Tcl_AppendResult(interp, "error reading file: ", 
+                             Tcl_PosixError(interp), (char *)NULL);
+            Tcl_DStringFree(&ds);
+            return TCL_ERROR;           /* Found EOF (incomplete entry) or
+                                         * error. */
+        }
+        restorePtr->numLines++;
+        Tcl_DStringAppend(&ds, "\n", 1);
+    }
+    result = Tcl_SplitList(interp, Tcl_DStringValue(&ds), &restorePtr->argc, 
+                           &restorePtr->argv);
+    Tcl_DStringFree(&ds);
+    return result;
+}
+
+static void
+RestoreError(Tcl_Interp *interp, RestoreData *restorePtr)
+{
+    Tcl_DString ds;
+
+    Tcl_DStringInit(&ds);
+    Tcl_DStringGetResult(interp, &ds);
+    Tcl_AppendResult(interp, restorePtr->fileName, ":", 
+        Blt_Ltoa(restorePtr->numLines), ": error: ", Tcl_DStringValue(&ds), 
+        (char *)NULL);
+    Tcl_DStringFree(&ds);
+}
+
+static int
+RestoreHeader(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+{
+    long numCols, numRows, count;
+    int64_t time;
+
+    /* i rows columns ctime mtime */
+    if (restorePtr->argc != 5) {
+        RestoreError(interp, restorePtr);
+        Tcl_AppendResult(interp, "wrong # of elements in restore header.", 
+                (char *)NULL);
+        return TCL_ERROR;
+    }   
+    if (Blt_GetCount(interp, restorePtr->argv[1], COUNT_POS, &count)
+        != TCL_OK) {
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    /* FIXME: What are you doing w/ numRows and numCols? */
+    numRows = count;
+    if (Blt_GetCount(interp, restorePtr->argv[2], COUNT_POS, &count)!=TCL_OK) {
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    numCols = count;
+    if ((restorePtr->flags & TABLE_RESTORE_OVERWRITE) == 0) {
+        numRows += restorePtr->numRows;
+        numCols += restorePtr->numCols;
+    }
+    if (Blt_GetInt64(interp, restorePtr->argv[3], &time) != TCL_OK){
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    restorePtr->ctime = time;
+    if (Blt_GetInt64(interp, restorePtr->argv[4], &time) != TCL_OK){
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    restorePtr->mtime = time;
+    return TCL_OK;
+}
+
+static int
+RestoreColumn(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+{
+    long index;
+    Column *colPtr;
+    int type;
+    const char *label;
+    int isNew;
+    Blt_HashEntry *hPtr;
+
+    /* c index label type ?tagList? */
+    if ((restorePtr->argc < 4) || (restorePtr->argc > 5)) {
+        RestoreError(interp, restorePtr);
+        Tcl_AppendResult(interp, "wrong # elements in restore column entry", 
+                (char *)NULL);
+        return TCL_ERROR;
+    }   
+    if (Blt_GetLong(interp, restorePtr->argv[1], &index) != TCL_OK) {
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    label = restorePtr->argv[2];
+    colPtr = blt_table_get_column_by_label(table, label);
+    if ((colPtr == NULL) || 
+        ((restorePtr->flags & TABLE_RESTORE_OVERWRITE) == 0)) {
+        colPtr = blt_table_create_column(interp, table, label);
+        if (colPtr == NULL) {
+            RestoreError(interp, restorePtr);
+            Tcl_AppendResult(interp, "can't append column \"", label, "\"",
+                             (char *)NULL);
+            return TCL_ERROR;
+        }
+    }
+    hPtr = Blt_CreateHashEntry(&restorePtr->colIndices,(intptr_t)index, &isNew);
+    Blt_SetHashValue(hPtr, colPtr);
+
+    type = blt_table_name_to_column_type(restorePtr->argv[3]);
+    if (type == TABLE_COLUMN_TYPE_UNKNOWN) {
+        RestoreError(interp, restorePtr);
+        Tcl_AppendResult(interp, "bad column type \"", restorePtr->argv[3], 
+                         "\"", (char *)NULL);
+        return TCL_ERROR;
+    }
+    colPtr->type = type;
+    if ((restorePtr->argc == 5) && 
+        ((restorePtr->flags & TABLE_RESTORE_NO_TAGS) == 0)) {
+        int i, argc;
+        const char **argv;
+
+        if (Tcl_SplitList(interp, restorePtr->argv[4], &argc, &argv)!= TCL_OK) {
+            RestoreError(interp, restorePtr);
+            return TCL_ERROR;
+        }
+        
+        for (i = 0; i < argc; i++) {
+            if (blt_table_set_column_tag(interp, table, colPtr, argv[i]) 
+                != TCL_OK) {
+                Tcl_Free((char *)argv);
+                return TCL_ERROR;
+            }
+        }
+        Tcl_Free((char *)argv);
+    }
+    return TCL_OK;
+}
+
+static int
+RestoreRow(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+{
+    BLT_TABLE_ROW row;
+    Blt_HashEntry *hPtr;
+    const char *label;
+    int isNew;
+    long index;
+
+    /* r index label ?tagList? */
+    if ((restorePtr->argc < 3) || (restorePtr->argc > 4)) {
+        RestoreError(interp, restorePtr);
+        Tcl_AppendResult(interp, "wrong # of elements in restore row entry", 
+                         (char *)NULL);
+        return TCL_ERROR;
+    }   
+    if (Blt_GetLong(interp, restorePtr->argv[1], &index) != TCL_OK) {
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    label = restorePtr->argv[2];
+    row = blt_table_get_row_by_label(table, label);
+    if ((row == NULL) || ((restorePtr->flags & TABLE_RESTORE_OVERWRITE) == 0)) {
+        row = blt_table_create_row(interp, table, label);
+        if (row == NULL) {
+            RestoreError(interp, restorePtr);
+            Tcl_AppendResult(interp, "can't append row \"", label, "\"",
+                     (char *)NULL);
+            return TCL_ERROR;
+        }
+    }
+    hPtr = Blt_CreateHashEntry(&restorePtr->rowIndices,(intptr_t)index, &isNew);
+    Blt_SetHashValue(hPtr, row);
+    if ((restorePtr->argc == 5) && 
+        ((restorePtr->flags & TABLE_RESTORE_NO_TAGS) == 0)) {
+        const char **argv;
+        int argc;
+        int i;
+
+        if (Tcl_SplitList(interp, restorePtr->argv[3], &argc, &argv)!= TCL_OK) {
+            RestoreError(interp, restorePtr);
+            return TCL_ERROR;
+        }
+        for (i = 0; i < argc; i++) {
+            if (blt_table_set_row_tag(interp, table, row, argv[i]) != TCL_OK) {
+                Tcl_Free((char *)argv);
+                return TCL_ERROR;
+            }
+        }
+        Tcl_Free((char *)argv);
+    }
+    return TCL_OK;
+}
+
+static int
+RestoreValue(Tcl_Interp *interp, BLT_TABLE table, RestoreData *restorePtr)
+{
+    Blt_HashEntry *hPtr;
+    int result;
+    Row *rowPtr;
+    Column *colPtr;
+    Value *valuePtr;
+    long index;
+
+    /* d row column value */
+    if (restorePtr->argc != 4) {
+        RestoreError(interp, restorePtr);
+        Tcl_AppendResult(interp, "wrong # elements in restore data entry", 
+                (char *)NULL);
+        return TCL_ERROR;
+    }   
+    if (Blt_GetLong(interp, restorePtr->argv[1], &index) != TCL_OK) {
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    hPtr = Blt_FindHashEntry(&restorePtr->rowIndices, (intptr_t)index);
+    if (hPtr == NULL) {
+        RestoreError(interp, restorePtr);
+        Tcl_AppendResult(interp, "bad row index \"", restorePtr->argv[1], "\"",
+                         (char *)NULL);
+        return TCL_ERROR;
+    }
+    rowPtr = Blt_GetHashValue(hPtr);
+    if (Blt_GetLong(interp, restorePtr->argv[2], &index) != TCL_OK) {
+        RestoreError(interp, restorePtr);
+        return TCL_ERROR;
+    }
+    hPtr = Blt_FindHashEntry(&restorePtr->colIndices, (intptr_t)index);
+    if (hPtr == NULL) {
+        RestoreError(interp, restorePtr);
+        Tcl_AppendResult(interp, "bad column index \"", restorePtr->argv[2], 
+                "\"", (char *)NULL);
+        return TCL_ERROR;
+    }
+    colPtr = Blt_GetHashValue(hPtr);
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        result = SetPackedFromString(interp, colPtr, rowPtr, 
+                restorePtr->argv[3], -1);
+    } else if (colPtr->encodingPtr != NULL) {
+        SetEncodedString(colPtr, rowPtr, restorePtr->argv[3], -1);
+        result = TCL_OK;
+    } else {
+        CopyOnWrite(colPtr, rowPtr);
+        valuePtr = GetValue(table, rowPtr, colPtr);
+        IndexRemoveValue(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        result = SetValueFromString(interp, colPtr->type, restorePtr->argv[3],
+                -1, valuePtr);
+        IndexAddValue(colPtr, rowPtr);
+        StatsAddValue(colPtr, rowPtr);
+    }
+    if (result != TCL_OK) {
+        RestoreError(interp, restorePtr);
+    } else if (colPtr->bindPtr != NULL) {
+        UpdateBinding(colPtr->bindPtr, rowPtr, TABLE_TRACE_WRITES);
+    }
+    return result;
+}
+
+BLT_TABLE_ROW *
+blt_table_get_row_map(Table *tablePtr)  
+{
+    if (tablePtr->corePtr->rows.flags & REINDEX) {
+        ResetRowMap(&tablePtr->corePtr->rows);
+    }
+    return tablePtr->corePtr->rows.map;
+}
+
+BLT_TABLE_COLUMN *
+blt_table_get_column_map(Table *tablePtr)  
+{
+    if (tablePtr->corePtr->columns.flags & REINDEX) {
+        ResetColumnMap(&tablePtr->corePtr->columns);
+    }
+    return tablePtr->corePtr->columns.map;
+}
+
+Blt_Chain
+blt_table_get_row_tags(Table *tablePtr, Row *rowPtr)  
+{
+    Blt_Chain chain;
+
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+
+    chain = Blt_Chain_Create();
+    for (hPtr = Blt_FirstHashEntry(tablePtr->rowTags, &iter); hPtr != NULL;
+         hPtr = Blt_NextHashEntry(&iter)) {
+        RowTag *tagPtr;
+
+        tagPtr = Blt_GetHashValue(hPtr);
+        if (RowTagHas(tagPtr, rowPtr->offset)) {
+            Blt_Chain_Append(chain, Blt_GetHashKey(tablePtr->rowTags, hPtr));
+        }
+    }
+    return chain;
+}
+
+Blt_HashTable *
+blt_table_get_row_tag_table(Table *tablePtr)  
+{
+    return tablePtr->rowTags;
+}
+
+Blt_HashTable *
+blt_table_get_column_tag_table(Table *tablePtr)  
+{
+    return Blt_Tags_GetTable(tablePtr->columnTags);
+}
+
+Blt_Chain
+blt_table_get_column_tags(Table *tablePtr, Column *colPtr)  
+{
+    Blt_Chain chain;
+
+    chain = Blt_Chain_Create();
+    Blt_Tags_AppendTagsToChain(tablePtr->columnTags, colPtr, chain);
+    return chain;
+}
+
+Blt_Chain
+blt_table_get_tagged_columns(Table *tablePtr, const char *tag)  
+{
+    return Blt_Tags_GetItemList(tablePtr->columnTags, tag);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_tagged_rows --
+ *
+ *      Returns the list of rows with the given tag, in row offset order.
+ *      The list is built from the tag's bitmap and kept until the tag
+ *      changes.  It belongs to the tag and must not be freed.
+ *
+ * Results:
+ *      Returns the list of rows, or NULL if the tag doesn't exist.
+ *
+ *---------------------------------------------------------------------------
+ */
+Blt_Chain
+blt_table_get_tagged_rows(Table *tablePtr, const char *tag)  
+{
+    RowTag *tagPtr;
+
+    tagPtr = FindRowTag(tablePtr->rowTags, tag);
+    if (tagPtr == NULL) {
+        return NULL;
+    }
+    if (tagPtr->chain == NULL) {
+        Rows *rowsPtr;
+        Row *rowPtr;
+
+        rowsPtr = &tablePtr->corePtr->rows;
+        tagPtr->chain = Blt_Chain_Create();
+        for (rowPtr = NextTaggedRow(rowsPtr, tagPtr, 0); rowPtr != NULL;
+             rowPtr = NextTaggedRow(rowsPtr, tagPtr, rowPtr->offset + 1)) {
+            Blt_Chain_Append(tagPtr->chain, rowPtr);
+        }
+    }
+    return tagPtr->chain;
+}
+
+
+int 
+blt_table_same_object(Table *tablePtr1, Table *tablePtr2)  
+{
+    return tablePtr1->corePtr == tablePtr2->corePtr;
+}
+
+BLT_TABLE_ROW
+blt_table_get_row_by_index(Table *tablePtr, long index)  
+{
+    if (tablePtr->corePtr->rows.flags & REINDEX) {
+        ResetRowMap(&tablePtr->corePtr->rows);
+    }
+    if (index < blt_table_num_rows(tablePtr)) {
+        return blt_table_row(tablePtr, index);
+    }
+    return NULL;
+}
+
+BLT_TABLE_COLUMN
+blt_table_get_column_by_index(Table *tablePtr, long index)  
+{
+    if (tablePtr->corePtr->columns.flags & REINDEX) {
+        ResetColumnMap(&tablePtr->corePtr->columns);
+    }
+    if (index < blt_table_num_columns(tablePtr)) {
+        return blt_table_column(tablePtr, index);
+    }
+    return NULL;
+}
+
+BLT_TABLE_ROWCOLUMN_SPEC
+blt_table_row_spec(BLT_TABLE table, Tcl_Obj *objPtr, const char **sp)
+{
+    const char *p;
+    const char *string;
+    long index;
+    char c;
+
+    string = Tcl_GetString(objPtr);
+    *sp = string;
+    c = string[0];
+    if (c == '@') {
+        *sp = string + 1;
+        return TABLE_SPEC_TAG;
+    } else if ((isdigit(UCHAR(c))) && 
+               (Blt_GetLongFromObj(NULL, objPtr, &index) == TCL_OK)) {
+        return TABLE_SPEC_INDEX;
+    } else if ((c == 'r') && (strncmp(string, "range:", 6) == 0)) {
+        *sp = string + 6;
+        return TABLE_SPEC_RANGE;
+    } else if ((c == 'i') && (strncmp(string, "index:", 6) == 0)) {
+        *sp = string + 6;
+        return TABLE_SPEC_INDEX;
+    } else if ((c == 'l') && (strncmp(string, "label:", 6) == 0)) {
+        *sp = string + 6;
+        return TABLE_SPEC_LABEL;
+    } else if ((c == 't') && (strncmp(string, "tag:", 4) == 0)) {
+        *sp = string + 4;
+        return TABLE_SPEC_TAG;
+    } else if (blt_table_get_row_by_label(table, string) != NULL) {
+        return TABLE_SPEC_LABEL;
+    }
+    p = strchr(string, '-');
+    if (p != NULL) {
+        Tcl_Obj *rangeObjPtr;
+        BLT_TABLE_ROW row;
+
+        rangeObjPtr = Tcl_NewStringObj(string, p - string);
+        row = blt_table_get_row((Tcl_Interp *)NULL, table, rangeObjPtr);
+        Tcl_DecrRefCount(rangeObjPtr);
+        if (row != NULL) {
+            rangeObjPtr = Tcl_NewStringObj(p + 1, -1);
+            row = blt_table_get_row((Tcl_Interp *)NULL, table, rangeObjPtr);
+            Tcl_DecrRefCount(rangeObjPtr);
+            if (row != NULL) {
+                return TABLE_SPEC_RANGE;
+            }
+        }
+    } 
+    return TABLE_SPEC_UNKNOWN;
+}
+
+BLT_TABLE_COLUMN
+blt_table_first_column(Table *tablePtr)  
+{
+    return tablePtr->corePtr->columns.headPtr;
+}
+
+BLT_TABLE_COLUMN
+blt_table_last_column(Table *tablePtr)  
+{
+    return tablePtr->corePtr->columns.tailPtr;
+}
+
+BLT_TABLE_COLUMN
+blt_table_next_column(Column *colPtr)  
+{
+    return colPtr->nextPtr;
+}
+
+BLT_TABLE_COLUMN
+blt_table_previous_column(Column *colPtr)  
+{
+    return colPtr->prevPtr;
+}
+
+BLT_TABLE_ROW
+blt_table_first_row(Table *tablePtr)  
+{
+    return tablePtr->corePtr->rows.headPtr;
+}
+
+BLT_TABLE_ROW
+blt_table_last_row(Table *tablePtr)  
+{
+    return tablePtr->corePtr->rows.tailPtr;
+}
+
+BLT_TABLE_ROW
+blt_table_next_row(Row *rowPtr)  
+{
+    return rowPtr->nextPtr;
+}
+
+BLT_TABLE_ROW
+blt_table_previous_row(Row *rowPtr)  
+{
+    return rowPtr->prevPtr;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_iterate_rows --
+ *
+ *      Returns the id of the first row derived from the given tag,
+ *      label or index represented in objPtr.  
+ *
+ * Results:
+ *      Returns the row location of the first item.  If no row 
+ *      can be found, then -1 is returned and an error message is
+ *      left in the interpreter.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_iterate_rows(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr, 
+                      BLT_TABLE_ITERATOR *iterPtr)
+{
+    const char *tag, *p;
+    long index;
+    BLT_TABLE_ROWCOLUMN_SPEC spec;
+    Rows *rowsPtr;
+    memset(iterPtr, 0, sizeof(BLT_TABLE_ITERATOR));
+    iterPtr->table = table;
+    iterPtr->type = TABLE_ITERATOR_INDEX;
+    iterPtr->link = NULL;
+    iterPtr->numEntries = 0;
+
+    spec = blt_table_row_spec(table, objPtr, &tag);
+    rowsPtr = blt_table_rows(table);
+    if (rowsPtr->flags & REINDEX) {
+        ResetRowMap(rowsPtr);
+    }
+    switch (spec) {
+    case TABLE_SPEC_INDEX:
+        {
+            int result;
+
+            p = Tcl_GetString(objPtr);
+            if (p == tag) {
+                result = Blt_GetLongFromObj(NULL, objPtr, &index);
+            } else {
+                result = Blt_GetLong(NULL, (char *)tag, &index);
+            }
+            if (result != TCL_OK) {
+                if (interp != NULL) {
+                    Tcl_AppendResult(interp, "badly formed row index \"", tag, 
+                                     "\"", (char *)NULL);
+                }
+                return TCL_ERROR;
+            }
+            if (index >= blt_table_num_rows(table)) {
+                if (interp != NULL) {
+                    Tcl_AppendResult(interp, "bad row index \"", 
+                                     Tcl_GetString(objPtr), "\"", (char *)NULL);
+                }
+                return TCL_ERROR;
+            }               
+            iterPtr->firstPtr = iterPtr->lastPtr = blt_table_row(table, index);
+            if (iterPtr->firstPtr != NULL) {
+                iterPtr->numEntries = 1;
+            }
+            iterPtr->tag = tag;
+            return TCL_OK;
+        }
+        break;
+
+    case TABLE_SPEC_LABEL:
+        {
+            Row *rowPtr;
+
+            iterPtr->firstPtr = FindRowLabel(rowsPtr, tag);
+            if (iterPtr->firstPtr != NULL) {
+                iterPtr->type = TABLE_ITERATOR_LABEL;
+                iterPtr->tag = tag;
+                for (rowPtr = iterPtr->firstPtr; rowPtr != NULL; 
+                     rowPtr = rowPtr->nextLabelPtr) {
+                    iterPtr->numEntries++;
+                }
+                return TCL_OK;
+            }
+        }
+        break;
+        
+    case TABLE_SPEC_TAG:
+        {
+            RowTag *tagPtr;
+
+            if (strcmp(tag, "all") == 0) {
+                Row *firstPtr, *lastPtr;
+                
+                iterPtr->type = TABLE_ITERATOR_ALL;
+                firstPtr = blt_table_first_row(table);
+                lastPtr = blt_table_last_row(table);
+                iterPtr->tag = tag;
+                if (firstPtr != NULL) {
+                    iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
+                }
+                iterPtr->firstPtr = firstPtr;
+                iterPtr->lastPtr = lastPtr;
+                return TCL_OK;
+            }
+            if (strcmp(tag, "end") == 0) {
+                iterPtr->tag = tag;
+                iterPtr->firstPtr = iterPtr->lastPtr = 
+                    blt_table_last_row(table);
+                if (iterPtr->firstPtr != NULL) {
+                    iterPtr->numEntries = 1;
+                }
+                return TCL_OK;
+            }
+            tagPtr = FindRowTag(table->rowTags, tag);
+            if (tagPtr != NULL) {
+                iterPtr->rowTagPtr = tagPtr;
+                iterPtr->type = TABLE_ITERATOR_TAG;
+                iterPtr->tag = tag;
+                iterPtr->numEntries = tagPtr->numRows;
+            }
+        }
+        return TCL_OK;
+        
+    case TABLE_SPEC_RANGE:
+        {
+            Row *firstPtr, *lastPtr;
+            Tcl_Obj *rangeObjPtr;
+
+            p = strchr(tag, '-');
+            if (p == NULL) {
+                if (interp != NULL) {
+                    Tcl_AppendResult(interp, "bad range specification \"", tag, 
+                                     "\"", (char *)NULL);
+                }
+                return TCL_ERROR;
+            }
+            rangeObjPtr = Tcl_NewStringObj(tag, p - tag);
+            firstPtr = blt_table_get_row(interp, table, rangeObjPtr);
+            Tcl_DecrRefCount(rangeObjPtr);
+            if (firstPtr == NULL) {
+                return TCL_ERROR;
+            }
+            rangeObjPtr = Tcl_NewStringObj(p + 1, -1);
+            lastPtr = blt_table_get_row(interp, table, rangeObjPtr);
+            Tcl_DecrRefCount(rangeObjPtr);
+            if (lastPtr == NULL) {
+                return TCL_ERROR;
+            }
+            if (firstPtr->index > lastPtr->index) {
+                return TCL_OK;
+            }
+            iterPtr->firstPtr = firstPtr;
+            iterPtr->lastPtr = lastPtr;
+            iterPtr->type = TABLE_ITERATOR_RANGE;
+            iterPtr->table = table;
+            iterPtr->tag = tag;
+            iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
+        }
+        return TCL_OK;
+
+    default:
+        break;
+    }
+    if (interp != NULL) {
+        Tcl_AppendResult(interp, "unknown row specification \"", tag, 
+                         "\" in ", blt_table_name(table), (char *)NULL);
+    }
+    return TCL_ERROR;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_first_tagged_row --
+ *
+ *      Returns the id of the next row derived from the given tag.
+ *
+ * Results:
+ *      Returns the row location of the first item.  If no more rows
+ *      can be found, then -1 is returned.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_ROW
+blt_table_first_tagged_row(BLT_TABLE_ITERATOR *iterPtr)
+{
+    switch (iterPtr->type) {
+    case TABLE_ITERATOR_TAG:
+        {
+            Rows *rowsPtr;
+            Row *rowPtr;
+
+            /* Look ahead to the next tagged row, in case the current row
+             * is deleted. */
+            rowsPtr = &iterPtr->table->corePtr->rows;
+            rowPtr = NextTaggedRow(rowsPtr, iterPtr->rowTagPtr, 0);
+            if (rowPtr != NULL) {
+                iterPtr->nextPtr = NextTaggedRow(rowsPtr, iterPtr->rowTagPtr,
+                        rowPtr->offset + 1);
+            }
+            return rowPtr;
+        }
+        break;
+    case TABLE_ITERATOR_CHAIN:
+        /* iterPtr->link is already set by blt_table_row_iterator */
+        if (iterPtr->link != NULL) {
+            BLT_TABLE_ROW row;
+
+            row = Blt_Chain_GetValue(iterPtr->link);
+            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
+            return row;
+        }
+        break;
+    case TABLE_ITERATOR_LABEL:
+        if (iterPtr->firstPtr != NULL) {
+            Row *rowPtr;
+
+            rowPtr = iterPtr->firstPtr;
+            iterPtr->nextPtr = rowPtr->nextLabelPtr;
+            return rowPtr;
+        }
+        break;
+
+    default:
+        if (iterPtr->firstPtr != NULL) {
+            Row *rowPtr;
+
+            rowPtr = iterPtr->firstPtr;
+            if (rowPtr == iterPtr->lastPtr) {
+                iterPtr->nextPtr = NULL;
+            } else {
+                iterPtr->nextPtr = rowPtr->nextPtr;
+            }
+            return rowPtr;
+        } 
+    }
+    return NULL;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_next_tagged_row --
+ *
+ *      Returns the id of the next row derived from the given tag.
+ *
+ * Results:
+ *      Returns the row location of the first item.  If no more rows can be
+ *      found, then -1 is returned.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_ROW
+blt_table_next_tagged_row(BLT_TABLE_ITERATOR *iterPtr)
+{
+    switch (iterPtr->type) {
+    case TABLE_ITERATOR_CHAIN:
+        if (iterPtr->link != NULL) {
+            BLT_TABLE_ROW row;
+            
+            row = Blt_Chain_GetValue(iterPtr->link);
+            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
+            return row;
+        }
+        break;
+    case TABLE_ITERATOR_TAG:
+        if (iterPtr->nextPtr != NULL) {
+            Row *rowPtr;
+
+            rowPtr = iterPtr->nextPtr;
+            iterPtr->nextPtr = NextTaggedRow(&iterPtr->table->corePtr->rows,
+                iterPtr->rowTagPtr, rowPtr->offset + 1);
+            return rowPtr;
+        }
+        break;
+    case TABLE_ITERATOR_LABEL:
+        if (iterPtr->nextPtr != NULL) {
+            Row *rowPtr;
+
+            rowPtr = iterPtr->nextPtr;
+            iterPtr->nextPtr = rowPtr->nextLabelPtr;
+            return rowPtr;
+        }
+        break;
+    default:
+        if (iterPtr->nextPtr != NULL) {
+            Row *rowPtr;
+
+            rowPtr = iterPtr->nextPtr;
+            if (rowPtr == iterPtr->lastPtr) {
+                iterPtr->nextPtr = NULL;
+            } else {
+                iterPtr->nextPtr = rowPtr->nextPtr;
+            }
+            return rowPtr;
+        }       
+    }
+    return NULL;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_row --
+ *
+ *      Gets the row offset associated the given row index, tag, or label.
+ *      This routine is used when you want only one row index.  It's an
+ *      error if more than one row is specified (e.g. "all" tag or range
+ *      "1-4").  It's also an error if the row tag is empty (no rows are
+ *      currently tagged).
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_ROW
+blt_table_get_row(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr)
+{
+    BLT_TABLE_ITERATOR iter;
+    BLT_TABLE_ROW first, next;
+    
+    if (blt_table_iterate_rows(interp, table, objPtr, &iter) != TCL_OK) {
+        return NULL;
+    }
+    first = blt_table_first_tagged_row(&iter);
+    if (first == NULL) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "no rows specified by \"", 
+                             Tcl_GetString(objPtr), "\"", (char *)NULL);
+        }
+        return NULL;
+    }
+    next = blt_table_next_tagged_row(&iter);
+    if (next != NULL) {
+        if (interp != NULL) {
+            const char *tag;
+            
+            blt_table_row_spec(table, objPtr, &tag);
+            Tcl_AppendResult(interp, "multiple rows specified by \"", 
+                             tag, "\"", (char *)NULL);
+        }
+        return NULL;
+    }
+    return first;
+}
+
+BLT_TABLE_ROWCOLUMN_SPEC
+blt_table_column_spec(BLT_TABLE table, Tcl_Obj *objPtr, const char **sp)
+{
+    const char *p;
+    const char *string;
+    long index;
+    char c;
+
+    string = Tcl_GetString(objPtr);
+    *sp = string;
+    c = string[0];
+    if (c == '@') {
+        *sp = string + 1;
+        return TABLE_SPEC_TAG;
+    } else if ((isdigit(c)) &&
+               (Blt_GetLongFromObj(NULL, objPtr, &index) == TCL_OK)) {
+        return TABLE_SPEC_INDEX;
+    } else if ((c == 'r') && (strncmp(string, "range:", 6) == 0)) {
+        *sp = string + 6;
+        return TABLE_SPEC_RANGE;
+    } else if ((c == 'i') && (strncmp(string, "index:", 6) == 0)) {
+        *sp = string + 6;
+        return TABLE_SPEC_INDEX;
+    } else if ((c == 'l') && (strncmp(string, "label:", 6) == 0)) {
+        *sp = string + 6;
+        return TABLE_SPEC_LABEL;
+    } else if ((c == 't') && (strncmp(string, "tag:", 4) == 0)) {
+        *sp = string + 4;
+        return TABLE_SPEC_TAG;
+    } else if (blt_table_get_column_by_label(table, string) != NULL) {
+        return TABLE_SPEC_LABEL;
+    }
+    p = strchr(string, '-');
+    if (p != NULL) {
+        Tcl_Obj *objPtr;
+        BLT_TABLE_COLUMN col;
+
+        objPtr = Tcl_NewStringObj(string, p - string);
+        Tcl_IncrRefCount(objPtr);
+        col = blt_table_get_column(NULL, table, objPtr);
+        Tcl_DecrRefCount(objPtr);
+        if (col != NULL) {
+            objPtr = Tcl_NewStringObj(p + 1, -1);
+            col = blt_table_get_column(NULL, table, objPtr);
+            Tcl_DecrRefCount(objPtr);
+            if (col != NULL) {
+                return TABLE_SPEC_RANGE;
+            }
+        }
+    }
+    return TABLE_SPEC_UNKNOWN;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_iterate_columns --
+ *
+ *      Returns the id of the first column derived from the given tag,
+ *      label or index represented in objPtr.
+ *
+ * Results:
+ *      Returns the column location of the first item.  If no column can be
+ *      found, then -1 is returned and an error message is left in the
+ *      interpreter.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_iterate_columns(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr, 
+                         BLT_TABLE_ITERATOR *iterPtr)
+{
+    const char *tag, *p;
+    int result;
+    long index;
+    BLT_TABLE_ROWCOLUMN_SPEC spec;
+    Columns *columnsPtr;
+
+    columnsPtr = blt_table_columns(table);
+    if (columnsPtr->flags & REINDEX) {
+        ResetColumnMap(columnsPtr);
+    }
+    iterPtr->table = table;
+    iterPtr->type = TABLE_ITERATOR_INDEX;
+    iterPtr->link = NULL;
+    iterPtr->numEntries = 0;
+
+    spec = blt_table_column_spec(table, objPtr, &tag);
+    switch (spec) {
+    case TABLE_SPEC_INDEX:
+        p = Tcl_GetString(objPtr);
+        if (p == tag) {
+            result = Blt_GetLongFromObj(NULL, objPtr, &index);
+        } else {
+            result = Blt_GetLong(NULL, (const char *)tag, &index);
+        }
+        if (result != TCL_OK) {
+            if (interp != NULL) {
+                Tcl_AppendResult(interp, "badly formed column index \"", 
+                        tag, "\"", (char *)NULL);
+            }
+            return TCL_ERROR;
+        }
+        if ((index < 0) || (index >= blt_table_num_columns(table))) {
+            if (interp != NULL) {
+                Tcl_AppendResult(interp, "bad column index \"", 
+                        Tcl_GetString(objPtr), "\"", (char *)NULL);
+            }
+            return TCL_ERROR;
+        }               
+        iterPtr->firstPtr = iterPtr->lastPtr = blt_table_column(table, index);
+        if (iterPtr->firstPtr != NULL) {
+            iterPtr->numEntries = 1;
+        }
+        iterPtr->tag = tag;
+        return TCL_OK;
+
+    case TABLE_SPEC_LABEL:
+        iterPtr->tablePtr = blt_table_column_get_label_table(table, tag);
+        if (iterPtr->tablePtr != NULL) {
+            iterPtr->type = TABLE_ITERATOR_LABEL;
+            iterPtr->tag = tag;
+            iterPtr->numEntries = iterPtr->tablePtr->numEntries;
+            return TCL_OK;
+        }
+        break;
+        
+    case TABLE_SPEC_TAG:
+        {
+            Blt_Chain chain;
+
+            if (strcmp(tag, "all") == 0) {
+                Column *firstPtr, *lastPtr;
+
+                iterPtr->type = TABLE_ITERATOR_ALL;
+                iterPtr->tag = tag;
+                firstPtr = blt_table_first_column(table);
+                lastPtr = blt_table_last_column(table);
+                if (firstPtr != NULL) {
+                    iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
+                }
+                iterPtr->firstPtr = firstPtr;
+                iterPtr->lastPtr = lastPtr;
+                return TCL_OK;
+            }
+            if (strcmp(tag, "end") == 0) {
+                iterPtr->tag = tag;
+                iterPtr->firstPtr = iterPtr->lastPtr = 
+                    blt_table_last_column(table);
+                if (iterPtr->firstPtr != NULL) {
+                    iterPtr->numEntries = 1;
+                }
+                return TCL_OK;
+            }
+            
+            chain = blt_table_get_tagged_columns(iterPtr->table, tag);
+            if (chain != NULL) {
+                iterPtr->link = Blt_Chain_FirstLink(chain);
+                iterPtr->type = TABLE_ITERATOR_TAG;
+                iterPtr->tag = tag;
+                iterPtr->chain = NULL;  /* Don't free column tag chain.  */
+                iterPtr->numEntries = Blt_Chain_GetLength(chain);
+                return TCL_OK;
+            }
+        }
+        break;
+
+    case TABLE_SPEC_RANGE:
+        {
+            Column *firstPtr, *lastPtr;
+            Tcl_Obj *fromObjPtr, *toObjPtr;
+            
+            p = strchr(tag, '-');
+            if (p == NULL) {
+                if (interp != NULL) {
+                    Tcl_AppendResult(interp, "bad range specification \"", tag, 
+                                     "\"", (char *)NULL);
+                }
+                return TCL_ERROR;
+            }
+            fromObjPtr = Tcl_NewStringObj(tag, p - tag);
+            firstPtr = blt_table_get_column(interp, table, fromObjPtr);
+            Tcl_DecrRefCount(fromObjPtr);
+            if (firstPtr == NULL) {
+                return TCL_ERROR;
+            }
+            toObjPtr = Tcl_NewStringObj(p + 1, -1);
+            lastPtr = blt_table_get_column(interp, table, toObjPtr);
+            Tcl_DecrRefCount(toObjPtr);
+            if (lastPtr == NULL) {
+                return TCL_ERROR;
+            }
+            iterPtr->firstPtr = firstPtr;
+            iterPtr->lastPtr = lastPtr;
+            iterPtr->type  = TABLE_ITERATOR_RANGE;
+            iterPtr->tag = tag;
+            if (firstPtr != NULL) {
+                iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
+            }
+        }
+        return TCL_OK;
+
+    default:
+        break;
+    }
+    if (interp != NULL) {
+        Tcl_AppendResult(interp, "unknown column specification \"", 
+                         tag, "\" in ", blt_table_name(table),(char *)NULL);
+    }
+    return TCL_ERROR;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_first_tagged_column --
+ *
+ *      Returns the first column based upon given iterator.
+ *
+ * Results:
+ *      Returns the column location of the first item.  If no more columns
+ *      can be found, then -1 is returned.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_COLUMN
+blt_table_first_tagged_column(BLT_TABLE_ITERATOR *iterPtr)
+{
+    switch (iterPtr->type) {
+    case TABLE_ITERATOR_TAG:
+    case TABLE_ITERATOR_CHAIN:
+        /* iterPtr->link is already set by blt_table_column_iterator */
+        if (iterPtr->link != NULL) {
+            BLT_TABLE_COLUMN col;
+
+            col = Blt_Chain_GetValue(iterPtr->link);
+            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
+            return col;
+        }
+        break;
+    case TABLE_ITERATOR_LABEL:
+        {
+            Blt_HashEntry *hPtr;
+            
+            hPtr = Blt_FirstHashEntry(iterPtr->tablePtr, &iterPtr->cursor);
+            if (hPtr == NULL) {
+                return NULL;
+            }
+            return Blt_GetHashValue(hPtr);
+        }
+        break;
+    default:
+        if (iterPtr->firstPtr != NULL) {
+            Column *colPtr;
+
+            colPtr = iterPtr->firstPtr;
+            if (colPtr == iterPtr->lastPtr) {
+                iterPtr->nextPtr = NULL;
+            } else {
+                iterPtr->nextPtr = colPtr->nextPtr;
+            }
+            return colPtr;
+        } 
+        break;
+    }
+    return NULL;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_next_tagged_column --
+ *
+ *      Returns the column location of the next column using the given
+ *      iterator.
+ *
+ * Results:
+ *      Returns the column location of the next item.  If no more columns
+ *      can be found, then -1 is returned.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_COLUMN
+blt_table_next_tagged_column(BLT_TABLE_ITERATOR *iterPtr)
+{
+    switch (iterPtr->type) {
+    case TABLE_ITERATOR_TAG:
+    case TABLE_ITERATOR_CHAIN:
+        if (iterPtr->link != NULL) {
+            BLT_TABLE_COLUMN col;
+            
+            col = Blt_Chain_GetValue(iterPtr->link);
+            iterPtr->link = Blt_Chain_NextLink(iterPtr->link);
+            return col;
+        }
+        break;
+    case TABLE_ITERATOR_LABEL:
+        {
+            Blt_HashEntry *hPtr;
+
+            hPtr = Blt_NextHashEntry(&iterPtr->cursor); 
+            if (hPtr == NULL) {
+                return NULL;
+            }
+            return Blt_GetHashValue(hPtr);
+        }
+        break;
+    default:
+        if (iterPtr->nextPtr != NULL) {
+            Column *colPtr;
+
+            colPtr = iterPtr->nextPtr;
+            if (colPtr == iterPtr->lastPtr) {
+                iterPtr->nextPtr = NULL;
+            } else {
+                iterPtr->nextPtr = colPtr->nextPtr;
+            }
+            return colPtr;
+        }       
+        break;
+    }
+    return NULL;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_column --
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_COLUMN
+blt_table_get_column(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr)
+{
+    BLT_TABLE_ITERATOR iter;
+    BLT_TABLE_COLUMN first, next;
+
+    if (blt_table_iterate_columns(interp, table, objPtr, &iter) != TCL_OK) {
+        return NULL;
+    }
+    first = blt_table_first_tagged_column(&iter);
+    if (first == NULL) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "no columns specified by \"", 
+                Tcl_GetString(objPtr), "\"", (char *)NULL);
+        }
+        return NULL;
+    }
+    next = blt_table_next_tagged_column(&iter);
+    if (next != NULL) {
+        if (interp != NULL) {
+            const char *tag;
+            
+            blt_table_column_spec(table, objPtr, &tag);
+            Tcl_AppendResult(interp, "multiple columns specified by \"", 
+                tag, "\"", (char *)NULL);
+        }
+        return NULL;
+    }
+    return first;
+}
+
+
+int
+blt_table_list_columns(Tcl_Interp *interp, BLT_TABLE table, int objc, 
+                       Tcl_Obj *const *objv, Blt_Chain chain)
+{
+    Blt_ChainLink link;
+    Blt_HashTable cols;
+    int i;
+
+    Blt_InitHashTableWithPool(&cols, BLT_ONE_WORD_KEYS);
+    /* Initialize the hash table with the existing entries. */
+    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
+         link = Blt_Chain_NextLink(link)) {
+        int isNew;
+        BLT_TABLE_COLUMN col;
+
+        col = Blt_Chain_GetValue(link);
+        Blt_CreateHashEntry(&cols, col, &isNew);
+    }
+    /* Collect the columns into a hash table. */
+    for (i = 0; i < objc; i++) {
+        BLT_TABLE_ITERATOR iter;
+        BLT_TABLE_COLUMN col;
+
+        if (blt_table_iterate_columns(interp, table, objv[i], &iter) 
+            != TCL_OK) {
+            Blt_DeleteHashTable(&cols);
+            return TCL_ERROR;
+        }
+        for (col = blt_table_first_tagged_column(&iter); col != NULL; 
+             col = blt_table_next_tagged_column(&iter)) {
+            int isNew;
+
+            Blt_CreateHashEntry(&cols, col, &isNew);
+            if (isNew) {
+                Blt_Chain_Append(chain, col);
+            }
+        }
+    }
+    Blt_DeleteHashTable(&cols);
+    return TCL_OK;
+}
+
+int
+blt_table_list_rows(Tcl_Interp *interp, BLT_TABLE table, int objc, 
+                    Tcl_Obj *const *objv, Blt_Chain chain)
+{
+    Blt_ChainLink link;
+    Blt_HashTable rows;
+    int i;
+
+    Blt_InitHashTableWithPool(&rows, BLT_ONE_WORD_KEYS);
+    /* Initialize the hash table with the existing entries. */
+    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
+         link = Blt_Chain_NextLink(link)) {
+        int isNew;
+        BLT_TABLE_ROW row;
+
+        row = Blt_Chain_GetValue(link);
+        Blt_CreateHashEntry(&rows, row, &isNew);
+    }
+    for (i = 0; i < objc; i++) {
+        BLT_TABLE_ITERATOR iter;
+        BLT_TABLE_ROW row;
+
+        if (blt_table_iterate_rows(interp, table, objv[i], &iter) != TCL_OK){
+            Blt_DeleteHashTable(&rows);
+            return TCL_ERROR;
+        }
+        /* Append the new rows onto the chain. */
+        for (row = blt_table_first_tagged_row(&iter); row != NULL; 
+             row = blt_table_next_tagged_row(&iter)) {
+            int isNew;
+
+            Blt_CreateHashEntry(&rows, row, &isNew);
+            if (isNew) {
+                Blt_Chain_Append(chain, row);
+            }
+        }
+    }
+    Blt_DeleteHashTable(&rows);
+    return TCL_OK;
+}
+
+int
+blt_table_iterate_rows_objv(Tcl_Interp *interp, BLT_TABLE table, int objc, 
+                            Tcl_Obj *const *objv, BLT_TABLE_ITERATOR *iterPtr)
+{
+    Blt_Chain chain;
+
+    chain = Blt_Chain_Create();
+    if (blt_table_list_rows(interp, table, objc, objv, chain) != TCL_OK) {
+        Blt_Chain_Destroy(chain);
+        return TCL_ERROR;
+    }
+    iterPtr->type = TABLE_ITERATOR_CHAIN;
+    iterPtr->link = Blt_Chain_FirstLink(chain);
+    /* Indicate to free created chain. */
+    iterPtr->chain = chain;
+    iterPtr->numEntries = Blt_Chain_GetLength(chain);
+    iterPtr->tag = "";
+    return TCL_OK;
+}
+
+void
+blt_table_iterate_all_rows(BLT_TABLE table, BLT_TABLE_ITERATOR *iterPtr)
+{
+    Row *firstPtr, *lastPtr;
+    Rows *rowsPtr;
+    
+    rowsPtr = blt_table_rows(table);
+    if (rowsPtr->flags & REINDEX) {
+        ResetRowMap(rowsPtr);
+    }
+
+    iterPtr->chain = NULL;
+    iterPtr->link = NULL;
+    iterPtr->numEntries = 0;
+    iterPtr->table = table;
+    iterPtr->tag = "all";
+    iterPtr->type = TABLE_ITERATOR_ALL;
+
+    firstPtr = blt_table_first_row(table);
+    lastPtr = blt_table_last_row(table);
+    if (firstPtr != NULL) {
+        iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
+    } 
+    iterPtr->firstPtr = firstPtr;
+    iterPtr->lastPtr = lastPtr;
+}
+
+int
+blt_table_iterate_columns_objv(Tcl_Interp *interp, BLT_TABLE table, int objc, 
+                               Tcl_Obj *const *objv,
+                               BLT_TABLE_ITERATOR *iterPtr)
+{
+    Blt_Chain chain;
+
+    chain = Blt_Chain_Create();
+    if (blt_table_list_columns(interp, table, objc, objv, chain) != TCL_OK) {
+        Blt_Chain_Destroy(chain);
+        return TCL_ERROR;
+    }
+    iterPtr->table = table;
+    iterPtr->type = TABLE_ITERATOR_CHAIN;
+    iterPtr->link = Blt_Chain_FirstLink(chain);    
+    /* Indicate to free created chain. */
+    iterPtr->chain = chain;
+    iterPtr->numEntries = Blt_Chain_GetLength(chain);
+    iterPtr->tag = "";
+    return TCL_OK;
+}
+
+void
+blt_table_iterate_all_columns(BLT_TABLE table, BLT_TABLE_ITERATOR *iterPtr)
+{
+    Column *firstPtr, *lastPtr;
+    Columns *columnsPtr;
+
+    columnsPtr = blt_table_columns(table);
+    if (columnsPtr->flags & REINDEX) { 
+        ResetColumnMap(columnsPtr);
+    }
+
+    iterPtr->chain = NULL;
+    iterPtr->link = NULL;
+    iterPtr->numEntries = 0;
+    iterPtr->table = table;
+    iterPtr->tag = "all";
+    iterPtr->type = TABLE_ITERATOR_ALL;
+
+    firstPtr = blt_table_first_column(table);
+    lastPtr = blt_table_last_column(table);
+    if (firstPtr != NULL) {
+        iterPtr->numEntries = lastPtr->index - firstPtr->index + 1;
+    } 
+    iterPtr->firstPtr = firstPtr;
+    iterPtr->lastPtr = lastPtr;
+}
+
+void
+blt_table_free_iterator_objv(BLT_TABLE_ITERATOR *iterPtr)
+{
+    if ((iterPtr->type == TABLE_ITERATOR_CHAIN) && (iterPtr->chain != NULL)) {
+        Blt_Chain_Destroy(iterPtr->chain);
+        iterPtr->chain = NULL;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FreeTrace --
+ *
+ *      Memory is deallocated for the trace.
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+FreeTrace(Trace *tracePtr)
+{
+    if (tracePtr->rowTag != NULL) {
+        Blt_Free(tracePtr->rowTag);
+    }
+    if (tracePtr->colTag != NULL) {
+        Blt_Free(tracePtr->colTag);
+    }
+    Blt_Free(tracePtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_delete_trace --
+ *
+ *      Deletes a trace.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      Memory is deallocated for the trace.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_delete_trace(Table *tablePtr, Trace *tracePtr)
+{
+    Blt_HashEntry *hPtr;
+
+    hPtr = Blt_FindHashEntry(&tablePtr->traces, tracePtr);
+    if (hPtr == NULL) {
+        return;                         /* Invalid trace token. */
+    }
+    Blt_DeleteHashEntry(&tablePtr->traces, hPtr);
+    if ((tracePtr->flags & TABLE_TRACE_DESTROYED) == 0) {
+        if (tracePtr->deleteProc != NULL) {
+            (*tracePtr->deleteProc)(tracePtr->clientData);
+        }
+        if (tracePtr->flags & TABLE_TRACE_PENDING) {
+            Tcl_CancelIdleCall(TraceIdleProc, tracePtr);
+        }
+        /* 
+         * This accomplishes two things.  
+         * 1) It doesn't let it anything match the trace and 
+         * 2) marks the trace as invalid. 
+         */
+        /* Take it out of the list so you can't use it anymore. */
+        if (tracePtr->readLink != NULL) {
+            Blt_Chain_DeleteLink(tablePtr->readTraces, tracePtr->readLink);
+            tracePtr->readLink = NULL;
+        }
+        if (tracePtr->writeLink != NULL) {
+            Blt_Chain_DeleteLink(tablePtr->writeTraces, tracePtr->writeLink);
+            tracePtr->writeLink = NULL;
+        }
+        tracePtr->flags = TABLE_TRACE_DESTROYED;        
+        Tcl_EventuallyFree(tracePtr, (Tcl_FreeProc *)FreeTrace);
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_create_trace --
+ *
+ *      Creates a trace for one or more rows/columns in the table based
+ *      upon the given criteria.  Whenever a matching action occurs in the
+ *      table object, the specified procedure is executed.
+ *
+ *      The trace may be put into 1 or 2 callback lists: one for read
+ *      traces and another for write, create, and/or unset traces.  This is
+ *      done to improve performance on reads.  We only examine the list of
+ *      read traces, which in most cases will me empty.
+ *
+ * Results:
+ *      Returns a token for the trace.
+ *
+ * Side Effects:
+ *      Memory is allocated for the trace.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_TRACE
+blt_table_create_trace(
+    Table *tablePtr,                    /* Table to be traced. */
+    Row *rowPtr, 
+    Column *colPtr,                     /* Row/column in table. */
+    const char *rowTag, 
+    const char *colTag,
+    unsigned int flags,                 /* Bit mask indicating what actions
+                                         * to trace. */
+    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
+                                         * trace. */
+    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
+    ClientData clientData)              /* One-word of data passed along
+                                         * when the callback is
+                                         * executed. */
+{
+    Blt_HashEntry *hPtr;
+    Trace *tracePtr;
+    int isNew;
+
+    tracePtr = Blt_Calloc(1, sizeof (Trace));
+    if (tracePtr == NULL) {
+        return NULL;
+    }
+    tracePtr->row = rowPtr;
+    tracePtr->column = colPtr;
+    if (rowTag != NULL) {
+        tracePtr->rowTag = Blt_AssertStrdup(rowTag);
+    }
+    if (colTag != NULL) {
+        tracePtr->colTag = Blt_AssertStrdup(colTag);
+    }
+    tracePtr->flags = flags;
+    tracePtr->proc = proc;
+    tracePtr->deleteProc = deleteProc;
+    tracePtr->clientData = clientData;
+    if (tracePtr->flags & TABLE_TRACE_READS) {
+        tracePtr->readLink = Blt_Chain_Append(tablePtr->readTraces, tracePtr);
+    }
+    if (tracePtr->flags & 
+        (TABLE_TRACE_WRITES | TABLE_TRACE_UNSETS | TABLE_TRACE_CREATES)) {
+        tracePtr->writeLink = Blt_Chain_Append(tablePtr->writeTraces, tracePtr);
+    }
+    hPtr = Blt_CreateHashEntry(&tablePtr->traces, tracePtr, &isNew);
+    Tcl_SetHashValue(hPtr, tracePtr);
+    assert(isNew);
+    tracePtr->table = tablePtr;
+    return tracePtr;
+}
+
+void
+blt_table_trace_column(
+    Table *tablePtr,                    /* Table to be traced. */
+    Column *colPtr,                     /* Cell in table. */
+    unsigned int flags,                 /* Bit mask indicating what actions
+                                         * to trace. */
+    BLT_TABLE_TRACE_PROC *proc,        /* Callback procedure for the
+                                        * trace. */
+    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
+    ClientData clientData)              /* One-word of data passed along
+                                         * when the callback is
+                                         * executed. */
+{
+    blt_table_create_trace(tablePtr, NULL, colPtr, NULL, NULL, flags,
+                           proc, deleteProc, clientData);
+}
+
+BLT_TABLE_TRACE
+blt_table_create_column_trace(
+    Table *tablePtr,                    /* Table to be traced. */
+    Column *colPtr,                     /* Cell in table. */
+    unsigned int flags,                 /* Bit mask indicating what actions
+                                         * to trace. */
+    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
+                                         * trace. */
+    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
+    ClientData clientData)              /* One-word of data passed along
+                                         * when the callback is
+                                         * executed. */
+{
+    return blt_table_create_trace(tablePtr, NULL, colPtr, NULL, NULL, flags,
+                proc, deleteProc, clientData);
+}
+
+BLT_TABLE_TRACE
+blt_table_create_column_tag_trace(
+    Table *tablePtr,                    /* Table to be traced. */
+    const char *colTag,                 /* Cell in table. */
+    unsigned int flags,                 /* Bit mask indicating what actions
+                                         * to trace. */
+    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
+                                         * trace. */
+    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
+    ClientData clientData)              /* One-word of data passed along
+                                         * when the callback is
+                                         * executed. */
+{
+    return blt_table_create_trace(tablePtr, NULL, NULL, NULL, colTag, flags,
+                proc, deleteProc, clientData);
+}
+
+void
+blt_table_trace_row(
+    Table *tablePtr,                    /* Table to be traced. */
+    Row *rowPtr,                        /* Cell in table. */
+    unsigned int flags,                 /* Bit mask indicating what actions
+                                         * to trace. */
+    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
+                                         * trace. */
+    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
+    ClientData clientData)              /* One-word of data passed along
+                                         * when the callback is
+                                         * executed. */
+{
+    blt_table_create_trace(tablePtr, 
+        rowPtr,                         /* Row */
+        (BLT_TABLE_COLUMN)NULL,         /* Column */
+        (const char *)NULL,             /* Row tag. */
+        (const char *)NULL,             /* Column tag. */
+        flags,                          /* Flags. */
+        proc,                           /* Callback procedure. */
+        deleteProc,                     /* Delete callback procedure. */
+        clientData);                    /* Data passed to callbacks. */
+}
+
+BLT_TABLE_TRACE
+blt_table_create_row_trace(
+    Table *tablePtr,                    /* Table to be traced. */
+    Row *rowPtr,                        /* Cell in table. */
+    unsigned int flags,                 /* Bit mask indicating what actions
+                                         * to trace. */
+    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
+                                         * trace. */
+    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
+    ClientData clientData)              /* One-word of data passed along
+                                         * when the callback is
+                                         * executed. */
+{
+    return blt_table_create_trace(tablePtr, 
+        rowPtr, 
+        (Column *)NULL, 
+        (const char *)NULL, 
+        (const char *)NULL, 
+        flags,
+        proc, 
+        deleteProc, 
+        clientData);
+}
+
+BLT_TABLE_TRACE
+blt_table_create_row_tag_trace(
+    Table *tablePtr,                    /* Table to be traced. */
+    const char *rowTag,                 /* Cell in table. */
+    unsigned int flags,                 /* Bit mask indicating what actions
+                                         * to trace. */
+    BLT_TABLE_TRACE_PROC *proc,         /* Callback procedure for the
+                                         * trace. */
+    BLT_TABLE_TRACE_DELETE_PROC *deleteProc, 
+    ClientData clientData)              /* One-word of data passed along
+                                         * when the callback is
+                                         * executed. */
+{
+    return blt_table_create_trace(tablePtr, NULL, NULL, rowTag, NULL, flags,
+                proc, deleteProc, clientData);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_release_tags --
+ *
+ *      Releases the tag table used by this client.  
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      If no client is using the table, then it is freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_release_tags(Table *tablePtr)
+{
+    Tags *tagsPtr;
+
+    tagsPtr = tablePtr->tags;
+    tagsPtr->refCount--;
+    if (tagsPtr->refCount <= 0) {
+        ResetRowTags(&tagsPtr->rowTagTable);
+        tablePtr->rowTags = NULL;
+        Blt_Tags_Reset(&tagsPtr->columnTags);
+        tablePtr->columnTags = NULL;
+        Blt_Free(tagsPtr);
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_tags_are_shared --
+ *
+ *      Returns whether the tag table is shared with another client.
+ *
+ * Results:
+ *      Returns TRUE if the current tag table is shared with another
+ *      client, FALSE otherwise.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_tags_are_shared(Table *tablePtr)
+{
+    return (tablePtr->tags->refCount > 1);
+}   
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_new_tags --
+ *
+ *      Releases the old tag table (if it exists) and creates a new empty
+ *      tag table.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      Possible frees memory for the old tag table (if no one else is
+ *      using it) and resets the pointers to the new tag tables.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_new_tags(Table *tablePtr)
+{
+    if (tablePtr->tags != NULL) {
+        blt_table_release_tags(tablePtr);
+    }
+    tablePtr->tags = NewTags();
+    tablePtr->rowTags = &tablePtr->tags->rowTagTable;
+    tablePtr->columnTags = &tablePtr->tags->columnTags;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_forget_row_tag --
+ *
+ *      Removes a tag from the row tag table.  Row tags are bitmaps of
+ *      row offsets stored in a hash table keyed by the tag name.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      The bitmap for the given tag is freed.
+ *      
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_forget_row_tag(Tcl_Interp *interp, Table *tablePtr, const char *tag)
+{
+    Blt_HashEntry *hPtr;
+
+    if ((strcmp(tag, "all") == 0) || (strcmp(tag, "end") == 0)) {
+        return TCL_OK;                  /* Can't forget reserved tags. */
+    }
+    hPtr = Blt_FindHashEntry(tablePtr->rowTags, tag);
+    if (hPtr != NULL) {
+        FreeRowTag(Blt_GetHashValue(hPtr));
+        Blt_DeleteHashEntry(tablePtr->rowTags, hPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_forget_column_tag --
+ *
+ *      Removes a tag from the column tag table.  Column tags are contained
+ *      in hash tables keyed by the tag name.  Each table is in turn hashed
+ *      by the column offset in the column tag table.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      Entries for the given tag in the corresponding column in hash tables
+ *      may be removed.
+ *      
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_forget_column_tag(Tcl_Interp *interp, Table *tablePtr, 
+                            const char *tag)
+{
+    if ((strcmp(tag, "all") == 0) || (strcmp(tag, "end") == 0)) {
+        return TCL_OK;                  /* Can't forget reserved tags. */
+    }
+    Blt_Tags_ForgetTag(tablePtr->columnTags, tag);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_row_tag --
+ *
+ *      Associates a tag with a given row.  Each row tag is a bitmap
+ *      indexed by the row location (offset) and stored in a hash table
+ *      keyed by the tag name.  If the row is NULL, this indicates to
+ *      simply create the tag entry.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      A tag is stored for a particular row.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_set_row_tag(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
+                    const char *tag)
+{
+    RowTag *tagPtr;
+    char c;
+    long dummy;
+    
+    c = tag[0];
+    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
+        ((c == 'e') && (strcmp(tag, "end") == 0))) {
+        return TCL_OK;          /* Don't need to create reserved tags. */
+    }
+    if (c == '\0') {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be empty.", 
+                (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (c == '-') {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "tag \"", tag, 
+                "\" can't start with a '-'.", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if ((isdigit(c)) && Blt_GetLong(NULL, (char *)tag, &dummy) == TCL_OK) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be a number.",
+                             (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    tagPtr = GetRowTag(tablePtr->rowTags, tag);
+    if (rowPtr != NULL) {
+        SetRowTagBit(tagPtr, rowPtr->offset);
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_column_tag --
+ *
+ *      Associates a tag with a given column.  Individual column tags are
+ *      stored in hash tables keyed by the tag name.  Each table is in turn
+ *      stored in a hash table keyed by the column location.  If the column
+ *      is NULL, then this means to simply create the tag.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      A tag is stored for a particular column.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_set_column_tag(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+                         const char *tag)
+{
+    long dummy;
+    char c;
+
+    c = tag[0];
+    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
+        ((c == 'e') && (strcmp(tag, "end") == 0))) {
+        return TCL_OK;                  /* Don't create reserved tags. */
+    }
+    if (c == '\0') {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be empty.", 
+                             (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (c == '-') {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "tag \"", tag, 
+                "\" can't start with a '-'.", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if ((isdigit(c)) &&(Blt_GetLong(NULL, (const char *)tag, &dummy)==TCL_OK)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "tag \"", tag, "\" can't be a number.",
+                             (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (colPtr == NULL) {
+        Blt_Tags_AddTag(tablePtr->columnTags, tag);
+    } else {
+        Blt_Tags_AddItemToTag(tablePtr->columnTags, tag, colPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_row_has_tag --
+ *
+ *      Checks if a tag is associated with the given row.  
+ *
+ * Results:
+ *      Returns TRUE if the tag is found, FALSE otherwise.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_row_has_tag(Table *tablePtr, Row *rowPtr, const char *tag)
+{
+    RowTag *tagPtr;
+    char c;
+
+    c = tag[0];
+    if ((c == 'a') && (strcmp(tag, "all") == 0)) {
+        return TRUE;            /* "all" tags matches every row. */
+    }
+    if ((c == 'e') && (strcmp(tag, "end") == 0)) {
+        return (blt_table_row_index(tablePtr, rowPtr)==
+                (blt_table_num_rows(tablePtr)-1));
+    }
+    tagPtr = FindRowTag(tablePtr->rowTags, tag);
+    return ((tagPtr != NULL) && (RowTagHas(tagPtr, rowPtr->offset)));
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_column_has_tag --
+ *
+ *      Checks if a tag is associated with the given column.  
+ *
+ * Results:
+ *      Returns TRUE if the tag is found, FALSE otherwise.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_column_has_tag(Table *tablePtr, Column *colPtr, const char *tag)
+{
+    char c;
+
+    c = tag[0];
+    if ((c == 'a') && (strcmp(tag, "all") == 0)) {
+        return TRUE;                    /* "all" tags matches every column. */
+    }
+    if ((c == 'e') && (strcmp(tag, "end") == 0)) {
+        return (colPtr == (Column *)tablePtr->corePtr->columns.tailPtr);
+    }
+    return Blt_Tags_ItemHasTag(tablePtr->columnTags, colPtr, tag);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_unset_row_tag --
+ *
+ *      Removes a tag from a given row.  
+ *
+ * Results:
+ *      A standard TCL result.  If an error occurred, TCL_ERROR is returned
+ *      and the interpreter result contains the error message.
+ *
+ * Side Effects:
+ *      The tag associated with the row is freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_unset_row_tag(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
+                        const char *tag)
+{
+    RowTag *tagPtr;
+    char c;
+
+    c = tag[0];
+    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
+        ((c == 'e') && (strcmp(tag, "end") == 0))) {
+        return TCL_OK;                  /* Can't remove reserved tags. */
+    } 
+    tagPtr = FindRowTag(tablePtr->rowTags, tag);
+    if (tagPtr != NULL) {
+        ClearRowTagBit(tagPtr, rowPtr->offset);
+    }
+    return TCL_OK;
+}    
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_unset_column_tag --
+ *
+ *      Removes a tag from a given column.  
+ *
+ * Results:
+ *      A standard TCL result.  If an error occurred, TCL_ERROR
+ *      is returned and the interpreter result contains the error
+ *      message.
+ *
+ * Side Effects:
+ *      The tag associated with the column is freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_unset_column_tag(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+                         const char *tag)
+{
+    char c;
+
+    c = tag[0];
+    if (((c == 'a') && (strcmp(tag, "all") == 0)) ||
+        ((c == 'e') && (strcmp(tag, "end") == 0))) {
+        return TCL_OK;                  /* Can't remove reserved tags. */
+    } 
+    Blt_Tags_RemoveItemFromTag(tablePtr->columnTags, tag, colPtr);
+    return TCL_OK;
+}    
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_clear_row_tags --
+ *
+ *      Removes all tags for a given row.  
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      All tags associated with the row are freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_clear_row_tags(Table *tablePtr, Row *rowPtr)
+{
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+
+    for (hPtr = Blt_FirstHashEntry(tablePtr->rowTags, &iter); hPtr != NULL;
+         hPtr = Blt_NextHashEntry(&iter)) {
+        ClearRowTagBit(Blt_GetHashValue(hPtr), rowPtr->offset);
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_clear_column_tags --
+ *
+ *      Removes all tags for a given column.  
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      All tags associated with the column are freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_clear_column_tags(Table *tablePtr, Column *colPtr)
+{
+    Blt_Tags_ClearTagsFromItem(tablePtr->columnTags, colPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_value --
+ *
+ *      Gets the value from the table at the designated row, column
+ *      location.  The value of a packed column is formatted, and the
+ *      string of an encoded column copied, into the table's scratch
+ *      value, which is reused by the next call, so the column isn't
+ *      unpacked or decoded.  Callers that keep the value must copy it.
+ *
+ * Results:
+ *      Returns the value.  Its string is NULL if the cell is empty.
+ *
+ * -------------------------------------------------------------------------- 
+ */
+BLT_TABLE_VALUE
+blt_table_get_value(Table *tablePtr, Row *rowPtr, Column *colPtr)
+{
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        Value *valuePtr;
+
+        /* Format the value rather than unpacking the column. */
+        valuePtr = &tablePtr->corePtr->scratch;
+        ResetValue(valuePtr);
+        if (PackedExists(colPtr, rowPtr->offset)) {
+            FormatPackedValue(colPtr, rowPtr->offset, valuePtr);
+        }
+        return valuePtr;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        Value *valuePtr;
+
+        /* Copy the string rather than decoding the column. */
+        valuePtr = &tablePtr->corePtr->scratch;
+        ResetValue(valuePtr);
+        if (EncodedCode(colPtr, rowPtr->offset) != 0) {
+            EncodedString *strPtr;
+
+            strPtr = EncodedStringAt(colPtr, rowPtr->offset);
+            SetValueString(valuePtr, strPtr->string, strPtr->length);
+        }
+        return valuePtr;
+    }
+    return GetValue(tablePtr, rowPtr, colPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_value --
+ *
+ *      Sets a scalar Tcl_Obj value in the table at the designated row and
+ *      column.  "Write" and possibly "create" or "unset" traces may be fired
+ *      *after* the value is set.  If valuePtr is NULL, this indicates to
+ *      unset the old value.
+ *
+ * Results:
+ *      A standard TCL result.  Returns TCL_OK if successful setting the value
+ *      at the table location.  If an error occurs, TCL_ERROR is returned and
+ *      an error message is left in the interpreter.
+ *
+ * -------------------------------------------------------------------------- 
+ */
+int
+blt_table_set_value(Table *tablePtr, Row *rowPtr, Column *colPtr, Value *newPtr)
+{
+    Value *valuePtr;
+    int flags;
+
+    if (IsReadOnly(NULL, tablePtr)) {
+        return TCL_ERROR;
+    }
+    flags = TABLE_TRACE_WRITES;
+    if (IsEmptyValue(newPtr)) {         /* New value is empty. This is the
+                                         * same as unsetting the value. */
+        flags |= TABLE_TRACE_UNSETS;
+    } else if (IsEmpty(rowPtr, colPtr)) {
+        flags |= TABLE_TRACE_CREATES;   /* Old value was empty. */
+    } 
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        /* The new value may be from a column of a different type, so
+         * convert it from its string representation. */
+        if (IsEmptyValue(newPtr)) {
+            CopyOnWrite(colPtr, rowPtr);
+            StatsRemoveValue(colPtr, rowPtr);
+            PackedClearExists(colPtr, rowPtr->offset);
+        } else if (SetPackedFromString(NULL, colPtr, rowPtr,
+                GetValueString(newPtr), GetValueLength(newPtr)) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        CallTraces(tablePtr, rowPtr, colPtr, flags);
+        return TCL_OK;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        if (IsEmptyValue(newPtr)) {
+            UnsetEncodedValue(colPtr, rowPtr);
+        } else {
+            SetEncodedString(colPtr, rowPtr, GetValueString(newPtr),
+                             GetValueLength(newPtr));
+        }
+        CallTraces(tablePtr, rowPtr, colPtr, flags);
+        return TCL_OK;
+    }
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    if (newPtr != valuePtr) {
+        IndexRemoveValue(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        ResetValue(valuePtr);
+        *valuePtr = *newPtr;            /* Copy the value. */
+        if ((newPtr->string != NULL) &&
+            (newPtr->string != TABLE_VALUE_STORE)) {
+            valuePtr->string = Blt_AssertStrdup(newPtr->string);
+        }
+        IndexAddValue(colPtr, rowPtr);
+        StatsAddValue(colPtr, rowPtr);
+        CallTraces(tablePtr, rowPtr, colPtr, flags);
+    }
+    return TCL_OK;
+}
+
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_obj --
+ *
+ *      Gets a scalar Tcl_Obj value from the table at the designated row,
+ *      column location.  "Read" traces may be fired *before* the value is
+ *      retrieved.  If no value exists at that location, the return value
+ *      is NULL.
+ *
+ * Results:
+ *      A standard TCL result.  Returns TCL_OK if successful accessing the
+ *      table location.  If an error occurs, TCL_ERROR is returned.
+ *
+ * -------------------------------------------------------------------------- 
+ */
+Tcl_Obj *
+blt_table_get_obj(Table *tablePtr, Row *rowPtr, Column *colPtr)
+{
+    Value *valuePtr;
+    Tcl_Obj *objPtr;
+
+    CallTraces(tablePtr, rowPtr, colPtr, TABLE_TRACE_READS);
+    if (IsEmpty(rowPtr, colPtr)) {
+        return NULL;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        return GetObjFromPacked(colPtr, rowPtr->offset);
+    }
+    if (colPtr->encodingPtr != NULL) {
+        EncodedString *strPtr;
+
+        strPtr = EncodedStringAt(colPtr, rowPtr->offset);
+        return Tcl_NewStringObj(strPtr->string, strPtr->length);
+    }
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    objPtr = GetObjFromValue(colPtr->type, valuePtr);
+    return objPtr;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_obj --
+ *
+ *      Sets a scalar Tcl_Obj value in the table at the designated row and
+ *      column.  "Write" and possibly "create" or "unset" traces may be fired
+ *      *after* the value is set.  If valueObjPtr is NULL, this indicates to
+ *      unset the old value.
+ *
+ * Results:
+ *      A standard TCL result.  Returns TCL_OK if successful setting the value
+ *      at the table location.  If an error occurs, TCL_ERROR is returned and
+ *      an error message is left in the interpreter.
+ *
+ * -------------------------------------------------------------------------- 
+ */
+int
+blt_table_set_obj(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                  Column *colPtr, Tcl_Obj *objPtr)
+{
+    unsigned int flags;
+    Value *valuePtr;
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    flags = TABLE_TRACE_WRITES;
+    if (objPtr == NULL) {               /* New value is empty. This is the 
+                                         * same as unsetting the value. */
+        flags |= TABLE_TRACE_UNSETS;
+    } else if (IsEmpty(rowPtr, colPtr)) {
+        flags |= TABLE_TRACE_CREATES;
+    } 
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        if (SetPackedFromObj(interp, colPtr, rowPtr, objPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        CallTraces(tablePtr, rowPtr, colPtr, flags);
+        return TCL_OK;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        if (objPtr == NULL) {
+            UnsetEncodedValue(colPtr, rowPtr);
+        } else {
+            const char *string;
+            int length;
+
+            string = Tcl_GetStringFromObj(objPtr, &length);
+            SetEncodedString(colPtr, rowPtr, string, length);
+        }
+        CallTraces(tablePtr, rowPtr, colPtr, flags);
+        return TCL_OK;
+    }
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    if (SetValueFromObj(interp, colPtr->type, objPtr, valuePtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+    CallTraces(tablePtr, rowPtr, colPtr, flags);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_unset_value --
+ *
+ *      Unsets a scalar Tcl_Obj value in the table at the designated row,
+ *      column location.  It's okay is there is presently no value at the
+ *      location. Unset traces may be fired *before* the value is unset.
+ *
+ * Results:
+ *      A standard TCL result.  Returns TCL_OK if successful unsetting the
+ *      value at the table location.  If an error occurs, TCL_ERROR is
+ *      returned and an error message is left in the interpreter.
+ *
+ * -------------------------------------------------------------------------- 
+ */
+int
+blt_table_unset_value(Table *tablePtr, Row *rowPtr, Column *colPtr)
+{
+    if (IsReadOnly(NULL, tablePtr)) {
+        return TCL_ERROR;
+    }
+    if (!IsEmpty(rowPtr, colPtr)) {
+        Value *valuePtr;
+
+        CallTraces(tablePtr, rowPtr, colPtr, TABLE_TRACE_UNSETS);
+        /* Indicate the keytables need to be regenerated. */
+        if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+            tablePtr->flags |= TABLE_KEYS_DIRTY;
+        }
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            CopyOnWrite(colPtr, rowPtr);
+            StatsRemoveValue(colPtr, rowPtr);
+            PackedClearExists(colPtr, rowPtr->offset);
+            return TCL_OK;
+        }
+        if (colPtr->encodingPtr != NULL) {
+            UnsetEncodedValue(colPtr, rowPtr);
+            return TCL_OK;
+        }
+        CopyOnWrite(colPtr, rowPtr);
+        valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+        IndexRemoveValue(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        ResetValue(valuePtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_create --
+ *
+ *      Creates a table object by the designated name.  It's an error if a
+ *      table object already exists by that name.
+ *
+ * Results:
+ *      A standard TCL result.  If successful, a new table object is created
+ *      and TCL_OK is returned.  If an object already exists or the table
+ *      object can't be allocated, then TCL_ERROR is returned and an error
+ *      message is left in the interpreter.
+ *
+ * Side Effects:
+ *      A new table object is created.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_create(
+    Tcl_Interp *interp,                 /* Interpreter to report errors back
+                                         * to. */
+    const char *name,                   /* Name of tuple in namespace.  Object
+                                         * must not already exist. */
+    Table **tablePtrPtr)                /* (out) Client token of newly created
+                                         * table object.  Releasing the token
+                                         * will free the tuple.  If NULL, no
+                                         * token is generated. */
+{
+    InterpData *dataPtr;
+    TableObject *corePtr;
+    Blt_ObjectName objName;
+    Table *newClientPtr;
+    Tcl_DString ds;
+    const char *qualName;
+    char string[200];
+
+    dataPtr = GetInterpData(interp);
+    if (name != NULL) {
+        /* Check if a client by this name already exist in the current
+         * namespace. */
+        if (GetTable(dataPtr, name, NS_SEARCH_CURRENT) != NULL) {
+            Tcl_AppendResult(interp, "a table object \"", name,
+                "\" already exists", (char *)NULL);
+            return TCL_ERROR;
+        }
+    } else {
+        /* Generate a unique name in the current namespace. */
+        do  {
+            Blt_FmtString(string, 200, "datatable%d", dataPtr->nextId++);
+        } while (GetTable(dataPtr, name, NS_SEARCH_CURRENT) != NULL);
+        name = string;
+    } 
+    /* 
+     * Tear apart and put back together the namespace-qualified name of the
+     * object.  This is to ensure that naming is consistent.
+     */ 
+    if (!Blt_ParseObjectName(interp, name, &objName, 0)) {
+        return TCL_ERROR;
+    }
+    corePtr = NewTableObject();
+    if (corePtr == NULL) {
+        Tcl_AppendResult(interp, "can't allocate table object.", (char *)NULL);
+        Tcl_DStringFree(&ds);
+        return TCL_ERROR;
+    }
+    qualName = Blt_MakeQualifiedName(&objName, &ds);
+    newClientPtr = NewTable(dataPtr, corePtr, qualName);
+    Tcl_DStringFree(&ds);
+    if (newClientPtr == NULL) {
+        Tcl_AppendResult(interp, "can't allocate table token", (char *)NULL);
+        return TCL_ERROR;
+    }
+    
+    if (tablePtrPtr != NULL) {
+        *tablePtrPtr = newClientPtr;
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_open --
+ *
+ *      Allocates a token for the table object designated by name.  It's an
+ *      error if no table object exists by that name.  The token returned is
+ *      passed to various routines to manipulate the object.  Traces and event
+ *      notifications are also made through the token.
+ *
+ * Results:
+ *      A new token is returned representing the table object.  
+ *
+ * Side Effects:
+ *      If this is the remaining client, then the table object itself is
+ *      freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_open(
+    Tcl_Interp *interp,                 /* Interpreter to report errors back
+                                         * to. */
+    const char *name,                   /* Name of table object in
+                                         * namespace. */
+    Table **tablePtrPtr)
+{
+    Table *tablePtr, *newClientPtr;
+    InterpData *dataPtr;
+
+    dataPtr = GetInterpData(interp);
+    tablePtr = GetTable(dataPtr, name, NS_SEARCH_BOTH);
+    if ((tablePtr == NULL) || (tablePtr->corePtr == NULL)) {
+        Tcl_AppendResult(interp, "can't find a table object \"", name, "\"", 
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    newClientPtr = NewTable(dataPtr, tablePtr->corePtr, name);
+    if (newClientPtr == NULL) {
+        Tcl_AppendResult(interp, "can't allocate token for table \"", name, 
+                "\"", (char *)NULL);
+        return TCL_ERROR;
+    }
+    /* By default, share tags with an existing table. Clients can can
+     * blt_table_new_tags to get a new tags table. */
+    ShareTags(tablePtr, newClientPtr);
+    *tablePtrPtr = newClientPtr;
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_close --
+ *
+ *      Releases the tuple token, indicating this the client is no longer
+ *      using the object. The client is removed from the tuple object's client
+ *      list.  If this is the last client, then the object itself is destroyed
+ *      and memory is freed.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      If this is the remaining client, then the table object itself
+ *      is freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_close(Table *tablePtr)
+{
+    if (tablePtr->magic != TABLE_MAGIC) {
+        Blt_Warn("invalid table object token %p\n", tablePtr);
+        return;
+    }
+    if (tablePtr->link2 != NULL) {
+        Blt_Chain chain;
+
+        /* Remove the client from the list of clients using the table name.
+         * This is different from the table core. */
+        chain = Blt_GetHashValue(tablePtr->hPtr);
+        Blt_Chain_DeleteLink(chain, tablePtr->link2);
+        if (Blt_Chain_GetLength(chain) == 0) {
+            /* If no more clients are using this name, then remove it from the
+             * interpreter-specific hash table. */      
+            Blt_DeleteHashEntry(tablePtr->clientTablePtr, tablePtr->hPtr);
+        }
+    }
+    DestroyClient(tablePtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_exists --
+ *
+ *      Indicates if a table object by the given name exists in either the
+ *      current or global namespace.
+ *
+ * Results:
+ *      Returns 1 if a table object exists and 0 otherwise.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_exists(Tcl_Interp *interp, const char *name)
+{
+    InterpData *dataPtr;
+
+    dataPtr = GetInterpData(interp);
+    return (GetTable(dataPtr, name, NS_SEARCH_BOTH) != NULL);
+}
+
+static Notifier *
+CreateNotifier(Tcl_Interp *interp, Blt_Chain chain, unsigned int mask,
+               BLT_TABLE_NOTIFY_EVENT_PROC *proc, 
+               BLT_TABLE_NOTIFIER_DELETE_PROC *deleteProc, 
+               ClientData clientData)
+{
+    Notifier *notifierPtr;
+
+    notifierPtr = Blt_AssertMalloc(sizeof (Notifier));
+    notifierPtr->proc = proc;
+    notifierPtr->deleteProc = deleteProc;
+    notifierPtr->chain = chain;
+    notifierPtr->clientData = clientData;
+    notifierPtr->column = NULL;         /* All columns. */
+    notifierPtr->row = NULL;            /* All rows. */
+    notifierPtr->tag = NULL;            /* No tag. */
+    notifierPtr->flags = mask | TABLE_NOTIFY_COLUMN | TABLE_NOTIFY_ROW;
+    notifierPtr->interp = interp;
+    notifierPtr->link = Blt_Chain_Append(chain, notifierPtr);
+    return notifierPtr;
+}
+
+static Notifier *
+CreateNotifierForRows(Tcl_Interp *interp, Blt_Chain chain, unsigned int mask,
+                      Row *rowPtr, const char *tag, 
+                      BLT_TABLE_NOTIFY_EVENT_PROC *proc,
+                      BLT_TABLE_NOTIFIER_DELETE_PROC *deleteProc, 
+                      ClientData clientData)
+{
+    Notifier *notifierPtr;
+
+    notifierPtr = Blt_AssertMalloc(sizeof (Notifier));
+    notifierPtr->proc = proc;
+    notifierPtr->deleteProc = deleteProc;
+    notifierPtr->chain = chain;
+    notifierPtr->clientData = clientData;
+    notifierPtr->row = rowPtr;
+    notifierPtr->column = NULL;
+    notifierPtr->tag = (tag != NULL) ? Blt_AssertStrdup(tag) : NULL;
+    notifierPtr->flags = mask | TABLE_NOTIFY_ROW;
+    notifierPtr->interp = interp;
+    notifierPtr->link = Blt_Chain_Append(chain, notifierPtr);
+    return notifierPtr;
+}
+
+static Notifier *
+CreateNotifierForColumns(Tcl_Interp *interp, Blt_Chain chain, unsigned int mask,
+        Column *colPtr, const char *tag, BLT_TABLE_NOTIFY_EVENT_PROC *proc,
+        BLT_TABLE_NOTIFIER_DELETE_PROC *deleteProc, ClientData clientData)
+{
+    Notifier *notifierPtr;
+
+    notifierPtr = Blt_AssertMalloc(sizeof (Notifier));
+    notifierPtr->proc = proc;
+    notifierPtr->deleteProc = deleteProc;
+    notifierPtr->chain = chain;
+    notifierPtr->clientData = clientData;
+    notifierPtr->column = colPtr;
+    notifierPtr->row = NULL;
+    notifierPtr->tag = (tag != NULL) ? Blt_AssertStrdup(tag) : NULL;
+    notifierPtr->flags = mask | TABLE_NOTIFY_COLUMN;
+    notifierPtr->interp = interp;
+    notifierPtr->link = Blt_Chain_Append(chain, notifierPtr);
+    return notifierPtr;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_create_notifier --
+ *
+ *      Creates an event handler using the following three pieces of
+ *      information: 
+ *              1. C function pointer, 
+ *              2. one-word of data passed on each call, and 
+ *              3. event mask indicating which events are of interest.  
+ *      If an event already exists matching all of the above criteria,
+ *      it is repositioned on the end of the event handler list.  This
+ *      means that it will be the last to fire.
+ *
+ * Results:
+ *      Returns a pointer to the event handler.
+ *
+ * Side Effects:
+ *      Memory for the event handler is possibly allocated.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_NOTIFIER
+blt_table_create_notifier(Tcl_Interp *interp, Table *tablePtr, 
+                          unsigned int mask, BLT_TABLE_NOTIFY_EVENT_PROC *proc,
+                          BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
+                          ClientData clientData)
+{
+    return CreateNotifier(interp, tablePtr->columnNotifiers, mask,  proc, 
+                          deletedProc, clientData);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_create_column_notifier --
+ *
+ *      Creates an event handler using the following three pieces of
+ *      information: 
+ *              1. C function pointer, 
+ *              2. one-word of data passed on each call, and 
+ *              3. event mask indicating which events are of interest.  
+ *      If an event already exists matching all of the above criteria,
+ *      it is repositioned on the end of the event handler list.  This
+ *      means that it will be the last to fire.
+ *
+ * Results:
+ *      Returns a pointer to the event handler.
+ *
+ * Side Effects:
+ *      Memory for the event handler is possibly allocated.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_NOTIFIER
+blt_table_create_column_notifier(Tcl_Interp *interp, Table *tablePtr,
+                               BLT_TABLE_COLUMN col, unsigned int mask,
+                               BLT_TABLE_NOTIFY_EVENT_PROC *proc,
+                               BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
+                               ClientData clientData)
+{
+    return CreateNotifierForColumns(interp, tablePtr->columnNotifiers, mask, 
+                col, NULL, proc, deletedProc, clientData);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_create_column_tag_notifier --
+ *
+ *      Creates an event handler using the following three pieces of
+ *      information: 
+ *              1. C function pointer, 
+ *              2. one-word of data passed on each call, and 
+ *              3. event mask indicating which events are of interest.  
+ *      If an event already exists matching all of the above criteria,
+ *      it is repositioned on the end of the event handler list.  This
+ *      means that it will be the last to fire.
+ *
+ * Results:
+ *      Returns a pointer to the event handler.
+ *
+ * Side Effects:
+ *      Memory for the event handler is possibly allocated.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_NOTIFIER
+blt_table_create_column_tag_notifier(Tcl_Interp *interp, Table *tablePtr,
+                                  const char *tag, unsigned int mask,
+                                  BLT_TABLE_NOTIFY_EVENT_PROC *proc,
+                                  BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
+                                  ClientData clientData)
+{
+    return CreateNotifierForColumns(interp, tablePtr->columnNotifiers, mask, 
+        NULL, tag, proc, deletedProc, clientData);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_create_row_notifier --
+ *
+ *      Creates an event handler using the following three pieces of
+ *      information: 
+ *              1. C function pointer, 
+ *              2. one-word of data passed on each call, and 
+ *              3. event mask indicating which events are of interest.  
+ *      If an event already exists matching all of the above criteria,
+ *      it is repositioned on the end of the event handler list.  This
+ *      means that it will be the last to fire.
+ *
+ * Results:
+ *      Returns a pointer to the event handler.
+ *
+ * Side Effects:
+ *      Memory for the event handler is possibly allocated.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_NOTIFIER
+blt_table_create_row_notifier(Tcl_Interp *interp, Table *tablePtr, 
+                            BLT_TABLE_ROW row, unsigned int mask,
+                            BLT_TABLE_NOTIFY_EVENT_PROC *proc,
+                            BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
+                            ClientData clientData)
+{
+    return CreateNotifierForRows(interp, tablePtr->rowNotifiers, mask, row, 
+        NULL, proc, deletedProc, clientData);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_create_column_tag_notifier --
+ *
+ *      Creates an event handler using the following three pieces of
+ *      information: 
+ *              1. C function pointer, 
+ *              2. one-word of data passed on each call, and 
+ *              3. event mask indicating which events are of interest.  
+ *      If an event already exists matching all of the above criteria,
+ *      it is repositioned on the end of the event handler list.  This
+ *      means that it will be the last to fire.
+ *
+ * Results:
+ *      Returns a pointer to the event handler.
+ *
+ * Side Effects:
+ *      Memory for the event handler is possibly allocated.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_NOTIFIER
+blt_table_create_row_tag_notifier(Tcl_Interp *interp, Table *tablePtr,
+                               const  char *tag, unsigned int mask,
+                               BLT_TABLE_NOTIFY_EVENT_PROC *proc,
+                               BLT_TABLE_NOTIFIER_DELETE_PROC *deletedProc,
+                               ClientData clientData)
+{
+    return CreateNotifierForRows(interp, tablePtr->rowNotifiers, mask, NULL, 
+        tag, proc, deletedProc, clientData);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_delete_notifier --
+ *
+ *      Removes the event handler designated by following three pieces
+ *      of information: 
+ *         1. C function pointer, 
+ *         2. one-word of data passed on each call, and 
+ *         3. event mask indicating which events are of interest.
+ *
+ * Results:
+ *      Nothing.
+ *
+ * Side Effects:
+ *      Memory for the event handler is freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_delete_notifier(Table *tablePtr, Notifier *notifierPtr)
+{
+    /* Check if notifier is already being deleted. */
+    if ((notifierPtr->flags & TABLE_NOTIFY_DESTROYED) == 0) {
+        unsigned int flags;
+
+        /* Mark the notifier first so that the delete procedure can't
+         * delete it again. */
+        flags = notifierPtr->flags;
+        notifierPtr->flags = TABLE_NOTIFY_DESTROYED;
+        if (notifierPtr->deleteProc != NULL) {
+            (*notifierPtr->deleteProc)(notifierPtr->clientData);
+        }
+        if (flags & TABLE_NOTIFY_PENDING) {
+            Tcl_CancelIdleCall(NotifyIdleProc, notifierPtr);
+        }
+        Tcl_EventuallyFree(notifierPtr, (Tcl_FreeProc *)FreeNotifier);
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_row_by_label --
+ *
+ *      Returns the offset of the row given its label.  If the row label is
+ *      invalid, then -1 is returned.
+ *
+ * Results:
+ *      Returns the offset of the row or -1 if not found.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_ROW
+blt_table_get_row_by_label(Table *tablePtr, const char *label)
+{
+    return FindRowLabel(&tablePtr->corePtr->rows, label);
+}
+
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_column_by_label --
+ *
+ *      Returns the offset of the column given its label.  If the column label
+ *      is invalid, then -1 is returned.
+ *
+ * Results:
+ *      Returns the offset of the column or -1 if not found.
+ *
+ *---------------------------------------------------------------------------
+ */
+BLT_TABLE_COLUMN
+blt_table_get_column_by_label(Table *tablePtr, const char *label)
+{
+    return FindColumnLabel(&tablePtr->corePtr->columns, label);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_column_get_label_table --
+ *
+ *      Returns the offset of the column given its label.  If the column label
+ *      is invalid, then -1 is returned.
+ *
+ * Results:
+ *      Returns the offset of the column or -1 if not found.
+ *
+ *---------------------------------------------------------------------------
+ */
+Blt_HashTable *
+blt_table_column_get_label_table(Table *tablePtr, const char *label)
+{
+    return GetColumnLabelTable(&tablePtr->corePtr->columns, label);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_row_get_label_table --
+ *
+ *      Obsolete.  Rows with the same label are no longer kept in a
+ *      separate hash table for each label.  Use blt_table_iterate_rows to
+ *      find all the rows with a label.
+ *
+ * Results:
+ *      Always returns NULL.
+ *
+ *---------------------------------------------------------------------------
+ */
+Blt_HashTable *
+blt_table_row_get_label_table(Table *tablePtr, const char *label)
+{
+    return NULL;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_row_label --
+ *
+ *      Returns the label of the row.  If the row offset is invalid or the row
+ *      has no label, then NULL is returned.
+ *
+ * Results:
+ *      Returns the label of the row.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_set_row_label(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
+                        const char *label)
+{
+    BLT_TABLE_NOTIFY_EVENT event;
+        
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    InitNotifyEvent(tablePtr, &event);
+    event.type = TABLE_NOTIFY_RELABEL;
+    event.row = rowPtr;
+    SetRowLabel(&tablePtr->corePtr->rows, rowPtr, label);
+    NotifyClients(tablePtr, &event);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_column_label --
+ *
+ *      Sets the label of the column.  If the column offset is invalid, then
+ *      no label is set.
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_set_column_label(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+                           const char *label)
+{
+    BLT_TABLE_NOTIFY_EVENT event;
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    InitNotifyEvent(tablePtr, &event);
+    event.type = TABLE_NOTIFY_COLUMNS_RELABEL;
+    event.column = colPtr;
+    SetColumnLabel(&tablePtr->corePtr->columns, colPtr, label);
+    NotifyClients(tablePtr, &event);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_column_type --
+ *
+ *      Sets the type of the given column.  
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_set_column_type(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+                          BLT_TABLE_COLUMN_TYPE type)
+{
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    if (type == colPtr->type) {
+        return TCL_OK;                  /* Already the requested type. */
+    }
+    return SetColumnType(interp, tablePtr, colPtr, type);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_value_exists --
+ *
+ *      Indicates if a value exists for a given row,column offset in the
+ *      tuple.  Note that this routine does not fire read traces.
+ *
+ * Results:
+ *      Returns 1 is a value exists, 0 otherwise.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_value_exists(Table *tablePtr, Row *rowPtr, Column *colPtr)
+{
+    if ((colPtr == NULL) || (rowPtr == NULL)) {
+        return 0;
+    }
+    return !IsEmpty(rowPtr, colPtr);
+}
+
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_extend_rows --
+ *
+ *      Adds new rows to the table.  Rows are slots in an array of Rows.  The
+ *      array grows by doubling its size, so there may be more slots than
+ *      needed (# rows).
+ *
+ * Results:
+ *      Returns TCL_OK is the tuple is resized and TCL_ERROR if an not enough
+ *      memory was available.
+ *
+ * Side Effects:
+ *      If more rows are needed, the array which holds the tuples is
+ *      reallocated by doubling its size.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_extend_rows(Tcl_Interp *interp, Table *tablePtr, size_t numExtra, 
+                      Row **rows)
+{
+    long i;
+    Blt_Chain chain;
+    Blt_ChainLink link;
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    if (numExtra == 0) {
+        return TCL_OK;
+    }
+    chain = Blt_Chain_Create();
+    if (!ExtendRows(tablePtr, numExtra, chain)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't extend table by ", 
+                Blt_Ltoa(numExtra), " rows: out of memory.", (char *)NULL);
+        }
+        Blt_Chain_Destroy(chain);
+        return TCL_ERROR;
+    }
+    /* For each new row generate a notify event. */
+    for (i = 0, link = Blt_Chain_FirstLink(chain); link != NULL; 
+         link = Blt_Chain_NextLink(link), i++) {
+        Row *rowPtr;
+
+        rowPtr = Blt_Chain_GetValue(link);
+        if (rows != NULL) {
+            rows[i] = rowPtr;
+        }
+        NotifyRowChanged(tablePtr, rowPtr, TABLE_NOTIFY_ROWS_CREATED);
+    }
+    assert(Blt_Chain_GetLength(chain) > 0);
+    Blt_Chain_Destroy(chain);
+    return TCL_OK;
+}
+
+int
+blt_table_delete_row(Table *tablePtr, Row *rowPtr)
+{
+    if (IsReadOnly(NULL, tablePtr)) {
+        return TCL_ERROR;
+    }
+    NotifyRowChanged(tablePtr, rowPtr, TABLE_NOTIFY_ROWS_DELETED);
+    UnsetRowValues(tablePtr, rowPtr);
+    ClearRowFromTags(tablePtr->corePtr, rowPtr);
+    blt_table_clear_row_traces(tablePtr, rowPtr);
+    ClearRowNotifiers(tablePtr, rowPtr);
+    tablePtr->flags |= TABLE_KEYS_DIRTY;
+    ForgetBatchItems(tablePtr->corePtr, rowPtr, NULL);
+    DeleteRow(&tablePtr->corePtr->rows, rowPtr);
+    return TCL_OK;
+}
+
+BLT_TABLE_ROW
+blt_table_create_row(Tcl_Interp *interp, BLT_TABLE table, const char *label)
+{
+    Row *rowPtr;
+
+    rowPtr = NULL;                      /* Suppress compiler warning. */
+    if (blt_table_extend_rows(interp, table, 1, &rowPtr) != TCL_OK) {
+        return NULL;
+    }
+    if (label != NULL) {
+        if (blt_table_set_row_label(interp, table, rowPtr, label) != TCL_OK) {
+            blt_table_delete_row(table, rowPtr);
+            return NULL;
+        }
+    }
+    return rowPtr;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_move_rows --
+ *
+ *      Move one of more rows to a new location in the tuple.
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+int
+blt_table_move_rows(Tcl_Interp *interp, Table *tablePtr, Row *destPtr, 
+                   Row *firstPtr, Row *lastPtr, int after)
+{
+    Rows *rowsPtr;
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    rowsPtr = &tablePtr->corePtr->rows;
+    if (!MoveRows(rowsPtr, destPtr, firstPtr, lastPtr, after)) {
+        Tcl_AppendResult(interp, "can't allocate new map for \"", 
+                blt_table_name(tablePtr), "\"", (char *)NULL);
+        return TCL_ERROR;
+    }
+    NotifyRowChanged(tablePtr, NULL, TABLE_NOTIFY_ROWS_MOVED);
+    return TCL_OK;
+}
+
+void
+blt_table_set_row_map(Table *tablePtr, Row **map)
+{
+    ReplaceRowMap(&tablePtr->corePtr->rows, map);
+    NotifyRowChanged(tablePtr, NULL, TABLE_NOTIFY_ROWS_MOVED);
+}
+
+void
+blt_table_sort_init(Table *tablePtr, BLT_TABLE_SORT_ORDER *order, 
+                    long numColumns, unsigned int flags)
+{
+    size_t i;
+
+    sortData.table = tablePtr;
+    sortData.order = order;
+    sortData.numColumns = numColumns;
+    sortData.flags = flags;
+    for (i = 0; i < numColumns; i++) {
+        BLT_TABLE_SORT_ORDER *sortPtr;
+
+        sortPtr = order + i;
+        sortPtr->clientData = tablePtr;
+        sortPtr->cmpProc = blt_table_get_compare_proc(tablePtr, 
+                sortPtr->column, flags);
+    }
+}
+
+void
+blt_table_sort_finish()
+{
+    size_t i;
+
+    if (sortData.table == NULL) {
+        return;
+    }
+    /* String comparisons unpack the column, so pack bound columns again. */
+    for (i = 0; i < sortData.numColumns; i++) {
+        RepackBoundColumn(sortData.table, sortData.order[i].column);
+    }
+    sortData.table = NULL;
+}
+
+BLT_TABLE_ROW *
+blt_table_sort_rows(Table *tablePtr)
+{
+    Rows *rowsPtr;
+    Row **map;
+
+    rowsPtr = &tablePtr->corePtr->rows;
+    /* Make a copy of the current row map. */
+    map = Blt_Malloc(sizeof(Row *) * rowsPtr->numAllocated);
+    if (map == NULL) {
+        return NULL;
+    }
+    memcpy(map, rowsPtr->map, sizeof(Row *) * rowsPtr->numAllocated);
+    SortRowMap(tablePtr, sortData.order, sortData.numColumns, sortData.flags,
+               rowsPtr->numUsed, map);
+    return map;
+}
+
+void
+blt_table_sort_row_map(Table *tablePtr, long numRows, BLT_TABLE_ROW *rows)
+{
+    SortRowMap(tablePtr, sortData.order, sortData.numColumns, sortData.flags,
+               numRows, rows);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_sort_rows_by_order --
+ *
+ *      Sorts the array of rows by the given columns.  Unlike
+ *      blt_table_sort_init and blt_table_sort_row_map, no state is kept
+ *      between calls, so it's safe to call from within a sort or a trace.
+ *
+ * Results:
+ *      None.
+ *
+ * Side Effects:
+ *      The rows in the array are reordered.  The comparison procedures of
+ *      the sort order are set.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+blt_table_sort_rows_by_order(Table *tablePtr, BLT_TABLE_SORT_ORDER *order,
+                             size_t numColumns, unsigned int flags, 
+                             size_t numRows, BLT_TABLE_ROW *rows)
+{
+    size_t i;
+
+    SortRowMap(tablePtr, order, numColumns, flags, numRows, rows);
+    for (i = 0; i < numColumns; i++) {
+        RepackBoundColumn(tablePtr, order[i].column);
+    }
+}
+
+typedef struct {
+    Table *tablePtr;
+    Column *colPtr;
+    BLT_TABLE_COMPARE_PROC *proc;
+    long *minItems, *maxItems;          /* Minimum and maximum of each
+                                         * worker's items. -1 if all the
+                                         * values are empty. */
+    int *hasNaN;                        /* Indicates if a worker found a
+                                         * NaN.  */
+} LimitsScan;
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PackedLimitsProc --
+ *
+ *      Finds the minimum and maximum values in a range of offsets of a
+ *      packed column.  Deleted and unused row offsets have no value, so
+ *      the chunks are scanned in order rather than following the list of
+ *      rows.  NaNs are skipped.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+PackedLimitsProc(ClientData clientData, long first, long last, int worker)
+{
+    LimitsScan *scanPtr = clientData;
+    Column *colPtr;
+    long i, minOffset, maxOffset;
+
+    colPtr = scanPtr->colPtr;
+    minOffset = maxOffset = -1;
+    if (IsPackedDouble(colPtr)) {
+        double min, max;
+
+        min = max = 0.0;
+        for (i = first; i < last; i++) {
+            double d;
+
+            if (!PackedExists(colPtr, i)) {
+                continue;
+            }
+            d = PackedDouble(colPtr, i);
+            if (isnan(d)) {
+                continue;
+            }
+            if ((minOffset < 0) || (d < min)) {
+                minOffset = i, min = d;
+            }
+            if ((maxOffset < 0) || (d > max)) {
+                maxOffset = i, max = d;
+            }
+        }
+    } else {
+        int64_t min, max;
+
+        min = max = 0;
+        for (i = first; i < last; i++) {
+            int64_t i64;
+
+            if (!PackedExists(colPtr, i)) {
+                continue;
+            }
+            i64 = PackedInt64(colPtr, i);
+            if ((minOffset < 0) || (i64 < min)) {
+                minOffset = i, min = i64;
+            }
+            if ((maxOffset < 0) || (i64 > max)) {
+                maxOffset = i, max = i64;
+            }
+        }
+    }
+    scanPtr->minItems[worker] = minOffset;
+    scanPtr->maxItems[worker] = maxOffset;
+}
+
+static void
+GetPackedLimits(Table *tablePtr, Column *colPtr, Row **minRowPtrPtr,
+                Row **maxRowPtrPtr)
+{
+    LimitsScan scan;
+    long minOffsets[TABLE_MAX_THREADS], maxOffsets[TABLE_MAX_THREADS];
+    long minOffset, maxOffset, numAllocated;
+    int i, numWorkers;
+
+    numAllocated = NumRowsAllocated(tablePtr);
+    numWorkers = blt_table_num_workers(tablePtr, numAllocated);
+    scan.colPtr = colPtr;
+    scan.minItems = minOffsets;
+    scan.maxItems = maxOffsets;
+    blt_table_run_workers(numWorkers, numAllocated, PackedLimitsProc, &scan);
+
+    /* Combine the workers' results in order, keeping the first of equal
+     * values the same as a single scan would. */
+    minOffset = maxOffset = -1;
+    for (i = 0; i < numWorkers; i++) {
+        long min, max;
+
+        min = minOffsets[i], max = maxOffsets[i];
+        if (min < 0) {
+            continue;
+        }
+        if (IsPackedDouble(colPtr)) {
+            if ((minOffset < 0) || 
+                (PackedDouble(colPtr, min) < PackedDouble(colPtr, minOffset))) {
+                minOffset = min;
+            }
+            if ((maxOffset < 0) || 
+                (PackedDouble(colPtr, max) > PackedDouble(colPtr, maxOffset))) {
+                maxOffset = max;
+            }
+        } else {
+            if ((minOffset < 0) || 
+                (PackedInt64(colPtr, min) < PackedInt64(colPtr, minOffset))) {
+                minOffset = min;
+            }
+            if ((maxOffset < 0) || 
+                (PackedInt64(colPtr, max) > PackedInt64(colPtr, maxOffset))) {
+                maxOffset = max;
+            }
+        }
+    }
+    if (minOffset >= 0) {
+        Row **map;
+        long j, numRows;
+
+        /* Look up the rows of the offsets found. */
+        map = tablePtr->corePtr->rows.map;
+        numRows = blt_table_num_rows(tablePtr);
+        for (j = 0; j < numRows; j++) {
+            if (map[j]->offset == minOffset) {
+                *minRowPtrPtr = map[j];
+            }
+            if (map[j]->offset == maxOffset) {
+                *maxRowPtrPtr = map[j];
+            }
+        }
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * LimitsProc --
+ *
+ *      Finds the rows with the minimum and maximum values of the column in
+ *      a range of the row map, using the column's comparison procedure.
+ *      NaNs don't compare the same way as other numbers, so if a NaN is
+ *      found the scan is flagged to be redone in a single thread.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+LimitsProc(ClientData clientData, long first, long last, int worker)
+{
+    LimitsScan *scanPtr = clientData;
+    Column *colPtr;
+    Row **map;
+    Row *minRowPtr, *maxRowPtr;
+    long i;
+    int checkNaN;
+
+    colPtr = scanPtr->colPtr;
+    map = scanPtr->tablePtr->corePtr->rows.map;
+    checkNaN = ((colPtr->type == TABLE_COLUMN_TYPE_DOUBLE) ||
+                (colPtr->type == TABLE_COLUMN_TYPE_TIME));
+    minRowPtr = maxRowPtr = NULL;
+    scanPtr->hasNaN[worker] = FALSE;
+    for (i = first; i < last; i++) {
+        Row *rowPtr;
+
+        rowPtr = map[i];
+        if (IsEmpty(rowPtr, colPtr)) {
+            continue;                   /* Empty values sort last. */
+        }
+        if ((checkNaN) && 
+            (isnan(ColumnValue(colPtr, rowPtr->offset)->datum.d))) {
+            scanPtr->hasNaN[worker] = TRUE;
+        }
+        if ((minRowPtr == NULL) ||
+            ((*scanPtr->proc)(NULL, colPtr, rowPtr, minRowPtr) < 0)) {
+            minRowPtr = rowPtr;
+        }
+        if ((maxRowPtr == NULL) ||
+            ((*scanPtr->proc)(NULL, colPtr, rowPtr, maxRowPtr) > 0)) {
+            maxRowPtr = rowPtr;
+        }
+    }
+    scanPtr->minItems[worker] = (minRowPtr == NULL) ? -1 : minRowPtr->index;
+    scanPtr->maxItems[worker] = (maxRowPtr == NULL) ? -1 : maxRowPtr->index;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ComputeLimits --
+ *
+ *      Finds the rows with the minimum and maximum values of the column.
+ *      The rows are NULL if the column has no values.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ComputeLimits(Table *tablePtr, Column *colPtr, Row **minRowPtrPtr,
+              Row **maxRowPtrPtr)
+{
+    LimitsScan scan;
+    long minRows[TABLE_MAX_THREADS], maxRows[TABLE_MAX_THREADS];
+    int hasNaN[TABLE_MAX_THREADS];
+    Row **map;
+    Row *minRowPtr, *maxRowPtr;
+    long numRows;
+    int i, numWorkers;
+
+    *minRowPtrPtr = *maxRowPtrPtr = NULL;
+    numRows = blt_table_num_rows(tablePtr);
+    if (numRows == 0) {
+        return;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        GetPackedLimits(tablePtr, colPtr, minRowPtrPtr, maxRowPtrPtr);
+        return;
+    }
+    scan.tablePtr = tablePtr;
+    scan.colPtr = colPtr;
+    scan.proc = blt_table_get_compare_proc(tablePtr, colPtr, 0);
+    scan.minItems = minRows;
+    scan.maxItems = maxRows;
+    scan.hasNaN = hasNaN;
+    numWorkers = blt_table_num_workers(tablePtr, numRows);
+    blt_table_run_workers(numWorkers, numRows, LimitsProc, &scan);
+    for (i = 0; i < numWorkers; i++) {
+        if (hasNaN[i]) {
+            numWorkers = 1;
+            LimitsProc(&scan, 0, numRows, 0);
+            break;
+        }
+    }
+    /* Combine the workers' results in order, keeping the first of equal
+     * values the same as a single scan would. */
+    map = tablePtr->corePtr->rows.map;
+    maxRowPtr = minRowPtr = NULL;
+    for (i = 0; i < numWorkers; i++) {
+        Row *rowPtr;
+
+        if (minRows[i] < 0) {
+            continue;
+        }
+        rowPtr = map[minRows[i]];
+        if ((minRowPtr == NULL) ||
+            ((*scan.proc)(NULL, colPtr, rowPtr, minRowPtr) < 0)) {
+            minRowPtr = rowPtr;
+        }
+        rowPtr = map[maxRows[i]];
+        if ((maxRowPtr == NULL) ||
+            ((*scan.proc)(NULL, colPtr, rowPtr, maxRowPtr) > 0)) {
+            maxRowPtr = rowPtr;
+        }
+    }
+    *minRowPtrPtr = minRowPtr;
+    *maxRowPtrPtr = maxRowPtr;
+}
+
+/*
+ * Column statistics.
+ *
+ *      The statistics of a column (# of values, sum, limits, and an
+ *      estimate of the # of distinct values) are computed when they are
+ *      first asked for and cached in the column.  The set and unset
+ *      routines keep them up to date: they call StatsRemoveValue before a
+ *      value is changed and StatsAddValue after.  Adding a value updates
+ *      every statistic.  Removing a value can't be undone for the limits
+ *      (when the value was the minimum or maximum) or the distinct
+ *      estimate, so those are marked stale and recomputed the next time
+ *      they are needed.
+ *
+ *      The distinct estimate is a HyperLogLog sketch.  Each value is
+ *      hashed; the high bits of the hash select a register and the
+ *      register keeps the longest run of leading zeros seen in the rest.
+ */
+#define STATS_REGISTER_BITS     10
+#define STATS_NUM_REGISTERS     (1 << STATS_REGISTER_BITS)
+
+struct _BLT_TABLE_STATS {
+    unsigned int flags;                 /* Indicates which statistics are
+                                         * up to date. */
+    long numValues;                     /* # of non-empty values. */
+    double sum;                         /* Sum of the values of a numeric
+                                         * column. */
+    Row *minRowPtr, *maxRowPtr;         /* Rows holding the minimum and
+                                         * maximum values. NULL if the
+                                         * column is empty. */
+    unsigned char registers[STATS_NUM_REGISTERS];
+};
+
+#define STATS_COUNTS    (1<<0)          /* # of values and sum. */
+#define STATS_LIMITS    (1<<1)          /* Minimum and maximum. */
+#define STATS_DISTINCT  (1<<2)          /* Distinct value sketch. */
+#define STATS_ALL       (STATS_COUNTS | STATS_LIMITS | STATS_DISTINCT)
+
+static INLINE int
+IsNumericType(BLT_TABLE_COLUMN_TYPE type)
+{
+    switch (type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+    case TABLE_COLUMN_TYPE_LONG:
+    case TABLE_COLUMN_TYPE_INT64:
+    case TABLE_COLUMN_TYPE_BOOLEAN:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static INLINE int
+IsDoubleType(BLT_TABLE_COLUMN_TYPE type)
+{
+    return ((type == TABLE_COLUMN_TYPE_DOUBLE) ||
+            (type == TABLE_COLUMN_TYPE_TIME));
+}
+
+/* Returns the numeric value at the row offset as a double. */
+static double
+GetStatsNumber(Column *colPtr, long offset)
+{
+    Value *valuePtr;
+
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        return (IsPackedDouble(colPtr)) ? PackedDouble(colPtr, offset) :
+            (double)PackedInt64(colPtr, offset);
+    }
+    valuePtr = ColumnValue(colPtr, offset);
+    switch (colPtr->type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+        return valuePtr->datum.d;
+    case TABLE_COLUMN_TYPE_LONG:
+    case TABLE_COLUMN_TYPE_BOOLEAN:
+        return (double)valuePtr->datum.l;
+    default:
+        return (double)valuePtr->datum.i64;
+    }
+}
+
+static INLINE uint64_t
+MixBits(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static uint64_t
+HashDouble(double d)
+{
+    union {
+        double d;
+        uint64_t u;
+    } bits;
+
+    bits.d = d;
+    if (d == 0.0) {
+        bits.d = 0.0;                   /* -0.0 is the same as 0.0 */
+    } else if (isnan(d)) {
+        bits.u = 0x7ff8000000000000ULL;
+    }
+    return MixBits(bits.u);
+}
+
+/* FNV-1a hash of a string. */
+static uint64_t
+HashString(const char *string, int length)
+{
+    const unsigned char *p, *pend;
+    uint64_t hash;
+
+    hash = 0xcbf29ce484222325ULL;
+    p = (const unsigned char *)string;
+    for (pend = p + length; p < pend; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ULL;
+    }
+    return MixBits(hash);
+}
+
+/* Returns the integer value at the row offset of an integer column. */
+static int64_t
+GetInt64Number(Column *colPtr, long offset)
+{
+    Value *valuePtr;
+
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        return PackedInt64(colPtr, offset);
+    }
+    valuePtr = ColumnValue(colPtr, offset);
+    if (colPtr->type == TABLE_COLUMN_TYPE_INT64) {
+        return valuePtr->datum.i64;
+    }
+    return (int64_t)valuePtr->datum.l;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * HashStatsValue --
+ *
+ *      Hashes the value at the row offset for the distinct value sketch.
+ *      Numbers are hashed by value, not by their string representation,
+ *      so that the hash is the same whether the column is packed or not.
+ *
+ *---------------------------------------------------------------------------
+ */
+static uint64_t
+HashStatsValue(Column *colPtr, long offset)
+{
+    Value *valuePtr;
+
+    if (IsDoubleType(colPtr->type)) {
+        return HashDouble(GetStatsNumber(colPtr, offset));
+    }
+    if (IsNumericType(colPtr->type)) {
+        return MixBits((uint64_t)GetInt64Number(colPtr, offset));
+    }
+    if (colPtr->encodingPtr != NULL) {
+        return EncodedStringAt(colPtr, offset)->hash;
+    }
+    valuePtr = ColumnValue(colPtr, offset);
+    return HashString(GetValueString(valuePtr), GetValueLength(valuePtr));
+}
+
+static void
+AddToSketch(ColumnStats *statsPtr, uint64_t hash)
+{
+    unsigned int reg;
+    unsigned char rank;
+
+    reg = (unsigned int)(hash >> (64 - STATS_REGISTER_BITS));
+    hash <<= STATS_REGISTER_BITS;
+    for (rank = 1; rank <= (64 - STATS_REGISTER_BITS); rank++) {
+        if (hash & 0x8000000000000000ULL) {
+            break;
+        }
+        hash <<= 1;
+    }
+    if (rank > statsPtr->registers[reg]) {
+        statsPtr->registers[reg] = rank;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * EstimateDistinct --
+ *
+ *      Returns the estimated # of distinct values from the sketch.  For
+ *      small counts, where some registers are still empty, the estimate
+ *      is made from the # of empty registers (linear counting).
+ *
+ *---------------------------------------------------------------------------
+ */
+static long
+EstimateDistinct(ColumnStats *statsPtr)
+{
+    double sum, estimate, m;
+    int i, numZeros;
+
+    m = (double)STATS_NUM_REGISTERS;
+    sum = 0.0;
+    numZeros = 0;
+    for (i = 0; i < STATS_NUM_REGISTERS; i++) {
+        sum += ldexp(1.0, -(int)statsPtr->registers[i]);
+        if (statsPtr->registers[i] == 0) {
+            numZeros++;
+        }
+    }
+    estimate = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+    if ((estimate <= (2.5 * m)) && (numZeros > 0)) {
+        estimate = m * log(m / (double)numZeros);
+    }
+    if (estimate > (double)statsPtr->numValues) {
+        return statsPtr->numValues;
+    }
+    return (long)(estimate + 0.5);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ComputeStats --
+ *
+ *      Computes the # of values, sum, and distinct value sketch of the
+ *      column in one pass over its values.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ComputeStats(Table *tablePtr, Column *colPtr, ColumnStats *statsPtr,
+             unsigned int flags)
+{
+    long i, numValues;
+    double sum;
+    int isNumeric;
+
+    if (flags & STATS_DISTINCT) {
+        memset(statsPtr->registers, 0, STATS_NUM_REGISTERS);
+    }
+    isNumeric = IsNumericType(colPtr->type);
+    numValues = 0;
+    sum = 0.0;
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        long numAllocated;
+
+        /* Scan the packed chunks in order. */
+        numAllocated = NumRowsAllocated(tablePtr);
+        for (i = 0; i < numAllocated; i++) {
+            if (!PackedExists(colPtr, i)) {
+                continue;
+            }
+            numValues++;
+            sum += GetStatsNumber(colPtr, i);
+            if (flags & STATS_DISTINCT) {
+                AddToSketch(statsPtr, HashStatsValue(colPtr, i));
+            }
+        }
+    } else if (colPtr->encodingPtr != NULL) {
+        Row **map;
+        long numRows;
+
+        /* Encoded columns are strings: only count and hash the codes. */
+        map = tablePtr->corePtr->rows.map;
+        numRows = blt_table_num_rows(tablePtr);
+        for (i = 0; i < numRows; i++) {
+            long offset;
+
+            offset = map[i]->offset;
+            if (EncodedCode(colPtr, offset) == 0) {
+                continue;
+            }
+            numValues++;
+            if (flags & STATS_DISTINCT) {
+                AddToSketch(statsPtr, EncodedStringAt(colPtr, offset)->hash);
+            }
+        }
+    } else if (colPtr->chunks != NULL) {
+        Row **map;
+        long numRows;
+
+        map = tablePtr->corePtr->rows.map;
+        numRows = blt_table_num_rows(tablePtr);
+        for (i = 0; i < numRows; i++) {
+            long offset;
+
+            offset = map[i]->offset;
+            if (IsEmptyValue(ColumnValue(colPtr, offset))) {
+                continue;
+            }
+            numValues++;
+            if (isNumeric) {
+                sum += GetStatsNumber(colPtr, offset);
+            }
+            if (flags & STATS_DISTINCT) {
+                AddToSketch(statsPtr, HashStatsValue(colPtr, offset));
+            }
+        }
+    }
+    if (flags & STATS_COUNTS) {
+        statsPtr->numValues = numValues;
+        statsPtr->sum = sum;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetColumnStats --
+ *
+ *      Returns the statistics of the column, computing the ones requested
+ *      that aren't up to date.
+ *
+ *---------------------------------------------------------------------------
+ */
+static ColumnStats *
+GetColumnStats(Table *tablePtr, Column *colPtr, unsigned int flags)
+{
+    ColumnStats *statsPtr;
+    unsigned int needed;
+
+    statsPtr = colPtr->statsPtr;
+    if (statsPtr == NULL) {
+        statsPtr = Blt_AssertCalloc(1, sizeof(ColumnStats));
+        colPtr->statsPtr = statsPtr;
+    }
+    needed = flags & ~statsPtr->flags;
+    if ((needed) && (tablePtr->corePtr->rows.flags & REINDEX)) {
+        /* The scans below use the row map. */
+        ResetRowMap(&tablePtr->corePtr->rows);
+    }
+    if (needed & STATS_LIMITS) {
+        ComputeLimits(tablePtr, colPtr, &statsPtr->minRowPtr,
+                      &statsPtr->maxRowPtr);
+    }
+    if (needed & STATS_DISTINCT) {
+        /* The sketch needs every value, so count them at the same
+         * time. */
+        needed |= STATS_COUNTS;
+    }
+    if (needed & (STATS_COUNTS | STATS_DISTINCT)) {
+        ComputeStats(tablePtr, colPtr, statsPtr, needed);
+    }
+    statsPtr->flags |= needed;
+    return statsPtr;
+}
+
+static void
+FreeColumnStats(Column *colPtr)
+{
+    if (colPtr->statsPtr != NULL) {
+        Blt_Free(colPtr->statsPtr);
+        colPtr->statsPtr = NULL;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * StatsRemoveValue --
+ *
+ *      Removes the row's current value in the column from the column's
+ *      statistics.  This must be called before the value is changed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+StatsRemoveValue(Column *colPtr, Row *rowPtr)
+{
+    ColumnStats *statsPtr;
+
+    statsPtr = colPtr->statsPtr;
+    if ((statsPtr == NULL) || (statsPtr->flags == 0) ||
+        (IsEmpty(rowPtr, colPtr))) {
+        return;
+    }
+    if (statsPtr->flags & STATS_COUNTS) {
+        statsPtr->numValues--;
+        if (IsNumericType(colPtr->type)) {
+            double d;
+
+            d = GetStatsNumber(colPtr, rowPtr->offset);
+            if (FINITE(d)) {
+                statsPtr->sum -= d;
+            } else {
+                /* Can't subtract an infinity or NaN from the sum. */
+                statsPtr->flags &= ~STATS_COUNTS;
+            }
+        }
+    }
+    if ((rowPtr == statsPtr->minRowPtr) || (rowPtr == statsPtr->maxRowPtr)) {
+        statsPtr->flags &= ~STATS_LIMITS;
+    }
+    /* The sketch can't forget a value. */
+    statsPtr->flags &= ~STATS_DISTINCT;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * StatsAddValue --
+ *
+ *      Adds the row's current value in the column to the column's
+ *      statistics.  This is called after the value has been changed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+StatsAddValue(Column *colPtr, Row *rowPtr)
+{
+    ColumnStats *statsPtr;
+
+    statsPtr = colPtr->statsPtr;
+    if ((statsPtr == NULL) || (statsPtr->flags == 0) ||
+        (IsEmpty(rowPtr, colPtr))) {
+        return;
+    }
+    if (statsPtr->flags & STATS_COUNTS) {
+        statsPtr->numValues++;
+        if (IsNumericType(colPtr->type)) {
+            statsPtr->sum += GetStatsNumber(colPtr, rowPtr->offset);
+        }
+    }
+    if (statsPtr->flags & STATS_LIMITS) {
+        if ((IsDoubleType(colPtr->type)) &&
+            (isnan(GetStatsNumber(colPtr, rowPtr->offset)))) {
+            /* NaNs don't compare the same as other values.  Let the scan
+             * sort it out. */
+            statsPtr->flags &= ~STATS_LIMITS;
+        } else if (statsPtr->minRowPtr == NULL) {
+            statsPtr->minRowPtr = statsPtr->maxRowPtr = rowPtr;
+        } else {
+            BLT_TABLE_COMPARE_PROC *proc;
+
+            /* The default comparison of a column never needs the
+             * table. */
+            proc = blt_table_get_compare_proc(NULL, colPtr, 0);
+            if ((*proc)(NULL, colPtr, rowPtr, statsPtr->minRowPtr) < 0) {
+                statsPtr->minRowPtr = rowPtr;
+            }
+            if ((*proc)(NULL, colPtr, rowPtr, statsPtr->maxRowPtr) > 0) {
+                statsPtr->maxRowPtr = rowPtr;
+            }
+        }
+    }
+    if (statsPtr->flags & STATS_DISTINCT) {
+        AddToSketch(statsPtr, HashStatsValue(colPtr, rowPtr->offset));
+    }
+}
+
+static Tcl_Obj *
+GetLimitObj(Table *tablePtr, Column *colPtr, Row *rowPtr)
+{
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        return GetObjFromPacked(colPtr, rowPtr->offset);
+    }
+    return blt_table_get_obj(tablePtr, rowPtr, colPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_column_limits --
+ *
+ *      Returns the minimum and maximum values of the column.  The limits
+ *      are cached, so asking again before the column changes is cheap.
+ *      The objects returned are NULL if the column has no values.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_get_column_limits(Tcl_Interp *interp, Table *tablePtr, Column *colPtr,
+                          Tcl_Obj **minObjPtrPtr, Tcl_Obj **maxObjPtrPtr)
+{
+    ColumnStats *statsPtr;
+    Row *minRowPtr, *maxRowPtr;
+
+    *minObjPtrPtr = *maxObjPtrPtr = NULL;
+    if (blt_table_num_rows(tablePtr) == 0) {
+        return TCL_OK;
+    }
+    statsPtr = GetColumnStats(tablePtr, colPtr, STATS_LIMITS);
+    minRowPtr = statsPtr->minRowPtr;
+    maxRowPtr = statsPtr->maxRowPtr;
+    if (minRowPtr != NULL) {
+        *minObjPtrPtr = GetLimitObj(tablePtr, colPtr, minRowPtr);
+        *maxObjPtrPtr = GetLimitObj(tablePtr, colPtr, maxRowPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_column_stats --
+ *
+ *      Returns the statistics of the column: the # of empty and non-empty
+ *      values, an estimate of the # of distinct values, the minimum and
+ *      maximum values, and for numeric columns the sum of the values.
+ *      The statistics are cached and kept up to date as values are set
+ *      and unset.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_get_column_stats(Tcl_Interp *interp, Table *tablePtr, Column *colPtr,
+                           BLT_TABLE_COLUMN_STATS *resultPtr)
+{
+    ColumnStats *statsPtr;
+    Row *minRowPtr, *maxRowPtr;
+
+    statsPtr = GetColumnStats(tablePtr, colPtr, STATS_ALL);
+    resultPtr->numValues = statsPtr->numValues;
+    resultPtr->numEmpty = blt_table_num_rows(tablePtr) - statsPtr->numValues;
+    resultPtr->numDistinct = EstimateDistinct(statsPtr);
+    resultPtr->isNumeric = IsNumericType(colPtr->type);
+    resultPtr->sum = (resultPtr->isNumeric) ? statsPtr->sum : 0.0;
+    resultPtr->minObjPtr = resultPtr->maxObjPtr = NULL;
+    minRowPtr = statsPtr->minRowPtr;
+    maxRowPtr = statsPtr->maxRowPtr;
+    if (minRowPtr != NULL) {
+        resultPtr->minObjPtr = GetLimitObj(tablePtr, colPtr, minRowPtr);
+        resultPtr->maxObjPtr = GetLimitObj(tablePtr, colPtr, maxRowPtr);
+    }
+    return TCL_OK;
+}
+
+/*
+ * Joins and aggregates.
+ *
+ *      Both build a hash table over the key columns of a table.  The keys
+ *      are hashed by their typed values: integer keys by their 64-bit
+ *      value, numeric keys of mixed types as doubles, and anything else
+ *      by its string.  The hash table maps a 64-bit hash to the first of
+ *      a chain of items with that hash, so collisions are resolved by
+ *      comparing the keys themselves.
+ */
+#define KEY_STRING      0
+#define KEY_INT64       1
+#define KEY_DOUBLE      2
+
+typedef struct {
+    Column *colPtr;
+    int kind;                           /* How the key is compared. */
+} KeyColumn;
+
+static INLINE int
+IsIntegerType(BLT_TABLE_COLUMN_TYPE type)
+{
+    return ((type == TABLE_COLUMN_TYPE_LONG) ||
+            (type == TABLE_COLUMN_TYPE_INT64) ||
+            (type == TABLE_COLUMN_TYPE_BOOLEAN));
+}
+
+static int
+GetKeyKind(Column *colPtr1, Column *colPtr2)
+{
+    if ((IsNumericType(colPtr1->type)) && (IsNumericType(colPtr2->type))) {
+        if ((IsIntegerType(colPtr1->type)) &&
+            (IsIntegerType(colPtr2->type))) {
+            return KEY_INT64;
+        }
+        return KEY_DOUBLE;
+    }
+    return KEY_STRING;
+}
+
+static Row **
+GetRowMap(Table *tablePtr)
+{
+    Rows *rowsPtr;
+
+    rowsPtr = &tablePtr->corePtr->rows;
+    if (rowsPtr->flags & REINDEX) {
+        ResetRowMap(rowsPtr);
+    }
+    return rowsPtr->map;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * HashKeys --
+ *
+ *      Hashes the key values of the row.  If any of the key values is
+ *      empty, the flag pointed to by emptyPtr is set.
+ *
+ *---------------------------------------------------------------------------
+ */
+static uint64_t
+HashKeys(KeyColumn *keys, size_t numKeys, Row *rowPtr, int *emptyPtr)
+{
+    uint64_t hash;
+    size_t i;
+
+    *emptyPtr = FALSE;
+    hash = 0;
+    for (i = 0; i < numKeys; i++) {
+        Column *colPtr;
+        uint64_t h;
+
+        colPtr = keys[i].colPtr;
+        if (IsEmpty(rowPtr, colPtr)) {
+            *emptyPtr = TRUE;
+            h = 0x9e3779b97f4a7c15ULL;
+        } else if (keys[i].kind == KEY_INT64) {
+            h = MixBits((uint64_t)GetInt64Number(colPtr, rowPtr->offset));
+        } else if (keys[i].kind == KEY_DOUBLE) {
+            h = HashDouble(GetStatsNumber(colPtr, rowPtr->offset));
+        } else if (colPtr->encodingPtr != NULL) {
+            /* The hash of each distinct string is computed once. */
+            h = EncodedStringAt(colPtr, rowPtr->offset)->hash;
+        } else {
+            Value *valuePtr;
+
+            valuePtr = ColumnValue(colPtr, rowPtr->offset);
+            h = HashString(GetValueString(valuePtr), GetValueLength(valuePtr));
+        }
+        hash = MixBits(((hash << 5) | (hash >> 59)) ^ h);
+    }
+    return hash;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * KeysEqual --
+ *
+ *      Indicates if the key values of the two rows are the same.  Empty
+ *      values are equal to each other.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+KeysEqual(KeyColumn *keys1, Row *rowPtr1, KeyColumn *keys2, Row *rowPtr2,
+          size_t numKeys)
+{
+    size_t i;
+
+    for (i = 0; i < numKeys; i++) {
+        Column *colPtr1, *colPtr2;
+        int isEmpty1, isEmpty2;
+
+        colPtr1 = keys1[i].colPtr;
+        colPtr2 = keys2[i].colPtr;
+        isEmpty1 = IsEmpty(rowPtr1, colPtr1);
+        isEmpty2 = IsEmpty(rowPtr2, colPtr2);
+        if ((isEmpty1) || (isEmpty2)) {
+            if (isEmpty1 != isEmpty2) {
+                return FALSE;
+            }
+            continue;
+        }
+        if (keys1[i].kind == KEY_INT64) {
+            if (GetInt64Number(colPtr1, rowPtr1->offset) !=
+                GetInt64Number(colPtr2, rowPtr2->offset)) {
+                return FALSE;
+            }
+        } else if (keys1[i].kind == KEY_DOUBLE) {
+            double d1, d2;
+
+            d1 = GetStatsNumber(colPtr1, rowPtr1->offset);
+            d2 = GetStatsNumber(colPtr2, rowPtr2->offset);
+            if ((d1 != d2) && (!isnan(d1) || !isnan(d2))) {
+                return FALSE;
+            }
+        } else if ((colPtr1 == colPtr2) && (colPtr1->encodingPtr != NULL)) {
+            if (EncodedCode(colPtr1, rowPtr1->offset) != 
+                EncodedCode(colPtr2, rowPtr2->offset)) {
+                return FALSE;
+            }
+        } else {
+            const char *s1, *s2;
+            unsigned int length1, length2;
+
+            s1 = GetCellString(colPtr1, rowPtr1->offset, &length1);
+            s2 = GetCellString(colPtr2, rowPtr2->offset, &length2);
+            if ((length1 != length2) || (memcmp(s1, s2, length1) != 0)) {
+                return FALSE;
+            }
+        }
+    }
+    return TRUE;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * CopyCell --
+ *
+ *      Copies the value of a cell from one table to another.  The columns
+ *      have the same type.  Packed values are copied directly.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+CopyCell(Table *destPtr, Row *destRowPtr, Column *destColPtr, Table *srcPtr,
+         Row *srcRowPtr, Column *srcColPtr)
+{
+    Value value;
+    int result;
+
+    if (IsEmpty(srcRowPtr, srcColPtr)) {
+        return TCL_OK;
+    }
+    if (srcColPtr->encodingPtr != NULL) {
+        /* Point to the dictionary's string.  It's copied, so the value
+         * isn't reset. */
+        memset(&value, 0, sizeof(Value));
+        value.string = GetCellString(srcColPtr, srcRowPtr->offset, 
+                                     &value.length);
+        return blt_table_set_value(destPtr, destRowPtr, destColPtr, &value);
+    }
+    if ((srcColPtr->flags & TABLE_COLUMN_PACKED) == 0) {
+        return blt_table_set_value(destPtr, destRowPtr, destColPtr,
+                GetValue(srcPtr, srcRowPtr, srcColPtr));
+    }
+    if ((destColPtr->flags & TABLE_COLUMN_PACKED) &&
+        (destColPtr->type == srcColPtr->type)) {
+        unsigned int flags;
+
+        flags = TABLE_TRACE_WRITES;
+        if (IsEmpty(destRowPtr, destColPtr)) {
+            flags |= TABLE_TRACE_CREATES;
+        }
+        CopyOnWrite(destColPtr, destRowPtr);
+        StatsRemoveValue(destColPtr, destRowPtr);
+        /* Doubles and 64-bit integers are the same size. Copy the bits
+         * rather than converting. */
+        memcpy(PackedSlot(destColPtr, destRowPtr->offset),
+               PackedSlot(srcColPtr, srcRowPtr->offset), sizeof(double));
+        PackedSetExists(destColPtr, destRowPtr->offset);
+        StatsAddValue(destColPtr, destRowPtr);
+        if (destColPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+            destPtr->flags |= TABLE_KEYS_DIRTY;
+        }
+        CallTraces(destPtr, destRowPtr, destColPtr, flags);
+        return TCL_OK;
+    }
+    memset(&value, 0, sizeof(Value));
+    FormatPackedValue(srcColPtr, srcRowPtr->offset, &value);
+    result = blt_table_set_value(destPtr, destRowPtr, destColPtr, &value);
+    ResetValue(&value);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SetupResultColumn --
+ *
+ *      Labels a column of a join or aggregate result and gives it the
+ *      type of the source column.  If the source column is packed, so is
+ *      the result column.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+SetupResultColumn(Tcl_Interp *interp, Table *destPtr, Column *colPtr,
+                  const char *label, BLT_TABLE_COLUMN_TYPE type, int packed)
+{
+    if (blt_table_set_column_label(interp, destPtr, colPtr, label) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (blt_table_set_column_type(interp, destPtr, colPtr, type) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if ((packed) && (PackColumn(interp, destPtr, colPtr) != TCL_OK)) {
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static int
+CheckResultTable(Tcl_Interp *interp, Table *destPtr, Table *tablePtr)
+{
+    if (destPtr->corePtr == tablePtr->corePtr) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "result table can't be the same as ",
+                "the source table", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_join --
+ *
+ *      Joins the rows of two tables whose key values are equal, adding the
+ *      result to the table dest.  The result has the columns of table
+ *      followed by the columns of other, less its key columns.  A column
+ *      of other whose label is already used gets the suffix appended to
+ *      its label.  Each row of table is matched with the rows of other
+ *      that have the same key values, in order.  Empty keys never match.
+ *      For a left join, rows of table without a match are added once,
+ *      with the columns of other left empty.
+ *
+ *      The hash table is built over the rows of other, then probed with
+ *      the rows of table.  Key columns compared as strings need the
+ *      string representations, so packed key columns are unpacked when
+ *      the other key column isn't numeric.  Bound key columns are packed
+ *      again once the rows are matched.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_join(Tcl_Interp *interp, Table *tablePtr, Table *otherPtr,
+               size_t numKeys, Column **keys, Column **otherKeys, int how,
+               const char *suffix, Table *destPtr)
+{
+    Blt_HashTable hashTable;
+    Column **srcColumns, **destColumns;
+    Column *colPtr;
+    KeyColumn *leftKeys, *rightKeys;
+    Row **leftMap, **rightMap, **leftRows, **rightRows, **destRows;
+    long *next;
+    long i, numLeft, numRight, numOut, numAllocated;
+    size_t j, numColumns, numLeftColumns;
+    int result;
+
+    if ((CheckResultTable(interp, destPtr, tablePtr) != TCL_OK) ||
+        (CheckResultTable(interp, destPtr, otherPtr) != TCL_OK)) {
+        return TCL_ERROR;
+    }
+    leftKeys = Blt_AssertMalloc(MAX(numKeys, 1) * sizeof(KeyColumn));
+    rightKeys = Blt_AssertMalloc(MAX(numKeys, 1) * sizeof(KeyColumn));
+    for (j = 0; j < numKeys; j++) {
+        int kind;
+
+        kind = GetKeyKind(keys[j], otherKeys[j]);
+        if (kind == KEY_STRING) {
+            UnpackColumn(tablePtr, keys[j]);
+            UnpackColumn(otherPtr, otherKeys[j]);
+        }
+        leftKeys[j].colPtr = keys[j];
+        rightKeys[j].colPtr = otherKeys[j];
+        leftKeys[j].kind = rightKeys[j].kind = kind;
+    }
+
+    /* Build the hash table over the rows of the other table.  The rows
+     * are added last to first, so that each chain is in row order. */
+    Blt_InitHashTable(&hashTable, BLT_ONE_WORD_KEYS);
+    numRight = blt_table_num_rows(otherPtr);
+    rightMap = GetRowMap(otherPtr);
+    next = Blt_AssertMalloc(MAX(numRight, 1) * sizeof(long));
+    for (i = numRight - 1; i >= 0; i--) {
+        Blt_HashEntry *hPtr;
+        uint64_t hash;
+        int isNew, isEmpty;
+
+        next[i] = -1;
+        hash = HashKeys(rightKeys, numKeys, rightMap[i], &isEmpty);
+        if (isEmpty) {
+            continue;                   /* Empty keys never match. */
+        }
+        hPtr = Blt_CreateHashEntry(&hashTable, (char *)(uintptr_t)hash,
+                                   &isNew);
+        if (!isNew) {
+            next[i] = (long)(intptr_t)Blt_GetHashValue(hPtr);
+        }
+        Blt_SetHashValue(hPtr, (ClientData)(intptr_t)i);
+    }
+
+    /* Probe with the rows of the table, collecting the matching pairs. */
+    numLeft = blt_table_num_rows(tablePtr);
+    leftMap = GetRowMap(tablePtr);
+    numAllocated = MAX(numLeft, 1);
+    leftRows = Blt_AssertMalloc(numAllocated * sizeof(Row *));
+    rightRows = Blt_AssertMalloc(numAllocated * sizeof(Row *));
+    numOut = 0;
+    for (i = 0; i < numLeft; i++) {
+        Blt_HashEntry *hPtr;
+        Row *rowPtr;
+        long k;
+        uint64_t hash;
+        int isEmpty, isMatched;
+
+        rowPtr = leftMap[i];
+        hash = HashKeys(leftKeys, numKeys, rowPtr, &isEmpty);
+        hPtr = NULL;
+        if (!isEmpty) {
+            hPtr = Blt_FindHashEntry(&hashTable, (char *)(uintptr_t)hash);
+        }
+        k = (hPtr != NULL) ? (long)(intptr_t)Blt_GetHashValue(hPtr) : -1;
+        isMatched = FALSE;
+        for (/*empty*/; k >= 0; k = next[k]) {
+            if (!KeysEqual(leftKeys, rowPtr, rightKeys, rightMap[k],
+                           numKeys)) {
+                continue;               /* Same hash, different keys. */
+            }
+            isMatched = TRUE;
+            if (numOut >= numAllocated) {
+                numAllocated += numAllocated;
+                leftRows = Blt_AssertRealloc(leftRows,
+                        numAllocated * sizeof(Row *));
+                rightRows = Blt_AssertRealloc(rightRows,
+                        numAllocated * sizeof(Row *));
+            }
+            leftRows[numOut] = rowPtr;
+            rightRows[numOut] = rightMap[k];
+            numOut++;
+        }
+        if ((!isMatched) && (how == TABLE_JOIN_LEFT)) {
+            if (numOut >= numAllocated) {
+                numAllocated += numAllocated;
+                leftRows = Blt_AssertRealloc(leftRows,
+                        numAllocated * sizeof(Row *));
+                rightRows = Blt_AssertRealloc(rightRows,
+                        numAllocated * sizeof(Row *));
+            }
+            leftRows[numOut] = rowPtr;
+            rightRows[numOut] = NULL;
+            numOut++;
+        }
+    }
+    Blt_DeleteHashTable(&hashTable);
+    Blt_Free(next);
+    for (j = 0; j < numKeys; j++) {
+        RepackBoundColumn(tablePtr, keys[j]);
+        RepackBoundColumn(otherPtr, otherKeys[j]);
+    }
+
+    /* The result has the columns of the table, then the columns of the
+     * other table that aren't keys. */
+    numLeftColumns = blt_table_num_columns(tablePtr);
+    numColumns = numLeftColumns + blt_table_num_columns(otherPtr);
+    srcColumns = Blt_AssertMalloc(MAX(numColumns, 1) * sizeof(Column *));
+    numColumns = 0;
+    for (colPtr = blt_table_first_column(tablePtr); colPtr != NULL;
+         colPtr = blt_table_next_column(colPtr)) {
+        srcColumns[numColumns++] = colPtr;
+    }
+    for (colPtr = blt_table_first_column(otherPtr); colPtr != NULL;
+         colPtr = blt_table_next_column(colPtr)) {
+        for (j = 0; j < numKeys; j++) {
+            if (otherKeys[j] == colPtr) {
+                break;
+            }
+        }
+        if (j == numKeys) {
+            srcColumns[numColumns++] = colPtr;
+        }
+    }
+    result = TCL_ERROR;
+    destColumns = Blt_AssertMalloc(MAX(numColumns, 1) * sizeof(Column *));
+    destRows = Blt_AssertMalloc(MAX(numOut, 1) * sizeof(Row *));
+    if ((blt_table_extend_columns(interp, destPtr, numColumns, destColumns)
+         != TCL_OK) ||
+        (blt_table_extend_rows(interp, destPtr, numOut, destRows) != TCL_OK)) {
+        goto done;
+    }
+    for (j = 0; j < numColumns; j++) {
+        Tcl_DString ds;
+        const char *label;
+        int code;
+
+        colPtr = srcColumns[j];
+        Tcl_DStringInit(&ds);
+        label = colPtr->label;
+        if ((j >= numLeftColumns) &&
+            (blt_table_get_column_by_label(destPtr, label) != NULL)) {
+            Tcl_DStringAppend(&ds, label, -1);
+            Tcl_DStringAppend(&ds, suffix, -1);
+            label = Tcl_DStringValue(&ds);
+        }
+        code = SetupResultColumn(interp, destPtr, destColumns[j], label,
+                colPtr->type, colPtr->flags & TABLE_COLUMN_PACKED);
+        Tcl_DStringFree(&ds);
+        if (code != TCL_OK) {
+            goto done;
+        }
+    }
+    /* Copy the values a column at a time. */
+    for (j = 0; j < numColumns; j++) {
+        Table *srcPtr;
+        Row **srcRows;
+
+        srcPtr = (j < numLeftColumns) ? tablePtr : otherPtr;
+        srcRows = (j < numLeftColumns) ? leftRows : rightRows;
+        for (i = 0; i < numOut; i++) {
+            if (srcRows[i] == NULL) {
+                continue;
+            }
+            if (CopyCell(destPtr, destRows[i], destColumns[j], srcPtr,
+                         srcRows[i], srcColumns[j]) != TCL_OK) {
+                goto done;
+            }
+        }
+    }
+    result = TCL_OK;
+ done:
+    Blt_Free(leftKeys);
+    Blt_Free(rightKeys);
+    Blt_Free(leftRows);
+    Blt_Free(rightRows);
+    Blt_Free(srcColumns);
+    Blt_Free(destColumns);
+    Blt_Free(destRows);
+    return result;
+}
+
+typedef struct {
+    long count;                         /* # of non-empty values. */
+    double sum;                         /* Sum of the values. */
+    Row *rowPtr;                        /* Row holding the minimum or
+                                         * maximum value. */
+} AggregateState;
+
+static const char *aggregateNames[] = {
+    "sum", "mean", "count", "min", "max"
+};
+
+/* Compares the values of two rows for the minimum and maximum. */
+static int
+CompareAggregateValues(Column *colPtr, Row *rowPtr1, Row *rowPtr2)
+{
+    if (IsIntegerType(colPtr->type)) {
+        int64_t i1, i2;
+
+        i1 = GetInt64Number(colPtr, rowPtr1->offset);
+        i2 = GetInt64Number(colPtr, rowPtr2->offset);
+        return (i1 < i2) ? -1 : (i1 > i2);
+    }
+    if (IsDoubleType(colPtr->type)) {
+        double d1, d2;
+
+        d1 = GetStatsNumber(colPtr, rowPtr1->offset);
+        d2 = GetStatsNumber(colPtr, rowPtr2->offset);
+        return (d1 < d2) ? -1 : (d1 > d2);
+    }
+    if (colPtr->encodingPtr != NULL) {
+        return CompareEncodedDictionaryStrings(NULL, colPtr, rowPtr1, rowPtr2);
+    }
+    return Blt_DictionaryCompare(
+        GetValueString(ColumnValue(colPtr, rowPtr1->offset)),
+        GetValueString(ColumnValue(colPtr, rowPtr2->offset)));
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_aggregate --
+ *
+ *      Groups the rows of the table by their key values and computes the
+ *      aggregates of each group, adding the result to the table dest.
+ *      The result has a row for each group, in the order the groups are
+ *      first found, and the key columns followed by a column for each
+ *      aggregate.  The aggregate columns are labeled by the column and
+ *      function (for example "price_sum").  Empty keys form their own
+ *      group.  Empty values (and NaNs, for the minimum and maximum) are
+ *      skipped.  Counts are integers, sums and means are doubles, and the
+ *      minimum and maximum have the type of their column.  A sum, mean,
+ *      minimum, or maximum of a group without values is empty.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_aggregate(Tcl_Interp *interp, Table *tablePtr, size_t numKeys,
+                    Column **keys, size_t numAggs, BLT_TABLE_AGGREGATE *aggs,
+                    Table *destPtr)
+{
+    AggregateState *states;
+    Blt_HashTable hashTable;
+    Column **destColumns;
+    KeyColumn *keyColumns;
+    Row **map, **groupRows, **destRows;
+    long *next;
+    long i, numRows, numGroups, numAllocated;
+    size_t j;
+    int result;
+
+    if (CheckResultTable(interp, destPtr, tablePtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    for (j = 0; j < numAggs; j++) {
+        Column *colPtr;
+        int op;
+
+        colPtr = aggs[j].col;
+        op = aggs[j].op;
+        if (((op == TABLE_AGGREGATE_SUM) || (op == TABLE_AGGREGATE_MEAN)) &&
+            (!IsNumericType(colPtr->type))) {
+            if (interp != NULL) {
+                Tcl_AppendResult(interp, "can't ", aggregateNames[op],
+                        " column \"", colPtr->label, "\": type \"",
+                        blt_table_column_type_to_name(colPtr->type),
+                        "\" isn't numeric", (char *)NULL);
+            }
+            return TCL_ERROR;
+        }
+        if (((op == TABLE_AGGREGATE_MIN) || (op == TABLE_AGGREGATE_MAX)) &&
+            (!IsNumericType(colPtr->type))) {
+            UnpackColumn(tablePtr, colPtr);
+        }
+    }
+    keyColumns = Blt_AssertMalloc(MAX(numKeys, 1) * sizeof(KeyColumn));
+    for (j = 0; j < numKeys; j++) {
+        keyColumns[j].colPtr = keys[j];
+        keyColumns[j].kind = GetKeyKind(keys[j], keys[j]);
+    }
+
+    /* Find the group of each row.  The hash table holds the index of the
+     * most recent group with the hash, and the groups with the same hash
+     * are chained. */
+    Blt_InitHashTable(&hashTable, BLT_ONE_WORD_KEYS);
+    numRows = blt_table_num_rows(tablePtr);
+    map = GetRowMap(tablePtr);
+    numGroups = 0;
+    numAllocated = 64;
+    groupRows = Blt_AssertMalloc(numAllocated * sizeof(Row *));
+    next = Blt_AssertMalloc(numAllocated * sizeof(long));
+    states = Blt_AssertCalloc(numAllocated * MAX(numAggs, 1),
+                              sizeof(AggregateState));
+    for (i = 0; i < numRows; i++) {
+        AggregateState *statePtr;
+        Blt_HashEntry *hPtr;
+        Row *rowPtr;
+        long group;
+        uint64_t hash;
+        int isNew, isEmpty;
+
+        rowPtr = map[i];
+        hash = HashKeys(keyColumns, numKeys, rowPtr, &isEmpty);
+        hPtr = Blt_CreateHashEntry(&hashTable, (char *)(uintptr_t)hash,
+                                   &isNew);
+        group = -1;
+        if (!isNew) {
+            for (group = (long)(intptr_t)Blt_GetHashValue(hPtr); group >= 0;
+                 group = next[group]) {
+                if (KeysEqual(keyColumns, rowPtr, keyColumns,
+                              groupRows[group], numKeys)) {
+                    break;
+                }
+            }
+        }
+        if (group < 0) {
+            if (numGroups >= numAllocated) {
+                size_t oldSize;
+
+                oldSize = numAllocated * MAX(numAggs, 1);
+                numAllocated += numAllocated;
+                groupRows = Blt_AssertRealloc(groupRows,
+                        numAllocated * sizeof(Row *));
+                next = Blt_AssertRealloc(next, numAllocated * sizeof(long));
+                states = Blt_AssertRealloc(states, numAllocated *
+                        MAX(numAggs, 1) * sizeof(AggregateState));
+                memset(states + oldSize, 0, oldSize * sizeof(AggregateState));
+            }
+            group = numGroups++;
+            groupRows[group] = rowPtr;
+            next[group] = (isNew) ? -1 :
+                (long)(intptr_t)Blt_GetHashValue(hPtr);
+            Blt_SetHashValue(hPtr, (ClientData)(intptr_t)group);
+        }
+        statePtr = states + group * numAggs;
+        for (j = 0; j < numAggs; j++, statePtr++) {
+            Column *colPtr;
+
+            colPtr = aggs[j].col;
+            if (IsEmpty(rowPtr, colPtr)) {
+                continue;
+            }
+            switch (aggs[j].op) {
+            case TABLE_AGGREGATE_SUM:
+            case TABLE_AGGREGATE_MEAN:
+                statePtr->sum += GetStatsNumber(colPtr, rowPtr->offset);
+                /*FALLTHRU*/
+            case TABLE_AGGREGATE_COUNT:
+                statePtr->count++;
+                break;
+            case TABLE_AGGREGATE_MIN:
+            case TABLE_AGGREGATE_MAX:
+                if ((IsDoubleType(colPtr->type)) &&
+                    (isnan(GetStatsNumber(colPtr, rowPtr->offset)))) {
+                    break;
+                }
+                if (statePtr->rowPtr == NULL) {
+                    statePtr->rowPtr = rowPtr;
+                } else {
+                    int cmp;
+
+                    cmp = CompareAggregateValues(colPtr, rowPtr,
+                                                 statePtr->rowPtr);
+                    if ((aggs[j].op == TABLE_AGGREGATE_MIN) ? (cmp < 0) :
+                        (cmp > 0)) {
+                        statePtr->rowPtr = rowPtr;
+                    }
+                }
+                break;
+            }
+        }
+    }
+    Blt_DeleteHashTable(&hashTable);
+
+    result = TCL_ERROR;
+    destColumns = Blt_AssertMalloc(MAX(numKeys + numAggs, 1) *
+                                   sizeof(Column *));
+    destRows = Blt_AssertMalloc(MAX(numGroups, 1) * sizeof(Row *));
+    if ((blt_table_extend_columns(interp, destPtr, numKeys + numAggs,
+                destColumns) != TCL_OK) ||
+        (blt_table_extend_rows(interp, destPtr, numGroups, destRows)
+         != TCL_OK)) {
+        goto done;
+    }
+    for (j = 0; j < numKeys; j++) {
+        Column *colPtr;
+
+        colPtr = keys[j];
+        if (SetupResultColumn(interp, destPtr, destColumns[j], colPtr->label,
+                colPtr->type, colPtr->flags & TABLE_COLUMN_PACKED) != TCL_OK) {
+            goto done;
+        }
+        for (i = 0; i < numGroups; i++) {
+            if (CopyCell(destPtr, destRows[i], destColumns[j], tablePtr,
+                         groupRows[i], colPtr) != TCL_OK) {
+                goto done;
+            }
+        }
+    }
+    for (j = 0; j < numAggs; j++) {
+        Tcl_DString ds;
+        Column *colPtr, *destColPtr;
+        BLT_TABLE_COLUMN_TYPE type;
+        int code, op, packed;
+
+        colPtr = aggs[j].col;
+        op = aggs[j].op;
+        destColPtr = destColumns[numKeys + j];
+        Tcl_DStringInit(&ds);
+        Tcl_DStringAppend(&ds, colPtr->label, -1);
+        Tcl_DStringAppend(&ds, "_", 1);
+        Tcl_DStringAppend(&ds, aggregateNames[op], -1);
+        packed = TRUE;
+        if (op == TABLE_AGGREGATE_COUNT) {
+            type = TABLE_COLUMN_TYPE_LONG;
+        } else if ((op == TABLE_AGGREGATE_SUM) ||
+                   (op == TABLE_AGGREGATE_MEAN)) {
+            type = TABLE_COLUMN_TYPE_DOUBLE;
+        } else {
+            type = colPtr->type;
+            packed = (colPtr->flags & TABLE_COLUMN_PACKED);
+        }
+        code = SetupResultColumn(interp, destPtr, destColPtr,
+                Tcl_DStringValue(&ds), type, packed);
+        Tcl_DStringFree(&ds);
+        if (code != TCL_OK) {
+            goto done;
+        }
+        for (i = 0; i < numGroups; i++) {
+            AggregateState *statePtr;
+
+            statePtr = states + i * numAggs + j;
+            code = TCL_OK;
+            switch (op) {
+            case TABLE_AGGREGATE_COUNT:
+                code = blt_table_set_long(interp, destPtr, destRows[i],
+                        destColPtr, statePtr->count);
+                break;
+            case TABLE_AGGREGATE_SUM:
+                if (statePtr->count > 0) {
+                    code = blt_table_set_double(interp, destPtr, destRows[i],
+                        destColPtr, statePtr->sum);
+                }
+                break;
+            case TABLE_AGGREGATE_MEAN:
+                if (statePtr->count > 0) {
+                    code = blt_table_set_double(interp, destPtr, destRows[i],
+                        destColPtr, statePtr->sum / statePtr->count);
+                }
+                break;
+            default:
+                if (statePtr->rowPtr != NULL) {
+                    code = CopyCell(destPtr, destRows[i], destColPtr,
+                        tablePtr, statePtr->rowPtr, colPtr);
+                }
+                break;
+            }
+            if (code != TCL_OK) {
+                goto done;
+            }
+        }
+    }
+    result = TCL_OK;
+ done:
+    Blt_Free(keyColumns);
+    Blt_Free(groupRows);
+    Blt_Free(next);
+    Blt_Free(states);
+    Blt_Free(destColumns);
+    Blt_Free(destRows);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ShareColumn --
+ *
+ *      Makes the snapshot column use the chunks of the table's column.
+ *      The snapshot column gets its own directory of the same chunks.
+ *      Columns mapped from a binary snapshot are copied instead, since
+ *      their chunks go away with the binary snapshot.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ShareColumn(Column *srcPtr, Column *destPtr, long numAllocated)
+{
+    ColumnShare *srcSharePtr, *destSharePtr;
+    long i, numValues, numChunks;
+
+    if (srcPtr->encodingPtr != NULL) {
+        /* Encoded columns are small: copy the codes and dictionary. */
+        CopyEncodedColumn(srcPtr, destPtr, numAllocated);
+        return;
+    }
+    if (srcPtr->flags & TABLE_COLUMN_PACKED) {
+        destPtr->packed.d = srcPtr->packed.d;
+        destPtr->validMap = srcPtr->validMap;
+        destPtr->numPacked = srcPtr->numPacked;
+        if (srcPtr->flags & TABLE_COLUMN_MAPPED) {
+            CopyPackedChunks(destPtr);
+            return;
+        }
+        numValues = srcPtr->numPacked;
+    } else if (srcPtr->chunks != NULL) {
+        numValues = numAllocated;
+    } else {
+        return;                         /* No storage yet. */
+    }
+    numChunks = NumChunks(numValues);
+    srcSharePtr = srcPtr->sharePtr;
+    if (srcSharePtr == NULL) {
+        srcSharePtr = Blt_AssertCalloc(1, sizeof(ColumnShare));
+        srcPtr->sharePtr = srcSharePtr;
+    }
+    if (srcSharePtr->numChunks < numChunks) {
+        /* Rows were added since the last snapshot.  The new chunks, and
+         * the grown last chunk, aren't shared yet. */
+        srcSharePtr->refCounts = Blt_AssertRealloc(srcSharePtr->refCounts,
+                numChunks * sizeof(int *));
+        memset(srcSharePtr->refCounts + srcSharePtr->numChunks, 0, 
+               (numChunks - srcSharePtr->numChunks) * sizeof(int *));
+        srcSharePtr->numChunks = numChunks;
+    }
+    srcSharePtr->numValues = numValues;
+    destSharePtr = Blt_AssertCalloc(1, sizeof(ColumnShare));
+    destSharePtr->numValues = numValues;
+    destSharePtr->numChunks = numChunks;
+    destSharePtr->refCounts = Blt_AssertMalloc(numChunks * sizeof(int *));
+    for (i = 0; i < numChunks; i++) {
+        int *countPtr;
+
+        countPtr = srcSharePtr->refCounts[i];
+        if (countPtr == NULL) {
+            countPtr = Blt_AssertMalloc(sizeof(int));
+            *countPtr = 1;
+            srcSharePtr->refCounts[i] = countPtr;
+        }
+        (*countPtr)++;
+        destSharePtr->refCounts[i] = countPtr;
+    }
+    destPtr->sharePtr = destSharePtr;
+    if (srcPtr->flags & TABLE_COLUMN_PACKED) {
+        destPtr->packed.d = Blt_AssertMalloc(numChunks * sizeof(double *));
+        memcpy(destPtr->packed.d, srcPtr->packed.d, 
+               numChunks * sizeof(double *));
+        destPtr->validMap = Blt_AssertMalloc(numChunks * 
+                sizeof(unsigned int *));
+        memcpy(destPtr->validMap, srcPtr->validMap, 
+               numChunks * sizeof(unsigned int *));
+    } else {
+        destPtr->chunks = Blt_AssertMalloc(numChunks * sizeof(Value *));
+        memcpy(destPtr->chunks, srcPtr->chunks, numChunks * sizeof(Value *));
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_snapshot --
+ *
+ *      Creates a read-only table holding the current rows and columns of
+ *      the table.  The snapshot shares the chunks of the table's columns
+ *      copy-on-write: when the table first changes a value the snapshot
+ *      can see, only the chunk holding it is copied.  Appending rows to
+ *      the table copies at most the partial last chunk.  Row and column
+ *      labels are copied.  Tags, traces, notifiers, keys, and indexes are
+ *      not.
+ *
+ * Results:
+ *      A standard TCL result.  The token of the new table is returned
+ *      via snapPtrPtr.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_snapshot(Tcl_Interp *interp, Table *tablePtr, const char *name,
+                   Table **snapPtrPtr)
+{
+    Column *srcColPtr, *colPtr;
+    Columns *columnsPtr;
+    Row *srcRowPtr;
+    Rows *rowsPtr, *srcRowsPtr;
+    Table *snapPtr;
+    long numAllocated;
+
+    if (blt_table_create(interp, name, &snapPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    srcRowsPtr = &tablePtr->corePtr->rows;
+    rowsPtr = &snapPtr->corePtr->rows;
+    columnsPtr = &snapPtr->corePtr->columns;
+
+    /* The rows keep their offsets, so the shared storage lines up. */
+    numAllocated = srcRowsPtr->numAllocated;
+    if (numAllocated > 0) {
+        rowsPtr->map = Blt_AssertMalloc(numAllocated * sizeof(Row *));
+        rowsPtr->numAllocated = numAllocated;
+    }
+    for (srcRowPtr = srcRowsPtr->headPtr; srcRowPtr != NULL; 
+         srcRowPtr = srcRowPtr->nextPtr) {
+        Row *rowPtr;
+
+        rowPtr = Blt_Pool_AllocItem(rowsPtr->pool, sizeof(Row));
+        memset(rowPtr, 0, sizeof(Row));
+        if (rowsPtr->headPtr == NULL) {
+            rowsPtr->headPtr = rowPtr;
+        } else {
+            rowPtr->prevPtr = rowsPtr->tailPtr;
+            rowsPtr->tailPtr->nextPtr = rowPtr;
+        }
+        rowsPtr->tailPtr = rowPtr;
+        rowPtr->offset = srcRowPtr->offset;
+        rowPtr->index = rowsPtr->numUsed;
+        rowsPtr->map[rowsPtr->numUsed++] = rowPtr;
+        SetRowLabel(rowsPtr, rowPtr, srcRowPtr->label);
+    }
+    rowsPtr->nextRowId = srcRowsPtr->nextRowId;
+
+    ExtendColumns(snapPtr, blt_table_num_columns(tablePtr), NULL);
+    colPtr = columnsPtr->headPtr;
+    for (srcColPtr = tablePtr->corePtr->columns.headPtr; srcColPtr != NULL;
+         srcColPtr = srcColPtr->nextPtr, colPtr = colPtr->nextPtr) {
+        SetColumnLabel(columnsPtr, colPtr, srcColPtr->label);
+        colPtr->type = srcColPtr->type;
+        colPtr->flags = srcColPtr->flags & TABLE_COLUMN_PACKED;
+        ShareColumn(srcColPtr, colPtr, numAllocated);
+    }
+    columnsPtr->nextColumnId = tablePtr->corePtr->columns.nextColumnId;
+    snapPtr->corePtr->flags |= TABLE_READONLY;
+    *snapPtrPtr = snapPtr;
+    return TCL_OK;
+}
+
+int
+blt_table_is_snapshot(Table *tablePtr)
+{
+    return ((tablePtr->corePtr->flags & TABLE_READONLY) != 0);
+}
+
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_delete_column --
+ *
+ *      Remove the designated column from the table.  The actual space
+ *      contained by the column isn't freed.  The map is compressed.
+ *      Tcl_Objs stored as column values are released.  Traces and tags
+ *      associated with the column are removed.
+ *
+ * Side Effects:
+ *      Traces may fire when column values are unset.  Also notifier events
+ *      may be triggered, indicating the column has been deleted.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_delete_column(Table *tablePtr, Column *colPtr)
+{
+    if (IsReadOnly(NULL, tablePtr)) {
+        return TCL_ERROR;
+    }
+    /* If the deleted column is a primary key, the generated keytables
+     * are now invalid. So remove them. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        blt_table_unset_keys(tablePtr);
+    }
+    NotifyColumnChanged(tablePtr, colPtr, TABLE_NOTIFY_COLUMNS_DELETED);
+    blt_table_clear_column_traces(tablePtr, colPtr);
+    Blt_Tags_ClearTagsFromItem(tablePtr->columnTags, colPtr);
+    ClearColumnNotifiers(tablePtr, colPtr);
+    ForgetBatchItems(tablePtr->corePtr, NULL, colPtr);
+    DeleteColumn(tablePtr, colPtr);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_extend_columns --
+ *
+ *      Adds new columns to the table.  Columns are slots in an array of
+ *      Columns.  The array columns by doubling its size, so there may be more
+ *      slots than needed (# columns).
+ *
+ * Results:
+ *      Returns TCL_OK is the tuple is resized and TCL_ERROR if an
+ *      not enough memory was available.
+ *
+ * Side Effects:
+ *      If more columns are needed, the array which holds the tuples is
+ *      reallocated by doubling its size.  
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_extend_columns(Tcl_Interp *interp, BLT_TABLE table, size_t numExtra, 
+                        Column **columns)
+{
+    size_t i;
+    Blt_Chain chain;
+    Blt_ChainLink link;
+
+    if (IsReadOnly(interp, table)) {
+        return TCL_ERROR;
+    }
+    chain = Blt_Chain_Create();
+    if (!ExtendColumns(table, numExtra, chain)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't extend table by ", 
+                Blt_Ltoa(numExtra), " columns: out of memory.", (char *)NULL);
+        }
+        Blt_Chain_Destroy(chain);
+        return TCL_ERROR;
+    }
+    /* For each new column generate a notify event. */
+    for (i = 0, link = Blt_Chain_FirstLink(chain); link != NULL; 
+         link = Blt_Chain_NextLink(link), i++) {
+        Column *colPtr;
+
+        colPtr = Blt_Chain_GetValue(link);
+        if (columns != NULL) {
+            columns[i] = colPtr;
+        }
+        NotifyColumnChanged(table, colPtr, TABLE_NOTIFY_COLUMNS_CREATED);
+    }
+    Blt_Chain_Destroy(chain);
+    return TCL_OK;
+}
+
+BLT_TABLE_COLUMN
+blt_table_create_column(Tcl_Interp *interp, BLT_TABLE table, const char *label)
+{
+    Column *colPtr;
+
+    colPtr = NULL;                      /* Suppress compiler warning. */
+    if (blt_table_extend_columns(interp, table, 1, &colPtr) != TCL_OK) {
+        return NULL;
+    }
+    if (label != NULL) {
+        if (blt_table_set_column_label(interp, table, colPtr, label)!=TCL_OK) {
+            blt_table_delete_column(table, colPtr);
+            return NULL;
+        }
+    }
+    return colPtr;
+}
+
+void
+blt_table_set_column_map(Table *tablePtr, Column **map)
+{
+    NotifyColumnChanged(tablePtr, NULL, TABLE_NOTIFY_COLUMNS_MOVED);
+    ReplaceColumnMap(&tablePtr->corePtr->columns, map);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_move_columns --
+ *
+ *      Move one of more rows to a new location in the tuple.
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+int
+blt_table_move_columns(Tcl_Interp *interp, Table *tablePtr, Column *destPtr, 
+                       Column *firstPtr, Column *lastPtr, int after)
+{
+    Columns *columnsPtr;
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    columnsPtr = &tablePtr->corePtr->columns;
+    if (!MoveColumns(columnsPtr, destPtr, firstPtr, lastPtr, after)) {
+        Tcl_AppendResult(interp, "can't move columns in \"", 
+                blt_table_name(tablePtr), "\"", (char *)NULL);
+        return TCL_ERROR;
+    }
+    NotifyColumnChanged(tablePtr, NULL, TABLE_NOTIFY_COLUMNS_MOVED);
+    return TCL_OK;
+}
+
+/* 
+ * Binary snapshots.
+ *
+ *      A snapshot is a versioned, columnar image of a table written by
+ *      blt_table_file_dump_binary.  Numbers are in the byte order of the
+ *      machine that wrote the file.
+ *
+ *      header          SnapshotHeader
+ *      column data     For each column: its label and tag list (NUL
+ *                      terminated strings), a bitmap of the rows that
+ *                      have a value, then either a typed array of 8-byte
+ *                      values (numeric columns) or an array of heap
+ *                      offsets and a heap of NUL terminated strings.
+ *      row data        Row labels and row tag lists, stored as string
+ *                      arrays.
+ *      directory       SnapshotColumn for each column.
+ *
+ *      Sections are aligned on 8-byte boundaries.  Numeric arrays and
+ *      bitmaps have a slot for every row the restored table will allocate,
+ *      so that blt_table_file_restore can map the file and point packed
+ *      columns directly at its pages.  The mapping is private, so changing
+ *      a value copies only the page that holds it.
+ */
+#define SNAPSHOT_MAGIC          "\211BLTDT\r\n"
+#define SNAPSHOT_MAGIC_LENGTH   8
+#define SNAPSHOT_VERSION        1
+#define SNAPSHOT_BYTE_ORDER     0x01020304
+
+typedef struct {
+    char magic[SNAPSHOT_MAGIC_LENGTH];
+    uint32_t version;
+    uint32_t byteOrder;                 /* Written as SNAPSHOT_BYTE_ORDER
+                                         * in the writer's byte order. */
+    int64_t numRows, numColumns;
+    int64_t capacity;                   /* # of slots in numeric arrays
+                                         * and bitmaps. */
+    int64_t directory;                  /* Offset of the column
+                                         * directory. */
+    int64_t rowLabels, rowLabelHeap;    /* String array of row labels. */
+    int64_t rowTags, rowTagHeap;        /* String array of row tags. */
+} SnapshotHeader;
+
+typedef struct {
+    int32_t type;                       /* Column type. */
+    uint32_t flags;                     /* Not used. */
+    int64_t label, labelLength;
+    int64_t tags, tagsLength;
+    int64_t validMap;                   /* Bitmap of rows with values. */
+    int64_t data;                       /* Numeric columns: array of
+                                         * values.  Otherwise an array of
+                                         * numRows + 1 heap offsets. */
+    int64_t heap;                       /* Start of the string heap. */
+} SnapshotColumn;
+
+typedef struct {
+    Tcl_Channel channel;
+    int64_t offset;                     /* Current offset in the file. */
+    int error;                          /* Indicates a write failed. */
+} SnapshotWriter;
+
+typedef struct {
+    char *base;                         /* Contents of the file. */
+    size_t size;                        /* Size of the file in bytes. */
+} Snapshot;
+
+static void
+WriteSnapshot(SnapshotWriter *writerPtr, const void *bytes, size_t numBytes)
+{
+    if ((writerPtr->error) || (numBytes == 0)) {
+        return;
+    }
+    if (Tcl_Write(writerPtr->channel, (const char *)bytes, numBytes) != 
+        (int)numBytes) {
+        writerPtr->error = TRUE;
+    }
+    writerPtr->offset += numBytes;
+}
+
+static void
+AlignSnapshot(SnapshotWriter *writerPtr)
+{
+    static const char zeros[8] = { 0 };
+    size_t pad;
+
+    pad = (8 - (writerPtr->offset & 7)) & 7;
+    WriteSnapshot(writerPtr, zeros, pad);
+}
+
+static char *
+GetTagList(Blt_Chain tags, Tcl_DString *dsPtr)
+{
+    Blt_ChainLink link;
+
+    Tcl_DStringSetLength(dsPtr, 0);
+    for (link = Blt_Chain_FirstLink(tags); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        Tcl_DStringAppendElement(dsPtr, Blt_Chain_GetValue(link));
+    }
+    Blt_Chain_Destroy(tags);
+    return Tcl_DStringValue(dsPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * WriteSnapshotStrings --
+ *
+ *      Writes a heap of NUL terminated strings followed by the array of
+ *      numRows + 1 heap offsets.  Empty strings (NULL) have the same
+ *      offset as the next string.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+WriteSnapshotStrings(SnapshotWriter *writerPtr, size_t numRows, 
+                     const char **strings, const unsigned int *lengths,
+                     int64_t *dataPtr, int64_t *heapPtr)
+{
+    int64_t *offsets;
+    size_t i;
+
+    offsets = Blt_AssertMalloc((numRows + 1) * sizeof(int64_t));
+    *heapPtr = writerPtr->offset;
+    offsets[0] = 0;
+    for (i = 0; i < numRows; i++) {
+        offsets[i + 1] = offsets[i];
+        if (strings[i] != NULL) {
+            WriteSnapshot(writerPtr, strings[i], lengths[i] + 1);
+            offsets[i + 1] += lengths[i] + 1;
+        }
+    }
+    AlignSnapshot(writerPtr);
+    *dataPtr = writerPtr->offset;
+    WriteSnapshot(writerPtr, offsets, (numRows + 1) * sizeof(int64_t));
+    Blt_Free(offsets);
+}
+
+static void
+WriteSnapshotColumn(SnapshotWriter *writerPtr, Table *tablePtr, 
+                    Column *colPtr, size_t numRows, Row **rows, 
+                    size_t capacity, SnapshotColumn *entryPtr)
+{
+    Tcl_DString ds;
+    const char *tags;
+    unsigned int *validMap;
+    size_t i, numWords;
+
+    entryPtr->type = colPtr->type;
+    entryPtr->label = writerPtr->offset;
+    entryPtr->labelLength = strlen(colPtr->label);
+    WriteSnapshot(writerPtr, colPtr->label, entryPtr->labelLength + 1);
+    Tcl_DStringInit(&ds);
+    tags = GetTagList(blt_table_get_column_tags(tablePtr, colPtr), &ds);
+    entryPtr->tags = writerPtr->offset;
+    entryPtr->tagsLength = Tcl_DStringLength(&ds);
+    WriteSnapshot(writerPtr, tags, entryPtr->tagsLength + 1);
+    Tcl_DStringFree(&ds);
+    AlignSnapshot(writerPtr);
+
+    numWords = PackedMapSize(capacity);
+    validMap = Blt_AssertCalloc(numWords, sizeof(unsigned int));
+    for (i = 0; i < numRows; i++) {
+        if (!IsEmpty(rows[i], colPtr)) {
+            validMap[i >> 5] |= (1U << (i & 31));
+        }
+    }
+    entryPtr->validMap = writerPtr->offset;
+    WriteSnapshot(writerPtr, validMap, numWords * sizeof(unsigned int));
+    Blt_Free(validMap);
+    AlignSnapshot(writerPtr);
+
+    if (IsPackableType(colPtr->type)) {
+        double buffer[1024];
+        size_t count;
+
+        /* Doubles and 64-bit integers are the same size.  The buffer
+         * holds either. */
+        entryPtr->heap = 0;
+        entryPtr->data = writerPtr->offset;
+        count = 0;
+        for (i = 0; i < capacity; i++) {
+            int64_t *i64Ptr;
+            Row *rowPtr;
+
+            i64Ptr = (int64_t *)(buffer + count);
+            buffer[count] = 0.0;
+            rowPtr = (i < numRows) ? rows[i] : NULL;
+            if ((rowPtr == NULL) || (IsEmpty(rowPtr, colPtr))) {
+                /* Empty slot. */
+            } else if (colPtr->flags & TABLE_COLUMN_PACKED) {
+                memcpy(buffer + count, PackedSlot(colPtr, rowPtr->offset),
+                       sizeof(double));
+            } else {
+                Value *valuePtr;
+
+                valuePtr = ColumnValue(colPtr, rowPtr->offset);
+                switch (colPtr->type) {
+                case TABLE_COLUMN_TYPE_DOUBLE:
+                case TABLE_COLUMN_TYPE_TIME:
+                    buffer[count] = valuePtr->datum.d;
+                    break;
+                case TABLE_COLUMN_TYPE_LONG:
+                    *i64Ptr = valuePtr->datum.l;
+                    break;
+                default:
+                    *i64Ptr = valuePtr->datum.i64;
+                    break;
+                }
+            }
+            count++;
+            if (count == 1024) {
+                WriteSnapshot(writerPtr, buffer, count * sizeof(double));
+                count = 0;
+            }
+        }
+        WriteSnapshot(writerPtr, buffer, count * sizeof(double));
+    } else {
+        const char **strings;
+        unsigned int *lengths;
+
+        strings = Blt_AssertCalloc(numRows + 1, sizeof(char *));
+        lengths = Blt_AssertCalloc(numRows + 1, sizeof(unsigned int));
+        for (i = 0; i < numRows; i++) {
+            if (!IsEmpty(rows[i], colPtr)) {
+                strings[i] = GetCellString(colPtr, rows[i]->offset, 
+                                           lengths + i);
+            }
+        }
+        WriteSnapshotStrings(writerPtr, numRows, strings, lengths, 
+                &entryPtr->data, &entryPtr->heap);
+        Blt_Free(strings);
+        Blt_Free(lengths);
+    }
+    AlignSnapshot(writerPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_file_dump_binary --
+ *
+ *      Writes a binary snapshot of the rows and columns selected by the
+ *      iterators to the named file.  The snapshot can be read back with
+ *      blt_table_file_restore.
+ *
+ * Results:
+ *      A standard TCL result.  If the file can't be written, TCL_ERROR is
+ *      returned and an error message is left in the interpreter result.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_file_dump_binary(Tcl_Interp *interp, Table *tablePtr, 
+                           const char *fileName, BLT_TABLE_ITERATOR *riPtr,
+                           BLT_TABLE_ITERATOR *ciPtr)
+{
+    SnapshotHeader header;
+    SnapshotColumn *directory;
+    SnapshotWriter writer;
+    Tcl_DString ds;
+    Tcl_Obj *tmpObjPtr, *fileObjPtr;
+    Row **rows, *rowPtr;
+    Column **columns, *colPtr;
+    const char **strings;
+    unsigned int *lengths;
+    size_t i, size, numRows, numColumns;
+    int result;
+
+    /* Iterators over lists of rows or columns can only be walked once.
+     * Collect the rows and columns into arrays first. */
+    numRows = numColumns = 0;
+    size = 64;
+    rows = Blt_AssertMalloc(size * sizeof(Row *));
+    for (rowPtr = blt_table_first_tagged_row(riPtr); rowPtr != NULL;
+         rowPtr = blt_table_next_tagged_row(riPtr)) {
+        if (numRows == size) {
+            size += size;
+            rows = Blt_AssertRealloc(rows, size * sizeof(Row *));
+        }
+        rows[numRows++] = rowPtr;
+    }
+    size = 64;
+    columns = Blt_AssertMalloc(size * sizeof(Column *));
+    for (colPtr = blt_table_first_tagged_column(ciPtr); colPtr != NULL;
+         colPtr = blt_table_next_tagged_column(ciPtr)) {
+        if (numColumns == size) {
+            size += size;
+            columns = Blt_AssertRealloc(columns, size * sizeof(Column *));
+        }
+        columns[numColumns++] = colPtr;
+    }
+    /* Write to a temporary file and rename it.  Tables restored from the
+     * old file may still have its pages mapped. Truncating it in place
+     * would pull those pages out from under them. */
+    Tcl_DStringInit(&ds);
+    Tcl_DStringAppend(&ds, fileName, -1);
+    Tcl_DStringAppend(&ds, ".tmp", 4);
+    tmpObjPtr = Tcl_NewStringObj(Tcl_DStringValue(&ds), -1);
+    Tcl_IncrRefCount(tmpObjPtr);
+    Tcl_DStringFree(&ds);
+    writer.channel = Tcl_FSOpenFileChannel(interp, tmpObjPtr, "w", 0666);
+    if (writer.channel == NULL) {
+        Tcl_DecrRefCount(tmpObjPtr);
+        Blt_Free(rows);
+        Blt_Free(columns);
+        return TCL_ERROR;
+    }
+    Tcl_SetChannelOption(NULL, writer.channel, "-translation", "binary");
+    writer.offset = 0;
+    writer.error = FALSE;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LENGTH);
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.numRows = numRows;
+    header.numColumns = numColumns;
+    header.capacity = GetMapSize(0, numRows);
+    /* Reserve space for the header.  It's rewritten at the end once the
+     * offsets of the sections are known. */
+    WriteSnapshot(&writer, &header, sizeof(header));
+
+    directory = Blt_AssertCalloc(numColumns + 1, sizeof(SnapshotColumn));
+    for (i = 0; i < numColumns; i++) {
+        WriteSnapshotColumn(&writer, tablePtr, columns[i], numRows, rows, 
+                header.capacity, directory + i);
+    }
+    Blt_Free(columns);
+
+    /* Row labels and tags. */
+    strings = Blt_AssertCalloc(numRows + 1, sizeof(char *));
+    lengths = Blt_AssertCalloc(numRows + 1, sizeof(unsigned int));
+    for (i = 0; i < numRows; i++) {
+        strings[i] = rows[i]->label;
+        lengths[i] = strlen(rows[i]->label);
+    }
+    WriteSnapshotStrings(&writer, numRows, strings, lengths, 
+        &header.rowLabels, &header.rowLabelHeap);
+    AlignSnapshot(&writer);
+    Tcl_DStringInit(&ds);
+    for (i = 0; i < numRows; i++) {
+        const char *tags;
+
+        tags = GetTagList(blt_table_get_row_tags(tablePtr, rows[i]), &ds);
+        strings[i] = Blt_AssertStrdup(tags);
+        lengths[i] = Tcl_DStringLength(&ds);
+    }
+    Tcl_DStringFree(&ds);
+    WriteSnapshotStrings(&writer, numRows, strings, lengths, 
+        &header.rowTags, &header.rowTagHeap);
+    AlignSnapshot(&writer);
+    for (i = 0; i < numRows; i++) {
+        Blt_Free((char *)strings[i]);
+    }
+    Blt_Free(strings);
+    Blt_Free(lengths);
+    Blt_Free(rows);
+
+    header.directory = writer.offset;
+    WriteSnapshot(&writer, directory, numColumns * sizeof(SnapshotColumn));
+    Blt_Free(directory);
+
+    if ((!writer.error) && (Tcl_Seek(writer.channel, 0, SEEK_SET) == 0)) {
+        writer.offset = 0;
+        WriteSnapshot(&writer, &header, sizeof(header));
+    } else {
+        writer.error = TRUE;
+    }
+    if (writer.error) {
+        Tcl_AppendResult(interp, "error writing \"", fileName, "\": ",
+                Tcl_PosixError(interp), (char *)NULL);
+        Tcl_Close(NULL, writer.channel);
+        goto error;
+    }
+    if (Tcl_Close(interp, writer.channel) != TCL_OK) {
+        goto error;
+    }
+    fileObjPtr = Tcl_NewStringObj(fileName, -1);
+    Tcl_IncrRefCount(fileObjPtr);
+    result = Tcl_FSRenameFile(tmpObjPtr, fileObjPtr);
+    Tcl_DecrRefCount(fileObjPtr);
+    if (result != TCL_OK) {
+        Tcl_AppendResult(interp, "can't rename \"", Tcl_GetString(tmpObjPtr),
+                "\" to \"", fileName, "\": ", Tcl_PosixError(interp), 
+                (char *)NULL);
+        goto error;
+    }
+    Tcl_DecrRefCount(tmpObjPtr);
+    return TCL_OK;
+ error:
+    Tcl_FSDeleteFile(tmpObjPtr);
+    Tcl_DecrRefCount(tmpObjPtr);
+    return TCL_ERROR;
+}
+
+static int
+IsSnapshotFile(const char *fileName)
+{
+    Tcl_Channel channel;
+    char magic[SNAPSHOT_MAGIC_LENGTH];
+    int numBytes;
+
+    channel = Tcl_OpenFileChannel(NULL, fileName, "r", 0);
+    if (channel == NULL) {
+        return FALSE;
+    }
+    Tcl_SetChannelOption(NULL, channel, "-translation", "binary");
+    numBytes = Tcl_Read(channel, magic, SNAPSHOT_MAGIC_LENGTH);
+    Tcl_Close(NULL, channel);
+    return ((numBytes == SNAPSHOT_MAGIC_LENGTH) &&
+            (memcmp(magic, SNAPSHOT_MAGIC, SNAPSHOT_MAGIC_LENGTH) == 0));
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * OpenSnapshot --
+ *
+ *      Maps the snapshot file into memory.  The mapping is private and
+ *      writable, so pages are copied when they are changed.  If memory
+ *      mapped files aren't available, the file is read into memory
+ *      instead.
+ *
+ * Results:
+ *      Returns the snapshot or NULL if the file can't be read.
+ *
+ *---------------------------------------------------------------------------
+ */
+static Snapshot *
+OpenSnapshot(Tcl_Interp *interp, const char *fileName)
+{
+    Snapshot *snapPtr;
+#ifdef HAVE_SYS_MMAN_H
+    Tcl_DString ds;
+    const char *path;
+    struct stat info;
+    void *base;
+    int fd;
+
+    path = Tcl_TranslateFileName(interp, fileName, &ds);
+    if (path == NULL) {
+        return NULL;
+    }
+    fd = open(path, O_RDONLY);
+    Tcl_DStringFree(&ds);
+    if ((fd < 0) || (fstat(fd, &info) < 0)) {
+        Tcl_AppendResult(interp, "can't open \"", fileName, "\": ", 
+                Tcl_PosixError(interp), (char *)NULL);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return NULL;
+    }
+    base = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, 
+                fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        Tcl_AppendResult(interp, "can't map \"", fileName, "\": ", 
+                Tcl_PosixError(interp), (char *)NULL);
+        return NULL;
+    }
+    snapPtr = Blt_AssertMalloc(sizeof(Snapshot));
+    snapPtr->base = base;
+    snapPtr->size = info.st_size;
+#else
+    Tcl_Channel channel;
+    Tcl_WideInt size;
+
+    channel = Tcl_OpenFileChannel(interp, fileName, "r", 0);
+    if (channel == NULL) {
+        return NULL;
+    }
+    Tcl_SetChannelOption(NULL, channel, "-translation", "binary");
+    size = Tcl_Seek(channel, 0, SEEK_END);
+    Tcl_Seek(channel, 0, SEEK_SET);
+    snapPtr = Blt_AssertMalloc(sizeof(Snapshot));
+    snapPtr->size = (size > 0) ? (size_t)size : 0;
+    snapPtr->base = Blt_AssertMalloc(snapPtr->size + 1);
+    if ((size < 0) || (Tcl_Read(channel, snapPtr->base, size) != size)) {
+        Tcl_AppendResult(interp, "error reading \"", fileName, "\": ", 
+                Tcl_PosixError(interp), (char *)NULL);
+        Tcl_Close(NULL, channel);
+        Blt_Free(snapPtr->base);
+        Blt_Free(snapPtr);
+        return NULL;
+    }
+    Tcl_Close(NULL, channel);
+#endif /* HAVE_SYS_MMAN_H */
+    return snapPtr;
+}
+
+static void
+CloseSnapshot(Snapshot *snapPtr)
+{
+#ifdef HAVE_SYS_MMAN_H
+    munmap(snapPtr->base, snapPtr->size);
+#else
+    Blt_Free(snapPtr->base);
+#endif /* HAVE_SYS_MMAN_H */
+    Blt_Free(snapPtr);
+}
+
+static void
+ReleaseSnapshots(TableObject *corePtr)
+{
+    Blt_ChainLink link;
+
+    if (corePtr->snapshots == NULL) {
+        return;
+    }
+    for (link = Blt_Chain_FirstLink(corePtr->snapshots); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        CloseSnapshot(Blt_Chain_GetValue(link));
+    }
+    Blt_Chain_Destroy(corePtr->snapshots);
+    corePtr->snapshots = NULL;
+}
+
+/* Indicates if the range of bytes lies within the snapshot. */
+static int
+InSnapshot(Snapshot *snapPtr, int64_t offset, int64_t length, int align)
+{
+    if ((offset < 0) || (length < 0) || ((offset & (align - 1)) != 0)) {
+        return FALSE;
+    }
+    return (((uint64_t)offset <= snapPtr->size) &&
+            ((uint64_t)length <= (snapPtr->size - offset)));
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * CheckSnapshotStrings --
+ *
+ *      Verifies that a string array lies within the snapshot and that its
+ *      offsets are in order and point to NUL terminated strings.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+CheckSnapshotStrings(Snapshot *snapPtr, int64_t numRows, int64_t data, 
+                     int64_t heap)
+{
+    int64_t *offsets;
+    int64_t i;
+
+    if ((!InSnapshot(snapPtr, data, (numRows + 1) * sizeof(int64_t), 8)) ||
+        (!InSnapshot(snapPtr, heap, 0, 1))) {
+        return FALSE;
+    }
+    offsets = (int64_t *)(snapPtr->base + data);
+    if ((offsets[0] != 0) || (!InSnapshot(snapPtr, heap, offsets[numRows], 1))) {
+        return FALSE;
+    }
+    for (i = 0; i < numRows; i++) {
+        if (offsets[i + 1] < offsets[i]) {
+            return FALSE;
+        }
+        if ((offsets[i + 1] > offsets[i]) && 
+            (snapPtr->base[heap + offsets[i + 1] - 1] != '\0')) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Returns the string for the row of a string array or NULL if empty. */
+static INLINE const char *
+GetSnapshotString(Snapshot *snapPtr, int64_t data, int64_t heap, int64_t i,
+                  int *lengthPtr)
+{
+    int64_t *offsets;
+
+    offsets = (int64_t *)(snapPtr->base + data);
+    if (offsets[i + 1] == offsets[i]) {
+        return NULL;
+    }
+    *lengthPtr = (int)(offsets[i + 1] - offsets[i] - 1);
+    return snapPtr->base + heap + offsets[i];
+}
+
+static int
+CheckSnapshot(Tcl_Interp *interp, const char *fileName, Snapshot *snapPtr)
+{
+    SnapshotHeader *headerPtr;
+    SnapshotColumn *directory;
+    const char *mesg;
+    int64_t i;
+
+    headerPtr = (SnapshotHeader *)snapPtr->base;
+    mesg = NULL;
+    if (snapPtr->size < sizeof(SnapshotHeader)) {
+        mesg = "file is too short";
+    } else if (headerPtr->version != SNAPSHOT_VERSION) {
+        mesg = "unknown version";
+    } else if (headerPtr->byteOrder != SNAPSHOT_BYTE_ORDER) {
+        mesg = "written with a different byte order";
+    } else if ((headerPtr->numRows < 0) || (headerPtr->numColumns < 0) ||
+               (headerPtr->capacity < headerPtr->numRows) ||
+               (headerPtr->numRows > INT_MAX) ||
+               (headerPtr->capacity > INT_MAX) ||
+               (headerPtr->numColumns > INT_MAX) ||
+               (!InSnapshot(snapPtr, headerPtr->directory, 
+                        headerPtr->numColumns * sizeof(SnapshotColumn), 8)) ||
+               (!CheckSnapshotStrings(snapPtr, headerPtr->numRows, 
+                        headerPtr->rowLabels, headerPtr->rowLabelHeap)) ||
+               (!CheckSnapshotStrings(snapPtr, headerPtr->numRows, 
+                        headerPtr->rowTags, headerPtr->rowTagHeap))) {
+        mesg = "bad header";
+    }
+    if (mesg == NULL) {
+        directory = (SnapshotColumn *)(snapPtr->base + headerPtr->directory);
+        for (i = 0; i < headerPtr->numColumns; i++) {
+            SnapshotColumn *entryPtr;
+            int64_t numWords;
+
+            entryPtr = directory + i;
+            numWords = PackedMapSize(headerPtr->capacity);
+            if ((blt_table_column_type_to_name(entryPtr->type) == NULL) ||
+                (!InSnapshot(snapPtr, entryPtr->label, 
+                             entryPtr->labelLength + 1, 1)) ||
+                (snapPtr->base[entryPtr->label + entryPtr->labelLength] 
+                 != '\0') ||
+                (!InSnapshot(snapPtr, entryPtr->tags, 
+                             entryPtr->tagsLength + 1, 1)) ||
+                (snapPtr->base[entryPtr->tags + entryPtr->tagsLength] 
+                 != '\0') ||
+                (!InSnapshot(snapPtr, entryPtr->validMap, 
+                             numWords * sizeof(unsigned int), 8))) {
+                mesg = "bad column entry";
+                break;
+            }
+            if (IsPackableType(entryPtr->type)) {
+                if (!InSnapshot(snapPtr, entryPtr->data, 
+                                headerPtr->capacity * sizeof(double), 8)) {
+                    mesg = "bad column data";
+                    break;
+                }
+            } else if (!CheckSnapshotStrings(snapPtr, headerPtr->numRows, 
+                        entryPtr->data, entryPtr->heap)) {
+                mesg = "bad column data";
+                break;
+            }
+        }
+    }
+    if (mesg != NULL) {
+        Tcl_AppendResult(interp, "bad snapshot \"", fileName, "\": ", mesg,
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static int
+SetTagsFromList(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
+                Column *colPtr, const char *list)
+{
+    const char **argv;
+    int i, argc;
+    int result;
+
+    if (list[0] == '\0') {
+        return TCL_OK;
+    }
+    if (Tcl_SplitList(interp, list, &argc, &argv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    result = TCL_OK;
+    for (i = 0; (i < argc) && (result == TCL_OK); i++) {
+        if (rowPtr != NULL) {
+            result = blt_table_set_row_tag(interp, tablePtr, rowPtr, argv[i]);
+        } else {
+            result = blt_table_set_column_tag(interp, tablePtr, colPtr, 
+                argv[i]);
+        }
+    }
+    Tcl_Free((char *)argv);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RestoreSnapshotColumn --
+ *
+ *      Restores the values of one column from the snapshot.  If the mapped
+ *      flag is set, a numeric column is packed and its chunks point
+ *      directly into the snapshot.  Otherwise each value is copied.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+RestoreSnapshotColumn(Tcl_Interp *interp, Table *tablePtr, 
+                      Snapshot *snapPtr, SnapshotColumn *entryPtr, 
+                      Column *colPtr, int64_t numRows, Row **rows, int mapped)
+{
+    unsigned int *validMap;
+    int64_t i;
+    long numSlots, numChunks;
+
+    validMap = (unsigned int *)(snapPtr->base + entryPtr->validMap);
+    FreeColumnStats(colPtr);
+    if (mapped) {
+        FreePackedColumn(colPtr);
+        if (colPtr->chunks != NULL) {
+            /* The table had no rows, so the column has no values. */
+            FreeChunks(colPtr->chunks, NumRowsAllocated(tablePtr));
+            colPtr->chunks = NULL;
+        }
+        /* Point each chunk and its bitmap at the snapshot's arrays. */
+        numSlots = NumRowsAllocated(tablePtr);
+        numChunks = NumChunks(numSlots);
+        colPtr->packed.d = Blt_AssertMalloc(MAX(numChunks, 1) * 
+                sizeof(double *));
+        colPtr->validMap = Blt_AssertMalloc(MAX(numChunks, 1) * 
+                sizeof(unsigned int *));
+        for (i = 0; i < numChunks; i++) {
+            colPtr->packed.d[i] = (double *)(snapPtr->base + entryPtr->data) +
+                (i << TABLE_CHUNK_SHIFT);
+            colPtr->validMap[i] = validMap + 
+                PackedMapSize(i << TABLE_CHUNK_SHIFT);
+        }
+        colPtr->numPacked = numSlots;
+        colPtr->flags |= (TABLE_COLUMN_PACKED | TABLE_COLUMN_MAPPED);
+        goto done;
+    }
+    for (i = 0; i < numRows; i++) {
+        Row *rowPtr;
+        Value *valuePtr;
+
+        if ((validMap[i >> 5] & (1U << (i & 31))) == 0) {
+            continue;
+        }
+        rowPtr = rows[i];
+        CopyOnWrite(colPtr, rowPtr);
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            memcpy(PackedSlot(colPtr, rowPtr->offset), 
+                   snapPtr->base + entryPtr->data + i * sizeof(double),
+                   sizeof(double));
+            PackedSetExists(colPtr, rowPtr->offset);
+            continue;
+        }
+        IndexRemoveValue(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+        if (IsPackableType(entryPtr->type)) {
+            ResetValue(valuePtr);
+            FormatPackedSlot(entryPtr->type, 
+                snapPtr->base + entryPtr->data + i * sizeof(double), 
+                valuePtr);
+        } else {
+            const char *string;
+            int length;
+
+            string = GetSnapshotString(snapPtr, entryPtr->data, 
+                entryPtr->heap, i, &length);
+            if ((string != NULL) && 
+                (SetValueFromString(interp, colPtr->type, string, length,
+                                    valuePtr) != TCL_OK)) {
+                return TCL_ERROR;
+            }
+        }
+        IndexAddValue(colPtr, rowPtr);
+        StatsAddValue(colPtr, rowPtr);
+    }
+ done:
+    /* No traces are called, so resync any vector bound to the column. */
+    if (colPtr->bindPtr != NULL) {
+        UpdateBinding(colPtr->bindPtr, NULL, TABLE_TRACE_WRITES);
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RestoreSnapshot --
+ *
+ *      Restores a binary snapshot written by blt_table_file_dump_binary.
+ *      If the table has no rows, numeric columns are packed and backed by
+ *      the pages of the mapped file, so restoring them costs no more than
+ *      mapping the file.  Other columns, and all columns when restoring
+ *      into a table that already has rows, are copied.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+RestoreSnapshot(Tcl_Interp *interp, Table *tablePtr, const char *fileName,
+                unsigned int flags)
+{
+    Snapshot *snapPtr;
+    SnapshotHeader *headerPtr;
+    SnapshotColumn *directory;
+    Rows *rowsPtr;
+    Row **rows;
+    int64_t i;
+    int isEmpty, numMapped, result;
+
+    snapPtr = OpenSnapshot(interp, fileName);
+    if (snapPtr == NULL) {
+        return TCL_ERROR;
+    }
+    if (CheckSnapshot(interp, fileName, snapPtr) != TCL_OK) {
+        CloseSnapshot(snapPtr);
+        return TCL_ERROR;
+    }
+    headerPtr = (SnapshotHeader *)snapPtr->base;
+    directory = (SnapshotColumn *)(snapPtr->base + headerPtr->directory);
+    rowsPtr = &tablePtr->corePtr->rows;
+    /* The snapshot's slots line up with row offsets only if the table has
+     * no rows and no free row offsets. */
+    isEmpty = ((rowsPtr->numUsed == 0) && 
+               (Blt_Chain_GetLength(rowsPtr->freeList) == 0));
+    rows = Blt_AssertMalloc((headerPtr->numRows + 1) * sizeof(Row *));
+    result = TCL_ERROR;
+    numMapped = 0;
+    if (isEmpty) {
+        if (blt_table_extend_rows(interp, tablePtr, headerPtr->numRows, rows)
+            != TCL_OK) {
+            goto done;
+        }
+    }
+    for (i = 0; i < headerPtr->numRows; i++) {
+        const char *label;
+        int length;
+
+        label = GetSnapshotString(snapPtr, headerPtr->rowLabels, 
+                headerPtr->rowLabelHeap, i, &length);
+        if (label == NULL) {
+            label = "";
+        }
+        if (isEmpty) {
+            if ((strcmp(rows[i]->label, label) != 0) &&
+                (blt_table_set_row_label(interp, tablePtr, rows[i], label) 
+                 != TCL_OK)) {
+                goto done;
+            }
+        } else {
+            rows[i] = NULL;
+            if (flags & TABLE_RESTORE_OVERWRITE) {
+                rows[i] = blt_table_get_row_by_label(tablePtr, label);
+            }
+            if (rows[i] == NULL) {
+                rows[i] = blt_table_create_row(interp, tablePtr, label);
+                if (rows[i] == NULL) {
+                    goto done;
+                }
+            }
+        }
+        if ((flags & TABLE_RESTORE_NO_TAGS) == 0) {
+            const char *tags;
+
+            tags = GetSnapshotString(snapPtr, headerPtr->rowTags, 
+                headerPtr->rowTagHeap, i, &length);
+            if ((tags != NULL) && 
+                (SetTagsFromList(interp, tablePtr, rows[i], NULL, tags) 
+                 != TCL_OK)) {
+                goto done;
+            }
+        }
+    }
+    for (i = 0; i < headerPtr->numColumns; i++) {
+        SnapshotColumn *entryPtr;
+        Column *colPtr;
+        const char *label;
+        int mapped;
+
+        entryPtr = directory + i;
+        label = snapPtr->base + entryPtr->label;
+        colPtr = NULL;
+        if (flags & TABLE_RESTORE_OVERWRITE) {
+            colPtr = blt_table_get_column_by_label(tablePtr, label);
+        }
+        if (colPtr == NULL) {
+            colPtr = blt_table_create_column(interp, tablePtr, label);
+            if (colPtr == NULL) {
+                goto done;
+            }
+        }
+        if (blt_table_set_column_type(interp, tablePtr, colPtr, 
+                entryPtr->type) != TCL_OK) {
+            goto done;
+        }
+        if (((flags & TABLE_RESTORE_NO_TAGS) == 0) &&
+            (SetTagsFromList(interp, tablePtr, NULL, colPtr, 
+                snapPtr->base + entryPtr->tags) != TCL_OK)) {
+            goto done;
+        }
+        mapped = ((isEmpty) && (headerPtr->numRows > 0) &&
+                  (IsPackableType(entryPtr->type)) &&
+                  (colPtr->indexPtr == NULL) &&
+                  (NumRowsAllocated(tablePtr) <= headerPtr->capacity));
+        if (RestoreSnapshotColumn(interp, tablePtr, snapPtr, entryPtr, colPtr,
+                headerPtr->numRows, rows, mapped) != TCL_OK) {
+            goto done;
+        }
+        if (mapped) {
+            numMapped++;
+        }
+    }
+    result = TCL_OK;
+ done:
+    Blt_Free(rows);
+    if (numMapped > 0) {
+        TableObject *corePtr;
+
+        /* Packed columns point into the snapshot. Keep it until the
+         * table is destroyed. */
+        corePtr = tablePtr->corePtr;
+        if (corePtr->snapshots == NULL) {
+            corePtr->snapshots = Blt_Chain_Create();
+        }
+        Blt_Chain_Append(corePtr->snapshots, snapPtr);
+    } else {
+        CloseSnapshot(snapPtr);
+    }
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_restore --
+ *
+ *      Restores data to the given table based upon the dump string.
+ *      The dump string should have been generated by blt_table_dump.
+ *      Two bit flags may be set.
+ *      
+ *      TABLE_RESTORE_NO_TAGS   Don't restore tag information.
+ *      TABLE_RESTORE_OVERWRITE Look for row and columns with the 
+ *                              same label. Overwrite if necessary.
+ *
+ * Results:
+ *      A standard TCL result.  If the restore was successful, TCL_OK
+ *      is returned.  Otherwise, TCL_ERROR is returned and an error
+ *      message is left in the interpreter result.
+ *
+ * Side Effects:
+ *      New row and columns are created in the table and may possibly
+ *      generate event notifier or trace callbacks.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_restore(Tcl_Interp *interp, BLT_TABLE table, char *data, 
+                      unsigned int flags)
+{
+    RestoreData restore;
+    int result;
+
+    if (IsReadOnly(interp, table)) {
+        return TCL_ERROR;
+    }
+    restore.argc = 0;
+    restore.mtime = restore.ctime = 0L;
+    restore.argv = NULL;
+    restore.fileName = "data string";
+    restore.numLines = 0;
+    restore.flags = flags;
+    restore.numCols = blt_table_num_columns(table);
+    restore.numRows = blt_table_num_rows(table);
+    Blt_InitHashTableWithPool(&restore.rowIndices, BLT_ONE_WORD_KEYS);
+    Blt_InitHashTableWithPool(&restore.colIndices, BLT_ONE_WORD_KEYS);
+    /* Read dump information */
+    result = TCL_ERROR;
+    for (;;) {
+        char c1, c2;
+
+        result = ParseDumpRecord(interp, &data, &restore);
+        if (result != TCL_OK) {
+            break;
+        }
+        if (restore.argc == 0) {
+            continue;
+        }
+        c1 = restore.argv[0][0], c2 = restore.argv[0][1];
+        if ((c1 == 'i') && (c2 == '\0')) {
+            result = RestoreHeader(interp, table, &restore);
+        } else if ((c1 == 'r') && (c2 == '\0')) {
+            result = RestoreRow(interp, table, &restore);
+        } else if ((c1 == 'c') && (c2 == '\0')) {
+            result = RestoreColumn(interp, table, &restore);
+        } else if ((c1 == 'd') && (c2 == '\0')) {
+            result = RestoreValue(interp, table, &restore);
+        } else {
+            Tcl_AppendResult(interp, restore.fileName, ":", 
+                Blt_Ltoa(restore.numLines), ": error: unknown entry \"", 
+                restore.argv[0], "\"", (char *)NULL);
+            result = TCL_ERROR;
+        }
+        Tcl_Free((char *)restore.argv);
+        if (result != TCL_OK) {
+            break;
+        }
+    }
+    Blt_DeleteHashTable(&restore.rowIndices);
+    Blt_DeleteHashTable(&restore.colIndices);
+    if (result == TCL_ERROR) {
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_file_restore --
+ *
+ *      Restores data to the given table based upon the dump file
+ *      provided. The dump file should have been generated by
+ *      blt_table_dump or blt_table_file_dump.  Binary snapshots written
+ *      by blt_table_file_dump_binary are recognized by their header.
+ *
+ *      If the filename starts with an '@', then it is the name of an
+ *      already opened channel to be used. Two bit flags may be set.
+ *      
+ *      TABLE_RESTORE_NO_TAGS   Don't restore tag information.
+ *      TABLE_RESTORE_OVERWRITE Look for row and columns with 
+ *                              the same label. Overwrite if necessary.
+ *
+ * Results:
+ *      A standard TCL result.  If the restore was successful, TCL_OK
+ *      is returned.  Otherwise, TCL_ERROR is returned and an error
+ *      message is left in the interpreter result.
+ *
+ * Side Effects:
+ *      Row and columns are created in the table and may possibly
+ *      generate trace or notifier event callbacks.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_file_restore(Tcl_Interp *interp, BLT_TABLE table, 
+                       const char *fileName, unsigned int flags)
+{
+    RestoreData restore;
+    Tcl_Channel channel;
+    int closeChannel;
+    int result;
+
+    closeChannel = TRUE;
+    if (((fileName[0] != '@') || (fileName[1] == '\0')) &&
+        (IsSnapshotFile(fileName))) {
+        return RestoreSnapshot(interp, table, fileName, flags);
+    }
+    if ((fileName[0] == '@') && (fileName[1] != '\0')) {
+        int mode;
+        
+        channel = Tcl_GetChannel(interp, fileName+1, &mode);
+        if (channel == NULL) {
+            return TCL_ERROR;
+        }
+        if ((mode & TCL_READABLE) == 0) {
+            Tcl_AppendResult(interp, "channel \"", fileName, 
+                "\" not opened for reading", (char *)NULL);
+            return TCL_ERROR;
+        }
+        closeChannel = FALSE;
+    } else {
+        channel = Tcl_OpenFileChannel(interp, fileName, "r", 0);
+        if (channel == NULL) {
+            return TCL_ERROR;   /* Can't open dump file. */
+        }
+    }
+    restore.argc = 0;
+    restore.mtime = restore.ctime = 0L;
+    restore.argv = NULL;
+    restore.fileName = fileName;
+    restore.numLines = 0;
+    restore.flags = flags;
+    restore.numCols = blt_table_num_columns(table);
+    restore.numRows = blt_table_num_rows(table);
+    Blt_InitHashTableWithPool(&restore.rowIndices, BLT_ONE_WORD_KEYS);
+    Blt_InitHashTableWithPool(&restore.colIndices, BLT_ONE_WORD_KEYS);
+
+    result = TCL_ERROR;
+    /* Process dump information record by record. */
+    for (;;) {
+        char c1, c2;
+
+        result = ReadDumpRecord(interp, channel, &restore);
+        if (result != TCL_OK) {
+            break;
+        }
+        if (restore.argc == 0) {
+            continue;
+        }
+        c1 = restore.argv[0][0], c2 = restore.argv[0][1];
+        if ((c1 == 'i') && (c2 == '\0')) {
+            result = RestoreHeader(interp, table, &restore);
+        } else if ((c1 == 'r') && (c2 == '\0')) {
+            result = RestoreRow(interp, table, &restore);
+        } else if ((c1 == 'c') && (c2 == '\0')) {
+            result = RestoreColumn(interp, table, &restore);
+        } else if ((c1 == 'd') && (c2 == '\0')) {
+            result = RestoreValue(interp, table, &restore);
+        } else {
+            Tcl_AppendResult(interp, fileName, ":", Blt_Ltoa(restore.numLines), 
+                ": error: unknown entry \"", restore.argv[0], "\"", 
+                (char *)NULL);
+            result = TCL_ERROR;
+        }
+        if (result != TCL_OK) {
+            Tcl_Free((char *)restore.argv); /* Allocated by Tcl_SplitList */
+            break;
+        }
+        Tcl_Free((char *)restore.argv); /* Allocated by Tcl_SplitList */
+    }
+    Blt_DeleteHashTable(&restore.rowIndices);
+    Blt_DeleteHashTable(&restore.colIndices);
+    if (closeChannel) {
+        Tcl_Close(interp, channel);
+    }
+    if (result == TCL_ERROR) {
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static void
+FreePrimaryKeys(Table *tablePtr)
+{
+    int i;
+    
+    for (i = 0; i < tablePtr->numKeys; i++) {
+        Column *colPtr;
+        
+        colPtr = tablePtr->primaryKeys[i];
+        colPtr->flags &= ~TABLE_COLUMN_PRIMARY_KEY;
+    }
+    Blt_Free(tablePtr->primaryKeys);
+    tablePtr->primaryKeys = NULL;
+    tablePtr->numKeys = 0;
+}
+
+static void
+FreeKeyTables(Table *tablePtr)
+{
+    if (tablePtr->keyTables != NULL) {
+        int i;
+
+        for (i = 0; i < tablePtr->numKeys; i++) {
+            Blt_DeleteHashTable(tablePtr->keyTables + i);
+        }
+        Blt_Free(tablePtr->keyTables);
+        tablePtr->keyTables = NULL;
+    }
+    if (tablePtr->masterKey != NULL) {
+        Blt_Free(tablePtr->masterKey);
+        Blt_DeleteHashTable(&tablePtr->masterKeyTable);
+        tablePtr->masterKey = NULL;
+    }
+}
+
+void
+blt_table_unset_keys(Table *tablePtr)
+{
+    FreeKeyTables(tablePtr);
+    FreePrimaryKeys(tablePtr);
+    tablePtr->flags &= ~(TABLE_KEYS_DIRTY | TABLE_KEYS_UNIQUE);
+}
+
+int
+blt_table_get_keys(Table *tablePtr, BLT_TABLE_COLUMN **keysPtr)
+{
+    *keysPtr = tablePtr->primaryKeys;
+    return tablePtr->numKeys;
+}
+
+static int
+SameKeys(int len1, BLT_TABLE_COLUMN *keys1, int len2, BLT_TABLE_COLUMN *keys2)
+{
+    int i;
+    
+    if (len1 != len2) {
+        return FALSE;
+    }
+    for (i = 0; i < len1; i++) {
+        if (keys1[i] != keys2[i]) {
+            fprintf(stderr, "different keys\n");
+            return FALSE;
+        }
+    } 
+    return TRUE;
+}
+
+int
+blt_table_set_keys(Table *tablePtr, int numKeys, BLT_TABLE_COLUMN *keys,
+                   int unique)
+{
+    int i;
+    
+    if (SameKeys(tablePtr->numKeys, tablePtr->primaryKeys, numKeys, keys)) {
+        return TCL_OK;
+    }
+    if (tablePtr->primaryKeys != NULL) {
+        FreePrimaryKeys(tablePtr);
+    }
+    tablePtr->primaryKeys = keys;
+    tablePtr->numKeys = numKeys;
+    
+    /* Mark the designated columns as primary keys.  This flag is used to
+     * check if a primary column is deleted, it's rows are added or
+     * changed, or it's values set or unset.  The generated keytables are
+     * invalid and need to be regenerated. */
+    for (i = 0; i < numKeys; i++) {
+        Column *colPtr;
+        
+        colPtr = keys[i];
+        colPtr->flags |= TABLE_COLUMN_PRIMARY_KEY;
+    }
+    tablePtr->flags |= TABLE_KEYS_DIRTY;
+    if (unique) {
+        tablePtr->flags |= TABLE_KEYS_UNIQUE;
+    }
+    return TCL_OK;
+}
+
+static int
+MakeKeyTables(Tcl_Interp *interp, Table *tablePtr)
+{
+    Row *rowPtr;
+    int i;
+    size_t masterKeySize;
+
+    FreeKeyTables(tablePtr);
+    tablePtr->flags &= ~TABLE_KEYS_DIRTY;
+
+    /* Create a hashtable for each key. */
+    tablePtr->keyTables =
+        Blt_Malloc(sizeof(Blt_HashTable) * tablePtr->numKeys);
+    if (tablePtr->keyTables == NULL) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't allocated keytables for ",
+                Blt_Itoa(tablePtr->numKeys), " keys.", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    for (i = 0; i < tablePtr->numKeys; i++) {
+        size_t size;
+        Column *colPtr;
+
+        colPtr = tablePtr->primaryKeys[i];
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_DOUBLE:
+        case TABLE_COLUMN_TYPE_TIME:
+            size = sizeof(double)/sizeof(int);
+            break;
+        case TABLE_COLUMN_TYPE_BOOLEAN:
+        case TABLE_COLUMN_TYPE_LONG:
+            size = BLT_ONE_WORD_KEYS;
+            break;
+        default:
+        case TABLE_COLUMN_TYPE_STRING:
+            size = BLT_STRING_KEYS;
+            break;
+        }
+        Blt_InitHashTable(tablePtr->keyTables + i, size);
+    }
+    /* Generate a master table of key tuple combinations for each row.  
+     * We uniquely identify the key by its row in the column. The combination
+     * of these keys (in the exact order) is how we find the row. */
+    masterKeySize = sizeof(BLT_TABLE_ROW) * tablePtr->numKeys;
+    tablePtr->masterKey = Blt_AssertMalloc(masterKeySize);
+    Blt_InitHashTable(&tablePtr->masterKeyTable, masterKeySize / sizeof(int));
+
+    /* For each row, create hash entries for the individual key columns,
+     * but also for the combined keys for the row.  The hash of the
+     * combined keys must be unique. */
+    for (rowPtr = (Row *)tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
+         rowPtr = rowPtr->nextPtr) {
+        int j;
+
+        for (j = 0; j < tablePtr->numKeys; j++) {
+            Blt_HashTable *keyTablePtr;
+            Column *colPtr;
+            int isNew;
+            Blt_HashEntry *hPtr;
+            Value *valuePtr;
+            Value packed;
+            
+            colPtr = tablePtr->primaryKeys[j];
+            if (IsEmpty(rowPtr, colPtr)) {
+                break;                  /* Skip this row since one of the
+                                         * key values is empty. */
+            }
+            keyTablePtr = tablePtr->keyTables + j;
+            if (colPtr->flags & TABLE_COLUMN_PACKED) {
+                FormatPackedValue(colPtr, rowPtr->offset, &packed);
+                valuePtr = &packed;
+            } else {
+                valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+            }
+            switch (colPtr->type) {
+            case TABLE_COLUMN_TYPE_DOUBLE:
+            case TABLE_COLUMN_TYPE_TIME:
+                hPtr = Blt_CreateHashEntry(keyTablePtr, &valuePtr->datum.d,
+                                           &isNew);
+                break;
+            case TABLE_COLUMN_TYPE_BOOLEAN:
+            case TABLE_COLUMN_TYPE_LONG:
+                hPtr = Blt_CreateHashEntry(keyTablePtr,
+                                           (intptr_t)valuePtr->datum.l, &isNew);
+                break;
+            case TABLE_COLUMN_TYPE_STRING:
+            default:
+                hPtr = Blt_CreateHashEntry(keyTablePtr,
+                                           GetValueString(valuePtr), &isNew);
+                break;
+            }
+            if (valuePtr == &packed) {
+                ResetValue(&packed);
+            }
+            if (isNew) {
+                Blt_SetHashValue(hPtr, rowPtr);
+            }
+            tablePtr->masterKey[j] = Blt_GetHashValue(hPtr);
+        }
+        if (j == tablePtr->numKeys) {
+            Blt_HashEntry *hPtr;
+            int isNew;
 
-/*
- *---------------------------------------------------------------------------
- *
- * blt_table_set_row_label --
- *
- *      Returns the label of the row.  If the row offset is invalid or the row
- *      has no label, then NULL is returned.
- *
- * Results:
- *      Returns the label of the row.
- *
- *---------------------------------------------------------------------------
- */
-int
-blt_table_set_row_label(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
-                        const char *label)
-{
-    BLT_TABLE_NOTIFY_EVENT event;
+            /* If we created all the hashkeys necessary for this row, then
+             * generate an entry for the row in the master key table. */
+            hPtr = Blt_CreateHashEntry(&tablePtr->masterKeyTable, 
+                tablePtr->masterKey, &isNew);
+            if (isNew) {
+                Blt_SetHashValue(hPtr, rowPtr);
+            } else if (tablePtr->flags & TABLE_KEYS_UNIQUE) {
+                if (interp != NULL) {
+                    BLT_TABLE_ROW dupRow;
         
-    InitNotifyEvent(tablePtr, &event);
-    event.type = TABLE_NOTIFY_RELABEL;
-    event.row = rowPtr;
-    SetRowLabel(&tablePtr->corePtr->rows, rowPtr, label);
-    NotifyClients(tablePtr, &event);
+                    dupRow = Blt_GetHashValue(hPtr);
+                    Tcl_AppendResult(interp, "primary keys are not unique:",
+                        "rows \"", blt_table_row_label(dupRow), "\" and \"",
+                        blt_table_row_label(rowPtr), 
+                        "\" have the same keys.", (char *)NULL);
+                }
+                blt_table_unset_keys(tablePtr);
+                return TCL_ERROR;       /* Bail out. Keys aren't unique. */
+            }
+        }
+    }
+    tablePtr->flags &= ~TABLE_KEYS_UNIQUE;
     return TCL_OK;
 }
-
+            
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_column_label --
+ * blt_table_key_lookup --
  *
- *      Sets the label of the column.  If the column offset is invalid, then
- *      no label is set.
+ *      Look up the (hopefully) unique row that matches all the values
+ *      for each of the key columns.  
  *
  * Results:
- *      None.
+ *      Returns a standard TCL result.  *rowPtrPtr will return the 
+ *      pointer to the found row.  NULL is the row wasn't found.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_set_column_label(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
-                           const char *label)
+blt_table_key_lookup(Tcl_Interp *interp, Table *tablePtr, int objc, 
+                     Tcl_Obj *const *objv, Row **rowPtrPtr)
 {
-    BLT_TABLE_NOTIFY_EVENT event;
+    int i;
+    Blt_HashEntry *hPtr;
+    
+    *rowPtrPtr = NULL;
+    if (objc != tablePtr->numKeys) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "wrong # of values: should be ",
+                Blt_Itoa(tablePtr->numKeys), " value(s) of ", (char *)NULL);
+            for (i = 0; i < tablePtr->numKeys; i++) {
+                BLT_TABLE_COLUMN col;
 
-    InitNotifyEvent(tablePtr, &event);
-    event.type = TABLE_NOTIFY_COLUMNS_RELABEL;
-    event.column = colPtr;
-    SetColumnLabel(&tablePtr->corePtr->columns, colPtr, label);
-    NotifyClients(tablePtr, &event);
+                col = tablePtr->primaryKeys[i];
+                Tcl_AppendResult(interp, blt_table_column_label(col), " ", 
+                                 (char *)NULL);
+            }
+        }
+        return TCL_ERROR;               /* Wrong # of keys supplied. */
+    }
+    if (tablePtr->numKeys == 0) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "no primary keys designated",
+                         (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (tablePtr->flags & TABLE_KEYS_DIRTY) {
+        if (MakeKeyTables(interp, tablePtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    /* Create a master search key by getting the rows from the individual
+     * key hash tables for each key.  Use this key to search the master
+     * table. */
+    for (i = 0; i < tablePtr->numKeys; i++) {
+        Blt_HashTable *keyTablePtr;
+        Column *colPtr;
+        Blt_HashEntry *hPtr;
+
+        colPtr = tablePtr->primaryKeys[i];
+        keyTablePtr = tablePtr->keyTables + i;
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_DOUBLE:
+        case TABLE_COLUMN_TYPE_TIME:
+            {
+                double dval;
+
+                if (Blt_GetDoubleFromObj(interp, objv[i], &dval) != TCL_OK) {
+                    return TCL_ERROR;
+                }
+                hPtr = Blt_FindHashEntry(keyTablePtr, &dval);
+            }
+            break;
+        case TABLE_COLUMN_TYPE_BOOLEAN:
+            {
+                int ival;
+                
+                if (Tcl_GetBooleanFromObj(interp, objv[i], &ival) != TCL_OK) {
+                    return TCL_ERROR;
+                }
+                hPtr = Blt_FindHashEntry(keyTablePtr, (intptr_t)ival);
+            }
+            break;
+        case TABLE_COLUMN_TYPE_LONG:
+            {
+                long lval;
+
+                if (Blt_GetLongFromObj(interp, objv[i], &lval) != TCL_OK) {
+                    return TCL_ERROR;
+                }
+                hPtr = Blt_FindHashEntry(keyTablePtr, (intptr_t)lval);
+            }
+            break;
+        default:
+        case TABLE_COLUMN_TYPE_STRING:
+            {
+                const char *string;
+
+                string = Tcl_GetString(objv[i]);
+                hPtr = Blt_FindHashEntry(keyTablePtr, string);
+            }
+            break;
+        }
+        if (hPtr == NULL) {
+            return TCL_OK;              /* Can't find one of the keys, so
+                                         * the whole search fails. */
+        }
+        tablePtr->masterKey[i] = Blt_GetHashValue(hPtr);
+    }
+    hPtr = Blt_FindHashEntry(&tablePtr->masterKeyTable, tablePtr->masterKey);
+    if (hPtr == NULL) {
+        Blt_Warn("can't find master key\n");
+        return TCL_OK;
+    }
+    *rowPtrPtr = Blt_GetHashValue(hPtr);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_column_type --
+ * blt_table_set_long --
  *
- *      Sets the type of the given column.  
+ *      Sets the double value of the selected row, column location in the
+ *      table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  The column type must be "integer" or
+ *      "string", otherwise an error is returned.
  *
  * Results:
- *      None.
+ *      Returns a standard TCL result.
+ *
+ * Side Effects:
+ *      New tuples may be allocated created.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_set_column_type(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
-                          BLT_TABLE_COLUMN_TYPE type)
+blt_table_set_long(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                   Column *colPtr, long value)
 {
-    if (type == colPtr->type) {
-        return TCL_OK;                  /* Already the requested type. */
+    Value *valuePtr;
+    char string[200];
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
     }
-    return SetColumnType(interp, tablePtr, colPtr, type);
+    if ((colPtr->type != TABLE_COLUMN_TYPE_LONG) &&
+        (colPtr->type != TABLE_COLUMN_TYPE_STRING)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "wrong column type \"",
+                             blt_table_column_type_to_name(colPtr->type), 
+                             "\": should be \"integer\"", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        CopyOnWrite(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        PackedInt64(colPtr, rowPtr->offset) = value;
+        PackedSetExists(colPtr, rowPtr->offset);
+        StatsAddValue(colPtr, rowPtr);
+        goto done;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        sprintf(string, "%ld", value);
+        SetEncodedString(colPtr, rowPtr, string, -1);
+        goto done;
+    }
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    ResetValue(valuePtr);
+    valuePtr->datum.l = value;
+    valuePtr->length = sprintf(string, "%ld", value);
+    if (strlen(string) >= TABLE_VALUE_LENGTH) {
+        valuePtr->string = Blt_AssertStrdup(string);
+    } else {
+        strcpy(valuePtr->store, string);
+        valuePtr->string = TABLE_VALUE_STORE;
+    }
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+ done:
+    /* Indicate the keytables need to be regenerated. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    }
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_value_exists --
+ * blt_table_set_boolean --
  *
- *      Indicates if a value exists for a given row,column offset in the
- *      tuple.  Note that this routine does not fire read traces.
+ *      Sets the double value of the selected row, column location in the
+ *      table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  The column type must be "boolean" or
+ *      "string", otherwise an error is returned.
  *
  * Results:
- *      Returns 1 is a value exists, 0 otherwise.
+ *      Returns a standard TCL result.
+ *
+ * Side Effects:
+ *      New tuples may be allocated created.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_value_exists(Table *tablePtr, Row *rowPtr, Column *colPtr)
+blt_table_set_boolean(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                      Column *colPtr, int value)
 {
-    if ((colPtr == NULL) || (rowPtr == NULL)) {
-        return 0;
+    Value *valuePtr;
+    char string[200];
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    if ((colPtr->type != TABLE_COLUMN_TYPE_BOOLEAN) &&
+        (colPtr->type != TABLE_COLUMN_TYPE_STRING)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "wrong column type \"",
+                             blt_table_column_type_to_name(colPtr->type), 
+                             "\": should be \"boolean\"", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        sprintf(string, "%d", value);
+        SetEncodedString(colPtr, rowPtr, string, -1);
+        goto done;
+    }
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    ResetValue(valuePtr);
+    valuePtr->datum.l = (long)value;
+    valuePtr->length = sprintf(string, "%d", value);
+    if (strlen(string) >= TABLE_VALUE_LENGTH) {
+        valuePtr->string = Blt_AssertStrdup(string);
+    } else {
+        strcpy(valuePtr->store, string);
+        valuePtr->string = TABLE_VALUE_STORE;
+    }
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+ done:
+    /* Indicate the keytables need to be regenerated. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
     }
-    return !IsEmpty(rowPtr, colPtr);
+    return TCL_OK;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_extend_rows --
+ * blt_table_set_int64 --
  *
- *      Adds new rows to the table.  Rows are slots in an array of Rows.  The
- *      array grows by doubling its size, so there may be more slots than
- *      needed (# rows).
+ *      Sets the int64_t value of the selected row, column location in the
+ *      table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  The column type must be "integer" or
+ *      "string", otherwise an error is returned.
  *
  * Results:
- *      Returns TCL_OK is the tuple is resized and TCL_ERROR if an not enough
- *      memory was available.
+ *      Returns a standard TCL result.
  *
  * Side Effects:
- *      If more rows are needed, the array which holds the tuples is
- *      reallocated by doubling its size.
+ *      New tuples may be allocated created.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_extend_rows(Tcl_Interp *interp, Table *tablePtr, size_t numExtra, 
-                      Row **rows)
+blt_table_set_int64(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                   Column *colPtr, int64_t value)
 {
-    long i;
-    Blt_Chain chain;
-    Blt_ChainLink link;
+    Value *valuePtr;
+    char string[200];
 
-    if (numExtra == 0) {
-        return TCL_OK;
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
     }
-    chain = Blt_Chain_Create();
-    if (!ExtendRows(tablePtr, numExtra, chain)) {
+    if ((colPtr->type != TABLE_COLUMN_TYPE_INT64) &&
+        (colPtr->type != TABLE_COLUMN_TYPE_STRING)) {
         if (interp != NULL) {
-            Tcl_AppendResult(interp, "can't extend table by ", 
-                Blt_Ltoa(numExtra), " rows: out of memory.", (char *)NULL);
+            Tcl_AppendResult(interp, "wrong column type \"",
+                             blt_table_column_type_to_name(colPtr->type), 
+                             "\": should be \"int64\"", (char *)NULL);
         }
-        Blt_Chain_Destroy(chain);
         return TCL_ERROR;
     }
-    /* For each new row generate a notify event. */
-    for (i = 0, link = Blt_Chain_FirstLink(chain); link != NULL; 
-         link = Blt_Chain_NextLink(link), i++) {
-        Row *rowPtr;
-
-        rowPtr = Blt_Chain_GetValue(link);
-        if (rows != NULL) {
-            rows[i] = rowPtr;
-        }
-        NotifyRowChanged(tablePtr, rowPtr, TABLE_NOTIFY_ROWS_CREATED);
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        CopyOnWrite(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        PackedInt64(colPtr, rowPtr->offset) = value;
+        PackedSetExists(colPtr, rowPtr->offset);
+        StatsAddValue(colPtr, rowPtr);
+        goto done;
     }
-    assert(Blt_Chain_GetLength(chain) > 0);
-    Blt_Chain_Destroy(chain);
-    return TCL_OK;
-}
-
-int
-blt_table_delete_row(Table *tablePtr, Row *rowPtr)
-{
-    NotifyRowChanged(tablePtr, rowPtr, TABLE_NOTIFY_ROWS_DELETED);
-    UnsetRowValues(tablePtr, rowPtr);
-    Blt_Tags_ClearTagsFromItem(tablePtr->rowTags, rowPtr);
-    blt_table_clear_row_traces(tablePtr, rowPtr);
-    ClearRowNotifiers(tablePtr, rowPtr);
-    tablePtr->flags |= TABLE_KEYS_DIRTY;
-    DeleteRow(&tablePtr->corePtr->rows, rowPtr);
-    return TCL_OK;
-}
-
-BLT_TABLE_ROW
-blt_table_create_row(Tcl_Interp *interp, BLT_TABLE table, const char *label)
-{
-    Row *rowPtr;
-
-    rowPtr = NULL;                      /* Suppress compiler warning. */
-    if (blt_table_extend_rows(interp, table, 1, &rowPtr) != TCL_OK) {
-        return NULL;
+    if (colPtr->encodingPtr != NULL) {
+        sprintf(string, "%" PRId64, value);
+        SetEncodedString(colPtr, rowPtr, string, -1);
+        goto done;
     }
-    if (label != NULL) {
-        if (blt_table_set_row_label(interp, table, rowPtr, label) != TCL_OK) {
-            blt_table_delete_row(table, rowPtr);
-            return NULL;
-        }
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    ResetValue(valuePtr);
+    valuePtr->datum.i64 = value;
+    valuePtr->length = sprintf(string, "%" PRId64, value);
+    if (strlen(string) >= TABLE_VALUE_LENGTH) {
+        valuePtr->string = Blt_AssertStrdup(string);
+    } else {
+        strcpy(valuePtr->store, string);
+        valuePtr->string = TABLE_VALUE_STORE;
     }
-    return rowPtr;
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+ done:
+    /* Indicate the keytables need to be regenerated. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    }
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_move_rows --
+ * blt_table_set_string_rep --
  *
- *      Move one of more rows to a new location in the tuple.
+ *      Sets the value of the selected row, column location in the table.
+ *      The row, column location must be within the actual table limits.
+ *
+ * Results:
+ *      Returns a standard TCL result.
+ *
+ * Side Effects:
+ *      New tuples may be allocated created.
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 int
-blt_table_move_rows(Tcl_Interp *interp, Table *tablePtr, Row *destPtr, 
-                   Row *firstPtr, Row *lastPtr, int after)
+blt_table_set_string_rep(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                         Column *colPtr, const char *string, int length)
 {
-    Rows *rowsPtr;
+    Value *valuePtr;
 
-    rowsPtr = &tablePtr->corePtr->rows;
-    if (!MoveRows(rowsPtr, destPtr, firstPtr, lastPtr, after)) {
-        Tcl_AppendResult(interp, "can't allocate new map for \"", 
-                blt_table_name(tablePtr), "\"", (char *)NULL);
+    if (IsReadOnly(interp, tablePtr)) {
         return TCL_ERROR;
     }
-    NotifyRowChanged(tablePtr, NULL, TABLE_NOTIFY_ROWS_MOVED);
-    return TCL_OK;
-}
-
-void
-blt_table_set_row_map(Table *tablePtr, Row **map)
-{
-    ReplaceRowMap(&tablePtr->corePtr->rows, map);
-    NotifyRowChanged(tablePtr, NULL, TABLE_NOTIFY_ROWS_MOVED);
-}
-
-void
-blt_table_sort_init(Table *tablePtr, BLT_TABLE_SORT_ORDER *order, 
-                    long numColumns, unsigned int flags)
-{
-    size_t i;
-
-    sortData.table = tablePtr;
-    sortData.order = order;
-    sortData.numColumns = numColumns;
-    sortData.flags = flags;
-    for (i = 0; i < numColumns; i++) {
-        BLT_TABLE_SORT_ORDER *sortPtr;
-
-        sortPtr = order + i;
-        sortPtr->clientData = tablePtr;
-        sortPtr->cmpProc = blt_table_get_compare_proc(tablePtr, 
-                sortPtr->column, flags);
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        if (SetPackedFromString(interp, colPtr, rowPtr, string, length) 
+            != TCL_OK) {
+            return TCL_ERROR;
+        }
+        goto done;
     }
+    if (colPtr->encodingPtr != NULL) {
+        SetEncodedString(colPtr, rowPtr, string, length);
+        goto done;
+    }
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    ResetValue(valuePtr);
+    if (SetValueFromString(interp, colPtr->type, string, length, valuePtr)
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+ done:
+    /* Indicate the keytables need to be regenerated. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    }
+    /* No traces are called, but a bound vector must see the new value. */
+    if (colPtr->bindPtr != NULL) {
+        UpdateBinding(colPtr->bindPtr, rowPtr, TABLE_TRACE_WRITES);
+    }
+    return TCL_OK;
 }
 
-void
-blt_table_sort_finish()
-{
-}
-
-BLT_TABLE_ROW *
-blt_table_sort_rows(Table *tablePtr)
-{
-    return SortRows(&tablePtr->corePtr->rows, (QSortCompareProc *)CompareRows);
-}
-
-
-
-void
-blt_table_sort_row_map(Table *tablePtr, long numRows, BLT_TABLE_ROW *rows)
-{
-    /* Sort the map and return it. */
-    qsort((char *)rows, numRows, sizeof(BLT_TABLE_ROW), 
-          (QSortCompareProc *)CompareRows);
-}
-
-int
-blt_table_get_column_limits(Tcl_Interp *interp, Table *tablePtr, Column *colPtr,
-                          Tcl_Obj **minObjPtrPtr, Tcl_Obj **maxObjPtrPtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ScanNumber --
+ *
+ *      Converts the string to the column's numeric type without creating
+ *      a TCL object.  The string doesn't need to be NUL terminated.
+ *
+ * Results:
+ *      Returns TRUE if the string was converted.  FALSE is returned if the
+ *      column isn't numeric or the string isn't a valid number.  The
+ *      caller falls back to the normal conversion, which generates the
+ *      error message.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ScanNumber(BLT_TABLE_COLUMN_TYPE type, const char *s, int length, 
+           double *dPtr, int64_t *i64Ptr)
 {
-    Row *rowPtr, *minRowPtr, *maxRowPtr;
+    char buffer[64];
+    long l;
 
-    if (blt_table_num_rows(tablePtr) == 0) {
-        return TCL_OK;
+    if ((length <= 0) || ((size_t)length >= sizeof(buffer))) {
+        return FALSE;
     }
-    rowPtr = blt_table_first_row(tablePtr);
-    maxRowPtr = minRowPtr = rowPtr;
-    sortData.table = tablePtr;
-    for (/*empty*/; rowPtr != NULL; rowPtr = rowPtr->nextPtr) {
-        BLT_TABLE_COMPARE_PROC *proc;
-
-        proc = blt_table_get_compare_proc(tablePtr, colPtr, 0);
-        if ((*proc)(NULL, colPtr, rowPtr, minRowPtr) < 0) {
-                minRowPtr = rowPtr;
-        }
-        if ((*proc)(NULL, colPtr, rowPtr, maxRowPtr) > 0) {
-            maxRowPtr = rowPtr;
+    memcpy(buffer, s, length);
+    buffer[length] = '\0';
+    switch (type) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+        return (Blt_GetDouble(NULL, buffer, dPtr) == TCL_OK);
+    case TABLE_COLUMN_TYPE_LONG:
+        if (Blt_GetLong(NULL, buffer, &l) != TCL_OK) {
+            return FALSE;
         }
+        *i64Ptr = l;
+        return TRUE;
+    case TABLE_COLUMN_TYPE_INT64:
+        return (Blt_GetInt64(NULL, buffer, i64Ptr) == TCL_OK);
+    default:
+        return FALSE;
     }
-    *minObjPtrPtr = blt_table_get_obj(tablePtr, minRowPtr, colPtr);
-    *maxObjPtrPtr = blt_table_get_obj(tablePtr, maxRowPtr, colPtr);
-    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_delete_column --
+ * blt_table_set_string_reps --
  *
- *      Remove the designated column from the table.  The actual space
- *      contained by the column isn't freed.  The map is compressed.
- *      Tcl_Objs stored as column values are released.  Traces and tags
- *      associated with the column are removed.
+ *      Sets the values of a column in many rows at once from their string
+ *      representations, as blt_table_set_string_rep does for a single
+ *      value.  Numbers are converted without creating TCL objects and
+ *      go straight into packed columns.
  *
- * Side Effects:
- *      Traces may fire when column values are unset.  Also notifier events
- *      may be triggered, indicating the column has been deleted.
+ * Results:
+ *      Returns a standard TCL result.  If a string can't be converted to
+ *      the column's type, TCL_ERROR is returned and an error message is
+ *      left in the interpreter.  Values before it have already been set.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_delete_column(Table *tablePtr, Column *colPtr)
+blt_table_set_string_reps(Tcl_Interp *interp, Table *tablePtr, Column *colPtr,
+                          size_t numValues, Row **rows, const char **strings,
+                          const int *lengths)
 {
-    /* If the deleted column is a primary key, the generated keytables
-     * are now invalid. So remove them. */
+    size_t i;
+
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    for (i = 0; i < numValues; i++) {
+        Row *rowPtr;
+        Value *valuePtr;
+        double d;
+        int64_t i64;
+
+        rowPtr = rows[i];
+        if (!ScanNumber(colPtr->type, strings[i], lengths[i], &d, &i64)) {
+            if (blt_table_set_string_rep(interp, tablePtr, rowPtr, colPtr, 
+                        strings[i], lengths[i]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            continue;
+        }
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            CopyOnWrite(colPtr, rowPtr);
+            StatsRemoveValue(colPtr, rowPtr);
+            if (IsPackedDouble(colPtr)) {
+                PackedDouble(colPtr, rowPtr->offset) = d;
+            } else {
+                PackedInt64(colPtr, rowPtr->offset) = i64;
+            }
+            PackedSetExists(colPtr, rowPtr->offset);
+            StatsAddValue(colPtr, rowPtr);
+            continue;
+        }
+        CopyOnWrite(colPtr, rowPtr);
+        valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+        IndexRemoveValue(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_DOUBLE:
+            valuePtr->datum.d = d;
+            break;
+        case TABLE_COLUMN_TYPE_LONG:
+            valuePtr->datum.l = (long)i64;
+            break;
+        default:
+            valuePtr->datum.i64 = i64;
+            break;
+        }
+        SetValueString(valuePtr, strings[i], lengths[i]);
+        IndexAddValue(colPtr, rowPtr);
+        StatsAddValue(colPtr, rowPtr);
+    }
     if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        blt_table_unset_keys(tablePtr);
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    }
+    if (colPtr->bindPtr != NULL) {
+        UpdateBinding(colPtr->bindPtr, NULL, TABLE_TRACE_WRITES);
+    }
+    return TCL_OK;
+}
+
+/* Empty slots of packed double columns hold NaN, so that vectors bound
+ * to the column see them as missing. */
+static INLINE void
+ClearPackedSlot(Column *colPtr, long offset)
+{
+    if (IsPackedDouble(colPtr)) {
+        PackedDouble(colPtr, offset) = Blt_NaN();
+    } else {
+        PackedInt64(colPtr, offset) = 0;
+    }
+}
+
+/* Indicates if the rows are stored at consecutive offsets. */
+static int
+IsContiguous(size_t numRows, Row **rows)
+{
+    size_t i;
+
+    for (i = 1; i < numRows; i++) {
+        if (rows[i]->offset != (rows[0]->offset + (long)i)) {
+            return FALSE;
+        }
     }
-    NotifyColumnChanged(tablePtr, colPtr, TABLE_NOTIFY_COLUMNS_DELETED);
-    blt_table_clear_column_traces(tablePtr, colPtr);
-    Blt_Tags_ClearTagsFromItem(tablePtr->columnTags, colPtr);
-    ClearColumnNotifiers(tablePtr, colPtr);
-    DeleteColumn(tablePtr, colPtr);
-    return TCL_OK;
+    return TRUE;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_extend_columns --
+ * blt_table_set_packed_values --
  *
- *      Adds new columns to the table.  Columns are slots in an array of
- *      Columns.  The array columns by doubling its size, so there may be more
- *      slots than needed (# columns).
+ *      Sets the values of a numeric column in many rows at once from an
+ *      array of numbers: doubles for double and time columns, 64-bit
+ *      integers for long and int64 columns.  The optional bitmap (one bit
+ *      per value, least significant bit first) marks which values are
+ *      set; the others are unset.  If the column is packed and the rows
+ *      are stored at consecutive offsets, the array is copied into the
+ *      column at once.
  *
  * Results:
- *      Returns TCL_OK is the tuple is resized and TCL_ERROR if an
- *      not enough memory was available.
- *
- * Side Effects:
- *      If more columns are needed, the array which holds the tuples is
- *      reallocated by doubling its size.  
+ *      Returns a standard TCL result.  If the column isn't numeric,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_extend_columns(Tcl_Interp *interp, BLT_TABLE table, size_t numExtra, 
-                        Column **columns)
+blt_table_set_packed_values(Tcl_Interp *interp, Table *tablePtr, 
+                            Column *colPtr, size_t numValues, Row **rows,
+                            const void *values, const unsigned char *validBits)
 {
     size_t i;
-    Blt_Chain chain;
-    Blt_ChainLink link;
 
-    chain = Blt_Chain_Create();
-    if (!ExtendColumns(table, numExtra, chain)) {
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    if (!IsPackableType(colPtr->type)) {
         if (interp != NULL) {
-            Tcl_AppendResult(interp, "can't extend table by ", 
-                Blt_Ltoa(numExtra), " columns: out of memory.", (char *)NULL);
+            Tcl_AppendResult(interp, "column \"", colPtr->label,
+                "\" isn't numeric", (char *)NULL);
         }
-        Blt_Chain_Destroy(chain);
         return TCL_ERROR;
     }
-    /* For each new column generate a notify event. */
-    for (i = 0, link = Blt_Chain_FirstLink(chain); link != NULL; 
-         link = Blt_Chain_NextLink(link), i++) {
-        Column *colPtr;
+    if (numValues == 0) {
+        return TCL_OK;
+    }
+    if ((colPtr->flags & TABLE_COLUMN_PACKED) && (colPtr->statsPtr == NULL) &&
+        (IsContiguous(numValues, rows))) {
+        long offset, last, j;
 
-        colPtr = Blt_Chain_GetValue(link);
-        if (columns != NULL) {
-            columns[i] = colPtr;
+        offset = rows[0]->offset;
+        last = offset + numValues - 1;
+        for (j = offset >> TABLE_CHUNK_SHIFT; 
+             j <= (last >> TABLE_CHUNK_SHIFT); j++) {
+            CopyChunkOnWrite(colPtr, j);
         }
-        NotifyColumnChanged(table, colPtr, TABLE_NOTIFY_COLUMNS_CREATED);
+        PutPackedSlots(colPtr, offset, values, numValues);
+        for (i = 0; i < numValues; i++) {
+            if ((validBits == NULL) || (validBits[i >> 3] & (1 << (i & 7)))) {
+                PackedSetExists(colPtr, offset + i);
+            } else {
+                PackedClearExists(colPtr, offset + i);
+                ClearPackedSlot(colPtr, offset + i);
+            }
+        }
+        goto done;
+    }
+    for (i = 0; i < numValues; i++) {
+        Row *rowPtr;
+        Value *valuePtr;
+        int isValid;
+
+        rowPtr = rows[i];
+        isValid = ((validBits == NULL) || (validBits[i >> 3] & (1 << (i & 7))));
+        CopyOnWrite(colPtr, rowPtr);
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            StatsRemoveValue(colPtr, rowPtr);
+            if (isValid) {
+                PackedInt64(colPtr, rowPtr->offset) = ((int64_t *)values)[i];
+                PackedSetExists(colPtr, rowPtr->offset);
+                StatsAddValue(colPtr, rowPtr);
+            } else {
+                PackedClearExists(colPtr, rowPtr->offset);
+                ClearPackedSlot(colPtr, rowPtr->offset);
+            }
+            continue;
+        }
+        valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+        IndexRemoveValue(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        ResetValue(valuePtr);
+        if (isValid) {
+            FormatPackedSlot(colPtr->type, (const double *)values + i, 
+                             valuePtr);
+        }
+        IndexAddValue(colPtr, rowPtr);
+        StatsAddValue(colPtr, rowPtr);
+    }
+ done:
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    }
+    if (colPtr->bindPtr != NULL) {
+        UpdateBinding(colPtr->bindPtr, NULL, TABLE_TRACE_WRITES);
     }
-    Blt_Chain_Destroy(chain);
     return TCL_OK;
 }
 
-BLT_TABLE_COLUMN
-blt_table_create_column(Tcl_Interp *interp, BLT_TABLE table, const char *label)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_packed_values --
+ *
+ *      Gets the values of a numeric column in many rows at once, the
+ *      reverse of blt_table_set_packed_values.  The values are stored in
+ *      the array, and the bitmap (if not NULL) marks which are set.
+ *      Unset values are stored as zero.  If the column is packed and the
+ *      rows are stored at consecutive offsets, the values are copied out
+ *      of the column at once.
+ *
+ * Results:
+ *      Returns the number of unset values.
+ *
+ *---------------------------------------------------------------------------
+ */
+size_t
+blt_table_get_packed_values(Table *tablePtr, Column *colPtr, size_t numValues, 
+                            Row **rows, void *values, unsigned char *validBits)
 {
-    Column *colPtr;
+    int64_t *array = values;
+    size_t i, numEmpty;
 
-    colPtr = NULL;                      /* Suppress compiler warning. */
-    if (blt_table_extend_columns(interp, table, 1, &colPtr) != TCL_OK) {
-        return NULL;
+    if (validBits != NULL) {
+        memset(validBits, 0, (numValues + 7) / 8);
     }
-    if (label != NULL) {
-        if (blt_table_set_column_label(interp, table, colPtr, label)!=TCL_OK) {
-            blt_table_delete_column(table, colPtr);
-            return NULL;
+    if (numValues == 0) {
+        return 0;
+    }
+    numEmpty = 0;
+    if ((colPtr->flags & TABLE_COLUMN_PACKED) && 
+        (IsContiguous(numValues, rows))) {
+        long offset;
+
+        offset = rows[0]->offset;
+        GetPackedSlots(colPtr, offset, values, numValues);
+        for (i = 0; i < numValues; i++) {
+            if (!PackedExists(colPtr, offset + i)) {
+                array[i] = 0;
+                numEmpty++;
+            } else if (validBits != NULL) {
+                validBits[i >> 3] |= (1 << (i & 7));
+            }
         }
+        return numEmpty;
     }
-    return colPtr;
-}
+    for (i = 0; i < numValues; i++) {
+        Row *rowPtr;
+        Value *valuePtr;
 
-void
-blt_table_set_column_map(Table *tablePtr, Column **map)
-{
-    NotifyColumnChanged(tablePtr, NULL, TABLE_NOTIFY_COLUMNS_MOVED);
-    ReplaceColumnMap(&tablePtr->corePtr->columns, map);
+        rowPtr = rows[i];
+        if (IsEmpty(rowPtr, colPtr)) {
+            array[i] = 0;
+            numEmpty++;
+            continue;
+        }
+        if (validBits != NULL) {
+            validBits[i >> 3] |= (1 << (i & 7));
+        }
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            array[i] = PackedInt64(colPtr, rowPtr->offset);
+            continue;
+        }
+        valuePtr = ColumnValue(colPtr, rowPtr->offset);
+        switch (colPtr->type) {
+        case TABLE_COLUMN_TYPE_DOUBLE:
+        case TABLE_COLUMN_TYPE_TIME:
+            ((double *)values)[i] = valuePtr->datum.d;
+            break;
+        case TABLE_COLUMN_TYPE_LONG:
+            array[i] = valuePtr->datum.l;
+            break;
+        default:
+            array[i] = valuePtr->datum.i64;
+            break;
+        }
+    }
+    return numEmpty;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_move_columns --
+ * blt_table_set_string --
  *
- *      Move one of more rows to a new location in the tuple.
+ *      Sets the string value of the selected row, column location in the
+ *      table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  The column type must be "string",
+ *      otherwise an error is returned.
+ *
+ * Results:
+ *      Returns a standard TCL result.
+ *
+ * Side Effects:
+ *      New tuples may be allocated created.
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 int
-blt_table_move_columns(Tcl_Interp *interp, Table *tablePtr, Column *destPtr, 
-                       Column *firstPtr, Column *lastPtr, int after)
+blt_table_set_string(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                     Column *colPtr, const char *string, int length)
 {
-    Columns *columnsPtr;
-
-    columnsPtr = &tablePtr->corePtr->columns;
-    if (!MoveColumns(columnsPtr, destPtr, firstPtr, lastPtr, after)) {
-        Tcl_AppendResult(interp, "can't move columns in \"", 
-                blt_table_name(tablePtr), "\"", (char *)NULL);
+    if (colPtr->type != TABLE_COLUMN_TYPE_STRING) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "column \"", colPtr->label, 
+                         "\" is not type string.", (char *)NULL);
+        }
         return TCL_ERROR;
     }
-    NotifyColumnChanged(tablePtr, NULL, TABLE_NOTIFY_COLUMNS_MOVED);
-    return TCL_OK;
+    return blt_table_set_string_rep(interp, tablePtr, rowPtr, colPtr, string,
+        length);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_restore --
+ * blt_table_append_string --
  *
- *      Restores data to the given table based upon the dump string.
- *      The dump string should have been generated by blt_table_dump.
- *      Two bit flags may be set.
- *      
- *      TABLE_RESTORE_NO_TAGS   Don't restore tag information.
- *      TABLE_RESTORE_OVERWRITE Look for row and columns with the 
- *                              same label. Overwrite if necessary.
+ *      Append the string value of the selected row, column location in the
+ *      table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  After the string is appended, the column 
+ *      is reconverted to its designated type.
  *
  * Results:
- *      A standard TCL result.  If the restore was successful, TCL_OK
- *      is returned.  Otherwise, TCL_ERROR is returned and an error
- *      message is left in the interpreter result.
+ *      Returns a standard TCL result.
  *
  * Side Effects:
- *      New row and columns are created in the table and may possibly
- *      generate event notifier or trace callbacks.
+ *      New tuples may be allocated created.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_restore(Tcl_Interp *interp, BLT_TABLE table, char *data, 
-                      unsigned int flags)
+blt_table_append_string(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
+                       Column *colPtr, const char *s, int length)
 {
-    RestoreData restore;
-    int result;
+    Value *valuePtr;
+    long l;
+    double d;
+    Tcl_Obj *objPtr;
 
-    restore.argc = 0;
-    restore.mtime = restore.ctime = 0L;
-    restore.argv = NULL;
-    restore.fileName = "data string";
-    restore.numLines = 0;
-    restore.flags = flags;
-    restore.numCols = blt_table_num_columns(table);
-    restore.numRows = blt_table_num_rows(table);
-    Blt_InitHashTableWithPool(&restore.rowIndices, BLT_ONE_WORD_KEYS);
-    Blt_InitHashTableWithPool(&restore.colIndices, BLT_ONE_WORD_KEYS);
-    /* Read dump information */
-    result = TCL_ERROR;
-    for (;;) {
-        char c1, c2;
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        EncodedString *strPtr;
 
-        result = ParseDumpRecord(interp, &data, &restore);
+        strPtr = EncodedStringAt(colPtr, rowPtr->offset);
+        objPtr = Tcl_NewStringObj(strPtr->string, strPtr->length);
+        Tcl_AppendToObj(objPtr, s, length);
+        s = Tcl_GetStringFromObj(objPtr, &length);
+        SetEncodedString(colPtr, rowPtr, s, length);
+        Tcl_DecrRefCount(objPtr);
+        return TCL_OK;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        int result;
+
+        /* Append to the formatted value (2.0, not the 2 that may have
+         * been set) and store the number, so the column stays packed. */
+        if (PackedExists(colPtr, rowPtr->offset)) {
+            Value packed;
+
+            FormatPackedValue(colPtr, rowPtr->offset, &packed);
+            objPtr = Tcl_NewStringObj(GetValueString(&packed), 
+                                      GetValueLength(&packed));
+            ResetValue(&packed);
+            Tcl_AppendToObj(objPtr, s, length);
+        } else {
+            objPtr = Tcl_NewStringObj(s, length);
+        }
+        Tcl_IncrRefCount(objPtr);
+        result = SetPackedFromObj(interp, colPtr, rowPtr, objPtr);
+        Tcl_DecrRefCount(objPtr);
         if (result != TCL_OK) {
-            break;
+            return TCL_ERROR;
         }
-        if (restore.argc == 0) {
-            continue;
+        goto done;
+    }
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    if (IsEmptyValue(valuePtr)) {
+        objPtr = Tcl_NewStringObj(s, length);
+    } else {
+        objPtr = Tcl_NewStringObj(GetValueString(valuePtr),
+                                  GetValueLength(valuePtr));
+        Tcl_AppendToObj(objPtr, s, length);
+    }
+    Tcl_IncrRefCount(objPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    switch (colPtr->type) {
+    case TABLE_COLUMN_TYPE_TIME:        /* Time: is a double */
+        if (Blt_GetTimeFromObj(interp, objPtr, &d) != TCL_OK) {
+            goto error;
         }
-        c1 = restore.argv[0][0], c2 = restore.argv[0][1];
-        if ((c1 == 'i') && (c2 == '\0')) {
-            result = RestoreHeader(interp, table, &restore);
-        } else if ((c1 == 'r') && (c2 == '\0')) {
-            result = RestoreRow(interp, table, &restore);
-        } else if ((c1 == 'c') && (c2 == '\0')) {
-            result = RestoreColumn(interp, table, &restore);
-        } else if ((c1 == 'd') && (c2 == '\0')) {
-            result = RestoreValue(interp, table, &restore);
-        } else {
-            Tcl_AppendResult(interp, restore.fileName, ":", 
-                Blt_Ltoa(restore.numLines), ": error: unknown entry \"", 
-                restore.argv[0], "\"", (char *)NULL);
-            result = TCL_ERROR;
+        valuePtr->datum.d = d;
+        break;
+
+    case TABLE_COLUMN_TYPE_DOUBLE:      /* double */
+        if (Blt_GetDoubleFromObj(interp, objPtr, &d) != TCL_OK) {
+            goto error;
         }
-        Tcl_Free((char *)restore.argv);
-        if (result != TCL_OK) {
-            break;
+        valuePtr->datum.d = d;
+        break;
+    case TABLE_COLUMN_TYPE_BOOLEAN:      /* boolean */
+        {
+            int ival;
+            
+            if (Tcl_GetBooleanFromObj(interp, objPtr, &ival) != TCL_OK) {
+                goto error;
+            }
+            valuePtr->datum.l = ival;
         }
+        break;
+    case TABLE_COLUMN_TYPE_LONG:        /* long */
+        if (Blt_GetLongFromObj(interp, objPtr, &l) != TCL_OK) {
+            goto error;
+        }
+        valuePtr->datum.l = l;
+        break;
+    default:                            /* string. */
+        break;
     }
-    Blt_DeleteHashTable(&restore.rowIndices);
-    Blt_DeleteHashTable(&restore.colIndices);
-    if (result == TCL_ERROR) {
-        return TCL_ERROR;
+    s = Tcl_GetStringFromObj(objPtr, &length);
+    ResetValue(valuePtr);
+    if (length >= TABLE_VALUE_LENGTH) {
+        valuePtr->string = Blt_Strndup(s, length + 1);
+        valuePtr->length = length;
+    } else {
+        strncpy(valuePtr->store, s, length);
+        valuePtr->store[length] = '\0';
+        valuePtr->string = TABLE_VALUE_STORE;
+        valuePtr->length = length;
+    }
+    Tcl_DecrRefCount(objPtr);
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+ done:
+    /* Indicate the keytables need to be regenerated. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    }
+    if (colPtr->bindPtr != NULL) {
+        UpdateBinding(colPtr->bindPtr, rowPtr, TABLE_TRACE_WRITES);
     }
     return TCL_OK;
+ error:
+    IndexAddValue(colPtr, rowPtr);      /* Value is unchanged. */
+    StatsAddValue(colPtr, rowPtr);
+    Tcl_DecrRefCount(objPtr);
+    return TCL_ERROR;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_file_restore --
- *
- *      Restores data to the given table based upon the dump file
- *      provided. The dump file should have been generated by
- *      blt_table_dump or blt_table_file_dump.
+ * blt_table_set_double --
  *
- *      If the filename starts with an '@', then it is the name of an
- *      already opened channel to be used. Two bit flags may be set.
- *      
- *      TABLE_RESTORE_NO_TAGS   Don't restore tag information.
- *      TABLE_RESTORE_OVERWRITE Look for row and columns with 
- *                              the same label. Overwrite if necessary.
+ *      Sets the double value of the selected row, column location in the
+ *      table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  The column type must be "double", "time",
+ *      or "string", otherwise an error is returned.
  *
  * Results:
- *      A standard TCL result.  If the restore was successful, TCL_OK
- *      is returned.  Otherwise, TCL_ERROR is returned and an error
- *      message is left in the interpreter result.
- *
- * Side Effects:
- *      Row and columns are created in the table and may possibly
- *      generate trace or notifier event callbacks.
+ *      Returns a standard TCL result.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_file_restore(Tcl_Interp *interp, BLT_TABLE table, 
-                       const char *fileName, unsigned int flags)
+blt_table_set_double(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                     Column *colPtr, double value)
 {
-    RestoreData restore;
-    Tcl_Channel channel;
-    int closeChannel;
-    int result;
+    Value *valuePtr;
 
-    closeChannel = TRUE;
-    if ((fileName[0] == '@') && (fileName[1] != '\0')) {
-        int mode;
-        
-        channel = Tcl_GetChannel(interp, fileName+1, &mode);
-        if (channel == NULL) {
-            return TCL_ERROR;
-        }
-        if ((mode & TCL_READABLE) == 0) {
-            Tcl_AppendResult(interp, "channel \"", fileName, 
-                "\" not opened for reading", (char *)NULL);
-            return TCL_ERROR;
-        }
-        closeChannel = FALSE;
-    } else {
-        channel = Tcl_OpenFileChannel(interp, fileName, "r", 0);
-        if (channel == NULL) {
-            return TCL_ERROR;   /* Can't open dump file. */
-        }
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
     }
-    restore.argc = 0;
-    restore.mtime = restore.ctime = 0L;
-    restore.argv = NULL;
-    restore.fileName = fileName;
-    restore.numLines = 0;
-    restore.flags = flags;
-    restore.numCols = blt_table_num_columns(table);
-    restore.numRows = blt_table_num_rows(table);
-    Blt_InitHashTableWithPool(&restore.rowIndices, BLT_ONE_WORD_KEYS);
-    Blt_InitHashTableWithPool(&restore.colIndices, BLT_ONE_WORD_KEYS);
-
-    result = TCL_ERROR;
-    /* Process dump information record by record. */
-    for (;;) {
-        char c1, c2;
-
-        result = ReadDumpRecord(interp, channel, &restore);
-        if (result != TCL_OK) {
-            break;
-        }
-        if (restore.argc == 0) {
-            continue;
+    if ((colPtr->type != TABLE_COLUMN_TYPE_DOUBLE) &&
+        (colPtr->type != TABLE_COLUMN_TYPE_STRING) &&
+        (colPtr->type != TABLE_COLUMN_TYPE_TIME)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "column \"", colPtr->label,
+                             "\" is not type double.", (char *)NULL);
         }
-        c1 = restore.argv[0][0], c2 = restore.argv[0][1];
-        if ((c1 == 'i') && (c2 == '\0')) {
-            result = RestoreHeader(interp, table, &restore);
-        } else if ((c1 == 'r') && (c2 == '\0')) {
-            result = RestoreRow(interp, table, &restore);
-        } else if ((c1 == 'c') && (c2 == '\0')) {
-            result = RestoreColumn(interp, table, &restore);
-        } else if ((c1 == 'd') && (c2 == '\0')) {
-            result = RestoreValue(interp, table, &restore);
+        return TCL_ERROR;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        CopyOnWrite(colPtr, rowPtr);
+        StatsRemoveValue(colPtr, rowPtr);
+        if (isnan(value)) {
+            PackedClearExists(colPtr, rowPtr->offset);
         } else {
-            Tcl_AppendResult(interp, fileName, ":", Blt_Ltoa(restore.numLines), 
-                ": error: unknown entry \"", restore.argv[0], "\"", 
-                (char *)NULL);
-            result = TCL_ERROR;
-        }
-        if (result != TCL_OK) {
-            Tcl_Free((char *)restore.argv); /* Allocated by Tcl_SplitList */
-            break;
+            PackedDouble(colPtr, rowPtr->offset) = value;
+            PackedSetExists(colPtr, rowPtr->offset);
+            StatsAddValue(colPtr, rowPtr);
         }
-        Tcl_Free((char *)restore.argv); /* Allocated by Tcl_SplitList */
-    }
-    Blt_DeleteHashTable(&restore.rowIndices);
-    Blt_DeleteHashTable(&restore.colIndices);
-    if (closeChannel) {
-        Tcl_Close(interp, channel);
-    }
-    if (result == TCL_ERROR) {
-        return TCL_ERROR;
+        goto done;
     }
-    return TCL_OK;
-}
+    if (colPtr->encodingPtr != NULL) {
+        if (isnan(value)) {
+            UnsetEncodedValue(colPtr, rowPtr);
+        } else {
+            char string[200];
 
-static void
-FreePrimaryKeys(Table *tablePtr)
-{
-    int i;
-    
-    for (i = 0; i < tablePtr->numKeys; i++) {
-        Column *colPtr;
-        
-        colPtr = tablePtr->primaryKeys[i];
-        colPtr->flags &= ~TABLE_COLUMN_PRIMARY_KEY;
+            sprintf(string, "%.17g", value);
+            SetEncodedString(colPtr, rowPtr, string, -1);
+        }
+        goto done;
     }
-    Blt_Free(tablePtr->primaryKeys);
-    tablePtr->primaryKeys = NULL;
-    tablePtr->numKeys = 0;
-}
-
-static void
-FreeKeyTables(Table *tablePtr)
-{
-    if (tablePtr->keyTables != NULL) {
-        int i;
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    ResetValue(valuePtr);
+    if (!isnan(value)) {
+        char string[200];
 
-        for (i = 0; i < tablePtr->numKeys; i++) {
-            Blt_DeleteHashTable(tablePtr->keyTables + i);
+        valuePtr->datum.d = value;
+        valuePtr->length = sprintf(string, "%.17g", value);
+        if (strlen(string) >= TABLE_VALUE_LENGTH) {
+            valuePtr->string = Blt_AssertStrdup(string);
+        } else {
+            strcpy(valuePtr->store, string);
+            valuePtr->string = TABLE_VALUE_STORE;
         }
-        Blt_Free(tablePtr->keyTables);
-        tablePtr->keyTables = NULL;
     }
-    if (tablePtr->masterKey != NULL) {
-        Blt_Free(tablePtr->masterKey);
-        Blt_DeleteHashTable(&tablePtr->masterKeyTable);
-        tablePtr->masterKey = NULL;
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+ done:
+    /* Indicate the keytables need to be regenerated. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
     }
+    CallTraces(tablePtr, rowPtr, colPtr, TABLE_TRACE_WRITES);
+    return TCL_OK;
 }
 
-void
-blt_table_unset_keys(Table *tablePtr)
-{
-    FreeKeyTables(tablePtr);
-    FreePrimaryKeys(tablePtr);
-    tablePtr->flags &= ~(TABLE_KEYS_DIRTY | TABLE_KEYS_UNIQUE);
-}
-
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_set_bytes --
+ *
+ *      Sets the blob value of the selected row, column location in the
+ *      table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  The column type must be "blob" or an
+ *      error is returned.
+ *
+ * Results:
+ *      Returns a standard TCL result.
+ *
+ * Side Effects:
+ *      New tuples may be allocated created.  
+ *
+ *---------------------------------------------------------------------------
+ */
 int
-blt_table_get_keys(Table *tablePtr, BLT_TABLE_COLUMN **keysPtr)
+blt_table_set_bytes(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                    Column *colPtr, const unsigned char *bytes, int numBytes)
 {
-    *keysPtr = tablePtr->primaryKeys;
-    return tablePtr->numKeys;
-}
+    Value *valuePtr;
 
-static int
-SameKeys(int len1, BLT_TABLE_COLUMN *keys1, int len2, BLT_TABLE_COLUMN *keys2)
-{
-    int i;
-    
-    if (len1 != len2) {
-        return FALSE;
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
     }
-    for (i = 0; i < len1; i++) {
-        if (keys1[i] != keys2[i]) {
-            fprintf(stderr, "different keys\n");
-            return FALSE;
+    if (colPtr->type != TABLE_COLUMN_TYPE_BLOB) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "column \"", colPtr->label, 
+                         "\" is not type blob.", (char *)NULL);
         }
-    } 
-    return TRUE;
-}
-
-int
-blt_table_set_keys(Table *tablePtr, int numKeys, BLT_TABLE_COLUMN *keys,
-                   int unique)
-{
-    int i;
-    
-    if (SameKeys(tablePtr->numKeys, tablePtr->primaryKeys, numKeys, keys)) {
-        return TCL_OK;
-    }
-    if (tablePtr->primaryKeys != NULL) {
-        FreePrimaryKeys(tablePtr);
-    }
-    tablePtr->primaryKeys = keys;
-    tablePtr->numKeys = numKeys;
-    
-    /* Mark the designated columns as primary keys.  This flag is used to
-     * check if a primary column is deleted, it's rows are added or
-     * changed, or it's values set or unset.  The generated keytables are
-     * invalid and need to be regenerated. */
-    for (i = 0; i < numKeys; i++) {
-        Column *colPtr;
-        
-        colPtr = keys[i];
-        colPtr->flags |= TABLE_COLUMN_PRIMARY_KEY;
+        return TCL_ERROR;
     }
-    tablePtr->flags |= TABLE_KEYS_DIRTY;
-    if (unique) {
-        tablePtr->flags |= TABLE_KEYS_UNIQUE;
+    CopyOnWrite(colPtr, rowPtr);
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    IndexRemoveValue(colPtr, rowPtr);
+    StatsRemoveValue(colPtr, rowPtr);
+    ResetValue(valuePtr);
+    if (SetValueFromString(interp, colPtr->type, (const char *)bytes, numBytes,
+                           valuePtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    IndexAddValue(colPtr, rowPtr);
+    StatsAddValue(colPtr, rowPtr);
+    /* Indicate the keytables need to be regenerated. */
+    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
+        tablePtr->flags |= TABLE_KEYS_DIRTY;
     }
     return TCL_OK;
 }
 
-static int
-MakeKeyTables(Tcl_Interp *interp, Table *tablePtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_string --
+ *
+ *      Retrieves the string value of the selected row, column location in
+ *      the table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  The current string representation of the
+ *      value is returned.
+ *
+ * Results:
+ *      Returns a string value.  If the value is empty, the default value 
+ *      is returned.
+ *
+ *---------------------------------------------------------------------------
+ */
+const char *
+blt_table_get_string(Table *tablePtr, Row *rowPtr, Column *colPtr)
 {
-    Row *rowPtr;
-    int i;
-    size_t masterKeySize;
-
-    FreeKeyTables(tablePtr);
-    tablePtr->flags &= ~TABLE_KEYS_DIRTY;
+    Value *valuePtr;
 
-    /* Create a hashtable for each key. */
-    tablePtr->keyTables =
-        Blt_Malloc(sizeof(Blt_HashTable) * tablePtr->numKeys);
-    if (tablePtr->keyTables == NULL) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "can't allocated keytables for ",
-                Blt_Itoa(tablePtr->numKeys), " keys.", (char *)NULL);
-        }
-        return TCL_ERROR;
+    if (IsEmpty(rowPtr, colPtr)) {
+        return NULL;
     }
-    for (i = 0; i < tablePtr->numKeys; i++) {
-        size_t size;
-        Column *colPtr;
-
-        colPtr = tablePtr->primaryKeys[i];
-        switch (colPtr->type) {
-        case TABLE_COLUMN_TYPE_DOUBLE:
-        case TABLE_COLUMN_TYPE_TIME:
-            size = sizeof(double)/sizeof(int);
-            break;
-        case TABLE_COLUMN_TYPE_BOOLEAN:
-        case TABLE_COLUMN_TYPE_LONG:
-            size = BLT_ONE_WORD_KEYS;
-            break;
-        default:
-        case TABLE_COLUMN_TYPE_STRING:
-            size = BLT_STRING_KEYS;
-            break;
-        }
-        Blt_InitHashTable(tablePtr->keyTables + i, size);
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        return GetPackedString(colPtr, rowPtr->offset);
     }
-    /* Generate a master table of key tuple combinations for each row.  
-     * We uniquely identify the key by its row in the column. The combination
-     * of these keys (in the exact order) is how we find the row. */
-    masterKeySize = sizeof(BLT_TABLE_ROW) * tablePtr->numKeys;
-    tablePtr->masterKey = Blt_AssertMalloc(masterKeySize);
-    Blt_InitHashTable(&tablePtr->masterKeyTable, masterKeySize / sizeof(int));
-
-    /* For each row, create hash entries for the individual key columns,
-     * but also for the combined keys for the row.  The hash of the
-     * combined keys must be unique. */
-    for (rowPtr = (Row *)tablePtr->corePtr->rows.headPtr; rowPtr != NULL; 
-         rowPtr = rowPtr->nextPtr) {
-        int j;
-
-        for (j = 0; j < tablePtr->numKeys; j++) {
-            Blt_HashTable *keyTablePtr;
-            Column *colPtr;
-            int isNew;
-            Blt_HashEntry *hPtr;
-            Value *valuePtr;
-            
-            colPtr = tablePtr->primaryKeys[j];
-            if (IsEmpty(rowPtr, colPtr)) {
-                break;                  /* Skip this row since one of the
-                                         * key values is empty. */
-            }
-            keyTablePtr = tablePtr->keyTables + j;
-            valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-            switch (colPtr->type) {
-            case TABLE_COLUMN_TYPE_DOUBLE:
-            case TABLE_COLUMN_TYPE_TIME:
-                hPtr = Blt_CreateHashEntry(keyTablePtr, &valuePtr->datum.d,
-                                           &isNew);
-                break;
-            case TABLE_COLUMN_TYPE_BOOLEAN:
-            case TABLE_COLUMN_TYPE_LONG:
-                hPtr = Blt_CreateHashEntry(keyTablePtr,
-                                           (intptr_t)valuePtr->datum.l, &isNew);
-                break;
-            case TABLE_COLUMN_TYPE_STRING:
-            default:
-                hPtr = Blt_CreateHashEntry(keyTablePtr,
-                                           GetValueString(valuePtr), &isNew);
-                break;
-            }
-            if (isNew) {
-                Blt_SetHashValue(hPtr, rowPtr);
-            }
-            tablePtr->masterKey[j] = Blt_GetHashValue(hPtr);
-        }
-        if (j == tablePtr->numKeys) {
-            Blt_HashEntry *hPtr;
-            int isNew;
-
-            /* If we created all the hashkeys necessary for this row, then
-             * generate an entry for the row in the master key table. */
-            hPtr = Blt_CreateHashEntry(&tablePtr->masterKeyTable, 
-                tablePtr->masterKey, &isNew);
-            if (isNew) {
-                Blt_SetHashValue(hPtr, rowPtr);
-            } else if (tablePtr->flags & TABLE_KEYS_UNIQUE) {
-                if (interp != NULL) {
-                    BLT_TABLE_ROW dupRow;
-        
-                    dupRow = Blt_GetHashValue(hPtr);
-                    Tcl_AppendResult(interp, "primary keys are not unique:",
-                        "rows \"", blt_table_row_label(dupRow), "\" and \"",
-                        blt_table_row_label(rowPtr), 
-                        "\" have the same keys.", (char *)NULL);
-                }
-                blt_table_unset_keys(tablePtr);
-                return TCL_ERROR;       /* Bail out. Keys aren't unique. */
-            }
-        }
+    if (colPtr->encodingPtr != NULL) {
+        return EncodedStringAt(colPtr, rowPtr->offset)->string;
     }
-    tablePtr->flags &= ~TABLE_KEYS_UNIQUE;
-    return TCL_OK;
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    return GetValueString(valuePtr);
 }
-            
+
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_key_lookup --
+ * blt_table_get_double --
  *
- *      Look up the (hopefully) unique row that matches all the values
- *      for each of the key columns.  
+ *      Retrieves the double value of the selected row, column location in
+ *      the table.  No checking is done the see if row and column are valid
+ *      (it's assumed they are).  If the current type of the column isn't
+ *      "double", the double value is computed.
  *
  * Results:
- *      Returns a standard TCL result.  *rowPtrPtr will return the 
- *      pointer to the found row.  NULL is the row wasn't found.
+ *      Returns a double value.  If the value is empty, the default value 
+ *      is returned (NaN).
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_key_lookup(Tcl_Interp *interp, Table *tablePtr, int objc, 
-                     Tcl_Obj *const *objv, Row **rowPtrPtr)
+double
+blt_table_get_double(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                     Column *colPtr)
 {
-    int i;
-    Blt_HashEntry *hPtr;
-    
-    *rowPtrPtr = NULL;
-    if (objc != tablePtr->numKeys) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "wrong # of values: should be ",
-                Blt_Itoa(tablePtr->numKeys), " value(s) of ", (char *)NULL);
-            for (i = 0; i < tablePtr->numKeys; i++) {
-                BLT_TABLE_COLUMN col;
+    Value *valuePtr;
+    double d;
 
-                col = tablePtr->primaryKeys[i];
-                Tcl_AppendResult(interp, blt_table_column_label(col), " ", 
-                                 (char *)NULL);
-            }
-        }
-        return TCL_ERROR;               /* Wrong # of keys supplied. */
+    if (IsEmpty(rowPtr, colPtr)) {
+        return Blt_NaN();
     }
-    if (tablePtr->numKeys == 0) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "no primary keys designated",
-                         (char *)NULL);
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        if (IsPackedDouble(colPtr)) {
+            return PackedDouble(colPtr, rowPtr->offset);
         }
-        return TCL_ERROR;
+        return (double)PackedInt64(colPtr, rowPtr->offset);
     }
-    if (tablePtr->flags & TABLE_KEYS_DIRTY) {
-        if (MakeKeyTables(interp, tablePtr) != TCL_OK) {
-            return TCL_ERROR;
+    if (colPtr->encodingPtr != NULL) {
+        if (Blt_GetDouble(interp, 
+                EncodedStringAt(colPtr, rowPtr->offset)->string, &d) 
+            != TCL_OK) {
+            return Blt_NaN();
         }
+        return d;
     }
-    /* Create a master search key by getting the rows from the individual
-     * key hash tables for each key.  Use this key to search the master
-     * table. */
-    for (i = 0; i < tablePtr->numKeys; i++) {
-        Blt_HashTable *keyTablePtr;
-        Column *colPtr;
-        Blt_HashEntry *hPtr;
-
-        colPtr = tablePtr->primaryKeys[i];
-        keyTablePtr = tablePtr->keyTables + i;
-        switch (colPtr->type) {
-        case TABLE_COLUMN_TYPE_DOUBLE:
-        case TABLE_COLUMN_TYPE_TIME:
-            {
-                double dval;
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    if ((colPtr->type == TABLE_COLUMN_TYPE_DOUBLE) ||
+        (colPtr->type == TABLE_COLUMN_TYPE_TIME)) {
+        return valuePtr->datum.d;
+    }
+    if (Blt_GetDouble(interp, GetValueString(valuePtr), &d) != TCL_OK) {
+        return Blt_NaN();
+    }
+    return d;
+}
 
-                if (Blt_GetDoubleFromObj(interp, objv[i], &dval) != TCL_OK) {
-                    return TCL_ERROR;
-                }
-                hPtr = Blt_FindHashEntry(keyTablePtr, &dval);
-            }
-            break;
-        case TABLE_COLUMN_TYPE_BOOLEAN:
-            {
-                int ival;
-                
-                if (Tcl_GetBooleanFromObj(interp, objv[i], &ival) != TCL_OK) {
-                    return TCL_ERROR;
-                }
-                hPtr = Blt_FindHashEntry(keyTablePtr, (intptr_t)ival);
-            }
-            break;
-        case TABLE_COLUMN_TYPE_LONG:
-            {
-                long lval;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_get_long --
+ *
+ *      Retrieves the long integer value of the selected row, column
+ *      location in the table.  No checking is done the see if row and
+ *      column are valid (it's assumed they are).  If the current type of
+ *      the column isn't "integer", the long value is computed.
+ *
+ * Results:
+ *      Returns a long value.  If the value is empty, the default value 
+ *      is returned.
+ *
+ *---------------------------------------------------------------------------
+ */
+long
+blt_table_get_long(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                   Column *colPtr, long defVal)
+{
+    Value *valuePtr;
+    long l;
 
-                if (Blt_GetLongFromObj(interp, objv[i], &lval) != TCL_OK) {
-                    return TCL_ERROR;
-                }
-                hPtr = Blt_FindHashEntry(keyTablePtr, (intptr_t)lval);
-            }
-            break;
-        default:
-        case TABLE_COLUMN_TYPE_STRING:
-            {
-                const char *string;
+    if (IsEmpty(rowPtr, colPtr)) {
+        return defVal;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        Value packed;
+        int result;
 
-                string = Tcl_GetString(objv[i]);
-                hPtr = Blt_FindHashEntry(keyTablePtr, string);
-            }
-            break;
+        if (!IsPackedDouble(colPtr)) {
+            return (long)PackedInt64(colPtr, rowPtr->offset);
         }
-        if (hPtr == NULL) {
-            return TCL_OK;              /* Can't find one of the keys, so
-                                         * the whole search fails. */
+        FormatPackedValue(colPtr, rowPtr->offset, &packed);
+        result = Blt_GetLong(interp, GetValueString(&packed), &l);
+        ResetValue(&packed);
+        return (result == TCL_OK) ? l : TCL_ERROR;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        if (Blt_GetLong(interp, 
+                EncodedStringAt(colPtr, rowPtr->offset)->string, &l) 
+            != TCL_OK) {
+            return TCL_ERROR;
         }
-        tablePtr->masterKey[i] = Blt_GetHashValue(hPtr);
+        return l;
     }
-    hPtr = Blt_FindHashEntry(&tablePtr->masterKeyTable, tablePtr->masterKey);
-    if (hPtr == NULL) {
-        Blt_Warn("can't find master key\n");
-        return TCL_OK;
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    if (colPtr->type == TABLE_COLUMN_TYPE_LONG) {
+        return valuePtr->datum.l;
     }
-    *rowPtrPtr = Blt_GetHashValue(hPtr);
-    return TCL_OK;
+    if (Blt_GetLong(interp, GetValueString(valuePtr), &l) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return l;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_long --
+ * blt_table_get_boolean --
  *
- *      Sets the double value of the selected row, column location in the
- *      table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  The column type must be "integer" or
- *      "string", otherwise an error is returned.
+ *      Retrieves the boolean integer value of the selected row, column
+ *      location in the table.  No checking is done the see if row and
+ *      column are valid (it's assumed they are).  If the current type of
+ *      the column isn't "boolean", the boolean value is computed.
  *
  * Results:
- *      Returns a standard TCL result.
- *
- * Side Effects:
- *      New tuples may be allocated created.
+ *      Returns a boolean value.  If the value is empty, the default value 
+ *      is returned.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_set_long(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                   Column *colPtr, long value)
+blt_table_get_boolean(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                      Column *colPtr, int defVal)
 {
     Value *valuePtr;
-    char string[200];
+    int state;
 
-    if ((colPtr->type != TABLE_COLUMN_TYPE_LONG) &&
-        (colPtr->type != TABLE_COLUMN_TYPE_STRING)) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "wrong column type \"",
-                             blt_table_column_type_to_name(colPtr->type), 
-                             "\": should be \"integer\"", (char *)NULL);
+    if (IsEmpty(rowPtr, colPtr)) {
+        return defVal;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        Value packed;
+        int result;
+
+        FormatPackedValue(colPtr, rowPtr->offset, &packed);
+        result = Tcl_GetBoolean(interp, GetValueString(&packed), &state);
+        ResetValue(&packed);
+        return (result == TCL_OK) ? state : TCL_ERROR;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        if (Tcl_GetBoolean(interp, 
+                EncodedStringAt(colPtr, rowPtr->offset)->string, &state) 
+            != TCL_OK) {
+            return TCL_ERROR;
         }
-        return TCL_ERROR;
+        return state;
     }
     valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    ResetValue(valuePtr);
-    valuePtr->datum.l = value;
-    valuePtr->length = sprintf(string, "%ld", value);
-    if (strlen(string) >= TABLE_VALUE_LENGTH) {
-        valuePtr->string = Blt_AssertStrdup(string);
-    } else {
-        strcpy(valuePtr->store, string);
-        valuePtr->string = TABLE_VALUE_STORE;
+    if (colPtr->type == TABLE_COLUMN_TYPE_BOOLEAN) {
+        return (int)valuePtr->datum.l;
     }
-    /* Indicate the keytables need to be regenerated. */
-    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    if (Tcl_GetBoolean(interp, GetValueString(valuePtr), &state) != TCL_OK) {
+        return TCL_ERROR;
     }
-    return TCL_OK;
+    return state;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_boolean --
+ * blt_table_get_int64 --
  *
- *      Sets the double value of the selected row, column location in the
- *      table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  The column type must be "boolean" or
- *      "string", otherwise an error is returned.
+ *      Retrieves the 64-bit integer value of the selected row, column
+ *      location in the table.  No checking is done the see if row and
+ *      column are valid (it's assumed they are).  If the current type of
+ *      the column isn't "int64", the int64_t value is computed.
  *
  * Results:
- *      Returns a standard TCL result.
- *
- * Side Effects:
- *      New tuples may be allocated created.
+ *      Returns a int64_t value.  If the value is empty, the default value 
+ *      is returned.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_set_boolean(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                      Column *colPtr, int value)
+int64_t
+blt_table_get_int64(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
+                   Column *colPtr, int64_t defVal)
 {
     Value *valuePtr;
-    char string[200];
+    int64_t i;
 
-    if ((colPtr->type != TABLE_COLUMN_TYPE_BOOLEAN) &&
-        (colPtr->type != TABLE_COLUMN_TYPE_STRING)) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "wrong column type \"",
-                             blt_table_column_type_to_name(colPtr->type), 
-                             "\": should be \"boolean\"", (char *)NULL);
+    if (IsEmpty(rowPtr, colPtr)) {
+        return defVal;
+    }
+    if (colPtr->flags & TABLE_COLUMN_PACKED) {
+        Value packed;
+        int result;
+
+        if (!IsPackedDouble(colPtr)) {
+            return PackedInt64(colPtr, rowPtr->offset);
+        }
+        FormatPackedValue(colPtr, rowPtr->offset, &packed);
+        result = Blt_GetInt64(interp, GetValueString(&packed), &i);
+        ResetValue(&packed);
+        return (result == TCL_OK) ? i : TCL_ERROR;
+    }
+    if (colPtr->encodingPtr != NULL) {
+        if (Blt_GetInt64(interp, 
+                EncodedStringAt(colPtr, rowPtr->offset)->string, &i) 
+            != TCL_OK) {
+            return TCL_ERROR;
+        }
+        return i;
+    }
+    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
+    if (colPtr->type == TABLE_COLUMN_TYPE_INT64) {
+        return valuePtr->datum.i64;
+    }
+    if (Blt_GetInt64(interp, GetValueString(valuePtr), &i) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return i;
+}
+
+void
+blt_table_clear(Table *tablePtr)
+{
+    TableObject *corePtr;
+
+    corePtr = tablePtr->corePtr;
+    ForgetBatchItems(corePtr, NULL, NULL);
+    FreeBindings(corePtr, NULL);
+    FreeColumns(corePtr);
+    /* The row offsets are reused, so clear all the row tags. */
+    RemapRowTags(corePtr, TRUE);
+    FreeRows(corePtr);
+    ReleaseSnapshots(corePtr);
+    /* Re-initialize rows and columns. */
+    Blt_InitHashTableWithPool(&corePtr->columns.labelTable, BLT_STRING_KEYS);
+    Blt_InitHashTableWithPool(&corePtr->rows.labelTable, BLT_STRING_KEYS);
+    corePtr->columns.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
+    corePtr->columns.nextColumnId = 1;
+    corePtr->rows.freeList = Blt_Chain_Create();
+    corePtr->rows.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
+    corePtr->rows.nextRowId = 1;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PackPackedColumn --
+ *
+ *      Moves the values of a packed column so that they are in row order
+ *      with no gaps, for blt_table_pack.  The chunks are sized to the
+ *      number of rows used.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+PackPackedColumn(Rows *rowsPtr, Column *colPtr)
+{
+    Column column;                      /* Holds the new chunks. */
+    Row *rowPtr;
+    long count;
+
+    memset(&column, 0, sizeof(Column));
+    ResizePackedColumn(&column, (rowsPtr->numUsed > 0) ? rowsPtr->numUsed : 1);
+    count = 0;
+    for (rowPtr = rowsPtr->headPtr; rowPtr != NULL; rowPtr = rowPtr->nextPtr) {
+        if (PackedExists(colPtr, rowPtr->offset)) {
+            /* Doubles and 64-bit integers are the same size. Copy the
+             * bits rather than converting. */
+            memcpy(PackedSlot(&column, count), 
+                   PackedSlot(colPtr, rowPtr->offset), sizeof(double));
+            PackedSetExists(&column, count);
+        }
+        count++;
+    }
+    FreePackedColumn(colPtr);
+    colPtr->packed.d = column.packed.d;
+    colPtr->validMap = column.validMap;
+    colPtr->numPacked = column.numPacked;
+    colPtr->flags |= TABLE_COLUMN_PACKED;
+}
+
+void
+blt_table_pack(Table *tablePtr)
+{
+    Column *colPtr;
+    Columns *columnsPtr;
+    Rows *rowsPtr;
+
+    rowsPtr = &tablePtr->corePtr->rows;
+    columnsPtr = &tablePtr->corePtr->columns;
+    /* Replace each column's chunks with ones exactly the number of used
+     * rows.  */
+    for (colPtr = columnsPtr->headPtr; colPtr != NULL; 
+         colPtr = colPtr->nextPtr) {
+        /* Row offsets are changing, so ordered indexes must be resorted. */
+        IndexMarkDirty(colPtr);
+        UnshareColumn(colPtr);
+        if (colPtr->flags & TABLE_COLUMN_PACKED) {
+            PackPackedColumn(rowsPtr, colPtr);
+        }
+        if (colPtr->encodingPtr != NULL) {
+            unsigned int *codes;
+            Row *rowPtr;
+            long i;
+
+            codes = Blt_AssertCalloc(MAX(rowsPtr->numUsed, 1), 
+                                     sizeof(unsigned int));
+            i = 0;
+            for (rowPtr = rowsPtr->headPtr; rowPtr != NULL;
+                 rowPtr = rowPtr->nextPtr) {
+                codes[i] = EncodedCode(colPtr, rowPtr->offset);
+                i++;
+            }
+            Blt_Free(colPtr->encodingPtr->codes);
+            colPtr->encodingPtr->codes = codes;
+        }
+        if (colPtr->chunks != NULL) {
+            Row *rowPtr;
+            Value **chunks;
+            long i;
+
+            chunks = NULL;
+            if (rowsPtr->numUsed > 0) {
+                chunks = AllocChunks(rowsPtr->numUsed);
+                i = 0;
+                for (rowPtr = rowsPtr->headPtr; rowPtr != NULL;
+                     rowPtr = rowPtr->nextPtr) {
+                    *ChunkValue(chunks, i) = 
+                        *ColumnValue(colPtr, rowPtr->offset);
+                    i++;
+                }
+            }
+            /* The values were moved, so only the chunks are freed. */
+            FreeChunks(colPtr->chunks, rowsPtr->numAllocated);
+            colPtr->chunks = chunks;
+        }
+    }
+    {
+        size_t count;
+        Row *rowPtr;
+        
+        /* Move the row tag bits to the new offsets first. */
+        RemapRowTags(tablePtr->corePtr, FALSE);
+        FreeRowOffsetMap(rowsPtr);
+        count = 0;
+        for (rowPtr = rowsPtr->headPtr; rowPtr != NULL;
+             rowPtr = rowPtr->nextPtr) {
+            rowPtr->offset = count;
+            rowPtr->index = count;
+            count++;
+        }
+        assert(count == rowsPtr->numUsed);
+        if (count > 0) {
+            Row **map;
+            
+            /* Resize the row map to the exact number of rows. */
+            if (rowsPtr->map == NULL) {
+                map = Blt_Malloc(sizeof(Row *) * count);
+            } else {
+                map = Blt_Realloc(rowsPtr->map, sizeof(Row *) * count);
+            }
+            rowsPtr->map = map;
+            rowsPtr->numAllocated = count;
+        }
+        if (rowsPtr->freeList != NULL) {
+            /* Dump the free list. */
+            Blt_Chain_Destroy(rowsPtr->freeList);
+            rowsPtr->freeList = Blt_Chain_Create();
+        }
+    }
+    {
+        size_t count;
+        Column *colPtr;
+        
+        count = 0;
+        for (colPtr = columnsPtr->headPtr; colPtr != NULL;
+             colPtr = colPtr->nextPtr) {
+            count++;
+        }
+        assert(count == columnsPtr->numUsed);
+        if (count > 0) {
+            Column **map;
+
+            /* Resize the column map to the exact number of columns. */
+            if (columnsPtr->map == NULL) {
+                map = Blt_Malloc(sizeof(Column *) * count);
+            } else {
+                map = Blt_Realloc(columnsPtr->map, sizeof(Column *) * count);
+            }
+            columnsPtr->map = map;
+            columnsPtr->numAllocated = count;
         }
-        return TCL_ERROR;
-    }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    ResetValue(valuePtr);
-    valuePtr->datum.l = (long)value;
-    valuePtr->length = sprintf(string, "%d", value);
-    if (strlen(string) >= TABLE_VALUE_LENGTH) {
-        valuePtr->string = Blt_AssertStrdup(string);
-    } else {
-        strcpy(valuePtr->store, string);
-        valuePtr->string = valuePtr->store;
     }
-    /* Indicate the keytables need to be regenerated. */
-    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    if (tablePtr->corePtr->bindings != NULL) {
+        Blt_ChainLink link;
+
+        /* The rows are now in storage order, so bound vectors can hold
+         * the column's view. */
+        for (link = Blt_Chain_FirstLink(tablePtr->corePtr->bindings); 
+             link != NULL; link = Blt_Chain_NextLink(link)) {
+            RefreshBinding(Blt_Chain_GetValue(link));
+        }
     }
-    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_int64 --
+ * blt_table_create_index --
  *
- *      Sets the int64_t value of the selected row, column location in the
- *      table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  The column type must be "integer" or
- *      "string", otherwise an error is returned.
+ *      Creates a secondary index on the given column.  The index is
+ *      either a hash index (equality lookups) or an ordered index
+ *      (equality and range lookups).  Any existing index on the column is
+ *      replaced.
  *
  * Results:
  *      Returns a standard TCL result.
  *
- * Side Effects:
- *      New tuples may be allocated created.
- *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_set_int64(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                   Column *colPtr, int64_t value)
+blt_table_create_index(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+                       int type)
 {
-    Value *valuePtr;
-    char string[200];
+    TableIndex *indexPtr;
 
-    if ((colPtr->type != TABLE_COLUMN_TYPE_INT64) &&
-        (colPtr->type != TABLE_COLUMN_TYPE_STRING)) {
+    if ((type != TABLE_INDEX_HASH) && (type != TABLE_INDEX_ORDERED)) {
         if (interp != NULL) {
-            Tcl_AppendResult(interp, "wrong column type \"",
-                             blt_table_column_type_to_name(colPtr->type), 
-                             "\": should be \"int64\"", (char *)NULL);
+            Tcl_AppendResult(interp, "unknown index type \"", Blt_Itoa(type),
+                             "\"", (char *)NULL);
         }
         return TCL_ERROR;
     }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    ResetValue(valuePtr);
-    valuePtr->datum.i64 = value;
-    valuePtr->length = sprintf(string, "%" PRId64, value);
-    if (strlen(string) >= TABLE_VALUE_LENGTH) {
-        valuePtr->string = Blt_AssertStrdup(string);
-    } else {
-        strcpy(valuePtr->store, string);
-        valuePtr->string = TABLE_VALUE_STORE;
+    if (colPtr->type == TABLE_COLUMN_TYPE_BLOB) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't index column \"", colPtr->label,
+                             "\": column is type blob", (char *)NULL);
+        }
+        return TCL_ERROR;
     }
-    /* Indicate the keytables need to be regenerated. */
-    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    if (IsBoundColumn(interp, colPtr, "index")) {
+        return TCL_ERROR;
     }
+    /* Indexes refer to the column's values, so packed columns are
+     * unpacked and encoded columns are decoded. */
+    UnpackColumn(tablePtr, colPtr);
+    DecodeColumn(tablePtr, colPtr);
+    FreeIndex(colPtr);
+    indexPtr = Blt_AssertCalloc(1, sizeof(TableIndex));
+    indexPtr->type = type;
+    indexPtr->flags = TABLE_INDEX_DIRTY;
+    colPtr->indexPtr = indexPtr;
+    BuildIndex(tablePtr, colPtr);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_string_rep --
- *
- *      Sets the value of the selected row, column location in the table.
- *      The row, column location must be within the actual table limits.
- *
- * Results:
- *      Returns a standard TCL result.
+ * blt_table_delete_index --
  *
- * Side Effects:
- *      New tuples may be allocated created.
+ *      Removes the secondary index, if one exists, from the column.
  *
  *---------------------------------------------------------------------------
  */
-int
-blt_table_set_string_rep(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                         Column *colPtr, const char *string, int length)
+void
+blt_table_delete_index(Table *tablePtr, Column *colPtr)
 {
-    Value *valuePtr;
-
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    ResetValue(valuePtr);
-    if (SetValueFromString(interp, colPtr->type, string, length, valuePtr)
-        != TCL_OK) {
-        return TCL_ERROR;
-    }
-    /* Indicate the keytables need to be regenerated. */
-    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        tablePtr->flags |= TABLE_KEYS_DIRTY;
-    }
-    return TCL_OK;
+    FreeIndex(colPtr);
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_string --
+ * blt_table_index_type --
  *
- *      Sets the string value of the selected row, column location in the
- *      table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  The column type must be "string",
- *      otherwise an error is returned.
+ *      Returns the type of the secondary index on the column.
  *
  * Results:
- *      Returns a standard TCL result.
- *
- * Side Effects:
- *      New tuples may be allocated created.
+ *      Returns TABLE_INDEX_HASH, TABLE_INDEX_ORDERED, or TABLE_INDEX_NONE
+ *      if the column isn't indexed.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_set_string(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                     Column *colPtr, const char *string, int length)
+blt_table_index_type(Column *colPtr)
 {
-    if (colPtr->type != TABLE_COLUMN_TYPE_STRING) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "column \"", colPtr->label, 
-                         "\" is not type string.", (char *)NULL);
-        }
-        return TCL_ERROR;
+    if (colPtr->indexPtr == NULL) {
+        return TABLE_INDEX_NONE;
     }
-    return blt_table_set_string_rep(interp, tablePtr, rowPtr, colPtr, string,
-        length);
+    return colPtr->indexPtr->type;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_append_string --
+ * blt_table_index_lookup --
  *
- *      Append the string value of the selected row, column location in the
- *      table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  After the string is appended, the column 
- *      is reconverted to its designated type.
+ *      Finds the rows whose value in the indexed column is equal to the
+ *      given value.  The value is first converted to the column's type.
  *
  * Results:
- *      Returns a standard TCL result.
- *
- * Side Effects:
- *      New tuples may be allocated created.
+ *      Returns a standard TCL result.  The matching rows are appended to
+ *      the given chain.  Rows from a hash index are in no particular
+ *      order.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_append_string(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr, 
-                       Column *colPtr, const char *s, int length)
+blt_table_index_lookup(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+                       Tcl_Obj *objPtr, Blt_Chain chain)
 {
-    Value *valuePtr;
-    long l;
-    double d;
-    Tcl_Obj *objPtr;
+    TableIndex *indexPtr;
+    Value value;
 
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    if (IsEmptyValue(valuePtr)) {
-        objPtr = Tcl_NewStringObj(s, length);
-    } else {
-        objPtr = Tcl_NewStringObj(GetValueString(valuePtr),
-                                  GetValueLength(valuePtr));
-        Tcl_AppendToObj(objPtr, s, length);
-    }
-    Tcl_IncrRefCount(objPtr);
-    switch (colPtr->type) {
-    case TABLE_COLUMN_TYPE_TIME:        /* Time: is a double */
-        if (Blt_GetTimeFromObj(interp, objPtr, &d) != TCL_OK) {
-            Tcl_DecrRefCount(objPtr);
-            return TCL_ERROR;
+    indexPtr = colPtr->indexPtr;
+    if (indexPtr == NULL) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "column \"", colPtr->label, 
+                             "\" isn't indexed", (char *)NULL);
         }
-        valuePtr->datum.d = d;
-        break;
+        return TCL_ERROR;
+    }
+    if (indexPtr->flags & TABLE_INDEX_DIRTY) {
+        BuildIndex(tablePtr, colPtr);
+    }
+    memset(&value, 0, sizeof(Value));
+    if (SetValueFromObj(interp, colPtr->type, objPtr, &value) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (indexPtr->type == TABLE_INDEX_HASH) {
+        Blt_HashEntry *hPtr;
 
-    case TABLE_COLUMN_TYPE_DOUBLE:      /* double */
-        if (Blt_GetDoubleFromObj(interp, objPtr, &d) != TCL_OK) {
-            Tcl_DecrRefCount(objPtr);
-            return TCL_ERROR;
-        }
-        valuePtr->datum.d = d;
-        break;
-    case TABLE_COLUMN_TYPE_BOOLEAN:      /* boolean */
-        {
-            int ival;
-            
-            if (Tcl_GetBooleanFromObj(interp, objPtr, &ival) != TCL_OK) {
-                Tcl_DecrRefCount(objPtr);
-                return TCL_ERROR;
+        hPtr = GetIndexEntry(indexPtr, &value, FALSE);
+        if (hPtr != NULL) {
+            Blt_HashTable *rowTablePtr;
+            Blt_HashEntry *hPtr2;
+            Blt_HashSearch iter;
+
+            rowTablePtr = Blt_GetHashValue(hPtr);
+            for (hPtr2 = Blt_FirstHashEntry(rowTablePtr, &iter); 
+                 hPtr2 != NULL; hPtr2 = Blt_NextHashEntry(&iter)) {
+                Blt_Chain_Append(chain, Blt_GetHashKey(rowTablePtr, hPtr2));
             }
-            valuePtr->datum.l = ival;
-        }
-        break;
-    case TABLE_COLUMN_TYPE_LONG:        /* long */
-        if (Blt_GetLongFromObj(interp, objPtr, &l) != TCL_OK) {
-            Tcl_DecrRefCount(objPtr);
-            return TCL_ERROR;
         }
-        valuePtr->datum.l = l;
-        break;
-    default:                            /* string. */
-        break;
-    }
-    s = Tcl_GetStringFromObj(objPtr, &length);
-    ResetValue(valuePtr);
-    if (length >= TABLE_VALUE_LENGTH) {
-        valuePtr->string = Blt_Strndup(s, length + 1);
-        valuePtr->length = length;
     } else {
-        strncpy(valuePtr->store, s, length);
-        valuePtr->store[length] = '\0';
-        valuePtr->string = TABLE_VALUE_STORE;
-        valuePtr->length = length;
-    }
-    Tcl_DecrRefCount(objPtr);
+        long first, last;
 
-    /* Indicate the keytables need to be regenerated. */
-    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        tablePtr->flags |= TABLE_KEYS_DIRTY;
+        first = SearchIndex(indexPtr, colPtr, &value, NULL, TRUE);
+        last = SearchIndex(indexPtr, colPtr, &value, NULL, FALSE);
+        for (/*empty*/; first < last; first++) {
+            Blt_Chain_Append(chain, indexPtr->rows[first]);
+        }
     }
+    ResetValue(&value);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_double --
+ * blt_table_index_range --
  *
- *      Sets the double value of the selected row, column location in the
- *      table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  The column type must be "double", "time",
- *      or "string", otherwise an error is returned.
+ *      Finds the rows whose value in the column lies between the minimum
+ *      and maximum values (inclusive).  If either value is NULL, the range
+ *      is unbounded on that side.  NaNs are ordered after all numbers and
+ *      are only found if neither value is given.  The column must have an
+ *      ordered index.
  *
  * Results:
- *      Returns a standard TCL result.
+ *      Returns a standard TCL result.  The matching rows are appended to
+ *      the given chain in increasing order of their values.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_set_double(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                     Column *colPtr, double value)
+blt_table_index_range(Tcl_Interp *interp, Table *tablePtr, Column *colPtr, 
+                      Tcl_Obj *minObjPtr, Tcl_Obj *maxObjPtr, Blt_Chain chain)
 {
-    Value *valuePtr;
+    TableIndex *indexPtr;
+    long first, last;
 
-    if ((colPtr->type != TABLE_COLUMN_TYPE_DOUBLE) &&
-        (colPtr->type != TABLE_COLUMN_TYPE_STRING) &&
-        (colPtr->type != TABLE_COLUMN_TYPE_TIME)) {
+    indexPtr = colPtr->indexPtr;
+    if ((indexPtr == NULL) || (indexPtr->type != TABLE_INDEX_ORDERED)) {
         if (interp != NULL) {
-            Tcl_AppendResult(interp, "column \"", colPtr->label,
-                             "\" is not type double.", (char *)NULL);
+            Tcl_AppendResult(interp, "column \"", colPtr->label, 
+                             "\" doesn't have an ordered index", (char *)NULL);
         }
         return TCL_ERROR;
     }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    ResetValue(valuePtr);
-    if (!isnan(value)) {
-        char string[200];
+    if (indexPtr->flags & TABLE_INDEX_DIRTY) {
+        BuildIndex(tablePtr, colPtr);
+    }
+    first = 0;
+    last = indexPtr->numRows;
+    if (minObjPtr != NULL) {
+        Value value;
 
-        valuePtr->datum.d = value;
-        valuePtr->length = sprintf(string, "%.17g", value);
-        if (strlen(string) >= TABLE_VALUE_LENGTH) {
-            valuePtr->string = Blt_AssertStrdup(string);
-        } else {
-            strcpy(valuePtr->store, string);
-            valuePtr->string = TABLE_VALUE_STORE;
+        memset(&value, 0, sizeof(Value));
+        if (SetValueFromObj(interp, colPtr->type, minObjPtr, &value) 
+            != TCL_OK) {
+            return TCL_ERROR;
         }
+        first = SearchIndex(indexPtr, colPtr, &value, NULL, TRUE);
+        ResetValue(&value);
     }
-    /* Indicate the keytables need to be regenerated. */
-    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    if (maxObjPtr != NULL) {
+        Value value;
+
+        memset(&value, 0, sizeof(Value));
+        if (SetValueFromObj(interp, colPtr->type, maxObjPtr, &value) 
+            != TCL_OK) {
+            return TCL_ERROR;
+        }
+        last = SearchIndex(indexPtr, colPtr, &value, NULL, FALSE);
+        ResetValue(&value);
+    } else if ((minObjPtr != NULL) && 
+               ((colPtr->type == TABLE_COLUMN_TYPE_DOUBLE) ||
+                (colPtr->type == TABLE_COLUMN_TYPE_TIME))) {
+        Value value;
+
+        /* NaNs sort after all numbers, but aren't above the minimum. */
+        memset(&value, 0, sizeof(Value));
+        value.datum.d = Blt_NaN();
+        last = SearchIndex(indexPtr, colPtr, &value, NULL, TRUE);
+    }
+    for (/*empty*/; first < last; first++) {
+        Blt_Chain_Append(chain, indexPtr->rows[first]);
     }
-    CallTraces(tablePtr, rowPtr, colPtr, TABLE_TRACE_WRITES);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_set_bytes --
+ * blt_table_pack_column --
  *
- *      Sets the blob value of the selected row, column location in the
- *      table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  The column type must be "blob" or an
- *      error is returned.
+ *      Changes the column to packed storage: a dense array of numbers and
+ *      a bitmap of which rows have values.  Only double, time, long, and
+ *      int64 columns can be packed.  Packed columns don't keep the
+ *      original string representation of their values.
  *
  * Results:
- *      Returns a standard TCL result.
- *
- * Side Effects:
- *      New tuples may be allocated created.  
+ *      A standard TCL result.  If the column's type isn't numeric or the
+ *      column is indexed, TCL_ERROR is returned and an error message is
+ *      left in the interpreter.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_set_bytes(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                    Column *colPtr, const unsigned char *bytes, int numBytes)
+blt_table_pack_column(Tcl_Interp *interp, Table *tablePtr, Column *colPtr)
 {
-    Value *valuePtr;
-
-    if (colPtr->type != TABLE_COLUMN_TYPE_BLOB) {
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "column \"", colPtr->label, 
-                         "\" is not type blob.", (char *)NULL);
-        }
-        return TCL_ERROR;
-    }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    ResetValue(valuePtr);
-    if (SetValueFromString(interp, colPtr->type, (const char *)bytes, numBytes,
-                           valuePtr) != TCL_OK) {
+    if (IsReadOnly(interp, tablePtr)) {
         return TCL_ERROR;
     }
-    /* Indicate the keytables need to be regenerated. */
-    if (colPtr->flags & TABLE_COLUMN_PRIMARY_KEY) {
-        tablePtr->flags |= TABLE_KEYS_DIRTY;
+    return PackColumn(interp, tablePtr, colPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_unpack_column --
+ *
+ *      Changes a packed column back to storing a value structure for each
+ *      row.  It's not an error if the column isn't packed.
+ *
+ * Results:
+ *      Returns a standard TCL result.  If the column is bound to a vector,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+blt_table_unpack_column(Tcl_Interp *interp, Table *tablePtr, Column *colPtr)
+{
+    if ((IsReadOnly(interp, tablePtr)) || 
+        (IsBoundColumn(interp, colPtr, "unpack"))) {
+        return TCL_ERROR;
     }
+    UnpackColumn(tablePtr, colPtr);
     return TCL_OK;
 }
 
+int
+blt_table_column_is_packed(Column *colPtr)
+{
+    return ((colPtr->flags & TABLE_COLUMN_PACKED) != 0);
+}
+
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_get_string --
+ * blt_table_encode_column --
  *
- *      Retrieves the string value of the selected row, column location in
- *      the table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  The current string representation of the
- *      value is returned.
+ *      Changes the string column to dictionary encoding: each distinct
+ *      string is stored once and rows hold a small integer code.  Columns
+ *      with few distinct values use less memory and are sorted, joined,
+ *      and grouped by code.
  *
  * Results:
- *      Returns a string value.  If the value is empty, the default value 
- *      is returned.
+ *      A standard TCL result.  If the column's type isn't string or the
+ *      column is indexed, TCL_ERROR is returned and an error message is
+ *      left in the interpreter.
  *
  *---------------------------------------------------------------------------
  */
-const char *
-blt_table_get_string(Table *tablePtr, Row *rowPtr, Column *colPtr)
+int
+blt_table_encode_column(Tcl_Interp *interp, Table *tablePtr, Column *colPtr)
 {
-    Value *valuePtr;
-
-    if (IsEmpty(rowPtr, colPtr)) {
-        return NULL;
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
     }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    return GetValueString(valuePtr);
+    return EncodeColumn(interp, tablePtr, colPtr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_get_double --
- *
- *      Retrieves the double value of the selected row, column location in
- *      the table.  No checking is done the see if row and column are valid
- *      (it's assumed they are).  If the current type of the column isn't
- *      "double", the double value is computed.
+ * blt_table_decode_column --
  *
- * Results:
- *      Returns a double value.  If the value is empty, the default value 
- *      is returned (NaN).
+ *      Changes an encoded column back to storing a value structure for
+ *      each row.  It's not an error if the column isn't encoded.
  *
  *---------------------------------------------------------------------------
  */
-double
-blt_table_get_double(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                     Column *colPtr)
+void
+blt_table_decode_column(Table *tablePtr, Column *colPtr)
 {
-    Value *valuePtr;
-    double d;
+    DecodeColumn(tablePtr, colPtr);
+}
 
-    if (IsEmpty(rowPtr, colPtr)) {
-        return Blt_NaN();
-    }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    if ((colPtr->type == TABLE_COLUMN_TYPE_DOUBLE) ||
-        (colPtr->type == TABLE_COLUMN_TYPE_TIME)) {
-        return valuePtr->datum.d;
-    }
-    if (Blt_GetDouble(interp, GetValueString(valuePtr), &d) != TCL_OK) {
-        return Blt_NaN();
-    }
-    return d;
+int
+blt_table_column_is_encoded(Column *colPtr)
+{
+    return (colPtr->encodingPtr != NULL);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_get_long --
- *
- *      Retrieves the long integer value of the selected row, column
- *      location in the table.  No checking is done the see if row and
- *      column are valid (it's assumed they are).  If the current type of
- *      the column isn't "integer", the long value is computed.
+ * blt_table_encoded_code --
  *
- * Results:
- *      Returns a long value.  If the value is empty, the default value 
- *      is returned.
+ *      Returns the code of the value of an encoded column at the row.  0
+ *      is the code of an empty value.  Codes index the strings returned
+ *      by blt_table_encoded_string and are only good until the column is
+ *      decoded.
  *
  *---------------------------------------------------------------------------
  */
-long
-blt_table_get_long(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                   Column *colPtr, long defVal)
+unsigned int
+blt_table_encoded_code(Row *rowPtr, Column *colPtr)
 {
-    Value *valuePtr;
-    long l;
+    return EncodedCode(colPtr, rowPtr->offset);
+}
 
-    if (IsEmpty(rowPtr, colPtr)) {
-        return defVal;
-    }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    if (colPtr->type == TABLE_COLUMN_TYPE_LONG) {
-        return valuePtr->datum.l;
-    }
-    if (Blt_GetLong(interp, GetValueString(valuePtr), &l) != TCL_OK) {
-        return TCL_ERROR;
+/* Returns the # of codes of an encoded column, including code 0. */
+unsigned int
+blt_table_num_encoded_codes(Column *colPtr)
+{
+    return colPtr->encodingPtr->numStrings;
+}
+
+/* Returns the string with the code, or NULL for code 0. */
+const char *
+blt_table_encoded_string(Column *colPtr, unsigned int code, int *lengthPtr)
+{
+    EncodedString *strPtr;
+
+    if (code == 0) {
+        *lengthPtr = 0;
+        return NULL;
     }
-    return l;
+    strPtr = colPtr->encodingPtr->strings + code;
+    *lengthPtr = strPtr->length;
+    return strPtr->string;
+}
+
+/* Returns the code of the string in the column's dictionary, or 0 if no
+ * value of the column is the string. */
+unsigned int
+blt_table_find_encoded_code(Column *colPtr, const char *string, int length)
+{
+    return FindEncodedString(colPtr->encodingPtr, string, length, 
+                             HashString(string, length));
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_get_boolean --
+ * blt_table_bind_vector --
  *
- *      Retrieves the boolean integer value of the selected row, column
- *      location in the table.  No checking is done the see if row and
- *      column are valid (it's assumed they are).  If the current type of
- *      the column isn't "boolean", the boolean value is computed.
+ *      Binds a double column to the named vector.  The column is packed
+ *      and the vector takes a copy of the column's values, kept as the
+ *      column's view when the rows are in storage order.  From then on,
+ *      changes to either one are seen by the other.  A column is bound to at most
+ *      one vector and a vector to one column.  If the vector name is NULL
+ *      or empty, the column is unbound.
  *
  * Results:
- *      Returns a boolean value.  If the value is empty, the default value 
- *      is returned.
+ *      A standard TCL result.  An error is returned if the vector doesn't
+ *      exist, is bound to another column, or the column isn't a double
+ *      column that can be packed.
  *
  *---------------------------------------------------------------------------
  */
 int
-blt_table_get_boolean(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                      Column *colPtr, int defVal)
+blt_table_bind_vector(Tcl_Interp *interp, Table *tablePtr, Column *colPtr,
+                      const char *vecName)
 {
-    Value *valuePtr;
-    int state;
+    Blt_HashEntry *hPtr;
+    Blt_Vector *vecPtr;
+    ColumnBinding *bindPtr;
+    InterpData *dataPtr;
+    TableObject *corePtr;
+    int isNew;
 
-    if (IsEmpty(rowPtr, colPtr)) {
-        return defVal;
+    if (IsReadOnly(interp, tablePtr)) {
+        return TCL_ERROR;
     }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    if (colPtr->type == TABLE_COLUMN_TYPE_BOOLEAN) {
-        return (int)valuePtr->datum.l;
+    if ((vecName == NULL) || (vecName[0] == '\0')) {
+        blt_table_unbind_vector(tablePtr, colPtr);
+        return TCL_OK;
     }
-    if (Tcl_GetBoolean(interp, GetValueString(valuePtr), &state) != TCL_OK) {
+    if (!IsPackedDouble(colPtr)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't bind column \"", colPtr->label, 
+                "\": type \"", blt_table_column_type_to_name(colPtr->type),
+                "\" isn't double", (char *)NULL);
+        }
         return TCL_ERROR;
     }
-    return state;
+    if (Blt_GetVector(interp, vecName, &vecPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    dataPtr = GetInterpData(interp);
+    hPtr = Blt_FindHashEntry(&dataPtr->bindingTable, vecPtr);
+    if (hPtr != NULL) {
+        bindPtr = Blt_GetHashValue(hPtr);
+        if (bindPtr->colPtr == colPtr) {
+            return TCL_OK;              /* Already bound. */
+        }
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "vector \"", vecName, 
+                "\" is already bound to column \"", bindPtr->colPtr->label, 
+                "\"", (char *)NULL);
+        }
+        return TCL_ERROR;
+    }
+    if (PackColumn(interp, tablePtr, colPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (colPtr->bindPtr != NULL) {
+        FreeBinding(colPtr->bindPtr);
+    }
+    corePtr = tablePtr->corePtr;
+    bindPtr = Blt_AssertCalloc(1, sizeof(ColumnBinding));
+    bindPtr->interp = interp;
+    bindPtr->tablePtr = tablePtr;
+    bindPtr->corePtr = corePtr;
+    bindPtr->colPtr = colPtr;
+    bindPtr->vecPtr = vecPtr;
+    bindPtr->vecId = Blt_AllocVectorId(interp, vecName);
+    Blt_SetVectorChangedProc(bindPtr->vecId, VectorChangedProc, bindPtr);
+    bindPtr->dirty = Blt_VecDirty(vecPtr);
+    hPtr = Blt_CreateHashEntry(&dataPtr->bindingTable, vecPtr, &isNew);
+    Blt_SetHashValue(hPtr, bindPtr);
+    if (corePtr->bindings == NULL) {
+        corePtr->bindings = Blt_Chain_Create();
+    }
+    bindPtr->link = Blt_Chain_Append(corePtr->bindings, bindPtr);
+    colPtr->bindPtr = bindPtr;
+    SyncBinding(bindPtr);
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * blt_table_get_int64 --
- *
- *      Retrieves the 64-bit integer value of the selected row, column
- *      location in the table.  No checking is done the see if row and
- *      column are valid (it's assumed they are).  If the current type of
- *      the column isn't "int64", the int64_t value is computed.
+ * blt_table_unbind_vector --
  *
- * Results:
- *      Returns a int64_t value.  If the value is empty, the default value 
- *      is returned.
+ *      Removes the binding between the column and its vector.  The vector
+ *      keeps a copy of the column's values.  It's not an error if the
+ *      column isn't bound.
  *
  *---------------------------------------------------------------------------
  */
-int64_t
-blt_table_get_int64(Tcl_Interp *interp, Table *tablePtr, Row *rowPtr,
-                   Column *colPtr, int64_t defVal)
-{
-    Value *valuePtr;
-    int64_t i;
-
-    if (IsEmpty(rowPtr, colPtr)) {
-        return defVal;
-    }
-    valuePtr = GetValue(tablePtr, rowPtr, colPtr);
-    if (colPtr->type == TABLE_COLUMN_TYPE_INT64) {
-        return valuePtr->datum.i64;
-    }
-    if (Blt_GetInt64(interp, GetValueString(valuePtr), &i) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    return i;
-}
-
 void
-blt_table_clear(Table *tablePtr)
+blt_table_unbind_vector(Table *tablePtr, Column *colPtr)
 {
-    TableObject *corePtr;
-
-    corePtr = tablePtr->corePtr;
-    FreeColumns(corePtr);
-    FreeRows(corePtr);
-    /* Re-initialize rows and columns. */
-    Blt_InitHashTableWithPool(&corePtr->columns.labelTable, BLT_STRING_KEYS);
-    Blt_InitHashTableWithPool(&corePtr->rows.labelTable, BLT_STRING_KEYS);
-    corePtr->columns.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
-    corePtr->columns.nextColumnId = 1;
-    corePtr->rows.freeList = Blt_Chain_Create();
-    corePtr->rows.pool = Blt_Pool_Create(BLT_FIXED_SIZE_ITEMS);
-    corePtr->rows.nextRowId = 1;
+    if (colPtr->bindPtr != NULL) {
+        FreeBinding(colPtr->bindPtr);
+    }
 }
 
-void
-blt_table_pack(Table *tablePtr)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * blt_table_column_vector --
+ *
+ *      Returns the name of the vector bound to the column, or NULL if the
+ *      column isn't bound.
+ *
+ *---------------------------------------------------------------------------
+ */
+const char *
+blt_table_column_vector(Column *colPtr)
 {
-    Column *colPtr;
-    Columns *columnsPtr;
-    Rows *rowsPtr;
-
-    rowsPtr = &tablePtr->corePtr->rows;
-    columnsPtr = &tablePtr->corePtr->columns;
-    /* Replace each vector with one exactly the number of used rows.  */
-    for (colPtr = columnsPtr->headPtr; colPtr != NULL; 
-         colPtr = colPtr->nextPtr) {
-        if (colPtr->vector != NULL) {
-            Row *rowPtr;
-            Value *vector, *valuePtr;
-
-            vector = Blt_Malloc(rowsPtr->numUsed * sizeof(Value));
-            if (vector == NULL) {
-            }    
-            valuePtr = vector;
-            for (rowPtr = rowsPtr->headPtr; rowPtr != NULL;
-                 rowPtr = rowPtr->nextPtr) {
-                *valuePtr = colPtr->vector[rowPtr->offset];
-                valuePtr++;
-            }
-            Blt_Free(colPtr->vector);
-            colPtr->vector = vector;
-        }
-    }
-    {
-        size_t count;
-        Row *rowPtr;
-        
-        count = 0;
-        for (rowPtr = rowsPtr->headPtr; rowPtr != NULL;
-             rowPtr = rowPtr->nextPtr) {
-            rowPtr->offset = count;
-            rowPtr->index = count;
-            count++;
-        }
-        assert(count == rowsPtr->numUsed);
-        if (count > 0) {
-            Row **map;
-            
-            /* Resize the row map to the exact number of rows. */
-            if (rowsPtr->map == NULL) {
-                map = Blt_Malloc(sizeof(Row *) * count);
-            } else {
-                map = Blt_Realloc(rowsPtr->map, sizeof(Row *) * count);
-            }
-            rowsPtr->map = map;
-            rowsPtr->numAllocated = count;
-        }
-        if (rowsPtr->freeList != NULL) {
-            /* Dump the free list. */
-            Blt_Chain_Destroy(rowsPtr->freeList);
-            rowsPtr->freeList = Blt_Chain_Create();
-        }
-    }
-    {
-        size_t count;
-        Column *colPtr;
-        
-        count = 0;
-        for (colPtr = columnsPtr->headPtr; colPtr != NULL;
-             colPtr = colPtr->nextPtr) {
-            count++;
-        }
-        assert(count == columnsPtr->numUsed);
-        if (count > 0) {
-            Column **map;
-
-            /* Resize the column map to the exact number of columns. */
-            if (columnsPtr->map == NULL) {
-                map = Blt_Malloc(sizeof(Column *) * count);
-            } else {
-                map = Blt_Realloc(columnsPtr->map, sizeof(Column *) * count);
-            }
-            columnsPtr->map = map;
-            columnsPtr->numAllocated = count;
-        }
+    if (colPtr->bindPtr == NULL) {
+        return NULL;
     }
+    return Blt_NameOfVectorId(colPtr->bindPtr->vecId);
 }
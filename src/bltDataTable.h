@@ -111,6 +111,8 @@ struct _BLT_TABLE_ROW {
                                          * offset-to-index. */
     long offset;                        /* Index of row in column
                                          * storage. */
+    struct _BLT_TABLE_ROW *nextLabelPtr; /* Next row with the same
+                                          * label. */
     unsigned int flags;
 };
 
@@ -120,9 +122,44 @@ struct _BLT_TABLE_COLUMN {
     const char *label;                  /* Label of row or column. */
     long index;                         /* Reverse lookup
                                          * offset-to-index. */
-    BLT_TABLE_VALUE vector;
+    BLT_TABLE_VALUE *chunks;            /* Directory of chunks of values
+                                         * indexed by row offset. NULL if
+                                         * the column has no values or is
+                                         * packed. */
     BLT_TABLE_COLUMN_TYPE type;
     unsigned int flags;
+    struct _BLT_TABLE_INDEX *indexPtr;  /* Secondary index of the column's
+                                         * values. NULL if the column isn't
+                                         * indexed. */
+    union {
+        double **d;
+        int64_t **i64;
+    } packed;                           /* Packed columns: directory of
+                                         * chunks of values indexed by row
+                                         * offset. */
+    unsigned int **validMap;            /* Packed columns: bitmap of the
+                                         * row offsets that have a value,
+                                         * one per chunk. */
+    long numPacked;                     /* Packed columns: # of row
+                                         * offsets in the chunks. */
+    Blt_HashTable *packedStrings;       /* Packed columns: strings
+                                         * formatted from the values,
+                                         * keyed by row offset.  NULL if
+                                         * none have been asked for. */
+    struct _BLT_TABLE_BINDING *bindPtr; /* Vector bound to the column.
+                                         * NULL if the column isn't
+                                         * bound. */
+    struct _BLT_TABLE_STATS *statsPtr;  /* Cached statistics of the
+                                         * column's values. NULL if none
+                                         * have been computed. */
+    struct _BLT_TABLE_SHARE *sharePtr;  /* Storage shared copy-on-write
+                                         * with snapshots of the table.
+                                         * NULL if the column's storage
+                                         * isn't shared. */
+    struct _BLT_TABLE_ENCODING *encodingPtr; /* Dictionary-encoded string
+                                         * column: dictionary and codes of
+                                         * the values. NULL if the column
+                                         * isn't encoded. */
 };
 
 /*
@@ -139,8 +176,15 @@ typedef struct _BLT_TABLE_ROWS {
                                          * rows used. */
     long numUsed;
     BLT_TABLE_ROW *map;                 /* Array of row pointers. */
+    BLT_TABLE_ROW *offsetMap;           /* Array of row pointers indexed
+                                         * by row offset.  Built on demand
+                                         * to walk row tags.  NULL if not
+                                         * built. */
     Blt_HashTable labelTable;           /* Hash table of labels. Maps
-                                         * labels to table offsets. */
+                                         * labels to the first row with
+                                         * the label.  Other rows with the
+                                         * same label are linked through
+                                         * their nextLabelPtr fields. */
     long nextRowId;                     /* Used to generate default
                                          * row labels. */
     Blt_Chain freeList;                 /* List of free rows. */
@@ -197,11 +241,11 @@ typedef struct _BLT_TABLE_ROWCOLUMN {
  *      the clients of a core table object have released their tokens, the
  *      table object is automatically destroyed.
  *
- *      The table object is an array of column vectors. Each vector is an
- *      array of BLT_TABLE_VALUE's, representing the data for the column.
- *      Empty row entries are designated by 0 length values.  Column
- *      vectors are allocated when needed.  Every column in the table has
- *      the same length.
+ *      The table object is an array of columns. Each column holds
+ *      BLT_TABLE_VALUE's, representing the data for the column, in
+ *      fixed-size chunks.  Empty row entries are designated by 0 length
+ *      values.  Column chunks are allocated when needed.  Every column in
+ *      the table has the same length.
  *
  *      Rows and columns are indexed by a map of pointers to headers.  This
  *      map represents the order of the rows or columns, not how the values
@@ -218,6 +262,14 @@ typedef struct _BLT_TABLE_CORE {
     unsigned int notifyFlags;           /* Notification flags. See
                                          * definitions below. */
     int notifyHold;
+    Blt_Chain snapshots;                /* Binary snapshots whose pages
+                                         * back packed columns.  NULL if
+                                         * there are none. */
+    Blt_Chain bindings;                 /* Columns bound to vectors.  NULL
+                                         * if there are none. */
+    struct _BLT_TABLE_VALUE scratch;    /* Value formatted from a packed
+                                         * cell by blt_table_get_value.
+                                         * Reused by the next call. */
 } BLT_TABLE_CORE;
 
 #ifndef _BLT_TAGS_H
@@ -269,7 +321,9 @@ typedef struct _BLT_TABLE {
     Blt_ChainLink link2;                /* Pointer into the list of clients
                                          * using the same table name. */
 
-    Blt_Tags rowTags;
+    Blt_HashTable *rowTags;             /* Row tags of this client.  Maps
+                                         * tag names to bitmaps of row
+                                         * offsets. */
     Blt_Tags columnTags;
 
     Blt_HashTable traces;               /* Hash table of valid traces */
@@ -291,6 +345,10 @@ typedef struct _BLT_TABLE {
                                          * lookups. */
     int numKeys;                        /* # of primary keys. */
 
+    struct _TableBatch *batchPtr;       /* If non-NULL, traces and notifier
+                                         * events generated by this client
+                                         * are deferred until the batch
+                                         * ends. */
     unsigned int flags;
 } *BLT_TABLE;
 
@@ -374,6 +432,16 @@ BLT_EXTERN const char *blt_table_get_string(BLT_TABLE table,
 BLT_EXTERN int blt_table_set_string_rep(Tcl_Interp *interp, BLT_TABLE table,
         BLT_TABLE_ROW row, BLT_TABLE_COLUMN column, const char *string,
         int length);
+BLT_EXTERN int blt_table_set_string_reps(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE_COLUMN col, size_t numValues, BLT_TABLE_ROW *rows,
+        const char **strings, const int *lengths);
+BLT_EXTERN int blt_table_set_packed_values(Tcl_Interp *interp, 
+        BLT_TABLE table, BLT_TABLE_COLUMN col, size_t numValues, 
+        BLT_TABLE_ROW *rows, const void *values, 
+        const unsigned char *validBits);
+BLT_EXTERN size_t blt_table_get_packed_values(BLT_TABLE table, 
+        BLT_TABLE_COLUMN col, size_t numValues, BLT_TABLE_ROW *rows, 
+        void *values, unsigned char *validBits);
 BLT_EXTERN int blt_table_set_string(Tcl_Interp *interp, BLT_TABLE table,
         BLT_TABLE_ROW row, BLT_TABLE_COLUMN column, const char *string,
         int length);
@@ -511,6 +579,7 @@ typedef struct _BLT_TABLE_ITERATOR {
     long numEntries;
 
     /* For tag-based searches. */
+    void *rowTagPtr;                    /* Row tag bitmap being searched. */
     Blt_HashTable *tablePtr;            /* Pointer to tag hash table. */
     Blt_HashSearch cursor;              /* Iterator for tag hash table. */
 
@@ -801,6 +870,9 @@ BLT_EXTERN BLT_TABLE_NOTIFIER blt_table_create_column_tag_notifier(
 BLT_EXTERN void blt_table_delete_notifier(BLT_TABLE table, 
         BLT_TABLE_NOTIFIER notifier);
 
+BLT_EXTERN void blt_table_begin_batch(BLT_TABLE table);
+BLT_EXTERN void blt_table_end_batch(BLT_TABLE table);
+
 /*
  * BLT_TABLE_SORT_ORDER --
  *
@@ -838,6 +910,10 @@ BLT_EXTERN BLT_TABLE_ROW *blt_table_sort_rows(BLT_TABLE table);
 BLT_EXTERN void blt_table_sort_row_map(BLT_TABLE table, long numRows, 
         BLT_TABLE_ROW *rows);
 BLT_EXTERN void blt_table_sort_finish(void);
+
+BLT_EXTERN void blt_table_sort_rows_by_order(BLT_TABLE table, 
+        BLT_TABLE_SORT_ORDER *order, size_t numColumns, unsigned int flags,
+        size_t numRows, BLT_TABLE_ROW *rows);
 BLT_EXTERN BLT_TABLE_COMPARE_PROC *blt_table_get_compare_proc(BLT_TABLE table, 
         BLT_TABLE_COLUMN column, unsigned int flags);
 
@@ -854,6 +930,9 @@ BLT_EXTERN int blt_table_restore(Tcl_Interp *interp, BLT_TABLE table,
         char *string, unsigned int flags);
 BLT_EXTERN int blt_table_file_restore(Tcl_Interp *interp, BLT_TABLE table, 
         const char *fileName, unsigned int flags);
+BLT_EXTERN int blt_table_file_dump_binary(Tcl_Interp *interp, BLT_TABLE table,
+        const char *fileName, BLT_TABLE_ITERATOR *rowIterPtr, 
+        BLT_TABLE_ITERATOR *colIterPtr);
 
 typedef int (BLT_TABLE_IMPORT_PROC)(BLT_TABLE table, Tcl_Interp *interp, 
         int objc, Tcl_Obj *const *objv);
@@ -871,9 +950,110 @@ BLT_EXTERN int blt_table_set_keys(BLT_TABLE table, int numKeys,
 BLT_EXTERN int blt_table_key_lookup(Tcl_Interp *interp, BLT_TABLE table,
         int objc, Tcl_Obj *const *objv, BLT_TABLE_ROW *rowPtr);
 
+#define TABLE_INDEX_NONE        0
+#define TABLE_INDEX_HASH        1       /* Equality lookups. */
+#define TABLE_INDEX_ORDERED     2       /* Equality and range lookups. */
+
+BLT_EXTERN int blt_table_create_index(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE_COLUMN col, int type);
+BLT_EXTERN void blt_table_delete_index(BLT_TABLE table, BLT_TABLE_COLUMN col);
+BLT_EXTERN int blt_table_index_type(BLT_TABLE_COLUMN col);
+BLT_EXTERN int blt_table_index_lookup(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE_COLUMN col, Tcl_Obj *objPtr, Blt_Chain chain);
+BLT_EXTERN int blt_table_index_range(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE_COLUMN col, Tcl_Obj *minObjPtr, Tcl_Obj *maxObjPtr,
+        Blt_Chain chain);
+
+BLT_EXTERN int blt_table_pack_column(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE_COLUMN col);
+BLT_EXTERN int blt_table_unpack_column(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE_COLUMN col);
+BLT_EXTERN int blt_table_column_is_packed(BLT_TABLE_COLUMN col);
+
+BLT_EXTERN int blt_table_encode_column(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE_COLUMN col);
+BLT_EXTERN void blt_table_decode_column(BLT_TABLE table, BLT_TABLE_COLUMN col);
+BLT_EXTERN int blt_table_column_is_encoded(BLT_TABLE_COLUMN col);
+BLT_EXTERN unsigned int blt_table_encoded_code(BLT_TABLE_ROW row, 
+        BLT_TABLE_COLUMN col);
+BLT_EXTERN unsigned int blt_table_num_encoded_codes(BLT_TABLE_COLUMN col);
+BLT_EXTERN const char *blt_table_encoded_string(BLT_TABLE_COLUMN col, 
+        unsigned int code, int *lengthPtr);
+BLT_EXTERN unsigned int blt_table_find_encoded_code(BLT_TABLE_COLUMN col, 
+        const char *string, int length);
+
+BLT_EXTERN int blt_table_bind_vector(Tcl_Interp *interp, BLT_TABLE table, 
+        BLT_TABLE_COLUMN col, const char *vecName);
+BLT_EXTERN void blt_table_unbind_vector(BLT_TABLE table, BLT_TABLE_COLUMN col);
+BLT_EXTERN const char *blt_table_column_vector(BLT_TABLE_COLUMN col);
+
 BLT_EXTERN int blt_table_get_column_limits(Tcl_Interp *interp, BLT_TABLE table, 
         BLT_TABLE_COLUMN col, Tcl_Obj **minObjPtrPtr, Tcl_Obj **maxObjPtrPtr);
 
+/*
+ * BLT_TABLE_COLUMN_STATS --
+ *
+ *      Statistics of the values in a column.  The minimum and maximum are
+ *      new objects, or NULL if the column has no values.  The sum is only
+ *      computed for numeric columns.
+ */
+typedef struct {
+    long numValues;                     /* # of non-empty values. */
+    long numEmpty;                      /* # of empty values. */
+    long numDistinct;                   /* Estimated # of distinct
+                                         * values. */
+    int isNumeric;                      /* Indicates if the sum is
+                                         * valid. */
+    double sum;                         /* Sum of the values. */
+    Tcl_Obj *minObjPtr, *maxObjPtr;     /* Minimum and maximum values. */
+} BLT_TABLE_COLUMN_STATS;
+
+BLT_EXTERN int blt_table_get_column_stats(Tcl_Interp *interp, BLT_TABLE table, 
+        BLT_TABLE_COLUMN col, BLT_TABLE_COLUMN_STATS *statsPtr);
+
+#define TABLE_JOIN_INNER        0       /* Only rows with a match. */
+#define TABLE_JOIN_LEFT         1       /* Every row of the first table. */
+
+BLT_EXTERN int blt_table_join(Tcl_Interp *interp, BLT_TABLE table,
+        BLT_TABLE other, size_t numKeys, BLT_TABLE_COLUMN *keys,
+        BLT_TABLE_COLUMN *otherKeys, int how, const char *suffix,
+        BLT_TABLE dest);
+
+#define TABLE_AGGREGATE_SUM     0
+#define TABLE_AGGREGATE_MEAN    1
+#define TABLE_AGGREGATE_COUNT   2
+#define TABLE_AGGREGATE_MIN     3
+#define TABLE_AGGREGATE_MAX     4
+
+typedef struct {
+    BLT_TABLE_COLUMN col;               /* Column to aggregate. */
+    int op;                             /* Aggregate function. */
+} BLT_TABLE_AGGREGATE;
+
+BLT_EXTERN int blt_table_aggregate(Tcl_Interp *interp, BLT_TABLE table,
+        size_t numKeys, BLT_TABLE_COLUMN *keys, size_t numAggregates,
+        BLT_TABLE_AGGREGATE *aggregates, BLT_TABLE dest);
+
+BLT_EXTERN int blt_table_snapshot(Tcl_Interp *interp, BLT_TABLE table,
+        const char *name, BLT_TABLE *snapPtr);
+BLT_EXTERN int blt_table_is_snapshot(BLT_TABLE table);
+
+/*
+ * BLT_TABLE_WORKER_PROC --
+ *
+ *      Called for each chunk of items split among worker threads.  Worker
+ *      procedures may only read plain C data: they must not call TCL or
+ *      change the table.
+ */
+typedef void (BLT_TABLE_WORKER_PROC)(ClientData clientData, long first,
+        long last, int worker);
+
+BLT_EXTERN void blt_table_set_threads(Tcl_Interp *interp, int numThreads);
+BLT_EXTERN int blt_table_get_threads(Tcl_Interp *interp);
+BLT_EXTERN int blt_table_num_workers(BLT_TABLE table, long numItems);
+BLT_EXTERN void blt_table_run_workers(int numWorkers, long numItems, 
+        BLT_TABLE_WORKER_PROC *proc, ClientData clientData);
+
 BLT_EXTERN BLT_TABLE_ROW blt_table_row(BLT_TABLE table, long index);
 BLT_EXTERN BLT_TABLE_COLUMN blt_table_column(BLT_TABLE table, long index);
 BLT_EXTERN long blt_table_row_index(BLT_TABLE table, BLT_TABLE_ROW row);
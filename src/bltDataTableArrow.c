@@ -0,0 +1,2195 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *
+ * bltDataTableArrow.c --
+ *
+ * Copyright 2015 George A. Howlett. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are
+ *   met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *   4) Products derived from this software may not be called "BLT" nor may
+ *      "BLT" appear in their names without specific prior written
+ *      permission from the author.
+ *
+ *   THIS SOFTWARE IS PROVIDED ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ *   WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ *   BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ *   OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ *   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <bltInt.h>
+#ifndef NO_DATATABLE
+
+#ifdef HAVE_MEMORY_H
+  #include <memory.h>
+#endif /* HAVE_MEMORY_H */
+
+#ifdef HAVE_STDLIB_H
+  #include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+
+#include <limits.h>
+#include <math.h>
+
+DLLEXPORT extern Tcl_AppInitProc blt_table_arrow_init;
+DLLEXPORT extern Tcl_AppInitProc blt_table_arrow_safe_init;
+
+#define TRUE    1
+#define FALSE   0
+
+#define DEF_BATCH_SIZE          (1<<16) /* # of rows in each record batch
+                                         * written. */
+
+/*
+ * Arrow IPC format.
+ *
+ *      The file format is the magic string "ARROW1" padded to 8 bytes,
+ *      a stream of messages, and a footer:
+ *
+ *      magic           "ARROW1\0\0"
+ *      messages        Schema message, then a RecordBatch message for
+ *                      each batch of rows.
+ *      end of stream   0xFFFFFFFF 0x00000000
+ *      footer          Footer flatbuffer: the schema again and the
+ *                      location of each record batch.
+ *      trailer         int32 length of the footer, "ARROW1"
+ *
+ *      Each message is a continuation marker (0xFFFFFFFF), the int32
+ *      length of its metadata, the Message flatbuffer padded to 8 bytes,
+ *      and the message body.  The body of a record batch holds the
+ *      buffers of each column: a validity bitmap (least significant bit
+ *      first) and either a value array, a bitmap of booleans, or int32
+ *      offsets into an array of string bytes.  Buffers are aligned on
+ *      8-byte boundaries.  Data buffers are in the byte order given by
+ *      the schema.
+ *
+ *      The streaming format is the same messages without the magic
+ *      strings or footer.  Both are read; the file format is written.
+ *
+ *      Flatbuffers are little-endian.  A table starts with the signed
+ *      offset of its vtable, a list of uint16 field offsets.  Fields
+ *      referring to strings, vectors, and tables hold the unsigned offset
+ *      of the object from the field.  The buffer starts with the offset
+ *      of its root table.  Tables are written with their children after
+ *      them, so that offsets always point forward.
+ */
+#define ARROW_MAGIC             "ARROW1"
+#define ARROW_MAGIC_LENGTH      6
+#define ARROW_CONTINUATION      0xFFFFFFFF
+#define ARROW_METADATA_V4       3
+#define ARROW_METADATA_V5       4
+
+/* Message header types. */
+#define ARROW_MESG_SCHEMA       1
+#define ARROW_MESG_DICTIONARY   2
+#define ARROW_MESG_RECORDBATCH  3
+
+/* Field types. */
+#define ARROW_TYPE_NULL         1
+#define ARROW_TYPE_INT          2
+#define ARROW_TYPE_FLOAT        3
+#define ARROW_TYPE_BINARY       4
+#define ARROW_TYPE_UTF8         5
+#define ARROW_TYPE_BOOL         6
+#define ARROW_TYPE_DATE         8
+#define ARROW_TYPE_TIMESTAMP    10
+#define ARROW_TYPE_LARGEBINARY  19
+#define ARROW_TYPE_LARGEUTF8    20
+
+/* FloatingPoint precisions. */
+#define ARROW_PRECISION_SINGLE  1
+#define ARROW_PRECISION_DOUBLE  2
+
+/* Timestamp units. */
+#define ARROW_UNIT_SECOND       0
+#define ARROW_UNIT_MILLI        1
+#define ARROW_UNIT_MICRO        2
+#define ARROW_UNIT_NANO         3
+
+/* Date units. */
+#define ARROW_DATE_DAY          0
+#define ARROW_DATE_MILLI        1
+
+#ifdef WORDS_BIGENDIAN
+  #define ARROW_ENDIANNESS      1
+#else
+  #define ARROW_ENDIANNESS      0
+#endif /* WORDS_BIGENDIAN */
+
+/*
+ * FlatBuffer --
+ *
+ *      Flatbuffer being read.  Every offset is checked against its size.
+ */
+typedef struct {
+    const unsigned char *bytes;
+    size_t size;
+} FlatBuffer;
+
+/*
+ * FbTable --
+ *
+ *      Table in a flatbuffer being read.
+ */
+typedef struct {
+    const FlatBuffer *fbPtr;
+    size_t table;                       /* Offset of the table. */
+    size_t vtable;                      /* Offset of its vtable. */
+    size_t vtableSize;
+    size_t tableSize;
+} FbTable;
+
+/*
+ * FbField --
+ *
+ *      Field of a table being written.  Scalar fields hold their value.
+ *      The offset of each field in the buffer is filled in when the table
+ *      is written, so that fields referring to other objects can be set
+ *      once those are written.
+ */
+typedef struct {
+    int id;                             /* Index of the field in the
+                                         * table's schema. */
+    int size;                           /* Size of the field: 1, 2, 4, or 8
+                                         * bytes. */
+    int64_t value;                      /* Value of a scalar field. */
+    size_t pos;                         /* Offset of the field in the
+                                         * buffer. */
+} FbField;
+
+/*
+ * ArrowField --
+ *
+ *      Column described by the schema being read.
+ */
+typedef struct {
+    int type;                           /* Arrow type of the field. */
+    int bitWidth;                       /* Int: # of bits. */
+    int isSigned;                       /* Int: indicates if signed. */
+    int precision;                      /* FloatingPoint: precision. */
+    int unit;                           /* Timestamp, Date: unit. */
+    BLT_TABLE_COLUMN col;               /* Column holding the values. */
+} ArrowField;
+
+/*
+ * ArrowReader --
+ */
+typedef struct {
+    const unsigned char *bytes;         /* Arrow data. */
+    size_t numBytes;                    /* # of bytes of data. */
+    ArrowField *fields;                 /* Columns of the schema. NULL
+                                         * until the schema is read. */
+    long numFields;
+} ArrowReader;
+
+/*
+ * ArrowBlock --
+ *
+ *      Location of a record batch in the file, kept for the footer.
+ */
+typedef struct {
+    int64_t offset;                     /* Offset of the message. */
+    int32_t metaLength;                 /* Length of the metadata,
+                                         * including its prefix. */
+    int64_t bodyLength;                 /* Length of the body. */
+} ArrowBlock;
+
+/*
+ * ArrowWriter --
+ */
+typedef struct {
+    Tcl_Channel channel;                /* If non-NULL, channel to write
+                                         * output to. */
+    Blt_DBuffer dbuffer;                /* Otherwise the output is
+                                         * collected here. */
+    int64_t offset;                     /* Current offset in the output. */
+    int error;                          /* Indicates a write failed. */
+} ArrowWriter;
+
+/*
+ * ImportArgs --
+ */
+typedef struct {
+    Tcl_Obj *fileObjPtr;                /* Name of file or channel to
+                                         * read from. */
+    Tcl_Obj *dataObjPtr;                /* If non-NULL, byte array to use
+                                         * as input. */
+} ImportArgs;
+
+static Blt_SwitchSpec importSwitches[] =
+{
+    {BLT_SWITCH_OBJ,    "-data",      "bytes", (char *)NULL,
+        Blt_Offset(ImportArgs, dataObjPtr), 0, 0, NULL},
+    {BLT_SWITCH_OBJ,    "-file",      "fileName", (char *)NULL,
+        Blt_Offset(ImportArgs, fileObjPtr), 0},
+    {BLT_SWITCH_END}
+};
+
+/*
+ * ExportArgs --
+ */
+typedef struct {
+    BLT_TABLE_ITERATOR ri, ci;
+    Tcl_Obj *fileObjPtr;                /* If non-NULL, file or channel
+                                         * to write to. */
+    long batchSize;                     /* # of rows in each record
+                                         * batch. */
+} ExportArgs;
+
+static Blt_SwitchFreeProc ColumnIterFreeProc;
+static Blt_SwitchParseProc ColumnIterSwitchProc;
+static Blt_SwitchCustom columnIterSwitch = {
+    ColumnIterSwitchProc, NULL, ColumnIterFreeProc, 0,
+};
+static Blt_SwitchFreeProc RowIterFreeProc;
+static Blt_SwitchParseProc RowIterSwitchProc;
+static Blt_SwitchCustom rowIterSwitch = {
+    RowIterSwitchProc, NULL, RowIterFreeProc, 0,
+};
+
+static Blt_SwitchSpec exportSwitches[] =
+{
+    {BLT_SWITCH_LONG_POS, "-batchsize", "numRows", (char *)NULL,
+        Blt_Offset(ExportArgs, batchSize), 0},
+    {BLT_SWITCH_CUSTOM, "-columns",   "columns" ,(char *)NULL,
+        Blt_Offset(ExportArgs, ci),   0, 0, &columnIterSwitch},
+    {BLT_SWITCH_OBJ,    "-file",      "fileName", (char *)NULL,
+        Blt_Offset(ExportArgs, fileObjPtr), 0},
+    {BLT_SWITCH_CUSTOM, "-rows",      "rows", (char *)NULL,
+        Blt_Offset(ExportArgs, ri),   0, 0, &rowIterSwitch},
+    {BLT_SWITCH_END}
+};
+
+static BLT_TABLE_IMPORT_PROC ImportArrowProc;
+static BLT_TABLE_EXPORT_PROC ExportArrowProc;
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnIterFreeProc --
+ *
+ *      Free the storage associated with the -columns switch.
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static void
+ColumnIterFreeProc(ClientData clientData, char *record, int offset, int flags)
+{
+    BLT_TABLE_ITERATOR *iterPtr = (BLT_TABLE_ITERATOR *)(record + offset);
+
+    blt_table_free_iterator_objv(iterPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnIterSwitchProc --
+ *
+ *      Convert a Tcl_Obj representing an offset in the table.
+ *
+ * Results:
+ *      The return value is a standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+ColumnIterSwitchProc(
+    ClientData clientData,              /* Table of the columns. */
+    Tcl_Interp *interp,                 /* Interpreter to report results. */
+    const char *switchName,             /* Not used. */
+    Tcl_Obj *objPtr,                    /* String representation */
+    char *record,                       /* Structure record */
+    int offset,                         /* Offset to field in structure */
+    int flags)                          /* Not used. */
+{
+    BLT_TABLE_ITERATOR *iterPtr = (BLT_TABLE_ITERATOR *)(record + offset);
+    BLT_TABLE table;
+    Tcl_Obj **objv;
+    int objc;
+
+    table = clientData;
+    if (Tcl_ListObjGetElements(interp, objPtr, &objc, &objv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (blt_table_iterate_columns_objv(interp, table, objc, objv, iterPtr)
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RowIterFreeProc --
+ *
+ *      Free the storage associated with the -rows switch.
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static void
+RowIterFreeProc(ClientData clientData, char *record, int offset, int flags)
+{
+    BLT_TABLE_ITERATOR *iterPtr = (BLT_TABLE_ITERATOR *)(record + offset);
+
+    blt_table_free_iterator_objv(iterPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RowIterSwitchProc --
+ *
+ *      Convert a Tcl_Obj representing an offset in the table.
+ *
+ * Results:
+ *      The return value is a standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+RowIterSwitchProc(
+    ClientData clientData,              /* Table of the rows. */
+    Tcl_Interp *interp,                 /* Interpreter to report results. */
+    const char *switchName,             /* Not used. */
+    Tcl_Obj *objPtr,                    /* String representation */
+    char *record,                       /* Structure record */
+    int offset,                         /* Offset to field in structure */
+    int flags)                          /* Not used. */
+{
+    BLT_TABLE_ITERATOR *iterPtr = (BLT_TABLE_ITERATOR *)(record + offset);
+    BLT_TABLE table;
+    Tcl_Obj **objv;
+    int objc;
+
+    table = clientData;
+    if (Tcl_ListObjGetElements(interp, objPtr, &objc, &objv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (blt_table_iterate_rows_objv(interp, table, objc, objv, iterPtr)
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static INLINE uint16_t
+GetUInt16(const unsigned char *bp)
+{
+    return (uint16_t)(bp[0] | (bp[1] << 8));
+}
+
+static INLINE uint32_t
+GetUInt32(const unsigned char *bp)
+{
+    return ((uint32_t)bp[0] | ((uint32_t)bp[1] << 8) |
+            ((uint32_t)bp[2] << 16) | ((uint32_t)bp[3] << 24));
+}
+
+static INLINE int64_t
+GetInt64(const unsigned char *bp)
+{
+    return (int64_t)((uint64_t)GetUInt32(bp) |
+                     ((uint64_t)GetUInt32(bp + 4) << 32));
+}
+
+static INLINE void
+PutUInt16(unsigned char *bp, uint16_t value)
+{
+    bp[0] = value & 0xFF;
+    bp[1] = (value >> 8) & 0xFF;
+}
+
+static INLINE void
+PutUInt32(unsigned char *bp, uint32_t value)
+{
+    bp[0] = value & 0xFF;
+    bp[1] = (value >> 8) & 0xFF;
+    bp[2] = (value >> 16) & 0xFF;
+    bp[3] = (value >> 24) & 0xFF;
+}
+
+static INLINE void
+PutInt64(unsigned char *bp, int64_t value)
+{
+    PutUInt32(bp, (uint32_t)((uint64_t)value & 0xFFFFFFFF));
+    PutUInt32(bp + 4, (uint32_t)((uint64_t)value >> 32));
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FbGetTable --
+ *
+ *      Locates the table at the given offset in the flatbuffer and its
+ *      vtable.
+ *
+ * Results:
+ *      Returns TRUE if the table and its vtable lie within the buffer.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+FbGetTable(const FlatBuffer *fbPtr, size_t offset, FbTable *tablePtr)
+{
+    int64_t vtable;
+
+    if ((offset & 3) || (offset > fbPtr->size) ||
+        ((fbPtr->size - offset) < 4)) {
+        return FALSE;
+    }
+    vtable = (int64_t)offset - (int32_t)GetUInt32(fbPtr->bytes + offset);
+    if ((vtable < 0) || (vtable & 1) || ((uint64_t)vtable > fbPtr->size) ||
+        ((fbPtr->size - vtable) < 4)) {
+        return FALSE;
+    }
+    tablePtr->fbPtr = fbPtr;
+    tablePtr->table = offset;
+    tablePtr->vtable = (size_t)vtable;
+    tablePtr->vtableSize = GetUInt16(fbPtr->bytes + vtable);
+    tablePtr->tableSize = GetUInt16(fbPtr->bytes + vtable + 2);
+    if ((tablePtr->vtableSize < 4) ||
+        (tablePtr->vtableSize > (fbPtr->size - vtable)) ||
+        (tablePtr->tableSize > (fbPtr->size - offset))) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FbGetField --
+ *
+ *      Returns the offset of the field in the flatbuffer, or 0 if the
+ *      field isn't set or doesn't lie within its table.
+ *
+ *---------------------------------------------------------------------------
+ */
+static size_t
+FbGetField(FbTable *tablePtr, int id, size_t size)
+{
+    size_t slot, offset;
+
+    slot = 4 + 2 * id;
+    if ((slot + 2) > tablePtr->vtableSize) {
+        return 0;
+    }
+    offset = GetUInt16(tablePtr->fbPtr->bytes + tablePtr->vtable + slot);
+    if ((offset < 4) || ((offset + size) > tablePtr->tableSize)) {
+        return 0;
+    }
+    return tablePtr->table + offset;
+}
+
+static int64_t
+FbGetScalar(FbTable *tablePtr, int id, size_t size, int64_t defValue)
+{
+    const unsigned char *bp;
+    size_t offset;
+
+    offset = FbGetField(tablePtr, id, size);
+    if (offset == 0) {
+        return defValue;
+    }
+    bp = tablePtr->fbPtr->bytes + offset;
+    switch (size) {
+    case 1:
+        return bp[0];
+    case 2:
+        return (int16_t)GetUInt16(bp);
+    case 4:
+        return (int32_t)GetUInt32(bp);
+    default:
+        return GetInt64(bp);
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FbGetObject --
+ *
+ *      Returns the offset of the string, vector, or table the field
+ *      refers to, or 0 if the field isn't set or is bad.
+ *
+ *---------------------------------------------------------------------------
+ */
+static size_t
+FbGetObject(FbTable *tablePtr, int id)
+{
+    size_t offset;
+    uint32_t object;
+
+    offset = FbGetField(tablePtr, id, 4);
+    if (offset == 0) {
+        return 0;
+    }
+    object = GetUInt32(tablePtr->fbPtr->bytes + offset);
+    if ((object == 0) || (object > (tablePtr->fbPtr->size - offset))) {
+        return 0;
+    }
+    return offset + object;
+}
+
+static int
+FbGetTableField(FbTable *tablePtr, int id, FbTable *childPtr)
+{
+    size_t offset;
+
+    offset = FbGetObject(tablePtr, id);
+    if (offset == 0) {
+        return FALSE;
+    }
+    return FbGetTable(tablePtr->fbPtr, offset, childPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FbGetVector --
+ *
+ *      Locates the vector the field refers to.  The offset of its first
+ *      element and the number of elements are returned.
+ *
+ * Results:
+ *      Returns TRUE if the field is set and the vector lies within the
+ *      buffer.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+FbGetVector(FbTable *tablePtr, int id, size_t elemSize, size_t *firstPtr,
+            size_t *countPtr)
+{
+    const FlatBuffer *fbPtr = tablePtr->fbPtr;
+    size_t offset, count;
+
+    offset = FbGetObject(tablePtr, id);
+    if ((offset == 0) || ((fbPtr->size - offset) < 4)) {
+        return FALSE;
+    }
+    count = GetUInt32(fbPtr->bytes + offset);
+    offset += 4;
+    if (count > ((fbPtr->size - offset) / elemSize)) {
+        return FALSE;
+    }
+    *firstPtr = offset;
+    *countPtr = count;
+    return TRUE;
+}
+
+/* Returns the table that is the given element of a vector of tables. */
+static int
+FbGetVectorTable(FbTable *tablePtr, size_t first, size_t i, FbTable *elemPtr)
+{
+    const FlatBuffer *fbPtr = tablePtr->fbPtr;
+    size_t offset;
+    uint32_t object;
+
+    offset = first + 4 * i;
+    object = GetUInt32(fbPtr->bytes + offset);
+    if (object > (fbPtr->size - offset)) {
+        return FALSE;
+    }
+    return FbGetTable(fbPtr, offset + object, elemPtr);
+}
+
+/* Pads the buffer with zeros to a multiple of the alignment. */
+static size_t
+FbAlign(Blt_DBuffer dbuffer, size_t align)
+{
+    size_t length, pad;
+
+    length = Blt_DBuffer_Length(dbuffer);
+    pad = (align - (length & (align - 1))) & (align - 1);
+    if (pad > 0) {
+        memset(Blt_DBuffer_Extend(dbuffer, pad), 0, pad);
+    }
+    return length + pad;
+}
+
+static unsigned char *
+FbExtend(Blt_DBuffer dbuffer, size_t numBytes)
+{
+    unsigned char *bp;
+
+    bp = Blt_DBuffer_Extend(dbuffer, numBytes);
+    memset(bp, 0, numBytes);
+    return bp;
+}
+
+/* Sets the field to refer to an object written after it. */
+static void
+FbSetObject(Blt_DBuffer dbuffer, size_t field, size_t object)
+{
+    assert(object > field);
+    PutUInt32(Blt_DBuffer_Bytes(dbuffer) + field, (uint32_t)(object - field));
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FbWriteTable --
+ *
+ *      Writes a table and its vtable.  Fields are laid out largest first,
+ *      so that each is aligned on its size.  The offset of each field is
+ *      stored in its FbField structure.
+ *
+ * Results:
+ *      Returns the offset of the table.
+ *
+ *---------------------------------------------------------------------------
+ */
+static size_t
+FbWriteTable(Blt_DBuffer dbuffer, int numFields, FbField *fields)
+{
+    unsigned char *bp;
+    size_t vtable, table, vtableSize, tableSize;
+    int i, size, numSlots;
+
+    numSlots = 0;
+    for (i = 0; i < numFields; i++) {
+        if (fields[i].id >= numSlots) {
+            numSlots = fields[i].id + 1;
+        }
+    }
+    vtableSize = 4 + 2 * numSlots;
+    vtable = FbAlign(dbuffer, 4);
+    FbExtend(dbuffer, vtableSize);
+    /* The table starts 4 bytes before an 8-byte boundary, so that 8-byte
+     * fields following its vtable offset are aligned. */
+    table = FbAlign(dbuffer, 4);
+    if ((table & 7) == 0) {
+        FbExtend(dbuffer, 4);
+        table += 4;
+    }
+    tableSize = 4;
+    for (size = 8; size > 0; size >>= 1) {
+        for (i = 0; i < numFields; i++) {
+            if (fields[i].size == size) {
+                fields[i].pos = table + tableSize;
+                tableSize += size;
+            }
+        }
+    }
+    tableSize = (tableSize + 3) & ~3;
+    FbExtend(dbuffer, tableSize);
+    bp = Blt_DBuffer_Bytes(dbuffer);
+    PutUInt16(bp + vtable, (uint16_t)vtableSize);
+    PutUInt16(bp + vtable + 2, (uint16_t)tableSize);
+    PutUInt32(bp + table, (uint32_t)(table - vtable));
+    for (i = 0; i < numFields; i++) {
+        FbField *fieldPtr;
+        unsigned char *fp;
+
+        fieldPtr = fields + i;
+        PutUInt16(bp + vtable + 4 + 2 * fieldPtr->id,
+                  (uint16_t)(fieldPtr->pos - table));
+        fp = bp + fieldPtr->pos;
+        switch (fieldPtr->size) {
+        case 1:
+            fp[0] = (unsigned char)fieldPtr->value;
+            break;
+        case 2:
+            PutUInt16(fp, (uint16_t)fieldPtr->value);
+            break;
+        case 4:
+            PutUInt32(fp, (uint32_t)fieldPtr->value);
+            break;
+        default:
+            PutInt64(fp, fieldPtr->value);
+            break;
+        }
+    }
+    return table;
+}
+
+static size_t
+FbWriteString(Blt_DBuffer dbuffer, const char *string, size_t length)
+{
+    unsigned char *bp;
+    size_t offset;
+
+    offset = FbAlign(dbuffer, 4);
+    bp = FbExtend(dbuffer, 4 + length + 1);
+    PutUInt32(bp, (uint32_t)length);
+    memcpy(bp + 4, string, length);
+    return offset;
+}
+
+/*
+ * FbStartVector --
+ *
+ *      Writes the length of a vector of structures aligned on 8 bytes.
+ *      The caller writes the elements after it.
+ */
+static size_t
+FbStartVector(Blt_DBuffer dbuffer, size_t count)
+{
+    size_t offset;
+
+    offset = FbAlign(dbuffer, 4);
+    if (((offset + 4) & 7) != 0) {
+        FbExtend(dbuffer, 4);
+        offset += 4;
+    }
+    PutUInt32(FbExtend(dbuffer, 4), (uint32_t)count);
+    return offset;
+}
+
+/*
+ * FbWriteTableVector --
+ *
+ *      Writes a vector of table offsets.  Each element is set with
+ *      FbSetObject once its table is written.
+ */
+static size_t
+FbWriteTableVector(Blt_DBuffer dbuffer, size_t count)
+{
+    size_t offset;
+
+    offset = FbAlign(dbuffer, 4);
+    PutUInt32(FbExtend(dbuffer, 4 + 4 * count), (uint32_t)count);
+    return offset;
+}
+
+static const char *
+ArrowTypeName(int type)
+{
+    static const char *names[] = {
+        "none", "null", "int", "floatingpoint", "binary", "utf8", "bool",
+        "decimal", "date", "time", "timestamp", "interval", "list",
+        "struct", "union", "fixedsizebinary", "fixedsizelist", "map",
+        "duration", "largebinary", "largeutf8", "largelist",
+        "runendencoded", "binaryview", "utf8view", "listview",
+        "largelistview"
+    };
+    if ((type < 0) || (type >= (int)(sizeof(names) / sizeof(char *)))) {
+        return "unknown";
+    }
+    return names[type];
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ArrowTypeToColumnType --
+ *
+ *      Returns the column type used to hold values of the Arrow field's
+ *      type, or TABLE_COLUMN_TYPE_UNKNOWN if the type isn't supported.
+ *      Integers are stored as int64, floating point numbers as doubles,
+ *      and timestamps and dates as times (seconds since the epoch).
+ *
+ *---------------------------------------------------------------------------
+ */
+static BLT_TABLE_COLUMN_TYPE
+ArrowTypeToColumnType(ArrowField *fieldPtr)
+{
+    switch (fieldPtr->type) {
+    case ARROW_TYPE_INT:
+        switch (fieldPtr->bitWidth) {
+        case 8:
+        case 16:
+        case 32:
+        case 64:
+            return TABLE_COLUMN_TYPE_INT64;
+        }
+        break;
+    case ARROW_TYPE_FLOAT:
+        if ((fieldPtr->precision == ARROW_PRECISION_SINGLE) ||
+            (fieldPtr->precision == ARROW_PRECISION_DOUBLE)) {
+            return TABLE_COLUMN_TYPE_DOUBLE;
+        }
+        break;
+    case ARROW_TYPE_TIMESTAMP:
+        if ((fieldPtr->unit >= ARROW_UNIT_SECOND) &&
+            (fieldPtr->unit <= ARROW_UNIT_NANO)) {
+            return TABLE_COLUMN_TYPE_TIME;
+        }
+        break;
+    case ARROW_TYPE_DATE:
+        if ((fieldPtr->unit == ARROW_DATE_DAY) ||
+            (fieldPtr->unit == ARROW_DATE_MILLI)) {
+            return TABLE_COLUMN_TYPE_TIME;
+        }
+        break;
+    case ARROW_TYPE_BOOL:
+        return TABLE_COLUMN_TYPE_BOOLEAN;
+    case ARROW_TYPE_UTF8:
+    case ARROW_TYPE_LARGEUTF8:
+        return TABLE_COLUMN_TYPE_STRING;
+    case ARROW_TYPE_BINARY:
+    case ARROW_TYPE_LARGEBINARY:
+        return TABLE_COLUMN_TYPE_BLOB;
+    case ARROW_TYPE_NULL:
+        return TABLE_COLUMN_TYPE_STRING;
+    }
+    return TABLE_COLUMN_TYPE_UNKNOWN;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ImportSchema --
+ *
+ *      Creates a column in the table for each field of the schema.
+ *      Numeric columns are packed, so that record batches can be copied
+ *      straight into them.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ImportSchema(Tcl_Interp *interp, BLT_TABLE table, ArrowReader *readerPtr,
+             FbTable *schemaPtr)
+{
+    size_t first, i, count;
+
+    if (readerPtr->fields != NULL) {
+        Tcl_AppendResult(interp, "arrow data has more than one schema",
+                         (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (FbGetScalar(schemaPtr, 0, 2, 0) != ARROW_ENDIANNESS) {
+        Tcl_AppendResult(interp, "arrow data isn't in this machine's "
+                         "byte order", (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (!FbGetVector(schemaPtr, 1, 4, &first, &count)) {
+        Tcl_AppendResult(interp, "bad arrow schema: no fields", (char *)NULL);
+        return TCL_ERROR;
+    }
+    readerPtr->fields = Blt_AssertCalloc(count + 1, sizeof(ArrowField));
+    readerPtr->numFields = count;
+    for (i = 0; i < count; i++) {
+        ArrowField *fieldPtr;
+        FbTable field, type;
+        BLT_TABLE_COLUMN_TYPE colType;
+        Tcl_DString ds;
+        size_t name, numChildren, dummy;
+
+        fieldPtr = readerPtr->fields + i;
+        if (!FbGetVectorTable(schemaPtr, first, i, &field)) {
+            Tcl_AppendResult(interp, "bad arrow schema: bad field",
+                             (char *)NULL);
+            return TCL_ERROR;
+        }
+        Tcl_DStringInit(&ds);
+        name = FbGetObject(&field, 0);
+        if ((name != 0) && ((schemaPtr->fbPtr->size - name) >= 4)) {
+            size_t length;
+
+            length = GetUInt32(schemaPtr->fbPtr->bytes + name);
+            if (length <= (schemaPtr->fbPtr->size - name - 4)) {
+                Tcl_DStringAppend(&ds, (const char *)schemaPtr->fbPtr->bytes
+                                  + name + 4, (int)length);
+            }
+        }
+        fieldPtr->type = (int)FbGetScalar(&field, 2, 1, 0);
+        if (FbGetTableField(&field, 3, &type)) {
+            fieldPtr->bitWidth = (int)FbGetScalar(&type, 0, 4, 0);
+            fieldPtr->isSigned = (int)FbGetScalar(&type, 1, 1, 0);
+            fieldPtr->precision = (int)FbGetScalar(&type, 0, 2, 0);
+            fieldPtr->unit = (int)FbGetScalar(&type, 0, 2,
+                (fieldPtr->type == ARROW_TYPE_DATE) ? ARROW_DATE_MILLI : 0);
+        }
+        colType = ArrowTypeToColumnType(fieldPtr);
+        if (FbGetObject(&field, 4) != 0) {
+            Tcl_AppendResult(interp, "can't import column \"",
+                Tcl_DStringValue(&ds), "\": dictionary-encoded arrow "
+                "columns aren't supported", (char *)NULL);
+            Tcl_DStringFree(&ds);
+            return TCL_ERROR;
+        }
+        if ((colType == TABLE_COLUMN_TYPE_UNKNOWN) ||
+            ((FbGetVector(&field, 5, 4, &dummy, &numChildren)) &&
+             (numChildren > 0))) {
+            Tcl_AppendResult(interp, "can't import column \"",
+                Tcl_DStringValue(&ds), "\": arrow type \"",
+                ArrowTypeName(fieldPtr->type), "\" isn't supported",
+                (char *)NULL);
+            Tcl_DStringFree(&ds);
+            return TCL_ERROR;
+        }
+        if (blt_table_extend_columns(interp, table, 1, &fieldPtr->col)
+            != TCL_OK) {
+            Tcl_DStringFree(&ds);
+            return TCL_ERROR;
+        }
+        if ((Tcl_DStringLength(&ds) > 0) &&
+            (blt_table_set_column_label(interp, table, fieldPtr->col,
+                Tcl_DStringValue(&ds)) != TCL_OK)) {
+            Tcl_DStringFree(&ds);
+            return TCL_ERROR;
+        }
+        Tcl_DStringFree(&ds);
+        if (blt_table_set_column_type(interp, table, fieldPtr->col, colType)
+            != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if ((colType != TABLE_COLUMN_TYPE_STRING) &&
+            (colType != TABLE_COLUMN_TYPE_BOOLEAN) &&
+            (colType != TABLE_COLUMN_TYPE_BLOB) &&
+            (blt_table_pack_column(interp, table, fieldPtr->col) != TCL_OK)) {
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ConvertNumbers --
+ *
+ *      Converts the values of a numeric Arrow buffer into an array of
+ *      64-bit integers or doubles, the form blt_table_set_packed_values
+ *      takes.  Timestamps and dates are converted to seconds.
+ *
+ * Results:
+ *      Returns the array, which must be freed with Blt_Free.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void *
+ConvertNumbers(ArrowField *fieldPtr, const unsigned char *data, size_t count)
+{
+    int64_t *array;
+    double *values;
+    size_t i;
+
+    array = Blt_AssertMalloc(count * sizeof(int64_t) + 1);
+    values = (double *)array;
+    for (i = 0; i < count; i++) {
+        switch (fieldPtr->type) {
+        case ARROW_TYPE_INT:
+            switch (fieldPtr->bitWidth) {
+            case 8:
+                array[i] = (fieldPtr->isSigned) ?
+                    (int64_t)((int8_t *)data)[i] : (int64_t)data[i];
+                break;
+            case 16:
+                {
+                    uint16_t u16;
+
+                    memcpy(&u16, data + i * 2, 2);
+                    array[i] = (fieldPtr->isSigned) ?
+                        (int64_t)(int16_t)u16 : (int64_t)u16;
+                }
+                break;
+            case 32:
+                {
+                    uint32_t u32;
+
+                    memcpy(&u32, data + i * 4, 4);
+                    array[i] = (fieldPtr->isSigned) ?
+                        (int64_t)(int32_t)u32 : (int64_t)u32;
+                }
+                break;
+            default:
+                memcpy(array + i, data + i * 8, 8);
+                break;
+            }
+            break;
+        case ARROW_TYPE_FLOAT:
+            if (fieldPtr->precision == ARROW_PRECISION_SINGLE) {
+                float f;
+
+                memcpy(&f, data + i * 4, 4);
+                values[i] = f;
+            } else {
+                memcpy(values + i, data + i * 8, 8);
+            }
+            break;
+        case ARROW_TYPE_DATE:
+            if (fieldPtr->unit == ARROW_DATE_DAY) {
+                int32_t days;
+
+                memcpy(&days, data + i * 4, 4);
+                values[i] = days * 86400.0;
+            } else {
+                int64_t ms;
+
+                memcpy(&ms, data + i * 8, 8);
+                values[i] = ms * 1e-3;
+            }
+            break;
+        case ARROW_TYPE_TIMESTAMP:
+            {
+                static double scales[] = { 1.0, 1e3, 1e6, 1e9 };
+                int64_t t;
+
+                memcpy(&t, data + i * 8, 8);
+                values[i] = (double)t / scales[fieldPtr->unit];
+            }
+            break;
+        }
+    }
+    return array;
+}
+
+/* Returns the width in bytes of each value of a numeric Arrow field. */
+static size_t
+NumberWidth(ArrowField *fieldPtr)
+{
+    switch (fieldPtr->type) {
+    case ARROW_TYPE_INT:
+        return fieldPtr->bitWidth / 8;
+    case ARROW_TYPE_FLOAT:
+        return (fieldPtr->precision == ARROW_PRECISION_SINGLE) ? 4 : 8;
+    case ARROW_TYPE_DATE:
+        return (fieldPtr->unit == ARROW_DATE_DAY) ? 4 : 8;
+    default:
+        return 8;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ImportColumn --
+ *
+ *      Sets the values of one column from its buffers in a record batch.
+ *      Signed 64-bit integers and doubles are copied from the Arrow
+ *      buffer into the packed column without conversion.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ImportColumn(Tcl_Interp *interp, BLT_TABLE table, ArrowField *fieldPtr,
+             size_t numRows, BLT_TABLE_ROW *rows, const unsigned char *valid,
+             const unsigned char **buffers, const size_t *lengths)
+{
+    size_t i;
+    int result;
+
+#define IsValid(i)      ((valid == NULL) || (valid[(i) >> 3] & (1 << ((i) & 7))))
+    result = TCL_OK;
+    switch (fieldPtr->type) {
+    case ARROW_TYPE_NULL:
+        break;
+
+    case ARROW_TYPE_INT:
+    case ARROW_TYPE_FLOAT:
+    case ARROW_TYPE_DATE:
+    case ARROW_TYPE_TIMESTAMP:
+        {
+            const unsigned char *data;
+            void *array;
+
+            data = buffers[1];
+            if (lengths[1] < (numRows * NumberWidth(fieldPtr))) {
+                goto badBuffer;
+            }
+            array = NULL;
+            if ((NumberWidth(fieldPtr) != 8) ||
+                (fieldPtr->type == ARROW_TYPE_TIMESTAMP) ||
+                (fieldPtr->type == ARROW_TYPE_DATE) ||
+                ((fieldPtr->type == ARROW_TYPE_INT) && (!fieldPtr->isSigned)) ||
+                (((size_t)data & 7) != 0)) {
+                array = ConvertNumbers(fieldPtr, data, numRows);
+                data = array;
+            }
+            result = blt_table_set_packed_values(interp, table, fieldPtr->col,
+                numRows, rows, data, valid);
+            if (array != NULL) {
+                Blt_Free(array);
+            }
+        }
+        break;
+
+    case ARROW_TYPE_BOOL:
+        if (lengths[1] < ((numRows + 7) / 8)) {
+            goto badBuffer;
+        }
+        for (i = 0; (i < numRows) && (result == TCL_OK); i++) {
+            if (IsValid(i)) {
+                result = blt_table_set_boolean(interp, table, rows[i],
+                        fieldPtr->col, (buffers[1][i >> 3] >> (i & 7)) & 1);
+            }
+        }
+        break;
+
+    case ARROW_TYPE_UTF8:
+    case ARROW_TYPE_LARGEUTF8:
+    case ARROW_TYPE_BINARY:
+    case ARROW_TYPE_LARGEBINARY:
+        {
+            BLT_TABLE_ROW *validRows;
+            const char **strings;
+            int *sizes;
+            size_t count, width;
+            int isLarge;
+
+            isLarge = ((fieldPtr->type == ARROW_TYPE_LARGEUTF8) ||
+                       (fieldPtr->type == ARROW_TYPE_LARGEBINARY));
+            width = (isLarge) ? 8 : 4;
+            if (lengths[1] < ((numRows + 1) * width)) {
+                goto badBuffer;
+            }
+            validRows = Blt_AssertMalloc((numRows + 1) * sizeof(BLT_TABLE_ROW));
+            strings = Blt_AssertMalloc((numRows + 1) * sizeof(char *));
+            sizes = Blt_AssertMalloc((numRows + 1) * sizeof(int));
+            count = 0;
+            for (i = 0; i < numRows; i++) {
+                int64_t start, end;
+
+                if (!IsValid(i)) {
+                    continue;
+                }
+                if (isLarge) {
+                    memcpy(&start, buffers[1] + i * 8, 8);
+                    memcpy(&end, buffers[1] + (i + 1) * 8, 8);
+                } else {
+                    int32_t i32;
+
+                    memcpy(&i32, buffers[1] + i * 4, 4);
+                    start = i32;
+                    memcpy(&i32, buffers[1] + (i + 1) * 4, 4);
+                    end = i32;
+                }
+                if ((start < 0) || (end < start) ||
+                    ((uint64_t)end > lengths[2]) ||
+                    ((end - start) > INT_MAX)) {
+                    break;
+                }
+                validRows[count] = rows[i];
+                strings[count] = (const char *)buffers[2] + start;
+                sizes[count] = (int)(end - start);
+                count++;
+            }
+            if (i < numRows) {
+                Blt_Free(validRows);
+                Blt_Free(strings);
+                Blt_Free(sizes);
+                goto badBuffer;
+            }
+            if ((fieldPtr->type == ARROW_TYPE_UTF8) ||
+                (fieldPtr->type == ARROW_TYPE_LARGEUTF8)) {
+                result = blt_table_set_string_reps(interp, table,
+                        fieldPtr->col, count, validRows, strings, sizes);
+            } else {
+                for (i = 0; (i < count) && (result == TCL_OK); i++) {
+                    result = blt_table_set_bytes(interp, table, validRows[i],
+                        fieldPtr->col, (const unsigned char *)strings[i],
+                        sizes[i]);
+                }
+            }
+            Blt_Free(validRows);
+            Blt_Free(strings);
+            Blt_Free(sizes);
+        }
+        break;
+    }
+    return result;
+ badBuffer:
+    Tcl_AppendResult(interp, "bad arrow record batch: buffer of column \"",
+        blt_table_column_label(fieldPtr->col), "\" is too short",
+        (char *)NULL);
+    return TCL_ERROR;
+#undef IsValid
+}
+
+/* Returns the number of buffers each value of the field uses. */
+static int
+NumBuffers(ArrowField *fieldPtr)
+{
+    switch (fieldPtr->type) {
+    case ARROW_TYPE_NULL:
+        return 0;
+    case ARROW_TYPE_UTF8:
+    case ARROW_TYPE_LARGEUTF8:
+    case ARROW_TYPE_BINARY:
+    case ARROW_TYPE_LARGEBINARY:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ImportRecordBatch --
+ *
+ *      Adds the rows of a record batch to the table.  If an error occurs,
+ *      the rows are deleted.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ImportRecordBatch(Tcl_Interp *interp, BLT_TABLE table, ArrowReader *readerPtr,
+                  FbTable *batchPtr, const unsigned char *body,
+                  int64_t bodyLength)
+{
+    BLT_TABLE_ROW *rows;
+    const FlatBuffer *fbPtr = batchPtr->fbPtr;
+    size_t firstNode, numNodes, firstBuffer, numBuffers, next;
+    int64_t numRows;
+    long i;
+
+    if (readerPtr->fields == NULL) {
+        Tcl_AppendResult(interp, "arrow record batch comes before schema",
+                         (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (FbGetObject(batchPtr, 3) != 0) {
+        Tcl_AppendResult(interp, "compressed arrow record batches "
+                         "aren't supported", (char *)NULL);
+        return TCL_ERROR;
+    }
+    numRows = FbGetScalar(batchPtr, 0, 8, 0);
+    if ((!FbGetVector(batchPtr, 1, 16, &firstNode, &numNodes)) ||
+        (!FbGetVector(batchPtr, 2, 16, &firstBuffer, &numBuffers)) ||
+        (numNodes < (size_t)readerPtr->numFields) || (numRows < 0) ||
+        ((uint64_t)numRows > (size_t)LONG_MAX / sizeof(int64_t))) {
+        Tcl_AppendResult(interp, "bad arrow record batch", (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (numRows == 0) {
+        return TCL_OK;
+    }
+    /* Every column has a value for each row.  Check the lengths before
+     * adding rows, so that a bad length can't add more rows than the
+     * body holds.  Each row of a column takes at least one bit. */
+    for (i = 0; i < readerPtr->numFields; i++) {
+        if ((GetInt64(fbPtr->bytes + firstNode + i * 16) != numRows) ||
+            ((NumBuffers(readerPtr->fields + i) > 0) &&
+             (((numRows - 1) / 8) >= bodyLength))) {
+            Tcl_AppendResult(interp, "bad arrow record batch: bad length "
+                "for column \"", blt_table_column_label(readerPtr->fields[i].col),
+                "\"", (char *)NULL);
+            return TCL_ERROR;
+        }
+    }
+    rows = Blt_Malloc(numRows * sizeof(BLT_TABLE_ROW));
+    if (rows == NULL) {
+        Tcl_AppendResult(interp, "can't allocate ", Blt_Ltoa(numRows),
+                " row slots.", (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (blt_table_extend_rows(interp, table, numRows, rows) != TCL_OK) {
+        Blt_Free(rows);
+        return TCL_ERROR;
+    }
+    next = 0;
+    for (i = 0; i < readerPtr->numFields; i++) {
+        ArrowField *fieldPtr;
+        const unsigned char *buffers[3];
+        size_t lengths[3];
+        int64_t nullCount;
+        int j, n;
+
+        fieldPtr = readerPtr->fields + i;
+        nullCount = GetInt64(fbPtr->bytes + firstNode + i * 16 + 8);
+        n = NumBuffers(fieldPtr);
+        if ((next + n) > numBuffers) {
+            goto badBatch;
+        }
+        for (j = 0; j < n; j++) {
+            const unsigned char *bp;
+            int64_t offset, size;
+
+            bp = fbPtr->bytes + firstBuffer + (next + j) * 16;
+            offset = GetInt64(bp);
+            size = GetInt64(bp + 8);
+            if ((offset < 0) || (size < 0) || (offset > bodyLength) ||
+                (size > (bodyLength - offset))) {
+                goto badBatch;
+            }
+            buffers[j] = body + offset;
+            lengths[j] = (size_t)size;
+        }
+        next += n;
+        if (n == 0) {
+            continue;
+        }
+        if (nullCount == 0) {
+            buffers[0] = NULL;
+        } else if (lengths[0] < ((size_t)(numRows + 7) / 8)) {
+            goto badBatch;
+        }
+        if (ImportColumn(interp, table, fieldPtr, numRows, rows, buffers[0],
+                         buffers, lengths) != TCL_OK) {
+            goto error;
+        }
+    }
+    Blt_Free(rows);
+    return TCL_OK;
+ badBatch:
+    Tcl_AppendResult(interp, "bad arrow record batch: bad buffers for "
+        "column \"", blt_table_column_label(readerPtr->fields[i].col), "\"",
+        (char *)NULL);
+ error:
+    for (i = 0; i < numRows; i++) {
+        blt_table_delete_row(table, rows[i]);
+    }
+    Blt_Free(rows);
+    return TCL_ERROR;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ImportArrow --
+ *
+ *      Reads the messages of Arrow data in the file or streaming format.
+ *      In the file format, the messages end where the footer starts.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ImportArrow(Tcl_Interp *interp, BLT_TABLE table, const unsigned char *bytes,
+            size_t numBytes)
+{
+    ArrowReader reader;
+    size_t pos, end;
+    int result;
+
+    memset(&reader, 0, sizeof(reader));
+    reader.bytes = bytes;
+    reader.numBytes = numBytes;
+    pos = 0;
+    end = numBytes;
+    if ((numBytes >= 8) &&
+        (memcmp(bytes, ARROW_MAGIC, ARROW_MAGIC_LENGTH) == 0)) {
+        uint32_t footerLength;
+
+        if ((numBytes < (8 + 4 + ARROW_MAGIC_LENGTH)) ||
+            (memcmp(bytes + numBytes - ARROW_MAGIC_LENGTH, ARROW_MAGIC,
+                    ARROW_MAGIC_LENGTH) != 0)) {
+            Tcl_AppendResult(interp, "bad arrow file: missing trailer",
+                             (char *)NULL);
+            return TCL_ERROR;
+        }
+        footerLength = GetUInt32(bytes + numBytes - ARROW_MAGIC_LENGTH - 4);
+        if (footerLength > (numBytes - 8 - 4 - ARROW_MAGIC_LENGTH)) {
+            Tcl_AppendResult(interp, "bad arrow file: bad footer length",
+                             (char *)NULL);
+            return TCL_ERROR;
+        }
+        pos = 8;
+        end = numBytes - ARROW_MAGIC_LENGTH - 4 - footerLength;
+    }
+    result = TCL_ERROR;
+    while ((end - pos) >= 4) {
+        FlatBuffer fb;
+        FbTable message, header;
+        uint32_t metaLength;
+        int64_t bodyLength;
+        size_t body;
+        int version, type;
+
+        metaLength = GetUInt32(bytes + pos);
+        pos += 4;
+        if (metaLength == ARROW_CONTINUATION) {
+            if ((end - pos) < 4) {
+                break;
+            }
+            metaLength = GetUInt32(bytes + pos);
+            pos += 4;
+        }
+        if (metaLength == 0) {
+            break;                      /* End of stream. */
+        }
+        if (metaLength > (end - pos)) {
+            Tcl_AppendResult(interp, "bad arrow data: message is truncated",
+                             (char *)NULL);
+            goto error;
+        }
+        fb.bytes = bytes + pos;
+        fb.size = metaLength;
+        if ((!FbGetTable(&fb, GetUInt32(fb.bytes), &message)) ||
+            (!FbGetTableField(&message, 2, &header))) {
+            Tcl_AppendResult(interp, "bad arrow data: bad message",
+                             (char *)NULL);
+            goto error;
+        }
+        version = (int)FbGetScalar(&message, 0, 2, 0);
+        type = (int)FbGetScalar(&message, 1, 1, 0);
+        bodyLength = FbGetScalar(&message, 3, 8, 0);
+        body = pos + metaLength;
+        if ((bodyLength < 0) || ((uint64_t)bodyLength > (end - body))) {
+            Tcl_AppendResult(interp, "bad arrow data: message body is "
+                             "truncated", (char *)NULL);
+            goto error;
+        }
+        if (version < ARROW_METADATA_V4) {
+            Tcl_AppendResult(interp, "arrow metadata version ",
+                Blt_Itoa(version + 1), " isn't supported", (char *)NULL);
+            goto error;
+        }
+        switch (type) {
+        case ARROW_MESG_SCHEMA:
+            if (ImportSchema(interp, table, &reader, &header) != TCL_OK) {
+                goto error;
+            }
+            break;
+        case ARROW_MESG_RECORDBATCH:
+            if (ImportRecordBatch(interp, table, &reader, &header,
+                        bytes + body, bodyLength) != TCL_OK) {
+                goto error;
+            }
+            break;
+        case ARROW_MESG_DICTIONARY:
+            Tcl_AppendResult(interp, "dictionary-encoded arrow columns "
+                             "aren't supported", (char *)NULL);
+            goto error;
+        default:
+            Tcl_AppendResult(interp, "unknown arrow message type ",
+                             Blt_Itoa(type), (char *)NULL);
+            goto error;
+        }
+        pos = body + (size_t)bodyLength;
+    }
+    if (reader.fields == NULL) {
+        Tcl_AppendResult(interp, "no schema found in arrow data",
+                         (char *)NULL);
+        goto error;
+    }
+    result = TCL_OK;
+ error:
+    if (reader.fields != NULL) {
+        Blt_Free(reader.fields);
+    }
+    return result;
+}
+
+static int
+ReadArrowFile(Tcl_Interp *interp, const char *fileName, Blt_DBuffer dbuffer)
+{
+    Tcl_Channel channel;
+    int closeChannel;
+
+    closeChannel = TRUE;
+    if ((fileName[0] == '@') && (fileName[1] != '\0')) {
+        int mode;
+
+        channel = Tcl_GetChannel(interp, fileName+1, &mode);
+        if (channel == NULL) {
+            return TCL_ERROR;
+        }
+        if ((mode & TCL_READABLE) == 0) {
+            Tcl_AppendResult(interp, "channel \"", fileName,
+                             "\" not opened for reading", (char *)NULL);
+            return TCL_ERROR;
+        }
+        closeChannel = FALSE;
+    } else {
+        channel = Tcl_OpenFileChannel(interp, fileName, "r", 0);
+        if (channel == NULL) {
+            return TCL_ERROR;
+        }
+    }
+    if (Tcl_SetChannelOption(interp, channel, "-translation", "binary")
+        != TCL_OK) {
+        goto error;
+    }
+    while (!Tcl_Eof(channel)) {
+#define BLOCK_SIZE (1<<16)
+        size_t length;
+        int numRead;
+        char *bp;
+
+        length = Blt_DBuffer_Length(dbuffer);
+        bp = (char *)Blt_DBuffer_Extend(dbuffer, BLOCK_SIZE);
+        if (bp == NULL) {
+            Tcl_AppendResult(interp, "can't allocate buffer to read \"",
+                             fileName, "\"", (char *)NULL);
+            goto error;
+        }
+        numRead = Tcl_Read(channel, bp, BLOCK_SIZE);
+        if (numRead < 0) {
+            Tcl_AppendResult(interp, "error reading \"", fileName, "\": ",
+                             Tcl_PosixError(interp), (char *)NULL);
+            goto error;
+        }
+        Blt_DBuffer_SetLength(dbuffer, length + numRead);
+    }
+    if (closeChannel) {
+        Tcl_Close(interp, channel);
+    }
+    return TCL_OK;
+ error:
+    if (closeChannel) {
+        Tcl_Close(NULL, channel);
+    }
+    return TCL_ERROR;
+}
+
+/*
+ * $table import arrow -file fileName
+ * $table import arrow -data bytes
+ */
+static int
+ImportArrowProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
+                Tcl_Obj *const *objv)
+{
+    ImportArgs args;
+    int result;
+
+    memset(&args, 0, sizeof(args));
+    if (Blt_ParseSwitches(interp, importSwitches, objc - 3 , objv + 3,
+        &args, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    result = TCL_ERROR;
+    if ((args.dataObjPtr != NULL) && (args.fileObjPtr != NULL)) {
+        Tcl_AppendResult(interp, "can't set both -file and -data switches.",
+                         (char *)NULL);
+        goto error;
+    }
+    if (args.dataObjPtr != NULL) {
+        const unsigned char *bytes;
+        int numBytes;
+
+        bytes = Tcl_GetByteArrayFromObj(args.dataObjPtr, &numBytes);
+        result = ImportArrow(interp, table, bytes, numBytes);
+    } else {
+        Blt_DBuffer dbuffer;
+        const char *fileName;
+
+        fileName = (args.fileObjPtr == NULL) ? "out.arrow" :
+            Tcl_GetString(args.fileObjPtr);
+        dbuffer = Blt_DBuffer_Create();
+        result = ReadArrowFile(interp, fileName, dbuffer);
+        if (result == TCL_OK) {
+            result = ImportArrow(interp, table, Blt_DBuffer_Bytes(dbuffer),
+                Blt_DBuffer_Length(dbuffer));
+        }
+        Blt_DBuffer_Destroy(dbuffer);
+    }
+ error:
+    Blt_FreeSwitches(importSwitches, (char *)&args, 0);
+    return result;
+}
+
+static void
+WriteArrow(ArrowWriter *writerPtr, const void *bytes, size_t numBytes)
+{
+    if ((writerPtr->error) || (numBytes == 0)) {
+        return;
+    }
+    if (writerPtr->channel != NULL) {
+        if (Tcl_Write(writerPtr->channel, (const char *)bytes, numBytes) !=
+            (int)numBytes) {
+            writerPtr->error = TRUE;
+        }
+    } else if (!Blt_DBuffer_AppendData(writerPtr->dbuffer, bytes, numBytes)) {
+        writerPtr->error = TRUE;
+    }
+    writerPtr->offset += numBytes;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * WriteMessage --
+ *
+ *      Writes a message: its metadata, padded to 8 bytes, and its body.
+ *      The location of the message is returned in the block.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+WriteMessage(ArrowWriter *writerPtr, Blt_DBuffer meta, Blt_DBuffer body,
+             ArrowBlock *blockPtr)
+{
+    unsigned char prefix[8];
+    size_t metaLength;
+
+    metaLength = FbAlign(meta, 8);
+    PutUInt32(prefix, ARROW_CONTINUATION);
+    PutUInt32(prefix + 4, (uint32_t)metaLength);
+    blockPtr->offset = writerPtr->offset;
+    blockPtr->metaLength = (int32_t)(metaLength + 8);
+    blockPtr->bodyLength = (body == NULL) ? 0 : Blt_DBuffer_Length(body);
+    WriteArrow(writerPtr, prefix, 8);
+    WriteArrow(writerPtr, Blt_DBuffer_Bytes(meta), metaLength);
+    if (body != NULL) {
+        WriteArrow(writerPtr, Blt_DBuffer_Bytes(body),
+                   Blt_DBuffer_Length(body));
+    }
+}
+
+/* Returns the Arrow type used to write the values of the column. */
+static int
+ColumnTypeToArrowType(BLT_TABLE_COLUMN col)
+{
+    switch (blt_table_column_type(col)) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+        return ARROW_TYPE_FLOAT;
+    case TABLE_COLUMN_TYPE_LONG:
+    case TABLE_COLUMN_TYPE_INT64:
+        return ARROW_TYPE_INT;
+    case TABLE_COLUMN_TYPE_TIME:
+        return ARROW_TYPE_TIMESTAMP;
+    case TABLE_COLUMN_TYPE_BOOLEAN:
+        return ARROW_TYPE_BOOL;
+    case TABLE_COLUMN_TYPE_BLOB:
+        return ARROW_TYPE_BINARY;
+    default:
+        return ARROW_TYPE_UTF8;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * WriteSchema --
+ *
+ *      Writes a Schema table with a field for each column.  Times are
+ *      written as timestamps in microseconds.
+ *
+ * Results:
+ *      Returns the offset of the table.
+ *
+ *---------------------------------------------------------------------------
+ */
+static size_t
+WriteSchema(Blt_DBuffer dbuffer, long numColumns, BLT_TABLE_COLUMN *cols)
+{
+    FbField schema[2] = {
+        { 0, 2, ARROW_ENDIANNESS },     /* endianness */
+        { 1, 4 }                        /* fields */
+    };
+    size_t table, vector;
+    long i;
+
+    table = FbWriteTable(dbuffer, 2, schema);
+    vector = FbWriteTableVector(dbuffer, numColumns);
+    FbSetObject(dbuffer, schema[1].pos, vector);
+    for (i = 0; i < numColumns; i++) {
+        FbField field[5] = {
+            { 0, 4 },                   /* name */
+            { 1, 1, TRUE },             /* nullable */
+            { 2, 1 },                   /* type_type */
+            { 3, 4 },                   /* type */
+            { 5, 4 }                    /* children */
+        };
+        FbField type[2];
+        const char *label;
+        size_t offset;
+        int numTypeFields;
+
+        field[2].value = ColumnTypeToArrowType(cols[i]);
+        offset = FbWriteTable(dbuffer, 5, field);
+        FbSetObject(dbuffer, vector + 4 + 4 * i, offset);
+        label = blt_table_column_label(cols[i]);
+        offset = FbWriteString(dbuffer, label, strlen(label));
+        FbSetObject(dbuffer, field[0].pos, offset);
+        memset(type, 0, sizeof(type));
+        numTypeFields = 0;
+        switch (field[2].value) {
+        case ARROW_TYPE_INT:
+            type[0].id = 0, type[0].size = 4, type[0].value = 64;
+            type[1].id = 1, type[1].size = 1, type[1].value = TRUE;
+            numTypeFields = 2;
+            break;
+        case ARROW_TYPE_FLOAT:
+            type[0].id = 0, type[0].size = 2;
+            type[0].value = ARROW_PRECISION_DOUBLE;
+            numTypeFields = 1;
+            break;
+        case ARROW_TYPE_TIMESTAMP:
+            type[0].id = 0, type[0].size = 2;
+            type[0].value = ARROW_UNIT_MICRO;
+            numTypeFields = 1;
+            break;
+        }
+        offset = FbWriteTable(dbuffer, numTypeFields, type);
+        FbSetObject(dbuffer, field[3].pos, offset);
+        offset = FbWriteTableVector(dbuffer, 0);
+        FbSetObject(dbuffer, field[4].pos, offset);
+    }
+    return table;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * WriteMessageHeader --
+ *
+ *      Starts the flatbuffer of a message.  The field that refers to the
+ *      message header is returned, to be set once the header is written.
+ *
+ *---------------------------------------------------------------------------
+ */
+static size_t
+WriteMessageHeader(Blt_DBuffer dbuffer, int type, int64_t bodyLength)
+{
+    FbField message[4] = {
+        { 0, 2, ARROW_METADATA_V5 },    /* version */
+        { 1, 1 },                       /* header_type */
+        { 2, 4 },                       /* header */
+        { 3, 8 },                       /* bodyLength */
+    };
+    size_t table;
+
+    message[1].value = type;
+    message[3].value = bodyLength;
+    Blt_DBuffer_SetLength(dbuffer, 0);
+    FbExtend(dbuffer, 4);               /* Root table offset. */
+    table = FbWriteTable(dbuffer, 4, message);
+    PutUInt32(Blt_DBuffer_Bytes(dbuffer), (uint32_t)table);
+    return message[2].pos;
+}
+
+/* Appends a buffer to the message body, aligned on 8 bytes. */
+static unsigned char *
+AddBodyBuffer(Blt_DBuffer body, Blt_DBuffer buffers, size_t numBytes)
+{
+    unsigned char *bp;
+    size_t offset;
+
+    offset = Blt_DBuffer_Length(body);
+    bp = FbExtend(buffers, 16);
+    PutInt64(bp, offset);
+    PutInt64(bp + 8, numBytes);
+    FbExtend(body, (numBytes + 7) & ~7);
+    return Blt_DBuffer_Bytes(body) + offset;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ExportColumn --
+ *
+ *      Writes the buffers of one column of a record batch into the
+ *      message body: the values first, then the validity bitmap if any
+ *      values are empty.  Numeric values are copied from the column into
+ *      the body at once.
+ *
+ * Results:
+ *      Returns the number of empty values.
+ *
+ *---------------------------------------------------------------------------
+ */
+static size_t
+ExportColumn(BLT_TABLE table, BLT_TABLE_COLUMN col, size_t numRows,
+             BLT_TABLE_ROW *rows, Blt_DBuffer body, Blt_DBuffer buffers,
+             Blt_DBuffer scratch)
+{
+    unsigned char *valid, *bp;
+    size_t i, numEmpty, start, numBytes;
+
+    numBytes = (numRows + 7) / 8;
+    Blt_DBuffer_SetLength(scratch, 0);
+    valid = FbExtend(scratch, numBytes);
+    numEmpty = 0;
+    /* The validity bitmap is listed first, but written after the
+     * values. */
+    start = Blt_DBuffer_Length(buffers);
+    FbExtend(buffers, 16);
+    switch (ColumnTypeToArrowType(col)) {
+    case ARROW_TYPE_FLOAT:
+    case ARROW_TYPE_INT:
+        bp = AddBodyBuffer(body, buffers, numRows * sizeof(int64_t));
+        numEmpty = blt_table_get_packed_values(table, col, numRows, rows, bp,
+                valid);
+        break;
+
+    case ARROW_TYPE_TIMESTAMP:
+        {
+            int64_t *array;
+
+            bp = AddBodyBuffer(body, buffers, numRows * sizeof(int64_t));
+            numEmpty = blt_table_get_packed_values(table, col, numRows, rows,
+                bp, valid);
+            array = (int64_t *)bp;
+            for (i = 0; i < numRows; i++) {
+                double d;
+
+                memcpy(&d, array + i, sizeof(double));
+                array[i] = (int64_t)floor(d * 1e6 + 0.5);
+            }
+        }
+        break;
+
+    case ARROW_TYPE_BOOL:
+        bp = AddBodyBuffer(body, buffers, numBytes);
+        for (i = 0; i < numRows; i++) {
+            if (!blt_table_value_exists(table, rows[i], col)) {
+                numEmpty++;
+                continue;
+            }
+            valid[i >> 3] |= (1 << (i & 7));
+            if (blt_table_get_boolean(NULL, table, rows[i], col, FALSE) > 0) {
+                bp[i >> 3] |= (1 << (i & 7));
+            }
+        }
+        break;
+
+    default:
+        {
+            size_t offsets;
+            int32_t length;
+
+            /* The offsets are written first.  The body may move as the
+             * values are appended, so the offsets are found again. */
+            offsets = Blt_DBuffer_Length(body);
+            AddBodyBuffer(body, buffers, (numRows + 1) * sizeof(int32_t));
+            bp = FbExtend(buffers, 16);
+            PutInt64(bp, Blt_DBuffer_Length(body));
+            length = 0;
+            for (i = 0; i < numRows; i++) {
+                int32_t *array;
+
+                array = (int32_t *)(Blt_DBuffer_Bytes(body) + offsets);
+                array[i] = length;
+                if (!blt_table_value_exists(table, rows[i], col)) {
+                    numEmpty++;
+                    continue;
+                }
+                valid[i >> 3] |= (1 << (i & 7));
+                if (blt_table_column_type(col) == TABLE_COLUMN_TYPE_BLOB) {
+                    BLT_TABLE_VALUE value;
+
+                    value = blt_table_get_value(table, rows[i], col);
+                    Blt_DBuffer_AppendData(body, blt_table_value_bytes(value),
+                        blt_table_value_length(value));
+                    length += blt_table_value_length(value);
+                } else {
+                    const char *string;
+                    int numBytes;
+
+                    /* Encoded string columns are read without decoding
+                     * them. */
+                    string = blt_table_get_string(table, rows[i], col);
+                    numBytes = strlen(string);
+                    Blt_DBuffer_AppendString(body, string, numBytes);
+                    length += numBytes;
+                }
+            }
+            ((int32_t *)(Blt_DBuffer_Bytes(body) + offsets))[numRows] = length;
+            PutInt64(Blt_DBuffer_Bytes(buffers) + Blt_DBuffer_Length(buffers)
+                     - 8, length);
+            FbAlign(body, 8);
+        }
+        break;
+    }
+    bp = Blt_DBuffer_Bytes(buffers) + start;
+    PutInt64(bp, Blt_DBuffer_Length(body));
+    if (numEmpty > 0) {
+        memcpy(FbExtend(body, (numBytes + 7) & ~7), valid, numBytes);
+        bp = Blt_DBuffer_Bytes(buffers) + start;
+        PutInt64(bp + 8, numBytes);
+    }
+    return numEmpty;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ExportRecordBatch --
+ *
+ *      Writes a RecordBatch message holding the given rows.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ExportRecordBatch(BLT_TABLE table, ArrowWriter *writerPtr, long numColumns,
+                  BLT_TABLE_COLUMN *cols, size_t numRows, BLT_TABLE_ROW *rows,
+                  Blt_DBuffer meta, Blt_DBuffer body, ArrowBlock *blockPtr)
+{
+    FbField batch[3] = {
+        { 0, 8 },                       /* length */
+        { 1, 4 },                       /* nodes */
+        { 2, 4 },                       /* buffers */
+    };
+    Blt_DBuffer nodes, buffers, scratch;
+    size_t header, offset;
+    long i;
+
+    nodes = Blt_DBuffer_Create();
+    buffers = Blt_DBuffer_Create();
+    scratch = Blt_DBuffer_Create();
+    Blt_DBuffer_SetLength(body, 0);
+    for (i = 0; i < numColumns; i++) {
+        unsigned char *bp;
+        size_t numEmpty;
+
+        numEmpty = ExportColumn(table, cols[i], numRows, rows, body, buffers,
+                scratch);
+        bp = FbExtend(nodes, 16);
+        PutInt64(bp, numRows);
+        PutInt64(bp + 8, numEmpty);
+    }
+    header = WriteMessageHeader(meta, ARROW_MESG_RECORDBATCH,
+                Blt_DBuffer_Length(body));
+    batch[0].value = numRows;
+    offset = FbWriteTable(meta, 3, batch);
+    FbSetObject(meta, header, offset);
+    offset = FbStartVector(meta, numColumns);
+    FbSetObject(meta, batch[1].pos, offset);
+    Blt_DBuffer_AppendData(meta, Blt_DBuffer_Bytes(nodes),
+                           Blt_DBuffer_Length(nodes));
+    offset = FbStartVector(meta, Blt_DBuffer_Length(buffers) / 16);
+    FbSetObject(meta, batch[2].pos, offset);
+    Blt_DBuffer_AppendData(meta, Blt_DBuffer_Bytes(buffers),
+                           Blt_DBuffer_Length(buffers));
+    WriteMessage(writerPtr, meta, body, blockPtr);
+    Blt_DBuffer_Destroy(nodes);
+    Blt_DBuffer_Destroy(buffers);
+    Blt_DBuffer_Destroy(scratch);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ExportArrow --
+ *
+ *      Writes the rows and columns in the Arrow IPC file format: the
+ *      schema, a record batch for each -batchsize rows, and the footer.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ExportArrow(BLT_TABLE table, ArrowWriter *writerPtr, ExportArgs *argsPtr,
+            long numColumns, BLT_TABLE_COLUMN *cols, size_t numRows,
+            BLT_TABLE_ROW *rows)
+{
+    static const unsigned char magic[8] = "ARROW1";
+    static const unsigned char eos[8] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    FbField footer[4] = {
+        { 0, 2, ARROW_METADATA_V5 },    /* version */
+        { 1, 4 },                       /* schema */
+        { 2, 4 },                       /* dictionaries */
+        { 3, 4 },                       /* recordBatches */
+    };
+    ArrowBlock block, *blocks;
+    Blt_DBuffer meta, body;
+    unsigned char trailer[4];
+    size_t i, numBatches, offset, header;
+
+    meta = Blt_DBuffer_Create();
+    body = Blt_DBuffer_Create();
+    WriteArrow(writerPtr, magic, 8);
+    header = WriteMessageHeader(meta, ARROW_MESG_SCHEMA, 0);
+    offset = WriteSchema(meta, numColumns, cols);
+    FbSetObject(meta, header, offset);
+    WriteMessage(writerPtr, meta, NULL, &block);
+
+    numBatches = (numRows + argsPtr->batchSize - 1) / argsPtr->batchSize;
+    blocks = Blt_AssertMalloc((numBatches + 1) * sizeof(ArrowBlock));
+    for (i = 0; i < numBatches; i++) {
+        size_t first, count;
+
+        first = i * argsPtr->batchSize;
+        count = MIN(numRows - first, (size_t)argsPtr->batchSize);
+        ExportRecordBatch(table, writerPtr, numColumns, cols, count,
+                rows + first, meta, body, blocks + i);
+    }
+    WriteArrow(writerPtr, eos, 8);
+
+    /* Footer */
+    Blt_DBuffer_SetLength(meta, 0);
+    FbExtend(meta, 4);
+    offset = FbWriteTable(meta, 4, footer);
+    PutUInt32(Blt_DBuffer_Bytes(meta), (uint32_t)offset);
+    offset = WriteSchema(meta, numColumns, cols);
+    FbSetObject(meta, footer[1].pos, offset);
+    offset = FbStartVector(meta, 0);
+    FbSetObject(meta, footer[2].pos, offset);
+    offset = FbStartVector(meta, numBatches);
+    FbSetObject(meta, footer[3].pos, offset);
+    for (i = 0; i < numBatches; i++) {
+        unsigned char *bp;
+
+        bp = FbExtend(meta, 24);
+        PutInt64(bp, blocks[i].offset);
+        PutUInt32(bp + 8, (uint32_t)blocks[i].metaLength);
+        PutInt64(bp + 16, blocks[i].bodyLength);
+    }
+    FbAlign(meta, 8);
+    WriteArrow(writerPtr, Blt_DBuffer_Bytes(meta), Blt_DBuffer_Length(meta));
+    PutUInt32(trailer, (uint32_t)Blt_DBuffer_Length(meta));
+    WriteArrow(writerPtr, trailer, 4);
+    WriteArrow(writerPtr, magic, ARROW_MAGIC_LENGTH);
+    Blt_Free(blocks);
+    Blt_DBuffer_Destroy(meta);
+    Blt_DBuffer_Destroy(body);
+}
+
+/*
+ * $table export arrow -file fileName ?switches...?
+ * $table export arrow ?switches...?
+ */
+static int
+ExportArrowProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
+                Tcl_Obj *const *objv)
+{
+    ArrowWriter writer;
+    BLT_TABLE_COLUMN col, *cols;
+    BLT_TABLE_ROW row, *rows;
+    ExportArgs args;
+    Tcl_Channel channel;
+    int closeChannel;
+    int result;
+    long numColumns, numRows;
+
+    closeChannel = FALSE;
+    channel = NULL;
+    memset(&args, 0, sizeof(args));
+    args.batchSize = DEF_BATCH_SIZE;
+    rowIterSwitch.clientData = table;
+    columnIterSwitch.clientData = table;
+    blt_table_iterate_all_rows(table, &args.ri);
+    blt_table_iterate_all_columns(table, &args.ci);
+    if (Blt_ParseSwitches(interp, exportSwitches, objc - 3, objv + 3, &args,
+        BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    result = TCL_ERROR;
+    cols = NULL;
+    rows = NULL;
+    if (args.fileObjPtr != NULL) {
+        const char *fileName;
+
+        closeChannel = TRUE;
+        fileName = Tcl_GetString(args.fileObjPtr);
+        if ((fileName[0] == '@') && (fileName[1] != '\0')) {
+            int mode;
+
+            channel = Tcl_GetChannel(interp, fileName+1, &mode);
+            if (channel == NULL) {
+                goto error;
+            }
+            if ((mode & TCL_WRITABLE) == 0) {
+                Tcl_AppendResult(interp, "channel \"", fileName,
+                                 "\" not opened for writing", (char *)NULL);
+                goto error;
+            }
+            closeChannel = FALSE;
+        } else {
+            channel = Tcl_OpenFileChannel(interp, fileName, "w", 0666);
+            if (channel == NULL) {
+                goto error;     /* Can't open export file. */
+            }
+        }
+        if (Tcl_SetChannelOption(interp, channel, "-translation", "binary")
+            != TCL_OK) {
+            goto error;
+        }
+    }
+    cols = Blt_AssertMalloc((blt_table_num_columns(table) + 1) *
+                            sizeof(BLT_TABLE_COLUMN));
+    numColumns = 0;
+    for (col = blt_table_first_tagged_column(&args.ci); col != NULL;
+         col = blt_table_next_tagged_column(&args.ci)) {
+        cols[numColumns++] = col;
+    }
+    rows = Blt_AssertMalloc((blt_table_num_rows(table) + 1) *
+                            sizeof(BLT_TABLE_ROW));
+    numRows = 0;
+    for (row = blt_table_first_tagged_row(&args.ri); row != NULL;
+         row = blt_table_next_tagged_row(&args.ri)) {
+        rows[numRows++] = row;
+    }
+    memset(&writer, 0, sizeof(writer));
+    writer.channel = channel;
+    if (channel == NULL) {
+        writer.dbuffer = Blt_DBuffer_Create();
+    }
+    ExportArrow(table, &writer, &args, numColumns, cols, numRows, rows);
+    if (writer.error) {
+        Tcl_AppendResult(interp, "can't write arrow data: ",
+                         Tcl_PosixError(interp), (char *)NULL);
+    } else {
+        if (channel == NULL) {
+            Tcl_SetObjResult(interp,
+                             Blt_DBuffer_ByteArrayObj(writer.dbuffer));
+        }
+        result = TCL_OK;
+    }
+    if (writer.dbuffer != NULL) {
+        Blt_DBuffer_Destroy(writer.dbuffer);
+    }
+ error:
+    if (cols != NULL) {
+        Blt_Free(cols);
+    }
+    if (rows != NULL) {
+        Blt_Free(rows);
+    }
+    if ((closeChannel) && (channel != NULL)) {
+        Tcl_Close(interp, channel);
+    }
+    Blt_FreeSwitches(exportSwitches, (char *)&args, 0);
+    return result;
+}
+
+int
+blt_table_arrow_init(Tcl_Interp *interp)
+{
+#ifdef USE_TCL_STUBS
+    if (Tcl_InitStubs(interp, TCL_VERSION_COMPILED, PKG_ANY) == NULL) {
+        return TCL_ERROR;
+    };
+#endif
+#ifdef USE_BLT_STUBS
+    if (Blt_InitTclStubs(interp, BLT_VERSION, PKG_EXACT) == NULL) {
+        return TCL_ERROR;
+    };
+#else
+    if (Tcl_PkgRequire(interp, "blt_tcl", BLT_VERSION, PKG_EXACT) == NULL) {
+        return TCL_ERROR;
+    }
+#endif
+    if (Tcl_PkgProvide(interp, "blt_datatable_arrow", BLT_VERSION) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    return blt_table_register_format(interp,
+        "arrow",                /* Name of format. */
+        ImportArrowProc,        /* Import procedure. */
+        ExportArrowProc);       /* Export procedure. */
+}
+
+int
+blt_table_arrow_safe_init(Tcl_Interp *interp)
+{
+    return blt_table_arrow_init(interp);
+}
+
+#endif /* NO_DATATABLE */
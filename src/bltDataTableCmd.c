@@ -56,6 +56,10 @@
   #include <ctype.h>
 #endif /* HAVE_CTYPE_H */
 
+#ifdef HAVE_ERRNO_H
+  #include <errno.h>
+#endif /* HAVE_ERRNO_H */
+
 #include "tclIntDecls.h"
 
 #include "bltMath.h"
@@ -136,6 +140,7 @@ typedef struct {
 enum DataFormats {
     FMT_TXT,                            /* Comma separated value files */
     FMT_CSV,                            /* Comma separated value files r/w */
+    FMT_ARROW,                          /* Arrow IPC files r/w */
 #ifdef HAVE_LIBMYSQL
     FMT_MYSQL,                          /* Mysql r/w */
 #endif
@@ -156,6 +161,7 @@ enum DataFormats {
 static DataFormat dataFormats[] = {
     { "txt" },                          /* White space separated values */
     { "csv" },                          /* Comma separated values */
+    { "arrow" },                        /* Arrow IPC columnar data */
 #ifdef HAVE_LIBMYSQL
     { "mysql" },                        /* mysql client library. */
 #endif
@@ -482,6 +488,8 @@ static Blt_SwitchSpec moveSwitches[] =
     {BLT_SWITCH_END}
 };
 
+#define DUMP_BINARY     (1<<0)          /* Write a binary snapshot. */
+
 typedef struct {
     /* Private data */
     Tcl_Channel channel;
@@ -495,6 +503,8 @@ typedef struct {
 
 static Blt_SwitchSpec dumpSwitches[] = 
 {
+    {BLT_SWITCH_BITS_NOARG, "-binary", "", (char *)NULL,
+        Blt_Offset(DumpSwitches, flags), 0, DUMP_BINARY},
     {BLT_SWITCH_CUSTOM, "-rows",    "rows", (char *)NULL,
         Blt_Offset(DumpSwitches, ri),      0, 0, &rowIterSwitch},
     {BLT_SWITCH_CUSTOM, "-columns", "columns", (char *)NULL,
@@ -646,6 +656,47 @@ static Blt_SwitchSpec findSwitches[] =
     {BLT_SWITCH_END}
 };
 
+typedef struct {
+    Tcl_Obj *onObjPtr;                  /* List of key columns. */
+    const char *how;                    /* "inner" or "left". */
+    const char *suffix;                 /* Suffix for clashing labels. */
+} TableJoinSwitches;
+
+static Blt_SwitchSpec tableJoinSwitches[] = 
+{
+    {BLT_SWITCH_STRING, "-how",    "inner|left", (char *)NULL,
+        Blt_Offset(TableJoinSwitches, how), 0},
+    {BLT_SWITCH_OBJ,    "-on",     "columnList", (char *)NULL,
+        Blt_Offset(TableJoinSwitches, onObjPtr), 0},
+    {BLT_SWITCH_STRING, "-suffix", "string", (char *)NULL,
+        Blt_Offset(TableJoinSwitches, suffix), 0},
+    {BLT_SWITCH_END}
+};
+
+typedef struct {
+    Tcl_Obj *byObjPtr;                  /* List of columns to group by. */
+    Tcl_Obj *objv[5];                   /* Column lists for each
+                                         * aggregate, indexed by the
+                                         * TABLE_AGGREGATE_* values. */
+} AggregateSwitches;
+
+static Blt_SwitchSpec aggregateSwitches[] = 
+{
+    {BLT_SWITCH_OBJ,    "-by",    "columnList", (char *)NULL,
+        Blt_Offset(AggregateSwitches, byObjPtr), 0},
+    {BLT_SWITCH_OBJ,    "-count", "columnList", (char *)NULL,
+        Blt_Offset(AggregateSwitches, objv[TABLE_AGGREGATE_COUNT]), 0},
+    {BLT_SWITCH_OBJ,    "-max",   "columnList", (char *)NULL,
+        Blt_Offset(AggregateSwitches, objv[TABLE_AGGREGATE_MAX]), 0},
+    {BLT_SWITCH_OBJ,    "-mean",  "columnList", (char *)NULL,
+        Blt_Offset(AggregateSwitches, objv[TABLE_AGGREGATE_MEAN]), 0},
+    {BLT_SWITCH_OBJ,    "-min",   "columnList", (char *)NULL,
+        Blt_Offset(AggregateSwitches, objv[TABLE_AGGREGATE_MIN]), 0},
+    {BLT_SWITCH_OBJ,    "-sum",   "columnList", (char *)NULL,
+        Blt_Offset(AggregateSwitches, objv[TABLE_AGGREGATE_SUM]), 0},
+    {BLT_SWITCH_END}
+};
+
 static BLT_TABLE_TRACE_PROC TraceProc;
 static BLT_TABLE_TRACE_DELETE_PROC TraceDeleteProc;
 
@@ -653,6 +704,7 @@ static BLT_TABLE_NOTIFY_EVENT_PROC NotifyProc;
 static BLT_TABLE_NOTIFIER_DELETE_PROC NotifierDeleteProc;
 
 static Tcl_CmdDeleteProc TableInstDeleteProc;
+static Tcl_FreeProc FreeCmdProc;
 static Tcl_InterpDeleteProc TableInterpDeleteProc;
 static Tcl_ObjCmdProc TableInstObjCmd;
 static Tcl_ObjCmdProc TableObjCmd;
@@ -1684,6 +1736,8 @@ static void
 FreeWatchInfo(WatchInfo *watchPtr)
 {
     Tcl_DecrRefCount(watchPtr->cmdObjPtr);
+    /* Don't let deleting the notifier free the watch again. */
+    watchPtr->notifier->deleteProc = NULL;
     blt_table_delete_notifier(watchPtr->cmdPtr->table, watchPtr->notifier);
     Blt_Free(watchPtr);
 }
@@ -1817,6 +1871,52 @@ NotifyProc(ClientData clientData, BLT_TABLE_NOTIFY_EVENT *eventPtr)
     return TCL_OK;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetFindColumn --
+ *
+ *      Returns the column referred to by the variable name in a find
+ *      expression.  Variables are either column indices ($N) or column
+ *      labels, possibly preceded by the user-defined prefix.
+ *
+ * Results:
+ *      Returns the column or NULL if the variable doesn't refer to a
+ *      column.
+ *
+ *---------------------------------------------------------------------------
+ */
+static BLT_TABLE_COLUMN
+GetFindColumn(FindSwitches *switchesPtr, const char *varName)
+{
+    BLT_TABLE_COLUMN col;
+    long index;
+    const char *prefix;
+    int prefixLen;
+
+    prefix = NULL;
+    prefixLen = 0;
+    if (switchesPtr->prefixObjPtr != NULL) {
+        prefix = Tcl_GetStringFromObj(switchesPtr->prefixObjPtr, &prefixLen);
+    }
+    col = NULL;
+    if ((isdigit(UCHAR(varName[0]))) &&
+        (Blt_GetLong(NULL, (const char *)varName, &index) == TCL_OK)) {
+        /* $N returns the value in the Nth column of the current row. */
+        col = blt_table_get_column_by_index(switchesPtr->table, index);
+    } else if (prefixLen == 0) {
+        /* $fieldName returns the value of the "fieldName" column of the
+         * current row. */
+        col = blt_table_get_column_by_label(switchesPtr->table, varName);
+    } else if (strncmp(varName, prefix, prefixLen) == 0) {
+        /* $pref_fieldName returns the value of the "fieldName" column of the
+         * current row. "pref_" is the user-defined prefix. */
+        col = blt_table_get_column_by_label(switchesPtr->table, 
+                                            varName + prefixLen);
+    }
+    return col;
+}
+
 static int
 ColumnVarResolverProc(
     Tcl_Interp *interp,                 /* Current interpreter. */
@@ -1831,10 +1931,7 @@ ColumnVarResolverProc(
     FindSwitches *switchesPtr;
     TableCmdInterpData *dataPtr;
     Tcl_Obj *valueObjPtr;
-    long index;
     char c;
-    const char *prefix;
-    int prefixLen;
 
     dataPtr = GetTableCmdInterpData(interp);
     hPtr = Blt_FindHashEntry(&dataPtr->findTable, nsPtr);
@@ -1846,13 +1943,7 @@ ColumnVarResolverProc(
         return TCL_CONTINUE;    
     }
     switchesPtr = Blt_GetHashValue(hPtr);
-    prefix = NULL;
-    prefixLen = 0;
-    if (switchesPtr->prefixObjPtr != NULL) {
-        prefix = Tcl_GetStringFromObj(switchesPtr->prefixObjPtr, &prefixLen);
-    }
     c = varName[0];
-    col = NULL;
     if ((c == '#') && (strcmp(varName, "#") == 0)) {
         /* $# returns the row number of the current row. */
         /* Look up the column from the variable name given. */
@@ -1860,20 +1951,7 @@ ColumnVarResolverProc(
         *varPtr = Blt_GetCachedVar(&switchesPtr->varTable,varName, valueObjPtr);
         return TCL_OK;
     } 
-    if ((isdigit(c)) &&
-        (Blt_GetLong(NULL, (const char *)varName, &index) == TCL_OK)) {
-        /* $N returns the value in the Nth column of the current row. */
-        col = blt_table_get_column_by_index(switchesPtr->table, index);
-    } else if (prefixLen == 0) {
-        /* $fieldName returns the value of the "fieldName" column of the
-         * current row. */
-        col = blt_table_get_column_by_label(switchesPtr->table, varName);
-    } else if (strncmp(varName, prefix, prefixLen) == 0) {
-        /* $pref_fieldName returns the value of the "fieldName" column of the
-         * current row. "pref_" is the user-defined prefix. */
-        col = blt_table_get_column_by_label(switchesPtr->table, 
-                                            varName + prefixLen);
-    }
+    col = GetFindColumn(switchesPtr, varName);
     if (col == NULL) {
         /* Variable name doesn't refer to any column. Pass it back to the TCL
          * interpreter and let it resolve the variable as usual. */
@@ -1910,1800 +1988,3390 @@ EvaluateExpr(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *exprObjPtr,
     return TCL_OK;
 }
 
-static int
-FindRows(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr, 
-         FindSwitches *switchesPtr)
-{
-    Blt_HashEntry *hPtr;
-    BLT_TABLE_ROW row;
-    TableCmdInterpData *dataPtr;
-    Tcl_Namespace *nsPtr;
-    Tcl_Obj *listObjPtr;
-    int isNew;
-    size_t numMatches;
-    int result = TCL_OK;
+/*
+ * Compiled find expressions.
+ *
+ *      Most find expressions are simple comparisons of columns against
+ *      constants joined by "&&" and "||", such as
+ *
+ *          $price > 100 && $region == "EU"
+ *
+ *      Rather than having TCL evaluate the expression and resolve every
+ *      column variable for each row, the expression is compiled once into
+ *      a tree of typed comparisons.  The comparisons are tested directly
+ *      against the internal (datum) values of double, long, int64, and
+ *      time columns and against the string values of string columns.
+ *      Packed columns are read in place, without being unpacked.  For
+ *      dictionary-encoded columns the string constant is compiled against
+ *      the column's dictionary, so rows are tested by their codes.
+ *
+ *      Expressions that can't be compiled are evaluated by TCL as before.
+ *      If a row can't be decided by the compiled plan (for example a
+ *      column value is empty or NaN), the row alone is handed to TCL.
+ *      This keeps error reporting and the -emptyvalue switch exactly the
+ *      same as the uncompiled path.
+ */
+#define FIND_NODE_COMPARE       0
+#define FIND_NODE_AND           1
+#define FIND_NODE_OR            2
+#define FIND_NODE_NOT           3
 
-    Tcl_AddInterpResolvers(interp, TABLE_FIND_KEY, (Tcl_ResolveCmdProc*)NULL,
-        ColumnVarResolverProc, (Tcl_ResolveCompiledVarProc*)NULL);
+#define FIND_OP_EQ              0
+#define FIND_OP_NE              1
+#define FIND_OP_LT              2
+#define FIND_OP_LE              3
+#define FIND_OP_GT              4
+#define FIND_OP_GE              5
 
-    dataPtr = GetTableCmdInterpData(interp);
-    nsPtr = Tcl_GetCurrentNamespace(interp);
-    hPtr = Blt_CreateHashEntry(&dataPtr->findTable, nsPtr, &isNew);
-    assert(isNew);
-    Blt_SetHashValue(hPtr, switchesPtr);
+#define FIND_COMPARE_DOUBLE     0       /* Compare as doubles. */
+#define FIND_COMPARE_INT64      1       /* Compare as 64-bit integers. */
+#define FIND_COMPARE_STRING     2       /* Compare as strings. */
+#define FIND_COMPARE_CODE       3       /* Compare the codes of an encoded
+                                         * column. */
 
-    /* Now process each row, evaluating the expression. */
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    numMatches = 0;
-    for (row = blt_table_first_tagged_row(&switchesPtr->iter); row != NULL; 
-         row = blt_table_next_tagged_row(&switchesPtr->iter)) {
-        int bool;
-        
-        switchesPtr->row = row;
-        result = EvaluateExpr(interp, table, objPtr, &bool);
-        if (result != TCL_OK) {
-            break;
-        }
-        if (switchesPtr->flags & FIND_INVERT) {
-            bool = !bool;
-        }
-        if (bool) {
-            Tcl_Obj *objPtr;
+#define FIND_FALSE              0
+#define FIND_TRUE               1
+#define FIND_UNKNOWN            -1      /* Let TCL evaluate the row. */
+
+/* Largest integer that can be exactly represented by a double. */
+#define FIND_MAX_EXACT          9007199254740992.0
+
+typedef struct _FindNode {
+    int type;                           /* Type of node: compare, and, or,
+                                         * or not. */
+    struct _FindNode *leftPtr;          /* Operands of logical nodes. */
+    struct _FindNode *rightPtr;
+    BLT_TABLE_COLUMN col;               /* Column compared. */
+    int op;                             /* Comparison operator. */
+    int mode;                           /* How to compare: as doubles,
+                                         * integers, or strings. */
+    double d;                           /* Numeric constant. */
+    int64_t i64;
+    char *string;                       /* String constant. */
+    int length;                         /* # of bytes in string. */
+    unsigned int code;                  /* Encoded columns: code of the
+                                         * string constant. 0 if it's not
+                                         * in the dictionary. */
+    unsigned int numCodes;              /* Encoded columns: # of codes in
+                                         * the dictionary when compiled. */
+    signed char *cmps;                  /* Encoded columns: for the
+                                         * ordering operators, the string
+                                         * of each code compared with the
+                                         * constant. */
+} FindNode;
 
-            if (switchesPtr->tag != NULL) {
-                result = blt_table_set_row_tag(interp, table, row,
-                        switchesPtr->tag);
-                if (result != TCL_OK) {
-                    break;
-                }
-            }
-            numMatches++;
-            objPtr = GetRowIndexObj(table, row);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-            if ((switchesPtr->maxMatches > 0) && 
-                (numMatches >= switchesPtr->maxMatches)) {
-                break;
-            }
-        }
+typedef struct {
+    const char *next;                   /* Next character to parse. */
+    FindSwitches *switchesPtr;          /* Used to resolve column
+                                         * variables. */
+} FindParser;
+
+static void
+FreeFindNode(FindNode *nodePtr)
+{
+    if (nodePtr == NULL) {
+        return;
     }
-    if (result != TCL_OK) {
-        Tcl_DecrRefCount(listObjPtr);
-    } else {
-        Tcl_SetObjResult(interp, listObjPtr);
+    FreeFindNode(nodePtr->leftPtr);
+    FreeFindNode(nodePtr->rightPtr);
+    if (nodePtr->string != NULL) {
+        Blt_Free(nodePtr->string);
     }
-    /* Clean up. */
-    Blt_DeleteHashEntry(&dataPtr->findTable, hPtr);
-    Blt_FreeCachedVars(&switchesPtr->varTable);
-    if (!Tcl_RemoveInterpResolvers(interp, TABLE_FIND_KEY)) {
-        Tcl_AppendResult(interp, "can't delete resolver scheme", 
-                (char *)NULL);
-        return TCL_ERROR;
+    if (nodePtr->cmps != NULL) {
+        Blt_Free(nodePtr->cmps);
     }
-    return result;
+    Blt_Free(nodePtr);
 }
 
-static int
-AppendColumn(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst,
-    BLT_TABLE_COLUMN srcCol,            /* Column in the source table. */
-    BLT_TABLE_COLUMN dstCol)            /* Column in the dstination table. */
+static FindNode *
+NewFindNode(int type, FindNode *leftPtr, FindNode *rightPtr)
 {
-    size_t i, j, oldNumRows, need;
-    BLT_TABLE_COLUMN_TYPE type;
-    
-    oldNumRows = blt_table_num_rows(src);
-    need = oldNumRows + blt_table_num_rows(dst);
-    if (blt_table_extend_rows(interp, dst, need, NULL) != TCL_OK) {
-        return TCL_ERROR;
+    FindNode *nodePtr;
+
+    nodePtr = Blt_AssertCalloc(1, sizeof(FindNode));
+    nodePtr->type = type;
+    nodePtr->leftPtr = leftPtr;
+    nodePtr->rightPtr = rightPtr;
+    return nodePtr;
+}
+
+static void
+SkipFindSpaces(FindParser *parserPtr)
+{
+    while (isspace(UCHAR(*parserPtr->next))) {
+        parserPtr->next++;
     }
-    for (i = 0, j = oldNumRows; i < blt_table_num_rows(src); i++, j++) {
-        BLT_TABLE_ROW srcRow, dstRow;
-        BLT_TABLE_VALUE value;
+}
 
-        srcRow = blt_table_row(src, i);
-        value = blt_table_get_value(src, srcRow, srcCol);
-        if (value == NULL) {
-            continue;
-        }
-        dstRow = blt_table_row(dst, j);
-        if (blt_table_set_value(dst, dstRow, dstCol, value) != TCL_OK) {
-            return TCL_ERROR;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * IsDecimalNumber --
+ *
+ *      Indicates if the string is a plain decimal number: an optional
+ *      sign, digits, an optional fraction and exponent.  Numbers that TCL
+ *      may interpret differently (octal, hexadecimal, whitespace, Inf,
+ *      etc.) are rejected.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+IsDecimalNumber(const char *s, int length, int *isIntPtr)
+{
+    const char *p, *pend;
+    int numDigits;
+
+    p = s;
+    pend = s + length;
+    *isIntPtr = TRUE;
+    if ((p < pend) && ((*p == '-') || (*p == '+'))) {
+        p++;
+    }
+    if ((p < (pend - 1)) && (p[0] == '0') && (isdigit(UCHAR(p[1])))) {
+        return FALSE;                   /* Octal in older TCLs. */
+    }
+    numDigits = 0;
+    while ((p < pend) && (isdigit(UCHAR(*p)))) {
+        p++, numDigits++;
+    }
+    if ((p < pend) && (*p == '.')) {
+        *isIntPtr = FALSE;
+        p++;
+        while ((p < pend) && (isdigit(UCHAR(*p)))) {
+            p++, numDigits++;
         }
     }
-    type = blt_table_column_type(dstCol);
-    if (blt_table_set_column_type(interp, dst, dstCol, type) != TCL_OK) {
-        return TCL_ERROR;
+    if (numDigits == 0) {
+        return FALSE;
     }
-    return TCL_OK;
-}           
+    if ((p < pend) && ((*p == 'e') || (*p == 'E'))) {
+        *isIntPtr = FALSE;
+        p++;
+        if ((p < pend) && ((*p == '-') || (*p == '+'))) {
+            p++;
+        }
+        if ((p == pend) || (!isdigit(UCHAR(*p)))) {
+            return FALSE;
+        }
+        while ((p < pend) && (isdigit(UCHAR(*p)))) {
+            p++;
+        }
+    }
+    return (p == pend);
+}
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ParseFindOperand --
+ *
+ *      Parses either a column variable ($name or ${name}) or a constant
+ *      (number, "string", or {string}).  Quoted strings must not contain
+ *      substitutions.
+ *
+ * Results:
+ *      Returns TCL_OK if an operand was parsed.  Either *colPtr is set to
+ *      the column, or *stringPtr is set to a malloc-ed copy of the
+ *      constant and *isNumPtr indicates if it's a plain decimal number.
+ *      Otherwise TCL_ERROR is returned.
+ *
+ *---------------------------------------------------------------------------
+ */
 static int
-CopyColumn(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst,
-    BLT_TABLE_COLUMN scol,                /* Column in the source table. */
-    BLT_TABLE_COLUMN dcol)                /* Column in the destination table. */
+ParseFindOperand(FindParser *parserPtr, BLT_TABLE_COLUMN *colPtr,
+                 char **stringPtr, int *lengthPtr, int *isNumPtr)
 {
-    BLT_TABLE_ROW srow, drow;
-    size_t i, srcNumRows, dstNumRows;
+    const char *p, *start;
+    char *string;
+    int length;
 
-    if ((blt_table_same_object(src, dst)) && (scol == dcol)) {
-        return TCL_OK;                  /* Source and destination columns are
-                                         * the same column in the same
-                                         * table. */
+    SkipFindSpaces(parserPtr);
+    *colPtr = NULL;
+    *stringPtr = NULL;
+    *isNumPtr = FALSE;
+    p = parserPtr->next;
+    if (*p == '$') {
+        char *varName;
+
+        p++;
+        if (*p == '{') {
+            p++;
+            start = p;
+            while ((*p != '}') && (*p != '\0')) {
+                p++;
+            }
+            if (*p != '}') {
+                return TCL_ERROR;
+            }
+            length = p - start;
+            p++;
+        } else {
+            start = p;
+            while ((isalnum(UCHAR(*p))) || (*p == '_')) {
+                p++;
+            }
+            length = p - start;
+            if ((*p == ':') || (*p == '(')) {
+                return TCL_ERROR;       /* Namespace or array variable. */
+            }
+        }
+        if (length == 0) {
+            return TCL_ERROR;
+        }
+        varName = Blt_AssertMalloc(length + 1);
+        memcpy(varName, start, length);
+        varName[length] = '\0';
+        *colPtr = GetFindColumn(parserPtr->switchesPtr, varName);
+        Blt_Free(varName);
+        if (*colPtr == NULL) {
+            return TCL_ERROR;           /* Not a column variable. */
+        }
+        parserPtr->next = p;
+        return TCL_OK;
     }
-    srcNumRows = blt_table_num_rows(src);
-    dstNumRows = blt_table_num_rows(dst);
-    if (srcNumRows >  dstNumRows) {
-        size_t need;
-
-        need = (srcNumRows - dstNumRows);
-        if (blt_table_extend_rows(interp, dst, need, NULL) != TCL_OK) {
+    if ((*p == '"') || (*p == '{')) {
+        char endChar;
+        int isInt;
+
+        endChar = (*p == '"') ? '"' : '}';
+        p++;
+        start = p;
+        while ((*p != endChar) && (*p != '\0')) {
+            if ((*p == '\\') || (*p == '{') || 
+                ((endChar == '"') && ((*p == '$') || (*p == '[')))) {
+                return TCL_ERROR;       /* Substitution or nested braces. */
+            }
+            p++;
+        }
+        if (*p != endChar) {
             return TCL_ERROR;
         }
+        length = p - start;
+        string = Blt_AssertMalloc(length + 1);
+        memcpy(string, start, length);
+        string[length] = '\0';
+        p++;
+        if (IsDecimalNumber(string, length, &isInt)) {
+            *isNumPtr = TRUE;
+        } else {
+            double d;
+
+            if (Tcl_GetDouble(NULL, string, &d) == TCL_OK) {
+                Blt_Free(string);
+                return TCL_ERROR;       /* TCL may consider this to be a
+                                         * number. */
+            }
+        }
+        *stringPtr = string;
+        *lengthPtr = length;
+        parserPtr->next = p;
+        return TCL_OK;
     }
-    if (blt_table_set_column_type(interp, dst, dcol,
-        blt_table_column_type(scol)) != TCL_OK) {
+    start = p;
+    if ((*p == '-') || (*p == '+')) {
+        p++;
+    }
+    if ((!isdigit(UCHAR(*p))) && (*p != '.')) {
         return TCL_ERROR;
     }
-    for (srow = blt_table_first_row(src), drow = blt_table_first_row(dst);
-         srow != NULL;
-         srow = blt_table_next_row(srow), drow = blt_table_next_row(drow)) {
-        BLT_TABLE_VALUE value;
-        
-        value = blt_table_get_value(src, srow, scol);
-        if (value == NULL) {
-            continue;
-        }
-        if (blt_table_set_value(dst, drow, dcol, value) != TCL_OK) {
+    while ((isalnum(UCHAR(*p))) || (*p == '.') || 
+           (((*p == '-') || (*p == '+')) && ((p[-1] == 'e') || 
+                                            (p[-1] == 'E')))) {
+        p++;
+    }
+    length = p - start;
+    {
+        int isInt;
+
+        if (!IsDecimalNumber(start, length, &isInt)) {
             return TCL_ERROR;
         }
     }
-    for (i = srcNumRows; i < dstNumRows; i++) {
-        BLT_TABLE_ROW drow;
-
-        drow = blt_table_row(dst, i);
-        blt_table_unset_value(dst, drow, dcol);
-    }
+    string = Blt_AssertMalloc(length + 1);
+    memcpy(string, start, length);
+    string[length] = '\0';
+    *stringPtr = string;
+    *lengthPtr = length;
+    *isNumPtr = TRUE;
+    parserPtr->next = p;
     return TCL_OK;
-}           
+}
 
-static void
-CopyColumnTags(BLT_TABLE src, BLT_TABLE dst,
-    BLT_TABLE_COLUMN c1,        /* Column in the source table. */
-    BLT_TABLE_COLUMN c2)        /* Column in the dstination table. */
+static int
+ParseFindOperator(FindParser *parserPtr, int *opPtr)
 {
-    Blt_Chain chain;
-    Blt_ChainLink link;
-
-    /* Find all tags for with this column index. */
-    chain = blt_table_get_column_tags(src, c1);
-    for (link = Blt_Chain_FirstLink(chain); link != NULL;
-         link = Blt_Chain_NextLink(link)) {
-        const char *tag;
+    const char *p;
 
-        tag = Blt_Chain_GetValue(link);
-        blt_table_set_column_tag(NULL, dst, c2, tag);
+    SkipFindSpaces(parserPtr);
+    p = parserPtr->next;
+    if ((p[0] == '=') && (p[1] == '=')) {
+        *opPtr = FIND_OP_EQ, p += 2;
+    } else if ((p[0] == '!') && (p[1] == '=')) {
+        *opPtr = FIND_OP_NE, p += 2;
+    } else if ((p[0] == '<') && (p[1] == '=')) {
+        *opPtr = FIND_OP_LE, p += 2;
+    } else if ((p[0] == '>') && (p[1] == '=')) {
+        *opPtr = FIND_OP_GE, p += 2;
+    } else if ((p[0] == '<') && (p[1] != '<')) {
+        *opPtr = FIND_OP_LT, p++;
+    } else if ((p[0] == '>') && (p[1] != '>')) {
+        *opPtr = FIND_OP_GT, p++;
+    } else {
+        return TCL_ERROR;               /* String operators (eq, ne, etc.)
+                                         * are left to TCL. */
     }
-}           
+    parserPtr->next = p;
+    return TCL_OK;
+}
 
-static void
-ClearTable(BLT_TABLE table) 
+/* Compares strings the same as TCL's string comparisons: byte by byte,
+ * with a shorter string first. */
+static INLINE int
+CompareFindStrings(const char *s1, int length1, const char *s2, int length2)
 {
-    BLT_TABLE_COLUMN col, nextCol;
-    BLT_TABLE_ROW row, nextRow;
+    int cmp;
 
-    for (col = blt_table_first_column(table); col != NULL; col = nextCol) {
-        nextCol = blt_table_next_column(col);
-        blt_table_delete_column(table, col);
-    }
-    for (row = blt_table_first_row(table); row != NULL;  row = nextRow) {
-        nextRow = blt_table_next_row(row);
-        blt_table_delete_row(table, row);
+    cmp = memcmp(s1, s2, MIN(length1, length2));
+    if (cmp == 0) {
+        cmp = length1 - length2;
     }
+    return cmp;
 }
 
-static int
-CopyColumnLabel(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst,
-                BLT_TABLE_COLUMN c1, BLT_TABLE_COLUMN c2) 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * CompileEncodedConstant --
+ *
+ *      Compiles the string constant compared with a dictionary-encoded
+ *      column.  For "==" and "!=", the constant becomes its code in the
+ *      column's dictionary.  For the other operators, the constant is
+ *      compared once with each string in the dictionary.  Either way,
+ *      rows are then tested by their codes, without touching the strings.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+CompileEncodedConstant(FindNode *nodePtr)
 {
-    const char *label;
+    unsigned int i;
 
-    label = blt_table_column_label(c1);
-    if (blt_table_set_column_label(interp, dst, c2, label) != TCL_OK) {
-        return TCL_ERROR;
+    nodePtr->mode = FIND_COMPARE_CODE;
+    nodePtr->numCodes = blt_table_num_encoded_codes(nodePtr->col);
+    if ((nodePtr->op == FIND_OP_EQ) || (nodePtr->op == FIND_OP_NE)) {
+        nodePtr->code = blt_table_find_encoded_code(nodePtr->col, 
+                nodePtr->string, nodePtr->length);
+        return;
+    }
+    nodePtr->cmps = Blt_AssertMalloc(nodePtr->numCodes);
+    nodePtr->cmps[0] = 0;               /* Empty values aren't compared. */
+    for (i = 1; i < nodePtr->numCodes; i++) {
+        const char *string;
+        int length, cmp;
+
+        string = blt_table_encoded_string(nodePtr->col, i, &length);
+        cmp = CompareFindStrings(string, length, nodePtr->string, 
+                                 nodePtr->length);
+        nodePtr->cmps[i] = (cmp < 0) ? -1 : (cmp > 0);
     }
-    return TCL_OK;
 }
 
-static int
-CopyTable(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst) 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ParseFindComparison --
+ *
+ *      Parses a comparison between a column and a constant.  The
+ *      comparison mode is picked from the column type and the constant,
+ *      following the rules that TCL's expr uses: numbers are compared
+ *      numerically, otherwise strings are compared.  Combinations that
+ *      depend on the value in each row (e.g. a number against a string
+ *      column) aren't compiled.
+ *
+ *---------------------------------------------------------------------------
+ */
+static FindNode *
+ParseFindComparison(FindParser *parserPtr)
 {
-    size_t i;
-
-    if (blt_table_same_object(src, dst)) {
-        return TCL_OK;                  /* Source and destination are the
-                                         * same table. */
+    BLT_TABLE_COLUMN leftCol, rightCol, col;
+    FindNode *nodePtr;
+    char *leftString, *rightString, *string;
+    int leftLength, rightLength, length;
+    int leftIsNum, rightIsNum, isNum;
+    int op, isInt;
+    
+    leftString = rightString = NULL;
+    if (ParseFindOperand(parserPtr, &leftCol, &leftString, &leftLength, 
+                         &leftIsNum) != TCL_OK) {
+        return NULL;
     }
-    ClearTable(dst);
-    if (blt_table_num_columns(src) > blt_table_num_columns(dst)) {
-        size_t count;
-
-        count = blt_table_num_columns(src) - blt_table_num_columns(dst);
-        blt_table_extend_columns(interp, dst, count, NULL);
+    if (ParseFindOperator(parserPtr, &op) != TCL_OK) {
+        goto error;
     }
-    for (i = 0; i < blt_table_num_columns(src); i++) {
-        BLT_TABLE_COLUMN c1, c2;
-
-        c1 = blt_table_column(src, i);
-        c2 = blt_table_column(dst, i);
-        if (CopyColumn(interp, src, dst, c1, c2) != TCL_OK) {
-            return TCL_ERROR;
+    if (ParseFindOperand(parserPtr, &rightCol, &rightString, &rightLength, 
+                         &rightIsNum) != TCL_OK) {
+        goto error;
+    }
+    if ((leftCol != NULL) && (rightString != NULL)) {
+        col = leftCol;
+        string = rightString, length = rightLength, isNum = rightIsNum;
+        rightString = NULL;
+    } else if ((rightCol != NULL) && (leftString != NULL)) {
+        /* Constant is on the left, swap the sense of the operator. */
+        col = rightCol;
+        string = leftString, length = leftLength, isNum = leftIsNum;
+        leftString = NULL;
+        switch (op) {
+        case FIND_OP_LT: op = FIND_OP_GT; break;
+        case FIND_OP_LE: op = FIND_OP_GE; break;
+        case FIND_OP_GT: op = FIND_OP_LT; break;
+        case FIND_OP_GE: op = FIND_OP_LE; break;
         }
-        if (CopyColumnLabel(interp, src, dst, c1, c2) != TCL_OK) {
-            return TCL_ERROR;
+    } else {
+        goto error;                     /* Must be a column and a
+                                         * constant. */
+    }
+    nodePtr = NewFindNode(FIND_NODE_COMPARE, NULL, NULL);
+    nodePtr->col = col;
+    nodePtr->op = op;
+    nodePtr->string = string;
+    nodePtr->length = length;
+    switch (blt_table_column_type(col)) {
+    case TABLE_COLUMN_TYPE_DOUBLE:
+    case TABLE_COLUMN_TYPE_TIME:
+    case TABLE_COLUMN_TYPE_LONG:
+    case TABLE_COLUMN_TYPE_INT64:
+        if (!isNum) {
+            goto badNode;
+        }
+        IsDecimalNumber(string, length, &isInt);
+        nodePtr->d = strtod(string, NULL);
+        if (!FINITE(nodePtr->d)) {
+            goto badNode;
+        }
+        nodePtr->mode = FIND_COMPARE_DOUBLE;
+        if ((isInt) && (blt_table_column_type(col) != TABLE_COLUMN_TYPE_DOUBLE)
+            && (blt_table_column_type(col) != TABLE_COLUMN_TYPE_TIME)) {
+            char *end;
+
+            errno = 0;
+            nodePtr->i64 = strtoll(string, &end, 10);
+            if (errno != 0) {
+                goto badNode;           /* Overflow. */
+            }
+            nodePtr->mode = FIND_COMPARE_INT64;
+        } else if (fabs(nodePtr->d) > FIND_MAX_EXACT) {
+            goto badNode;
         }
-        CopyColumnTags(src, dst, c1, c2);
+        break;
+    case TABLE_COLUMN_TYPE_STRING:
+        if (isNum) {
+            goto badNode;
+        }
+        nodePtr->mode = FIND_COMPARE_STRING;
+        if (blt_table_column_is_encoded(col)) {
+            CompileEncodedConstant(nodePtr);
+        }
+        break;
+    default:
+        goto badNode;
     }
-    return TCL_OK;
+    return nodePtr;
+ badNode:
+    FreeFindNode(nodePtr);
+ error:
+    if (leftString != NULL) {
+        Blt_Free(leftString);
+    }
+    if (rightString != NULL) {
+        Blt_Free(rightString);
+    }
+    return NULL;
 }
 
+static FindNode *ParseFindOr(FindParser *parserPtr);
 
-static int
-CopyRow(Tcl_Interp *interp, BLT_TABLE srcTable, BLT_TABLE destTable,
-    BLT_TABLE_ROW srcRow,               /* Row offset in the source table. */
-    BLT_TABLE_ROW destRow)              /* Row offset in the destination. */
+static FindNode *
+ParseFindUnary(FindParser *parserPtr)
 {
-    size_t i;
+    FindNode *nodePtr;
 
-    if ((blt_table_same_object(srcTable, destTable)) && 
-        (srcRow == destRow)) {
-        return TCL_OK;          /* Source and destination are the same. */
-    }
-    if (blt_table_num_columns(srcTable) > blt_table_num_columns(destTable)) {
-        size_t needed;
+    SkipFindSpaces(parserPtr);
+    if ((parserPtr->next[0] == '!') && (parserPtr->next[1] != '=')) {
+        const char *p;
 
-        needed = blt_table_num_columns(srcTable) - 
-            blt_table_num_columns(destTable);
-        if (blt_table_extend_columns(interp, destTable, needed, NULL)!=TCL_OK) {
-            return TCL_ERROR;
+        /* Only allow "!" before a parenthesized expression or another
+         * "!".  Since "!" binds tighter than comparisons, "!$a > 1" is
+         * left to TCL. */
+        p = parserPtr->next + 1;
+        while (isspace(UCHAR(*p))) {
+            p++;
         }
+        if ((*p != '(') && (*p != '!')) {
+            return NULL;
+        }
+        parserPtr->next = p;
+        nodePtr = ParseFindUnary(parserPtr);
+        if (nodePtr == NULL) {
+            return NULL;
+        }
+        return NewFindNode(FIND_NODE_NOT, nodePtr, NULL);
     }
-    for (i = 0; i < blt_table_num_columns(srcTable); i++) {
-        BLT_TABLE_COLUMN col;
-        BLT_TABLE_VALUE value;
-
-        col = blt_table_column(srcTable, i);
-        value = blt_table_get_value(srcTable, srcRow, col);
-        col = blt_table_column(destTable, i);
-        if (blt_table_set_value(destTable, destRow, col, value)!= TCL_OK) {
-            return TCL_ERROR;
+    if (parserPtr->next[0] == '(') {
+        parserPtr->next++;
+        nodePtr = ParseFindOr(parserPtr);
+        if (nodePtr == NULL) {
+            return NULL;
+        }
+        SkipFindSpaces(parserPtr);
+        if (parserPtr->next[0] != ')') {
+            FreeFindNode(nodePtr);
+            return NULL;
         }
+        parserPtr->next++;
+        return nodePtr;
     }
-    return TCL_OK;
-}           
+    return ParseFindComparison(parserPtr);
+}
 
-static void
-CopyRowTags(BLT_TABLE srcTable, BLT_TABLE destTable,
-    BLT_TABLE_ROW srcRow,               /* Row in the source table. */
-    BLT_TABLE_ROW destRow)              /* Row in the destination table. */
+static FindNode *
+ParseFindAnd(FindParser *parserPtr)
 {
-    Blt_Chain chain;
-    Blt_ChainLink link;
+    FindNode *nodePtr;
 
-    /* Get all tags for this particular row in the source table. */
-    chain = blt_table_get_row_tags(srcTable, srcRow);
-    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
-         link = Blt_Chain_NextLink(link)) {
-        const char *tag;
+    nodePtr = ParseFindUnary(parserPtr);
+    while (nodePtr != NULL) {
+        FindNode *rightPtr;
 
-        tag = Blt_Chain_GetValue(link);
-        blt_table_set_row_tag(NULL, destTable, destRow, tag);
+        SkipFindSpaces(parserPtr);
+        if ((parserPtr->next[0] != '&') || (parserPtr->next[1] != '&')) {
+            break;
+        }
+        parserPtr->next += 2;
+        rightPtr = ParseFindUnary(parserPtr);
+        if (rightPtr == NULL) {
+            FreeFindNode(nodePtr);
+            return NULL;
+        }
+        nodePtr = NewFindNode(FIND_NODE_AND, nodePtr, rightPtr);
     }
-    Blt_Chain_Destroy(chain);
-}           
-
+    return nodePtr;
+}
 
-static int
-WriteRecord(Tcl_Channel channel, Tcl_DString *dsPtr)
+static FindNode *
+ParseFindOr(FindParser *parserPtr)
 {
-    int length, numWritten;
-    char *line;
+    FindNode *nodePtr;
 
-    length = Tcl_DStringLength(dsPtr);
-    line = Tcl_DStringValue(dsPtr);
-#if HAVE_UTF
-#ifdef notdef
-    numWritten = Tcl_WriteChars(channel, line, length);
-#endif
-    numWritten = Tcl_Write(channel, line, length);
-#else
-    numWritten = Tcl_Write(channel, line, length);
-#endif
-    if (numWritten != length) {
-        return FALSE;
+    nodePtr = ParseFindAnd(parserPtr);
+    while (nodePtr != NULL) {
+        FindNode *rightPtr;
+
+        SkipFindSpaces(parserPtr);
+        if ((parserPtr->next[0] != '|') || (parserPtr->next[1] != '|')) {
+            break;
+        }
+        parserPtr->next += 2;
+        rightPtr = ParseFindAnd(parserPtr);
+        if (rightPtr == NULL) {
+            FreeFindNode(nodePtr);
+            return NULL;
+        }
+        nodePtr = NewFindNode(FIND_NODE_OR, nodePtr, rightPtr);
     }
-    Tcl_DStringSetLength(dsPtr, 0);
-    return TRUE;
+    return nodePtr;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * DumpHeader --
+ * CompileFindExpr --
  *
- *      Prints the info associated with a column into a dynamic
- *      string.
+ *      Compiles the find expression into a tree of typed comparisons.
+ *      Read traces must be fired for each value accessed, so tables with
+ *      read traces are always evaluated by TCL.
  *
  * Results:
- *      None.
+ *      Returns the root of the compiled expression or NULL if the
+ *      expression can't be compiled.
  *
  *---------------------------------------------------------------------------
  */
-static int
-DumpHeader(DumpSwitches *dumpPtr, size_t numRows, size_t numCols)
+static FindNode *
+CompileFindExpr(BLT_TABLE table, Tcl_Obj *exprObjPtr, 
+                FindSwitches *switchesPtr)
 {
-    /* i rows columns ctime mtime \n */
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, "i");
+    Blt_ChainLink link;
+    FindNode *nodePtr;
+    FindParser parser;
 
-    /* # of rows and columns may be a subset of the table. */
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(numRows));
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(numCols));
+    for (link = Blt_Chain_FirstLink(table->corePtr->clients); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        BLT_TABLE client;
 
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(0));
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(0));
-    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
-    if (dumpPtr->channel != NULL) {
-        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
+        client = Blt_Chain_GetValue(link);
+        if (Blt_Chain_GetLength(client->readTraces) > 0) {
+            return NULL;
+        }
     }
-    return TRUE;
+    parser.next = Tcl_GetString(exprObjPtr);
+    parser.switchesPtr = switchesPtr;
+    nodePtr = ParseFindOr(&parser);
+    if (nodePtr == NULL) {
+        return NULL;
+    }
+    SkipFindSpaces(&parser);
+    if (*parser.next != '\0') {
+        FreeFindNode(nodePtr);          /* Trailing garbage. */
+        return NULL;
+    }
+    return nodePtr;
 }
 
+static INLINE int
+FindCompareResult(int op, int cmp)
+{
+    switch (op) {
+    case FIND_OP_EQ:    return (cmp == 0);
+    case FIND_OP_NE:    return (cmp != 0);
+    case FIND_OP_LT:    return (cmp < 0);
+    case FIND_OP_LE:    return (cmp <= 0);
+    case FIND_OP_GT:    return (cmp > 0);
+    case FIND_OP_GE:    return (cmp >= 0);
+    }
+    return FALSE;
+}
 
 /*
  *---------------------------------------------------------------------------
  *
- * DumpValue --
+ * EvaluateFindNode --
  *
- *      Retrieves all tags for a given row or column into a tcl list.  
+ *      Evaluates the compiled expression for the given row.  The "&&" and
+ *      "||" operators are short-circuited the same as in TCL.
  *
  * Results:
- *      None.
+ *      Returns FIND_TRUE, FIND_FALSE, or FIND_UNKNOWN if TCL must evaluate
+ *      the expression for this row.
  *
  *---------------------------------------------------------------------------
  */
 static int
-DumpValue(BLT_TABLE table, DumpSwitches *dumpPtr, BLT_TABLE_ROW row, 
-          BLT_TABLE_COLUMN col)
+EvaluateFindNode(BLT_TABLE table, BLT_TABLE_ROW row, FindNode *nodePtr)
 {
-    const char *string;
+    BLT_TABLE_VALUE value;
+    int result, cmp;
 
-    string = blt_table_get_string(table, row, col);
-    if (string == NULL) {
-        return TRUE;
+    switch (nodePtr->type) {
+    case FIND_NODE_AND:
+        result = EvaluateFindNode(table, row, nodePtr->leftPtr);
+        if (result != FIND_TRUE) {
+            return result;
+        }
+        return EvaluateFindNode(table, row, nodePtr->rightPtr);
+    case FIND_NODE_OR:
+        result = EvaluateFindNode(table, row, nodePtr->leftPtr);
+        if (result != FIND_FALSE) {
+            return result;
+        }
+        return EvaluateFindNode(table, row, nodePtr->rightPtr);
+    case FIND_NODE_NOT:
+        result = EvaluateFindNode(table, row, nodePtr->leftPtr);
+        if (result == FIND_UNKNOWN) {
+            return result;
+        }
+        return !result;
     }
-    /* d row column value \n */
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, "d");
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(blt_table_row_index(table, row)));
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(blt_table_column_index(table, col)));
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, string);
-    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
-    if (dumpPtr->channel != NULL) {
-        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
+    if ((nodePtr->mode == FIND_COMPARE_CODE) &&
+        (blt_table_column_is_encoded(nodePtr->col))) {
+        unsigned int code;
+
+        code = blt_table_encoded_code(row, nodePtr->col);
+        if (code == 0) {
+            return FIND_UNKNOWN;        /* Empty value. */
+        }
+        if (code < nodePtr->numCodes) {
+            cmp = (nodePtr->cmps != NULL) ? nodePtr->cmps[code] :
+                (code != nodePtr->code);
+            return FindCompareResult(nodePtr->op, cmp);
+        }
+        /* The string was added after the expression was compiled.
+         * Compare it below. */
     }
-    return TRUE;
-}
+    if ((blt_table_column_is_packed(nodePtr->col)) ||
+        (blt_table_column_is_encoded(nodePtr->col))) {
+        /* Read packed and dictionary-encoded columns through the getters
+         * so they aren't unpacked or decoded. */
+        if (!blt_table_value_exists(table, row, nodePtr->col)) {
+            return FIND_UNKNOWN;        /* Empty value. */
+        }
+        value = NULL;
+    } else {
+        value = blt_table_get_value(table, row, nodePtr->col);
+        if (blt_table_value_string(value) == NULL) {
+            return FIND_UNKNOWN;        /* Empty value. */
+        }
+    }
+    cmp = 0;
+    switch (nodePtr->mode) {
+    case FIND_COMPARE_DOUBLE:
+        {
+            double d;
 
-/*
- *---------------------------------------------------------------------------
- *
- * DumpColumn --
- *
- *      Prints the info associated with a column into a dynamic string.
- *
- *---------------------------------------------------------------------------
- */
-static int
-DumpColumn(BLT_TABLE table, DumpSwitches *dumpPtr, BLT_TABLE_COLUMN col)
-{
-    Blt_Chain colTags;
-    Blt_ChainLink link;
-    const char *name;
+            if (value == NULL) {
+                d = blt_table_get_double(NULL, table, row, nodePtr->col);
+            } else if (blt_table_column_type(nodePtr->col) == 
+                       TABLE_COLUMN_TYPE_LONG) {
+                d = (double)value->datum.l;
+            } else if (blt_table_column_type(nodePtr->col) == 
+                       TABLE_COLUMN_TYPE_INT64) {
+                d = (double)value->datum.i64;
+            } else {
+                d = value->datum.d;
+            }
+            if ((isnan(d)) || (fabs(d) > FIND_MAX_EXACT)) {
+                return FIND_UNKNOWN;
+            }
+            cmp = (d < nodePtr->d) ? -1 : (d > nodePtr->d) ? 1 : 0;
+        }
+        break;
+    case FIND_COMPARE_INT64:
+        {
+            int64_t i64;
 
-    /* c index label type tags \n */
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, "c");
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, 
-           Blt_Ltoa(blt_table_column_index(table, col)));
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, blt_table_column_label(col));
-    name = blt_table_column_type_to_name(blt_table_column_type(col));
-    if (name == NULL) {
-        name = "";
+            if (value == NULL) {
+                i64 = blt_table_get_int64(NULL, table, row, nodePtr->col, 0);
+            } else if (blt_table_column_type(nodePtr->col) == 
+                       TABLE_COLUMN_TYPE_LONG) {
+                i64 = value->datum.l;
+            } else {
+                i64 = value->datum.i64;
+            }
+            cmp = (i64 < nodePtr->i64) ? -1 : (i64 > nodePtr->i64) ? 1 : 0;
+        }
+        break;
+    case FIND_COMPARE_STRING:
+    case FIND_COMPARE_CODE:
+        {
+            const char *string;
+            int length;
+
+            if (value == NULL) {
+                string = blt_table_get_string(table, row, nodePtr->col);
+                length = strlen(string);
+            } else {
+                string = blt_table_value_string(value);
+                length = blt_table_value_length(value);
+            }
+            if ((nodePtr->op == FIND_OP_EQ) || (nodePtr->op == FIND_OP_NE)) {
+                cmp = (length != nodePtr->length) ||
+                    (memcmp(string, nodePtr->string, length) != 0);
+            } else {
+                cmp = CompareFindStrings(string, length, nodePtr->string, 
+                                         nodePtr->length);
+            }
+        }
+        break;
     }
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, name);
+    return FindCompareResult(nodePtr->op, cmp);
+}
 
-    colTags = blt_table_get_column_tags(table, col);
-    Tcl_DStringStartSublist(dumpPtr->dsPtr);
-    for (link = Blt_Chain_FirstLink(colTags); link != NULL;
-         link = Blt_Chain_NextLink(link)) {
-        const char *tag;
+typedef struct {
+    BLT_TABLE table;
+    FindNode *rootPtr;
+    BLT_TABLE_ROW *rows;                /* Rows to be evaluated. */
+    signed char *results;               /* Result of each row. */
+} FindScan;
 
-        tag = Blt_Chain_GetValue(link);
-        Tcl_DStringAppendElement(dumpPtr->dsPtr, tag);
-    }
-    Blt_Chain_Destroy(colTags);
-    Tcl_DStringEndSublist(dumpPtr->dsPtr);
-    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
-    if (dumpPtr->channel != NULL) {
-        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
+static void
+FindRowsProc(ClientData clientData, long first, long last, int worker)
+{
+    FindScan *scanPtr = clientData;
+    long i;
+
+    for (i = first; i < last; i++) {
+        scanPtr->results[i] = EvaluateFindNode(scanPtr->table, 
+                scanPtr->rows[i], scanPtr->rootPtr);
     }
-    return TRUE;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * DumpRow --
+ * PrepareFindNode --
  *
- *      Prints the info associated with a row into a dynamic string.
+ *      Makes sure the columns compared in the expression have their value
+ *      arrays allocated, so that worker threads only read the table.
+ *      Packed and dictionary-encoded columns are left as they are.
  *
  *---------------------------------------------------------------------------
  */
-static int
-DumpRow(BLT_TABLE table, DumpSwitches *dumpPtr, BLT_TABLE_ROW row)
+static void
+PrepareFindNode(BLT_TABLE table, BLT_TABLE_ROW row, FindNode *nodePtr)
 {
-    Blt_Chain rowTags;
-    Blt_ChainLink link;
-
-    /* r index label tags \n */
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, "r");
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, 
-                             Blt_Ltoa(blt_table_row_index(table, row)));
-    Tcl_DStringAppendElement(dumpPtr->dsPtr, (char *)blt_table_row_label(row));
-    Tcl_DStringStartSublist(dumpPtr->dsPtr);
-    rowTags = blt_table_get_row_tags(table, row);
-    for (link = Blt_Chain_FirstLink(rowTags); link != NULL;
-         link = Blt_Chain_NextLink(link)) {
-        const char *tag;
-
-        tag = Blt_Chain_GetValue(link);
-        Tcl_DStringAppendElement(dumpPtr->dsPtr, tag);
+    if (nodePtr == NULL) {
+        return;
     }
-    Blt_Chain_Destroy(rowTags);
-    Tcl_DStringEndSublist(dumpPtr->dsPtr);
-    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
-    if (dumpPtr->channel != NULL) {
-        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
+    if (nodePtr->type == FIND_NODE_COMPARE) {
+        if ((!blt_table_column_is_packed(nodePtr->col)) &&
+            (!blt_table_column_is_encoded(nodePtr->col))) {
+            blt_table_get_value(table, row, nodePtr->col);
+        }
+        return;
     }
-    return TRUE;
+    PrepareFindNode(table, row, nodePtr->leftPtr);
+    PrepareFindNode(table, row, nodePtr->rightPtr);
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * DumpTable --
+ * EvaluateFindRows --
  *
- *      Dumps data from the given table based upon the row and column maps
- *      provided which describe what rows and columns are to be dumped. The
- *      dump information is written to the file named. If the file name
- *      starts with an '@', then it is the name of an already opened
- *      channel to be used.
- *      
- * Results:
- *      A standard TCL result.  If the dump was successful, TCL_OK is
- *      returned.  Otherwise, TCL_ERROR is returned and an error message is
- *      left in the interpreter result.
+ *      Evaluates the compiled expression for all the rows of the search
+ *      using worker threads.  This is only done if there's more than one
+ *      thread and the table has no read traces (a trace could change the
+ *      table while TCL evaluates rows that couldn't be compiled).
  *
- * Side Effects:
- *      Dump information is written to the named file.
+ * Results:
+ *      Returns an array of the results for each row, or NULL if the rows
+ *      should be evaluated one at a time.  The rows are returned in
+ *      *rowsPtr and their number in *numRowsPtr.
  *
  *---------------------------------------------------------------------------
  */
+static signed char *
+EvaluateFindRows(BLT_TABLE table, FindNode *rootPtr, FindSwitches *switchesPtr,
+                 BLT_TABLE_ROW **rowsPtr, long *numRowsPtr)
+{
+    FindScan scan;
+    BLT_TABLE_ROW row;
+    long numRows, numAllocated;
+    int numWorkers;
+
+    if ((rootPtr == NULL) || 
+        (Blt_Chain_GetLength(table->readTraces) > 0) ||
+        (blt_table_num_workers(table, blt_table_num_rows(table)) < 2)) {
+        return NULL;
+    }
+    numAllocated = blt_table_num_rows(table);
+    scan.rows = Blt_AssertMalloc(numAllocated * sizeof(BLT_TABLE_ROW));
+    numRows = 0;
+    for (row = blt_table_first_tagged_row(&switchesPtr->iter); row != NULL; 
+         row = blt_table_next_tagged_row(&switchesPtr->iter)) {
+        if (numRows >= numAllocated) {
+            numAllocated += numAllocated;
+            scan.rows = Blt_AssertRealloc(scan.rows, 
+                numAllocated * sizeof(BLT_TABLE_ROW));
+        }
+        scan.rows[numRows++] = row;
+    }
+    scan.table = table;
+    scan.rootPtr = rootPtr;
+    scan.results = Blt_AssertMalloc(numRows + 1);
+    if (numRows > 0) {
+        PrepareFindNode(table, scan.rows[0], rootPtr);
+        numWorkers = blt_table_num_workers(table, numRows);
+        blt_table_run_workers(numWorkers, numRows, FindRowsProc, &scan);
+    }
+    *rowsPtr = scan.rows;
+    *numRowsPtr = numRows;
+    return scan.results;
+}
+
 static int
-DumpTable(BLT_TABLE table, DumpSwitches *dumpPtr)
+FindRows(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *objPtr, 
+         FindSwitches *switchesPtr)
 {
-    int result;
-    size_t numCols, numRows;
-    BLT_TABLE_COLUMN col;
+    Blt_HashEntry *hPtr;
     BLT_TABLE_ROW row;
+    BLT_TABLE_ROW *rows;
+    TableCmdInterpData *dataPtr;
+    Tcl_Namespace *nsPtr;
+    Tcl_Obj *listObjPtr;
+    FindNode *rootPtr;
+    signed char *results;
+    int isNew;
+    long i, numRows;
+    size_t numMatches;
+    int result = TCL_OK;
 
-    if (dumpPtr->ri.chain != NULL) {
-        numRows = Blt_Chain_GetLength(dumpPtr->ri.chain);
+    rootPtr = CompileFindExpr(table, objPtr, switchesPtr);
+    /* Evaluate the compiled expression in parallel, if possible. Rows
+     * that TCL must evaluate are still done below, in this thread. */
+    rows = NULL;
+    numRows = 0;
+    results = EvaluateFindRows(table, rootPtr, switchesPtr, &rows, &numRows);
+    Tcl_AddInterpResolvers(interp, TABLE_FIND_KEY, (Tcl_ResolveCmdProc*)NULL,
+        ColumnVarResolverProc, (Tcl_ResolveCompiledVarProc*)NULL);
+
+    dataPtr = GetTableCmdInterpData(interp);
+    nsPtr = Tcl_GetCurrentNamespace(interp);
+    hPtr = Blt_CreateHashEntry(&dataPtr->findTable, nsPtr, &isNew);
+    assert(isNew);
+    Blt_SetHashValue(hPtr, switchesPtr);
+
+    /* Now process each row, evaluating the expression. */
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    numMatches = 0;
+    if (results != NULL) {
+        row = (numRows > 0) ? rows[0] : NULL;
     } else {
-        numRows = blt_table_num_rows(table);
+        row = blt_table_first_tagged_row(&switchesPtr->iter);
     }
-    if (dumpPtr->ci.chain != NULL) {
-        numCols = Blt_Chain_GetLength(dumpPtr->ci.chain);
-    } else {
-        numCols = blt_table_num_columns(table);
+    for (i = 0; row != NULL; i++) {
+        int bool;
+        
+        switchesPtr->row = row;
+        bool = FIND_UNKNOWN;
+        if (results != NULL) {
+            bool = results[i];
+        } else if (rootPtr != NULL) {
+            bool = EvaluateFindNode(table, row, rootPtr);
+        }
+        if (bool == FIND_UNKNOWN) {
+            result = EvaluateExpr(interp, table, objPtr, &bool);
+            if (result != TCL_OK) {
+                break;
+            }
+        }
+        if (switchesPtr->flags & FIND_INVERT) {
+            bool = !bool;
+        }
+        if (bool) {
+            Tcl_Obj *objPtr;
+
+            if (switchesPtr->tag != NULL) {
+                result = blt_table_set_row_tag(interp, table, row,
+                        switchesPtr->tag);
+                if (result != TCL_OK) {
+                    break;
+                }
+            }
+            numMatches++;
+            objPtr = GetRowIndexObj(table, row);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+            if ((switchesPtr->maxMatches > 0) && 
+                (numMatches >= switchesPtr->maxMatches)) {
+                break;
+            }
+        }
+        if (results != NULL) {
+            row = ((i + 1) < numRows) ? rows[i + 1] : NULL;
+        } else {
+            row = blt_table_next_tagged_row(&switchesPtr->iter);
+        }
     }
-    result = DumpHeader(dumpPtr, numRows, numCols);
-    for (col = blt_table_first_tagged_column(&dumpPtr->ci); 
-         (result) && (col != NULL); 
-         col = blt_table_next_tagged_column(&dumpPtr->ci)) {
-        result = DumpColumn(table, dumpPtr, col);
+    if (result != TCL_OK) {
+        Tcl_DecrRefCount(listObjPtr);
+    } else {
+        Tcl_SetObjResult(interp, listObjPtr);
     }
-    for (row = blt_table_first_tagged_row(&dumpPtr->ri); 
-         (result) && (row != NULL); 
-         row = blt_table_next_tagged_row(&dumpPtr->ri)) {
-        result = DumpRow(table, dumpPtr, row);
+    /* Clean up. */
+    if (results != NULL) {
+        Blt_Free(results);
+        Blt_Free(rows);
     }
-    for (col = blt_table_first_tagged_column(&dumpPtr->ci); 
-         (result) && (col != NULL); 
-         col = blt_table_next_tagged_column(&dumpPtr->ci)) {
-        for (row = blt_table_first_tagged_row(&dumpPtr->ri); 
-             (result) && (row != NULL); 
-             row = blt_table_next_tagged_row(&dumpPtr->ri)) {
-            result = DumpValue(table, dumpPtr, row, col);
-        }
+    FreeFindNode(rootPtr);
+    Blt_DeleteHashEntry(&dataPtr->findTable, hPtr);
+    Blt_FreeCachedVars(&switchesPtr->varTable);
+    if (!Tcl_RemoveInterpResolvers(interp, TABLE_FIND_KEY)) {
+        Tcl_AppendResult(interp, "can't delete resolver scheme", 
+                (char *)NULL);
+        return TCL_ERROR;
     }
-    return (result) ? TCL_OK : TCL_ERROR;
+    return result;
 }
 
 static int
-SetFreqArrVariable(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows,
-                   FreqMap *freqMap, BLT_TABLE_COLUMN col,
-                   SortSwitches *switchesPtr)
+AppendColumn(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst,
+    BLT_TABLE_COLUMN srcCol,            /* Column in the source table. */
+    BLT_TABLE_COLUMN dstCol)            /* Column in the dstination table. */
 {
-    size_t i;
+    size_t i, j, oldNumRows, need;
+    BLT_TABLE_COLUMN_TYPE type;
+    
+    oldNumRows = blt_table_num_rows(src);
+    need = oldNumRows + blt_table_num_rows(dst);
+    if (blt_table_extend_rows(interp, dst, need, NULL) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    for (i = 0, j = oldNumRows; i < blt_table_num_rows(src); i++, j++) {
+        BLT_TABLE_ROW srcRow, dstRow;
+        BLT_TABLE_VALUE value;
 
-    /* Return the new row order as a list. */
-    for (i = 0; i < numRows; i++) {
-        BLT_TABLE_ROW row;
-        Tcl_Obj *valueObjPtr, *freqObjPtr, *objPtr;
-        int isEmpty;
-        
-        row = freqMap[i].row;
-        isEmpty = !blt_table_value_exists(cmdPtr->table, row, col);
-        if ((isEmpty) && (switchesPtr->flags & SORT_NONEMPTY)) {
+        srcRow = blt_table_row(src, i);
+        value = blt_table_get_value(src, srcRow, srcCol);
+        if (value == NULL) {
             continue;
         }
-        if (isEmpty) {
-            valueObjPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
-        } else {
-            valueObjPtr = blt_table_get_obj(cmdPtr->table, row, col);
-        }
-        freqObjPtr = Tcl_NewWideIntObj(freqMap[i].count);
-        objPtr = Tcl_ObjSetVar2(interp, switchesPtr->freqArrVarObjPtr, 
-                                valueObjPtr, freqObjPtr, 0);
-        if (objPtr == NULL) {
+        dstRow = blt_table_row(dst, j);
+        if (blt_table_set_value(dst, dstRow, dstCol, value) != TCL_OK) {
             return TCL_ERROR;
         }
-    } 
+    }
+    type = blt_table_column_type(dstCol);
+    if (blt_table_set_column_type(interp, dst, dstCol, type) != TCL_OK) {
+        return TCL_ERROR;
+    }
     return TCL_OK;
-}
+}           
 
 static int
-SetFreqListVariable(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows,
-                    FreqMap *freqMap,
-                    BLT_TABLE_COLUMN col, SortSwitches *switchesPtr)
+CopyColumn(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst,
+    BLT_TABLE_COLUMN scol,                /* Column in the source table. */
+    BLT_TABLE_COLUMN dcol)                /* Column in the destination table. */
 {
-    size_t i;
-    Tcl_Obj *listObjPtr;
+    BLT_TABLE_ROW srow, drow;
+    size_t i, srcNumRows, dstNumRows;
 
-    /* Return the new row order as a list. */
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (i = 0; i < numRows; i++) {
-        Tcl_Obj *objPtr;
-        
-        objPtr = Tcl_NewWideIntObj(freqMap[i].count);
-        Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-    } 
-    if (Tcl_ObjSetVar2(interp, switchesPtr->freqListVarObjPtr, NULL, listObjPtr,
-                       0) == NULL) {
+    if ((blt_table_same_object(src, dst)) && (scol == dcol)) {
+        return TCL_OK;                  /* Source and destination columns are
+                                         * the same column in the same
+                                         * table. */
+    }
+    srcNumRows = blt_table_num_rows(src);
+    dstNumRows = blt_table_num_rows(dst);
+    if (srcNumRows >  dstNumRows) {
+        size_t need;
+
+        need = (srcNumRows - dstNumRows);
+        if (blt_table_extend_rows(interp, dst, need, NULL) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (blt_table_set_column_type(interp, dst, dcol,
+        blt_table_column_type(scol)) != TCL_OK) {
         return TCL_ERROR;
     }
+    for (srow = blt_table_first_row(src), drow = blt_table_first_row(dst);
+         srow != NULL;
+         srow = blt_table_next_row(srow), drow = blt_table_next_row(drow)) {
+        BLT_TABLE_VALUE value;
+        
+        value = blt_table_get_value(src, srow, scol);
+        if (value == NULL) {
+            continue;
+        }
+        if (blt_table_set_value(dst, drow, dcol, value) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    for (i = srcNumRows; i < dstNumRows; i++) {
+        BLT_TABLE_ROW drow;
+
+        drow = blt_table_row(dst, i);
+        blt_table_unset_value(dst, drow, dcol);
+    }
     return TCL_OK;
-}
+}           
 
-static unsigned int sortFlags;
+static void
+CopyColumnTags(BLT_TABLE src, BLT_TABLE dst,
+    BLT_TABLE_COLUMN c1,        /* Column in the source table. */
+    BLT_TABLE_COLUMN c2)        /* Column in the dstination table. */
+{
+    Blt_Chain chain;
+    Blt_ChainLink link;
+
+    /* Find all tags for with this column index. */
+    chain = blt_table_get_column_tags(src, c1);
+    for (link = Blt_Chain_FirstLink(chain); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        const char *tag;
+
+        tag = Blt_Chain_GetValue(link);
+        blt_table_set_column_tag(NULL, dst, c2, tag);
+    }
+}           
+
+static void
+ClearTable(BLT_TABLE table) 
+{
+    BLT_TABLE_COLUMN col, nextCol;
+    BLT_TABLE_ROW row, nextRow;
+
+    for (col = blt_table_first_column(table); col != NULL; col = nextCol) {
+        nextCol = blt_table_next_column(col);
+        blt_table_delete_column(table, col);
+    }
+    for (row = blt_table_first_row(table); row != NULL;  row = nextRow) {
+        nextRow = blt_table_next_row(row);
+        blt_table_delete_row(table, row);
+    }
+}
 
 static int
-CompareFrequencies(const void *a, const void *b)
+CopyColumnLabel(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst,
+                BLT_TABLE_COLUMN c1, BLT_TABLE_COLUMN c2) 
 {
-    FreqMap *rowPtr1, *rowPtr2;
-    int result;
+    const char *label;
 
-    rowPtr1 = *(FreqMap **)a;
-    rowPtr2 = *(FreqMap **)b;
-    if (rowPtr1->count > rowPtr2->count) {
-        result = -1;
-    } else if (rowPtr2->count > rowPtr1->count) {
-        result = 1;
-    } else {
-        result = 0;
+    label = blt_table_column_label(c1);
+    if (blt_table_set_column_label(interp, dst, c2, label) != TCL_OK) {
+        return TCL_ERROR;
     }
-    return (sortFlags & TABLE_SORT_DECREASING) ? -result : result;
+    return TCL_OK;
 }
 
 static int
-SortFrequencies(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows, 
-                BLT_TABLE_ROW *map, BLT_TABLE_COLUMN col, 
-                SortSwitches *switchesPtr)
+CopyTable(Tcl_Interp *interp, BLT_TABLE src, BLT_TABLE dst) 
 {
-    BLT_TABLE_COMPARE_PROC *proc;
-    FreqMap *freqMap; 
-    size_t i, numEntries;
-    
-    proc = blt_table_get_compare_proc(cmdPtr->table, col, switchesPtr->tsFlags);
-    freqMap = Blt_AssertCalloc(numRows, sizeof(FreqMap));
-    numEntries = 0;
+    size_t i;
 
-    /* Load the map with the frequencies of each run for a value. */
-    for (i = 0; i < numRows; /*empty*/) {
-        size_t j;
-        size_t count;
-        
-        /* Find the next run of the same value as the current. */
-        count = 1;
-        for (j = i+1; j < numRows; j++) {
-            if (((*proc)(cmdPtr->table, col, map[i], map[j])) != 0) {
-                break;
-            }
-            count++;
-        }
-        if (switchesPtr->flags & SORT_UNIQUE) {
-            /* Just one entry. Use the first row and count. */
-            freqMap[numEntries].row = map[i];
-            freqMap[numEntries].count = count;
-            numEntries++;
-            i = j;
-        } else {
-            /* An entry for each row. Replicate the count. */
-            for (/*empty*/; i < j; i++) {
-                freqMap[i].row = map[i];
-                freqMap[i].count = count;
-                numEntries++;
-            }
-        }
+    if (blt_table_same_object(src, dst)) {
+        return TCL_OK;                  /* Source and destination are the
+                                         * same table. */
     }
-    if (switchesPtr->flags & SORT_BYFREQ) {
-        /* Sort the rows by their frequency. Set the global sortFlags
-         * variable so that CompareFrequencies can pick it up. */
-        sortFlags = switchesPtr->tsFlags;
-        qsort(freqMap, numEntries, sizeof(FreqMap), CompareFrequencies);
+    ClearTable(dst);
+    if (blt_table_num_columns(src) > blt_table_num_columns(dst)) {
+        size_t count;
+
+        count = blt_table_num_columns(src) - blt_table_num_columns(dst);
+        blt_table_extend_columns(interp, dst, count, NULL);
     }
-    if (switchesPtr->freqArrVarObjPtr != NULL) {
-        /* Set the TCL array with the frequencies */
-        if (SetFreqArrVariable(interp, cmdPtr, numEntries, freqMap, col,
-                               switchesPtr) != TCL_OK) {
+    for (i = 0; i < blt_table_num_columns(src); i++) {
+        BLT_TABLE_COLUMN c1, c2;
+
+        c1 = blt_table_column(src, i);
+        c2 = blt_table_column(dst, i);
+        if (CopyColumn(interp, src, dst, c1, c2) != TCL_OK) {
             return TCL_ERROR;
         }
-    }
-    if (switchesPtr->freqListVarObjPtr != NULL) {
-        /* Set the TCL array with the list of frequencies. */
-        if (SetFreqListVariable(interp, cmdPtr, numEntries, freqMap, col,
-                                switchesPtr) != TCL_OK) {
+        if (CopyColumnLabel(interp, src, dst, c1, c2) != TCL_OK) {
             return TCL_ERROR;
         }
+        CopyColumnTags(src, dst, c1, c2);
     }
-    if (switchesPtr->flags & SORT_ALTER) {
-        /* Overwrite the original sort map with the frequency map. */
-        for (i = 0; i < numEntries; i++) {
-            map[i] = freqMap[i].row;
-        }
-        /* Make row order permanent. */
-        blt_table_set_row_map(cmdPtr->table, map);
-    }
-    Blt_Free(freqMap);
     return TCL_OK;
 }
 
+
 static int
-SetSortedResult(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows, 
-                BLT_TABLE_ROW *rows, BLT_TABLE_COLUMN col, 
-                SortSwitches *switchesPtr)
+CopyRow(Tcl_Interp *interp, BLT_TABLE srcTable, BLT_TABLE destTable,
+    BLT_TABLE_ROW srcRow,               /* Row offset in the source table. */
+    BLT_TABLE_ROW destRow)              /* Row offset in the destination. */
 {
-    Tcl_Obj *listObjPtr;
     size_t i;
-    
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (i = 0; i < numRows; i++) {
-        Tcl_Obj *objPtr;
 
-        objPtr = NULL;
-        switch(switchesPtr->returnType) {
-        case SORT_RETURN_VALUES:
-            objPtr = blt_table_get_obj(cmdPtr->table, rows[i], col);
-            break;
-        case SORT_RETURN_LABELS:
-            objPtr = GetRowLabelObj(cmdPtr->table, rows[i]);
-            break;
-        case SORT_RETURN_INDICES:
-            objPtr = GetRowIndexObj(cmdPtr->table, rows[i]);
-            break;
+    if ((blt_table_same_object(srcTable, destTable)) && 
+        (srcRow == destRow)) {
+        return TCL_OK;          /* Source and destination are the same. */
+    }
+    if (blt_table_num_columns(srcTable) > blt_table_num_columns(destTable)) {
+        size_t needed;
+
+        needed = blt_table_num_columns(srcTable) - 
+            blt_table_num_columns(destTable);
+        if (blt_table_extend_columns(interp, destTable, needed, NULL)!=TCL_OK) {
+            return TCL_ERROR;
         }
-        if (objPtr != NULL) {
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+    }
+    for (i = 0; i < blt_table_num_columns(srcTable); i++) {
+        BLT_TABLE_COLUMN col;
+        BLT_TABLE_VALUE value;
+
+        col = blt_table_column(srcTable, i);
+        value = blt_table_get_value(srcTable, srcRow, col);
+        col = blt_table_column(destTable, i);
+        if (blt_table_set_value(destTable, destRow, col, value)!= TCL_OK) {
+            return TCL_ERROR;
         }
     }
-    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
-}
+}           
 
-static int
-SetUniqueSortedResult(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows, 
-                      BLT_TABLE_ROW *rows, BLT_TABLE_COLUMN col, 
-                      SortSwitches *switchesPtr)
+static void
+CopyRowTags(BLT_TABLE srcTable, BLT_TABLE destTable,
+    BLT_TABLE_ROW srcRow,               /* Row in the source table. */
+    BLT_TABLE_ROW destRow)              /* Row in the destination table. */
 {
-    BLT_TABLE_COMPARE_PROC *proc;
-    Tcl_Obj *listObjPtr;
-    size_t i;
-    
+    Blt_Chain chain;
+    Blt_ChainLink link;
 
-    /* Get the compare procedure for the column. We'll use that to sift out
-     * unique values. */
-    proc = blt_table_get_compare_proc(cmdPtr->table, col, switchesPtr->tsFlags);
+    /* Get all tags for this particular row in the source table. */
+    chain = blt_table_get_row_tags(srcTable, srcRow);
+    for (link = Blt_Chain_FirstLink(chain); link != NULL; 
+         link = Blt_Chain_NextLink(link)) {
+        const char *tag;
 
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (i = 0; i < numRows; /*empty*/) {
-        size_t j;
-        Tcl_Obj *objPtr;
-
-        /* Find the next run of similar rows. */
-        for (j = i + 1; j < numRows; j++) {
-            if (((*proc)(cmdPtr->table, col, rows[i], rows[j])) != 0) {
-                break;
-            }
-        }
-        objPtr = NULL;
-        switch(switchesPtr->returnType) {
-        case SORT_RETURN_VALUES:
-            objPtr = blt_table_get_obj(cmdPtr->table, rows[i], col);
-            break;
-        case SORT_RETURN_LABELS:
-            objPtr = GetRowLabelObj(cmdPtr->table, rows[i]);
-            break;
-        case SORT_RETURN_INDICES:
-            objPtr = GetRowIndexObj(cmdPtr->table, rows[i]);
-            break;
-        }
-        if (objPtr != NULL) {
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-        }
-        i = j;
+        tag = Blt_Chain_GetValue(link);
+        blt_table_set_row_tag(NULL, destTable, destRow, tag);
     }
-    Tcl_SetObjResult(interp, listObjPtr);
-    return TCL_OK;
-}
+    Blt_Chain_Destroy(chain);
+}           
 
-static const char *
-GetTypeFromMode(int mode)
+
+static int
+WriteRecord(Tcl_Channel channel, Tcl_DString *dsPtr)
 {
-#ifdef WIN32
-   if (mode == -1) {
-       return "unknown";
-   } else if (mode & FILE_ATTRIBUTE_DIRECTORY) {
-        return "directory";
-   } else if (mode &  FILE_ATTRIBUTE_HIDDEN) {
-        return "hidden";
-   } else if (mode &  FILE_ATTRIBUTE_READONLY) {
-        return "readonly";
-   } else {
-       return "file";
-   }
-#else
-    if (S_ISREG(mode)) {
-        return "file";
-    } else if (S_ISDIR(mode)) {
-        return "directory";
-    } else if (S_ISCHR(mode)) {
-        return "characterSpecial";
-    } else if (S_ISBLK(mode)) {
-        return "blockSpecial";
-    } else if (S_ISFIFO(mode)) {
-        return "fifo";
-#ifdef S_ISLNK
-    } else if (S_ISLNK(mode)) {
-        return "link";
+    int length, numWritten;
+    char *line;
+
+    length = Tcl_DStringLength(dsPtr);
+    line = Tcl_DStringValue(dsPtr);
+#if HAVE_UTF
+#ifdef notdef
+    numWritten = Tcl_WriteChars(channel, line, length);
 #endif
-#ifdef S_ISSOCK
-    } else if (S_ISSOCK(mode)) {
-        return "socket";
+    numWritten = Tcl_Write(channel, line, length);
+#else
+    numWritten = Tcl_Write(channel, line, length);
 #endif
+    if (numWritten != length) {
+        return FALSE;
     }
-    return "unknown";
-#endif
+    Tcl_DStringSetLength(dsPtr, 0);
+    return TRUE;
 }
 
-static INLINE BLT_TABLE_COLUMN 
-GetColumn(Tcl_Interp *interp, BLT_TABLE table, const char *label,
-          BLT_TABLE_COLUMN_TYPE type)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DumpHeader --
+ *
+ *      Prints the info associated with a column into a dynamic
+ *      string.
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+DumpHeader(DumpSwitches *dumpPtr, size_t numRows, size_t numCols)
 {
-    BLT_TABLE_COLUMN col;
+    /* i rows columns ctime mtime \n */
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, "i");
 
-    col = blt_table_get_column_by_label(table, label);
-    if (col == NULL) {
-        col = blt_table_create_column(interp, table, label);
-        blt_table_set_column_type(interp, table, col, type);
+    /* # of rows and columns may be a subset of the table. */
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(numRows));
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(numCols));
+
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(0));
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(0));
+    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
+    if (dumpPtr->channel != NULL) {
+        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
     }
-    return col;
+    return TRUE;
 }
 
-static void
-ExportToTable(Tcl_Interp *interp, BLT_TABLE table, const char *fileName, 
-              Tcl_StatBuf *statPtr, ReadDirectory *switchesPtr)
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DumpValue --
+ *
+ *      Retrieves all tags for a given row or column into a tcl list.  
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+DumpValue(BLT_TABLE table, DumpSwitches *dumpPtr, BLT_TABLE_ROW row, 
+          BLT_TABLE_COLUMN col)
 {
-    BLT_TABLE_ROW row;
-    BLT_TABLE_COLUMN col;
+    const char *string;
 
-    row = blt_table_create_row(interp, table, NULL);
-    if (row == NULL) {
-        return;
+    if (blt_table_column_is_packed(col)) {
+        /* Format the value into the table's scratch value, so dumping
+         * doesn't keep a string for every packed value. */
+        string = blt_table_value_string(blt_table_get_value(table, row, col));
+    } else {
+        string = blt_table_get_string(table, row, col);
     }
-    /* name */
-    col = blt_table_get_column_by_label(table, "name");
-    if (col == NULL) {
-        col = blt_table_create_column(interp, table, "name");
+    if (string == NULL) {
+        return TRUE;
     }
-    blt_table_set_string(interp, table, row, col, fileName, -1);
+    /* d row column value \n */
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, "d");
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(blt_table_row_index(table, row)));
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, Blt_Ltoa(blt_table_column_index(table, col)));
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, string);
+    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
+    if (dumpPtr->channel != NULL) {
+        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
+    }
+    return TRUE;
+}
 
-    if (switchesPtr->mask & READ_DIR_TYPE) {
-        col = GetColumn(interp, table, "type", TABLE_COLUMN_TYPE_STRING);
-        blt_table_set_string(interp, table, row, col,
-                             GetTypeFromMode(statPtr->st_mode), -1);
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DumpColumn --
+ *
+ *      Prints the info associated with a column into a dynamic string.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+DumpColumn(BLT_TABLE table, DumpSwitches *dumpPtr, BLT_TABLE_COLUMN col)
+{
+    Blt_Chain colTags;
+    Blt_ChainLink link;
+    const char *name;
+
+    /* c index label type tags \n */
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, "c");
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, 
+           Blt_Ltoa(blt_table_column_index(table, col)));
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, blt_table_column_label(col));
+    name = blt_table_column_type_to_name(blt_table_column_type(col));
+    if (name == NULL) {
+        name = "";
     }
-    if (switchesPtr->mask & READ_DIR_SIZE) {
-        col = GetColumn(interp, table, "size", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_size);
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, name);
+
+    colTags = blt_table_get_column_tags(table, col);
+    Tcl_DStringStartSublist(dumpPtr->dsPtr);
+    for (link = Blt_Chain_FirstLink(colTags); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        const char *tag;
+
+        tag = Blt_Chain_GetValue(link);
+        Tcl_DStringAppendElement(dumpPtr->dsPtr, tag);
     }
-    if (switchesPtr->mask & READ_DIR_UID) {
-        col = GetColumn(interp, table, "uid", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_uid);
+    Blt_Chain_Destroy(colTags);
+    Tcl_DStringEndSublist(dumpPtr->dsPtr);
+    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
+    if (dumpPtr->channel != NULL) {
+        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
     }
-    if (switchesPtr->mask & READ_DIR_GID) {
-        col = GetColumn(interp, table, "gid", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_gid);
+    return TRUE;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DumpRow --
+ *
+ *      Prints the info associated with a row into a dynamic string.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+DumpRow(BLT_TABLE table, DumpSwitches *dumpPtr, BLT_TABLE_ROW row)
+{
+    Blt_Chain rowTags;
+    Blt_ChainLink link;
+
+    /* r index label tags \n */
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, "r");
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, 
+                             Blt_Ltoa(blt_table_row_index(table, row)));
+    Tcl_DStringAppendElement(dumpPtr->dsPtr, (char *)blt_table_row_label(row));
+    Tcl_DStringStartSublist(dumpPtr->dsPtr);
+    rowTags = blt_table_get_row_tags(table, row);
+    for (link = Blt_Chain_FirstLink(rowTags); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        const char *tag;
+
+        tag = Blt_Chain_GetValue(link);
+        Tcl_DStringAppendElement(dumpPtr->dsPtr, tag);
     }
-    if (switchesPtr->mask & READ_DIR_ATIME) {
-        col = GetColumn(interp, table, "atime", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_atime);
+    Blt_Chain_Destroy(rowTags);
+    Tcl_DStringEndSublist(dumpPtr->dsPtr);
+    Tcl_DStringAppend(dumpPtr->dsPtr, "\n", 1);
+    if (dumpPtr->channel != NULL) {
+        return WriteRecord(dumpPtr->channel, dumpPtr->dsPtr);
     }
-    if (switchesPtr->mask & READ_DIR_MTIME) {
-        col = GetColumn(interp, table, "mtime", TABLE_COLUMN_TYPE_LONG);
+    return TRUE;
+}
+
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DumpTable --
+ *
+ *      Dumps data from the given table based upon the row and column maps
+ *      provided which describe what rows and columns are to be dumped. The
+ *      dump information is written to the file named. If the file name
+ *      starts with an '@', then it is the name of an already opened
+ *      channel to be used.
+ *      
+ * Results:
+ *      A standard TCL result.  If the dump was successful, TCL_OK is
+ *      returned.  Otherwise, TCL_ERROR is returned and an error message is
+ *      left in the interpreter result.
+ *
+ * Side Effects:
+ *      Dump information is written to the named file.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+DumpTable(BLT_TABLE table, DumpSwitches *dumpPtr)
+{
+    int result;
+    size_t numCols, numRows;
+    BLT_TABLE_COLUMN col;
+    BLT_TABLE_ROW row;
+
+    if (dumpPtr->ri.chain != NULL) {
+        numRows = Blt_Chain_GetLength(dumpPtr->ri.chain);
+    } else {
+        numRows = blt_table_num_rows(table);
+    }
+    if (dumpPtr->ci.chain != NULL) {
+        numCols = Blt_Chain_GetLength(dumpPtr->ci.chain);
+    } else {
+        numCols = blt_table_num_columns(table);
+    }
+    result = DumpHeader(dumpPtr, numRows, numCols);
+    for (col = blt_table_first_tagged_column(&dumpPtr->ci); 
+         (result) && (col != NULL); 
+         col = blt_table_next_tagged_column(&dumpPtr->ci)) {
+        result = DumpColumn(table, dumpPtr, col);
+    }
+    for (row = blt_table_first_tagged_row(&dumpPtr->ri); 
+         (result) && (row != NULL); 
+         row = blt_table_next_tagged_row(&dumpPtr->ri)) {
+        result = DumpRow(table, dumpPtr, row);
+    }
+    for (col = blt_table_first_tagged_column(&dumpPtr->ci); 
+         (result) && (col != NULL); 
+         col = blt_table_next_tagged_column(&dumpPtr->ci)) {
+        for (row = blt_table_first_tagged_row(&dumpPtr->ri); 
+             (result) && (row != NULL); 
+             row = blt_table_next_tagged_row(&dumpPtr->ri)) {
+            result = DumpValue(table, dumpPtr, row, col);
+        }
+    }
+    return (result) ? TCL_OK : TCL_ERROR;
+}
+
+static int
+SetFreqArrVariable(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows,
+                   FreqMap *freqMap, BLT_TABLE_COLUMN col,
+                   SortSwitches *switchesPtr)
+{
+    size_t i;
+
+    /* Return the new row order as a list. */
+    for (i = 0; i < numRows; i++) {
+        BLT_TABLE_ROW row;
+        Tcl_Obj *valueObjPtr, *freqObjPtr, *objPtr;
+        int isEmpty;
+        
+        row = freqMap[i].row;
+        isEmpty = !blt_table_value_exists(cmdPtr->table, row, col);
+        if ((isEmpty) && (switchesPtr->flags & SORT_NONEMPTY)) {
+            continue;
+        }
+        if (isEmpty) {
+            valueObjPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
+        } else {
+            valueObjPtr = blt_table_get_obj(cmdPtr->table, row, col);
+        }
+        freqObjPtr = Tcl_NewWideIntObj(freqMap[i].count);
+        objPtr = Tcl_ObjSetVar2(interp, switchesPtr->freqArrVarObjPtr, 
+                                valueObjPtr, freqObjPtr, 0);
+        if (objPtr == NULL) {
+            return TCL_ERROR;
+        }
+    } 
+    return TCL_OK;
+}
+
+static int
+SetFreqListVariable(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows,
+                    FreqMap *freqMap,
+                    BLT_TABLE_COLUMN col, SortSwitches *switchesPtr)
+{
+    size_t i;
+    Tcl_Obj *listObjPtr;
+
+    /* Return the new row order as a list. */
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    for (i = 0; i < numRows; i++) {
+        Tcl_Obj *objPtr;
+        
+        objPtr = Tcl_NewWideIntObj(freqMap[i].count);
+        Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+    } 
+    if (Tcl_ObjSetVar2(interp, switchesPtr->freqListVarObjPtr, NULL, listObjPtr,
+                       0) == NULL) {
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static unsigned int sortFlags;
+
+static int
+CompareFrequencies(const void *a, const void *b)
+{
+    FreqMap *rowPtr1, *rowPtr2;
+    int result;
+
+    rowPtr1 = *(FreqMap **)a;
+    rowPtr2 = *(FreqMap **)b;
+    if (rowPtr1->count > rowPtr2->count) {
+        result = -1;
+    } else if (rowPtr2->count > rowPtr1->count) {
+        result = 1;
+    } else {
+        result = 0;
+    }
+    return (sortFlags & TABLE_SORT_DECREASING) ? -result : result;
+}
+
+static int
+SortFrequencies(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows, 
+                BLT_TABLE_ROW *map, BLT_TABLE_COLUMN col, 
+                SortSwitches *switchesPtr)
+{
+    BLT_TABLE_COMPARE_PROC *proc;
+    FreqMap *freqMap; 
+    size_t i, numEntries;
+    
+    proc = blt_table_get_compare_proc(cmdPtr->table, col, switchesPtr->tsFlags);
+    freqMap = Blt_AssertCalloc(numRows, sizeof(FreqMap));
+    numEntries = 0;
+
+    /* Load the map with the frequencies of each run for a value. */
+    for (i = 0; i < numRows; /*empty*/) {
+        size_t j;
+        size_t count;
+        
+        /* Find the next run of the same value as the current. */
+        count = 1;
+        for (j = i+1; j < numRows; j++) {
+            if (((*proc)(cmdPtr->table, col, map[i], map[j])) != 0) {
+                break;
+            }
+            count++;
+        }
+        if (switchesPtr->flags & SORT_UNIQUE) {
+            /* Just one entry. Use the first row and count. */
+            freqMap[numEntries].row = map[i];
+            freqMap[numEntries].count = count;
+            numEntries++;
+            i = j;
+        } else {
+            /* An entry for each row. Replicate the count. */
+            for (/*empty*/; i < j; i++) {
+                freqMap[i].row = map[i];
+                freqMap[i].count = count;
+                numEntries++;
+            }
+        }
+    }
+    if (switchesPtr->flags & SORT_BYFREQ) {
+        /* Sort the rows by their frequency. Set the global sortFlags
+         * variable so that CompareFrequencies can pick it up. */
+        sortFlags = switchesPtr->tsFlags;
+        qsort(freqMap, numEntries, sizeof(FreqMap), CompareFrequencies);
+    }
+    if (switchesPtr->freqArrVarObjPtr != NULL) {
+        /* Set the TCL array with the frequencies */
+        if (SetFreqArrVariable(interp, cmdPtr, numEntries, freqMap, col,
+                               switchesPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (switchesPtr->freqListVarObjPtr != NULL) {
+        /* Set the TCL array with the list of frequencies. */
+        if (SetFreqListVariable(interp, cmdPtr, numEntries, freqMap, col,
+                                switchesPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    if (switchesPtr->flags & SORT_ALTER) {
+        /* Overwrite the original sort map with the frequency map. */
+        for (i = 0; i < numEntries; i++) {
+            map[i] = freqMap[i].row;
+        }
+        /* The row order is made permanent by the caller. */
+    }
+    Blt_Free(freqMap);
+    return TCL_OK;
+}
+
+static int
+SetSortedResult(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows, 
+                BLT_TABLE_ROW *rows, BLT_TABLE_COLUMN col, 
+                SortSwitches *switchesPtr)
+{
+    Tcl_Obj *listObjPtr;
+    size_t i;
+    
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    for (i = 0; i < numRows; i++) {
+        Tcl_Obj *objPtr;
+
+        objPtr = NULL;
+        switch(switchesPtr->returnType) {
+        case SORT_RETURN_VALUES:
+            objPtr = blt_table_get_obj(cmdPtr->table, rows[i], col);
+            break;
+        case SORT_RETURN_LABELS:
+            objPtr = GetRowLabelObj(cmdPtr->table, rows[i]);
+            break;
+        case SORT_RETURN_INDICES:
+            objPtr = GetRowIndexObj(cmdPtr->table, rows[i]);
+            break;
+        }
+        if (objPtr != NULL) {
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
+    }
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
+}
+
+static int
+SetUniqueSortedResult(Tcl_Interp *interp, Cmd *cmdPtr, size_t numRows, 
+                      BLT_TABLE_ROW *rows, BLT_TABLE_COLUMN col, 
+                      SortSwitches *switchesPtr)
+{
+    BLT_TABLE_COMPARE_PROC *proc;
+    Tcl_Obj *listObjPtr;
+    size_t i;
+    
+
+    /* Get the compare procedure for the column. We'll use that to sift out
+     * unique values. */
+    proc = blt_table_get_compare_proc(cmdPtr->table, col, switchesPtr->tsFlags);
+
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    for (i = 0; i < numRows; /*empty*/) {
+        size_t j;
+        Tcl_Obj *objPtr;
+
+        /* Find the next run of similar rows. */
+        for (j = i + 1; j < numRows; j++) {
+            if (((*proc)(cmdPtr->table, col, rows[i], rows[j])) != 0) {
+                break;
+            }
+        }
+        objPtr = NULL;
+        switch(switchesPtr->returnType) {
+        case SORT_RETURN_VALUES:
+            objPtr = blt_table_get_obj(cmdPtr->table, rows[i], col);
+            break;
+        case SORT_RETURN_LABELS:
+            objPtr = GetRowLabelObj(cmdPtr->table, rows[i]);
+            break;
+        case SORT_RETURN_INDICES:
+            objPtr = GetRowIndexObj(cmdPtr->table, rows[i]);
+            break;
+        }
+        if (objPtr != NULL) {
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
+        i = j;
+    }
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
+}
+
+static const char *
+GetTypeFromMode(int mode)
+{
+#ifdef WIN32
+   if (mode == -1) {
+       return "unknown";
+   } else if (mode & FILE_ATTRIBUTE_DIRECTORY) {
+        return "directory";
+   } else if (mode &  FILE_ATTRIBUTE_HIDDEN) {
+        return "hidden";
+   } else if (mode &  FILE_ATTRIBUTE_READONLY) {
+        return "readonly";
+   } else {
+       return "file";
+   }
+#else
+    if (S_ISREG(mode)) {
+        return "file";
+    } else if (S_ISDIR(mode)) {
+        return "directory";
+    } else if (S_ISCHR(mode)) {
+        return "characterSpecial";
+    } else if (S_ISBLK(mode)) {
+        return "blockSpecial";
+    } else if (S_ISFIFO(mode)) {
+        return "fifo";
+#ifdef S_ISLNK
+    } else if (S_ISLNK(mode)) {
+        return "link";
+#endif
+#ifdef S_ISSOCK
+    } else if (S_ISSOCK(mode)) {
+        return "socket";
+#endif
+    }
+    return "unknown";
+#endif
+}
+
+static INLINE BLT_TABLE_COLUMN 
+GetColumn(Tcl_Interp *interp, BLT_TABLE table, const char *label,
+          BLT_TABLE_COLUMN_TYPE type)
+{
+    BLT_TABLE_COLUMN col;
+
+    col = blt_table_get_column_by_label(table, label);
+    if (col == NULL) {
+        col = blt_table_create_column(interp, table, label);
+        blt_table_set_column_type(interp, table, col, type);
+    }
+    return col;
+}
+
+static void
+ExportToTable(Tcl_Interp *interp, BLT_TABLE table, const char *fileName, 
+              Tcl_StatBuf *statPtr, ReadDirectory *switchesPtr)
+{
+    BLT_TABLE_ROW row;
+    BLT_TABLE_COLUMN col;
+
+    row = blt_table_create_row(interp, table, NULL);
+    if (row == NULL) {
+        return;
+    }
+    /* name */
+    col = blt_table_get_column_by_label(table, "name");
+    if (col == NULL) {
+        col = blt_table_create_column(interp, table, "name");
+    }
+    blt_table_set_string(interp, table, row, col, fileName, -1);
+
+    if (switchesPtr->mask & READ_DIR_TYPE) {
+        col = GetColumn(interp, table, "type", TABLE_COLUMN_TYPE_STRING);
+        blt_table_set_string(interp, table, row, col,
+                             GetTypeFromMode(statPtr->st_mode), -1);
+    }
+    if (switchesPtr->mask & READ_DIR_SIZE) {
+        col = GetColumn(interp, table, "size", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_size);
+    }
+    if (switchesPtr->mask & READ_DIR_UID) {
+        col = GetColumn(interp, table, "uid", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_uid);
+    }
+    if (switchesPtr->mask & READ_DIR_GID) {
+        col = GetColumn(interp, table, "gid", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_gid);
+    }
+    if (switchesPtr->mask & READ_DIR_ATIME) {
+        col = GetColumn(interp, table, "atime", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_atime);
+    }
+    if (switchesPtr->mask & READ_DIR_MTIME) {
+        col = GetColumn(interp, table, "mtime", TABLE_COLUMN_TYPE_LONG);
         blt_table_set_long(interp, table, row, col, statPtr->st_mtime);
     }
-    if (switchesPtr->mask & READ_DIR_CTIME) {
-        col = GetColumn(interp, table, "ctime", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_ctime);
+    if (switchesPtr->mask & READ_DIR_CTIME) {
+        col = GetColumn(interp, table, "ctime", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_ctime);
+    }
+    if (switchesPtr->mask & READ_DIR_MODE) {
+        col = GetColumn(interp, table, "mode", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_mode);
+    }
+    if (switchesPtr->mask & READ_DIR_PERMS) {
+        col = GetColumn(interp, table, "perms", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_mode & 07777);
+    }
+    if (switchesPtr->mask & READ_DIR_INO) {
+        col = GetColumn(interp, table, "ino", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_ino);
+    }
+    if (switchesPtr->mask & READ_DIR_NLINK) {
+        col = GetColumn(interp, table, "nlink", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_nlink);
+    }
+    if (switchesPtr->mask & READ_DIR_DEV) {
+        col = GetColumn(interp, table, "dev", TABLE_COLUMN_TYPE_LONG);
+        blt_table_set_long(interp, table, row, col, statPtr->st_rdev);
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * AddOp --
+ *
+ *      Adds to rows from the source table onto the destination. If the
+ *      destination table doesn't already have a column, one is
+ *      automatically created.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
+ *
+ *      tableName add srcTableName ?switches?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+AddOp(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    AddSwitches switches;
+    BLT_TABLE srcTable;
+    size_t oldLength, count;
+    int result;
+    BLT_TABLE_COLUMN srcCol;
+
+    /* Process switches following the column names. */
+    if (blt_table_open(interp, Tcl_GetString(objv[2]), &srcTable) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    switches.flags = 0;
+    result = TCL_ERROR;
+    rowIterSwitch.clientData = srcTable;
+    columnIterSwitch.clientData = srcTable;
+    blt_table_iterate_all_rows(srcTable, &switches.ri);
+    blt_table_iterate_all_columns(srcTable, &switches.ci);
+    if (Blt_ParseSwitches(interp, addSwitches, objc - 3, objv + 3, 
+        &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        goto error;
+    }
+    oldLength = blt_table_num_rows(cmdPtr->table);
+    count = switches.ri.numEntries;
+    if (blt_table_extend_rows(interp, cmdPtr->table, count, NULL) != TCL_OK) {
+        goto error;
+    }
+    for (srcCol = blt_table_first_tagged_column(&switches.ci); srcCol != NULL; 
+         srcCol = blt_table_next_tagged_column(&switches.ci)) {
+        const char *label;
+        BLT_TABLE_COLUMN dstCol;
+        BLT_TABLE_ROW srcRow;
+        size_t i;
+
+        label = blt_table_column_label(srcCol);
+        dstCol = blt_table_get_column_by_label(cmdPtr->table, label);
+        if (dstCol == NULL) {
+            /* If column doesn't exist in destination table, create a new
+             * column, copying the label and the column type. */
+            if (blt_table_extend_columns(interp, cmdPtr->table, 1, &dstCol) 
+                != TCL_OK) {
+                goto error;
+            }
+            if (blt_table_set_column_label(interp, cmdPtr->table, dstCol, label)
+                != TCL_OK) {
+                goto error;
+            }
+            if (blt_table_set_column_type(interp, cmdPtr->table, dstCol, 
+                blt_table_column_type(srcCol)) != TCL_OK) {
+                goto error;
+            }
+        }
+        i = oldLength;
+        for (srcRow = blt_table_first_tagged_row(&switches.ri); srcRow != NULL; 
+             srcRow = blt_table_next_tagged_row(&switches.ri)) {
+            BLT_TABLE_VALUE value;
+            BLT_TABLE_ROW dstRow;
+
+            value = blt_table_get_value(srcTable, srcRow, srcCol);
+            if (value == NULL) {
+                continue;
+            }
+            dstRow = blt_table_row(cmdPtr->table, i);
+            if (blt_table_set_value(cmdPtr->table, dstRow, dstCol, value) 
+                != TCL_OK) {
+                goto error;
+            }
+            i++;
+        }
+        if ((switches.flags & COPY_NOTAGS) == 0) {
+            CopyColumnTags(srcTable, cmdPtr->table, srcCol, dstCol);
+        }
+    }
+    result = TCL_OK;
+ error:
+    blt_table_close(srcTable);
+    Blt_FreeSwitches(addSwitches, &switches, 0);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NewResultTable --
+ *
+ *      Creates a new table and its command to hold the result of a join or
+ *      aggregate.  The name of the table is left in the dynamic string.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+NewResultTable(Tcl_Interp *interp, Tcl_DString *dsPtr, BLT_TABLE *tablePtr)
+{
+    const char *instName;
+
+    instName = GenerateName(interp, "", "", dsPtr);
+    if (instName == NULL) {
+        return TCL_ERROR;
+    }
+    if (blt_table_create(interp, instName, tablePtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    NewTableCmd(interp, *tablePtr, instName);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetColumnList --
+ *
+ *      Converts a list of column names into an array of columns.  The
+ *      array must be freed by the caller.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+GetColumnList(Tcl_Interp *interp, BLT_TABLE table, Tcl_Obj *listObjPtr,
+              int *numColumnsPtr, BLT_TABLE_COLUMN **columnsPtr)
+{
+    BLT_TABLE_COLUMN *columns;
+    Tcl_Obj **objv;
+    int i, objc;
+
+    if (Tcl_ListObjGetElements(interp, listObjPtr, &objc, &objv) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    columns = Blt_AssertMalloc(MAX(objc, 1) * sizeof(BLT_TABLE_COLUMN));
+    for (i = 0; i < objc; i++) {
+        columns[i] = blt_table_get_column(interp, table, objv[i]);
+        if (columns[i] == NULL) {
+            Blt_Free(columns);
+            return TCL_ERROR;
+        }
+    }
+    *numColumnsPtr = objc;
+    *columnsPtr = columns;
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * AggregateOp --
+ *
+ *      Groups the rows of the table by the values of one or more columns
+ *      and creates a new table with the aggregates of each group.
+ * 
+ * Results:
+ *      A standard TCL result. The name of the new table is returned.
+ *
+ *      tableName aggregate -by columnList ?switches?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+AggregateOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
+{
+    AggregateSwitches switches;
+    BLT_TABLE_AGGREGATE *aggs;
+    BLT_TABLE_COLUMN *keys;
+    BLT_TABLE destTable;
+    Cmd *cmdPtr = clientData;
+    Tcl_DString ds;
+    int i, numKeys, numAggs, result;
+
+    memset(&switches, 0, sizeof(switches));
+    if (Blt_ParseSwitches(interp, aggregateSwitches, objc - 2, objv + 2, 
+                &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    aggs = NULL;
+    keys = NULL;
+    result = TCL_ERROR;
+    numKeys = 0;
+    if ((switches.byObjPtr != NULL) &&
+        (GetColumnList(interp, cmdPtr->table, switches.byObjPtr, &numKeys,
+                       &keys) != TCL_OK)) {
+        goto done;
+    }
+    if (numKeys == 0) {
+        Tcl_AppendResult(interp, "no columns to group by: ",
+                "the -by switch is required", (char *)NULL);
+        goto done;
+    }
+    numAggs = 0;
+    for (i = 0; i < 5; i++) {
+        BLT_TABLE_COLUMN *columns;
+        int j, numColumns;
+
+        if (switches.objv[i] == NULL) {
+            continue;
+        }
+        if (GetColumnList(interp, cmdPtr->table, switches.objv[i], 
+                &numColumns, &columns) != TCL_OK) {
+            goto done;
+        }
+        aggs = Blt_AssertRealloc(aggs, 
+                (numAggs + numColumns + 1) * sizeof(BLT_TABLE_AGGREGATE));
+        for (j = 0; j < numColumns; j++, numAggs++) {
+            aggs[numAggs].col = columns[j];
+            aggs[numAggs].op = i;
+        }
+        Blt_Free(columns);
+    }
+    Tcl_DStringInit(&ds);
+    if (NewResultTable(interp, &ds, &destTable) == TCL_OK) {
+        result = blt_table_aggregate(interp, cmdPtr->table, numKeys, keys,
+                numAggs, aggs, destTable);
+        if (result == TCL_OK) {
+            Tcl_DStringResult(interp, &ds);
+        } else {
+            Tcl_DeleteCommand(interp, Tcl_DStringValue(&ds));
+        }
+    }
+    Tcl_DStringFree(&ds);
+ done:
+    if (keys != NULL) {
+        Blt_Free(keys);
+    }
+    if (aggs != NULL) {
+        Blt_Free(aggs);
+    }
+    Blt_FreeSwitches(aggregateSwitches, &switches, 0);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * AppendOp --
+ *
+ *      Appends one or more values to the current value at the given
+ *      location. If the column or row doesn't already exist, it will
+ *      automatically be created.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or index is invalid, TCL_ERROR is
+ *      returned and an error message is left in the interpreter result.
+ *      
+ *      tableName append rowName columnName ?value ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+AppendOp(ClientData clientData, Tcl_Interp *interp, int objc,
+         Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE table;
+    BLT_TABLE_ITERATOR ri, ci;
+    BLT_TABLE_COLUMN col;
+    int i, extra;
+
+    table = cmdPtr->table;
+    if (IterateRowsWithCreate(interp, table, objv[2], &ri) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (IterateColumnsWithCreate(interp, table, objv[3], &ci) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    extra = 0;
+    for (i = 4; i < objc; i++) {
+        int length;
+
+        Tcl_GetStringFromObj(objv[i], &length);
+        extra += length;
+    }
+    if (extra == 0) {
+        return TCL_OK;
+    }
+    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+         col = blt_table_next_tagged_column(&ci)) {
+        BLT_TABLE_ROW row;
+        
+        for (row = blt_table_first_tagged_row(&ri); row != NULL; 
+             row = blt_table_next_tagged_row(&ri)) {
+            int i;
+
+            for (i = 4; i < objc; i++) {
+                const char *s;
+                int length;
+                
+                s = Tcl_GetStringFromObj(objv[i], &length);
+                if (blt_table_append_string(interp, table, row, col, s, length) 
+                    != TCL_OK) {
+                    return TCL_ERROR;
+                }
+            }
+        }
+    }       
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * BatchOp --
+ *
+ *      Evaluates a script as a batch of changes to the table.  Write,
+ *      create, and unset traces and notifier events are delivered once
+ *      the script completes, with one trace per changed cell.  Changes
+ *      aren't undone if the script fails.
+ *
+ *      tableName batch script
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+BatchOp(ClientData clientData, Tcl_Interp *interp, int objc,
+        Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE table;
+    int result;
+
+    table = cmdPtr->table;
+    Tcl_Preserve(cmdPtr);
+    blt_table_begin_batch(table);
+    result = Tcl_EvalObjEx(interp, objv[2], 0);
+    if (result == TCL_ERROR) {
+        Tcl_AddErrorInfo(interp, "\n    (\"batch\" script)");
+    }
+    /* The script may have attached to another table or deleted this
+     * one, discarding the batch. */
+    if (cmdPtr->table == table) {
+        Tcl_InterpState state;
+
+        /* Keep the script's result while the deferred callbacks run. */
+        state = Tcl_SaveInterpState(interp, result);
+        blt_table_end_batch(table);
+        result = Tcl_RestoreInterpState(interp, state);
+    }
+    Tcl_Release(cmdPtr);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * AttachOp --
+ *
+ *      tableName attach newTableName
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+AttachOp(ClientData clientData, Tcl_Interp *interp, int objc,
+         Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+
+    if (objc == 3) {
+        const char *qualName;
+        Blt_ObjectName objName;
+        BLT_TABLE table;
+        Tcl_DString ds;
+        int result;
+
+        if (!Blt_ParseObjectName(interp, Tcl_GetString(objv[2]), &objName, 0)) {
+            return TCL_ERROR;
+        }
+        qualName = Blt_MakeQualifiedName(&objName, &ds);
+        result = blt_table_open(interp, qualName, &table);
+        Tcl_DStringFree(&ds);
+        if (result != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (cmdPtr->table != NULL) {
+            Blt_HashEntry *hPtr;
+            Blt_HashSearch iter;
+            
+            blt_table_close(cmdPtr->table);
+
+            /* Free the extra bookkeeping that we're maintaining about the
+             * current table (table traces and notifiers).  */
+            for (hPtr = Blt_FirstHashEntry(&cmdPtr->traceTable, &iter); 
+                 hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+                TraceInfo *tracePtr;
+
+                tracePtr = Blt_GetHashValue(hPtr);
+                blt_table_delete_trace(cmdPtr->table, tracePtr->trace);
+            }
+            Blt_DeleteHashTable(&cmdPtr->traceTable);
+            Blt_InitHashTable(&cmdPtr->traceTable, TCL_STRING_KEYS);
+            for (hPtr = Blt_FirstHashEntry(&cmdPtr->watchTable, &iter); 
+                hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+                WatchInfo *watchPtr;
+
+                watchPtr = Blt_GetHashValue(hPtr);
+                FreeWatchInfo(watchPtr);
+            }
+            Blt_DeleteHashTable(&cmdPtr->watchTable);
+            Blt_InitHashTable(&cmdPtr->watchTable, TCL_STRING_KEYS);
+        }
+        cmdPtr->table = table;
+    }
+    Tcl_SetStringObj(Tcl_GetObjResult(interp), 
+        blt_table_name(cmdPtr->table), -1);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ClearOp --
+ *
+ *      tableName clear
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ClearOp(ClientData clientData, Tcl_Interp *interp, int objc,
+        Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+
+    if (blt_table_is_snapshot(cmdPtr->table)) {
+        Tcl_AppendResult(interp, "can't clear \"", 
+                blt_table_name(cmdPtr->table), "\": table is a snapshot",
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    blt_table_clear(cmdPtr->table);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnBindOp --
+ *
+ *      Reports and/or sets the vector bound to a column.  The vector
+ *      shares the values of the column, so changes to one are seen by the
+ *      other.  An empty vector name unbinds the column.
+ * 
+ * Results:
+ *      A standard TCL result.  If no vector name is given, the name of the
+ *      bound vector is returned, or the empty string if the column isn't
+ *      bound.  If the column can't be bound, TCL_ERROR is returned and an
+ *      error message is left in the interpreter result.
+ *
+ *      tableName column bind columnName ?vecName?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ColumnBindOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE_COLUMN col;
+
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        return TCL_ERROR;
     }
-    if (switchesPtr->mask & READ_DIR_MODE) {
-        col = GetColumn(interp, table, "mode", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_mode);
+    if (objc == 5) {
+        if (blt_table_bind_vector(interp, cmdPtr->table, col, 
+                Tcl_GetString(objv[4])) != TCL_OK) {
+            return TCL_ERROR;
+        }
     }
-    if (switchesPtr->mask & READ_DIR_PERMS) {
-        col = GetColumn(interp, table, "perms", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_mode & 07777);
+    if (blt_table_column_vector(col) != NULL) {
+        Tcl_SetStringObj(Tcl_GetObjResult(interp), 
+                blt_table_column_vector(col), -1);
     }
-    if (switchesPtr->mask & READ_DIR_INO) {
-        col = GetColumn(interp, table, "ino", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_ino);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnCopyOp --
+ *
+ *      Copies the specified columns to the table.  A different table may
+ *      be selected as the source.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
+ *
+ *      tableName column copy destColumn srcColumn ?switches?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ColumnCopyOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE srcTable, destTable;
+    BLT_TABLE_COLUMN srcColumn, destColumn;
+    CopySwitches switches;
+    int result;
+
+    /* Process switches following the column names. */
+    memset(&switches, 0, sizeof(switches));
+    result = TCL_ERROR;
+    if (Blt_ParseSwitches(interp, copySwitches, objc - 5, objv + 5, &switches, 
+        BLT_SWITCH_DEFAULTS) < 0) {
+        goto error;
     }
-    if (switchesPtr->mask & READ_DIR_NLINK) {
-        col = GetColumn(interp, table, "nlink", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_nlink);
+    /* Need to get the -table switch first to know what table to look up
+     * for the source column. */
+    srcTable = destTable = cmdPtr->table;
+    if (switches.table != NULL) {
+        srcTable = switches.table;
+    }
+    /* Destination column may not already exist. */
+    destColumn = NULL;
+    if ((switches.flags & COPY_NEW) == 0) {
+        destColumn = blt_table_get_column(interp, destTable, objv[3]);
+    }
+    if (destColumn == NULL) {
+        destColumn = blt_table_create_column(interp, destTable,
+                                             Tcl_GetString(objv[3]));
+        if (destColumn == NULL) {
+            goto error;
+        }
+    }
+    /* Source column must exist. */
+    srcColumn = blt_table_get_column(interp, srcTable, objv[4]);
+    if (srcColumn == NULL) {
+        goto error;
+    }
+    if (switches.flags & COPY_APPEND) {
+        if (AppendColumn(interp, srcTable, destTable, srcColumn, destColumn)
+            != TCL_OK) {
+            goto error;
+        }
+    } else {
+        if (CopyColumn(interp, srcTable, destTable, srcColumn, destColumn)
+            != TCL_OK) {
+            goto error;
+        }
+    }
+    if ((switches.flags & COPY_NOTAGS) == 0) {
+        CopyColumnTags(srcTable, destTable, srcColumn, destColumn);
+    }
+    result = TCL_OK;
+ error:
+    Blt_FreeSwitches(copySwitches, &switches, 0);
+    return result;
+    
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnJoinOp --
+ *
+ *      Joins by column the source table onto the destination.  Duplicate
+ *      column labels are allowed.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
+ *
+ *      tableName column join srcTableName ?switches?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ColumnJoinOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    JoinSwitches switches;
+    BLT_TABLE src, dst;
+    size_t oldWidth, extra;
+    int result;
+    BLT_TABLE_COLUMN srcCol;
+    size_t i;
+
+    /* Process switches following the column names. */
+    if (blt_table_open(interp, Tcl_GetString(objv[3]), &src) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    switches.flags = 0;
+    result = TCL_ERROR;
+    dst = cmdPtr->table;
+    columnIterSwitch.clientData = src;
+    blt_table_iterate_all_columns(src, &switches.ci);
+    if (Blt_ParseSwitches(interp, joinSwitches, objc - 4, objv + 4, &switches, 
+        BLT_SWITCH_DEFAULTS | JOIN_COLUMN) < 0) {
+        goto error;
+    }
+    oldWidth = blt_table_num_columns(dst);
+    extra = switches.ci.numEntries;
+    if (blt_table_extend_columns(interp, dst, extra, NULL) != TCL_OK) {
+        goto error;
+    }
+    i = oldWidth;
+    for (srcCol = blt_table_first_tagged_column(&switches.ci); srcCol != NULL; 
+         srcCol = blt_table_next_tagged_column(&switches.ci)) {
+        const char *label;
+        BLT_TABLE_COLUMN dstCol;
+        BLT_TABLE_ROW srcRow;
+        int srcType;
+
+        /* Copy the label and the column type. */
+        label = blt_table_column_label(srcCol);
+        dstCol = blt_table_column(dst, i);
+        i++;
+        if (blt_table_set_column_label(interp, dst, dstCol, label) != TCL_OK) {
+            goto error;
+        }
+        srcType = blt_table_column_type(srcCol);
+        if (blt_table_set_column_type(interp, cmdPtr->table, dstCol, srcType)
+            != TCL_OK) {
+            goto error;
+        }
+        for (srcRow = blt_table_first_row(src); srcRow != NULL; 
+             srcRow = blt_table_next_row(srcRow)) {
+            BLT_TABLE_VALUE value;
+            BLT_TABLE_ROW dstRow;
+
+            dstRow = blt_table_get_row_by_label(dst, label);
+            if (dstRow == NULL) {
+
+                /* If row doesn't exist in destination table, create a new
+                 * row, copying the label. */
+                
+                if (blt_table_extend_columns(interp, dst, 1, &dstCol)
+                    !=TCL_OK) {
+                    goto error;
+                }
+                if (blt_table_set_row_label(interp, dst, dstRow, label) 
+                    != TCL_OK) {
+                    goto error;
+                }
+            }
+            value = blt_table_get_value(src, srcRow, srcCol);
+            if (value == NULL) {
+                continue;
+            }
+            if (blt_table_set_value(dst, dstRow, dstCol, value) != TCL_OK) {
+                goto error;
+            }
+        }
+        if ((switches.flags & COPY_NOTAGS) == 0) {
+            CopyColumnTags(src, dst, srcCol, dstCol);
+        }
+    }
+    result = TCL_OK;
+ error:
+    blt_table_close(src);
+    Blt_FreeSwitches(addSwitches, &switches, JOIN_COLUMN);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnDeleteOp --
+ *
+ *      Deletes the columns designated.  One or more columns may be deleted
+ *      using a tag.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
+ *
+ *      tableName column delete ?columnName ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ColumnDeleteOp(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE_ITERATOR ci;
+    BLT_TABLE_COLUMN col;
+    int result;
+
+    result = TCL_ERROR;
+    if (blt_table_iterate_columns_objv(interp, cmdPtr->table, objc - 3,
+                objv + 3, &ci) != TCL_OK) {
+        return TCL_ERROR;
     }
-    if (switchesPtr->mask & READ_DIR_DEV) {
-        col = GetColumn(interp, table, "dev", TABLE_COLUMN_TYPE_LONG);
-        blt_table_set_long(interp, table, row, col, statPtr->st_rdev);
+    /* 
+     * Walk through the list of column offsets, deleting each column.
+     */
+    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+         col = blt_table_next_tagged_column(&ci)) {
+        if (blt_table_delete_column(cmdPtr->table, col) != TCL_OK) {
+            goto error;
+        }
     }
+    result = TCL_OK;
+ error:
+    blt_table_free_iterator_objv(&ci);
+    return result;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * AddOp --
+ * ColumnDupOp --
  *
- *      Adds to rows from the source table onto the destination. If the
- *      destination table doesn't already have a column, one is
- *      automatically created.
+ *      Duplicates the specified columns in the table.  This differs from
+ *      ColumnCopyOp, since the same table is the source and destination.
  * 
  * Results:
  *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
+ *      TCL_ERROR is returned and an error message is left in the interpreter
+ *      result.
  *
- *      tableName add srcTableName ?switches?
+ *      tableName column dup ?columnName ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-AddOp(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
+ColumnDupOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    AddSwitches switches;
-    BLT_TABLE srcTable;
-    size_t oldLength, count;
-    int result;
+    BLT_TABLE table;
+    Tcl_Obj *listObjPtr;
+    BLT_TABLE_ITERATOR ci;
     BLT_TABLE_COLUMN srcCol;
 
-    /* Process switches following the column names. */
-    if (blt_table_open(interp, Tcl_GetString(objv[2]), &srcTable) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    switches.flags = 0;
-    result = TCL_ERROR;
-    rowIterSwitch.clientData = srcTable;
-    columnIterSwitch.clientData = srcTable;
-    blt_table_iterate_all_rows(srcTable, &switches.ri);
-    blt_table_iterate_all_columns(srcTable, &switches.ci);
-    if (Blt_ParseSwitches(interp, addSwitches, objc - 3, objv + 3, 
-        &switches, BLT_SWITCH_DEFAULTS) < 0) {
-        goto error;
-    }
-    oldLength = blt_table_num_rows(cmdPtr->table);
-    count = switches.ri.numEntries;
-    if (blt_table_extend_rows(interp, cmdPtr->table, count, NULL) != TCL_OK) {
+    table = cmdPtr->table;
+    listObjPtr = NULL;
+    if (blt_table_iterate_columns_objv(interp, table, objc - 3, objv + 3, &ci) 
+        != TCL_OK) {
         goto error;
     }
-    for (srcCol = blt_table_first_tagged_column(&switches.ci); srcCol != NULL; 
-         srcCol = blt_table_next_tagged_column(&switches.ci)) {
-        const char *label;
-        BLT_TABLE_COLUMN dstCol;
-        BLT_TABLE_ROW srcRow;
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    for (srcCol = blt_table_first_tagged_column(&ci); srcCol != NULL; 
+         srcCol = blt_table_next_tagged_column(&ci)) {
         size_t i;
+        BLT_TABLE_COLUMN dstCol;
 
-        label = blt_table_column_label(srcCol);
-        dstCol = blt_table_get_column_by_label(cmdPtr->table, label);
+        dstCol = blt_table_create_column(interp, table, 
+                blt_table_column_label(srcCol));
         if (dstCol == NULL) {
-            /* If column doesn't exist in destination table, create a new
-             * column, copying the label and the column type. */
-            if (blt_table_extend_columns(interp, cmdPtr->table, 1, &dstCol) 
-                != TCL_OK) {
-                goto error;
-            }
-            if (blt_table_set_column_label(interp, cmdPtr->table, dstCol, label)
-                != TCL_OK) {
-                goto error;
-            }
-            if (blt_table_set_column_type(interp, cmdPtr->table, dstCol, 
-                blt_table_column_type(srcCol)) != TCL_OK) {
-                goto error;
-            }
-        }
-        i = oldLength;
-        for (srcRow = blt_table_first_tagged_row(&switches.ri); srcRow != NULL; 
-             srcRow = blt_table_next_tagged_row(&switches.ri)) {
-            BLT_TABLE_VALUE value;
-            BLT_TABLE_ROW dstRow;
-
-            value = blt_table_get_value(srcTable, srcRow, srcCol);
-            if (value == NULL) {
-                continue;
-            }
-            dstRow = blt_table_row(cmdPtr->table, i);
-            if (blt_table_set_value(cmdPtr->table, dstRow, dstCol, value) 
-                != TCL_OK) {
-                goto error;
-            }
-            i++;
+            goto error;
         }
-        if ((switches.flags & COPY_NOTAGS) == 0) {
-            CopyColumnTags(srcTable, cmdPtr->table, srcCol, dstCol);
+        if (CopyColumn(interp, table, table, srcCol, dstCol) != TCL_OK) {
+            goto error;
         }
+        CopyColumnTags(table, table, srcCol, dstCol);
+        i = blt_table_column_index(table, dstCol);
+        Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewWideIntObj(i));
     }
-    result = TCL_OK;
+    blt_table_free_iterator_objv(&ci);
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
  error:
-    blt_table_close(srcTable);
-    Blt_FreeSwitches(addSwitches, &switches, 0);
-    return result;
+    blt_table_free_iterator_objv(&ci);
+    if (listObjPtr != NULL) {
+        Tcl_DecrRefCount(listObjPtr);
+    }
+    return TCL_ERROR;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * AppendOp --
+ * ColumnEmptyOp --
+ *
+ *      Returns a list of the rows with empty values in the given column.
  *
- *      Appends one or more values to the current value at the given
- *      location. If the column or row doesn't already exist, it will
- *      automatically be created.
- * 
  * Results:
- *      A standard TCL result. If the tag or index is invalid, TCL_ERROR is
- *      returned and an error message is left in the interpreter result.
- *      
- *      tableName append rowName columnName ?value ...?
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
  *
+ *      tableName column empty columnName
+ *      
  *---------------------------------------------------------------------------
  */
 static int
-AppendOp(ClientData clientData, Tcl_Interp *interp, int objc,
-         Tcl_Obj *const *objv)
+ColumnEmptyOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    BLT_TABLE_ITERATOR ri, ci;
     BLT_TABLE_COLUMN col;
-    int i, extra;
+    Tcl_Obj *listObjPtr;
 
-    table = cmdPtr->table;
-    if (IterateRowsWithCreate(interp, table, objv[2], &ri) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    if (IterateColumnsWithCreate(interp, table, objv[3], &ci) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    extra = 0;
-    for (i = 4; i < objc; i++) {
-        int length;
+    BLT_TABLE_ROW row;
 
-        Tcl_GetStringFromObj(objv[i], &length);
-        extra += length;
-    }
-    if (extra == 0) {
-        return TCL_OK;
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        return TCL_ERROR;
     }
-    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-         col = blt_table_next_tagged_column(&ci)) {
-        BLT_TABLE_ROW row;
-        
-        for (row = blt_table_first_tagged_row(&ri); row != NULL; 
-             row = blt_table_next_tagged_row(&ri)) {
-            int i;
-
-            for (i = 4; i < objc; i++) {
-                const char *s;
-                int length;
-                
-                s = Tcl_GetStringFromObj(objv[i], &length);
-                if (blt_table_append_string(interp, table, row, col, s, length) 
-                    != TCL_OK) {
-                    return TCL_ERROR;
-                }
-            }
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    for (row = blt_table_first_row(cmdPtr->table); row != NULL;
+         row = blt_table_next_row(row)) {
+        if (!blt_table_value_exists(cmdPtr->table, row, col))  {
+            Tcl_Obj *objPtr;
+            
+            objPtr = GetRowIndexObj(cmdPtr->table, row);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
         }
-    }       
+    }
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * AttachOp --
+ * ColumnEncodedOp --
  *
- *      tableName attach newTableName
+ *      Reports and/or sets whether string columns are dictionary encoded.
+ *      Encoded columns store each distinct string once and a small code
+ *      for each row.
+ * 
+ * Results:
+ *      A standard TCL result.  If no boolean is given, a list of the
+ *      encoded states of the columns is returned.  If a column can't be
+ *      encoded, TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
+ *      
+ *      tableName column encoded columnName ?boolean?
  *
  *---------------------------------------------------------------------------
  */
 static int
-AttachOp(ClientData clientData, Tcl_Interp *interp, int objc,
-         Tcl_Obj *const *objv)
+ColumnEncodedOp(ClientData clientData, Tcl_Interp *interp, int objc,
+                Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
+    BLT_TABLE_ITERATOR ci;
+    BLT_TABLE_COLUMN col;
+    int state;
 
-    if (objc == 3) {
-        const char *qualName;
-        Blt_ObjectName objName;
-        BLT_TABLE table;
-        Tcl_DString ds;
-        int result;
-
-        if (!Blt_ParseObjectName(interp, Tcl_GetString(objv[2]), &objName, 0)) {
-            return TCL_ERROR;
-        }
-        qualName = Blt_MakeQualifiedName(&objName, &ds);
-        result = blt_table_open(interp, qualName, &table);
-        Tcl_DStringFree(&ds);
-        if (result != TCL_OK) {
-            return TCL_ERROR;
-        }
-        if (cmdPtr->table != NULL) {
-            Blt_HashEntry *hPtr;
-            Blt_HashSearch iter;
-            
-            blt_table_close(cmdPtr->table);
-
-            /* Free the extra bookkeeping that we're maintaining about the
-             * current table (table traces and notifiers).  */
-            for (hPtr = Blt_FirstHashEntry(&cmdPtr->traceTable, &iter); 
-                 hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
-                TraceInfo *tracePtr;
+    if (blt_table_iterate_columns(interp, cmdPtr->table, objv[3], &ci) 
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (objc == 4) {
+        Tcl_Obj *listObjPtr;
 
-                tracePtr = Blt_GetHashValue(hPtr);
-                blt_table_delete_trace(cmdPtr->table, tracePtr->trace);
-            }
-            Blt_DeleteHashTable(&cmdPtr->traceTable);
-            Blt_InitHashTable(&cmdPtr->traceTable, TCL_STRING_KEYS);
-            for (hPtr = Blt_FirstHashEntry(&cmdPtr->watchTable, &iter); 
-                hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
-                WatchInfo *watchPtr;
+        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+             col = blt_table_next_tagged_column(&ci)) {
+            Tcl_Obj *objPtr;
 
-                watchPtr = Blt_GetHashValue(hPtr);
-                FreeWatchInfo(watchPtr);
+            objPtr = Tcl_NewBooleanObj(blt_table_column_is_encoded(col));
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
+        Tcl_SetObjResult(interp, listObjPtr);
+        return TCL_OK;
+    }
+    if (Tcl_GetBooleanFromObj(interp, objv[4], &state) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+         col = blt_table_next_tagged_column(&ci)) {
+        if (state) {
+            if (blt_table_encode_column(interp, cmdPtr->table, col) 
+                != TCL_OK) {
+                return TCL_ERROR;
             }
-            Blt_DeleteHashTable(&cmdPtr->watchTable);
-            Blt_InitHashTable(&cmdPtr->watchTable, TCL_STRING_KEYS);
+        } else {
+            blt_table_decode_column(cmdPtr->table, col);
         }
-        cmdPtr->table = table;
     }
-    Tcl_SetStringObj(Tcl_GetObjResult(interp), 
-        blt_table_name(cmdPtr->table), -1);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ClearOp --
+ * ColumnExistsOp --
  *
- *      tableName clear
+ *      Indicates is the given column exists.  The column description can be
+ *      either an index, label, or single tag.
+ *
+ *      Problem: The blt_table_iterate_columns function checks both for
+ *               1) valid/invalid indices, labels, and tags and 2) 
+ *               syntax errors.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the interpreter
+ *      result.
  *
+ *      tableName column exists columnName
+ *      
  *---------------------------------------------------------------------------
  */
 static int
-ClearOp(ClientData clientData, Tcl_Interp *interp, int objc,
-        Tcl_Obj *const *objv)
+ColumnExistsOp(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
+    BLT_TABLE_COLUMN col;
+    int bool;
 
-    blt_table_clear(cmdPtr->table);
+    col = blt_table_get_column(NULL, cmdPtr->table, objv[3]);
+    bool = (col != NULL);
+    Tcl_SetBooleanObj(Tcl_GetObjResult(interp), bool);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnCopyOp --
+ * ColumnExtendOp --
  *
- *      Copies the specified columns to the table.  A different table may
- *      be selected as the source.
+ *      Extends the table by the given number of columns.
  * 
  * Results:
  *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
- *
- *      tableName column copy destColumn srcColumn ?switches?
+ *      TCL_ERROR is returned and an error message is left in the interpreter
+ *      result.
  *
+ *      tableName column extend numColumns ?switches?
+ *      
  *---------------------------------------------------------------------------
  */
 static int
-ColumnCopyOp(ClientData clientData, Tcl_Interp *interp, int objc,
-             Tcl_Obj *const *objv)
+ColumnExtendOp(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE srcTable, destTable;
-    BLT_TABLE_COLUMN srcColumn, destColumn;
-    CopySwitches switches;
+    BLT_TABLE table;
+    BLT_TABLE_COLUMN *cols;
+    long numColumns;
+    ExtendSwitches switches;
     int result;
-
-    /* Process switches following the column names. */
+    
     memset(&switches, 0, sizeof(switches));
-    result = TCL_ERROR;
-    if (Blt_ParseSwitches(interp, copySwitches, objc - 5, objv + 5, &switches, 
-        BLT_SWITCH_DEFAULTS) < 0) {
-        goto error;
+    if (Blt_ParseSwitches(interp, extendSwitches, objc - 4, objv + 4,
+                &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
     }
-    /* Need to get the -table switch first to know what table to look up
-     * for the source column. */
-    srcTable = destTable = cmdPtr->table;
-    if (switches.table != NULL) {
-        srcTable = switches.table;
+    table = cmdPtr->table;
+
+    if (Blt_GetCountFromObj(interp, objv[3], COUNT_NNEG, &numColumns)
+        != TCL_OK) {
+        return TCL_ERROR;
     }
-    /* Destination column may not already exist. */
-    destColumn = NULL;
-    if ((switches.flags & COPY_NEW) == 0) {
-        destColumn = blt_table_get_column(interp, destTable, objv[3]);
+    if (numColumns == 0) {
+        return TCL_OK;
     }
-    if (destColumn == NULL) {
-        destColumn = blt_table_create_column(interp, destTable,
-                                             Tcl_GetString(objv[3]));
-        if (destColumn == NULL) {
-            goto error;
+    cols = Blt_AssertMalloc(numColumns * sizeof(BLT_TABLE_COLUMN));
+    result = blt_table_extend_columns(interp, table, numColumns, cols);
+    if ((result == TCL_OK) && (switches.labels != NULL)) {
+        size_t i;
+        const char **p;
+        
+        for (i = 0, p = switches.labels; *p != NULL; p++, i++) {
+            result = blt_table_set_column_label(interp, table, cols[i], *p);
+            if (result != TCL_OK) {
+                break;
+            }
         }
     }
-    /* Source column must exist. */
-    srcColumn = blt_table_get_column(interp, srcTable, objv[4]);
-    if (srcColumn == NULL) {
-        goto error;
-    }
-    if (switches.flags & COPY_APPEND) {
-        if (AppendColumn(interp, srcTable, destTable, srcColumn, destColumn)
-            != TCL_OK) {
-            goto error;
-        }
-    } else {
-        if (CopyColumn(interp, srcTable, destTable, srcColumn, destColumn)
-            != TCL_OK) {
-            goto error;
+    if (result == TCL_OK) {
+        size_t i;
+        Tcl_Obj *listObjPtr;
+
+        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        for (i = 0; i < numColumns; i++) {
+            Tcl_Obj *objPtr;
+            
+            objPtr = GetColumnIndexObj(table, cols[i]);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
         }
+        Tcl_SetObjResult(interp, listObjPtr);
     }
-    if ((switches.flags & COPY_NOTAGS) == 0) {
-        CopyColumnTags(srcTable, destTable, srcColumn, destColumn);
-    }
-    result = TCL_OK;
- error:
-    Blt_FreeSwitches(copySwitches, &switches, 0);
+    Blt_Free(cols);
+    Blt_FreeSwitches(extendSwitches, &switches, 0);
     return result;
-    
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnJoinOp --
+ * ColumnGetOp --
  *
- *      Joins by column the source table onto the destination.  Duplicate
- *      column labels are allowed.
+ *      Retrieves a column of values.  The column argument can be either a
+ *      tag, label, or column index.  If it is a tag, it must refer to exactly
+ *      one column.  If row arguments exist they must refer to label or row.
+ *      We always return the row label.
  * 
  * Results:
- *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
- *
- *      tableName column join srcTableName ?switches?
+ *      A standard TCL result.  If successful, a list of values is returned in
+ *      the interpreter result.  If the column index is invalid, TCL_ERROR is
+ *      returned and an error message is left in the interpreter result.
+ *      
+ *      tableName column get -labels columnName ?rowName ...? 
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnJoinOp(ClientData clientData, Tcl_Interp *interp, int objc,
-             Tcl_Obj *const *objv)
+ColumnGetOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    JoinSwitches switches;
-    BLT_TABLE src, dst;
-    size_t oldWidth, extra;
-    int result;
-    BLT_TABLE_COLUMN srcCol;
-    size_t i;
+    BLT_TABLE table;
+    BLT_TABLE_COLUMN col;
+    Tcl_Obj *listObjPtr;
+    const char *string;
+    int needLabels;
 
-    /* Process switches following the column names. */
-    if (blt_table_open(interp, Tcl_GetString(objv[3]), &src) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    switches.flags = 0;
-    result = TCL_ERROR;
-    dst = cmdPtr->table;
-    columnIterSwitch.clientData = src;
-    blt_table_iterate_all_columns(src, &switches.ci);
-    if (Blt_ParseSwitches(interp, joinSwitches, objc - 4, objv + 4, &switches, 
-        BLT_SWITCH_DEFAULTS | JOIN_COLUMN) < 0) {
-        goto error;
+    string = Tcl_GetString(objv[3]);
+    needLabels = FALSE;
+    if (strcmp(string, "-labels") == 0) {
+        objv++, objc--;
+        needLabels = TRUE;
     }
-    oldWidth = blt_table_num_columns(dst);
-    extra = switches.ci.numEntries;
-    if (blt_table_extend_columns(interp, dst, extra, NULL) != TCL_OK) {
-        goto error;
+    table = cmdPtr->table;
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        return TCL_ERROR;
     }
-    i = oldWidth;
-    for (srcCol = blt_table_first_tagged_column(&switches.ci); srcCol != NULL; 
-         srcCol = blt_table_next_tagged_column(&switches.ci)) {
-        const char *label;
-        BLT_TABLE_COLUMN dstCol;
-        BLT_TABLE_ROW srcRow;
-        int srcType;
-
-        /* Copy the label and the column type. */
-        label = blt_table_column_label(srcCol);
-        dstCol = blt_table_column(dst, i);
-        i++;
-        if (blt_table_set_column_label(interp, dst, dstCol, label) != TCL_OK) {
-            goto error;
-        }
-        srcType = blt_table_column_type(srcCol);
-        if (blt_table_set_column_type(interp, cmdPtr->table, dstCol, srcType)
-            != TCL_OK) {
-            goto error;
-        }
-        for (srcRow = blt_table_first_row(src); srcRow != NULL; 
-             srcRow = blt_table_next_row(srcRow)) {
-            BLT_TABLE_VALUE value;
-            BLT_TABLE_ROW dstRow;
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    if (objc == 4) {
+        BLT_TABLE_ROW row;
 
-            dstRow = blt_table_get_row_by_label(dst, label);
-            if (dstRow == NULL) {
+        for (row = blt_table_first_row(cmdPtr->table); row != NULL;
+             row = blt_table_next_row(row)) {
+            Tcl_Obj *objPtr;
 
-                /* If row doesn't exist in destination table, create a new
-                 * row, copying the label. */
-                
-                if (blt_table_extend_columns(interp, dst, 1, &dstCol)
-                    !=TCL_OK) {
-                    goto error;
-                }
-                if (blt_table_set_row_label(interp, dst, dstRow, label) 
-                    != TCL_OK) {
-                    goto error;
-                }
-            }
-            value = blt_table_get_value(src, srcRow, srcCol);
-            if (value == NULL) {
-                continue;
+            if (needLabels) {
+                objPtr = Tcl_NewStringObj(blt_table_row_label(row), -1);
+            } else {
+                objPtr = GetRowIndexObj(cmdPtr->table, row);
             }
-            if (blt_table_set_value(dst, dstRow, dstCol, value) != TCL_OK) {
-                goto error;
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+            objPtr = blt_table_get_obj(cmdPtr->table, row, col);
+            if (objPtr == NULL) {
+                objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
             }
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
         }
-        if ((switches.flags & COPY_NOTAGS) == 0) {
-            CopyColumnTags(src, dst, srcCol, dstCol);
+    } else {
+        BLT_TABLE_ITERATOR ri;
+        BLT_TABLE_ROW row;
+
+        if (blt_table_iterate_rows_objv(interp, table, objc - 4, objv + 4, &ri) 
+            != TCL_OK) {
+            return TCL_ERROR;
+        }
+        for (row = blt_table_first_tagged_row(&ri); row != NULL; 
+             row = blt_table_next_tagged_row(&ri)) {
+            Tcl_Obj *objPtr;
+            
+            if (needLabels) {
+                objPtr = Tcl_NewStringObj(blt_table_row_label(row), -1);
+            } else {
+                objPtr = GetRowIndexObj(cmdPtr->table, row);
+            }
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+            objPtr = blt_table_get_obj(cmdPtr->table, row, col);
+            if (objPtr == NULL) {
+                objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
+            }
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
         }
+        blt_table_free_iterator_objv(&ri);
     }
-    result = TCL_OK;
- error:
-    blt_table_close(src);
-    Blt_FreeSwitches(addSwitches, &switches, JOIN_COLUMN);
-    return result;
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnDeleteOp --
+ * ColumnIndexOp --
  *
- *      Deletes the columns designated.  One or more columns may be deleted
- *      using a tag.
+ *      Returns the column index of the given column tag, label, or index.
+ *      A tag can't represent more than one column.
  * 
  * Results:
  *      A standard TCL result. If the tag or column index is invalid,
  *      TCL_ERROR is returned and an error message is left in the
  *      interpreter result.
  *
- *      tableName column delete ?columnName ...?
- *
+ *      tableName column index columnName
+ *      
  *---------------------------------------------------------------------------
  */
 static int
-ColumnDeleteOp(ClientData clientData, Tcl_Interp *interp, int objc,
-               Tcl_Obj *const *objv)
+ColumnIndexOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE_ITERATOR ci;
-    BLT_TABLE_COLUMN col;
-    int result;
+    BLT_TABLE_ITERATOR iter;
+    long index;
 
-    result = TCL_ERROR;
-    if (blt_table_iterate_columns_objv(interp, cmdPtr->table, objc - 3,
-                objv + 3, &ci) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    /* 
-     * Walk through the list of column offsets, deleting each column.
-     */
-    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-         col = blt_table_next_tagged_column(&ci)) {
-        if (blt_table_delete_column(cmdPtr->table, col) != TCL_OK) {
-            goto error;
+    index = -1;
+    if (blt_table_iterate_columns(interp, cmdPtr->table, objv[3], &iter)
+        == TCL_OK) {
+        BLT_TABLE_COLUMN col;
+
+        col = blt_table_first_tagged_column(&iter);
+        if (col != NULL) {
+            BLT_TABLE_COLUMN next;
+            
+            index = blt_table_column_index(cmdPtr->table, col);
+            next = blt_table_next_tagged_column(&iter);
+            if (next != NULL) {
+                /* It's not an error to look for an index of a column that
+                 * doesn't exist. Duplicate labels are another story. This
+                 * is too subtle a problem. Better to error on
+                 * duplicates.  */
+                const char *tag;
+            
+                blt_table_column_spec(cmdPtr->table, objv[3], &tag);
+                Tcl_AppendResult(interp, "multiple columns specified by \"", 
+                                 tag, "\"", (char *)NULL);
+                return TCL_ERROR;
+            }
         }
     }
-    result = TCL_OK;
- error:
-    blt_table_free_iterator_objv(&ci);
-    return result;
+    Tcl_SetWideIntObj(Tcl_GetObjResult(interp), index);
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnDupOp --
+ * ColumnIndicesOp --
  *
- *      Duplicates the specified columns in the table.  This differs from
- *      ColumnCopyOp, since the same table is the source and destination.
+ *      Returns a list of indices for the given column labels.  If the
+ *      column by that label doesn't exists, -1 is returned for the index.
+ *      If the column label refers to multiple columns, a list of the
+ *      indices is returned.
  * 
  * Results:
  *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the interpreter
- *      result.
- *
- *      tableName column dup ?columnName ...?
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
  *
+ *      tableName column indices ?label ...?
+ *      
  *---------------------------------------------------------------------------
  */
 static int
-ColumnDupOp(ClientData clientData, Tcl_Interp *interp, int objc,
-            Tcl_Obj *const *objv)
+ColumnIndicesOp(ClientData clientData, Tcl_Interp *interp, int objc,
+                Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
     Tcl_Obj *listObjPtr;
-    BLT_TABLE_ITERATOR ci;
-    BLT_TABLE_COLUMN srcCol;
+    IndicesSwitches switches;
+    int i;
 
-    table = cmdPtr->table;
-    listObjPtr = NULL;
-    if (blt_table_iterate_columns_objv(interp, table, objc - 3, objv + 3, &ci) 
-        != TCL_OK) {
-        goto error;
+    switches.flags = 0;
+    i = Blt_ParseSwitches(interp, indicesSwitches, objc - 3, objv + 3, 
+        &switches, BLT_SWITCH_OBJV_PARTIAL);
+    if (i < 0)  {
+        return TCL_ERROR;
     }
+    objc -= i, objv += i;
     listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (srcCol = blt_table_first_tagged_column(&ci); srcCol != NULL; 
-         srcCol = blt_table_next_tagged_column(&ci)) {
-        size_t i;
-        BLT_TABLE_COLUMN dstCol;
-
-        dstCol = blt_table_create_column(interp, table, 
-                blt_table_column_label(srcCol));
-        if (dstCol == NULL) {
-            goto error;
+    for (i = 3; i < objc; i++) {
+        Blt_HashTable *tablePtr;
+        Blt_HashEntry *hPtr;
+        Blt_HashSearch iter;
+        const char *label;
+        
+        label = Tcl_GetString(objv[i]);
+        tablePtr = blt_table_column_get_label_table(cmdPtr->table, label);
+        if (tablePtr == NULL) {
+            /* Label doesn't refer to any column. */
+            Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewWideIntObj(-1));
+            continue;
         }
-        if (CopyColumn(interp, table, table, srcCol, dstCol) != TCL_OK) {
-            goto error;
+        if ((switches.flags & INDICES_DUPLICATES) &&
+            (tablePtr->numEntries == 1)) {
+            continue;                   /* Only report duplicates. */
+        }
+        if (objc == 4) {
+            /* Check if there's only one label argument.  If this case we
+             * don't want to return a list of lists for duplicate labels.*/
+            for (hPtr = Blt_FirstHashEntry(tablePtr, &iter); hPtr != NULL;
+                 hPtr = Blt_NextHashEntry(&iter)) {
+                BLT_TABLE_COLUMN col;
+                Tcl_Obj *objPtr;
+                
+                col = Blt_GetHashValue(hPtr);
+                objPtr = GetColumnIndexObj(cmdPtr->table, col);
+                Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+            }
+        } else {
+            Tcl_Obj *subListObjPtr;
+
+            subListObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+            for (hPtr = Blt_FirstHashEntry(tablePtr, &iter); hPtr != NULL;
+                 hPtr = Blt_NextHashEntry(&iter)) {
+                BLT_TABLE_COLUMN col;
+                Tcl_Obj *objPtr;
+                
+                col = Blt_GetHashValue(hPtr);
+                objPtr = GetColumnIndexObj(cmdPtr->table, col);
+                Tcl_ListObjAppendElement(interp, subListObjPtr, objPtr);
+            }
+            Tcl_ListObjAppendElement(interp, listObjPtr, subListObjPtr);
         }
-        CopyColumnTags(table, table, srcCol, dstCol);
-        i = blt_table_column_index(table, dstCol);
-        Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewWideIntObj(i));
     }
-    blt_table_free_iterator_objv(&ci);
     Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
- error:
-    blt_table_free_iterator_objv(&ci);
-    if (listObjPtr != NULL) {
-        Tcl_DecrRefCount(listObjPtr);
-    }
-    return TCL_ERROR;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnEmptyOp --
- *
- *      Returns a list of the rows with empty values in the given column.
+ * ColumnCreateOp --
  *
+ *      Creates a single new column in the table.  The location of the new
+ *      column may be specified by -before or -after switches.  By default
+ *      the new column is added to the end of the table.
+ * 
  * Results:
  *      A standard TCL result. If the tag or column index is invalid,
  *      TCL_ERROR is returned and an error message is left in the
  *      interpreter result.
  *
- *      tableName column empty columnName
+ *      tableName column create ?switches?
  *      
  *---------------------------------------------------------------------------
  */
 static int
-ColumnEmptyOp(ClientData clientData, Tcl_Interp *interp, int objc,
-              Tcl_Obj *const *objv)
+ColumnCreateOp(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
+    InsertColumnSwitches switches;
     BLT_TABLE_COLUMN col;
-    Tcl_Obj *listObjPtr;
 
-    BLT_TABLE_ROW row;
+    memset(&switches, 0, sizeof(switches));
+    switches.cmdPtr = cmdPtr;
+    switches.type = TABLE_COLUMN_TYPE_STRING;
 
-    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (Blt_ParseSwitches(interp, insertColumnSwitches, objc - 3, objv + 3, 
+        &switches, 0) < 0) {
+        goto error;
+    }
+    col = blt_table_create_column(interp, cmdPtr->table, switches.label);
     if (col == NULL) {
-        return TCL_ERROR;
+        goto error;
     }
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (row = blt_table_first_row(cmdPtr->table); row != NULL;
-         row = blt_table_next_row(row)) {
-        if (!blt_table_value_exists(cmdPtr->table, row, col))  {
-            Tcl_Obj *objPtr;
-            
-            objPtr = GetRowIndexObj(cmdPtr->table, row);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+    if (blt_table_set_column_type(interp, cmdPtr->table, col, switches.type)
+        != TCL_OK) {
+        goto error;
+    }
+    if (switches.destColumn != NULL) {
+        if (blt_table_move_columns(interp, cmdPtr->table, switches.destColumn, 
+                col, col, switches.flags & INSERT_AFTER) != TCL_OK) {
+            goto error;
         }
     }
-    Tcl_SetObjResult(interp, listObjPtr);
+    if (switches.tags != NULL) {
+        Tcl_Obj **elv;
+        int elc;
+        int i;
+
+        if (Tcl_ListObjGetElements(interp, switches.tags, &elc, &elv) 
+            != TCL_OK) {
+            goto error;
+        }
+        for (i = 0; i < elc; i++) {
+            if (blt_table_set_column_tag(interp, cmdPtr->table, col, 
+                        Tcl_GetString(elv[i])) != TCL_OK) {
+                goto error;
+            }
+        }
+    }
+    Tcl_SetObjResult(interp, GetColumnIndexObj(cmdPtr->table, col));
+    Blt_FreeSwitches(insertColumnSwitches, &switches, 0);
     return TCL_OK;
+ error:
+    Blt_FreeSwitches(insertColumnSwitches, &switches, 0);
+    return TCL_ERROR;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnExistsOp --
- *
- *      Indicates is the given column exists.  The column description can be
- *      either an index, label, or single tag.
+ * ColumnLabelOp --
  *
- *      Problem: The blt_table_iterate_columns function checks both for
- *               1) valid/invalid indices, labels, and tags and 2) 
- *               syntax errors.
+ *      Gets/sets one or more column labels.  
  * 
  * Results:
- *      A standard TCL result. If the tag or column index is invalid,
+ *      A standard TCL result.  If successful, the old column label is
+ *      returned in the interpreter result.  If the column index is invalid,
  *      TCL_ERROR is returned and an error message is left in the interpreter
  *      result.
- *
- *      tableName column exists columnName
  *      
+ *      tableName column label columnName ?label columnName label ...? 
+ *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnExistsOp(ClientData clientData, Tcl_Interp *interp, int objc,
-               Tcl_Obj *const *objv)
+ColumnLabelOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE_COLUMN col;
-    int bool;
+    BLT_TABLE table;
 
-    col = blt_table_get_column(NULL, cmdPtr->table, objv[3]);
-    bool = (col != NULL);
-    Tcl_SetBooleanObj(Tcl_GetObjResult(interp), bool);
+    table = cmdPtr->table;
+    if (objc == 4) {
+        const char *label;
+        BLT_TABLE_COLUMN col;
+
+        col = blt_table_get_column(interp, table, objv[3]);
+        if (col == NULL) {
+            return TCL_ERROR;
+        }
+        label = blt_table_column_label(col);
+        Tcl_SetStringObj(Tcl_GetObjResult(interp), label, -1);
+    }  else {
+        int i;
+        
+        if ((objc - 3) & 1) {
+            Tcl_AppendResult(interp,"odd # of column/label pairs: should be \"",
+                Tcl_GetString(objv[0]), " column label ?column label?...", 
+                             (char *)NULL);
+            return TCL_ERROR;
+        }
+        for (i = 3; i < objc; i += 2) {
+            BLT_TABLE_COLUMN col;
+            const char *label;
+
+            col = blt_table_get_column(interp, table, objv[i]);
+            if (col == NULL) {
+                return TCL_ERROR;
+            }
+            label = Tcl_GetString(objv[i+1]);
+            if (label[0] == '\0') {
+                continue;               /* Don't set empty labels. */
+            }
+            if (blt_table_set_column_label(interp, table, col, label) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+    }
     return TCL_OK;
 }
 
+
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnExtendOp --
+ * ColumnLabelsOp --
  *
- *      Extends the table by the given number of columns.
+ *      Gets/sets all the column labels in the table.  
  * 
  * Results:
- *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the interpreter
- *      result.
- *
- *      tableName column extend numColumns ?switches?
+ *      A standard TCL result.  If successful, a list of values is returned
+ *      in the interpreter result.
  *      
+ *      tableName column labels ?labelList? 
+ *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnExtendOp(ClientData clientData, Tcl_Interp *interp, int objc,
+ColumnLabelsOp(ClientData clientData, Tcl_Interp *interp, int objc,
                Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
     BLT_TABLE table;
-    BLT_TABLE_COLUMN *cols;
-    long numColumns;
-    ExtendSwitches switches;
-    int result;
-    
-    memset(&switches, 0, sizeof(switches));
-    if (Blt_ParseSwitches(interp, extendSwitches, objc - 4, objv + 4,
-                &switches, BLT_SWITCH_DEFAULTS) < 0) {
-        return TCL_ERROR;
-    }
-    table = cmdPtr->table;
 
-    if (Blt_GetCountFromObj(interp, objv[3], COUNT_NNEG, &numColumns)
-        != TCL_OK) {
-        return TCL_ERROR;
-    }
-    if (numColumns == 0) {
-        return TCL_OK;
-    }
-    cols = Blt_AssertMalloc(numColumns * sizeof(BLT_TABLE_COLUMN));
-    result = blt_table_extend_columns(interp, table, numColumns, cols);
-    if ((result == TCL_OK) && (switches.labels != NULL)) {
-        size_t i;
-        const char **p;
-        
-        for (i = 0, p = switches.labels; *p != NULL; p++, i++) {
-            result = blt_table_set_column_label(interp, table, cols[i], *p);
-            if (result != TCL_OK) {
-                break;
-            }
-        }
-    }
-    if (result == TCL_OK) {
-        size_t i;
+    table = cmdPtr->table;
+    if (objc == 3) {
+        BLT_TABLE_COLUMN col;
         Tcl_Obj *listObjPtr;
 
         listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-        for (i = 0; i < numColumns; i++) {
+        for (col = blt_table_first_column(cmdPtr->table); col != NULL;
+             col = blt_table_next_column(col)) {
+            const char *label;
             Tcl_Obj *objPtr;
             
-            objPtr = GetColumnIndexObj(table, cols[i]);
+            label = blt_table_column_label(col);
+            objPtr = Tcl_NewStringObj(label, -1);
             Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
         }
         Tcl_SetObjResult(interp, listObjPtr);
+    } else {
+        Tcl_Obj **elv;
+        int elc, n;
+        int i;
+
+        if (Tcl_ListObjGetElements(interp, objv[3], &elc, &elv) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        n = MIN(elc, blt_table_num_columns(table));
+        for (i = 0; i < n; i++) {
+            BLT_TABLE_COLUMN col;
+            const char *label;
+
+            col = blt_table_column(table, i);
+            label = Tcl_GetString(elv[i]);
+            if (label[0] == '\0') {
+                continue;
+            }
+            if (blt_table_set_column_label(interp, table, col, label)
+                != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
     }
-    Blt_Free(cols);
-    Blt_FreeSwitches(extendSwitches, &switches, 0);
-    return result;
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnGetOp --
+ * ColumnMoveOp --
  *
- *      Retrieves a column of values.  The column argument can be either a
- *      tag, label, or column index.  If it is a tag, it must refer to exactly
- *      one column.  If row arguments exist they must refer to label or row.
- *      We always return the row label.
+ *      Moves the given number of columns to another location in the table.
  * 
  * Results:
- *      A standard TCL result.  If successful, a list of values is returned in
- *      the interpreter result.  If the column index is invalid, TCL_ERROR is
+ *      A standard TCL result. If the column index is invalid, TCL_ERROR is
  *      returned and an error message is left in the interpreter result.
  *      
- *      tableName column get -labels columnName ?rowName ...? 
+ *      tableName column move destColumn firstColumn lastColumn ?switches...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnGetOp(ClientData clientData, Tcl_Interp *interp, int objc,
-            Tcl_Obj *const *objv)
+ColumnMoveOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    BLT_TABLE_COLUMN col;
-    Tcl_Obj *listObjPtr;
-    const char *string;
-    int needLabels;
+    MoveSwitches switches;
+    BLT_TABLE_COLUMN destColumn, firstColumn, lastColumn;
 
-    string = Tcl_GetString(objv[3]);
-    needLabels = FALSE;
-    if (strcmp(string, "-labels") == 0) {
-        objv++, objc--;
-        needLabels = TRUE;
+    destColumn = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (destColumn == NULL) {
+        return TCL_ERROR;
     }
-    table = cmdPtr->table;
-    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
-    if (col == NULL) {
+    firstColumn = blt_table_get_column(interp, cmdPtr->table, objv[4]);
+    if (firstColumn == NULL) {
         return TCL_ERROR;
     }
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    if (objc == 4) {
-        BLT_TABLE_ROW row;
-
-        for (row = blt_table_first_row(cmdPtr->table); row != NULL;
-             row = blt_table_next_row(row)) {
-            Tcl_Obj *objPtr;
-
-            if (needLabels) {
-                objPtr = Tcl_NewStringObj(blt_table_row_label(row), -1);
-            } else {
-                objPtr = GetRowIndexObj(cmdPtr->table, row);
-            }
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-            objPtr = blt_table_get_obj(cmdPtr->table, row, col);
-            if (objPtr == NULL) {
-                objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
-            }
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-        }
-    } else {
-        BLT_TABLE_ITERATOR ri;
-        BLT_TABLE_ROW row;
+    lastColumn = blt_table_get_column(interp, cmdPtr->table, objv[5]);
+    if (lastColumn == NULL) {
+        return TCL_ERROR;
+    }
+    /* Check if range is valid. */
+    if ((blt_table_column_index(cmdPtr->table, firstColumn) > 
+         blt_table_column_index(cmdPtr->table, lastColumn))) {
+        return TCL_OK;                  /* No range. */
+    }
 
-        if (blt_table_iterate_rows_objv(interp, table, objc - 4, objv + 4, &ri) 
-            != TCL_OK) {
-            return TCL_ERROR;
-        }
-        for (row = blt_table_first_tagged_row(&ri); row != NULL; 
-             row = blt_table_next_tagged_row(&ri)) {
-            Tcl_Obj *objPtr;
-            
-            if (needLabels) {
-                objPtr = Tcl_NewStringObj(blt_table_row_label(row), -1);
-            } else {
-                objPtr = GetRowIndexObj(cmdPtr->table, row);
-            }
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-            objPtr = blt_table_get_obj(cmdPtr->table, row, col);
-            if (objPtr == NULL) {
-                objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
-            }
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-        }
-        blt_table_free_iterator_objv(&ri);
+    /* Check that destination is outside the range of columns to be moved. */
+    if ((blt_table_column_index(cmdPtr->table, destColumn) >= 
+         blt_table_column_index(cmdPtr->table, firstColumn)) &&
+        (blt_table_column_index(cmdPtr->table, destColumn) <= 
+         blt_table_column_index(cmdPtr->table, lastColumn))) {
+        Tcl_AppendResult(interp, "destination column \"", 
+                Tcl_GetString(objv[3]),
+                 "\" can't be in the range of columns to be moved.", 
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    memset(&switches, 0, sizeof(switches));
+    if (Blt_ParseSwitches(interp, moveSwitches, objc - 6, objv + 6, 
+        &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
     }
-    Tcl_SetObjResult(interp, listObjPtr);
-    return TCL_OK;
+    return blt_table_move_columns(interp, cmdPtr->table, destColumn, 
+          firstColumn, lastColumn, switches.flags & MOVE_AFTER);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnIndexOp --
+ * ColumnNamesOp --
  *
- *      Returns the column index of the given column tag, label, or index.
- *      A tag can't represent more than one column.
+ *      Reports the labels of all columns.  
  * 
  * Results:
- *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
- *
- *      tableName column index columnName
+ *      Always returns TCL_OK.  The interpreter result is a list of column
+ *      labels.
  *      
+ *      tableName column names ?pattern ...?
+ *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnIndexOp(ClientData clientData, Tcl_Interp *interp, int objc,
+ColumnNamesOp(ClientData clientData, Tcl_Interp *interp, int objc,
               Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE_ITERATOR iter;
-    long index;
+    Tcl_Obj *listObjPtr;
+    BLT_TABLE_COLUMN col;
 
-    index = -1;
-    if (blt_table_iterate_columns(interp, cmdPtr->table, objv[3], &iter)
-        == TCL_OK) {
-        BLT_TABLE_COLUMN col;
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    for (col = blt_table_first_column(cmdPtr->table); col != NULL;
+         col = blt_table_next_column(col)) {
+        const char *label;
+        int match;
+        int i;
 
-        col = blt_table_first_tagged_column(&iter);
-        if (col != NULL) {
-            BLT_TABLE_COLUMN next;
-            
-            index = blt_table_column_index(cmdPtr->table, col);
-            next = blt_table_next_tagged_column(&iter);
-            if (next != NULL) {
-                /* It's not an error to look for an index of a column that
-                 * doesn't exist. Duplicate labels are another story. This
-                 * is too subtle a problem. Better to error on
-                 * duplicates.  */
-                const char *tag;
-            
-                blt_table_column_spec(cmdPtr->table, objv[3], &tag);
-                Tcl_AppendResult(interp, "multiple columns specified by \"", 
-                                 tag, "\"", (char *)NULL);
-                return TCL_ERROR;
+        label = blt_table_column_label(col);
+        match = (objc == 3);
+        for (i = 3; i < objc; i++) {
+            char *pattern;
+
+            pattern = Tcl_GetString(objv[i]);
+            if (Tcl_StringMatch(label, pattern)) {
+                match = TRUE;
+                break;
             }
         }
+        if (match) {
+            Tcl_Obj *objPtr;
+
+            objPtr = Tcl_NewStringObj(label, -1);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
     }
-    Tcl_SetWideIntObj(Tcl_GetObjResult(interp), index);
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
+
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnIndicesOp --
+ * ColumnNonEmptyOp --
+ *
+ *      Returns a list of the rows with empty values in the given column.
  *
- *      Returns a list of indices for the given column labels.  If the
- *      column by that label doesn't exists, -1 is returned for the index.
- *      If the column label refers to multiple columns, a list of the
- *      indices is returned.
- * 
  * Results:
  *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
+ *      TCL_ERROR is returned and an error message is left in the interpreter
+ *      result.
  *
- *      tableName column indices ?label ...?
+ *      tableName column nonempty columnName
  *      
  *---------------------------------------------------------------------------
  */
 static int
-ColumnIndicesOp(ClientData clientData, Tcl_Interp *interp, int objc,
-                Tcl_Obj *const *objv)
+ColumnNonEmptyOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+                 Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
+    BLT_TABLE_COLUMN col;
+    BLT_TABLE_ROW row;
     Tcl_Obj *listObjPtr;
-    IndicesSwitches switches;
-    int i;
 
-    switches.flags = 0;
-    i = Blt_ParseSwitches(interp, indicesSwitches, objc - 3, objv + 3, 
-        &switches, BLT_SWITCH_OBJV_PARTIAL);
-    if (i < 0)  {
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
         return TCL_ERROR;
     }
-    objc -= i, objv += i;
     listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (i = 3; i < objc; i++) {
-        Blt_HashTable *tablePtr;
-        Blt_HashEntry *hPtr;
-        Blt_HashSearch iter;
-        const char *label;
-        
-        label = Tcl_GetString(objv[i]);
-        tablePtr = blt_table_column_get_label_table(cmdPtr->table, label);
-        if (tablePtr == NULL) {
-            /* Label doesn't refer to any column. */
-            Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewWideIntObj(-1));
-            continue;
-        }
-        if ((switches.flags & INDICES_DUPLICATES) &&
-            (tablePtr->numEntries == 1)) {
-            continue;                   /* Only report duplicates. */
-        }
-        if (objc == 4) {
-            /* Check if there's only one label argument.  If this case we
-             * don't want to return a list of lists for duplicate labels.*/
-            for (hPtr = Blt_FirstHashEntry(tablePtr, &iter); hPtr != NULL;
-                 hPtr = Blt_NextHashEntry(&iter)) {
-                BLT_TABLE_COLUMN col;
-                Tcl_Obj *objPtr;
-                
-                col = Blt_GetHashValue(hPtr);
-                objPtr = GetColumnIndexObj(cmdPtr->table, col);
-                Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-            }
-        } else {
-            Tcl_Obj *subListObjPtr;
-
-            subListObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-            for (hPtr = Blt_FirstHashEntry(tablePtr, &iter); hPtr != NULL;
-                 hPtr = Blt_NextHashEntry(&iter)) {
-                BLT_TABLE_COLUMN col;
-                Tcl_Obj *objPtr;
-                
-                col = Blt_GetHashValue(hPtr);
-                objPtr = GetColumnIndexObj(cmdPtr->table, col);
-                Tcl_ListObjAppendElement(interp, subListObjPtr, objPtr);
-            }
-            Tcl_ListObjAppendElement(interp, listObjPtr, subListObjPtr);
+    for (row = blt_table_first_row(cmdPtr->table); row != NULL;
+         row = blt_table_next_row(row)) {
+        if (blt_table_value_exists(cmdPtr->table, row, col))  {
+            Tcl_Obj *objPtr;
+            
+            objPtr = GetRowIndexObj(cmdPtr->table, row);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
         }
     }
     Tcl_SetObjResult(interp, listObjPtr);
@@ -3713,197 +5381,124 @@ ColumnIndicesOp(ClientData clientData, Tcl_Interp *interp, int objc,
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnCreateOp --
+ * ColumnPackedOp --
  *
- *      Creates a single new column in the table.  The location of the new
- *      column may be specified by -before or -after switches.  By default
- *      the new column is added to the end of the table.
+ *      Reports and/or sets whether columns use packed storage.  Packed
+ *      numeric columns store their values in a dense array instead of
+ *      one value structure per row.
  * 
  * Results:
- *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
+ *      A standard TCL result.  If no boolean is given, a list of the
+ *      packed states of the columns is returned.  If a column can't be
+ *      packed, TCL_ERROR is returned and an error message is left in the
  *      interpreter result.
- *
- *      tableName column create ?switches?
  *      
+ *      tableName column packed columnName ?boolean?
+ *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnCreateOp(ClientData clientData, Tcl_Interp *interp, int objc,
+ColumnPackedOp(ClientData clientData, Tcl_Interp *interp, int objc,
                Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    InsertColumnSwitches switches;
+    BLT_TABLE_ITERATOR ci;
     BLT_TABLE_COLUMN col;
+    int state;
 
-    memset(&switches, 0, sizeof(switches));
-    switches.cmdPtr = cmdPtr;
-    switches.type = TABLE_COLUMN_TYPE_STRING;
-
-    if (Blt_ParseSwitches(interp, insertColumnSwitches, objc - 3, objv + 3, 
-        &switches, 0) < 0) {
-        goto error;
-    }
-    col = blt_table_create_column(interp, cmdPtr->table, switches.label);
-    if (col == NULL) {
-        goto error;
-    }
-    if (blt_table_set_column_type(interp, cmdPtr->table, col, switches.type)
+    if (blt_table_iterate_columns(interp, cmdPtr->table, objv[3], &ci) 
         != TCL_OK) {
-        goto error;
-    }
-    if (switches.destColumn != NULL) {
-        if (blt_table_move_columns(interp, cmdPtr->table, switches.destColumn, 
-                col, col, switches.flags & INSERT_AFTER) != TCL_OK) {
-            goto error;
-        }
-    }
-    if (switches.tags != NULL) {
-        Tcl_Obj **elv;
-        int elc;
-        int i;
-
-        if (Tcl_ListObjGetElements(interp, switches.tags, &elc, &elv) 
-            != TCL_OK) {
-            goto error;
-        }
-        for (i = 0; i < elc; i++) {
-            if (blt_table_set_column_tag(interp, cmdPtr->table, col, 
-                        Tcl_GetString(elv[i])) != TCL_OK) {
-                goto error;
-            }
-        }
+        return TCL_ERROR;
     }
-    Tcl_SetObjResult(interp, GetColumnIndexObj(cmdPtr->table, col));
-    Blt_FreeSwitches(insertColumnSwitches, &switches, 0);
-    return TCL_OK;
- error:
-    Blt_FreeSwitches(insertColumnSwitches, &switches, 0);
-    return TCL_ERROR;
-}
-
-/*
- *---------------------------------------------------------------------------
- *
- * ColumnLabelOp --
- *
- *      Gets/sets one or more column labels.  
- * 
- * Results:
- *      A standard TCL result.  If successful, the old column label is
- *      returned in the interpreter result.  If the column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the interpreter
- *      result.
- *      
- *      tableName column label columnName ?label columnName label ...? 
- *
- *---------------------------------------------------------------------------
- */
-static int
-ColumnLabelOp(ClientData clientData, Tcl_Interp *interp, int objc,
-              Tcl_Obj *const *objv)
-{
-    Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-
-    table = cmdPtr->table;
     if (objc == 4) {
-        const char *label;
-        BLT_TABLE_COLUMN col;
+        Tcl_Obj *listObjPtr;
 
-        col = blt_table_get_column(interp, table, objv[3]);
-        if (col == NULL) {
-            return TCL_ERROR;
-        }
-        label = blt_table_column_label(col);
-        Tcl_SetStringObj(Tcl_GetObjResult(interp), label, -1);
-    }  else {
-        int i;
-        
-        if ((objc - 3) & 1) {
-            Tcl_AppendResult(interp,"odd # of column/label pairs: should be \"",
-                Tcl_GetString(objv[0]), " column label ?column label?...", 
-                             (char *)NULL);
-            return TCL_ERROR;
-        }
-        for (i = 3; i < objc; i += 2) {
-            BLT_TABLE_COLUMN col;
-            const char *label;
+        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+             col = blt_table_next_tagged_column(&ci)) {
+            Tcl_Obj *objPtr;
 
-            col = blt_table_get_column(interp, table, objv[i]);
-            if (col == NULL) {
-                return TCL_ERROR;
-            }
-            label = Tcl_GetString(objv[i+1]);
-            if (label[0] == '\0') {
-                continue;               /* Don't set empty labels. */
-            }
-            if (blt_table_set_column_label(interp, table, col, label) != TCL_OK) {
+            objPtr = Tcl_NewBooleanObj(blt_table_column_is_packed(col));
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
+        Tcl_SetObjResult(interp, listObjPtr);
+        return TCL_OK;
+    }
+    if (Tcl_GetBooleanFromObj(interp, objv[4], &state) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+         col = blt_table_next_tagged_column(&ci)) {
+        if (state) {
+            if (blt_table_pack_column(interp, cmdPtr->table, col) != TCL_OK) {
                 return TCL_ERROR;
             }
+        } else if (blt_table_unpack_column(interp, cmdPtr->table, col) 
+                   != TCL_OK) {
+            return TCL_ERROR;
         }
     }
     return TCL_OK;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnLabelsOp --
+ * ColumnSetOp --
  *
- *      Gets/sets all the column labels in the table.  
+ *      Sets one of values in a column.  One or more columns may be set
+ *      using a tag.  The row order is always the table's current view of
+ *      the table.  There may be less values than needed.
  * 
  * Results:
- *      A standard TCL result.  If successful, a list of values is returned
- *      in the interpreter result.
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
  *      
- *      tableName column labels ?labelList? 
+ *      tableName column set columnName ?rowName value ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnLabelsOp(ClientData clientData, Tcl_Interp *interp, int objc,
-               Tcl_Obj *const *objv)
+ColumnSetOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
+    BLT_TABLE_ITERATOR ci;
+    BLT_TABLE_COLUMN col;
     BLT_TABLE table;
 
     table = cmdPtr->table;
-    if (objc == 3) {
-        BLT_TABLE_COLUMN col;
-        Tcl_Obj *listObjPtr;
-
-        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-        for (col = blt_table_first_column(cmdPtr->table); col != NULL;
-             col = blt_table_next_column(col)) {
-            const char *label;
-            Tcl_Obj *objPtr;
-            
-            label = blt_table_column_label(col);
-            objPtr = Tcl_NewStringObj(label, -1);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-        }
-        Tcl_SetObjResult(interp, listObjPtr);
-    } else {
-        Tcl_Obj **elv;
-        int elc, n;
+    /* May set more than one row with the same values. */
+    if (IterateColumnsWithCreate(interp, table, objv[3], &ci) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (objc == 4) {
+        return TCL_OK;
+    }
+    if ((objc - 4) & 1) {
+        Tcl_AppendResult(interp, "odd # of row/value pairs: should be \"", 
+                Tcl_GetString(objv[0]), " column assign col row value...", 
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+         col = blt_table_next_tagged_column(&ci)) {
         int i;
 
-        if (Tcl_ListObjGetElements(interp, objv[3], &elc, &elv) != TCL_OK) {
-            return TCL_ERROR;
-        }
-        n = MIN(elc, blt_table_num_columns(table));
-        for (i = 0; i < n; i++) {
-            BLT_TABLE_COLUMN col;
-            const char *label;
+        /* The remaining arguments are index/value pairs. */
+        for (i = 4; i < objc; i += 2) {
+            BLT_TABLE_ROW row;
 
-            col = blt_table_column(table, i);
-            label = Tcl_GetString(elv[i]);
-            if (label[0] == '\0') {
-                continue;
+            row = blt_table_get_row(interp, table, objv[i]);
+            if (row == NULL) {
+                /* Can't find the row. Create it and try to find it again. */
+                if (MakeRows(interp, table, objv[i]) != TCL_OK) {
+                    return TCL_ERROR;
+                }
+                row = blt_table_get_row(interp, table, objv[i]);
             }
-            if (blt_table_set_column_label(interp, table, col, label)
+            if (blt_table_set_obj(interp, table, row, col, objv[i + 1])
                 != TCL_OK) {
                 return TCL_ERROR;
             }
@@ -3912,1700 +5507,2017 @@ ColumnLabelsOp(ClientData clientData, Tcl_Interp *interp, int objc,
     return TCL_OK;
 }
 
+
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnMoveOp --
+ * ColumnStatsOp --
  *
- *      Moves the given number of columns to another location in the table.
- * 
- * Results:
- *      A standard TCL result. If the column index is invalid, TCL_ERROR is
- *      returned and an error message is left in the interpreter result.
- *      
- *      tableName column move destColumn firstColumn lastColumn ?switches...?
+ *      Returns the statistics of a column as a list of name-value pairs:
+ *      the # of values and empty values, the estimated # of distinct
+ *      values, the minimum and maximum values, and for numeric columns
+ *      the sum.  The statistics are cached by the table, so asking again
+ *      before the column changes doesn't rescan it.
+ *
+ *      tableName column stats columnName
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnMoveOp(ClientData clientData, Tcl_Interp *interp, int objc,
-             Tcl_Obj *const *objv)
+ColumnStatsOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    MoveSwitches switches;
-    BLT_TABLE_COLUMN destColumn, firstColumn, lastColumn;
+    BLT_TABLE_COLUMN col;
+    BLT_TABLE_COLUMN_STATS stats;
+    Tcl_Obj *listObjPtr;
 
-    destColumn = blt_table_get_column(interp, cmdPtr->table, objv[3]);
-    if (destColumn == NULL) {
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
         return TCL_ERROR;
     }
-    firstColumn = blt_table_get_column(interp, cmdPtr->table, objv[4]);
-    if (firstColumn == NULL) {
+    if (blt_table_get_column_stats(interp, cmdPtr->table, col, &stats) 
+        != TCL_OK) {
         return TCL_ERROR;
     }
-    lastColumn = blt_table_get_column(interp, cmdPtr->table, objv[5]);
-    if (lastColumn == NULL) {
-        return TCL_ERROR;
+    if (stats.minObjPtr == NULL) {      /* Column has no values. */
+        stats.minObjPtr = Tcl_NewStringObj("", 0);
+        stats.maxObjPtr = Tcl_NewStringObj("", 0);
     }
-    /* Check if range is valid. */
-    if ((blt_table_column_index(cmdPtr->table, firstColumn) > 
-         blt_table_column_index(cmdPtr->table, lastColumn))) {
-        return TCL_OK;                  /* No range. */
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj("count", 5));
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+                             Tcl_NewLongObj(stats.numValues));
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj("empty", 5));
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+                             Tcl_NewLongObj(stats.numEmpty));
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+                             Tcl_NewStringObj("distinct", 8));
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+                             Tcl_NewLongObj(stats.numDistinct));
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj("min", 3));
+    Tcl_ListObjAppendElement(interp, listObjPtr, stats.minObjPtr);
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj("max", 3));
+    Tcl_ListObjAppendElement(interp, listObjPtr, stats.maxObjPtr);
+    if (stats.isNumeric) {
+        Tcl_ListObjAppendElement(interp, listObjPtr, 
+                                 Tcl_NewStringObj("sum", 3));
+        Tcl_ListObjAppendElement(interp, listObjPtr, 
+                                 Tcl_NewDoubleObj(stats.sum));
     }
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
+}
 
-    /* Check that destination is outside the range of columns to be moved. */
-    if ((blt_table_column_index(cmdPtr->table, destColumn) >= 
-         blt_table_column_index(cmdPtr->table, firstColumn)) &&
-        (blt_table_column_index(cmdPtr->table, destColumn) <= 
-         blt_table_column_index(cmdPtr->table, lastColumn))) {
-        Tcl_AppendResult(interp, "destination column \"", 
-                Tcl_GetString(objv[3]),
-                 "\" can't be in the range of columns to be moved.", 
-                (char *)NULL);
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnTagAddOp --
+ *
+ *      Adds a given tag to one or more columns.  Tag names can't start
+ *      with a digit (to distinquish them from node ids) and can't be a
+ *      reserved tag ("all", "add", or "end").
+ *
+ *      tableName column tag add tagName ?columnName ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ColumnTagAddOp(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE table;
+    int i;
+    const char *tag;
+
+    table = cmdPtr->table;
+    tag = Tcl_GetString(objv[4]);
+    if (blt_table_set_column_tag(interp, table, NULL, tag) != TCL_OK) {
         return TCL_ERROR;
     }
-    memset(&switches, 0, sizeof(switches));
-    if (Blt_ParseSwitches(interp, moveSwitches, objc - 6, objv + 6, 
-        &switches, BLT_SWITCH_DEFAULTS) < 0) {
-        return TCL_ERROR;
+    for (i = 5; i < objc; i++) {
+        BLT_TABLE_COLUMN col;
+        BLT_TABLE_ITERATOR ci;
+
+        if (blt_table_iterate_columns(interp, table, objv[i], &ci) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+             col = blt_table_next_tagged_column(&ci)) {
+            if (blt_table_set_column_tag(interp, table, col, tag) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }    
     }
-    return blt_table_move_columns(interp, cmdPtr->table, destColumn, 
-          firstColumn, lastColumn, switches.flags & MOVE_AFTER);
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnNamesOp --
+ * ColumnTagDeleteOp --
  *
- *      Reports the labels of all columns.  
- * 
- * Results:
- *      Always returns TCL_OK.  The interpreter result is a list of column
- *      labels.
- *      
- *      tableName column names ?pattern ...?
+ *      Removes a given tag from one or more columns. If a tag doesn't exist or
+ *      is a reserved tag ("all" or "end"), nothing will be done and no error
+ *      message will be returned.
+ *
+ *      tableName column tag delete tagName ?column...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnNamesOp(ClientData clientData, Tcl_Interp *interp, int objc,
-              Tcl_Obj *const *objv)
+ColumnTagDeleteOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+                  Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    Tcl_Obj *listObjPtr;
+    BLT_TABLE table;
+    BLT_TABLE_ITERATOR ci;
     BLT_TABLE_COLUMN col;
+    const char *tag;
+    
+    table = cmdPtr->table;
+    tag = Tcl_GetString(objv[4]);
+    if (blt_table_iterate_columns_objv(interp, table, objc - 5, objv + 5, &ci)
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
+    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+         col = blt_table_next_tagged_column(&ci)) {
+        if (blt_table_unset_column_tag(interp, table, col, tag) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
 
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (col = blt_table_first_column(cmdPtr->table); col != NULL;
-         col = blt_table_next_column(col)) {
-        const char *label;
-        int match;
-        int i;
-
-        label = blt_table_column_label(col);
-        match = (objc == 3);
-        for (i = 3; i < objc; i++) {
-            char *pattern;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnTagExistsOp --
+ *
+ *      Returns the existence of a tag in the table.  If a column is 
+ *      specified then the tag is search for for that column.
+ *
+ *      tableName tag column exists tagName ?columnName ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+ColumnTagExistsOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+                  Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    int bool;
+    const char *tag;
+    BLT_TABLE table;
 
-            pattern = Tcl_GetString(objv[i]);
-            if (Tcl_StringMatch(label, pattern)) {
-                match = TRUE;
-                break;
-            }
-        }
-        if (match) {
-            Tcl_Obj *objPtr;
+    tag = Tcl_GetString(objv[4]);
+    table = cmdPtr->table;
+    bool = (blt_table_get_tagged_columns(table, tag) != NULL);
+    if ((bool) && (objc == 6)) {
+        BLT_TABLE_COLUMN col;
 
-            objPtr = Tcl_NewStringObj(label, -1);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        col = blt_table_get_column(interp, table, objv[5]);
+        if (col == NULL) {
+            bool = FALSE;
+        } else {
+            bool = blt_table_column_has_tag(table, col, tag);
         }
-    }
-    Tcl_SetObjResult(interp, listObjPtr);
+    } 
+    Tcl_SetBooleanObj(Tcl_GetObjResult(interp), bool);
     return TCL_OK;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnNonEmptyOp --
+ * ColumnTagForgetOp --
  *
- *      Returns a list of the rows with empty values in the given column.
+ *      Removes the given tags from all nodes.
  *
- * Results:
- *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the interpreter
- *      result.
+ *      tableName column tag forget ?tagName ...?
  *
- *      tableName column nonempty columnName
- *      
  *---------------------------------------------------------------------------
  */
+/*ARGSUSED*/
 static int
-ColumnNonEmptyOp(ClientData clientData, Tcl_Interp *interp, int objc, 
-                 Tcl_Obj *const *objv)
+ColumnTagForgetOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+                  Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE_COLUMN col;
-    BLT_TABLE_ROW row;
-    Tcl_Obj *listObjPtr;
+    int i;
 
-    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
-    if (col == NULL) {
-        return TCL_ERROR;
-    }
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (row = blt_table_first_row(cmdPtr->table); row != NULL;
-         row = blt_table_next_row(row)) {
-        if (blt_table_value_exists(cmdPtr->table, row, col))  {
-            Tcl_Obj *objPtr;
-            
-            objPtr = GetRowIndexObj(cmdPtr->table, row);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+    for (i = 4; i < objc; i++) {
+        if (blt_table_forget_column_tag(interp, cmdPtr->table, 
+                Tcl_GetString(objv[i])) != TCL_OK) {
+            return TCL_ERROR;
         }
     }
-    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnSetOp --
+ * ColumnTagGetOp --
  *
- *      Sets one of values in a column.  One or more columns may be set
- *      using a tag.  The row order is always the table's current view of
- *      the table.  There may be less values than needed.
- * 
- * Results:
- *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
- *      
- *      tableName column set columnName ?rowName value ...?
+ *      Returns the tag names for a given column.  If one of more pattern
+ *      arguments are provided, then only those matching tags are returned.
+ *
+ *      tableName column tag get columnName ?pattern ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnSetOp(ClientData clientData, Tcl_Interp *interp, int objc,
-            Tcl_Obj *const *objv)
+ColumnTagGetOp(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE_ITERATOR ci;
-    BLT_TABLE_COLUMN col;
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch hsearch;
+    Blt_HashTable tagTable;
     BLT_TABLE table;
-
+    BLT_TABLE_COLUMN col;
+    BLT_TABLE_ITERATOR ci;
+    Tcl_Obj *listObjPtr;
+    int isNew;
+    size_t lastIndex;
+    
     table = cmdPtr->table;
-    /* May set more than one row with the same values. */
-    if (IterateColumnsWithCreate(interp, table, objv[3], &ci) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    if (objc == 4) {
-        return TCL_OK;
-    }
-    if ((objc - 4) & 1) {
-        Tcl_AppendResult(interp, "odd # of row/value pairs: should be \"", 
-                Tcl_GetString(objv[0]), " column assign col row value...", 
-                (char *)NULL);
+    if (blt_table_iterate_columns(interp, table, objv[4], &ci) != TCL_OK) {
         return TCL_ERROR;
     }
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+
+    Blt_InitHashTable(&tagTable, BLT_STRING_KEYS);
+    Blt_CreateHashEntry(&tagTable, "all", &isNew);
+    
+    /* Collect all the tags into a hash table. */
+    lastIndex = blt_table_num_columns(table) - 1;
     for (col = blt_table_first_tagged_column(&ci); col != NULL; 
          col = blt_table_next_tagged_column(&ci)) {
-        int i;
+        Blt_Chain chain;
+        Blt_ChainLink link;
+        int isNew;
+        
+        if (blt_table_column_index(table, col) == lastIndex) {
+            Blt_CreateHashEntry(&tagTable, "end", &isNew);
+        }
+        chain = blt_table_get_column_tags(table, col);
+        for (link = Blt_Chain_FirstLink(chain); link != NULL;
+             link = Blt_Chain_NextLink(link)) {
+            const char *tag;
 
-        /* The remaining arguments are index/value pairs. */
-        for (i = 4; i < objc; i += 2) {
-            BLT_TABLE_ROW row;
+            tag = Blt_Chain_GetValue(link);
+            Blt_CreateHashEntry(&tagTable, tag, &isNew);
+        }
+        Blt_Chain_Destroy(chain);
+    }
+    for (hPtr = Blt_FirstHashEntry(&tagTable, &hsearch); hPtr != NULL;
+         hPtr = Blt_NextHashEntry(&hsearch)) {
+        int match;
+        const char *tag;
 
-            row = blt_table_get_row(interp, table, objv[i]);
-            if (row == NULL) {
-                /* Can't find the row. Create it and try to find it again. */
-                if (MakeRows(interp, table, objv[i]) != TCL_OK) {
-                    return TCL_ERROR;
+        tag = Blt_GetHashKey(&tagTable, hPtr);
+        match = TRUE;
+        if (objc > 5) {
+            int i;
+
+            match = FALSE;
+            for (i = 5; i < objc; i++) {
+                if (Tcl_StringMatch(tag, Tcl_GetString(objv[i]))) {
+                    match = TRUE;
                 }
-                row = blt_table_get_row(interp, table, objv[i]);
-            }
-            if (blt_table_set_obj(interp, table, row, col, objv[i + 1])
-                != TCL_OK) {
-                return TCL_ERROR;
             }
         }
+        if (match) {
+            Tcl_Obj *objPtr;
+
+            objPtr = Tcl_NewStringObj(tag, -1);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
     }
+    Blt_DeleteHashTable(&tagTable);
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
 
+static unsigned char *
+GetColumnTagMatches(Tcl_Interp *interp, BLT_TABLE table, int objc, 
+                    Tcl_Obj *const *objv)
+{
+    size_t numCols;
+    int i;
+    unsigned char *matches;
+
+    numCols = blt_table_num_columns(table);
+    matches = Blt_AssertCalloc(numCols, sizeof(unsigned char));
+    /* Handle the reserved tags "all" or "end". */
+    for (i = 0; i < objc; i++) {
+        const char *tag;
+
+        tag = Tcl_GetString(objv[i]);
+        if (strcmp("all", tag) == 0) {
+            size_t j;
+
+            for (j = 0; j < numCols; j++) {
+                matches[j] = TRUE;
+            }
+            return matches;             /* Don't care about other tags. */
+        } 
+        if (strcmp("end", tag) == 0) {
+            matches[numCols - 1] = TRUE;
+        }
+    }
+    /* Now check user-defined tags. */
+    for (i = 0; i < objc; i++) {
+        Blt_Chain chain;
+        Blt_ChainLink link;
+        const char *tag;
+        
+        tag = Tcl_GetString(objv[i]);
+        if ((strcmp("all", tag) == 0) || (strcmp("end", tag) == 0)) {
+            continue;
+        }
+        chain = blt_table_get_tagged_columns(table, tag);
+        if (chain == NULL) {
+            Blt_Free(matches);
+            return NULL;
+        }
+        for (link = Blt_Chain_FirstLink(chain); link != NULL; 
+             link = Blt_Chain_NextLink(link)) {
+            BLT_TABLE_COLUMN col;
+            size_t j;
+
+            col = Blt_Chain_GetValue(link);
+            j = blt_table_column_index(table, col);
+            matches[j] = TRUE;
+        }
+    }
+    return matches;
+}
+
+
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagAddOp --
+ * ColumnTagIndicesOp --
  *
- *      Adds a given tag to one or more columns.  Tag names can't start
- *      with a digit (to distinquish them from node ids) and can't be a
- *      reserved tag ("all", "add", or "end").
+ *      Returns column indices names for the given tags.  If one of more tag
+ *      names are provided, then only those matching indices are returned.
  *
- *      tableName column tag add tagName ?columnName ...?
+ *      tableName column tag indices ?tagName ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnTagAddOp(ClientData clientData, Tcl_Interp *interp, int objc,
-               Tcl_Obj *const *objv)
+ColumnTagIndicesOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+                   Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    int i;
-    const char *tag;
+    Tcl_Obj *listObjPtr;
+    unsigned char *matches;
 
-    table = cmdPtr->table;
-    tag = Tcl_GetString(objv[4]);
-    if (blt_table_set_column_tag(interp, table, NULL, tag) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    for (i = 5; i < objc; i++) {
-        BLT_TABLE_COLUMN col;
-        BLT_TABLE_ITERATOR ci;
+    matches = GetColumnTagMatches(interp, cmdPtr->table, objc - 4, objv + 4);
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    if (matches != NULL) {
+        size_t i;
 
-        if (blt_table_iterate_columns(interp, table, objv[i], &ci) != TCL_OK) {
-            return TCL_ERROR;
-        }
-        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-             col = blt_table_next_tagged_column(&ci)) {
-            if (blt_table_set_column_tag(interp, table, col, tag) != TCL_OK) {
-                return TCL_ERROR;
+        for (i = 0; i < blt_table_num_columns(cmdPtr->table); i++) {
+            if (matches[i]) {
+                Tcl_ListObjAppendElement(interp, listObjPtr,
+                                         Tcl_NewWideIntObj(i));
             }
-        }    
+        }
+        Blt_Free(matches);
     }
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagDeleteOp --
+ * ColumnTagLabelsOp --
  *
- *      Removes a given tag from one or more columns. If a tag doesn't exist or
- *      is a reserved tag ("all" or "end"), nothing will be done and no error
- *      message will be returned.
+ *      Returns column labels for the given tags.  If one of more tag
+ *      names are provided, then only those matching indices are returned.
  *
- *      tableName column tag delete tagName ?column...?
+ *      tableName column tag labels ?tagName ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnTagDeleteOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+ColumnTagLabelsOp(ClientData clientData, Tcl_Interp *interp, int objc, 
                   Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    BLT_TABLE_ITERATOR ci;
-    BLT_TABLE_COLUMN col;
-    const char *tag;
-    
-    table = cmdPtr->table;
-    tag = Tcl_GetString(objv[4]);
-    if (blt_table_iterate_columns_objv(interp, table, objc - 5, objv + 5, &ci)
-        != TCL_OK) {
-        return TCL_ERROR;
-    }
-    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-         col = blt_table_next_tagged_column(&ci)) {
-        if (blt_table_unset_column_tag(interp, table, col, tag) != TCL_OK) {
-            return TCL_ERROR;
+    Tcl_Obj *listObjPtr;
+    unsigned char *matches;
+
+    matches = GetColumnTagMatches(interp, cmdPtr->table, objc - 4, objv + 4);
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    if (matches != NULL) {
+        size_t j;
+
+        for (j = 0; j < blt_table_num_columns(cmdPtr->table); j++) {
+            if (matches[j]) {
+                BLT_TABLE_COLUMN col;
+                Tcl_Obj *objPtr;
+                
+                col = blt_table_column(cmdPtr->table, j);
+                objPtr = Tcl_NewStringObj(blt_table_column_label(col), -1);
+                Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+            }
         }
+        Blt_Free(matches);
     }
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
+
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagExistsOp --
+ * ColumnTagRangeOp --
  *
- *      Returns the existence of a tag in the table.  If a column is 
- *      specified then the tag is search for for that column.
+ *      Adds one or more tags for a given column.  Tag names can't start
+ *      with a digit (to distinquish them from node ids) and can't be a
+ *      reserved tag ("all" or "end").
  *
- *      tableName tag column exists tagName ?columnName ...?
+ *      tableName column tag range fromColumn toColumn ?tagName ...?
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 static int
-ColumnTagExistsOp(ClientData clientData, Tcl_Interp *interp, int objc, 
-                  Tcl_Obj *const *objv)
+ColumnTagRangeOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+                 Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    int bool;
-    const char *tag;
     BLT_TABLE table;
+    BLT_TABLE_COLUMN from, to;
+    int i;
 
-    tag = Tcl_GetString(objv[4]);
     table = cmdPtr->table;
-    bool = (blt_table_get_tagged_columns(table, tag) != NULL);
-    if ((bool) && (objc == 6)) {
-        BLT_TABLE_COLUMN col;
+    from = blt_table_get_column(interp, table, objv[4]);
+    if (from == NULL) {
+        return TCL_ERROR;
+    }
+    to = blt_table_get_column(interp, table, objv[5]);
+    if (to == NULL) {
+        return TCL_ERROR;
+    }
+    if (blt_table_column_index(table, from) > blt_table_column_index(table, to)) {
+        return TCL_OK;
+    }
+    for (i = 6; i < objc; i++) {
+        const char *tag;
+        size_t j;
+        
+        tag = Tcl_GetString(objv[i]);
+        for (j = blt_table_column_index(table, from);
+             j <= blt_table_column_index(table, to); j++) {
+            BLT_TABLE_COLUMN col;
 
-        col = blt_table_get_column(interp, table, objv[5]);
-        if (col == NULL) {
-            bool = FALSE;
-        } else {
-            bool = blt_table_column_has_tag(table, col, tag);
-        }
-    } 
-    Tcl_SetBooleanObj(Tcl_GetObjResult(interp), bool);
+            col = blt_table_column(table, j);
+            if (blt_table_set_column_tag(interp, table, col, tag) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }    
+    }
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagForgetOp --
+ * ColumnTagNamesOp --
  *
- *      Removes the given tags from all nodes.
+ *      Returns a list of all the column tags.  One of more tag pattern
+ *      arguments can be given.
  *
- *      tableName column tag forget ?tagName ...?
+ *      tableName column tag names ?pattern ...?
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 static int
-ColumnTagForgetOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+ColumnTagNamesOp(ClientData clientData, Tcl_Interp *interp, int objc, 
                   Tcl_Obj *const *objv)
 {
+    Blt_HashTable *tablePtr;
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
     Cmd *cmdPtr = clientData;
+    Tcl_Obj *listObjPtr;
+    int allMatch, endMatch;
     int i;
+    
+    tablePtr = blt_table_get_column_tag_table(cmdPtr->table);
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+    for (hPtr = Blt_FirstHashEntry(tablePtr, &iter); hPtr != NULL;
+         hPtr = Blt_NextHashEntry(&iter)) {
+        const char *tag;
+        int i;
+        int match;
+        
+        tag = Blt_GetHashKey(tablePtr, hPtr);
+        match = (objc == 4);
+        for (i = 4; i < objc; i++) {
+            const char *pattern;
+
+            pattern = Tcl_GetString(objv[i]);
+            if (Tcl_StringMatch(tag, pattern)) {
+                match = TRUE;
+                break;                  /* Found match. */
+            }
+        }
+        if (match) {
+            Tcl_Obj *objPtr;
 
+            objPtr = Tcl_NewStringObj(tag, -1);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
+    }
+    allMatch = endMatch = (objc == 4);
     for (i = 4; i < objc; i++) {
-        if (blt_table_forget_column_tag(interp, cmdPtr->table, 
-                Tcl_GetString(objv[i])) != TCL_OK) {
-            return TCL_ERROR;
+        const char *pattern;
+
+        pattern = Tcl_GetString(objv[i]);
+        if (Tcl_StringMatch("all", pattern)) {
+           allMatch = TRUE;
         }
+        if (Tcl_StringMatch("end", pattern)) {
+           endMatch = TRUE;
+        }
+    }
+    if (allMatch) {
+        Tcl_Obj *objPtr;
+
+        objPtr = Tcl_NewStringObj("all", 3);
+        Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+    }
+    if (endMatch) {
+        Tcl_Obj *objPtr;
+
+        objPtr = Tcl_NewStringObj("end", 3);
+        Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
     }
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagGetOp --
+ * ColumnTagSetOp --
  *
- *      Returns the tag names for a given column.  If one of more pattern
- *      arguments are provided, then only those matching tags are returned.
+ *      Adds one or more tags for a given column.  Tag names can't start with a
+ *      digit (to distinquish them from node ids) and can't be a reserved tag
+ *      ("all" or "end").
  *
- *      tableName column tag get columnName ?pattern ...?
+ *      tableName column tag set columnName ?tagName ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnTagGetOp(ClientData clientData, Tcl_Interp *interp, int objc,
+ColumnTagSetOp(ClientData clientData, Tcl_Interp *interp, int objc,
                Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    Blt_HashEntry *hPtr;
-    Blt_HashSearch hsearch;
-    Blt_HashTable tagTable;
     BLT_TABLE table;
-    BLT_TABLE_COLUMN col;
     BLT_TABLE_ITERATOR ci;
-    Tcl_Obj *listObjPtr;
-    int isNew;
-    size_t lastIndex;
-    
+    int i;
+
     table = cmdPtr->table;
     if (blt_table_iterate_columns(interp, table, objv[4], &ci) != TCL_OK) {
         return TCL_ERROR;
     }
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-
-    Blt_InitHashTable(&tagTable, BLT_STRING_KEYS);
-    Blt_CreateHashEntry(&tagTable, "all", &isNew);
-    
-    /* Collect all the tags into a hash table. */
-    lastIndex = blt_table_num_columns(table) - 1;
-    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-         col = blt_table_next_tagged_column(&ci)) {
-        Blt_Chain chain;
-        Blt_ChainLink link;
-        int isNew;
-        
-        if (blt_table_column_index(table, col) == lastIndex) {
-            Blt_CreateHashEntry(&tagTable, "end", &isNew);
-        }
-        chain = blt_table_get_column_tags(table, col);
-        for (link = Blt_Chain_FirstLink(chain); link != NULL;
-             link = Blt_Chain_NextLink(link)) {
-            const char *tag;
-
-            tag = Blt_Chain_GetValue(link);
-            Blt_CreateHashEntry(&tagTable, tag, &isNew);
-        }
-        Blt_Chain_Destroy(chain);
-    }
-    for (hPtr = Blt_FirstHashEntry(&tagTable, &hsearch); hPtr != NULL;
-         hPtr = Blt_NextHashEntry(&hsearch)) {
-        int match;
+    for (i = 5; i < objc; i++) {
         const char *tag;
+        BLT_TABLE_COLUMN col;
 
-        tag = Blt_GetHashKey(&tagTable, hPtr);
-        match = TRUE;
-        if (objc > 5) {
-            int i;
-
-            match = FALSE;
-            for (i = 5; i < objc; i++) {
-                if (Tcl_StringMatch(tag, Tcl_GetString(objv[i]))) {
-                    match = TRUE;
-                }
-            }
-        }
-        if (match) {
-            Tcl_Obj *objPtr;
-
-            objPtr = Tcl_NewStringObj(tag, -1);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-        }
+        tag = Tcl_GetString(objv[i]);
+        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+             col = blt_table_next_tagged_column(&ci)) {
+            if (blt_table_set_column_tag(interp, table, col, tag) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }    
     }
-    Blt_DeleteHashTable(&tagTable);
-    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
 
-static unsigned char *
-GetColumnTagMatches(Tcl_Interp *interp, BLT_TABLE table, int objc, 
-                    Tcl_Obj *const *objv)
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ColumnTagUnsetOp --
+ *
+ *      Removes one or more tags from a given column. If a tag doesn't exist or
+ *      is a reserved tag ("all" or "end"), nothing will be done and no error
+ *      message will be returned.
+ *
+ *      tableName column tag unset columnName ?tagName ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ColumnTagUnsetOp(ClientData clientData, Tcl_Interp *interp, int objc, 
+                 Tcl_Obj *const *objv)
 {
-    size_t numCols;
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE table;
+    BLT_TABLE_ITERATOR ci;
     int i;
-    unsigned char *matches;
-
-    numCols = blt_table_num_columns(table);
-    matches = Blt_AssertCalloc(numCols, sizeof(unsigned char));
-    /* Handle the reserved tags "all" or "end". */
-    for (i = 0; i < objc; i++) {
-        const char *tag;
-
-        tag = Tcl_GetString(objv[i]);
-        if (strcmp("all", tag) == 0) {
-            size_t j;
 
-            for (j = 0; j < numCols; j++) {
-                matches[j] = TRUE;
-            }
-            return matches;             /* Don't care about other tags. */
-        } 
-        if (strcmp("end", tag) == 0) {
-            matches[numCols - 1] = TRUE;
-        }
+    table = cmdPtr->table;
+    if (blt_table_iterate_columns(interp, table, objv[4], &ci) != TCL_OK) {
+        return TCL_ERROR;
     }
-    /* Now check user-defined tags. */
-    for (i = 0; i < objc; i++) {
-        Blt_Chain chain;
-        Blt_ChainLink link;
+    for (i = 5; i < objc; i++) {
         const char *tag;
+        BLT_TABLE_COLUMN col;
         
         tag = Tcl_GetString(objv[i]);
-        if ((strcmp("all", tag) == 0) || (strcmp("end", tag) == 0)) {
-            continue;
-        }
-        chain = blt_table_get_tagged_columns(table, tag);
-        if (chain == NULL) {
-            Blt_Free(matches);
-            return NULL;
-        }
-        for (link = Blt_Chain_FirstLink(chain); link != NULL; 
-             link = Blt_Chain_NextLink(link)) {
-            BLT_TABLE_COLUMN col;
-            size_t j;
-
-            col = Blt_Chain_GetValue(link);
-            j = blt_table_column_index(table, col);
-            matches[j] = TRUE;
+        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+             col = blt_table_next_tagged_column(&ci)) {
+            if (blt_table_unset_column_tag(interp, table, col, tag) != TCL_OK) {
+                return TCL_ERROR;
+            }
         }
-    }
-    return matches;
+    }    
+    return TCL_OK;
 }
 
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagIndicesOp --
+ * ColumnTagOp --
  *
- *      Returns column indices names for the given tags.  If one of more tag
- *      names are provided, then only those matching indices are returned.
+ *      This procedure is invoked to process tag operations.
  *
- *      tableName column tag indices ?tagName ...?
+ * Results:
+ *      A standard TCL result.
+ *
+ * Side Effects:
+ *      See the user documentation.
  *
  *---------------------------------------------------------------------------
  */
+static Blt_OpSpec columnTagOps[] =
+{
+    {"add",     1, ColumnTagAddOp,     5, 0, "tagName ?columnName ...?",},
+    {"delete",  1, ColumnTagDeleteOp,  5, 0, "tagName ?columnName ...?",},
+    {"exists",  1, ColumnTagExistsOp,  4, 5, "tagName ?columnName?",},
+    {"forget",  1, ColumnTagForgetOp,  4, 0, "?tagName ...?",},
+    {"get",     1, ColumnTagGetOp,     5, 0, "columnName ?pattern ...?",},
+    {"indices", 1, ColumnTagIndicesOp, 4, 0, "?tagName ...?",},
+    {"labels",  1, ColumnTagLabelsOp,  4, 0, "?tagName ...?",},
+    {"names",   1, ColumnTagNamesOp,   4, 0, "?pattern ...?",},
+    {"range",   1, ColumnTagRangeOp,   6, 0, "from to ?tagName ...?",},
+    {"set",     1, ColumnTagSetOp,     5, 0, "columnName ?tagName ...?",},
+    {"unset",   1, ColumnTagUnsetOp,   5, 0, "columnName ?tagName ...?",},
+
+};
+
+static int numColumnTagOps = sizeof(columnTagOps) / sizeof(Blt_OpSpec);
+
 static int
-ColumnTagIndicesOp(ClientData clientData, Tcl_Interp *interp, int objc, 
-                   Tcl_Obj *const *objv)
+ColumnTagOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
 {
-    Cmd *cmdPtr = clientData;
-    Tcl_Obj *listObjPtr;
-    unsigned char *matches;
+    Tcl_ObjCmdProc *proc;
 
-    matches = GetColumnTagMatches(interp, cmdPtr->table, objc - 4, objv + 4);
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    if (matches != NULL) {
-        size_t i;
+    int result;
 
-        for (i = 0; i < blt_table_num_columns(cmdPtr->table); i++) {
-            if (matches[i]) {
-                Tcl_ListObjAppendElement(interp, listObjPtr,
-                                         Tcl_NewWideIntObj(i));
-            }
-        }
-        Blt_Free(matches);
+    proc = Blt_GetOpFromObj(interp, numColumnTagOps, columnTagOps, BLT_OP_ARG3,
+        objc, objv, 0);
+    if (proc == NULL) {
+        return TCL_ERROR;
     }
-    Tcl_SetObjResult(interp, listObjPtr);
-    return TCL_OK;
+    result = (*proc)(clientData, interp, objc, objv);
+    return result;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagLabelsOp --
- *
- *      Returns column labels for the given tags.  If one of more tag
- *      names are provided, then only those matching indices are returned.
+ * ColumnTypeOp --
  *
- *      tableName column tag labels ?tagName ...?
+ *      Reports and/or sets the type of a column.  
+ * 
+ * Results:
+ *      A standard TCL result.  If successful, the old column label is
+ *      returned in the interpreter result.  If the column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the interpreter
+ *      result.
+ *      
+ *      tableName column type columnName
+ *      tableName column type columnName ?typeName columnName typeName ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnTagLabelsOp(ClientData clientData, Tcl_Interp *interp, int objc, 
-                  Tcl_Obj *const *objv)
+ColumnTypeOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    Tcl_Obj *listObjPtr;
-    unsigned char *matches;
+    BLT_TABLE table;
+    int i;
+    
+    table = cmdPtr->table;
+    if (objc == 4) {
+        BLT_TABLE_ITERATOR ci;
+        BLT_TABLE_COLUMN col;
+        Tcl_Obj *listObjPtr;
 
-    matches = GetColumnTagMatches(interp, cmdPtr->table, objc - 4, objv + 4);
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    if (matches != NULL) {
-        size_t j;
+        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        if (blt_table_iterate_columns(interp, table, objv[3], &ci) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+             col = blt_table_next_tagged_column(&ci)) {
+            Tcl_Obj *objPtr;
+            BLT_TABLE_COLUMN_TYPE type;
+            
+            type = blt_table_column_type(col);
+            objPtr = Tcl_NewStringObj(blt_table_column_type_to_name(type), -1);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
+        Tcl_SetObjResult(interp, listObjPtr);
+        return TCL_OK;
+    }
+    objc -= 3;
+    objv += 3;
+    if (objc & 0x1) {
+        Tcl_AppendResult(interp, "odd # of arguments: should ?index type?...", 
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    for (i = 0; i < objc; i += 2) {
+        BLT_TABLE_ITERATOR ci;
+        BLT_TABLE_COLUMN col;
+        BLT_TABLE_COLUMN_TYPE newType;
 
-        for (j = 0; j < blt_table_num_columns(cmdPtr->table); j++) {
-            if (matches[j]) {
-                BLT_TABLE_COLUMN col;
-                Tcl_Obj *objPtr;
-                
-                col = blt_table_column(cmdPtr->table, j);
-                objPtr = Tcl_NewStringObj(blt_table_column_label(col), -1);
-                Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        if (blt_table_iterate_columns(interp, table, objv[i], &ci) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        newType = blt_table_name_to_column_type(Tcl_GetString(objv[i+1]));
+        if (newType == TABLE_COLUMN_TYPE_UNKNOWN) {
+            Tcl_AppendResult(interp, "unknown column type \"", 
+                             Tcl_GetString(objv[i+1]), "\"", (char *)NULL);
+            return TCL_ERROR;
+        }
+        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+             col = blt_table_next_tagged_column(&ci)) {
+            BLT_TABLE_COLUMN_TYPE type;
+
+            type = blt_table_column_type(col);
+            if (newType != type) {
+                if (blt_table_set_column_type(interp, table, col, newType)
+                    != TCL_OK) {
+                    return TCL_ERROR;
+                }
             }
         }
-        Blt_Free(matches);
     }
-    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagRangeOp --
- *
- *      Adds one or more tags for a given column.  Tag names can't start
- *      with a digit (to distinquish them from node ids) and can't be a
- *      reserved tag ("all" or "end").
+ * ColumnUnsetOp --
  *
- *      tableName column tag range fromColumn toColumn ?tagName ...?
+ *      Unsets one or more columns of values.  One or more columns may be
+ *      unset (using tags or multiple arguments). It's an error if the
+ *      column doesn't exist.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
+ *      
+ *      tableName column unset columnName ?indices ...?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnTagRangeOp(ClientData clientData, Tcl_Interp *interp, int objc, 
-                 Tcl_Obj *const *objv)
+ColumnUnsetOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
     BLT_TABLE table;
-    BLT_TABLE_COLUMN from, to;
-    int i;
+    BLT_TABLE_ITERATOR ri, ci;
+    BLT_TABLE_COLUMN col;
+    int result;
 
     table = cmdPtr->table;
-    from = blt_table_get_column(interp, table, objv[4]);
-    if (from == NULL) {
+    if (blt_table_iterate_columns(interp, table, objv[3], &ci) != TCL_OK) {
         return TCL_ERROR;
     }
-    to = blt_table_get_column(interp, table, objv[5]);
-    if (to == NULL) {
+    if (blt_table_iterate_rows_objv(interp, table, objc - 4, objv + 4 , &ri) 
+        != TCL_OK) {
         return TCL_ERROR;
     }
-    if (blt_table_column_index(table, from) > blt_table_column_index(table, to)) {
-        return TCL_OK;
-    }
-    for (i = 6; i < objc; i++) {
-        const char *tag;
-        size_t j;
-        
-        tag = Tcl_GetString(objv[i]);
-        for (j = blt_table_column_index(table, from);
-             j <= blt_table_column_index(table, to); j++) {
-            BLT_TABLE_COLUMN col;
+    result = TCL_ERROR;
+    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
+         col = blt_table_next_tagged_column(&ci)) {
+        BLT_TABLE_ROW row;
 
-            col = blt_table_column(table, j);
-            if (blt_table_set_column_tag(interp, table, col, tag) != TCL_OK) {
-                return TCL_ERROR;
+        for (row = blt_table_first_tagged_row(&ri); row != NULL;
+             row = blt_table_next_tagged_row(&ri)) {
+            if (blt_table_unset_value(table, row, col) != TCL_OK) {
+                goto error;
             }
-        }    
+        }
     }
-    return TCL_OK;
+    result = TCL_OK;
+ error:
+    blt_table_free_iterator_objv(&ri);
+    return result;
 }
 
+
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagNamesOp --
- *
- *      Returns a list of all the column tags.  One of more tag pattern
- *      arguments can be given.
+ * ColumnValuesOp --
  *
- *      tableName column tag names ?pattern ...?
+ *      Retrieves a column of values.  The column argument can be either a
+ *      tag, label, or column index.  If it is a tag, it must refer to
+ *      exactly one column.
+ * 
+ * Results:
+ *      A standard TCL result.  If successful, a list of values is returned
+ *      in the interpreter result.  If the column index is invalid,
+ *      TCL_ERROR is returned and an error message is left in the
+ *      interpreter result.
+ *      
+ *      tableName column values columnName ?valueList?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnTagNamesOp(ClientData clientData, Tcl_Interp *interp, int objc, 
-                  Tcl_Obj *const *objv)
+ColumnValuesOp(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
 {
-    Blt_HashTable *tablePtr;
-    Blt_HashEntry *hPtr;
-    Blt_HashSearch iter;
     Cmd *cmdPtr = clientData;
-    Tcl_Obj *listObjPtr;
-    int allMatch, endMatch;
-    int i;
-    
-    tablePtr = blt_table_get_column_tag_table(cmdPtr->table);
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-    for (hPtr = Blt_FirstHashEntry(tablePtr, &iter); hPtr != NULL;
-         hPtr = Blt_NextHashEntry(&iter)) {
-        const char *tag;
-        int i;
-        int match;
-        
-        tag = Blt_GetHashKey(tablePtr, hPtr);
-        match = (objc == 4);
-        for (i = 4; i < objc; i++) {
-            const char *pattern;
+    BLT_TABLE table;
+    BLT_TABLE_COLUMN col;
 
-            pattern = Tcl_GetString(objv[i]);
-            if (Tcl_StringMatch(tag, pattern)) {
-                match = TRUE;
-                break;                  /* Found match. */
-            }
-        }
-        if (match) {
-            Tcl_Obj *objPtr;
+    table = cmdPtr->table;
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        return TCL_ERROR;
+    }
+    if (objc == 4) {
+        BLT_TABLE_ROW row;
+        Tcl_Obj *listObjPtr;
 
-            objPtr = Tcl_NewStringObj(tag, -1);
+        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        for (row = blt_table_first_row(cmdPtr->table); row != NULL;
+             row = blt_table_next_row(row)) {
+            Tcl_Obj *objPtr;
+            
+            objPtr = blt_table_get_obj(cmdPtr->table, row, col);
+            if (objPtr == NULL) {
+                objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
+            }
             Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
         }
-    }
-    allMatch = endMatch = (objc == 4);
-    for (i = 4; i < objc; i++) {
-        const char *pattern;
+        Tcl_SetObjResult(interp, listObjPtr);
+    } else {
+        Tcl_Obj **elv;
+        int elc;
+        size_t i;
+        BLT_TABLE_ROW row;
 
-        pattern = Tcl_GetString(objv[i]);
-        if (Tcl_StringMatch("all", pattern)) {
-           allMatch = TRUE;
-        }
-        if (Tcl_StringMatch("end", pattern)) {
-           endMatch = TRUE;
+        if (Tcl_ListObjGetElements(interp, objv[4], &elc, &elv) != TCL_OK) {
+            return TCL_ERROR;
         }
-    }
-    if (allMatch) {
-        Tcl_Obj *objPtr;
+        if (elc > blt_table_num_rows(table)) {
+            size_t needed;
 
-        objPtr = Tcl_NewStringObj("all", 3);
-        Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-    }
-    if (endMatch) {
-        Tcl_Obj *objPtr;
+            needed = elc - blt_table_num_rows(table);
+            if (blt_table_extend_rows(interp, table, needed, NULL)
+                != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+        for (i = 0, row = blt_table_first_row(cmdPtr->table); i < elc; 
+             i++, row = blt_table_next_row(row)) {
 
-        objPtr = Tcl_NewStringObj("end", 3);
-        Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+            if (blt_table_set_obj(interp, table, row, col, elv[i]) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
     }
-    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagSetOp --
- *
- *      Adds one or more tags for a given column.  Tag names can't start with a
- *      digit (to distinquish them from node ids) and can't be a reserved tag
- *      ("all" or "end").
+ * ColumnOp --
  *
- *      tableName column tag set columnName ?tagName ...?
+ *      Parses the given command line and calls one of several
+ *      column-specific operations.
+ *      
+ * Results:
+ *      Returns a standard TCL result.  It is the result of operation
+ *      called.
  *
  *---------------------------------------------------------------------------
  */
+static Blt_OpSpec columnOps[] =
+{
+    {"bind",      1, ColumnBindOp,    4, 5, "columnName ?vecName?",},
+    {"copy",      2, ColumnCopyOp,    4, 0, "destColumn srcColumn ?switches?",},
+    {"create",    2, ColumnCreateOp,  3, 0, "?switches?",},
+    {"delete",    2, ColumnDeleteOp,  3, 0, "?columnName ...?",},
+    {"duplicate", 2, ColumnDupOp,     3, 0, "?columnName ...?",},
+    {"empty",     3, ColumnEmptyOp,   4, 4, "columnName",},
+    {"encoded",   2, ColumnEncodedOp, 4, 5, "columnName ?boolean?",},
+    {"exists",    3, ColumnExistsOp,  4, 4, "columnName",},
+    {"extend",    3, ColumnExtendOp,  4, 0, "numColumns ?switches?",},
+    {"get",       1, ColumnGetOp,     4, 0, "columnName ?switches?",},
+    {"index",     4, ColumnIndexOp,   4, 4, "columnName",},
+    {"indices",   4, ColumnIndicesOp, 3, 0, "?pattern ...?",},
+    {"join",      1, ColumnJoinOp,    4, 0, "tableName ?switches?",},
+    {"label",     5, ColumnLabelOp,   4, 0, "columnName ?label?",},
+    {"labels",    6, ColumnLabelsOp,  3, 4, "?labelList?",},
+    {"move",      1, ColumnMoveOp,    6, 0, "destColumn firstColumn lastColumn ?switches?"},
+    {"names",     2, ColumnNamesOp,   3, 0, "?pattern ...?",},
+    {"nonempty",  3, ColumnNonEmptyOp,4, 4, "columnName",},
+    {"packed",    1, ColumnPackedOp,  4, 5, "columnName ?boolean?",},
+    {"set",       2, ColumnSetOp,     5, 0, "columnName rowName ?value ...?",},
+    {"stats",     2, ColumnStatsOp,   4, 4, "columnName",},
+    {"tag",       2, ColumnTagOp,     3, 0, "op args...",},
+    {"type",      2, ColumnTypeOp,    4, 0, "columnName ?typeName columnName typeName ...?",},
+    {"unset",     1, ColumnUnsetOp,   4, 0, "columnName ?indices ...?",},
+    {"values",    1, ColumnValuesOp,  4, 5, "columnName ?valueList?",},
+};
+
+static int numColumnOps = sizeof(columnOps) / sizeof(Blt_OpSpec);
+
 static int
-ColumnTagSetOp(ClientData clientData, Tcl_Interp *interp, int objc,
-               Tcl_Obj *const *objv)
+ColumnOp(ClientData clientData, Tcl_Interp *interp, int objc,
+         Tcl_Obj *const *objv)
 {
-    Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    BLT_TABLE_ITERATOR ci;
-    int i;
+    Tcl_ObjCmdProc *proc;
+    int result;
 
-    table = cmdPtr->table;
-    if (blt_table_iterate_columns(interp, table, objv[4], &ci) != TCL_OK) {
+    proc = Blt_GetOpFromObj(interp, numColumnOps, columnOps, BLT_OP_ARG2, objc, 
+        objv, 0);
+    if (proc == NULL) {
         return TCL_ERROR;
     }
-    for (i = 5; i < objc; i++) {
-        const char *tag;
-        BLT_TABLE_COLUMN col;
-
-        tag = Tcl_GetString(objv[i]);
-        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-             col = blt_table_next_tagged_column(&ci)) {
-            if (blt_table_set_column_tag(interp, table, col, tag) != TCL_OK) {
-                return TCL_ERROR;
-            }
-        }    
-    }
-    return TCL_OK;
+    result = (*proc)(clientData, interp, objc, objv);
+    return result;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagUnsetOp --
+ * CopyOp --
  *
- *      Removes one or more tags from a given column. If a tag doesn't exist or
- *      is a reserved tag ("all" or "end"), nothing will be done and no error
- *      message will be returned.
+ *      Copies the rows and columns from the source table given.  Any data 
+ *      in the table is first deleted.
  *
- *      tableName column tag unset columnName ?tagName ...?
+ *      tableName copy srcTableName
  *
  *---------------------------------------------------------------------------
  */
+/*ARGSUSED*/
 static int
-ColumnTagUnsetOp(ClientData clientData, Tcl_Interp *interp, int objc, 
-                 Tcl_Obj *const *objv)
+CopyOp(ClientData clientData, Tcl_Interp *interp, int objc,
+       Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    BLT_TABLE_ITERATOR ci;
-    int i;
+    BLT_TABLE srcTable;
+    int result;
 
-    table = cmdPtr->table;
-    if (blt_table_iterate_columns(interp, table, objv[4], &ci) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    for (i = 5; i < objc; i++) {
-        const char *tag;
-        BLT_TABLE_COLUMN col;
-        
-        tag = Tcl_GetString(objv[i]);
-        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-             col = blt_table_next_tagged_column(&ci)) {
-            if (blt_table_unset_column_tag(interp, table, col, tag) != TCL_OK) {
-                return TCL_ERROR;
-            }
-        }
-    }    
-    return TCL_OK;
+    if (blt_table_open(interp, Tcl_GetString(objv[2]), &srcTable) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    result = CopyTable(interp, srcTable, cmdPtr->table);
+    blt_table_close(srcTable);
+    return result;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTagOp --
- *
- *      This procedure is invoked to process tag operations.
- *
- * Results:
- *      A standard TCL result.
+ * DirOp --
  *
- * Side Effects:
- *      See the user documentation.
+ *      tableName dir dirPath ?switches ...?
  *
  *---------------------------------------------------------------------------
  */
-static Blt_OpSpec columnTagOps[] =
-{
-    {"add",     1, ColumnTagAddOp,     5, 0, "tagName ?columnName ...?",},
-    {"delete",  1, ColumnTagDeleteOp,  5, 0, "tagName ?columnName ...?",},
-    {"exists",  1, ColumnTagExistsOp,  4, 5, "tagName ?columnName?",},
-    {"forget",  1, ColumnTagForgetOp,  4, 0, "?tagName ...?",},
-    {"get",     1, ColumnTagGetOp,     5, 0, "columnName ?pattern ...?",},
-    {"indices", 1, ColumnTagIndicesOp, 4, 0, "?tagName ...?",},
-    {"labels",  1, ColumnTagLabelsOp,  4, 0, "?tagName ...?",},
-    {"names",   1, ColumnTagNamesOp,   4, 0, "?pattern ...?",},
-    {"range",   1, ColumnTagRangeOp,   6, 0, "from to ?tagName ...?",},
-    {"set",     1, ColumnTagSetOp,     5, 0, "columnName ?tagName ...?",},
-    {"unset",   1, ColumnTagUnsetOp,   5, 0, "columnName ?tagName ...?",},
-
-};
-
-static int numColumnTagOps = sizeof(columnTagOps) / sizeof(Blt_OpSpec);
-
+/*ARGSUSED*/
 static int
-ColumnTagOp(ClientData clientData, Tcl_Interp *interp, int objc,
-            Tcl_Obj *const *objv)
+DirOp(ClientData clientData, Tcl_Interp *interp, int objc,
+      Tcl_Obj *const *objv)
 {
-    Tcl_ObjCmdProc *proc;
-
-    int result;
+    Cmd *cmdPtr = clientData;
+    ReadDirectory reader;
+    Tcl_Obj **patterns, **entries, *listObjPtr;
+    Tcl_StatBuf stat;
+    int i, numPatterns, numEntries;
+    unsigned int patternFlags;
+    Tcl_GlobTypeData data = {
+        0, TCL_GLOB_PERM_R, /* macType*/NULL, /*macCreator*/NULL
+    };
 
-    proc = Blt_GetOpFromObj(interp, numColumnTagOps, columnTagOps, BLT_OP_ARG3,
-        objc, objv, 0);
-    if (proc == NULL) {
+    memset(&reader, 0, sizeof(reader));
+    reader.mask = READ_DIR_DEFAULT;
+    if (Blt_ParseSwitches(interp, dirSwitches, objc - 3, objv + 3, &reader,
+        BLT_SWITCH_DEFAULTS) < 0) {
         return TCL_ERROR;
     }
-    result = (*proc)(clientData, interp, objc, objv);
-    return result;
+    data.type = reader.type;
+    data.perm = reader.perm;
+    numPatterns = 0;
+    if (reader.patternsObjPtr != NULL) {
+        if (Tcl_ListObjGetElements(interp, reader.patternsObjPtr, 
+                &numPatterns, &patterns) != TCL_OK) {
+            return TCL_ERROR;           /* Can't split patterns. */
+        }
+    }
+    patternFlags = 0;
+#if (_TCL_VERSION > _VERSION(8,5,0)) 
+    if (reader.flags & READ_DIR_NOCASE) {
+        patternFlags =  TCL_MATCH_NOCASE;
+    }
+#endif
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    if (Tcl_FSStat(objv[2], &stat) != 0) {
+        Tcl_AppendResult(interp, "Can't stat directory \"",
+                         Tcl_GetString(objv[2]), "\": ",
+                         Tcl_PosixError(interp), (char *)NULL);
+        goto error;
+    }
+    if (!S_ISDIR(stat.st_mode)) {
+        Tcl_AppendResult(interp, "\"", Tcl_GetString(objv[2]),
+                         "\" is not a directory", (char *)NULL);
+        goto error;
+    }
+    if (Tcl_FSMatchInDirectory(interp, listObjPtr, objv[2], "*", &data)
+        != TCL_OK) {
+        Tcl_AppendResult(interp, "Can't read directory \"",
+                         Tcl_GetString(objv[2]), "\": ",
+                         Tcl_PosixError(interp), (char *)NULL);
+        goto error;
+    }
+    if (Tcl_ListObjGetElements(interp, listObjPtr, &numEntries, &entries)
+        != TCL_OK) {
+        goto error;
+    }
+    for (i = 0; i < numEntries; i++) {
+        Tcl_Obj *partsObjPtr, *tailObjPtr;
+        Tcl_StatBuf stat;
+        const char *label;
+        int isMatch, numParts;
+
+        if (Tcl_FSConvertToPathType(interp, entries[i]) != TCL_OK) {
+           goto error;                 /* Can't convert path. */
+        }
+        memset(&stat, 0, sizeof(Tcl_StatBuf));
+        if (Tcl_FSStat(entries[i], &stat) < 0) {
+            continue;                   /* Can't stat entry. */
+        }
+        /* Get the tail of the path. */
+        partsObjPtr = Tcl_FSSplitPath(entries[i], &numParts);
+        if ((partsObjPtr == NULL) || (numParts == 0)) {
+            goto error;                 /* Can't split path. */
+        }
+        Tcl_IncrRefCount(partsObjPtr);
+        Tcl_ListObjIndex(NULL, partsObjPtr, numParts - 1, &tailObjPtr);
+        label = Tcl_GetString(tailObjPtr);
+
+        if (label[0] == '.') {
+            if (label[1] == '\0') {
+                Tcl_DecrRefCount(partsObjPtr);
+                continue;               /* Ignore . */
+            }
+            if ((label[1] == '.') && (label[2] == '\0')) {
+                Tcl_DecrRefCount(partsObjPtr);
+                continue;               /* Ignore .. */
+            }
+            /* Workaround bug in Tcl_FSSplitPath. Files that start with "~"
+             * are prepended with "./" */
+            if (label[1] == '/') {
+                label += 2;
+            }
+        }
+        isMatch = TRUE;
+        if (numPatterns > 0) {          /* Match files or subdirectories
+                                         * against patterns. */
+            int j;
+            
+            isMatch = FALSE;
+            for (j = 0; j < numPatterns; j++) {
+                const char *pattern;
+                
+                pattern = Tcl_GetString(patterns[j]);
+                if (Tcl_StringCaseMatch(label, pattern, patternFlags)) {
+                    isMatch = TRUE;
+                    break;              /* Found a match. */
+                }
+            }
+        }
+        if (isMatch) {
+            ExportToTable(interp, cmdPtr->table, label, &stat, &reader);
+        }
+        Tcl_DecrRefCount(partsObjPtr);
+    }
+    Tcl_DecrRefCount(listObjPtr);
+    return TCL_OK;
+ error:
+    Tcl_DecrRefCount(listObjPtr);
+    return TCL_ERROR;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnTypeOp --
+ * DumpOp --
  *
- *      Reports and/or sets the type of a column.  
- * 
- * Results:
- *      A standard TCL result.  If successful, the old column label is
- *      returned in the interpreter result.  If the column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the interpreter
- *      result.
- *      
- *      tableName column type columnName
- *      tableName column type columnName ?typeName columnName typeName ...?
+ *      tableName dump ?switches?
  *
  *---------------------------------------------------------------------------
  */
+/*ARGSUSED*/
 static int
-ColumnTypeOp(ClientData clientData, Tcl_Interp *interp, int objc,
-             Tcl_Obj *const *objv)
+DumpOp(ClientData clientData, Tcl_Interp *interp, int objc,
+       Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
     BLT_TABLE table;
-    int i;
-    
+    DumpSwitches switches;
+    int result;
+    Tcl_DString ds;
+    int closeChannel;
+    Tcl_Channel channel;
+
+    closeChannel = FALSE;
+    channel = NULL;
     table = cmdPtr->table;
-    if (objc == 4) {
-        BLT_TABLE_ITERATOR ci;
-        BLT_TABLE_COLUMN col;
-        Tcl_Obj *listObjPtr;
+    result = TCL_ERROR;
+    memset(&switches, 0, sizeof(switches));
+    switches.channel = channel;
+    switches.dsPtr = &ds;
+    rowIterSwitch.clientData = cmdPtr->table;
+    columnIterSwitch.clientData = cmdPtr->table;
+    blt_table_iterate_all_rows(table, &switches.ri);
+    blt_table_iterate_all_columns(table, &switches.ci);
 
-        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-        if (blt_table_iterate_columns(interp, table, objv[3], &ci) != TCL_OK) {
-            return TCL_ERROR;
+    if (Blt_ParseSwitches(interp, dumpSwitches, objc - 2, objv + 2, &switches, 
+        BLT_SWITCH_DEFAULTS) < 0) {
+        goto done;
+    }
+    if (switches.flags & DUMP_BINARY) {
+        const char *fileName;
+
+        fileName = (switches.fileObjPtr == NULL) ? "" :
+            Tcl_GetString(switches.fileObjPtr);
+        if ((fileName[0] == '\0') || 
+            ((fileName[0] == '@') && (fileName[1] != '\0'))) {
+            Tcl_AppendResult(interp, 
+                "-binary requires the -file switch with a file name", 
+                (char *)NULL);
+            goto done;
         }
-        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-             col = blt_table_next_tagged_column(&ci)) {
-            Tcl_Obj *objPtr;
-            BLT_TABLE_COLUMN_TYPE type;
+        result = blt_table_file_dump_binary(interp, table, fileName, 
+                &switches.ri, &switches.ci);
+        goto done;
+    }
+    if (switches.fileObjPtr != NULL) {
+        const char *fileName;
+
+        fileName = Tcl_GetString(switches.fileObjPtr);
+
+        closeChannel = TRUE;
+        if ((fileName[0] == '@') && (fileName[1] != '\0')) {
+            int mode;
             
-            type = blt_table_column_type(col);
-            objPtr = Tcl_NewStringObj(blt_table_column_type_to_name(type), -1);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+            channel = Tcl_GetChannel(interp, fileName+1, &mode);
+            if (channel == NULL) {
+                goto done;
+            }
+            if ((mode & TCL_WRITABLE) == 0) {
+                Tcl_AppendResult(interp, "can't dump table: channel \"", 
+                        fileName, "\" not opened for writing", (char *)NULL);
+                goto done;
+            }
+            closeChannel = FALSE;
+        } else {
+            channel = Tcl_OpenFileChannel(interp, fileName, "w", 0666);
+            if (channel == NULL) {
+                goto done;
+            }
         }
-        Tcl_SetObjResult(interp, listObjPtr);
-        return TCL_OK;
+        switches.channel = channel;
     }
-    objc -= 3;
-    objv += 3;
-    if (objc & 0x1) {
-        Tcl_AppendResult(interp, "odd # of arguments: should ?index type?...", 
-                (char *)NULL);
-        return TCL_ERROR;
+    Tcl_DStringInit(&ds);
+    result = DumpTable(table, &switches);
+    if ((switches.channel == NULL) && (result == TCL_OK)) {
+        Tcl_DStringResult(interp, &ds);
+    }
+    Tcl_DStringFree(&ds);
+ done:
+    if (closeChannel) {
+        Tcl_Close(interp, channel);
     }
-    for (i = 0; i < objc; i += 2) {
-        BLT_TABLE_ITERATOR ci;
-        BLT_TABLE_COLUMN col;
-        BLT_TABLE_COLUMN_TYPE newType;
+    Blt_FreeSwitches(dumpSwitches, &switches, 0);
+    return result;
+}
 
-        if (blt_table_iterate_columns(interp, table, objv[i], &ci) != TCL_OK) {
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DupOp --
+ *
+ *      Duplicates the rows and columns from the source table given into
+ *      a new table.  
+ *
+ *      tableName dup ?destTableName?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+DuplicateOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    if (objc == 3) {
+        BLT_TABLE srcTable;
+        int result;
+
+        if (blt_table_open(interp, Tcl_GetString(objv[2]), &srcTable) 
+            != TCL_OK) {
             return TCL_ERROR;
         }
-        newType = blt_table_name_to_column_type(Tcl_GetString(objv[i+1]));
-        if (newType == TABLE_COLUMN_TYPE_UNKNOWN) {
-            Tcl_AppendResult(interp, "unknown column type \"", 
-                             Tcl_GetString(objv[i+1]), "\"", (char *)NULL);
-            return TCL_ERROR;
+        result = CopyTable(interp, srcTable, cmdPtr->table);
+        blt_table_close(srcTable);
+        return result;
+    } else {
+        Tcl_DString ds;
+        const char *instName;
+        BLT_TABLE destTable;
+
+        Tcl_DStringInit(&ds);
+        instName = GenerateName(interp, "", "", &ds);
+        if (instName == NULL) {
+            goto error;
         }
-        for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-             col = blt_table_next_tagged_column(&ci)) {
-            BLT_TABLE_COLUMN_TYPE type;
+        if (blt_table_create(interp, instName, &destTable) == TCL_OK) {
+            int result;
 
-            type = blt_table_column_type(col);
-            if (newType != type) {
-                if (blt_table_set_column_type(interp, table, col, newType)
-                    != TCL_OK) {
-                    return TCL_ERROR;
-                }
+            NewTableCmd(interp, destTable, instName);
+            result = CopyTable(interp, cmdPtr->table, destTable);
+            if (result != TCL_ERROR) {
+                Tcl_SetStringObj(Tcl_GetObjResult(interp), instName, -1);
             }
+            Tcl_DStringFree(&ds);
+            return result;
         }
+    error:
+        Tcl_DStringFree(&ds);
+        return TCL_ERROR;
     }
-    return TCL_OK;
+    return TCL_ERROR;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnUnsetOp --
+ * EmptyValueOp --
  *
- *      Unsets one or more columns of values.  One or more columns may be
- *      unset (using tags or multiple arguments). It's an error if the
- *      column doesn't exist.
- * 
- * Results:
- *      A standard TCL result. If the tag or column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
- *      
- *      tableName column unset columnName ?indices ...?
+ *      tableName emptyvalue ?value?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnUnsetOp(ClientData clientData, Tcl_Interp *interp, int objc,
-              Tcl_Obj *const *objv)
+EmptyValueOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    BLT_TABLE_ITERATOR ri, ci;
-    BLT_TABLE_COLUMN col;
-    int result;
-
-    table = cmdPtr->table;
-    if (blt_table_iterate_columns(interp, table, objv[3], &ci) != TCL_OK) {
-        return TCL_ERROR;
-    }
-    if (blt_table_iterate_rows_objv(interp, table, objc - 4, objv + 4 , &ri) 
-        != TCL_OK) {
-        return TCL_ERROR;
-    }
-    result = TCL_ERROR;
-    for (col = blt_table_first_tagged_column(&ci); col != NULL; 
-         col = blt_table_next_tagged_column(&ci)) {
-        BLT_TABLE_ROW row;
-
-        for (row = blt_table_first_tagged_row(&ri); row != NULL;
-             row = blt_table_next_tagged_row(&ri)) {
-            if (blt_table_unset_value(table, row, col) != TCL_OK) {
-                goto error;
-            }
+    Tcl_SetStringObj(Tcl_GetObjResult(interp), cmdPtr->emptyString, -1);
+    if (objc == 3) {
+        if (cmdPtr->emptyString != NULL) {
+            Blt_Free(cmdPtr->emptyString);
+            cmdPtr->emptyString = Blt_AssertStrdup(Tcl_GetString(objv[2]));
         }
     }
-    result = TCL_OK;
- error:
-    blt_table_free_iterator_objv(&ri);
-    return result;
+    return TCL_OK;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnValuesOp --
+ * ExistsOp --
  *
- *      Retrieves a column of values.  The column argument can be either a
- *      tag, label, or column index.  If it is a tag, it must refer to
- *      exactly one column.
- * 
- * Results:
- *      A standard TCL result.  If successful, a list of values is returned
- *      in the interpreter result.  If the column index is invalid,
- *      TCL_ERROR is returned and an error message is left in the
- *      interpreter result.
- *      
- *      tableName column values columnName ?valueList?
+ *      tableName exists rowName columnName
  *
  *---------------------------------------------------------------------------
  */
 static int
-ColumnValuesOp(ClientData clientData, Tcl_Interp *interp, int objc,
-               Tcl_Obj *const *objv)
+ExistsOp(ClientData clientData, Tcl_Interp *interp, int objc,
+         Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
+    int bool;
+    BLT_TABLE_ROW row;
     BLT_TABLE_COLUMN col;
 
-    table = cmdPtr->table;
-    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
-    if (col == NULL) {
-        return TCL_ERROR;
-    }
-    if (objc == 4) {
-        BLT_TABLE_ROW row;
-        Tcl_Obj *listObjPtr;
-
-        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-        for (row = blt_table_first_row(cmdPtr->table); row != NULL;
-             row = blt_table_next_row(row)) {
-            Tcl_Obj *objPtr;
-            
-            objPtr = blt_table_get_obj(cmdPtr->table, row, col);
-            if (objPtr == NULL) {
-                objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
-            }
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-        }
-        Tcl_SetObjResult(interp, listObjPtr);
-    } else {
-        Tcl_Obj **elv;
-        int elc;
-        size_t i;
-        BLT_TABLE_ROW row;
-
-        if (Tcl_ListObjGetElements(interp, objv[4], &elc, &elv) != TCL_OK) {
-            return TCL_ERROR;
-        }
-        if (elc > blt_table_num_rows(table)) {
-            size_t needed;
-
-            needed = elc - blt_table_num_rows(table);
-            if (blt_table_extend_rows(interp, table, needed, NULL)
-                != TCL_OK) {
-                return TCL_ERROR;
-            }
-        }
-        for (i = 0, row = blt_table_first_row(cmdPtr->table); i < elc; 
-             i++, row = blt_table_next_row(row)) {
-
-            if (blt_table_set_obj(interp, table, row, col, elv[i]) != TCL_OK) {
-                return TCL_ERROR;
-            }
-        }
+    bool = FALSE;
+    row = blt_table_get_row(NULL, cmdPtr->table, objv[2]);
+    col = blt_table_get_column(NULL, cmdPtr->table, objv[3]);
+    if ((row != NULL) && (col != NULL)) {
+        bool = blt_table_value_exists(cmdPtr->table, row, col);
     }
+    Tcl_SetBooleanObj(Tcl_GetObjResult(interp), bool);
     return TCL_OK;
 }
-
 /*
  *---------------------------------------------------------------------------
  *
- * ColumnOp --
+ * ExportOp --
  *
- *      Parses the given command line and calls one of several
- *      column-specific operations.
+ *      Parses the given command line and calls one of several export-specific
+ *      operations.
  *      
  * Results:
- *      Returns a standard TCL result.  It is the result of operation
- *      called.
+ *      Returns a standard TCL result.  It is the result of operation called.
  *
  *---------------------------------------------------------------------------
  */
-static Blt_OpSpec columnOps[] =
-{
-    {"copy",      2, ColumnCopyOp,    4, 0, "destColumn srcColumn ?switches?",},
-    {"create",    2, ColumnCreateOp,  3, 0, "?switches?",},
-    {"delete",    2, ColumnDeleteOp,  3, 0, "?columnName ...?",},
-    {"duplicate", 2, ColumnDupOp,     3, 0, "?columnName ...?",},
-    {"empty",     3, ColumnEmptyOp,   4, 4, "columnName",},
-    {"exists",    3, ColumnExistsOp,  4, 4, "columnName",},
-    {"extend",    3, ColumnExtendOp,  4, 0, "numColumns ?switches?",},
-    {"get",       1, ColumnGetOp,     4, 0, "columnName ?switches?",},
-    {"index",     4, ColumnIndexOp,   4, 4, "columnName",},
-    {"indices",   4, ColumnIndicesOp, 3, 0, "?pattern ...?",},
-    {"join",      1, ColumnJoinOp,    4, 0, "tableName ?switches?",},
-    {"label",     5, ColumnLabelOp,   4, 0, "columnName ?label?",},
-    {"labels",    6, ColumnLabelsOp,  3, 4, "?labelList?",},
-    {"move",      1, ColumnMoveOp,    6, 0, "destColumn firstColumn lastColumn ?switches?"},
-    {"names",     2, ColumnNamesOp,   3, 0, "?pattern ...?",},
-    {"nonempty",  3, ColumnNonEmptyOp,4, 4, "columnName",},
-    {"set",       1, ColumnSetOp,     5, 0, "columnName rowName ?value ...?",},
-    {"tag",       2, ColumnTagOp,     3, 0, "op args...",},
-    {"type",      2, ColumnTypeOp,    4, 0, "columnName ?typeName columnName typeName ...?",},
-    {"unset",     1, ColumnUnsetOp,   4, 0, "columnName ?indices ...?",},
-    {"values",    1, ColumnValuesOp,  4, 5, "columnName ?valueList?",},
-};
-
-static int numColumnOps = sizeof(columnOps) / sizeof(Blt_OpSpec);
-
 static int
-ColumnOp(ClientData clientData, Tcl_Interp *interp, int objc,
+ExportOp(ClientData clientData, Tcl_Interp *interp, int objc,
          Tcl_Obj *const *objv)
 {
-    Tcl_ObjCmdProc *proc;
-    int result;
+    Cmd *cmdPtr = clientData;
+    Blt_HashEntry *hPtr;
+    DataFormat *fmtPtr;
+    TableCmdInterpData *dataPtr;
+    const char *fmt;
 
-    proc = Blt_GetOpFromObj(interp, numColumnOps, columnOps, BLT_OP_ARG2, objc, 
-        objv, 0);
-    if (proc == NULL) {
+    dataPtr = GetTableCmdInterpData(interp);
+    if (objc == 2) {
+        Blt_HashSearch iter;
+
+        for (hPtr = Blt_FirstHashEntry(&dataPtr->fmtTable, &iter); 
+             hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+            fmtPtr = Blt_GetHashValue(hPtr);
+            if (fmtPtr->exportProc != NULL) {
+                Tcl_AppendElement(interp, fmtPtr->name);
+            }
+        }
+        return TCL_OK;
+    }
+    fmt = Tcl_GetString(objv[2]);
+    hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
+    if (hPtr == NULL) {
+        LoadFormat(interp, fmt);
+        hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
+        if (hPtr == NULL) {
+            Tcl_AppendResult(interp, "can't export \"", Tcl_GetString(objv[2]),
+                         "\": format not registered", (char *)NULL);
+            return TCL_ERROR;
+        }
+    }
+    fmtPtr = Blt_GetHashValue(hPtr);
+    if ((fmtPtr->flags & FMT_LOADED) == 0) {
+        LoadFormat(interp, Tcl_GetString(objv[2]));
+    }
+    if (fmtPtr->exportProc == NULL) {
+        Tcl_AppendResult(interp, "can't find table export procedure for \"", 
+                         fmtPtr->name, "\" format.", (char *)NULL);
         return TCL_ERROR;
     }
-    result = (*proc)(clientData, interp, objc, objv);
-    return result;
+    return (*fmtPtr->exportProc) (cmdPtr->table, interp, objc, objv);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * CopyOp --
+ * FindOp --
  *
- *      Copies the rows and columns from the source table given.  Any data 
- *      in the table is first deleted.
+ *      Parses the given command line and calls one of several export-specific
+ *      operations.
+ *      
+ * Results:
+ *      Returns a standard TCL result.  It is the result of operation called.
  *
- *      tableName copy srcTableName
+ *      tableName find expr ?switches?
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 static int
-CopyOp(ClientData clientData, Tcl_Interp *interp, int objc,
+FindOp(ClientData clientData, Tcl_Interp *interp, int objc,
        Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE srcTable;
+    FindSwitches switches;
     int result;
 
-    if (blt_table_open(interp, Tcl_GetString(objv[2]), &srcTable) != TCL_OK) {
+    memset(&switches, 0, sizeof(switches));
+    rowIterSwitch.clientData = cmdPtr->table;
+    blt_table_iterate_all_rows(cmdPtr->table, &switches.iter);
+    if (Blt_ParseSwitches(interp, findSwitches, objc - 3, objv + 3, 
+        &switches, BLT_SWITCH_DEFAULTS) < 0) {
         return TCL_ERROR;
     }
-    result = CopyTable(interp, srcTable, cmdPtr->table);
-    blt_table_close(srcTable);
+    switches.table = cmdPtr->table;
+    Blt_InitHashTable(&switches.varTable, BLT_ONE_WORD_KEYS);
+    result = FindRows(interp, cmdPtr->table, objv[2], &switches);
+    Blt_FreeSwitches(findSwitches, &switches, 0);
     return result;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * DirOp --
+ * GetOp --
  *
- *      tableName dir dirPath ?switches ...?
+ *      Retrieves the value from a given table for a designated row,column
+ *      location.
+ *
+ *      Normally it's an error if the column or row key is invalid or the data
+ *      slot is empty (the Tcl_Obj is NULL). But if an extra argument is
+ *      provided, then it is returned as a default value.
+ * 
+ * Results:
+ *      A standard TCL result. If the tag or index is invalid, TCL_ERROR is
+ *      returned and an error message is left in the interpreter result.
+ *      
+ *      tableName get rowName columnName ?defValue?
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 static int
-DirOp(ClientData clientData, Tcl_Interp *interp, int objc,
-      Tcl_Obj *const *objv)
+GetOp(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    ReadDirectory reader;
-    Tcl_Obj **patterns, **entries, *listObjPtr;
-    Tcl_StatBuf stat;
-    int i, numPatterns, numEntries;
-    unsigned int patternFlags;
-    Tcl_GlobTypeData data = {
-        0, TCL_GLOB_PERM_R, /* macType*/NULL, /*macCreator*/NULL
-    };
+    Tcl_Obj *objPtr;
+    BLT_TABLE_ROW row;
+    BLT_TABLE_COLUMN col;
 
-    memset(&reader, 0, sizeof(reader));
-    reader.mask = READ_DIR_DEFAULT;
-    if (Blt_ParseSwitches(interp, dirSwitches, objc - 3, objv + 3, &reader,
-        BLT_SWITCH_DEFAULTS) < 0) {
+    row = blt_table_get_row(interp, cmdPtr->table, objv[2]);
+    if (row == NULL) {
+        if (objc == 5) {
+            objPtr = objv[4];
+            goto done;
+        }
         return TCL_ERROR;
-    }
-    data.type = reader.type;
-    data.perm = reader.perm;
-    numPatterns = 0;
-    if (reader.patternsObjPtr != NULL) {
-        if (Tcl_ListObjGetElements(interp, reader.patternsObjPtr, 
-                &numPatterns, &patterns) != TCL_OK) {
-            return TCL_ERROR;           /* Can't split patterns. */
+    } 
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        if (objc == 5) {
+            objPtr = objv[4];
+            goto done;
+        }
+        return TCL_ERROR;
+    } 
+    objPtr = blt_table_get_obj(cmdPtr->table, row, col);
+    if (objPtr == NULL) {
+        if (objc == 5) {
+            objPtr = objv[4];
+        } else {
+            objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
         }
     }
-    patternFlags = 0;
-#if (_TCL_VERSION > _VERSION(8,5,0)) 
-    if (reader.flags & READ_DIR_NOCASE) {
-        patternFlags =  TCL_MATCH_NOCASE;
-    }
-#endif
-    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
-    if (Tcl_FSStat(objv[2], &stat) != 0) {
-        Tcl_AppendResult(interp, "Can't stat directory \"",
-                         Tcl_GetString(objv[2]), "\": ",
-                         Tcl_PosixError(interp), (char *)NULL);
-        goto error;
-    }
-    if (!S_ISDIR(stat.st_mode)) {
-        Tcl_AppendResult(interp, "\"", Tcl_GetString(objv[2]),
-                         "\" is not a directory", (char *)NULL);
-        goto error;
-    }
-    if (Tcl_FSMatchInDirectory(interp, listObjPtr, objv[2], "*", &data)
-        != TCL_OK) {
-        Tcl_AppendResult(interp, "Can't read directory \"",
-                         Tcl_GetString(objv[2]), "\": ",
-                         Tcl_PosixError(interp), (char *)NULL);
-        goto error;
-    }
-    if (Tcl_ListObjGetElements(interp, listObjPtr, &numEntries, &entries)
-        != TCL_OK) {
-        goto error;
-    }
-    for (i = 0; i < numEntries; i++) {
-        Tcl_Obj *partsObjPtr, *tailObjPtr;
-        Tcl_StatBuf stat;
-        const char *label;
-        int isMatch, numParts;
+ done:
+    Tcl_SetObjResult(interp, objPtr);
+    return TCL_OK;
+}
 
-        if (Tcl_FSConvertToPathType(interp, entries[i]) != TCL_OK) {
-           goto error;                 /* Can't convert path. */
-        }
-        memset(&stat, 0, sizeof(Tcl_StatBuf));
-        if (Tcl_FSStat(entries[i], &stat) < 0) {
-            continue;                   /* Can't stat entry. */
-        }
-        /* Get the tail of the path. */
-        partsObjPtr = Tcl_FSSplitPath(entries[i], &numParts);
-        if ((partsObjPtr == NULL) || (numParts == 0)) {
-            goto error;                 /* Can't split path. */
-        }
-        Tcl_IncrRefCount(partsObjPtr);
-        Tcl_ListObjIndex(NULL, partsObjPtr, numParts - 1, &tailObjPtr);
-        label = Tcl_GetString(tailObjPtr);
 
-        if (label[0] == '.') {
-            if (label[1] == '\0') {
-                Tcl_DecrRefCount(partsObjPtr);
-                continue;               /* Ignore . */
-            }
-            if ((label[1] == '.') && (label[2] == '\0')) {
-                Tcl_DecrRefCount(partsObjPtr);
-                continue;               /* Ignore .. */
-            }
-            /* Workaround bug in Tcl_FSSplitPath. Files that start with "~"
-             * are prepended with "./" */
-            if (label[1] == '/') {
-                label += 2;
-            }
-        }
-        isMatch = TRUE;
-        if (numPatterns > 0) {          /* Match files or subdirectories
-                                         * against patterns. */
-            int j;
-            
-            isMatch = FALSE;
-            for (j = 0; j < numPatterns; j++) {
-                const char *pattern;
-                
-                pattern = Tcl_GetString(patterns[j]);
-                if (Tcl_StringCaseMatch(label, pattern, patternFlags)) {
-                    isMatch = TRUE;
-                    break;              /* Found a match. */
-                }
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ImportOp --
+ *
+ *      Parses the given command line and calls one of several import-specific
+ *      operations.
+ *      
+ * Results:
+ *      Returns a standard TCL result.  It is the result of operation called.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ImportOp(ClientData clientData, Tcl_Interp *interp, int objc,
+         Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    Blt_HashEntry *hPtr;
+    DataFormat *fmtPtr;
+    TableCmdInterpData *dataPtr;
+    const char *fmt;
+
+    dataPtr = GetTableCmdInterpData(interp);
+    if (objc == 2) {
+        Blt_HashSearch iter;
+
+        for (hPtr = Blt_FirstHashEntry(&dataPtr->fmtTable, &iter); 
+             hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+            fmtPtr = Blt_GetHashValue(hPtr);
+            if (fmtPtr->importProc != NULL) {
+                Tcl_AppendElement(interp, fmtPtr->name);
             }
         }
-        if (isMatch) {
-            ExportToTable(interp, cmdPtr->table, label, &stat, &reader);
+        return TCL_OK;
+    }
+    fmt = Tcl_GetString(objv[2]);
+    hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
+    if (hPtr == NULL) {
+        LoadFormat(interp, fmt);
+        hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
+        if (hPtr == NULL) {
+            Tcl_AppendResult(interp, "can't import table format \"", fmt,
+                             "\": format not registered", (char *)NULL);
+            return TCL_ERROR;
         }
-        Tcl_DecrRefCount(partsObjPtr);
     }
-    Tcl_DecrRefCount(listObjPtr);
-    return TCL_OK;
- error:
-    Tcl_DecrRefCount(listObjPtr);
-    return TCL_ERROR;
+    fmtPtr = Blt_GetHashValue(hPtr);
+    if ((fmtPtr->flags & FMT_LOADED) == 0) {
+        LoadFormat(interp, Tcl_GetString(objv[2]));
+    }
+    if (fmtPtr->importProc == NULL) {
+        Tcl_AppendResult(interp, "can't find table import procedure for \"", 
+                fmtPtr->name, "\" format.", (char *)NULL);
+        return TCL_ERROR;
+    }
+    return (*fmtPtr->importProc) (cmdPtr->table, interp, objc, objv);
+}
+
+static int
+CompareIndices(const void *a, const void *b)
+{
+    const long *i1Ptr = a;
+    const long *i2Ptr = b;
+
+    return (*i1Ptr > *i2Ptr) - (*i1Ptr < *i2Ptr);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * DumpOp --
+ * IndexCreateOp --
  *
- *      tableName dump ?switches?
+ *      Creates a secondary index on the column.  By default the index is
+ *      a hash index.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *      tableName index create columnName ?-type hash|ordered?
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 static int
-DumpOp(ClientData clientData, Tcl_Interp *interp, int objc,
-       Tcl_Obj *const *objv)
+IndexCreateOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    BLT_TABLE table;
-    DumpSwitches switches;
-    int result;
-    Tcl_DString ds;
-    int closeChannel;
-    Tcl_Channel channel;
-
-    closeChannel = FALSE;
-    channel = NULL;
-    table = cmdPtr->table;
-    result = TCL_ERROR;
-    memset(&switches, 0, sizeof(switches));
-    switches.channel = channel;
-    switches.dsPtr = &ds;
-    rowIterSwitch.clientData = cmdPtr->table;
-    columnIterSwitch.clientData = cmdPtr->table;
-    blt_table_iterate_all_rows(table, &switches.ri);
-    blt_table_iterate_all_columns(table, &switches.ci);
+    BLT_TABLE_COLUMN col;
+    int type;
 
-    if (Blt_ParseSwitches(interp, dumpSwitches, objc - 2, objv + 2, &switches, 
-        BLT_SWITCH_DEFAULTS) < 0) {
-        goto error;
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        return TCL_ERROR;
     }
-    if (switches.fileObjPtr != NULL) {
-        const char *fileName;
-
-        fileName = Tcl_GetString(switches.fileObjPtr);
+    type = TABLE_INDEX_HASH;
+    if (objc == 6) {
+        const char *string;
 
-        closeChannel = TRUE;
-        if ((fileName[0] == '@') && (fileName[1] != '\0')) {
-            int mode;
-            
-            channel = Tcl_GetChannel(interp, fileName+1, &mode);
-            if (channel == NULL) {
-                goto error;
-            }
-            if ((mode & TCL_WRITABLE) == 0) {
-                Tcl_AppendResult(interp, "can't dump table: channel \"", 
-                        fileName, "\" not opened for writing", (char *)NULL);
-                goto error;
-            }
-            closeChannel = FALSE;
+        string = Tcl_GetString(objv[4]);
+        if (strcmp(string, "-type") != 0) {
+            Tcl_AppendResult(interp, "unknown switch \"", string, 
+                "\": should be -type", (char *)NULL);
+            return TCL_ERROR;
+        }
+        string = Tcl_GetString(objv[5]);
+        if (strcmp(string, "hash") == 0) {
+            type = TABLE_INDEX_HASH;
+        } else if (strcmp(string, "ordered") == 0) {
+            type = TABLE_INDEX_ORDERED;
         } else {
-            channel = Tcl_OpenFileChannel(interp, fileName, "w", 0666);
-            if (channel == NULL) {
-                goto error;
-            }
+            Tcl_AppendResult(interp, "unknown index type \"", string, 
+                "\": should be hash or ordered", (char *)NULL);
+            return TCL_ERROR;
         }
-        switches.channel = channel;
-    }
-    Tcl_DStringInit(&ds);
-    result = DumpTable(table, &switches);
-    if ((switches.channel == NULL) && (result == TCL_OK)) {
-        Tcl_DStringResult(interp, &ds);
-    }
-    Tcl_DStringFree(&ds);
- error:
-    if (closeChannel) {
-        Tcl_Close(interp, channel);
+    } else if (objc != 4) {
+        Tcl_AppendResult(interp, "wrong # args: should be \"", 
+                Tcl_GetString(objv[0]), 
+                " index create columnName ?-type hash|ordered?\"",
+                (char *)NULL);
+        return TCL_ERROR;
     }
-    Blt_FreeSwitches(dumpSwitches, &switches, 0);
-    return result;
+    return blt_table_create_index(interp, cmdPtr->table, col, type);
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * DupOp --
+ * IndexDeleteOp --
  *
- *      Duplicates the rows and columns from the source table given into
- *      a new table.  
+ *      Removes the secondary indexes from the given columns.  It's not
+ *      an error if a column isn't indexed.
  *
- *      tableName dup ?destTableName?
+ * Results:
+ *      A standard TCL result.
+ *
+ *      tableName index delete ?columnName ...?
  *
  *---------------------------------------------------------------------------
  */
-/*ARGSUSED*/
 static int
-DuplicateOp(ClientData clientData, Tcl_Interp *interp, int objc,
-            Tcl_Obj *const *objv)
+IndexDeleteOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    if (objc == 3) {
-        BLT_TABLE srcTable;
-        int result;
-
-        if (blt_table_open(interp, Tcl_GetString(objv[2]), &srcTable) 
-            != TCL_OK) {
-            return TCL_ERROR;
-        }
-        result = CopyTable(interp, srcTable, cmdPtr->table);
-        blt_table_close(srcTable);
-        return result;
-    } else {
-        Tcl_DString ds;
-        const char *instName;
-        BLT_TABLE destTable;
-
-        Tcl_DStringInit(&ds);
-        instName = GenerateName(interp, "", "", &ds);
-        if (instName == NULL) {
-            goto error;
-        }
-        if (blt_table_create(interp, instName, &destTable) == TCL_OK) {
-            int result;
+    BLT_TABLE_ITERATOR iter;
+    BLT_TABLE_COLUMN col;
 
-            NewTableCmd(interp, destTable, instName);
-            result = CopyTable(interp, cmdPtr->table, destTable);
-            if (result != TCL_ERROR) {
-                Tcl_SetStringObj(Tcl_GetObjResult(interp), instName, -1);
-            }
-            Tcl_DStringFree(&ds);
-            return result;
-        }
-    error:
-        Tcl_DStringFree(&ds);
+    if (blt_table_iterate_columns_objv(interp, cmdPtr->table, objc - 3, 
+                objv + 3, &iter) != TCL_OK) {
         return TCL_ERROR;
     }
-    return TCL_ERROR;
+    for (col = blt_table_first_tagged_column(&iter); col != NULL; 
+         col = blt_table_next_tagged_column(&iter)) {
+        blt_table_delete_index(cmdPtr->table, col);
+    }
+    blt_table_free_iterator_objv(&iter);
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * EmptyValueOp --
+ * IndexLookupOp --
  *
- *      tableName emptyvalue ?value?
+ *      Returns the indices of the rows whose value in the indexed column
+ *      is equal to the given value.  The row indices are returned in
+ *      increasing order.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *      tableName index lookup columnName value
  *
  *---------------------------------------------------------------------------
  */
 static int
-EmptyValueOp(ClientData clientData, Tcl_Interp *interp, int objc,
-             Tcl_Obj *const *objv)
+IndexLookupOp(ClientData clientData, Tcl_Interp *interp, int objc,
+              Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    Tcl_SetStringObj(Tcl_GetObjResult(interp), cmdPtr->emptyString, -1);
-    if (objc == 3) {
-        if (cmdPtr->emptyString != NULL) {
-            Blt_Free(cmdPtr->emptyString);
-            cmdPtr->emptyString = Blt_AssertStrdup(Tcl_GetString(objv[2]));
-        }
+    BLT_TABLE_COLUMN col;
+    Blt_Chain chain;
+    Blt_ChainLink link;
+    Tcl_Obj *listObjPtr;
+    long *indices;
+    long i, numRows;
+
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        return TCL_ERROR;
+    }
+    chain = Blt_Chain_Create();
+    if (blt_table_index_lookup(interp, cmdPtr->table, col, objv[4], chain) 
+        != TCL_OK) {
+        Blt_Chain_Destroy(chain);
+        return TCL_ERROR;
+    }
+    numRows = Blt_Chain_GetLength(chain);
+    indices = Blt_AssertMalloc(sizeof(long) * MAX(numRows, 1));
+    for (i = 0, link = Blt_Chain_FirstLink(chain); link != NULL;
+         link = Blt_Chain_NextLink(link), i++) {
+        indices[i] = blt_table_row_index(cmdPtr->table,
+                                         Blt_Chain_GetValue(link));
+    }
+    Blt_Chain_Destroy(chain);
+    qsort(indices, numRows, sizeof(long), CompareIndices);
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    for (i = 0; i < numRows; i++) {
+        Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewLongObj(indices[i]));
     }
+    Blt_Free(indices);
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * ExistsOp --
+ * IndexNamesOp --
  *
- *      tableName exists rowName columnName
+ *      Returns the labels of the indexed columns.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *      tableName index names 
  *
  *---------------------------------------------------------------------------
  */
 static int
-ExistsOp(ClientData clientData, Tcl_Interp *interp, int objc,
-         Tcl_Obj *const *objv)
+IndexNamesOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    int bool;
-    BLT_TABLE_ROW row;
     BLT_TABLE_COLUMN col;
+    Tcl_Obj *listObjPtr;
 
-    bool = FALSE;
-    row = blt_table_get_row(NULL, cmdPtr->table, objv[2]);
-    col = blt_table_get_column(NULL, cmdPtr->table, objv[3]);
-    if ((row != NULL) && (col != NULL)) {
-        bool = blt_table_value_exists(cmdPtr->table, row, col);
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    for (col = blt_table_first_column(cmdPtr->table); col != NULL;
+         col = blt_table_next_column(col)) {
+        if (blt_table_index_type(col) != TABLE_INDEX_NONE) {
+            Tcl_Obj *objPtr;
+
+            objPtr = Tcl_NewStringObj(blt_table_column_label(col), -1);
+            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
+        }
     }
-    Tcl_SetBooleanObj(Tcl_GetObjResult(interp), bool);
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
+
+typedef struct {
+    Tcl_Obj *minObjPtr, *maxObjPtr;
+} IndexRangeSwitches;
+
+static Blt_SwitchSpec indexRangeSwitches[] = 
+{
+    {BLT_SWITCH_OBJ, "-max", "value", (char *)NULL,
+        Blt_Offset(IndexRangeSwitches, maxObjPtr), 0},
+    {BLT_SWITCH_OBJ, "-min", "value", (char *)NULL,
+        Blt_Offset(IndexRangeSwitches, minObjPtr), 0},
+    {BLT_SWITCH_END}
+};
+
 /*
  *---------------------------------------------------------------------------
  *
- * ExportOp --
+ * IndexRangeOp --
+ *
+ *      Returns the indices of the rows whose value in the column lies
+ *      between the minimum and maximum values (inclusive).  The column
+ *      must have an ordered index.  Rows are returned in increasing order
+ *      of their values.
  *
- *      Parses the given command line and calls one of several export-specific
- *      operations.
- *      
  * Results:
- *      Returns a standard TCL result.  It is the result of operation called.
+ *      A standard TCL result.
+ *
+ *      tableName index range columnName ?-min value? ?-max value?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ExportOp(ClientData clientData, Tcl_Interp *interp, int objc,
-         Tcl_Obj *const *objv)
+IndexRangeOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    Blt_HashEntry *hPtr;
-    DataFormat *fmtPtr;
-    TableCmdInterpData *dataPtr;
-    const char *fmt;
-
-    dataPtr = GetTableCmdInterpData(interp);
-    if (objc == 2) {
-        Blt_HashSearch iter;
+    BLT_TABLE_COLUMN col;
+    Blt_Chain chain;
+    Blt_ChainLink link;
+    IndexRangeSwitches switches;
+    Tcl_Obj *listObjPtr;
+    int result;
 
-        for (hPtr = Blt_FirstHashEntry(&dataPtr->fmtTable, &iter); 
-             hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
-            fmtPtr = Blt_GetHashValue(hPtr);
-            if (fmtPtr->exportProc != NULL) {
-                Tcl_AppendElement(interp, fmtPtr->name);
-            }
-        }
-        return TCL_OK;
-    }
-    fmt = Tcl_GetString(objv[2]);
-    hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
-    if (hPtr == NULL) {
-        LoadFormat(interp, fmt);
-        hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
-        if (hPtr == NULL) {
-            Tcl_AppendResult(interp, "can't export \"", Tcl_GetString(objv[2]),
-                         "\": format not registered", (char *)NULL);
-            return TCL_ERROR;
-        }
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
+        return TCL_ERROR;
     }
-    fmtPtr = Blt_GetHashValue(hPtr);
-    if ((fmtPtr->flags & FMT_LOADED) == 0) {
-        LoadFormat(interp, Tcl_GetString(objv[2]));
+    memset(&switches, 0, sizeof(switches));
+    if (Blt_ParseSwitches(interp, indexRangeSwitches, objc - 4, objv + 4, 
+        &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
     }
-    if (fmtPtr->exportProc == NULL) {
-        Tcl_AppendResult(interp, "can't find table export procedure for \"", 
-                         fmtPtr->name, "\" format.", (char *)NULL);
+    chain = Blt_Chain_Create();
+    result = blt_table_index_range(interp, cmdPtr->table, col, 
+        switches.minObjPtr, switches.maxObjPtr, chain);
+    Blt_FreeSwitches(indexRangeSwitches, &switches, 0);
+    if (result != TCL_OK) {
+        Blt_Chain_Destroy(chain);
         return TCL_ERROR;
     }
-    return (*fmtPtr->exportProc) (cmdPtr->table, interp, objc, objv);
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    for (link = Blt_Chain_FirstLink(chain); link != NULL;
+         link = Blt_Chain_NextLink(link)) {
+        Tcl_ListObjAppendElement(interp, listObjPtr, 
+                GetRowIndexObj(cmdPtr->table, Blt_Chain_GetValue(link)));
+    }
+    Blt_Chain_Destroy(chain);
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * FindOp --
+ * IndexTypeOp --
+ *
+ *      Returns the type of index on the column: "hash", "ordered", or ""
+ *      if the column isn't indexed.
  *
- *      Parses the given command line and calls one of several export-specific
- *      operations.
- *      
  * Results:
- *      Returns a standard TCL result.  It is the result of operation called.
+ *      A standard TCL result.
  *
- *      tableName find expr ?switches?
+ *      tableName index type columnName
  *
  *---------------------------------------------------------------------------
  */
 static int
-FindOp(ClientData clientData, Tcl_Interp *interp, int objc,
-       Tcl_Obj *const *objv)
+IndexTypeOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
 {
     Cmd *cmdPtr = clientData;
-    FindSwitches switches;
-    int result;
+    BLT_TABLE_COLUMN col;
+    const char *string;
 
-    memset(&switches, 0, sizeof(switches));
-    rowIterSwitch.clientData = cmdPtr->table;
-    blt_table_iterate_all_rows(cmdPtr->table, &switches.iter);
-    if (Blt_ParseSwitches(interp, findSwitches, objc - 3, objv + 3, 
-        &switches, BLT_SWITCH_DEFAULTS) < 0) {
+    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
+    if (col == NULL) {
         return TCL_ERROR;
     }
-    switches.table = cmdPtr->table;
-    Blt_InitHashTable(&switches.varTable, BLT_ONE_WORD_KEYS);
-    result = FindRows(interp, cmdPtr->table, objv[2], &switches);
-    Blt_FreeSwitches(findSwitches, &switches, 0);
-    return result;
+    switch (blt_table_index_type(col)) {
+    case TABLE_INDEX_HASH:
+        string = "hash";                break;
+    case TABLE_INDEX_ORDERED:
+        string = "ordered";             break;
+    default:
+        string = "";                    break;
+    }
+    Tcl_SetStringObj(Tcl_GetObjResult(interp), string, -1);
+    return TCL_OK;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * GetOp --
+ * IndexOp --
  *
- *      Retrieves the value from a given table for a designated row,column
- *      location.
+ *      This procedure is invoked to process secondary index operations.
  *
- *      Normally it's an error if the column or row key is invalid or the data
- *      slot is empty (the Tcl_Obj is NULL). But if an extra argument is
- *      provided, then it is returned as a default value.
- * 
  * Results:
- *      A standard TCL result. If the tag or index is invalid, TCL_ERROR is
- *      returned and an error message is left in the interpreter result.
- *      
- *      tableName get rowName columnName ?defValue?
+ *      A standard TCL result.
+ *
+ * Side Effects:
+ *      See the user documentation.
  *
  *---------------------------------------------------------------------------
  */
+static Blt_OpSpec indexOps[] =
+{
+    {"create", 1, IndexCreateOp, 4, 6, "columnName ?-type hash|ordered?",},
+    {"delete", 1, IndexDeleteOp, 3, 0, "?columnName ...?",},
+    {"lookup", 1, IndexLookupOp, 5, 5, "columnName value",},
+    {"names",  1, IndexNamesOp,  3, 3, "",},
+    {"range",  1, IndexRangeOp,  4, 0, "columnName ?-min value? ?-max value?",},
+    {"type",   1, IndexTypeOp,   4, 4, "columnName",},
+};
+
+static int numIndexOps = sizeof(indexOps) / sizeof(Blt_OpSpec);
+
 static int
-GetOp(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
+IndexOp(ClientData clientData, Tcl_Interp *interp, int objc,
+        Tcl_Obj *const *objv)
 {
-    Cmd *cmdPtr = clientData;
-    Tcl_Obj *objPtr;
-    BLT_TABLE_ROW row;
-    BLT_TABLE_COLUMN col;
+    Tcl_ObjCmdProc *proc;
+    int result;
 
-    row = blt_table_get_row(interp, cmdPtr->table, objv[2]);
-    if (row == NULL) {
-        if (objc == 5) {
-            objPtr = objv[4];
-            goto done;
-        }
-        return TCL_ERROR;
-    } 
-    col = blt_table_get_column(interp, cmdPtr->table, objv[3]);
-    if (col == NULL) {
-        if (objc == 5) {
-            objPtr = objv[4];
-            goto done;
-        }
+    proc = Blt_GetOpFromObj(interp, numIndexOps, indexOps, BLT_OP_ARG2, objc, 
+        objv, 0);
+    if (proc == NULL) {
         return TCL_ERROR;
-    } 
-    objPtr = blt_table_get_obj(cmdPtr->table, row, col);
-    if (objPtr == NULL) {
-        if (objc == 5) {
-            objPtr = objv[4];
-        } else {
-            objPtr = Tcl_NewStringObj(cmdPtr->emptyString, -1);
-        }
     }
- done:
-    Tcl_SetObjResult(interp, objPtr);
-    return TCL_OK;
+    result = (*proc)(clientData, interp, objc, objv);
+    return result;
 }
 
-
 /*
  *---------------------------------------------------------------------------
  *
- * ImportOp --
+ * JoinOp --
  *
- *      Parses the given command line and calls one of several import-specific
- *      operations.
- *      
+ *      Joins the rows of this table with the rows of another table whose
+ *      key columns have the same values, creating a new table with the
+ *      result.  Each element of the -on list is either a column in both
+ *      tables or a pair of columns, the first in this table and the
+ *      second in the other.
+ * 
  * Results:
- *      Returns a standard TCL result.  It is the result of operation called.
+ *      A standard TCL result. The name of the new table is returned.
+ *
+ *      tableName join otherTable -on columnList ?-how inner|left? 
+ *              ?-suffix string?
  *
  *---------------------------------------------------------------------------
  */
 static int
-ImportOp(ClientData clientData, Tcl_Interp *interp, int objc,
-         Tcl_Obj *const *objv)
+JoinOp(ClientData clientData, Tcl_Interp *interp, int objc,
+       Tcl_Obj *const *objv)
 {
+    BLT_TABLE otherTable, destTable;
+    BLT_TABLE_COLUMN *keys, *otherKeys;
     Cmd *cmdPtr = clientData;
-    Blt_HashEntry *hPtr;
-    DataFormat *fmtPtr;
-    TableCmdInterpData *dataPtr;
-    const char *fmt;
+    TableJoinSwitches switches;
+    Tcl_DString ds;
+    Tcl_Obj **elems;
+    int i, how, numElems, result;
 
-    dataPtr = GetTableCmdInterpData(interp);
-    if (objc == 2) {
-        Blt_HashSearch iter;
+    if (blt_table_open(interp, Tcl_GetString(objv[2]), &otherTable) 
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
+    memset(&switches, 0, sizeof(switches));
+    keys = otherKeys = NULL;
+    result = TCL_ERROR;
+    if (Blt_ParseSwitches(interp, tableJoinSwitches, objc - 3, objv + 3, 
+                &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        goto done;
+    }
+    how = TABLE_JOIN_INNER;
+    if (switches.how != NULL) {
+        if (strcmp(switches.how, "left") == 0) {
+            how = TABLE_JOIN_LEFT;
+        } else if (strcmp(switches.how, "inner") != 0) {
+            Tcl_AppendResult(interp, "bad join type \"", switches.how, 
+                "\": should be inner or left", (char *)NULL);
+            goto done;
+        }
+    }
+    numElems = 0;
+    if ((switches.onObjPtr != NULL) &&
+        (Tcl_ListObjGetElements(interp, switches.onObjPtr, &numElems, &elems)
+         != TCL_OK)) {
+        goto done;
+    }
+    if (numElems == 0) {
+        Tcl_AppendResult(interp, "no columns to join on: ",
+                "the -on switch is required", (char *)NULL);
+        goto done;
+    }
+    keys = Blt_AssertMalloc(numElems * sizeof(BLT_TABLE_COLUMN));
+    otherKeys = Blt_AssertMalloc(numElems * sizeof(BLT_TABLE_COLUMN));
+    for (i = 0; i < numElems; i++) {
+        Tcl_Obj **pair;
+        int numPair;
 
-        for (hPtr = Blt_FirstHashEntry(&dataPtr->fmtTable, &iter); 
-             hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
-            fmtPtr = Blt_GetHashValue(hPtr);
-            if (fmtPtr->importProc != NULL) {
-                Tcl_AppendElement(interp, fmtPtr->name);
-            }
+        if (Tcl_ListObjGetElements(interp, elems[i], &numPair, &pair) 
+            != TCL_OK) {
+            goto done;
+        }
+        if ((numPair != 1) && (numPair != 2)) {
+            Tcl_AppendResult(interp, "bad join column \"", 
+                Tcl_GetString(elems[i]), 
+                "\": should be columnName or {columnName otherColumnName}", 
+                (char *)NULL);
+            goto done;
+        }
+        keys[i] = blt_table_get_column(interp, cmdPtr->table, pair[0]);
+        if (keys[i] == NULL) {
+            goto done;
+        }
+        otherKeys[i] = blt_table_get_column(interp, otherTable, 
+                pair[numPair - 1]);
+        if (otherKeys[i] == NULL) {
+            goto done;
         }
-        return TCL_OK;
     }
-    fmt = Tcl_GetString(objv[2]);
-    hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
-    if (hPtr == NULL) {
-        LoadFormat(interp, fmt);
-        hPtr = Blt_FindHashEntry(&dataPtr->fmtTable, fmt);
-        if (hPtr == NULL) {
-            Tcl_AppendResult(interp, "can't import table format \"", fmt,
-                             "\": format not registered", (char *)NULL);
-            return TCL_ERROR;
+    Tcl_DStringInit(&ds);
+    if (NewResultTable(interp, &ds, &destTable) == TCL_OK) {
+        result = blt_table_join(interp, cmdPtr->table, otherTable, numElems,
+                keys, otherKeys, how, 
+                (switches.suffix != NULL) ? switches.suffix : "_2", destTable);
+        if (result == TCL_OK) {
+            Tcl_DStringResult(interp, &ds);
+        } else {
+            Tcl_DeleteCommand(interp, Tcl_DStringValue(&ds));
         }
     }
-    fmtPtr = Blt_GetHashValue(hPtr);
-    if ((fmtPtr->flags & FMT_LOADED) == 0) {
-        LoadFormat(interp, Tcl_GetString(objv[2]));
+    Tcl_DStringFree(&ds);
+ done:
+    if (keys != NULL) {
+        Blt_Free(keys);
     }
-    if (fmtPtr->importProc == NULL) {
-        Tcl_AppendResult(interp, "can't find table import procedure for \"", 
-                fmtPtr->name, "\" format.", (char *)NULL);
-        return TCL_ERROR;
+    if (otherKeys != NULL) {
+        Blt_Free(otherKeys);
     }
-    return (*fmtPtr->importProc) (cmdPtr->table, interp, objc, objv);
+    Blt_FreeSwitches(tableJoinSwitches, &switches, 0);
+    blt_table_close(otherTable);
+    return result;
 }
 
 /*
@@ -5805,6 +7717,9 @@ MinMaxOp(ClientData clientData, Tcl_Interp *interp, int objc,
                                           &maxObjPtr) != TCL_OK) {
                 return TCL_ERROR;
             }
+            if (minObjPtr == NULL) {    /* Column has no values. */
+                minObjPtr = maxObjPtr = Tcl_NewStringObj("", 0);
+            }
             if (flags & GET_MIN) {
                 Tcl_ListObjAppendElement(interp, listObjPtr, minObjPtr);
             } 
@@ -5827,6 +7742,9 @@ MinMaxOp(ClientData clientData, Tcl_Interp *interp, int objc,
                         &maxObjPtr) != TCL_OK) {
                 return TCL_ERROR;
             }
+            if (minObjPtr == NULL) {    /* Column has no values. */
+                minObjPtr = maxObjPtr = Tcl_NewStringObj("", 0);
+            }
             if (flags & GET_MIN) {
                 Tcl_ListObjAppendElement(interp, listObjPtr, minObjPtr);
             } 
@@ -5938,6 +7856,12 @@ PackOp(ClientData clientData, Tcl_Interp *interp, int objc,
 {
     Cmd *cmdPtr = clientData;
 
+    if (blt_table_is_snapshot(cmdPtr->table)) {
+        Tcl_AppendResult(interp, "can't pack \"", 
+                blt_table_name(cmdPtr->table), "\": table is a snapshot",
+                (char *)NULL);
+        return TCL_ERROR;
+    }
     blt_table_pack(cmdPtr->table);
     return TCL_OK;
 }
@@ -8028,6 +9952,45 @@ SetOp(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
     return TCL_OK;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SnapshotOp --
+ *
+ *      Creates a read-only copy of the table as it is now.  The copy
+ *      shares the storage of the table's columns until either table
+ *      changes them.  The name of the new table is returned.
+ *
+ *      tableName snapshot
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+SnapshotOp(ClientData clientData, Tcl_Interp *interp, int objc,
+           Tcl_Obj *const *objv)
+{
+    Cmd *cmdPtr = clientData;
+    BLT_TABLE snapTable;
+    Tcl_DString ds;
+    const char *instName;
+
+    Tcl_DStringInit(&ds);
+    instName = GenerateName(interp, "", "", &ds);
+    if (instName == NULL) {
+        goto error;
+    }
+    if (blt_table_snapshot(interp, cmdPtr->table, instName, &snapTable) 
+        != TCL_OK) {
+        goto error;
+    }
+    NewTableCmd(interp, snapTable, instName);
+    Tcl_DStringResult(interp, &ds);
+    return TCL_OK;
+ error:
+    Tcl_DStringFree(&ds);
+    return TCL_ERROR;
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -8094,7 +10057,6 @@ SortOp(ClientData clientData, Tcl_Interp *interp, int objc,
         sp->column = col;
         sp++;
     }
-    blt_table_sort_init(cmdPtr->table, order, numColumns, switches.tsFlags);
     col = order[0].column;
     /* Create a row map, pruning out empty values if necessary. */
     if (switches.ri.numEntries > 0) {
@@ -8134,7 +10096,8 @@ SortOp(ClientData clientData, Tcl_Interp *interp, int objc,
         numRows = i;
     }
     /* Sort the row map. */
-    blt_table_sort_row_map(cmdPtr->table, numRows, map);
+    blt_table_sort_rows_by_order(cmdPtr->table, order, numColumns, 
+                                 switches.tsFlags, numRows, map);
     
     if ((switches.freqArrVarObjPtr != NULL) || 
         (switches.freqListVarObjPtr != NULL) || 
@@ -8155,13 +10118,12 @@ SortOp(ClientData clientData, Tcl_Interp *interp, int objc,
     }
     Blt_Free(order);
     if (switches.flags & SORT_ALTER) {
-        /* Make row order permanent. */
+        /* Make row order permanent. The table takes ownership of the
+         * map. */
         blt_table_set_row_map(cmdPtr->table, map);
+    } else {
+        Blt_Free(map);
     }
-    if (result != TCL_OK) {
-        goto error;
-    }
-    blt_table_sort_finish();
     Blt_FreeSwitches(sortSwitches, &switches, 0);
     return TCL_OK;
 
@@ -8172,7 +10134,6 @@ SortOp(ClientData clientData, Tcl_Interp *interp, int objc,
     if (order != NULL) {
         Blt_Free(order);
     }
-    blt_table_sort_finish();
     Blt_FreeSwitches(sortSwitches, &switches, 0);
     return result;
 }
@@ -9153,8 +11114,10 @@ WatchOp(ClientData clientData, Tcl_Interp *interp, int objc,
 static Blt_OpSpec tableOps[] =
 {
     {"add",        2, AddOp,        3, 0, "tableName ?switches?",},
+    {"aggregate",  2, AggregateOp,  2, 0, "?switches?",},
     {"append",     2, AppendOp,     5, 0, "rowName columnName ?value ...?",},
     {"attach",     2, AttachOp,     2, 3, "tableName",},
+    {"batch",      1, BatchOp,      3, 3, "script",},
     {"column",     3, ColumnOp,     3, 0, "op args...",},
     {"copy",       3, CopyOp,       3, 3, "tableName",},
     {"clear",      2, ClearOp,      2, 2, "",},
@@ -9166,7 +11129,9 @@ static Blt_OpSpec tableOps[] =
     {"export",     3, ExportOp,     2, 0, "formatName args...",},
     {"find",       1, FindOp,       3, 0, "exprString ?switches?",},
     {"get",        1, GetOp,        4, 5, "rowName columnName ?defValue?",},
-    {"import",     1, ImportOp,     2, 0, "formatName args...",},
+    {"import",     2, ImportOp,     2, 0, "formatName args...",},
+    {"index",      2, IndexOp,      3, 0, "op args...",},
+    {"join",       1, JoinOp,       3, 0, "tableName ?switches?",},
     {"keys",       1, KeysOp,       2, 0, "?columnName ...?",},
     {"lappend",    2, LappendOp,    5, 0, "rowName columnName ?value ...?",},
     {"limits",     2, MinMaxOp,     2, 3, "?columnName?",},
@@ -9179,6 +11144,7 @@ static Blt_OpSpec tableOps[] =
     {"restore",    2, RestoreOp,    2, 0, "?switches?",},
     {"row",        2, RowOp,        3, 0, "op args...",},
     {"set",        2, SetOp,        3, 0, "?rowName columnName value ...?",},
+    {"snapshot",   2, SnapshotOp,   2, 2, "",},
     {"sort",       2, SortOp,       3, 0, "?flags ...?",},
     {"trace",      2, TraceOp,      2, 0, "op args...",},
     {"unset",      1, UnsetOp,      4, 0, "?rowName columnName ...?",},
@@ -9229,6 +11195,14 @@ TableInstObjCmd(
     return result;
 }
 
+static void
+FreeCmdProc(DestroyData data)
+{
+    Cmd *cmdPtr = (Cmd *)data;
+
+    Blt_Free(cmdPtr);
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -9276,7 +11250,77 @@ TableInstDeleteProc(ClientData clientData)
         Blt_DeleteHashEntry(cmdPtr->tablePtr, cmdPtr->hPtr);
     }
     blt_table_close(cmdPtr->table);
-    Blt_Free(cmdPtr);
+    cmdPtr->table = NULL;
+    /* An operation (such as "batch") may still be using the command. */
+    Tcl_EventuallyFree(cmdPtr, FreeCmdProc);
+}
+
+typedef struct {
+    int numThreads;
+} TableConfigureSwitches;
+
+static Blt_SwitchSpec tableConfigureSwitches[] = 
+{
+    {BLT_SWITCH_INT_POS, "-threads", "numThreads", (char *)NULL,
+        Blt_Offset(TableConfigureSwitches, numThreads), 0},
+    {BLT_SWITCH_END}
+};
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * TableConfigureOp --
+ *
+ *      Queries or sets options for all the tables in the interpreter.  The
+ *      -threads option is the # of threads used to sort and scan large
+ *      tables.  The default is 1, meaning no worker threads.
+ *      
+ * Results:
+ *      A standard TCL result.  If no options are given, a list of the
+ *      options and their values is returned.  If one option is given, its
+ *      value is returned.
+ *
+ *      blt::datatable configure ?option value ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+TableConfigureOp(ClientData clientData, Tcl_Interp *interp, int objc,
+                 Tcl_Obj *const *objv)
+{
+    TableConfigureSwitches switches;
+
+    if (objc == 2) {
+        Tcl_Obj *listObjPtr;
+
+        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        Tcl_ListObjAppendElement(interp, listObjPtr, 
+                Tcl_NewStringObj("-threads", 8));
+        Tcl_ListObjAppendElement(interp, listObjPtr, 
+                Tcl_NewIntObj(blt_table_get_threads(interp)));
+        Tcl_SetObjResult(interp, listObjPtr);
+        return TCL_OK;
+    }
+    if (objc == 3) {
+        const char *string;
+
+        string = Tcl_GetString(objv[2]);
+        if (strcmp(string, "-threads") != 0) {
+            Tcl_AppendResult(interp, "unknown option \"", string, 
+                "\": should be -threads", (char *)NULL);
+            return TCL_ERROR;
+        }
+        Tcl_SetIntObj(Tcl_GetObjResult(interp), blt_table_get_threads(interp));
+        return TCL_OK;
+    }
+    switches.numThreads = blt_table_get_threads(interp);
+    if (Blt_ParseSwitches(interp, tableConfigureSwitches, objc - 2, objv + 2, 
+                &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    blt_table_set_threads(interp, switches.numThreads);
+    return TCL_OK;
 }
 
 /*
@@ -9538,9 +11582,17 @@ TableLoadOp(ClientData clientData, Tcl_Interp *interp, int objc,
     Blt_FmtString(safeProcName, 11 + length + 9+1, "blt_table_%s_safe_init", fmt);
 
     Tcl_DStringAppend(&libName, "/", -1);
-    Tcl_UtfToTitle((char *)fmt);
     Tcl_DStringAppend(&libName, "Table", 5);
-    Tcl_DStringAppend(&libName, fmt, -1);
+    {
+        int offset;
+
+        /* Don't title-case the format name in place: the string may
+         * belong to a shared literal. */
+        offset = Tcl_DStringLength(&libName);
+        Tcl_DStringAppend(&libName, fmt, length);
+        Tcl_DStringSetLength(&libName, offset + 
+                Tcl_UtfToTitle(Tcl_DStringValue(&libName) + offset));
+    }
     Tcl_DStringAppend(&libName, Blt_Itoa(BLT_MAJOR_VERSION), 1);
     Tcl_DStringAppend(&libName, Blt_Itoa(BLT_MINOR_VERSION), 1);
     Tcl_DStringAppend(&libName, BLT_LIB_SUFFIX, -1);
@@ -9567,6 +11619,7 @@ TableLoadOp(ClientData clientData, Tcl_Interp *interp, int objc,
  */
 static Blt_OpSpec tableCmdOps[] =
 {
+    {"configure", 2, TableConfigureOp, 2, 0, "?option value ...?",},
     {"create",  1, TableCreateOp,  2, 3, "?tableName?",},
     {"destroy", 1, TableDestroyOp, 2, 0, "?tableName ...?",},
     {"exists",  1, TableExistsOp,  3, 3, "tableName",},
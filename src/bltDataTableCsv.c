@@ -62,6 +62,18 @@ DLLEXPORT extern Tcl_AppInitProc blt_table_csv_safe_init;
 #define EXPORT_ROWLABELS        (1<<0)
 #define EXPORT_COLUMNLABELS     (1<<1)
 
+#define IMPORT_INFER_TYPES      (1<<0)
+#define IMPORT_FOLLOW           (1<<1)
+
+#define IMPORT_BLOCK_SIZE       (1<<16) /* # of characters read from the
+                                         * channel at a time. */
+#define IMPORT_BATCH_SIZE       (1<<12) /* # of rows added to the table at a
+                                         * time. The first batch is also the
+                                         * sample used to infer column
+                                         * types. */
+#define IMPORT_CHUNK_SIZE       (1<<16) /* Minimum # of bytes parsed by each
+                                         * thread. */
+
 /*
  * Format       Import          Export
  * csv          file/data       file/data
@@ -97,8 +109,29 @@ typedef struct {
     size_t bytesLeft;                   /* Used for parsing data as a
                                          * single string. */
     
-    Tcl_DString currLine;               /* Dynamic string used to read the
-                                         * file line-by-line. */
+    Tcl_DString currLine;               /* Dynamic string used to hold
+                                         * the last line of the data
+                                         * string. */
+    Tcl_Obj *readObjPtr;                /* Characters read from the
+                                         * channel. */
+    char *block;                        /* Block of input read from the
+                                         * channel. Lines are parsed
+                                         * directly from the block. */
+    size_t blockSize;                   /* # of bytes allocated for the
+                                         * block. */
+    size_t blockLength;                 /* # of bytes of input in the
+                                         * block. */
+    size_t blockNext;                   /* Offset of the next line in the
+                                         * block. */
+    size_t recordStart;                 /* Offset of the first line of the
+                                         * current record in the block.
+                                         * Lines of a record are kept in
+                                         * the block until it ends. */
+    int keepBlock;                      /* If non-zero, lines already read
+                                         * are kept in the block so that
+                                         * they can be read again. */
+    int eof;                            /* Indicates the end of the
+                                         * channel was reached. */
     Tcl_Interp *interp;
     Tcl_Obj *fileObjPtr;                /* Name of file representing the
                                          * channel used as the input
@@ -115,8 +148,17 @@ typedef struct {
     Tcl_Obj *emptyValueObjPtr;          /* If non-NULL, empty value. */
     int maxRows;                        /* Stop processing after this many
                                          * rows have been found. */
+    int numThreads;                     /* # of threads used to parse the
+                                         * input. */
     const char **columnLabels;
     int nextLabel;
+    long firstNewColumn;                /* Index of the first column
+                                         * created by the import. */
+    int typesInferred;                  /* Indicates the column types have
+                                         * been inferred. */
+    Tcl_DString pending;                /* With -follow, input after the
+                                         * last complete record.  It's
+                                         * parsed by the next import. */
 } ImportArgs;
 
 static Blt_SwitchSpec importSwitches[] = 
@@ -133,6 +175,10 @@ static Blt_SwitchSpec importSwitches[] =
         Blt_Offset(ImportArgs, encodingObjPtr), 0, 0, NULL},
     {BLT_SWITCH_OBJ,    "-file",      "fileName", (char *)NULL,
         Blt_Offset(ImportArgs, fileObjPtr), 0},
+    {BLT_SWITCH_BITS_NOARG, "-follow", "", (char *)NULL,
+        Blt_Offset(ImportArgs, flags), 0, IMPORT_FOLLOW},
+    {BLT_SWITCH_BITS_NOARG, "-infertypes", "", (char *)NULL,
+        Blt_Offset(ImportArgs, flags), 0, IMPORT_INFER_TYPES},
     {BLT_SWITCH_INT_NNEG, "-maxrows", "numRows", (char *)NULL,
         Blt_Offset(ImportArgs, maxRows), 0},
     {BLT_SWITCH_STRING, "-possibleseparators", "string", (char *)NULL,
@@ -141,6 +187,8 @@ static Blt_SwitchSpec importSwitches[] =
         Blt_Offset(ImportArgs, reqQuote), 0},
     {BLT_SWITCH_STRING, "-separator", "char", (char *)NULL,
         Blt_Offset(ImportArgs, reqSeparator), 0},
+    {BLT_SWITCH_INT_POS, "-threads", "numThreads", (char *)NULL,
+        Blt_Offset(ImportArgs, numThreads), 0},
     {BLT_SWITCH_END}
 };
 
@@ -427,6 +475,20 @@ ExportCsvRows(BLT_TABLE table, ExportArgs *exportPtr)
             BLT_TABLE_COLUMN_TYPE type;
                 
             type = blt_table_column_type(col);
+            if (blt_table_column_is_packed(col)) {
+                Tcl_Obj *objPtr;
+
+                /* Packed columns don't store strings.  Format the value
+                 * rather than unpacking the column. */
+                objPtr = blt_table_get_obj(table, row, col);
+                if (objPtr != NULL) {
+                    Tcl_IncrRefCount(objPtr);
+                    AppendCsvRecord(exportPtr, Tcl_GetString(objPtr), -1,
+                                    type);
+                    Tcl_DecrRefCount(objPtr);
+                    continue;
+                }
+            }
             string = blt_table_get_string(table, row, col);
             AppendCsvRecord(exportPtr, string, -1, type);
         }
@@ -559,6 +621,53 @@ IsEmpty(ImportArgs *importPtr, const char *field, size_t count)
     return (length == 0);               /* Check if count==length==0 */
 }
 
+/* 
+ * ReadBlock -- 
+ *
+ *      Reads the next block of characters from the channel and appends
+ *      them to the block.  Lines of records already parsed are discarded
+ *      first, unless they are being kept to be read again.
+ *
+ */
+static int
+ReadBlock(Tcl_Interp *interp, ImportArgs *importPtr)
+{
+    const char *bytes;
+    int numChars, numBytes;
+
+    if ((!importPtr->keepBlock) && (importPtr->recordStart > 0)) {
+        importPtr->blockLength -= importPtr->recordStart;
+        memmove(importPtr->block, importPtr->block + importPtr->recordStart,
+                importPtr->blockLength);
+        importPtr->blockNext -= importPtr->recordStart;
+        importPtr->recordStart = 0;
+    }
+    numChars = Tcl_ReadChars(importPtr->channel, importPtr->readObjPtr, 
+                IMPORT_BLOCK_SIZE, 0);
+    if (numChars < 0) {
+        Tcl_AppendResult(interp, "error reading file: ", 
+                         Tcl_PosixError(interp), (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (numChars == 0) {
+        importPtr->eof = TRUE;
+        return TCL_OK;
+    }
+    bytes = Tcl_GetStringFromObj(importPtr->readObjPtr, &numBytes);
+    if ((importPtr->blockLength + numBytes + 1) > importPtr->blockSize) {
+        importPtr->blockSize = importPtr->blockLength + numBytes + 1;
+        if (importPtr->blockSize < IMPORT_BLOCK_SIZE) {
+            importPtr->blockSize = IMPORT_BLOCK_SIZE;
+        }
+        importPtr->blockSize += importPtr->blockSize / 2;
+        importPtr->block = Blt_AssertRealloc(importPtr->block, 
+                importPtr->blockSize);
+    }
+    memcpy(importPtr->block + importPtr->blockLength, bytes, numBytes);
+    importPtr->blockLength += numBytes;
+    return TCL_OK;
+}
+
 /* 
  * ImportGetLine -- 
  *
@@ -567,34 +676,43 @@ IsEmpty(ImportArgs *importPtr, const char *field, size_t count)
  *      the end of a row or in a quoted field.  So the resulting line
  *      always contains a new line unless an error occurs or we hit EOF.
  *
+ *      Files are read a block at a time.  The line points into the block
+ *      and is valid until the next line is read.
+ *
  */
 static int
 ImportGetLine(Tcl_Interp *interp, ImportArgs *importPtr, const char **bufferPtr,
               size_t *numBytesPtr)
 {
     if (importPtr->channel != NULL) {
-        int numChars;
-
-        if (Tcl_Eof(importPtr->channel)) {
-            *numBytesPtr = 0;
-            return TCL_OK;
-        }
-        Tcl_DStringSetLength(&importPtr->currLine, 0);
-        numChars = Tcl_Gets(importPtr->channel, &importPtr->currLine);
-        if (numChars < 0) {
-            if (Tcl_Eof(importPtr->channel)) {
-                *numBytesPtr = 0;
+        for (;;) {
+            const char *bp, *bend, *eol;
+
+            bp = importPtr->block + importPtr->blockNext;
+            bend = importPtr->block + importPtr->blockLength;
+            eol = (bp < bend) ? memchr(bp, '\n', bend - bp) : NULL;
+            if (eol != NULL) {
+                *bufferPtr = bp;
+                *numBytesPtr = eol - bp + 1;
+                importPtr->blockNext += *numBytesPtr;
                 return TCL_OK;
             }
-            *numBytesPtr = numChars;
-            Tcl_AppendResult(interp, "error reading file: ", 
-                             Tcl_PosixError(interp), (char *)NULL);
-            return TCL_ERROR;
+            if (importPtr->eof) {
+                if ((bp == bend) || (importPtr->flags & IMPORT_FOLLOW)) {
+                    /* With -follow, the last line may still be being
+                     * written.  Leave it for the next import. */
+                    *numBytesPtr = 0;   /* EOF */
+                    return TCL_OK;
+                }
+                /* Put back the newline missing from the last line. There's
+                 * always room for one more byte in the block. */
+                importPtr->block[importPtr->blockLength++] = '\n';
+                continue;
+            }
+            if (ReadBlock(interp, importPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
         }
-        /* Put back the newline. */
-        Tcl_DStringAppend(&importPtr->currLine, "\n", 1);
-        *numBytesPtr = Tcl_DStringLength(&importPtr->currLine);
-        *bufferPtr = Tcl_DStringValue(&importPtr->currLine);
     } else {
         const char *bp, *bend;
         ssize_t delta;
@@ -637,16 +755,14 @@ GuessSeparator(Tcl_Interp *interp, int maxRows, ImportArgs *importPtr)
 {
     int charCounts[10];
     int i, numSeparators;
-    off_t pos;
     const char defSepTokens[] = { ",\t|;" };
     const char *sepTokens;
 
     sepTokens = (importPtr->testSeparators != NULL) ? 
         importPtr->testSeparators : defSepTokens;
-    pos = 0;                            /* Suppress compiler warning. */
-    if (importPtr->channel != NULL) {
-        pos = Tcl_Tell(importPtr->channel);
-    } 
+    /* Keep the lines read from the channel in the block, so that they
+     * can be parsed again. */
+    importPtr->keepBlock = TRUE;
     numSeparators = strlen(sepTokens);
     if (numSeparators > 10) {
         numSeparators = 10;
@@ -655,27 +771,30 @@ GuessSeparator(Tcl_Interp *interp, int maxRows, ImportArgs *importPtr)
         charCounts[i] = 0;
     }
     for (i = 0; i < importPtr->maxRows; i++) {
-        const char *bp, *bend;
+        const char *line, *bp, *bend;
         size_t numBytes;
-        int result;
+        int j, result;
         
-        result = ImportGetLine(interp, importPtr, &bp, &numBytes);
+        result = ImportGetLine(interp, importPtr, &line, &numBytes);
         if (result != TCL_OK) {
             return TCL_ERROR;           /* I/O Error. */
         }
         if (numBytes == 0) {
             break;                      /* EOF */
         }
-        for (i = 0; i < numSeparators; i++) {
-            for (bend = bp + numBytes; bp < bend; bp++) {
-                if (*bp == sepTokens[i]) {
-                    charCounts[i]++;
+        bend = line + numBytes;
+        for (j = 0; j < numSeparators; j++) {
+            /* Rescan the line from its start for each separator. */
+            for (bp = line; bp < bend; bp++) {
+                if (*bp == sepTokens[j]) {
+                    charCounts[j]++;
                 }
             }
         }
     }
     if (importPtr->channel != NULL) {
-        Tcl_Seek(importPtr->channel, pos, SEEK_SET);
+        importPtr->keepBlock = FALSE;
+        importPtr->blockNext = 0;
     } else {
         importPtr->next = importPtr->buffer;
         importPtr->bytesLeft = importPtr->numBytes;
@@ -711,224 +830,874 @@ GetNextLabel(ImportArgs *importPtr)
     return label;
 }
 
+/*
+ * ImportBatch --
+ *
+ *      Fields parsed from the input are collected into batches of rows.
+ *      The rows of a batch are added to the table at once and the fields
+ *      set column by column.
+ */
+typedef struct {
+    long row;                           /* Row of the field in the
+                                         * batch. */
+    long column;                        /* Column index of the field. */
+    size_t offset;                      /* Offset of the field in the
+                                         * heap. */
+    int length;                         /* # of bytes in the field. */
+} ImportField;
+
+typedef struct {
+    ImportField *fields;                /* Array of fields in the batch. */
+    size_t numFields, numAllocated;
+    Tcl_DString heap;                   /* Holds the bytes of the
+                                         * fields. */
+    long numRows;                       /* # of rows in the batch. */
+    long numColumns;                    /* # of columns needed for the
+                                         * batch. */
+} ImportBatch;
+
+static void
+AddField(ImportBatch *batchPtr, long column, const char *field, int length)
+{
+    ImportField *fieldPtr;
+
+    if (batchPtr->numFields == batchPtr->numAllocated) {
+        batchPtr->numAllocated += batchPtr->numAllocated;
+        if (batchPtr->numAllocated == 0) {
+            batchPtr->numAllocated = 1024;
+        }
+        batchPtr->fields = Blt_AssertRealloc(batchPtr->fields, 
+                batchPtr->numAllocated * sizeof(ImportField));
+    }
+    fieldPtr = batchPtr->fields + batchPtr->numFields;
+    fieldPtr->row = batchPtr->numRows - 1;
+    fieldPtr->column = column;
+    fieldPtr->offset = Tcl_DStringLength(&batchPtr->heap);
+    fieldPtr->length = length;
+    Tcl_DStringAppend(&batchPtr->heap, field, length);
+    batchPtr->numFields++;
+}
+
+/*
+ * InferColumnType --
+ *
+ *      Guesses the type of a column from the fields in the sample.  The
+ *      column is "long" if every field is an integer, "double" if every
+ *      field is a number, and otherwise "string".
+ */
+static BLT_TABLE_COLUMN_TYPE
+InferColumnType(size_t numFields, const char **strings, const int *lengths)
+{
+    BLT_TABLE_COLUMN_TYPE type;
+    size_t i;
+
+    if (numFields == 0) {
+        return TABLE_COLUMN_TYPE_STRING;
+    }
+    type = TABLE_COLUMN_TYPE_LONG;
+    for (i = 0; i < numFields; i++) {
+        char buffer[64];
+        double d;
+        long l;
+
+        if ((lengths[i] == 0) || (lengths[i] >= (int)sizeof(buffer))) {
+            return TABLE_COLUMN_TYPE_STRING;
+        }
+        memcpy(buffer, strings[i], lengths[i]);
+        buffer[lengths[i]] = '\0';
+        if ((type == TABLE_COLUMN_TYPE_LONG) &&
+            (Blt_GetLong(NULL, buffer, &l) == TCL_OK)) {
+            continue;
+        }
+        if (Blt_GetDouble(NULL, buffer, &d) != TCL_OK) {
+            return TABLE_COLUMN_TYPE_STRING;
+        }
+        type = TABLE_COLUMN_TYPE_DOUBLE;
+    }
+    return type;
+}
+
+/*
+ * FlushBatch --
+ *
+ *      Adds the rows of the batch to the table and sets the fields.  If
+ *      the column types are inferred, a column that gets a value that
+ *      doesn't match the inferred type is changed back to "string".
+ */
 static int
-ImportCsv(Tcl_Interp *interp, BLT_TABLE table, ImportArgs *importPtr)
+FlushBatch(Tcl_Interp *interp, BLT_TABLE table, ImportArgs *importPtr, 
+           ImportBatch *batchPtr)
 {
-    Tcl_DString ds;
-    char *fp, *field;
-    int fieldSize;
-    int inQuotes, isQuoted, isPath;
+    BLT_TABLE_ROW *rows, *fieldRows;
+    const char **strings;
+    int *lengths;
+    size_t *starts;
+    size_t i;
+    long c;
     int result;
-    long i;
-    BLT_TABLE_ROW row;
-    BLT_TABLE_COLUMN col;
 
+    if (batchPtr->numRows == 0) {
+        return TCL_OK;
+    }
     result = TCL_ERROR;
-    isPath = isQuoted = inQuotes = FALSE;
-    row = NULL;
-    i = 0;
-    Tcl_DStringInit(&ds);
-    fieldSize = 128;
-    Tcl_DStringSetLength(&ds, fieldSize + 1);
-    fp = field = Tcl_DStringValue(&ds);
-    for (;;) {
-        const char *bp, *bend;
-        size_t numBytes;
+    rows = Blt_AssertMalloc(batchPtr->numRows * sizeof(BLT_TABLE_ROW));
+    starts = Blt_AssertCalloc(batchPtr->numColumns + 1, sizeof(size_t));
+    fieldRows = Blt_AssertMalloc((batchPtr->numFields + 1) * 
+                                 sizeof(BLT_TABLE_ROW));
+    strings = Blt_AssertMalloc((batchPtr->numFields + 1) * sizeof(char *));
+    lengths = Blt_AssertMalloc((batchPtr->numFields + 1) * sizeof(int));
+    if (blt_table_extend_rows(interp, table, batchPtr->numRows, rows) 
+        != TCL_OK) {
+        goto error;
+    }
+    while (blt_table_num_columns(table) < batchPtr->numColumns) {
+        BLT_TABLE_COLUMN col;
+        const char *label;
 
-        result = ImportGetLine(interp, importPtr, &bp, &numBytes);
-        if (result != TCL_OK) {
-            goto error;                 /* I/O Error. */
+        if (blt_table_extend_columns(interp, table, 1, &col) != TCL_OK) {
+            goto error;
         }
-        if (numBytes == 0) {
-            break;                      /* EOF */
+        label = GetNextLabel(importPtr);
+        if ((label != NULL) && 
+            (blt_table_set_column_label(interp, table, col, label) 
+             != TCL_OK)) {
+            goto error;
+        }
+    }
+
+    /* Sort the fields by column, keeping them in row order. */
+    for (i = 0; i < batchPtr->numFields; i++) {
+        starts[batchPtr->fields[i].column + 1]++;
+    }
+    for (c = 0; c < batchPtr->numColumns; c++) {
+        starts[c + 1] += starts[c];
+    }
+    for (i = 0; i < batchPtr->numFields; i++) {
+        ImportField *fieldPtr;
+        size_t j;
+
+        fieldPtr = batchPtr->fields + i;
+        j = starts[fieldPtr->column]++;
+        fieldRows[j] = rows[fieldPtr->row];
+        strings[j] = Tcl_DStringValue(&batchPtr->heap) + fieldPtr->offset;
+        lengths[j] = fieldPtr->length;
+    }
+    for (c = batchPtr->numColumns; c > 0; c--) {
+        starts[c] = starts[c - 1];
+    }
+    starts[0] = 0;
+
+    for (c = 0; c < batchPtr->numColumns; c++) {
+        BLT_TABLE_COLUMN col;
+        size_t first, count;
+        int isInferred;
+
+        first = starts[c];
+        count = starts[c + 1] - first;
+        col = blt_table_column(table, c);
+        isInferred = ((importPtr->flags & IMPORT_INFER_TYPES) && 
+                      (c >= importPtr->firstNewColumn));
+        if ((isInferred) && (!importPtr->typesInferred)) {
+            if (blt_table_set_column_type(interp, table, col, 
+                InferColumnType(count, strings + first, lengths + first))
+                != TCL_OK) {
+                goto error;
+            }
         }
-        bend = bp + numBytes;
-        while ((bp < bend) && (isspace(*bp)) && (!IsSeparator(importPtr, *bp))){
-            bp++;                       /* Skip leading spaces. */
+        if (count == 0) {
+            continue;
         }
-        if ((*bp == '\0') || (*bp == importPtr->commentChar)) {
-            continue;                   /* Ignore blank or comment lines */
+        if (blt_table_set_string_reps(interp, table, col, count, 
+                fieldRows + first, strings + first, lengths + first) 
+            != TCL_OK) {
+            if ((!isInferred) || 
+                (blt_table_column_type(col) == TABLE_COLUMN_TYPE_STRING)) {
+                goto error;
+            }
+            Tcl_ResetResult(interp);
+            if ((blt_table_set_column_type(interp, table, col, 
+                        TABLE_COLUMN_TYPE_STRING) != TCL_OK) ||
+                (blt_table_set_string_reps(interp, table, col, count, 
+                        fieldRows + first, strings + first, lengths + first) 
+                 != TCL_OK)) {
+                goto error;
+            }
         }
-        for (/*empty*/; bp < bend; bp++) {
-            if ((IsSeparator(importPtr, *bp)) || (*bp == '\n')) {
-                if (inQuotes) {
-                    *fp++ = *bp;        /* Copy the separator or newline. */
-                } else {
-                    BLT_TABLE_COLUMN col;
-                    char *last;
-
-                    if ((isPath) && (IsSeparator(importPtr, *bp)) && 
-                        (fp != field) && (*(fp - 1) != '\\')) {
-                        *fp++ = *bp;    /* Copy the separator or newline. */
-                        goto currLine;
-                    }    
-                    /* "last" points to the character after the last character
-                     * in the field. */
-                    last = fp;  
-
-                    /* Remove trailing spaces only if the field wasn't
-                     * quoted. */
-                    if ((!isQuoted) && (!isPath)) {
-                        while ((last > field) && (isspace(*(last - 1)))) {
-                            last--;
-                        }
-                    }
-                    if (row == NULL) {
-                        if ((*bp == '\n') &&  (fp == field)) {
-                            goto currLine;  /* Ignore empty lines. */
-                        }
-                        if (blt_table_extend_rows(interp, table, 1, &row) 
-                            != TCL_OK) {
-                            goto error;
-                        }
-                        if ((importPtr->maxRows > 0) && 
-                            (blt_table_num_rows(table) > importPtr->maxRows)) {
-                            bp = bend;
-                            goto currLine;
-                        }
+    }
+    importPtr->typesInferred = TRUE;
+    batchPtr->numRows = 0;
+    batchPtr->numFields = 0;
+    Tcl_DStringSetLength(&batchPtr->heap, 0);
+    result = TCL_OK;
+ error:
+    Blt_Free(rows);
+    Blt_Free(starts);
+    Blt_Free(fieldRows);
+    Blt_Free(strings);
+    Blt_Free(lengths);
+    return result;
+}
+
+#define ONES    ((uint64_t)0x0101010101010101ULL)
+#define HIGHS   ((uint64_t)0x8080808080808080ULL)
+#define HasZeroByte(w)  (((w) - ONES) & ~(w) & HIGHS)
+
+/*
+ * ScanToSpecial --
+ *
+ *      Returns a pointer to the first of the three characters in the
+ *      buffer, or the end of the buffer.  Eight bytes are tested at a time.
+ */
+static INLINE const char *
+ScanToSpecial(const char *bp, const char *bend, unsigned char c1, 
+              unsigned char c2, unsigned char c3)
+{
+    uint64_t m1, m2, m3;
+
+    m1 = ONES * c1, m2 = ONES * c2, m3 = ONES * c3;
+    while ((bend - bp) >= 8) {
+        uint64_t w;
+
+        memcpy(&w, bp, 8);
+        if (HasZeroByte(w ^ m1) | HasZeroByte(w ^ m2) | HasZeroByte(w ^ m3)) {
+            break;
+        }
+        bp += 8;
+    }
+    while ((bp < bend) && (*bp != (char)c1) && (*bp != (char)c2) && 
+           (*bp != (char)c3)) {
+        bp++;
+    }
+    return bp;
+}
+
+/*
+ * ImportParser --
+ *
+ *      State of the parser between lines.  A field may continue over
+ *      several lines if it's quoted.
+ */
+typedef struct {
+    Tcl_DString ds;                     /* Holds the current field. */
+    char *field;                        /* Start of the current field. */
+    char *fp;                           /* Next character in the field. */
+    int fieldSize;                      /* # of bytes available for the
+                                         * field. */
+    int inQuotes, isQuoted, isPath;
+    int inRow;                          /* Indicates a row has been started
+                                         * for the current line. */
+    long column;                        /* Index of the current field in
+                                         * the row. */
+    ImportBatch batch;                  /* Rows parsed but not yet added to
+                                         * the table. */
+    const char *markLine;               /* First line of the current
+                                         * record. */
+    size_t markFields, markHeap;        /* Size of the batch at the start
+                                         * of the current record. */
+    long markRows, markColumns;
+} ImportParser;
+
+static void
+InitParser(ImportParser *parserPtr)
+{
+    memset(parserPtr, 0, sizeof(ImportParser));
+    Tcl_DStringInit(&parserPtr->batch.heap);
+    Tcl_DStringInit(&parserPtr->ds);
+    parserPtr->fieldSize = 128;
+    Tcl_DStringSetLength(&parserPtr->ds, parserPtr->fieldSize + 1);
+    parserPtr->fp = parserPtr->field = Tcl_DStringValue(&parserPtr->ds);
+}
+
+/*
+ * MarkParser --
+ *
+ *      Remembers the state of the batch at the start of a record, so that
+ *      a record left unfinished at the end of the input can be removed.
+ */
+static INLINE void
+MarkParser(ImportParser *parserPtr, const char *line)
+{
+    parserPtr->markLine = line;
+    parserPtr->markFields = parserPtr->batch.numFields;
+    parserPtr->markHeap = Tcl_DStringLength(&parserPtr->batch.heap);
+    parserPtr->markRows = parserPtr->batch.numRows;
+    parserPtr->markColumns = parserPtr->batch.numColumns;
+}
+
+static void
+RewindParser(ImportParser *parserPtr)
+{
+    parserPtr->batch.numFields = parserPtr->markFields;
+    Tcl_DStringSetLength(&parserPtr->batch.heap, parserPtr->markHeap);
+    parserPtr->batch.numRows = parserPtr->markRows;
+    parserPtr->batch.numColumns = parserPtr->markColumns;
+    parserPtr->fp = parserPtr->field;
+    parserPtr->inQuotes = parserPtr->isQuoted = parserPtr->isPath = FALSE;
+    parserPtr->inRow = FALSE;
+    parserPtr->column = 0;
+}
+
+static void
+FreeParser(ImportParser *parserPtr)
+{
+    Tcl_DStringFree(&parserPtr->ds);
+    Tcl_DStringFree(&parserPtr->batch.heap);
+    if (parserPtr->batch.fields != NULL) {
+        Blt_Free(parserPtr->batch.fields);
+    }
+}
+
+/*
+ * ParseLine --
+ *
+ *      Parses a single line of CSV data, adding the fields to the parser's
+ *      batch.  The line always ends with a newline.  If maxRows is
+ *      non-negative, no more than maxRows rows are started in the batch.
+ *      Returns TRUE if the line would have started a row past maxRows.
+ */
+static int
+ParseLine(ImportArgs *importPtr, ImportParser *parserPtr, const char *bp,
+          const char *bend, long maxRows)
+{
+    ImportBatch *batchPtr = &parserPtr->batch;
+    char *fp, *field;
+
+    while ((bp < bend) && (isspace(*bp)) && (!IsSeparator(importPtr, *bp))){
+        bp++;                           /* Skip leading spaces. */
+    }
+    if ((*bp == '\0') || (*bp == importPtr->commentChar)) {
+        return FALSE;                   /* Ignore blank or comment lines */
+    }
+    fp = parserPtr->fp;
+    field = parserPtr->field;
+    for (/*empty*/; bp < bend; bp++) {
+        if ((fp != field) || (parserPtr->inQuotes)) {
+            const char *run;
+
+            /* 
+             * Inside of a field, only separators, newlines, and quotes are
+             * special. Inside of quotes, only quotes are. Copy the
+             * characters up to the next one in a single step.
+             */
+            if (parserPtr->inQuotes) {
+                run = ScanToSpecial(bp, bend, importPtr->quoteChar,
+                        importPtr->quoteChar, importPtr->quoteChar);
+            } else {
+                run = ScanToSpecial(bp, bend, importPtr->separatorChar,
+                        '\n', importPtr->quoteChar);
+            }
+            if (run > bp) {
+                int offset;
+
+                offset = fp - field;
+                if ((offset + (run - bp)) >= parserPtr->fieldSize) {
+                    while ((offset + (run - bp)) >= parserPtr->fieldSize) {
+                        parserPtr->fieldSize += parserPtr->fieldSize;
                     }
-                    /* End of field. Append field to row. */
-                    if (i >= blt_table_num_columns(table)) {
-                        const char *label;
-                        
-                        if (blt_table_extend_columns(interp, table, 1, &col) 
-                            != TCL_OK) {
-                            goto error;
-                        }
-                        label = GetNextLabel(importPtr);
-                        if ((label != NULL) && 
-                            (blt_table_set_column_label(interp, table, col,
-                                                        label) != TCL_OK)) {
-                            goto error;
-                        }
-                    } else {
-                        col = blt_table_column(table, i);
+                    Tcl_DStringSetLength(&parserPtr->ds, 
+                                         parserPtr->fieldSize + 1);
+                    field = Tcl_DStringValue(&parserPtr->ds);
+                    fp = field + offset;
+                }
+                memcpy(fp, bp, run - bp);
+                fp += run - bp;
+                bp = run;
+                if (bp == bend) {
+                    break;
+                }
+            }
+        }
+        if ((IsSeparator(importPtr, *bp)) || (*bp == '\n')) {
+            if (parserPtr->inQuotes) {
+                *fp++ = *bp;            /* Copy the separator or newline. */
+            } else {
+                char *last;
+
+                if ((parserPtr->isPath) && (IsSeparator(importPtr, *bp)) && 
+                    (fp != field) && (*(fp - 1) != '\\')) {
+                    *fp++ = *bp;        /* Copy the separator or newline. */
+                    goto currLine;
+                }    
+                /* "last" points to the character after the last character
+                 * in the field. */
+                last = fp;  
+
+                /* Remove trailing spaces only if the field wasn't
+                 * quoted. */
+                if ((!parserPtr->isQuoted) && (!parserPtr->isPath)) {
+                    while ((last > field) && (isspace(*(last - 1)))) {
+                        last--;
                     }
-                    if (((last > field) || (isQuoted)) && 
-                        (!IsEmpty(importPtr, field, last - field))) {
-                        if (blt_table_set_string_rep(interp, table, row, col,
-                                field, last - field) != TCL_OK) {             
-                            goto error;
-                        }
+                }
+                if (!parserPtr->inRow) {
+                    if ((*bp == '\n') &&  (fp == field)) {
+                        goto currLine;  /* Ignore empty lines. */
                     }
-                    i++;
-                    if (*bp == '\n') {
-                        row = NULL;
-                        i = 0;
+                    if ((maxRows >= 0) && (batchPtr->numRows >= maxRows)) {
+                        parserPtr->fp = fp;
+                        parserPtr->field = field;
+                        return TRUE;
                     }
-                    fp = field;
-                    isPath = isQuoted = FALSE;
+                    parserPtr->inRow = TRUE;
+                    batchPtr->numRows++;
                 }
-            currLine:
-                if ((importPtr->maxRows > 0) && 
-                    (blt_table_num_rows(table) > importPtr->maxRows)) {
-                    break;
+                /* End of field. Append field to row. */
+                if (parserPtr->column >= batchPtr->numColumns) {
+                    batchPtr->numColumns = parserPtr->column + 1;
                 }
-                ;
-            } else if ((*bp == ' ') || (*bp == '\t')) {
-                /* 
-                 * Include whitespace in the field only if it's not leading or
-                 * we're inside of quotes or a path.
-                 */
-                if ((fp != field) || (inQuotes) || (isPath)) {
-                    *fp++ = *bp; 
+                if (((last > field) || (parserPtr->isQuoted)) && 
+                    (!IsEmpty(importPtr, field, last - field))) {
+                    AddField(batchPtr, parserPtr->column, field, last - field);
                 }
-            } else if (*bp == '\\') {
-                /* 
-                 * Handle special case CSV files that allow unquoted paths.
-                 * Example:  ...,\this\path " should\have been\quoted\,...
-                 */
-                if (fp == field) {
-                    isPath = TRUE; 
+                parserPtr->column++;
+                if (*bp == '\n') {
+                    parserPtr->inRow = FALSE;
+                    parserPtr->column = 0;
                 }
-                *fp++ = *bp;
-            } else if (*bp == importPtr->quoteChar ) {
-                if (inQuotes) {
-                    if (*(bp+1) == importPtr->quoteChar) {
-                        *fp++ = importPtr->quoteChar;
-                        bp++;
-                    } else {
-                        inQuotes = FALSE;
-                    }
+                fp = field;
+                parserPtr->isPath = parserPtr->isQuoted = FALSE;
+            }
+        currLine:
+            ;
+        } else if ((*bp == ' ') || (*bp == '\t')) {
+            /* 
+             * Include whitespace in the field only if it's not leading or
+             * we're inside of quotes or a path.
+             */
+            if ((fp != field) || (parserPtr->inQuotes) || (parserPtr->isPath)) {
+                *fp++ = *bp; 
+            }
+        } else if (*bp == '\\') {
+            /* 
+             * Handle special case CSV files that allow unquoted paths.
+             * Example:  ...,\this\path " should\have been\quoted\,...
+             */
+            if (fp == field) {
+                parserPtr->isPath = TRUE; 
+            }
+            *fp++ = *bp;
+        } else if (*bp == importPtr->quoteChar ) {
+            if (parserPtr->inQuotes) {
+                if (*(bp+1) == importPtr->quoteChar) {
+                    *fp++ = importPtr->quoteChar;
+                    bp++;
                 } else {
-                    /* 
-                     * If the quote doesn't start a field, then treat all
-                     * quotes in the field as ordinary characters.
-                     */
-                    if (fp == field) {
-                        isQuoted = inQuotes = TRUE; 
-                    } else {
-                        *fp++ = *bp;
-                    }
+                    parserPtr->inQuotes = FALSE;
                 }
             } else {
-                *fp++ = *bp;    /* Copy the character. */
-            }
-            if ((fp - field) >= fieldSize) {
-                int offset;
-
                 /* 
-                 * We've exceeded the current maximum size of the field.
-                 * Double the size of the field, but make sure to reset the
-                 * pointers to the (possibly) new memory location.
+                 * If the quote doesn't start a field, then treat all
+                 * quotes in the field as ordinary characters.
                  */
-                offset = fp - field;
-                fieldSize += fieldSize;
-                Tcl_DStringSetLength(&ds, fieldSize + 1);
-                field = Tcl_DStringValue(&ds);
-                fp = field + offset;
+                if (fp == field) {
+                    parserPtr->isQuoted = parserPtr->inQuotes = TRUE; 
+                } else {
+                    *fp++ = *bp;
+                }
             }
+        } else {
+            *fp++ = *bp;        /* Copy the character. */
         }
-        if (numBytes < 1) {
+        if ((fp - field) >= parserPtr->fieldSize) {
+            int offset;
+
             /* 
-             * We're reached the end of input. But there may not have been a
-             * final newline to trigger the final append. So check if a last
-             * field is still needs appending the the last row.
+             * We've exceeded the current maximum size of the field.
+             * Double the size of the field, but make sure to reset the
+             * pointers to the (possibly) new memory location.
              */
-            if (fp != field) {
-                char *last;
-                const char *label;
+            offset = fp - field;
+            parserPtr->fieldSize += parserPtr->fieldSize;
+            Tcl_DStringSetLength(&parserPtr->ds, parserPtr->fieldSize + 1);
+            field = Tcl_DStringValue(&parserPtr->ds);
+            fp = field + offset;
+        }
+    }
+    parserPtr->fp = fp;
+    parserPtr->field = field;
+    return FALSE;
+}
 
-                last = fp;
-                /* Remove trailing spaces */
-                while (isspace(*(last - 1))) {
-                    last--;
-                }
-                if (row == NULL) {
-                    if (blt_table_extend_rows(interp, table, 1, &row) != TCL_OK){
-                        goto error;
-                    }
-                }
-                col = blt_table_get_column_by_index(table, i);
-                if (col == NULL) {
-                    if (blt_table_extend_columns(interp, table, 1, &col) 
-                        != TCL_OK) {
-                        goto error;
-                    }
-                }                       
-                label = GetNextLabel(importPtr);
-                if ((label != NULL) &&
-                    (blt_table_set_column_label(interp, table, col,
-                                                label) != TCL_OK)) {
-                    goto error;
-                }
-                if (((last > field) || (isQuoted)) && 
-                    (!IsEmpty(importPtr, field, last - field))) {
-                    if (blt_table_set_string(interp, table, row, col, field, 
-                        last - field) != TCL_OK) {
-                        goto error;
-                    }
-                }               
-            }    
-            break;
+/*
+ * ImportChunk --
+ *
+ *      Part of the input parsed by a single thread.  The chunk starts at
+ *      the beginning of a line.  It's assumed that the line also starts a
+ *      row, which is true unless the previous chunk ends inside of a quoted
+ *      field.  The chunk is parsed up to the first line at or after "end"
+ *      that doesn't continue a quoted field.
+ */
+typedef struct {
+    const char *start;                  /* First line of the chunk. */
+    const char *end;                    /* Start of the next chunk. */
+    const char *next;                   /* Line after the last line
+                                         * parsed. */
+    ImportParser parser;
+} ImportChunk;
+
+typedef struct {
+    ImportArgs *importPtr;
+    ImportChunk *chunks;
+    const char *bend;                   /* End of the input. The input
+                                         * always ends with a newline. */
+} ImportChunks;
+
+static void
+ParseChunk(ImportArgs *importPtr, ImportChunk *chunkPtr, const char *bend)
+{
+    const char *bp;
+
+    bp = chunkPtr->start;
+    while (bp < bend) {
+        const char *eol;
+
+        if (!chunkPtr->parser.inQuotes) {
+            if (bp >= chunkPtr->end) {
+                break;
+            }
+            MarkParser(&chunkPtr->parser, bp);
         }
+        eol = memchr(bp, '\n', bend - bp);
+        ParseLine(importPtr, &chunkPtr->parser, bp, eol + 1, -1);
+        bp = eol + 1;
     }
+    chunkPtr->next = bp;
+}
+
+static void
+ParseChunksProc(ClientData clientData, long first, long last, int worker)
+{
+    ImportChunks *chunksPtr = clientData;
+    long i;
+
+    for (i = first; i < last; i++) {
+        ParseChunk(chunksPtr->importPtr, chunksPtr->chunks + i, 
+                   chunksPtr->bend);
+    }
+}
+
+/*
+ * ImportChunked --
+ *
+ *      Parses the rest of the input with several threads.  The input is
+ *      split into chunks at line boundaries.  Each chunk is parsed into its
+ *      own batch.  The batches are then added to the table in order.  If a
+ *      quoted field crosses into the next chunk, that chunk started in the
+ *      wrong state: it's parsed again from where the previous chunk ended.
+ *      The result is the same as parsing the input serially.
+ *
+ *      With -follow, the input after the last complete record is saved
+ *      as pending instead.
+ */
+static int
+ImportChunked(Tcl_Interp *interp, BLT_TABLE table, ImportArgs *importPtr, 
+              int numThreads)
+{
+    ImportChunks chunks;
+    char *buffer;
+    const char *bp, *bend, *rest, *tail;
+    size_t length;
+    long i, numChunks;
+    int result;
+
+    /* Collect the rest of the input into a single buffer ending with a
+     * newline. */
+    if (importPtr->channel != NULL) {
+        importPtr->keepBlock = TRUE;
+        while (!importPtr->eof) {
+            if (ReadBlock(interp, importPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+        bp = importPtr->block + importPtr->blockNext;
+        length = importPtr->blockLength - importPtr->blockNext;
+    } else {
+        bp = importPtr->next;
+        length = importPtr->bytesLeft;
+    }
+    buffer = Blt_AssertMalloc(length + 2);
+    memcpy(buffer, bp, length);
+    tail = buffer + length;
+    if (importPtr->flags & IMPORT_FOLLOW) {
+        /* Leave the last line for the next import if it's unfinished. */
+        while ((length > 0) && (buffer[length - 1] != '\n')) {
+            length--;
+        }
+    } else {
+        if ((length > 0) && (buffer[length - 1] != '\n')) {
+            buffer[length++] = '\n';
+        }
+        buffer[length] = '\0';
+        tail = buffer + length;
+    }
+    rest = bend = buffer + length;
+
+    numChunks = length / IMPORT_CHUNK_SIZE;
+    if (numChunks > numThreads) {
+        numChunks = numThreads;
+    }
+    if (numChunks < 1) {
+        numChunks = 1;
+    }
+    chunks.importPtr = importPtr;
+    chunks.bend = bend;
+    chunks.chunks = Blt_AssertMalloc(numChunks * sizeof(ImportChunk));
+    for (i = 0; i < numChunks; i++) {
+        ImportChunk *chunkPtr;
+
+        chunkPtr = chunks.chunks + i;
+        InitParser(&chunkPtr->parser);
+        chunkPtr->start = chunkPtr->end = bend;
+        if (i == 0) {
+            chunkPtr->start = buffer;
+        } else {
+            const char *eol;
+            
+            bp = buffer + (length * i / numChunks) - 1;
+            if (bp < chunkPtr[-1].start) {
+                bp = chunkPtr[-1].start;
+            }
+            eol = memchr(bp, '\n', bend - bp);
+            chunkPtr->start = eol + 1;
+            chunkPtr[-1].end = chunkPtr->start;
+        }
+    }
+    /* Make sure the empty value string is generated before the threads
+     * share it. */
+    if (importPtr->emptyValueObjPtr != NULL) {
+        Tcl_GetString(importPtr->emptyValueObjPtr);
+    }
+    blt_table_run_workers(numChunks, numChunks, ParseChunksProc, &chunks);
+
     result = TCL_OK;
+    bp = buffer;
+    for (i = 0; i < numChunks; i++) {
+        ImportChunk *chunkPtr;
+
+        chunkPtr = chunks.chunks + i;
+        if (chunkPtr->start != bp) {
+            /* The previous chunk ended past the start of this one. */
+            FreeParser(&chunkPtr->parser);
+            InitParser(&chunkPtr->parser);
+            chunkPtr->start = bp;
+            ParseChunk(importPtr, chunkPtr, bend);
+        }
+        bp = chunkPtr->next;
+        if (chunkPtr->parser.inQuotes) {
+            /* The input ends inside of a quoted field.  The record may
+             * still be being written. */
+            RewindParser(&chunkPtr->parser);
+            rest = chunkPtr->parser.markLine;
+        }
+        if (result == TCL_OK) {
+            result = FlushBatch(interp, table, importPtr, 
+                                &chunkPtr->parser.batch);
+        }
+        FreeParser(&chunkPtr->parser);
+    }
+    if (importPtr->flags & IMPORT_FOLLOW) {
+        Tcl_DStringAppend(&importPtr->pending, rest, tail - rest);
+    }
+    Blt_Free(chunks.chunks);
+    Blt_Free(buffer);
+    return result;
+}
+
+static int
+ImportCsv(Tcl_Interp *interp, BLT_TABLE table, ImportArgs *importPtr)
+{
+    ImportParser parser;
+    int numThreads;
+    int result;
+
+    numThreads = importPtr->numThreads;
+    if (numThreads == 0) {
+        numThreads = blt_table_get_threads(interp);
+    }
+    InitParser(&parser);
+    for (;;) {
+        const char *bp;
+        size_t numBytes;
+        long maxRows;
+
+        if (!parser.inQuotes) {
+            MarkParser(&parser, NULL);  /* Start of a record. */
+            importPtr->recordStart = importPtr->blockNext;
+        }
+        result = ImportGetLine(interp, importPtr, &bp, &numBytes);
+        if (result != TCL_OK) {
+            goto error;                 /* I/O Error. */
+        }
+        if (numBytes == 0) {
+            break;                      /* EOF */
+        }
+        maxRows = -1;
+        if (importPtr->maxRows > 0) {
+            maxRows = importPtr->maxRows - blt_table_num_rows(table);
+        }
+        if (ParseLine(importPtr, &parser, bp, bp + numBytes, maxRows)) {
+            break;
+        }
+        if ((!parser.inRow) && (!parser.inQuotes) && 
+            (parser.batch.numRows >= IMPORT_BATCH_SIZE)) {
+            result = FlushBatch(interp, table, importPtr, &parser.batch);
+            if (result != TCL_OK) {
+                goto error;
+            }
+            /* 
+             * The first batch is always parsed serially, so the column
+             * labels and types are set the same way.  The rest of the
+             * input can be split between threads.
+             */
+            if ((numThreads > 1) && (importPtr->maxRows == 0)) {
+                result = ImportChunked(interp, table, importPtr, numThreads);
+                goto error;
+            }
+        }
+    }
+    if (importPtr->flags & IMPORT_FOLLOW) {
+        /* 
+         * Save the input from the start of the unfinished record, or the
+         * record past -maxrows.  The next import starts from there.
+         */
+        if (parser.inQuotes) {
+            RewindParser(&parser);
+        }
+        if (importPtr->blockLength > importPtr->recordStart) {
+            Tcl_DStringAppend(&importPtr->pending, 
+                importPtr->block + importPtr->recordStart,
+                importPtr->blockLength - importPtr->recordStart);
+        }
+    }
+    result = FlushBatch(interp, table, importPtr, &parser.batch);
  error:
-    Tcl_DStringFree(&ds);
+    FreeParser(&parser);
     return result;
 }
 
+/*
+ * FollowState --
+ *
+ *      Remembers where the last import with -follow of a file into a
+ *      table stopped.  The next import with -follow starts from there,
+ *      parsing only the records appended to the file since.  The state is
+ *      freed when the table is destroyed.
+ */
+typedef struct {
+    BLT_TABLE table;
+    BLT_TABLE_NOTIFIER notifier;        /* Used only to free the state
+                                         * when the table is destroyed. */
+    Blt_HashTable *followTablePtr;      /* Table of states of the
+                                         * interpreter. */
+    Blt_HashEntry *hashPtr;
+    const char *fileName;               /* File or channel followed. */
+    int isStarted;                      /* Indicates the file has been
+                                         * imported before. */
+    Tcl_WideInt offset;                 /* # of bytes read from the
+                                         * file. */
+    Tcl_DString pending;                /* Input read after the last
+                                         * complete record. */
+    char separatorChar;
+    long firstNewColumn;
+    int typesInferred;
+} FollowState;
+
+#define FOLLOW_THREAD_KEY "BLT DataTable Csv Follow"
+
+static void
+ResetFollowState(FollowState *statePtr)
+{
+    statePtr->isStarted = FALSE;
+    statePtr->offset = 0;
+    Tcl_DStringFree(&statePtr->pending);
+}
+
+static int
+FollowNotifyProc(ClientData clientData, BLT_TABLE_NOTIFY_EVENT *eventPtr)
+{
+    return TCL_OK;
+}
+
+static void
+FollowDeleteProc(ClientData clientData)
+{
+    FollowState *statePtr = clientData;
+
+    if (statePtr->hashPtr != NULL) {
+        Blt_DeleteHashEntry(statePtr->followTablePtr, statePtr->hashPtr);
+    }
+    ResetFollowState(statePtr);
+    if (statePtr->fileName != NULL) {
+        Blt_Free((char *)statePtr->fileName);
+    }
+    Blt_Free(statePtr);
+}
+
+static void
+FollowInterpDeleteProc(ClientData clientData, Tcl_Interp *interp)
+{
+    Blt_HashTable *followTablePtr = clientData;
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+
+    for (hPtr = Blt_FirstHashEntry(followTablePtr, &iter); hPtr != NULL;
+         hPtr = Blt_NextHashEntry(&iter)) {
+        FollowState *statePtr;
+
+        statePtr = Blt_GetHashValue(hPtr);
+        statePtr->hashPtr = NULL;
+        blt_table_delete_notifier(statePtr->table, statePtr->notifier);
+    }
+    Blt_DeleteHashTable(followTablePtr);
+    Blt_Free(followTablePtr);
+}
+
+/*
+ * GetFollowState --
+ *
+ *      Returns the state of the last import with -follow into the table,
+ *      creating it if needed.  If a different file was followed before,
+ *      the state is reset.
+ */
+static FollowState *
+GetFollowState(Tcl_Interp *interp, BLT_TABLE table, const char *fileName)
+{
+    Blt_HashTable *followTablePtr;
+    Blt_HashEntry *hPtr;
+    FollowState *statePtr;
+    int isNew;
+
+    followTablePtr = Tcl_GetAssocData(interp, FOLLOW_THREAD_KEY, NULL);
+    if (followTablePtr == NULL) {
+        followTablePtr = Blt_AssertMalloc(sizeof(Blt_HashTable));
+        Blt_InitHashTable(followTablePtr, BLT_ONE_WORD_KEYS);
+        Tcl_SetAssocData(interp, FOLLOW_THREAD_KEY, FollowInterpDeleteProc,
+                         followTablePtr);
+    }
+    hPtr = Blt_CreateHashEntry(followTablePtr, (char *)table, &isNew);
+    if (isNew) {
+        statePtr = Blt_AssertCalloc(1, sizeof(FollowState));
+        statePtr->table = table;
+        statePtr->followTablePtr = followTablePtr;
+        statePtr->hashPtr = hPtr;
+        Tcl_DStringInit(&statePtr->pending);
+        statePtr->notifier = blt_table_create_notifier(interp, table, 0,
+                FollowNotifyProc, FollowDeleteProc, statePtr);
+        Blt_SetHashValue(hPtr, statePtr);
+    } else {
+        statePtr = Blt_GetHashValue(hPtr);
+    }
+    if ((statePtr->fileName == NULL) || 
+        (strcmp(statePtr->fileName, fileName) != 0)) {
+        ResetFollowState(statePtr);
+        if (statePtr->fileName != NULL) {
+            Blt_Free((char *)statePtr->fileName);
+        }
+        statePtr->fileName = Blt_AssertStrdup(fileName);
+    }
+    return statePtr;
+}
+
 static int
 ImportCsvProc(BLT_TABLE table, Tcl_Interp *interp, int objc, 
               Tcl_Obj *const *objv)
@@ -945,12 +1714,19 @@ ImportCsvProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
         &args, BLT_SWITCH_DEFAULTS) < 0) {
         return TCL_ERROR;
     }
+    Tcl_DStringInit(&args.pending);
     result = TCL_ERROR;
     if ((args.dataObjPtr != NULL) && (args.fileObjPtr != NULL)) {
         Tcl_AppendResult(interp, "can't set both -file and -data switches.",
                          (char *)NULL);
         goto error;
     }
+    if ((args.dataObjPtr != NULL) && (args.flags & IMPORT_FOLLOW)) {
+        Tcl_AppendResult(interp, "can't use -follow with -data switch.",
+                         (char *)NULL);
+        goto error;
+    }
+    args.firstNewColumn = blt_table_num_columns(table);
     if ((args.reqQuote != NULL) && (args.reqQuote[0] != '\0')) {
         args.quoteChar = args.reqQuote[0];
     }
@@ -977,8 +1753,10 @@ ImportCsvProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
         int closeChannel;
         Tcl_Channel channel;
         const char *fileName;
+        FollowState *statePtr;
 
         closeChannel = TRUE;
+        statePtr = NULL;
         if (args.fileObjPtr == NULL) {
             fileName = "out.csv";
         } else {
@@ -1009,20 +1787,79 @@ ImportCsvProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
                 goto error;
             }
         }
+        if (args.flags & IMPORT_FOLLOW) {
+            statePtr = GetFollowState(interp, table, fileName);
+            if ((statePtr->isStarted) && (closeChannel)) {
+                Tcl_WideInt size;
+
+                /* 
+                 * Start reading where the last import stopped.  If the
+                 * file is now shorter, it's been truncated or replaced:
+                 * start again from the beginning.
+                 */
+                size = Tcl_Seek(channel, 0, SEEK_END);
+                if ((size < statePtr->offset) ||
+                    (Tcl_Seek(channel, statePtr->offset, SEEK_SET) < 0)) {
+                    ResetFollowState(statePtr);
+                    Tcl_Seek(channel, 0, SEEK_SET);
+                }
+            }
+        }
         args.channel = channel;
+        args.readObjPtr = Tcl_NewObj();
+        Tcl_IncrRefCount(args.readObjPtr);
         Tcl_DStringInit(&args.currLine);
-        if ((args.reqSeparator == NULL) || (args.reqSeparator[0] == '\0')) {
-            args.separatorChar = GuessSeparator(interp, MAX_LINES, &args);
-        } else {
+        if ((statePtr != NULL) && (statePtr->isStarted)) {
+            size_t length;
+
+            args.separatorChar = statePtr->separatorChar;
+            args.firstNewColumn = statePtr->firstNewColumn;
+            args.typesInferred = statePtr->typesInferred;
+            /* Parse the input left over from the last import first. */
+            length = Tcl_DStringLength(&statePtr->pending);
+            if (length > 0) {
+                args.blockSize = length + IMPORT_BLOCK_SIZE;
+                args.block = Blt_AssertMalloc(args.blockSize);
+                memcpy(args.block, Tcl_DStringValue(&statePtr->pending), 
+                       length);
+                args.blockLength = length;
+            }
+        }
+        if ((args.reqSeparator != NULL) && (args.reqSeparator[0] != '\0')) {
             args.separatorChar = args.reqSeparator[0];
+        } else if ((statePtr == NULL) || (!statePtr->isStarted)) {
+            args.separatorChar = GuessSeparator(interp, MAX_LINES, &args);
+        }
+        if (statePtr != NULL) {
+            /* Announce the new rows once the import is done. */
+            blt_table_begin_batch(table);
         }
         result = ImportCsv(interp, table, &args);
+        if ((statePtr != NULL) && (result == TCL_OK)) {
+            statePtr->isStarted = TRUE;
+            statePtr->offset = (closeChannel) ? Tcl_Tell(channel) : 0;
+            statePtr->separatorChar = args.separatorChar;
+            statePtr->firstNewColumn = args.firstNewColumn;
+            statePtr->typesInferred = args.typesInferred;
+            Tcl_DStringFree(&statePtr->pending);
+            Tcl_DStringAppend(&statePtr->pending, 
+                Tcl_DStringValue(&args.pending), 
+                Tcl_DStringLength(&args.pending));
+        }
         Tcl_DStringFree(&args.currLine);
+        Tcl_DecrRefCount(args.readObjPtr);
+        if (args.block != NULL) {
+            Blt_Free(args.block);
+        }
         if (closeChannel) {
             Tcl_Close(interp, channel);
         }
+        if (statePtr != NULL) {
+            blt_table_end_batch(table);
+        }
     }
  error:
+    Tcl_DStringFree(&args.pending);
     Blt_FreeSwitches(importSwitches, (char *)&args, 0);
     return result;
 }
@@ -64,18 +64,28 @@ DLLEXPORT extern Tcl_AppInitProc blt_table_sqlite_safe_init;
  * sqlite       file            file
  */
 
+#define DEF_BATCH_SIZE          1000
+
 /*
  * ImportArgs --
  */
 typedef struct {
     Tcl_Obj *fileObjPtr;                /* File to read. */
     Tcl_Obj *queryObjPtr;               /* If non-NULL, query to make. */
+    const char **pragmas;               /* If non-NULL, list of pragmas to
+                                         * set before the query. */
+    long batchSize;                     /* # of rows to add to the table at
+                                         * a time. */
 } ImportArgs;
 
 static Blt_SwitchSpec importSwitches[] = 
 {
+    {BLT_SWITCH_LONG_POS, "-batchsize", "numRows", (char *)NULL,
+        Blt_Offset(ImportArgs, batchSize), 0, 0},
     {BLT_SWITCH_OBJ, "-file",  "fileName", (char *)NULL,
         Blt_Offset(ImportArgs, fileObjPtr), 0, 0},
+    {BLT_SWITCH_LIST, "-pragma", "pragmaList", (char *)NULL,
+        Blt_Offset(ImportArgs, pragmas), 0, 0},
     {BLT_SWITCH_OBJ, "-query", "string", (char *)NULL,
         Blt_Offset(ImportArgs, queryObjPtr), 0, 0},
     {BLT_SWITCH_END}
@@ -90,6 +100,12 @@ typedef struct {
     Tcl_Obj *fileObjPtr;
     Tcl_Obj *tableObjPtr;
     const char *tableName;
+    const char **pragmas;               /* If non-NULL, list of pragmas to
+                                         * set before writing. */
+    long batchSize;                     /* Maximum # of rows written by each
+                                         * INSERT statement. */
+    int transaction;                    /* If non-zero, write all the rows
+                                         * in a single transaction. */
 } ExportArgs;
 
 #define EXPORT_ROWLABELS        (1<<0)
@@ -107,16 +123,22 @@ static Blt_SwitchCustom rowIterSwitch = {
 
 static Blt_SwitchSpec exportSwitches[] = 
 {
+    {BLT_SWITCH_LONG_POS, "-batchsize", "numRows", (char *)NULL,
+        Blt_Offset(ExportArgs, batchSize), 0, 0},
     {BLT_SWITCH_CUSTOM, "-columns",   "columns" ,(char *)NULL,
         Blt_Offset(ExportArgs, ci),   0, 0, &columnIterSwitch},
     {BLT_SWITCH_OBJ, "-file", "fileName", (char *)NULL,
         Blt_Offset(ExportArgs, fileObjPtr), 0, 0},
+    {BLT_SWITCH_LIST, "-pragma", "pragmaList", (char *)NULL,
+        Blt_Offset(ExportArgs, pragmas), 0, 0},
     {BLT_SWITCH_CUSTOM, "-rows",      "rows", (char *)NULL,
         Blt_Offset(ExportArgs, ri),   0, 0, &rowIterSwitch},
     {BLT_SWITCH_BITS_NOARG, "-rowlabels",  "", (char *)NULL,
         Blt_Offset(ExportArgs, flags), 0, EXPORT_ROWLABELS},
     {BLT_SWITCH_OBJ, "-table", "tableName", (char *)NULL,
         Blt_Offset(ExportArgs, tableObjPtr), 0, 0},
+    {BLT_SWITCH_BOOLEAN, "-transaction", "bool", (char *)NULL,
+        Blt_Offset(ExportArgs, transaction), 0, 0},
     {BLT_SWITCH_END}
 };
 
@@ -276,6 +298,62 @@ SqliteDisconnect(sqlite3 *conn)
     sqlite3_close(conn);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SqliteExec --
+ *
+ *      Executes one or more SQL statements that return no results, such
+ *      as pragmas, table creation, or transaction control.
+ *
+ * Results:
+ *      A standard TCL result.  If an error occurred, the interpreter
+ *      result contains the error message.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+SqliteExec(Tcl_Interp *interp, sqlite3 *conn, const char *sql)
+{
+    char *mesg;
+
+    mesg = NULL;
+    if (sqlite3_exec(conn, sql, NULL, NULL, &mesg) != SQLITE_OK) {
+        Tcl_AppendResult(interp, "error in statement \"", sql, "\": ", 
+                (mesg != NULL) ? mesg : sqlite3_errmsg(conn), (char *)NULL);
+        if (mesg != NULL) {
+            sqlite3_free(mesg);
+        }
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static int
+SqliteSetPragmas(Tcl_Interp *interp, sqlite3 *conn, const char **pragmas)
+{
+    const char **p;
+
+    if (pragmas == NULL) {
+        return TCL_OK;
+    }
+    for (p = pragmas; *p != NULL; p++) {
+        Tcl_DString ds;
+        int result;
+
+        Tcl_DStringInit(&ds);
+        Tcl_DStringAppend(&ds, "PRAGMA ", -1);
+        Tcl_DStringAppend(&ds, *p, -1);
+        Tcl_DStringAppend(&ds, ";", -1);
+        result = SqliteExec(interp, conn, Tcl_DStringValue(&ds));
+        Tcl_DStringFree(&ds);
+        if (result != TCL_OK) {
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
+
 static int
 SqliteImportLabel(Tcl_Interp *interp, BLT_TABLE table, BLT_TABLE_COLUMN col,
                   sqlite3_stmt *stmt, int index)
@@ -297,19 +375,10 @@ SqliteImportLabel(Tcl_Interp *interp, BLT_TABLE table, BLT_TABLE_COLUMN col,
 
 static int
 SqliteImportRow(Tcl_Interp *interp, BLT_TABLE table, sqlite3_stmt *stmt,
-                long numColumns, BLT_TABLE_COLUMN *cols, long index)
+                long numColumns, BLT_TABLE_COLUMN *cols, BLT_TABLE_ROW row)
 {
-    BLT_TABLE_ROW row;
     int i;
     
-    /* First check that there are enough rows in the table to accomodate
-     * the new data. Add more if necessary. */
-    if (index >= blt_table_num_rows(table)) {
-        if (blt_table_extend_rows(interp, table, 1, &row) != TCL_OK) {
-            return TCL_ERROR;
-        }
-    }
-    row = blt_table_row(table, index);
     for (i = 0; i < numColumns; i++) {
         int type;
             
@@ -358,18 +427,39 @@ SqliteImportRow(Tcl_Interp *interp, BLT_TABLE table, sqlite3_stmt *stmt,
     return TCL_OK;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SqliteImport --
+ *
+ *      Steps through the results of the query, storing each result row in
+ *      the table.  Rows already in the table are overwritten first.  New
+ *      rows are added in batches (see the -batchsize switch) rather than
+ *      one at a time, and any rows left unused from the last batch are
+ *      deleted.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
 static int
 SqliteImport(Tcl_Interp *interp, BLT_TABLE table, sqlite3 *conn, 
              ImportArgs *argsPtr) 
 {
     BLT_TABLE_COLUMN *cols;
+    BLT_TABLE_ROW *rows;
     const char *query, *left;
     int initialized, length, result;
-    long numColumns, count;
+    long numColumns, numExisting, count;
+    long numAdded, numLeft;             /* # of rows in the current
+                                         * batch, and # not used yet. */
     sqlite3_stmt *stmt;
     
-
     stmt = NULL;
+    cols = NULL;
+    rows = NULL;
+    numAdded = numLeft = 0;
     query = Tcl_GetStringFromObj(argsPtr->queryObjPtr, &length);
     if (sqlite3_prepare_v2(conn, query, length, &stmt, &left) != SQLITE_OK) {
         Tcl_AppendResult(interp, "error in query \"", query, "\": ", 
@@ -384,7 +474,7 @@ SqliteImport(Tcl_Interp *interp, BLT_TABLE table, sqlite3 *conn,
     if ((left != NULL) && (left[0] != '\0')) {
         Tcl_AppendResult(interp, "extra statements follow query \"", left,
                          "\": ", sqlite3_errmsg(conn), (char *)NULL);
-        return TCL_ERROR;
+        goto error;
     }
     numColumns = sqlite3_column_count(stmt);
     cols = Blt_Malloc(sizeof(BLT_TABLE_COLUMN) * numColumns);
@@ -393,15 +483,23 @@ SqliteImport(Tcl_Interp *interp, BLT_TABLE table, sqlite3 *conn,
                          " column slots.", (char *)NULL);
         goto error;
     }
+    rows = Blt_Malloc(sizeof(BLT_TABLE_ROW) * argsPtr->batchSize);
+    if (rows == NULL) {
+        Tcl_AppendResult(interp, "can't allocate ", 
+                Blt_Ltoa(argsPtr->batchSize), " row slots.", (char *)NULL);
+        goto error;
+    }
     if (blt_table_extend_columns(interp, table, numColumns, cols) != TCL_OK) {
         goto error;                     /* Can't create new columns. */
     }
     initialized = FALSE;
     result = SQLITE_OK;
     count = 0;
+    numExisting = blt_table_num_rows(table);
     do {
         result = sqlite3_step(stmt);
         if ((result == SQLITE_OK) || (result == SQLITE_ROW)) {
+            BLT_TABLE_ROW row;
             int i;
             
             if (!initialized) {
@@ -414,23 +512,51 @@ SqliteImport(Tcl_Interp *interp, BLT_TABLE table, sqlite3 *conn,
                 }
                 initialized = TRUE;
             }
-            if (SqliteImportRow(interp, table, stmt, numColumns, cols, count)
+            if (count < numExisting) {
+                row = blt_table_row(table, count);
+            } else {
+                if (numLeft == 0) {
+                    /* Add the next batch of rows to the table. */
+                    if (blt_table_extend_rows(interp, table, 
+                        argsPtr->batchSize, rows) != TCL_OK) {
+                        goto error;
+                    }
+                    numAdded = numLeft = argsPtr->batchSize;
+                }
+                row = rows[numAdded - numLeft];
+                numLeft--;
+            }
+            if (SqliteImportRow(interp, table, stmt, numColumns, cols, row)
                 != TCL_OK) {
                 goto error;
             }
+            count++;
         } else if (result != SQLITE_DONE) {
             Tcl_AppendResult(interp, "step failed \": ", 
                              sqlite3_errmsg(conn), (char *)NULL);
             goto error;
         }
     } while ((result == SQLITE_OK) || (result == SQLITE_ROW)) ;
+    /* Remove the rows from the last batch that weren't used. */
+    while (numLeft > 0) {
+        blt_table_delete_row(table, rows[numAdded - numLeft]);
+        numLeft--;
+    }
+    Blt_Free(rows);
     Blt_Free(cols);
     sqlite3_finalize(stmt);
     return TCL_OK;
  error:
+    while (numLeft > 0) {
+        blt_table_delete_row(table, rows[numAdded - numLeft]);
+        numLeft--;
+    }
     if (stmt != NULL) {
         sqlite3_finalize(stmt);
     }
+    if (rows != NULL) {
+        Blt_Free(rows);
+    }
     if (cols != NULL) {
         Blt_Free(cols);
     }
@@ -438,31 +564,28 @@ SqliteImport(Tcl_Interp *interp, BLT_TABLE table, sqlite3 *conn,
 }
 
 static int
-SqliteCreateTable(Tcl_Interp *interp, sqlite3 *conn, BLT_TABLE table,
-                  ExportArgs *argsPtr)
+SqliteCreateTable(Tcl_Interp *interp, sqlite3 *conn, ExportArgs *argsPtr,
+                  BLT_TABLE_COLUMN *cols, long numColumns)
 {
-    BLT_TABLE_COLUMN col;
     Blt_DBuffer dbuffer;
-    const char *query;
     int first;
-    int length;
     int result;
-    sqlite3_stmt *stmt;
+    long i;
     
     dbuffer = Blt_DBuffer_Create();
     Blt_DBuffer_Format(dbuffer, "DROP TABLE IF EXISTS %s; CREATE TABLE %s (",
                        argsPtr->tableName, argsPtr->tableName);
+    first = TRUE;
     if (argsPtr->flags & EXPORT_ROWLABELS) {
-        Blt_DBuffer_Format(dbuffer, "_rowId TEXT, ");
+        Blt_DBuffer_Format(dbuffer, "_rowId TEXT");
+        first = FALSE;
     }        
-    first = TRUE;
-    for (col = blt_table_first_tagged_column(&argsPtr->ci); col != NULL; 
-         col = blt_table_next_tagged_column(&argsPtr->ci)) {
+    for (i = 0; i < numColumns; i++) {
         int type;
         const char *label;
         
-        type = blt_table_column_type(col);
-        label = blt_table_column_label(col);
+        type = blt_table_column_type(cols[i]);
+        label = blt_table_column_label(cols[i]);
         if (!first) {
             Blt_DBuffer_Format(dbuffer, ", ");
         }
@@ -470,6 +593,7 @@ SqliteCreateTable(Tcl_Interp *interp, sqlite3 *conn, BLT_TABLE table,
         switch(type) {
         case TABLE_COLUMN_TYPE_BOOLEAN:
         case TABLE_COLUMN_TYPE_LONG:
+        case TABLE_COLUMN_TYPE_INT64:
             Blt_DBuffer_Format(dbuffer, "INTEGER");     break;
         case TABLE_COLUMN_TYPE_DOUBLE:
             Blt_DBuffer_Format(dbuffer, "REAL");        break;
@@ -483,151 +607,253 @@ SqliteCreateTable(Tcl_Interp *interp, sqlite3 *conn, BLT_TABLE table,
         first = FALSE;
     }
     Blt_DBuffer_Format(dbuffer, ");"); 
-    query = (const char *)Blt_DBuffer_String(dbuffer);
-    length = Blt_DBuffer_Length(dbuffer);
-    result = sqlite3_prepare_v2(conn, query, length, &stmt, NULL);
-    if (result != SQLITE_OK) {
-        Tcl_AppendResult(interp, "error in table create \"", query, "\": ", 
-                         sqlite3_errmsg(conn), (char *)NULL);
-    }
+    /* Both statements must be run, so they can't be prepared at once. */
+    result = SqliteExec(interp, conn, Blt_DBuffer_String(dbuffer));
     Blt_DBuffer_Destroy(dbuffer);
-    if (result != SQLITE_OK) {
-        goto error;
-    }
-    do {
-        result = sqlite3_step(stmt);
-    } while (result == SQLITE_OK);
-    sqlite3_finalize(stmt);
-    assert(result == SQLITE_DONE);
-    return TCL_OK;
- error:
-    if (stmt != NULL) {
-        sqlite3_finalize(stmt);
-    }
-    return TCL_ERROR;
+    return result;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SqlitePrepareInsert --
+ *
+ *      Prepares an INSERT statement that writes the given number of rows
+ *      at once.  Each row has a parameter for every exported column (and
+ *      the row label).
+ *
+ * Results:
+ *      A standard TCL result.  The prepared statement is returned via
+ *      stmtPtr.
+ *
+ *---------------------------------------------------------------------------
+ */
 static int
-SqliteExportValues(Tcl_Interp *interp, sqlite3 *conn, BLT_TABLE table,
-                   ExportArgs *argsPtr)
+SqlitePrepareInsert(Tcl_Interp *interp, sqlite3 *conn, ExportArgs *argsPtr,
+                    BLT_TABLE_COLUMN *cols, long numColumns, long numRows,
+                    sqlite3_stmt **stmtPtr)
 {
-    BLT_TABLE_COLUMN col;
-    BLT_TABLE_ROW row;
-    Blt_DBuffer dbuffer, dbuffer2;
+    Blt_DBuffer dbuffer;
     const char *query;
     int length, result;
-    int count;                          /* sqlite3 parameter index. */
+    long i, j;
     sqlite3_stmt *stmt;
     
     dbuffer = Blt_DBuffer_Create();
-    dbuffer2 = Blt_DBuffer_Create();
     Blt_DBuffer_Format(dbuffer, "INSERT INTO %s (", argsPtr->tableName);
-    Blt_DBuffer_Format(dbuffer2, "(");
-    count = 1;                          /* sqlite3 parameter indices start
-                                         * from 1. */
     if (argsPtr->flags & EXPORT_ROWLABELS) {
-        Blt_DBuffer_Format(dbuffer, "_rowId TEXT ");
-        Blt_DBuffer_Format(dbuffer2, "?%d", count);
-        count++;
+        Blt_DBuffer_Format(dbuffer, "_rowId");
     }        
-    for (col = blt_table_first_tagged_column(&argsPtr->ci); col != NULL;
-         col = blt_table_next_tagged_column(&argsPtr->ci)) {
-        const char *label;
-        
-        label = blt_table_column_label(col);
-        if (count > 1) {
+    for (j = 0; j < numColumns; j++) {
+        if ((j > 0) || (argsPtr->flags & EXPORT_ROWLABELS)) {
             Blt_DBuffer_Format(dbuffer, ", ");
-            Blt_DBuffer_Format(dbuffer2, ", ");
         }
-        Blt_DBuffer_Format(dbuffer, "[%s]", label);
-        Blt_DBuffer_Format(dbuffer2, "?%d", count);
-        count++;
+        Blt_DBuffer_Format(dbuffer, "[%s]", blt_table_column_label(cols[j]));
     }
-    Blt_DBuffer_Format(dbuffer2, ");");
     Blt_DBuffer_Format(dbuffer, ") values ");
-    Blt_DBuffer_Concat(dbuffer, dbuffer2);
-    Blt_DBuffer_Destroy(dbuffer2);
+    for (i = 0; i < numRows; i++) {
+        Blt_DBuffer_Format(dbuffer, (i > 0) ? ", (" : "(");
+        if (argsPtr->flags & EXPORT_ROWLABELS) {
+            Blt_DBuffer_Format(dbuffer, "?");
+        }
+        for (j = 0; j < numColumns; j++) {
+            if ((j > 0) || (argsPtr->flags & EXPORT_ROWLABELS)) {
+                Blt_DBuffer_Format(dbuffer, ", ");
+            }
+            Blt_DBuffer_Format(dbuffer, "?");
+        }
+        Blt_DBuffer_Format(dbuffer, ")");
+    }
+    Blt_DBuffer_Format(dbuffer, ";");
     query = Blt_DBuffer_String(dbuffer);
     length = Blt_DBuffer_Length(dbuffer);
+    stmt = NULL;
     result = sqlite3_prepare_v2(conn, query, length, &stmt, NULL);
-
-    if (result != SQLITE_OK) {
-        Tcl_AppendResult(interp, "error in insert statment \"", query, "\": ", 
-                         sqlite3_errmsg(conn), (char *)NULL);
+    if ((result != SQLITE_OK) || (stmt == NULL)) {
+        Tcl_AppendResult(interp, "error in insert statement for \"", 
+                argsPtr->tableName, "\": ", sqlite3_errmsg(conn), 
+                (char *)NULL);
         Blt_DBuffer_Destroy(dbuffer);
-        goto error;
-    }
-    if (stmt == NULL) {
-        Tcl_AppendResult(interp, "empty statement in query \"", query, "\": ", 
-                         sqlite3_errmsg(conn), (char *)NULL);
-        Blt_DBuffer_Destroy(dbuffer);
-        goto error;
+        if (stmt != NULL) {
+            sqlite3_finalize(stmt);
+        }
+        return TCL_ERROR;
     }
     Blt_DBuffer_Destroy(dbuffer);
+    *stmtPtr = stmt;
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SqliteBindRow --
+ *
+ *      Binds the values of a row to the parameters of an INSERT
+ *      statement, starting from the given parameter index.  Values are
+ *      bound by the column's type so that numbers aren't converted to
+ *      strings and back.
+ *
+ * Results:
+ *      Returns the index of the next parameter.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+SqliteBindRow(BLT_TABLE table, sqlite3_stmt *stmt, int count, 
+              ExportArgs *argsPtr, BLT_TABLE_COLUMN *cols, long numColumns,
+              BLT_TABLE_ROW row)
+{
+    long i;
+
+    if (argsPtr->flags & EXPORT_ROWLABELS) {
+        sqlite3_bind_text(stmt, count, blt_table_row_label(row), -1,
+                          SQLITE_STATIC);
+        count++;
+    }
+    for (i = 0; i < numColumns; i++, count++) {
+        BLT_TABLE_COLUMN col;
+
+        col = cols[i];
+        if (!blt_table_value_exists(table, row, col)) {
+            sqlite3_bind_null(stmt, count);
+            continue;
+        }
+        switch(blt_table_column_type(col)) {
+        case TABLE_COLUMN_TYPE_LONG:
+        case TABLE_COLUMN_TYPE_INT64:
+            sqlite3_bind_int64(stmt, count, 
+                blt_table_get_int64(NULL, table, row, col, 0));
+            break;
+        case TABLE_COLUMN_TYPE_BOOLEAN:
+            sqlite3_bind_int(stmt, count, 
+                blt_table_get_boolean(NULL, table, row, col, 0));
+            break;
+        case TABLE_COLUMN_TYPE_DOUBLE:
+            sqlite3_bind_double(stmt, count, 
+                blt_table_get_double(NULL, table, row, col));
+            break;
+        default:
+        case TABLE_COLUMN_TYPE_STRING:
+            /* The string may be a temporary conversion, so sqlite must
+             * copy it. */
+            sqlite3_bind_text(stmt, count, 
+                blt_table_get_string(table, row, col), -1, SQLITE_TRANSIENT);
+            break;
+        }
+    }
+    return count;
+}
+
+static int
+SqliteInsertRows(Tcl_Interp *interp, sqlite3 *conn, sqlite3_stmt *stmt,
+                 BLT_TABLE table, ExportArgs *argsPtr, BLT_TABLE_COLUMN *cols,
+                 long numColumns, BLT_TABLE_ROW *rows, long numRows)
+{
+    int count;                          /* sqlite3 parameter index. */
+    int result;
+    long i;
+
+    count = 1;                          /* sqlite3 parameter indices start
+                                         * from 1. */
+    for (i = 0; i < numRows; i++) {
+        count = SqliteBindRow(table, stmt, count, argsPtr, cols, numColumns,
+                              rows[i]);
+    }
+    do {
+        result = sqlite3_step(stmt);
+    } while (result == SQLITE_OK);
+    sqlite3_reset(stmt);
+    if (result != SQLITE_DONE) {
+        Tcl_AppendResult(interp, "can't insert rows into \"", 
+                argsPtr->tableName, "\": ", sqlite3_errmsg(conn), 
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SqliteExportValues --
+ *
+ *      Writes the rows of the table using multi-row INSERT statements.
+ *      A single statement for a full batch of rows is prepared once and
+ *      reused.  The last, partial batch gets its own statement.  The
+ *      number of rows in a batch is limited by the maximum number of
+ *      parameters sqlite allows in a statement.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+SqliteExportValues(Tcl_Interp *interp, sqlite3 *conn, BLT_TABLE table,
+                   ExportArgs *argsPtr, BLT_TABLE_COLUMN *cols, 
+                   long numColumns)
+{
+    BLT_TABLE_ROW row, *rows;
+    long numParams, batchSize, maxParams, count;
+    int result;
+    sqlite3_stmt *stmt;
+    
+    stmt = NULL;
+    numParams = numColumns;
+    if (argsPtr->flags & EXPORT_ROWLABELS) {
+        numParams++;
+    }
+    batchSize = argsPtr->batchSize;
+    maxParams = sqlite3_limit(conn, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+    if ((batchSize * numParams) > maxParams) {
+        batchSize = maxParams / numParams;
+        if (batchSize < 1) {
+            batchSize = 1;
+        }
+    }
+    rows = Blt_AssertMalloc(sizeof(BLT_TABLE_ROW) * batchSize);
+    result = TCL_OK;
+    count = 0;
     for (row = blt_table_first_tagged_row(&argsPtr->ri); row != NULL; 
          row = blt_table_next_tagged_row(&argsPtr->ri)) {
-        int count;                      /* sqlite3 result set index. */
-        
-        count = 1;                      /* sqlite3 parameter indices start
-                                         * from 1. */
-        if (argsPtr->flags & EXPORT_ROWLABELS) {
-            const char *label;
-                    
-            label = blt_table_row_label(row);
-            sqlite3_bind_text(stmt, count, label, -1, NULL);
-            count++;
+        rows[count++] = row;
+        if (count < batchSize) {
+            continue;
         }
-        for (col = blt_table_first_tagged_column(&argsPtr->ci); col != NULL;
-             col = blt_table_next_tagged_column(&argsPtr->ci)) {
-            if (!blt_table_value_exists(table, row, col)) {
-                sqlite3_bind_null(stmt, count);
-            } else {
-                int type;
-            
-                type = blt_table_column_type(col);
-                switch(type) {
-                case TABLE_COLUMN_TYPE_LONG:
-                case TABLE_COLUMN_TYPE_BOOLEAN:
-                    {
-                        long lval;
-                        
-                        lval = blt_table_get_long(interp, table, row, col, 0);
-                        sqlite3_bind_int64(stmt, count, lval);
-                    }
-                    break;
-                case TABLE_COLUMN_TYPE_DOUBLE:
-                    {
-                        double dval;
-                        
-                        dval = blt_table_get_double(interp, table, row, col);
-                        sqlite3_bind_double(stmt, count, dval);
-                    }
-                    break;
-                default:
-                case TABLE_COLUMN_TYPE_STRING:
-                    {
-                        const char *sval;
-                        
-                        sval = blt_table_get_string(table, row, col);
-                        sqlite3_bind_text(stmt, count, sval, -1, NULL);
-                    }
-                    break;
-                }
+        if (stmt == NULL) {
+            result = SqlitePrepareInsert(interp, conn, argsPtr, cols, 
+                numColumns, batchSize, &stmt);
+            if (result != TCL_OK) {
+                goto done;
             }
-            count++;
         }
-        do {
-            result = sqlite3_step(stmt);
-        } while (result == SQLITE_OK);
-        sqlite3_reset(stmt);
+        result = SqliteInsertRows(interp, conn, stmt, table, argsPtr, cols,
+                numColumns, rows, count);
+        if (result != TCL_OK) {
+            goto done;
+        }
+        count = 0;
     }
-    sqlite3_finalize(stmt);
-    return TCL_OK;
- error:
+    if (count > 0) {
+        /* Write the remaining rows with a statement just for them. */
+        if (stmt != NULL) {
+            sqlite3_finalize(stmt);
+            stmt = NULL;
+        }
+        result = SqlitePrepareInsert(interp, conn, argsPtr, cols, numColumns,
+                count, &stmt);
+        if (result == TCL_OK) {
+            result = SqliteInsertRows(interp, conn, stmt, table, argsPtr, 
+                cols, numColumns, rows, count);
+        }
+    }
+ done:
     if (stmt != NULL) {
         sqlite3_finalize(stmt);
     }
-    return TCL_ERROR;
+    Blt_Free(rows);
+    return result;
 }
 
 static int
@@ -640,6 +866,7 @@ ImportSqliteProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
     int result;
     
     memset(&args, 0, sizeof(args));
+    args.batchSize = DEF_BATCH_SIZE;
     if (Blt_ParseSwitches(interp, importSwitches, objc - 3, objv + 3, 
                 &args, BLT_SWITCH_DEFAULTS) < 0) {
         return TCL_ERROR;
@@ -655,6 +882,9 @@ ImportSqliteProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
     conn = NULL;                          /* Suppress compiler warning. */
     fileName = Tcl_GetString(args.fileObjPtr);
     result = SqliteConnect(interp, fileName, &conn);
+    if (result == TCL_OK) {
+        result = SqliteSetPragmas(interp, conn, args.pragmas);
+    }
     if (result == TCL_OK) {
         result = SqliteImport(interp, table, conn, &args);
     }
@@ -667,9 +897,11 @@ static int
 ExportSqliteProc(BLT_TABLE table, Tcl_Interp *interp, int objc, 
                 Tcl_Obj *const *objv)
 {
+    BLT_TABLE_COLUMN col, *cols;
     ExportArgs args;
     sqlite3 *conn;
     int result;
+    long numColumns;
     const char *fileName;
     
     if ((blt_table_num_rows(table) == 0) ||
@@ -677,6 +909,8 @@ ExportSqliteProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
         return TCL_OK;                         /* Empty table. */
     }
     memset(&args, 0, sizeof(args));
+    args.batchSize = DEF_BATCH_SIZE;
+    args.transaction = TRUE;
     rowIterSwitch.clientData = table;
     columnIterSwitch.clientData = table;
     blt_table_iterate_all_rows(table, &args.ri);
@@ -692,18 +926,47 @@ ExportSqliteProc(BLT_TABLE table, Tcl_Interp *interp, int objc,
     }
     if (args.fileObjPtr == NULL) {
         Tcl_AppendResult(interp, "-file switch is required.", (char *)NULL);
+        Blt_FreeSwitches(exportSwitches, &args, 0);
         return TCL_ERROR;
     }
+    /* Collect the exported columns once.  They're used by both the table
+     * creation and the insert statements. */
+    cols = Blt_AssertMalloc(sizeof(BLT_TABLE_COLUMN) * 
+                            blt_table_num_columns(table));
+    numColumns = 0;
+    for (col = blt_table_first_tagged_column(&args.ci); col != NULL;
+         col = blt_table_next_tagged_column(&args.ci)) {
+        cols[numColumns++] = col;
+    }
     conn = NULL;                          /* Suppress compiler warning. */
     fileName = Tcl_GetString(args.fileObjPtr);
     result = SqliteConnect(interp, fileName, &conn);
     if (result == TCL_OK) {
-        result = SqliteCreateTable(interp, conn, table, &args);
+        result = SqliteSetPragmas(interp, conn, args.pragmas);
+    }
+    if ((result == TCL_OK) && (args.transaction)) {
+        result = SqliteExec(interp, conn, "BEGIN TRANSACTION;");
+        if (result != TCL_OK) {
+            args.transaction = FALSE;
+        }
     }
     if (result == TCL_OK) {
-        result = SqliteExportValues(interp, conn, table, &args);
+        result = SqliteCreateTable(interp, conn, &args, cols, numColumns);
+    }
+    if ((result == TCL_OK) && (numColumns > 0)) {
+        result = SqliteExportValues(interp, conn, table, &args, cols, 
+                numColumns);
+    }
+    if (args.transaction) {
+        if (result == TCL_OK) {
+            result = SqliteExec(interp, conn, "COMMIT TRANSACTION;");
+        } else {
+            /* Leave the database as it was. */
+            sqlite3_exec(conn, "ROLLBACK TRANSACTION;", NULL, NULL, NULL);
+        }
     }
     SqliteDisconnect(conn);
+    Blt_Free(cols);
     Blt_FreeSwitches(exportSwitches, &args, 0);
     return result;
 }
@@ -59,12 +59,20 @@ DLLEXPORT extern Tcl_AppInitProc blt_table_txt_safe_init;
 #define TRUE    1
 #define FALSE   0
 
-#define STATE_FIELD             1
-#define STATE_SEPARATOR         0
-
 #define EXPORT_ROWLABELS        (1<<0)
 #define EXPORT_COLUMNLABELS     (1<<1)
 
+#define IMPORT_INFER_TYPES      (1<<0)
+
+#define IMPORT_BLOCK_SIZE       (1<<16) /* # of characters read from the
+                                         * channel at a time. */
+#define IMPORT_BATCH_SIZE       (1<<12) /* # of rows added to the table at a
+                                         * time. The first batch is also the
+                                         * sample used to infer column
+                                         * types. */
+#define IMPORT_CHUNK_SIZE       (1<<16) /* Minimum # of bytes parsed by each
+                                         * thread. */
+
 /*
  * ImportSwitches --
  */
@@ -72,10 +80,32 @@ typedef struct {
     unsigned int flags;
     Tcl_Channel channel;                /* If non-NULL, channel to read
                                          * from. */
-    char *buffer;                       /* Buffer to read data into. */
-    int numBytes;                       /* # of bytes in the buffer. */
-    Tcl_DString ds;                     /* Dynamic string used to read the
-                                         * file line by line. */
+    Tcl_Obj *encodingObjPtr;
+    const char *buffer;                 /* Buffer to read data into. */
+    size_t numBytes;                    /* # of bytes in the buffer. */
+    const char *next;                   /* Used for parsing data as a
+                                         * single string. */
+    size_t bytesLeft;                   /* Used for parsing data as a
+                                         * single string. */
+    Tcl_DString currLine;               /* Dynamic string used to hold
+                                         * the last line of the data
+                                         * string. */
+    Tcl_Obj *readObjPtr;                /* Characters read from the
+                                         * channel. */
+    char *block;                        /* Block of input read from the
+                                         * channel. Lines are parsed
+                                         * directly from the block. */
+    size_t blockSize;                   /* # of bytes allocated for the
+                                         * block. */
+    size_t blockLength;                 /* # of bytes of input in the
+                                         * block. */
+    size_t blockNext;                   /* Offset of the next line in the
+                                         * block. */
+    int keepBlock;                      /* If non-zero, lines already read
+                                         * are kept in the block so that
+                                         * they can be read again. */
+    int eof;                            /* Indicates the end of the
+                                         * channel was reached. */
     Tcl_Interp *interp;
     Blt_HashTable dataTable;
     Tcl_Obj *fileObjPtr;                /* Name of file representing the
@@ -85,8 +115,23 @@ typedef struct {
                                          * input source. */
     const char *quote;                  /* Quoted string delimiter. */
     const char *comment;                /* Comment character. */
+    char quoteChar;                     /* Quote character. */
+    char commentChar;                   /* Comment character. */
+    Tcl_Obj *widthsObjPtr;              /* If non-NULL, list of column
+                                         * widths. */
+    int *widths;                        /* Widths of the columns, in
+                                         * characters. If non-NULL, lines
+                                         * are sliced into fixed-width
+                                         * columns instead of tokenised. */
+    int numWidths;                      /* # of widths in above array. */
     int maxRows;                        /* Stop processing after this many
                                          * rows have been found. */
+    int numThreads;                     /* # of threads used to parse the
+                                         * input. */
+    long firstNewColumn;                /* Index of the first column
+                                         * created by the import. */
+    int typesInferred;                  /* Indicates the column types have
+                                         * been inferred. */
 } ImportSwitches;
 
 static Blt_SwitchSpec importSwitches[] = 
@@ -95,12 +140,20 @@ static Blt_SwitchSpec importSwitches[] =
         Blt_Offset(ImportSwitches, comment), 0},
     {BLT_SWITCH_OBJ,    "-data",      "string", (char *)NULL,
         Blt_Offset(ImportSwitches, dataObjPtr), 0, 0, NULL},
+    {BLT_SWITCH_OBJ,    "-encoding",  "string", (char *)NULL,
+        Blt_Offset(ImportSwitches, encodingObjPtr), 0, 0, NULL},
     {BLT_SWITCH_OBJ,    "-file",      "fileName", (char *)NULL,
         Blt_Offset(ImportSwitches, fileObjPtr), 0},
+    {BLT_SWITCH_BITS_NOARG, "-infertypes", "", (char *)NULL,
+        Blt_Offset(ImportSwitches, flags), 0, IMPORT_INFER_TYPES},
     {BLT_SWITCH_INT_NNEG, "-maxrows", "integer", (char *)NULL,
         Blt_Offset(ImportSwitches, maxRows), 0},
     {BLT_SWITCH_STRING, "-quote",     "char", (char *)NULL,
         Blt_Offset(ImportSwitches, quote), 0},
+    {BLT_SWITCH_INT_POS, "-threads", "numThreads", (char *)NULL,
+        Blt_Offset(ImportSwitches, numThreads), 0},
+    {BLT_SWITCH_OBJ,    "-widths",    "widthList", (char *)NULL,
+        Blt_Offset(ImportSwitches, widthsObjPtr), 0},
     {BLT_SWITCH_END}
 };
 
@@ -486,6 +539,52 @@ ExportProc(BLT_TABLE table, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
     return result;
 }
 
+/* 
+ * ReadBlock -- 
+ *
+ *      Reads the next block of characters from the channel and appends
+ *      them to the block.  Lines already parsed are discarded first,
+ *      unless they are being kept to be read again.
+ *
+ */
+static int
+ReadBlock(Tcl_Interp *interp, ImportSwitches *importPtr)
+{
+    const char *bytes;
+    int numChars, numBytes;
+
+    if ((!importPtr->keepBlock) && (importPtr->blockNext > 0)) {
+        importPtr->blockLength -= importPtr->blockNext;
+        memmove(importPtr->block, importPtr->block + importPtr->blockNext,
+                importPtr->blockLength);
+        importPtr->blockNext = 0;
+    }
+    numChars = Tcl_ReadChars(importPtr->channel, importPtr->readObjPtr, 
+                IMPORT_BLOCK_SIZE, 0);
+    if (numChars < 0) {
+        Tcl_AppendResult(interp, "error reading file: ", 
+                         Tcl_PosixError(interp), (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (numChars == 0) {
+        importPtr->eof = TRUE;
+        return TCL_OK;
+    }
+    bytes = Tcl_GetStringFromObj(importPtr->readObjPtr, &numBytes);
+    if ((importPtr->blockLength + numBytes + 1) > importPtr->blockSize) {
+        importPtr->blockSize = importPtr->blockLength + numBytes + 1;
+        if (importPtr->blockSize < IMPORT_BLOCK_SIZE) {
+            importPtr->blockSize = IMPORT_BLOCK_SIZE;
+        }
+        importPtr->blockSize += importPtr->blockSize / 2;
+        importPtr->block = Blt_AssertRealloc(importPtr->block, 
+                importPtr->blockSize);
+    }
+    memcpy(importPtr->block + importPtr->blockLength, bytes, numBytes);
+    importPtr->blockLength += numBytes;
+    return TCL_OK;
+}
+
 /* 
  * ImportGetLine -- 
  *
@@ -494,223 +593,793 @@ ExportProc(BLT_TABLE table, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
  *      at the end of a row or in a quoted field.  So the resulting line
  *      always contains a new line unless an error occurs or we hit EOF.
  *
+ *      Files are read a block at a time.  The line points into the block
+ *      and is valid until the next line is read.
+ *
  */
 static int
-ImportGetLine(Tcl_Interp *interp, ImportSwitches *importPtr, char **bufferPtr,
-                int *numBytesPtr)
+ImportGetLine(Tcl_Interp *interp, ImportSwitches *importPtr, 
+              const char **bufferPtr, size_t *numBytesPtr)
 {
     if (importPtr->channel != NULL) {
-        int numChars;
+        for (;;) {
+            const char *bp, *bend, *eol;
 
-        if (Tcl_Eof(importPtr->channel)) {
-            *numBytesPtr = 0;
-            return TCL_OK;
-        }
-        Tcl_DStringSetLength(&importPtr->ds, 0);
-        numChars = Tcl_Gets(importPtr->channel, &importPtr->ds);
-        if (numChars < 0) {
-            if (Tcl_Eof(importPtr->channel)) {
-                *numBytesPtr = 0;
+            bp = importPtr->block + importPtr->blockNext;
+            bend = importPtr->block + importPtr->blockLength;
+            eol = (bp < bend) ? memchr(bp, '\n', bend - bp) : NULL;
+            if (eol != NULL) {
+                *bufferPtr = bp;
+                *numBytesPtr = eol - bp + 1;
+                importPtr->blockNext += *numBytesPtr;
                 return TCL_OK;
             }
-            *numBytesPtr = numChars;
-            Tcl_AppendResult(interp, "error reading file: ", 
-                             Tcl_PosixError(interp), (char *)NULL);
-            return TCL_ERROR;
+            if (importPtr->eof) {
+                if (bp == bend) {
+                    *numBytesPtr = 0;   /* EOF */
+                    return TCL_OK;
+                }
+                /* Put back the newline missing from the last line. There's
+                 * always room for one more byte in the block. */
+                importPtr->block[importPtr->blockLength++] = '\n';
+                continue;
+            }
+            if (ReadBlock(interp, importPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
         }
-        /* Put back the newline. */
-        Tcl_DStringAppend(&importPtr->ds, "\n", 1);
-        *numBytesPtr = Tcl_DStringLength(&importPtr->ds);
-        *bufferPtr = Tcl_DStringValue(&importPtr->ds);
     } else {
-        char *bp, *bend;
-        int numBytes;
+        const char *bp, *bend;
+        size_t delta;
+
+        bp = importPtr->next;
+        bend = bp + importPtr->bytesLeft;
+        bp = (bp < bend) ? memchr(bp, '\n', bend - bp) : NULL;
+        bp = (bp == NULL) ? bend : bp + 1; /* Keep the newline. */
 
-        for (bp = importPtr->buffer, bend = bp + importPtr->numBytes; bp < bend;
-             bp++) {
-            if (*bp == '\n') {
-                bp++;                   /* Keep the newline. */
-                break;
-            }
-        }
         /* Do bookkeeping on buffer pointer and size. */
-        *bufferPtr = importPtr->buffer;
-        numBytes = bp - importPtr->buffer;
-        *numBytesPtr = numBytes;
-        importPtr->numBytes -= numBytes; /* Important to reduce bytes left
-                                          * regardless of trailing newline. */
-        if (numBytes > 0) {
+        *bufferPtr = importPtr->next;
+        delta = bp - importPtr->next;
+        *numBytesPtr = delta;
+        importPtr->bytesLeft -= delta;  /* Important to reduce bytes left
+                                         * regardless of trailing
+                                         * newline. */
+        if (delta > 0) {
             if (*(bp-1) != '\n') {
                 /* The last newline has been trimmed.  Append a newline.
-                 * Don't change the data object's string representation. Copy
-                 * the line and append the newline. */
-                assert(*bp == '\0');
-                Tcl_DStringSetLength(&importPtr->ds, 0);
-                Tcl_DStringAppend(&importPtr->ds, importPtr->buffer, numBytes);
-                Tcl_DStringAppend(&importPtr->ds, "\n", 1);
-                *numBytesPtr = Tcl_DStringLength(&importPtr->ds);
-                *bufferPtr = Tcl_DStringValue(&importPtr->ds);
+                 * Don't change the data object's string
+                 * representation. Copy the line and append the newline. */
+                Tcl_DStringSetLength(&importPtr->currLine, 0);
+                Tcl_DStringAppend(&importPtr->currLine, importPtr->next, delta);
+                Tcl_DStringAppend(&importPtr->currLine, "\n", 1);
+                *numBytesPtr = Tcl_DStringLength(&importPtr->currLine);
+                *bufferPtr = Tcl_DStringValue(&importPtr->currLine);
             } else {
-                importPtr->buffer += numBytes;
+                importPtr->next += delta;
             }
         }
     }
     return TCL_OK;
 }
 
+/*
+ * ImportField --
+ *
+ *      Fields parsed from the input are collected into batches of rows.
+ *      The rows of a batch are added to the table at once and the fields
+ *      set column by column.
+ */
+typedef struct {
+    long row;                           /* Row of the field in the
+                                         * batch. */
+    long column;                        /* Column index of the field. */
+    size_t offset;                      /* Offset of the field in the
+                                         * heap. */
+    int length;                         /* # of bytes in the field. */
+} ImportField;
+
+typedef struct {
+    ImportField *fields;                /* Array of fields in the batch. */
+    size_t numFields, numAllocated;
+    Tcl_DString heap;                   /* Holds the bytes of the
+                                         * fields. */
+    long numRows;                       /* # of rows in the batch. */
+    long numColumns;                    /* # of columns needed for the
+                                         * batch. */
+} ImportBatch;
+
+static void
+AddField(ImportBatch *batchPtr, long column, const char *field, int length)
+{
+    ImportField *fieldPtr;
+
+    if (batchPtr->numFields == batchPtr->numAllocated) {
+        batchPtr->numAllocated += batchPtr->numAllocated;
+        if (batchPtr->numAllocated == 0) {
+            batchPtr->numAllocated = 1024;
+        }
+        batchPtr->fields = Blt_AssertRealloc(batchPtr->fields, 
+                batchPtr->numAllocated * sizeof(ImportField));
+    }
+    fieldPtr = batchPtr->fields + batchPtr->numFields;
+    fieldPtr->row = batchPtr->numRows - 1;
+    fieldPtr->column = column;
+    fieldPtr->offset = Tcl_DStringLength(&batchPtr->heap);
+    fieldPtr->length = length;
+    Tcl_DStringAppend(&batchPtr->heap, field, length);
+    batchPtr->numFields++;
+}
+
+/*
+ * InferColumnType --
+ *
+ *      Guesses the type of a column from the fields in the sample.  The
+ *      column is "long" if every field is an integer, "double" if every
+ *      field is a number, and otherwise "string".
+ */
+static BLT_TABLE_COLUMN_TYPE
+InferColumnType(size_t numFields, const char **strings, const int *lengths)
+{
+    BLT_TABLE_COLUMN_TYPE type;
+    size_t i;
+
+    if (numFields == 0) {
+        return TABLE_COLUMN_TYPE_STRING;
+    }
+    type = TABLE_COLUMN_TYPE_LONG;
+    for (i = 0; i < numFields; i++) {
+        char buffer[64];
+        double d;
+        long l;
+
+        if ((lengths[i] == 0) || (lengths[i] >= (int)sizeof(buffer))) {
+            return TABLE_COLUMN_TYPE_STRING;
+        }
+        memcpy(buffer, strings[i], lengths[i]);
+        buffer[lengths[i]] = '\0';
+        if ((type == TABLE_COLUMN_TYPE_LONG) &&
+            (Blt_GetLong(NULL, buffer, &l) == TCL_OK)) {
+            continue;
+        }
+        if (Blt_GetDouble(NULL, buffer, &d) != TCL_OK) {
+            return TABLE_COLUMN_TYPE_STRING;
+        }
+        type = TABLE_COLUMN_TYPE_DOUBLE;
+    }
+    return type;
+}
+
+/*
+ * FlushBatch --
+ *
+ *      Adds the rows of the batch to the table and sets the fields.  If
+ *      the column types are inferred, a column that gets a value that
+ *      doesn't match the inferred type is changed back to "string".
+ */
 static int
-Import(Tcl_Interp *interp, BLT_TABLE table, ImportSwitches *importPtr)
+FlushBatch(Tcl_Interp *interp, BLT_TABLE table, ImportSwitches *importPtr, 
+           ImportBatch *batchPtr)
 {
-    Tcl_DString ds;
-    char *fp, *field;
-    int fieldSize;
-    int inQuotes, state;
+    BLT_TABLE_ROW *rows, *fieldRows;
+    const char **strings;
+    int *lengths;
+    size_t *starts;
+    size_t i;
+    long c;
     int result;
-    long i;
-    BLT_TABLE_ROW row;
-    BLT_TABLE_COLUMN col;
-    const char quote = importPtr->quote[0];
-    const char comment = importPtr->comment[0];
 
+    if (batchPtr->numRows == 0) {
+        return TCL_OK;
+    }
     result = TCL_ERROR;
-    inQuotes = FALSE;
-    row = NULL;
-    i = 0;
-    state = STATE_SEPARATOR;
-    Tcl_DStringInit(&ds);
-    fieldSize = 128;
-    Tcl_DStringSetLength(&ds, fieldSize + 1);
-    fp = field = Tcl_DStringValue(&ds);
-    for (;;) {
-        char *bp, *bend;
-        int numBytes;
-        
-        result = ImportGetLine(interp, importPtr, &bp, &numBytes);
-        if (result != TCL_OK) {
-            goto error;                 /* I/O Error. */
+    rows = Blt_AssertMalloc(batchPtr->numRows * sizeof(BLT_TABLE_ROW));
+    starts = Blt_AssertCalloc(batchPtr->numColumns + 1, sizeof(size_t));
+    fieldRows = Blt_AssertMalloc((batchPtr->numFields + 1) * 
+                                 sizeof(BLT_TABLE_ROW));
+    strings = Blt_AssertMalloc((batchPtr->numFields + 1) * sizeof(char *));
+    lengths = Blt_AssertMalloc((batchPtr->numFields + 1) * sizeof(int));
+    if (blt_table_extend_rows(interp, table, batchPtr->numRows, rows) 
+        != TCL_OK) {
+        goto error;
+    }
+    if (blt_table_num_columns(table) < batchPtr->numColumns) {
+        if (blt_table_extend_columns(interp, table, 
+                batchPtr->numColumns - blt_table_num_columns(table), NULL) 
+            != TCL_OK) {
+            goto error;
         }
-        if (numBytes == 0) {
-            break;                      /* EOF */
+    }
+
+    /* Sort the fields by column, keeping them in row order. */
+    for (i = 0; i < batchPtr->numFields; i++) {
+        starts[batchPtr->fields[i].column + 1]++;
+    }
+    for (c = 0; c < batchPtr->numColumns; c++) {
+        starts[c + 1] += starts[c];
+    }
+    for (i = 0; i < batchPtr->numFields; i++) {
+        ImportField *fieldPtr;
+        size_t j;
+
+        fieldPtr = batchPtr->fields + i;
+        j = starts[fieldPtr->column]++;
+        fieldRows[j] = rows[fieldPtr->row];
+        strings[j] = Tcl_DStringValue(&batchPtr->heap) + fieldPtr->offset;
+        lengths[j] = fieldPtr->length;
+    }
+    for (c = batchPtr->numColumns; c > 0; c--) {
+        starts[c] = starts[c - 1];
+    }
+    starts[0] = 0;
+
+    for (c = 0; c < batchPtr->numColumns; c++) {
+        BLT_TABLE_COLUMN col;
+        size_t first, count;
+        int isInferred;
+
+        first = starts[c];
+        count = starts[c + 1] - first;
+        col = blt_table_column(table, c);
+        isInferred = ((importPtr->flags & IMPORT_INFER_TYPES) && 
+                      (c >= importPtr->firstNewColumn));
+        if ((isInferred) && (!importPtr->typesInferred)) {
+            if (blt_table_set_column_type(interp, table, col, 
+                InferColumnType(count, strings + first, lengths + first))
+                != TCL_OK) {
+                goto error;
+            }
         }
-        bend = bp + numBytes;
-        while ((bp < bend) && (isspace(*bp))) {
-            bp++;                       /* Skip leading spaces. */
+        if (count == 0) {
+            continue;
         }
-        if ((*bp == '\0') || (*bp == comment)) {
-            continue;                   /* Ignore blank or comment lines */
+        if (blt_table_set_string_reps(interp, table, col, count, 
+                fieldRows + first, strings + first, lengths + first) 
+            != TCL_OK) {
+            if ((!isInferred) || 
+                (blt_table_column_type(col) == TABLE_COLUMN_TYPE_STRING)) {
+                goto error;
+            }
+            Tcl_ResetResult(interp);
+            if ((blt_table_set_column_type(interp, table, col, 
+                        TABLE_COLUMN_TYPE_STRING) != TCL_OK) ||
+                (blt_table_set_string_reps(interp, table, col, count, 
+                        fieldRows + first, strings + first, lengths + first) 
+                 != TCL_OK)) {
+                goto error;
+            }
         }
-        for (/*empty*/; bp < bend; bp++) {
-            if (*bp == '\\') {
-                bp++;
-                if (bp == bend) {
-                    goto done;          /* Ignore trailing escape. */
-                }
-                goto collect;
+    }
+    importPtr->typesInferred = TRUE;
+    batchPtr->numRows = 0;
+    batchPtr->numFields = 0;
+    Tcl_DStringSetLength(&batchPtr->heap, 0);
+    result = TCL_OK;
+ error:
+    Blt_Free(rows);
+    Blt_Free(starts);
+    Blt_Free(fieldRows);
+    Blt_Free(strings);
+    Blt_Free(lengths);
+    return result;
+}
+
+#define ONES    ((uint64_t)0x0101010101010101ULL)
+#define HIGHS   ((uint64_t)0x8080808080808080ULL)
+#define HasZeroByte(w)  (((w) - ONES) & ~(w) & HIGHS)
+#define HasLessThan(w,n) (((w) - ONES * (n)) & ~(w) & HIGHS)
+
+/* Whitespace, as tested by isspace in the "C" locale. */
+#define IsBlank(c)      (((c) == ' ') || (((c) >= '\t') && ((c) <= '\r')))
+
+/*
+ * ScanToBreak --
+ *
+ *      Returns a pointer to the first character in the buffer that ends a
+ *      run of ordinary characters: whitespace, the quote character, or a
+ *      backslash.  If inQuotes is set, whitespace is ordinary.  Eight bytes
+ *      are tested at a time.  A word with a control character that isn't
+ *      whitespace is checked a byte at a time.
+ */
+static INLINE const char *
+ScanToBreak(const char *bp, const char *bend, char quote, int inQuotes)
+{
+    uint64_t mq, mb;
+
+    mq = ONES * (unsigned char)quote, mb = ONES * '\\';
+    for (;;) {
+        const char *stop;
+
+        while ((bend - bp) >= 8) {
+            uint64_t w, m;
+
+            memcpy(&w, bp, 8);
+            m = HasZeroByte(w ^ mq) | HasZeroByte(w ^ mb);
+            if (!inQuotes) {
+                m |= HasLessThan(w, 0x21);
             }
-            if (isspace(*bp)) {
-                if (inQuotes) {
-                    goto collect;
-                } else {
-                    /* Transition from value to whitespace. */
-                    if ((state == STATE_FIELD) && (fp > field)) {
-                        *fp++ = '\0';
-                        if (row == NULL) {
-                            if (blt_table_extend_rows(interp, table, 1, &row)
-                                != TCL_OK) {
-                                goto error;
-                            }
-                            if ((importPtr->maxRows > 0) && 
-                                (blt_table_num_rows(table)>importPtr->maxRows)){
-                                bp = bend;
-                                goto done;
-                            }
-                        } 
-                        if (i >= blt_table_num_columns(table)) {
-                            if (blt_table_extend_columns(interp, table, 1, &col) 
-                                != TCL_OK) {
-                                goto error;
-                            }
-                        } else {
-                            col = blt_table_column(table, i);
-                        }
-                        i++;
-                        if (blt_table_set_string_rep(interp, table, row, col,
-                                field, fp - field) != TCL_OK) {
-                            goto error;
-                        }
-                    }
-                    /* Transition from value to newline. */
-                    if (*bp == '\n') {
-                        state = STATE_SEPARATOR;
-                        if (fp == field) {
-                            continue;   /* Ignore empty lines. */
-                        } 
-                        row = NULL;     /* Indicate end of record. */
-                        i = 0;
-                    } 
-                }
-                state = STATE_SEPARATOR;
-            } else if (*bp == quote) {
-                inQuotes ^= 1;
-                continue;
-            } else {
-            collect:
-                /* Transition from whitespace to value. */
-                if (state == STATE_SEPARATOR) {
-                    state = STATE_FIELD;
-                    fp = field;
-                }
-                *fp++ = *bp;
-                if ((fp - field) >= fieldSize) {
-                    int offset;
-                    
-                    /* 
-                     * We've exceeded the current maximum size of the field.
-                     * Double the size of the field, but make sure to reset the
-                     * pointers to the (possibly) new memory location.
-                     */
-                    offset = fp - field;
-                    fieldSize += fieldSize;
-                    Tcl_DStringSetLength(&ds, fieldSize + 1);
-                    field = Tcl_DStringValue(&ds);
-                    fp = field + offset;
-                }
+            if (m) {
+                break;
             }
+            bp += 8;
+        }
+        stop = ((bend - bp) >= 8) ? bp + 8 : bend;
+        for (/*empty*/; bp < stop; bp++) {
+            if ((*bp == quote) || (*bp == '\\') || 
+                ((!inQuotes) && (IsBlank(*bp)))) {
+                return bp;
+            }
+        }
+        if (bp == bend) {
+            return bp;
+        }
+    }
+}
+
+/*
+ * ImportParser --
+ *
+ *      State of the parser between lines.  A field may continue over
+ *      several lines if it's quoted or the newline is escaped.
+ */
+typedef struct {
+    Tcl_DString ds;                     /* Holds the current field. */
+    char *field;                        /* Start of the current field. */
+    char *fp;                           /* Next character in the field. */
+    int fieldSize;                      /* # of bytes available for the
+                                         * field. */
+    int inQuotes;
+    int inRow;                          /* Indicates a row has been started
+                                         * for the current line. */
+    long column;                        /* Index of the current field in
+                                         * the row. */
+    ImportBatch batch;                  /* Rows parsed but not yet added to
+                                         * the table. */
+} ImportParser;
+
+/* Indicates the parser is between rows. */
+#define AtEndOfRow(p) \
+    ((!(p)->inRow) && (!(p)->inQuotes) && ((p)->fp == (p)->field))
+
+static void
+InitParser(ImportParser *parserPtr)
+{
+    memset(parserPtr, 0, sizeof(ImportParser));
+    Tcl_DStringInit(&parserPtr->batch.heap);
+    Tcl_DStringInit(&parserPtr->ds);
+    parserPtr->fieldSize = 128;
+    Tcl_DStringSetLength(&parserPtr->ds, parserPtr->fieldSize + 1);
+    parserPtr->fp = parserPtr->field = Tcl_DStringValue(&parserPtr->ds);
+}
+
+static void
+FreeParser(ImportParser *parserPtr)
+{
+    Tcl_DStringFree(&parserPtr->ds);
+    Tcl_DStringFree(&parserPtr->batch.heap);
+    if (parserPtr->batch.fields != NULL) {
+        Blt_Free(parserPtr->batch.fields);
+    }
+}
+
+/*
+ * ParseTokens --
+ *
+ *      Parses a single line of whitespace separated fields, adding them to
+ *      the parser's batch.  Quotes group whitespace into a field and are
+ *      removed. A backslash escapes the next character.  The line always
+ *      ends with a newline.  If maxRows is non-negative, no more than
+ *      maxRows rows are started in the batch.  Returns TRUE if the line
+ *      would have started a row past maxRows.
+ */
+static int
+ParseTokens(ImportSwitches *importPtr, ImportParser *parserPtr, 
+            const char *bp, const char *bend, long maxRows)
+{
+    ImportBatch *batchPtr = &parserPtr->batch;
+    char *fp, *field;
+    const char quote = importPtr->quoteChar;
+
+    fp = parserPtr->fp;
+    field = parserPtr->field;
+    if ((fp == field) && (!parserPtr->inQuotes)) {
+        while ((bp < bend) && (IsBlank(*bp))) {
+            bp++;                       /* Skip leading spaces. */
+        }
+        if ((bp == bend) || ((importPtr->commentChar != '\0') && 
+                             (*bp == importPtr->commentChar))) {
+            return FALSE;               /* Ignore blank or comment lines */
         }
-    done:
-        if (numBytes < 1) {
+    }
+    for (/*empty*/; bp < bend; bp++) {
+        const char *run;
+        int offset;
+
+        /* Copy the ordinary characters up to the next break in a single
+         * step. */
+        run = ScanToBreak(bp, bend, quote, parserPtr->inQuotes);
+        offset = fp - field;
+        if ((offset + (run - bp) + 1) >= parserPtr->fieldSize) {
             /* 
-             * We're reached the end of input. But there may not have been a
-             * final newline to trigger the final append. So check if a last
-             * field is still needs appending the the last row.
+             * We've exceeded the current maximum size of the field.
+             * Double the size of the field, but make sure to reset the
+             * pointers to the (possibly) new memory location.
              */
+            while ((offset + (run - bp) + 1) >= parserPtr->fieldSize) {
+                parserPtr->fieldSize += parserPtr->fieldSize;
+            }
+            Tcl_DStringSetLength(&parserPtr->ds, parserPtr->fieldSize + 1);
+            field = Tcl_DStringValue(&parserPtr->ds);
+            fp = field + offset;
+        }
+        if (run > bp) {
+            memcpy(fp, bp, run - bp);
+            fp += run - bp;
+            bp = run;
+            if (bp == bend) {
+                break;
+            }
+        }
+        if (*bp == '\\') {
+            bp++;
+            if (bp == bend) {
+                break;                  /* Ignore trailing escape. */
+            }
+            *fp++ = *bp;
+        } else if (*bp == quote) {
+            parserPtr->inQuotes ^= 1;
+        } else if (parserPtr->inQuotes) {
+            *fp++ = *bp;                /* Copy quoted whitespace. */
+        } else {
+            /* Transition from value to whitespace. */
             if (fp > field) {
-                if (row == NULL) {
-                    if (blt_table_extend_rows(interp, table, 1, &row) != TCL_OK){
-                        goto error;
+                if (!parserPtr->inRow) {
+                    if ((maxRows >= 0) && (batchPtr->numRows >= maxRows)) {
+                        parserPtr->fp = fp;
+                        parserPtr->field = field;
+                        return TRUE;
                     }
+                    parserPtr->inRow = TRUE;
+                    batchPtr->numRows++;
                 }
-                col = blt_table_get_column_by_index(table, i);
-                if (col == NULL) {
-                    if (blt_table_extend_columns(interp, table, 1, &col) 
-                        != TCL_OK) {
-                        goto error;
-                    }
-                }                       
-                if (blt_table_set_string_rep(interp, table, row, col, field,
-                        fp - field) != TCL_OK) {
-                    goto error;
+                if (parserPtr->column >= batchPtr->numColumns) {
+                    batchPtr->numColumns = parserPtr->column + 1;
                 }
-            }           
+                AddField(batchPtr, parserPtr->column, field, fp - field);
+                parserPtr->column++;
+                fp = field;
+            }
+            if (*bp == '\n') {
+                parserPtr->inRow = FALSE; /* End of record. */
+                parserPtr->column = 0;
+            }
+        }
+    }
+    parserPtr->fp = fp;
+    parserPtr->field = field;
+    return FALSE;
+}
+
+/*
+ * ParseFixedWidths --
+ *
+ *      Parses a single line of fixed-width columns, adding them to the
+ *      parser's batch.  The line is sliced by the column widths, counted
+ *      in characters.  Leading and trailing spaces are removed from each
+ *      column.  Characters past the last column are ignored.  Returns TRUE
+ *      if the line would have started a row past maxRows.
+ */
+static int
+ParseFixedWidths(ImportSwitches *importPtr, ImportParser *parserPtr, 
+                 const char *bp, const char *bend, long maxRows)
+{
+    ImportBatch *batchPtr = &parserPtr->batch;
+    const char *p;
+    int i;
+
+    if ((bend > bp) && (bend[-1] == '\n')) {
+        bend--;
+    }
+    if ((bend > bp) && (bend[-1] == '\r')) {
+        bend--;
+    }
+    for (p = bp; (p < bend) && (IsBlank(*p)); p++) {
+        /*empty*/
+    }
+    if ((p == bend) || ((importPtr->commentChar != '\0') && 
+                        (*p == importPtr->commentChar))) {
+        return FALSE;                   /* Ignore blank or comment lines */
+    }
+    if ((maxRows >= 0) && (batchPtr->numRows >= maxRows)) {
+        return TRUE;
+    }
+    batchPtr->numRows++;
+    if (importPtr->numWidths > batchPtr->numColumns) {
+        batchPtr->numColumns = importPtr->numWidths;
+    }
+    for (i = 0; (i < importPtr->numWidths) && (bp < bend); i++) {
+        const char *first, *last;
+        int count;
+
+        first = bp;
+        for (count = importPtr->widths[i]; (count > 0) && (bp < bend); 
+             count--) {
+            bp++;
+            while ((bp < bend) && ((*bp & 0xC0) == 0x80)) {
+                bp++;                   /* Skip UTF-8 continuation bytes. */
+            }
+        }
+        last = bp;
+        while ((first < last) && (IsBlank(*first))) {
+            first++;
+        }
+        while ((last > first) && (IsBlank(last[-1]))) {
+            last--;
+        }
+        if (last > first) {
+            AddField(batchPtr, i, first, last - first);
+        }
+    }
+    return FALSE;
+}
+
+static INLINE int
+ParseLine(ImportSwitches *importPtr, ImportParser *parserPtr, const char *bp,
+          const char *bend, long maxRows)
+{
+    if (importPtr->widths != NULL) {
+        return ParseFixedWidths(importPtr, parserPtr, bp, bend, maxRows);
+    }
+    return ParseTokens(importPtr, parserPtr, bp, bend, maxRows);
+}
+
+/*
+ * ImportChunk --
+ *
+ *      Part of the input parsed by a single thread.  The chunk starts at
+ *      the beginning of a line.  It's assumed that the line also starts a
+ *      row, which is true unless the previous chunk ends inside of a quoted
+ *      or escaped field.  The chunk is parsed up to the first line at or
+ *      after "end" that starts a new row.
+ */
+typedef struct {
+    const char *start;                  /* First line of the chunk. */
+    const char *end;                    /* Start of the next chunk. */
+    const char *next;                   /* Line after the last line
+                                         * parsed. */
+    ImportParser parser;
+} ImportChunk;
+
+typedef struct {
+    ImportSwitches *importPtr;
+    ImportChunk *chunks;
+    const char *bend;                   /* End of the input. The input
+                                         * always ends with a newline. */
+} ImportChunks;
+
+static void
+ParseChunk(ImportSwitches *importPtr, ImportChunk *chunkPtr, const char *bend)
+{
+    const char *bp;
+
+    bp = chunkPtr->start;
+    while (bp < bend) {
+        const char *eol;
+
+        if ((bp >= chunkPtr->end) && (AtEndOfRow(&chunkPtr->parser))) {
             break;
-        }    
+        }
+        eol = memchr(bp, '\n', bend - bp);
+        ParseLine(importPtr, &chunkPtr->parser, bp, eol + 1, -1);
+        bp = eol + 1;
+    }
+    chunkPtr->next = bp;
+}
+
+static void
+ParseChunksProc(ClientData clientData, long first, long last, int worker)
+{
+    ImportChunks *chunksPtr = clientData;
+    long i;
+
+    for (i = first; i < last; i++) {
+        ParseChunk(chunksPtr->importPtr, chunksPtr->chunks + i, 
+                   chunksPtr->bend);
+    }
+}
+
+/*
+ * ImportChunked --
+ *
+ *      Parses the rest of the input with several threads.  The input is
+ *      split into chunks at line boundaries.  Each chunk is parsed into its
+ *      own batch.  The batches are then added to the table in order.  If a
+ *      field crosses into the next chunk, that chunk started in the wrong
+ *      state: it's parsed again from where the previous chunk ended.  The
+ *      result is the same as parsing the input serially.
+ */
+static int
+ImportChunked(Tcl_Interp *interp, BLT_TABLE table, ImportSwitches *importPtr, 
+              int numThreads)
+{
+    ImportChunks chunks;
+    char *buffer;
+    const char *bp, *bend;
+    size_t length;
+    long i, numChunks;
+    int result;
+
+    /* Collect the rest of the input into a single buffer ending with a
+     * newline. */
+    if (importPtr->channel != NULL) {
+        importPtr->keepBlock = TRUE;
+        while (!importPtr->eof) {
+            if (ReadBlock(interp, importPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+        }
+        bp = importPtr->block + importPtr->blockNext;
+        length = importPtr->blockLength - importPtr->blockNext;
+    } else {
+        bp = importPtr->next;
+        length = importPtr->bytesLeft;
+    }
+    buffer = Blt_AssertMalloc(length + 2);
+    memcpy(buffer, bp, length);
+    if ((length > 0) && (buffer[length - 1] != '\n')) {
+        buffer[length++] = '\n';
+    }
+    buffer[length] = '\0';
+    bend = buffer + length;
+
+    numChunks = length / IMPORT_CHUNK_SIZE;
+    if (numChunks > numThreads) {
+        numChunks = numThreads;
+    }
+    if (numChunks < 1) {
+        numChunks = 1;
     }
+    chunks.importPtr = importPtr;
+    chunks.bend = bend;
+    chunks.chunks = Blt_AssertMalloc(numChunks * sizeof(ImportChunk));
+    for (i = 0; i < numChunks; i++) {
+        ImportChunk *chunkPtr;
+
+        chunkPtr = chunks.chunks + i;
+        InitParser(&chunkPtr->parser);
+        chunkPtr->start = chunkPtr->end = bend;
+        if (i == 0) {
+            chunkPtr->start = buffer;
+        } else {
+            const char *eol;
+            
+            bp = buffer + (length * i / numChunks) - 1;
+            if (bp < chunkPtr[-1].start) {
+                bp = chunkPtr[-1].start;
+            }
+            eol = memchr(bp, '\n', bend - bp);
+            chunkPtr->start = eol + 1;
+            chunkPtr[-1].end = chunkPtr->start;
+        }
+    }
+    blt_table_run_workers(numChunks, numChunks, ParseChunksProc, &chunks);
+
     result = TCL_OK;
+    bp = buffer;
+    for (i = 0; i < numChunks; i++) {
+        ImportChunk *chunkPtr;
+
+        chunkPtr = chunks.chunks + i;
+        if (chunkPtr->start != bp) {
+            /* The previous chunk ended past the start of this one. */
+            FreeParser(&chunkPtr->parser);
+            InitParser(&chunkPtr->parser);
+            chunkPtr->start = bp;
+            ParseChunk(importPtr, chunkPtr, bend);
+        }
+        bp = chunkPtr->next;
+        if (result == TCL_OK) {
+            result = FlushBatch(interp, table, importPtr, 
+                                &chunkPtr->parser.batch);
+        }
+        FreeParser(&chunkPtr->parser);
+    }
+    Blt_Free(chunks.chunks);
+    Blt_Free(buffer);
+    return result;
+}
+
+static int
+Import(Tcl_Interp *interp, BLT_TABLE table, ImportSwitches *importPtr)
+{
+    ImportParser parser;
+    int numThreads;
+    int result;
+
+    numThreads = importPtr->numThreads;
+    if (numThreads == 0) {
+        numThreads = blt_table_get_threads(interp);
+    }
+    importPtr->firstNewColumn = blt_table_num_columns(table);
+    InitParser(&parser);
+    for (;;) {
+        const char *bp;
+        size_t numBytes;
+        long maxRows;
+
+        result = ImportGetLine(interp, importPtr, &bp, &numBytes);
+        if (result != TCL_OK) {
+            goto error;                 /* I/O Error. */
+        }
+        if (numBytes == 0) {
+            break;                      /* EOF */
+        }
+        maxRows = -1;
+        if (importPtr->maxRows > 0) {
+            maxRows = importPtr->maxRows - blt_table_num_rows(table);
+        }
+        if (ParseLine(importPtr, &parser, bp, bp + numBytes, maxRows)) {
+            break;
+        }
+        if ((AtEndOfRow(&parser)) && 
+            (parser.batch.numRows >= IMPORT_BATCH_SIZE)) {
+            result = FlushBatch(interp, table, importPtr, &parser.batch);
+            if (result != TCL_OK) {
+                goto error;
+            }
+            /* 
+             * The first batch is always parsed serially, so the column
+             * types are set the same way.  The rest of the input can be
+             * split between threads.
+             */
+            if ((numThreads > 1) && (importPtr->maxRows == 0)) {
+                result = ImportChunked(interp, table, importPtr, numThreads);
+                goto error;
+            }
+        }
+    }
+    result = FlushBatch(interp, table, importPtr, &parser.batch);
  error:
-    Tcl_DStringFree(&ds);
+    FreeParser(&parser);
     return result;
 }
 
+/*
+ * GetWidths --
+ *
+ *      Converts the list of column widths given by the -widths switch.
+ */
+static int
+GetWidths(Tcl_Interp *interp, ImportSwitches *importPtr)
+{
+    Tcl_Obj **objv;
+    int objc, i;
+
+    if (Tcl_ListObjGetElements(interp, importPtr->widthsObjPtr, &objc, &objv)
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
+    if (objc == 0) {
+        Tcl_AppendResult(interp, "no column widths specified", (char *)NULL);
+        return TCL_ERROR;
+    }
+    importPtr->widths = Blt_AssertMalloc(objc * sizeof(int));
+    importPtr->numWidths = objc;
+    for (i = 0; i < objc; i++) {
+        int width;
+
+        if (Tcl_GetIntFromObj(interp, objv[i], &width) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (width <= 0) {
+            Tcl_AppendResult(interp, "bad column width \"", 
+                Tcl_GetString(objv[i]), "\": must be positive", (char *)NULL);
+            return TCL_ERROR;
+        }
+        importPtr->widths[i] = width;
+    }
+    return TCL_OK;
+}
+
 static int
 ImportProc(BLT_TABLE table, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
 {
@@ -721,6 +1390,7 @@ ImportProc(BLT_TABLE table, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
     switches.quote      = Blt_AssertStrdup("\"");
     switches.comment    = Blt_AssertStrdup("#");
     Blt_InitHashTable(&switches.dataTable, BLT_STRING_KEYS);
+    Tcl_DStringInit(&switches.currLine);
     if (Blt_ParseSwitches(interp, importSwitches, objc - 3 , objv + 3, 
         &switches, BLT_SWITCH_DEFAULTS) < 0) {
         return TCL_ERROR;
@@ -731,16 +1401,22 @@ ImportProc(BLT_TABLE table, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
                          (char *)NULL);
         goto error;
     }
+    if ((switches.widthsObjPtr != NULL) && 
+        (GetWidths(interp, &switches) != TCL_OK)) {
+        goto error;
+    }
+    switches.quoteChar = (switches.quote != NULL) ? switches.quote[0] : '\0';
+    switches.commentChar = 
+        (switches.comment != NULL) ? switches.comment[0] : '\0';
     if (switches.dataObjPtr != NULL) {
         int numBytes;
 
         switches.channel = NULL;
         switches.buffer = Tcl_GetStringFromObj(switches.dataObjPtr, &numBytes);
-        switches.numBytes = numBytes;
+        switches.next = switches.buffer;
+        switches.bytesLeft = switches.numBytes = numBytes;
         switches.fileObjPtr = NULL;
-        Tcl_DStringInit(&switches.ds);
         result = Import(interp, table, &switches);
-        Tcl_DStringFree(&switches.ds);
     } else {
         int closeChannel;
         Tcl_Channel channel;
@@ -771,15 +1447,27 @@ ImportProc(BLT_TABLE table, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
                 goto error;
             }
         }
-        switches.channel = channel;
-        Tcl_DStringInit(&switches.ds);
-        result = Import(interp, table, &switches);
-        Tcl_DStringFree(&switches.ds);
+        if ((switches.encodingObjPtr == NULL) ||
+            (Tcl_SetChannelOption(interp, channel, "-encoding", 
+                Tcl_GetString(switches.encodingObjPtr)) == TCL_OK)) {
+            switches.channel = channel;
+            switches.readObjPtr = Tcl_NewObj();
+            Tcl_IncrRefCount(switches.readObjPtr);
+            result = Import(interp, table, &switches);
+            Tcl_DecrRefCount(switches.readObjPtr);
+        }
         if (closeChannel) {
             Tcl_Close(interp, channel);
         }
     }
  error:
+    Tcl_DStringFree(&switches.currLine);
+    if (switches.block != NULL) {
+        Blt_Free(switches.block);
+    }
+    if (switches.widths != NULL) {
+        Blt_Free(switches.widths);
+    }
     Blt_FreeSwitches(importSwitches, (char *)&switches, 0);
     Blt_DeleteHashTable(&switches.dataTable);
     return result;
@@ -54,6 +54,8 @@ BLT_EXTERN Tcl_AppInitProc blt_table_txt_init;
 BLT_EXTERN Tcl_AppInitProc blt_table_txt_safe_init;
 BLT_EXTERN Tcl_AppInitProc blt_table_csv_init;
 BLT_EXTERN Tcl_AppInitProc blt_table_csv_safe_init;
+BLT_EXTERN Tcl_AppInitProc blt_table_arrow_init;
+BLT_EXTERN Tcl_AppInitProc blt_table_arrow_safe_init;
 #ifdef HAVE_LIBMYSQL
 BLT_EXTERN Tcl_AppInitProc blt_table_mysql_init;
 BLT_EXTERN Tcl_AppInitProc blt_table_mysql_safe_init;
@@ -93,6 +95,12 @@ Blt_TclPkgsInit(Tcl_Interp *interp)     /* Interpreter for application. */
     }
     Tcl_StaticPackage(interp, "blt_datatable_csv", blt_table_csv_init, 
         blt_table_csv_safe_init);
+    /* ARROW */
+    if (blt_table_arrow_init(interp) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    Tcl_StaticPackage(interp, "blt_datatable_arrow", blt_table_arrow_init, 
+        blt_table_arrow_safe_init);
     /* MYSQL */
 #ifdef HAVE_LIBMYSQL
     if (blt_table_mysql_init(interp) != TCL_OK) {
@@ -1681,7 +1681,7 @@ BLT_EXTERN int		Blt_VectorNotifyPending(Blt_VectorId clientId);
 #define Blt_CreateVector_DECLARED
 /* 269 */
 BLT_EXTERN int		Blt_CreateVector(Tcl_Interp *interp,
-				const char *vecName, int size,
+				const char *vecName, long size,
 				Blt_Vector **vecPtrPtr);
 #endif
 #ifndef Blt_CreateVector2_DECLARED
@@ -1689,7 +1689,7 @@ BLT_EXTERN int		Blt_CreateVector(Tcl_Interp *interp,
 /* 270 */
 BLT_EXTERN int		Blt_CreateVector2(Tcl_Interp *interp,
 				const char *vecName, const char *cmdName,
-				const char *varName, int initialSize,
+				const char *varName, long initialSize,
 				Blt_Vector **vecPtrPtr);
 #endif
 #ifndef Blt_GetVector_DECLARED
@@ -1714,12 +1714,12 @@ BLT_EXTERN int		Blt_VectorExists(Tcl_Interp *interp,
 #define Blt_ResetVector_DECLARED
 /* 274 */
 BLT_EXTERN int		Blt_ResetVector(Blt_Vector *vecPtr, double *dataArr,
-				int n, int arraySize, Tcl_FreeProc *freeProc);
+				long n, long arraySize, Tcl_FreeProc *freeProc);
 #endif
 #ifndef Blt_ResizeVector_DECLARED
 #define Blt_ResizeVector_DECLARED
 /* 275 */
-BLT_EXTERN int		Blt_ResizeVector(Blt_Vector *vecPtr, int n);
+BLT_EXTERN int		Blt_ResizeVector(Blt_Vector *vecPtr, long n);
 #endif
 #ifndef Blt_DeleteVectorByName_DECLARED
 #define Blt_DeleteVectorByName_DECLARED
@@ -2029,13 +2029,13 @@ typedef struct BltTclProcs {
     const char * (*blt_NameOfVectorId) (Blt_VectorId clientId); /* 266 */
     const char * (*blt_NameOfVector) (Blt_Vector *vecPtr); /* 267 */
     int (*blt_VectorNotifyPending) (Blt_VectorId clientId); /* 268 */
-    int (*blt_CreateVector) (Tcl_Interp *interp, const char *vecName, int size, Blt_Vector **vecPtrPtr); /* 269 */
-    int (*blt_CreateVector2) (Tcl_Interp *interp, const char *vecName, const char *cmdName, const char *varName, int initialSize, Blt_Vector **vecPtrPtr); /* 270 */
+    int (*blt_CreateVector) (Tcl_Interp *interp, const char *vecName, long size, Blt_Vector **vecPtrPtr); /* 269 */
+    int (*blt_CreateVector2) (Tcl_Interp *interp, const char *vecName, const char *cmdName, const char *varName, long initialSize, Blt_Vector **vecPtrPtr); /* 270 */
     int (*blt_GetVector) (Tcl_Interp *interp, const char *vecName, Blt_Vector **vecPtrPtr); /* 271 */
     int (*blt_GetVectorFromObj) (Tcl_Interp *interp, Tcl_Obj *objPtr, Blt_Vector **vecPtrPtr); /* 272 */
     int (*blt_VectorExists) (Tcl_Interp *interp, const char *vecName); /* 273 */
-    int (*blt_ResetVector) (Blt_Vector *vecPtr, double *dataArr, int n, int arraySize, Tcl_FreeProc *freeProc); /* 274 */
-    int (*blt_ResizeVector) (Blt_Vector *vecPtr, int n); /* 275 */
+    int (*blt_ResetVector) (Blt_Vector *vecPtr, double *dataArr, long n, long arraySize, Tcl_FreeProc *freeProc); /* 274 */
+    int (*blt_ResizeVector) (Blt_Vector *vecPtr, long n); /* 275 */
     int (*blt_DeleteVectorByName) (Tcl_Interp *interp, const char *vecName); /* 276 */
     int (*blt_DeleteVector) (Blt_Vector *vecPtr); /* 277 */
     int (*blt_ExprVector) (Tcl_Interp *interp, char *expr, Blt_Vector *vecPtr); /* 278 */
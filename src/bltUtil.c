@@ -1172,11 +1172,12 @@ LinearOpSearch(Blt_OpSpec *specs, int low, int high, const char *string,
     for (specPtr = specs+low, i = low; i <= high; i++, specPtr++) {
         if ((c == specPtr->name[0]) && 
             (strncmp(string, specPtr->name, length) == 0)) {
-            last = i;
-            numMatches++;
             if (length == specPtr->minChars) {
-                break;
+                return i;               /* Abbreviation reserved for this
+                                         * operation. */
             }
+            last = i;
+            numMatches++;
         }
     }
     if (numMatches > 1) {
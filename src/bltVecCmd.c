@@ -91,7 +91,7 @@ static Blt_SwitchCustom indexSwitch = {
 
 typedef struct {
     Tcl_Obj *formatObjPtr;
-    int from, to;
+    long from, to;
     int empty;
 } ValuesSwitches;
 
@@ -109,7 +109,7 @@ static Blt_SwitchSpec valuesSwitches[] =
 };
 
 typedef struct {
-    int from, to;
+    long from, to;
     int empty;
     Tcl_Obj *dataObjPtr;
     Tcl_Obj *fileObjPtr;
@@ -131,7 +131,7 @@ static Blt_SwitchSpec exportSwitches[] =
 };
 
 typedef struct {
-    int from, to;
+    long from, to;
 } PrintSwitches;
 
 static Blt_SwitchSpec printSwitches[] = 
@@ -187,9 +187,17 @@ static Blt_SwitchSpec fftSwitches[] = {
     {BLT_SWITCH_BITS_NOARG, "-bartlett",  "", (char *)NULL,
          Blt_Offset(FFTData, mask), 0, FFT_BARTLETT},
     {BLT_SWITCH_DOUBLE, "-delta",   "float", (char *)NULL,
-        Blt_Offset(FFTData, mask), 0, 0, },
+        Blt_Offset(FFTData, delta), 0, 0, },
     {BLT_SWITCH_CUSTOM, "-frequencies", "vector", (char *)NULL,
         Blt_Offset(FFTData, freqPtr), 0, 0, &fftVectorSwitch},
+    {BLT_SWITCH_BITS_NOARG, "-nopad", "", (char *)NULL,
+        Blt_Offset(FFTData, mask), 0, FFT_NO_PAD},
+    {BLT_SWITCH_END}
+};
+
+static Blt_SwitchSpec inverseFftSwitches[] = {
+    {BLT_SWITCH_BITS_NOARG, "-nopad", "", (char *)NULL,
+        Blt_Offset(FFTData, mask), 0, FFT_NO_PAD},
     {BLT_SWITCH_END}
 };
 
@@ -311,8 +319,8 @@ ObjToIndex(
     int flags)                          /* Not used. */
 {
     Vector *vPtr = clientData;
-    int *indexPtr = (int *)(record + offset);
-    int index;
+    long *indexPtr = (long *)(record + offset);
+    long index;
 
     if (Blt_Vec_GetIndex(interp, vPtr, Tcl_GetString(objPtr), &index)!=TCL_OK) {
         return TCL_ERROR;
@@ -323,10 +331,10 @@ ObjToIndex(
 }
 
 static Tcl_Obj *
-GetValues(Vector *srcPtr, int first, int last)
+GetValues(Vector *srcPtr, long first, long last)
 { 
     Tcl_Obj *listObjPtr;
-    int i;
+    long i;
 
     listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
     for (i = first; i < last; i++) {
@@ -339,9 +347,9 @@ GetValues(Vector *srcPtr, int first, int last)
 }
 
 static void
-ReplicateValue(Vector *destPtr, int first, int last, double value)
+ReplicateValue(Vector *destPtr, long first, long last, double value)
 { 
-    int i;
+    long i;
  
     for (i = first; i < last; i++) {
         destPtr->valueArr[i] = value; 
@@ -372,8 +380,8 @@ CopyList(Vector *vPtr, Tcl_Interp *interp, int objc, Tcl_Obj *const *objv)
 static int
 AppendVector(Vector *destPtr, Vector *srcPtr)
 {
-    int numBytes;
-    int oldSize, newSize;
+    size_t numBytes;
+    long oldSize, newSize;
 
     oldSize = destPtr->length;
     newSize = oldSize + srcPtr->length;
@@ -390,10 +398,10 @@ static int
 AppendObjv(Vector *vPtr, int objc, Tcl_Obj *const *objv)
 {
     Tcl_Interp *interp = vPtr->interp;
-    int count;
+    long count;
     int i;
     double value;
-    int oldSize;
+    long oldSize;
 
     oldSize = vPtr->length;
     if (Blt_Vec_ChangeLength(interp, vPtr, vPtr->length + objc) != TCL_OK) {
@@ -716,6 +724,7 @@ FFTOp(ClientData clientData, Tcl_Interp *interp, int objc,
     
     memset(&data, 0, sizeof(data));
     data.delta = 1.0;
+    data.dataPtr = vPtr->dataPtr;
 
     if (GetVector(interp, vPtr->dataPtr, objv[2], &realVecPtr) != TCL_OK) {
         return TCL_ERROR;
@@ -755,7 +764,7 @@ FFTOp(ClientData clientData, Tcl_Interp *interp, int objc,
 
 /*ARGSUSED*/
 /* 
- *      vecName inversefft srcImag destReal destImag 
+ *      vecName inversefft srcImag destReal destImag ?-nopad?
  */
 static int
 InverseFFTOp(ClientData clientData, Tcl_Interp *interp, int objc,
@@ -765,6 +774,7 @@ InverseFFTOp(ClientData clientData, Tcl_Interp *interp, int objc,
     Vector *srcImagPtr;
     Vector *destRealPtr;
     Vector *destImagPtr;
+    FFTData data;
 
     if (GetVector(interp, vPtr->dataPtr, objv[2], &srcImagPtr) != TCL_OK) {
         return TCL_ERROR;
@@ -773,8 +783,13 @@ InverseFFTOp(ClientData clientData, Tcl_Interp *interp, int objc,
         (GetVector(interp, vPtr->dataPtr, objv[4], &destImagPtr) != TCL_OK)) {
         return TCL_ERROR;
     }
-    if (Blt_Vec_InverseFFT(interp, srcImagPtr, destRealPtr, destImagPtr, vPtr) 
-        != TCL_OK ){
+    memset(&data, 0, sizeof(data));
+    if (Blt_ParseSwitches(interp, inverseFftSwitches, objc - 5, objv + 5, 
+        &data, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    if (Blt_Vec_InverseFFT(interp, srcImagPtr, destRealPtr, destImagPtr, 
+        data.mask, vPtr) != TCL_OK ){
         return TCL_ERROR;
     }
     if (destRealPtr->flush) {
@@ -811,9 +826,9 @@ LengthOp(ClientData clientData, Tcl_Interp *interp, int objc,
     Vector *vPtr = clientData;
 
     if (objc == 3) {
-        int numElem;
+        long numElem;
 
-        if (Tcl_GetIntFromObj(interp, objv[2], &numElem) != TCL_OK) {
+        if (Blt_GetLongFromObj(interp, objv[2], &numElem) != TCL_OK) {
             return TCL_ERROR;
         }
         if (numElem < 0) {
@@ -831,7 +846,7 @@ LengthOp(ClientData clientData, Tcl_Interp *interp, int objc,
         }
         Blt_Vec_UpdateClients(vPtr);
     }
-    Tcl_SetIntObj(Tcl_GetObjResult(interp), vPtr->length);
+    Tcl_SetLongObj(Tcl_GetObjResult(interp), vPtr->length);
     return TCL_OK;
 }
 
@@ -977,7 +992,7 @@ MergeOp(ClientData clientData, Tcl_Interp *interp, int objc,
     valueArr = Blt_Malloc(sizeof(double) * numElem);
     if (valueArr == NULL) {
         Tcl_AppendResult(vPtr->interp, "not enough memory to allocate ", 
-                 Blt_Itoa(numElem), " vector elements", (char *)NULL);
+                 Blt_Ltoa(numElem), " vector elements", (char *)NULL);
         return TCL_ERROR;
     }
 
@@ -1165,7 +1180,7 @@ PackOp(ClientData clientData, Tcl_Interp *interp, int objc,
        Tcl_Obj *const *objv)
 {
     Vector *vPtr = clientData;
-    int i, j;
+    long i, j;
 
     for (i = 0, j = 0; i < vPtr->length; i++) {
         if (FINITE(vPtr->valueArr[i])) {
@@ -1273,7 +1288,7 @@ ValueGetOp(ClientData clientData, Tcl_Interp *interp, int objc,
            Tcl_Obj *const *objv)
 {
     Vector *vPtr = clientData;
-    int first, last;
+    long first, last;
     Blt_VectorIndexProc *indexProc;
     const char *string;
     Tcl_Obj *listObjPtr;
@@ -1321,7 +1336,7 @@ ValueSetOp(ClientData clientData, Tcl_Interp *interp, int objc,
            Tcl_Obj *const *objv)
 {
     Vector *vPtr = clientData;
-    int first, last;
+    long first, last;
     const char *string;
     double value;
 
@@ -1372,7 +1387,7 @@ ValueUnsetOp(ClientData clientData, Tcl_Interp *interp, int objc,
     int i;
 
     for (i = 3; i < objc; i++) {
-        int first, last;
+        long first, last;
         const char *string;
 
         string = Tcl_GetString(objv[i]);
@@ -1459,7 +1474,7 @@ ValuesOp(ClientData clientData, Tcl_Interp *interp, int objc,
     }
     listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
     if (switches.formatObjPtr == NULL) {
-        int i;
+        long i;
 
         listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
         if (switches.empty) {
@@ -1478,7 +1493,7 @@ ValuesOp(ClientData clientData, Tcl_Interp *interp, int objc,
     } else {
         char buffer[200];
         const char *fmt;
-        int i;
+        long i;
 
         fmt = Tcl_GetString(switches.formatObjPtr);
         if (switches.empty) {
@@ -1728,12 +1743,13 @@ FormatLong(Tcl_Interp *interp, double d, FormatParser *parserPtr)
 
 static int
 AppendFormatToObj(Tcl_Interp *interp, Tcl_Obj *appendObjPtr, const char *format,
-                  int *offsetPtr, Vector *vPtr, int maxOffset)
+                  long *offsetPtr, Vector *vPtr, long maxOffset)
 {
     FormatParser parser;
     const char *span = format, *msg;
     int numBytes = 0, index, count;
-    int originalLength, limit, offset;
+    int originalLength, limit;
+    long offset;
     static const char *mixedXPG =
             "cannot mix \"%\" and \"%n$\" conversion specifiers";
     static const char *badIndex[2] = {
@@ -2135,7 +2151,7 @@ PrintOp(ClientData clientData, Tcl_Interp *interp, int objc,
     char **argv;
     int argc;
     char *fmt;
-    int i;
+    long i;
 
     switches.from = 0;
     switches.to = vPtr->length - 1;
@@ -2191,7 +2207,7 @@ RangeOp(ClientData clientData, Tcl_Interp *interp, int objc,
 {
     Vector *vPtr = clientData;
     Tcl_Obj *listObjPtr;
-    int first, last, i;
+    long first, last, i;
 
     if (objc == 2) {
         first = 0;
@@ -2348,12 +2364,12 @@ GetBinaryFormat(Tcl_Interp *interp, const char *string, int *sizePtr)
 
 static int
 CopyValues(Vector *vPtr, char *byteArr, enum NativeFormats fmt, int size, 
-           int length, int swap, int *indexPtr)
+           long length, int swap, long *indexPtr)
 {
-    int newSize, i, n;
+    long newSize, i, n;
 
     if ((swap) && (size > 1)) {
-        int numBytes = size * length;
+        long numBytes = size * length;
 
         for (i = 0; i < numBytes; i += size) {
             int left, right;
@@ -2470,7 +2486,8 @@ BinreadOp(ClientData clientData, Tcl_Interp *interp, int objc,
     enum NativeFormats fmt;
     int fmtSize;
     int mode, swap;
-    int count, total, first, i;
+    long count, total, first;
+    int i;
     size_t arraySize;
 
     string = Tcl_GetString(objv[2]);
@@ -2490,13 +2507,23 @@ BinreadOp(ClientData clientData, Tcl_Interp *interp, int objc,
     count = 0;
 
     if (objc > 3) {
-        string = Tcl_GetString(objv[3]);
-        if (string[0] != '-') {
-            /* Get the number of values to read.  */
-            if (Tcl_GetIntFromObj(interp, objv[3], &count) != TCL_OK) {
+        /* 
+         * Get the number of values to read.  Try the argument as a number
+         * first so that a negative count isn't mistaken for a switch.
+         */
+        if (Blt_GetLongFromObj(NULL, objv[3], &count) == TCL_OK) {
+            if (count < 0) {
+                Tcl_AppendResult(interp, "invalid count \"",
+                    Tcl_GetString(objv[3]), "\": can't be negative",
+                    (char *)NULL);
                 return TCL_ERROR;
             }
             objc--, objv++;
+        } else {
+            string = Tcl_GetString(objv[3]);
+            if (string[0] != '-') {
+                return Blt_GetLongFromObj(interp, objv[3], &count);
+            }
         }
     }
     /* Process any option-value pairs that remain.  */
@@ -2550,7 +2577,7 @@ BinreadOp(ClientData clientData, Tcl_Interp *interp, int objc,
     }
     total = 0;
     while (!Tcl_Eof(channel)) {
-        int length;
+        long length;
         ssize_t bytesRead;
 
         bytesRead = Tcl_Read(channel, byteArr, arraySize);
@@ -2611,7 +2638,7 @@ ExportOp(ClientData clientData, Tcl_Interp *interp, int objc,
 {
     Vector *vPtr = clientData;
     ExportSwitches switches;
-    int numValues;
+    long numValues;
     char *fmt;
     int format;
     Blt_DBuffer dbuffer;
@@ -2673,14 +2700,14 @@ ExportOp(ClientData clientData, Tcl_Interp *interp, int objc,
         farray = (float *)Blt_DBuffer_Bytes(dbuffer);
         count = 0;
         if (switches.empty) {
-            int i;
+            long i;
 
             for (i = switches.from; i <= switches.to; i++) {
                 farray[count] = (float)vPtr->valueArr[i];
                 count++;
             }
         } else {
-            int i;
+            long i;
 
             for (i = switches.from; i <= switches.to; i++) {
                 if (FINITE(vPtr->valueArr[i])) {
@@ -2738,7 +2765,7 @@ CountOp(ClientData clientData, Tcl_Interp *interp, int objc,
         Tcl_Obj *const *objv)
 {
     Vector *vPtr = clientData;
-    int count;
+    long count;
     const char *string;
     char c;
 
@@ -2746,7 +2773,7 @@ CountOp(ClientData clientData, Tcl_Interp *interp, int objc,
     c = string[0];
     count = 0;
     if ((c == 'e') && (strcmp(string, "empty") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (!FINITE(vPtr->valueArr[i])) {
@@ -2754,7 +2781,7 @@ CountOp(ClientData clientData, Tcl_Interp *interp, int objc,
             }
         }
     } else if ((c == 'z') && (strcmp(string, "zero") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (FINITE(vPtr->valueArr[i]) && (vPtr->valueArr[i] == 0.0)) {
@@ -2762,7 +2789,7 @@ CountOp(ClientData clientData, Tcl_Interp *interp, int objc,
             }
         }
     } else if ((c == 'n') && (strcmp(string, "nonzero") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (FINITE(vPtr->valueArr[i]) && (vPtr->valueArr[i] != 0.0)) {
@@ -2770,7 +2797,7 @@ CountOp(ClientData clientData, Tcl_Interp *interp, int objc,
             }
         }
     } else if ((c == 'n') && (strcmp(string, "nonempty") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (FINITE(vPtr->valueArr[i])) {
@@ -2783,7 +2810,7 @@ CountOp(ClientData clientData, Tcl_Interp *interp, int objc,
                 (char *)NULL);
         return TCL_ERROR;
     }
-    Tcl_SetIntObj(Tcl_GetObjResult(interp), count);
+    Tcl_SetLongObj(Tcl_GetObjResult(interp), count);
     return TCL_OK;
 }
 
@@ -2814,35 +2841,35 @@ IndicesOp(ClientData clientData, Tcl_Interp *interp, int objc,
     string = Tcl_GetString(objv[2]);
     c = string[0];
     if ((c == 'e') && (strcmp(string, "empty") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (!FINITE(vPtr->valueArr[i])) {
-                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewIntObj(i));
+                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewLongObj(i));
             }
         }
     } else if ((c == 'z') && (strcmp(string, "zero") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (FINITE(vPtr->valueArr[i]) && (vPtr->valueArr[i] == 0.0)) {
-                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewIntObj(i));
+                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewLongObj(i));
             }
         }
     } else if ((c == 'n') && (strcmp(string, "nonzero") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (FINITE(vPtr->valueArr[i]) && (vPtr->valueArr[i] != 0.0)) {
-                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewIntObj(i));
+                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewLongObj(i));
             }
         }
     } else if ((c == 'n') && (strcmp(string, "nonempty") == 0)) {
-        int i;
+        long i;
 
         for (i = 0; i < vPtr->length; i++) {
             if (FINITE(vPtr->valueArr[i])) {
-                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewIntObj(i));
+                Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewLongObj(i));
             }
         }
     } else {
@@ -2877,7 +2904,7 @@ SearchOp(ClientData clientData, Tcl_Interp *interp, int objc,
 {
     Vector *vPtr = clientData;
     double min, max;
-    int i;
+    long i;
     int wantValue;
     char *string;
     Tcl_Obj *listObjPtr;
@@ -2917,7 +2944,7 @@ SearchOp(ClientData clientData, Tcl_Interp *interp, int objc,
         for (i = 0; i < vPtr->length; i++) {
             if (InRange(vPtr->valueArr[i], min, max)) {
                 Tcl_ListObjAppendElement(interp, listObjPtr,
-                         Tcl_NewIntObj(i + vPtr->offset));
+                         Tcl_NewLongObj(i + vPtr->offset));
             }
         }
     }
@@ -2979,7 +3006,7 @@ RandomOp(ClientData clientData, Tcl_Interp *interp, int objc,
          Tcl_Obj *const *objv)
 {
     Vector *vPtr = clientData;
-    int i;
+    long i;
 
     if (objc == 3) {
         int64_t seed;
@@ -3021,7 +3048,7 @@ SequenceOp(ClientData clientData, Tcl_Interp *interp, int objc,
     Vector *vPtr = clientData;
     const char *string;
     double start, stop, step;
-    int numSteps;
+    long numSteps;
 
     if (Tcl_GetDoubleFromObj(interp, objv[2], &start) != TCL_OK) {
         return TCL_ERROR;
@@ -3045,10 +3072,10 @@ SequenceOp(ClientData clientData, Tcl_Interp *interp, int objc,
 
 	r = stop - start;
 	s = r / step;
-        numSteps = (int)(s) + 1;
+        numSteps = (long)(s) + 1;
     }
     if (numSteps > 0) {
-        int i;
+        long i;
         
         if (Blt_Vec_SetLength(interp, vPtr, numSteps) != TCL_OK) {
             return TCL_ERROR;
@@ -3219,8 +3246,8 @@ SimplifyOp(ClientData clientData, Tcl_Interp *interp, int objc,
 {
     Vector *vPtr = clientData;
     Vector *x, *y;
-    int i, n, vecSize;
-    int numPoints;
+    long i, n, vecSize;
+    long numPoints;
     long *indices;
     Point2d *origPts;
     double *xArr, *yArr;
@@ -3249,7 +3276,7 @@ SimplifyOp(ClientData clientData, Tcl_Interp *interp, int objc,
     }
     origPts = Blt_Malloc(sizeof(Point2d) * numPoints);
     if (origPts == NULL) {
-        Tcl_AppendResult(interp, "can't allocate \"", Blt_Itoa(numPoints), 
+        Tcl_AppendResult(interp, "can't allocate \"", Blt_Ltoa(numPoints), 
                 "\" points", (char *)NULL);
         return TCL_ERROR;
     }
@@ -3278,13 +3305,13 @@ SimplifyOp(ClientData clientData, Tcl_Interp *interp, int objc,
     }
     xArr = Blt_VecData(vPtr);
     if (switches.flags & SIMPLIFY_INDICES) {
-        int i;
+        long i;
         
         for (i = 0; i < n; i++) {
             xArr[i] = (double)indices[i];
         }
     } else {
-        int j;
+        long j;
         
         for (i = 0, j = 0; i < n; i++, j += 2) {
             xArr[j] = origPts[indices[i]].x;
@@ -3333,13 +3360,13 @@ SplitOp(ClientData clientData, Tcl_Interp *interp, int objc,
     }
     if (numVectors > 0) {
         int i;
-        int extra;
+        long extra;
 
         extra = vPtr->length / numVectors;
         for (i = 0; i < numVectors; i++) {
             Vector *destPtr;
-            int oldSize, newSize;
-            int j, k;
+            long oldSize, newSize;
+            long j, k;
 
             if (GetVector(interp, vPtr->dataPtr, objv[i + 2], &destPtr)
                 != TCL_OK) {
@@ -3362,6 +3389,61 @@ SplitOp(ClientData clientData, Tcl_Interp *interp, int objc,
     return TCL_OK;
 }
 
+static void
+AppendStat(Tcl_Interp *interp, Tcl_Obj *listObjPtr, const char *name, 
+           double value)
+{
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj(name, -1));
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewDoubleObj(value));
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * StatsOp --
+ *
+ *      Returns the summary statistics of the vector as a list of
+ *      name-value pairs.  The values are the same as those returned by
+ *      the vector math functions of the same names, but the vector is
+ *      only scanned twice and the quartiles are selected once.
+ *
+ * Results:
+ *      A standard TCL result.  
+ *
+ *      vecName stats
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+StatsOp(ClientData clientData, Tcl_Interp *interp, int objc,
+        Tcl_Obj *const *objv)
+{
+    Vector *vPtr = clientData;
+    VectorStats stats;
+    Tcl_Obj *listObjPtr;
+
+    Blt_Vec_GetStats(vPtr, STATS_MOMENTS | STATS_QUARTILES, &stats);
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+        Tcl_NewStringObj("count", 5));
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewLongObj(stats.count));
+    AppendStat(interp, listObjPtr, "sum", stats.sum);
+    AppendStat(interp, listObjPtr, "mean", stats.mean);
+    AppendStat(interp, listObjPtr, "min", stats.min);
+    AppendStat(interp, listObjPtr, "max", stats.max);
+    AppendStat(interp, listObjPtr, "var", stats.var);
+    AppendStat(interp, listObjPtr, "sdev", stats.sdev);
+    AppendStat(interp, listObjPtr, "adev", stats.adev);
+    AppendStat(interp, listObjPtr, "skew", stats.skew);
+    AppendStat(interp, listObjPtr, "kurtosis", stats.kurtosis);
+    AppendStat(interp, listObjPtr, "q1", stats.q1);
+    AppendStat(interp, listObjPtr, "median", stats.median);
+    AppendStat(interp, listObjPtr, "q3", stats.q3);
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
+}
+
 
 static Vector **sortVectors;            /* Pointer to the array of values
                                          * currently being sorted. */
@@ -3397,8 +3479,8 @@ static int
 ComparePoints(const void *aPtr, const void *bPtr)
 {
     int i;
-    const int i1 = *(int *)aPtr;
-    const int i2 = *(int *)bPtr;
+    const long i1 = *(long *)aPtr;
+    const long i2 = *(long *)bPtr;
 
     for (i = 0; i < numSortVectors; i++) {
         int cond;
@@ -3470,7 +3552,7 @@ Blt_Vec_SortMap(Vector **vectors, int numVectors, long **mapPtr)
  *---------------------------------------------------------------------------
  */
 
-int
+long
 Blt_Vec_NonemptySortMap(Vector *vPtr, long **mapPtr)
 {
     long *map;
@@ -3570,11 +3652,11 @@ SortOp(ClientData clientData, Tcl_Interp *interp, int objc,
     }
     /* If all we care about is the unique values then compress the map. */
     if (switches.flags & SORT_UNIQUE) {
-        int count, i;
+        long count, i;
 
         count = 1;
         for (i = 1; i < vPtr->length; i++) {
-            int next, prev;
+            long next, prev;
 
             next = map[i];
             prev = map[i - 1];
@@ -3632,7 +3714,7 @@ SortOp(ClientData clientData, Tcl_Interp *interp, int objc,
     /* Now rearrange the designated vectors according to the sort map.  The
      * vectors must be the same size as the map.  */
     for (i = 0; i < numVectors; i++) {
-        int j;
+        long j;
         Vector *destPtr;
         
         destPtr = vectors[i];
@@ -3674,15 +3756,7 @@ InstExprOp(ClientData clientData, Tcl_Interp *interp, int objc,
 {
     Vector *vPtr = clientData;
 
-    if (Blt_ExprVector(interp, Tcl_GetString(objv[2]), (Blt_Vector *)vPtr) 
-        != TCL_OK) {
-        return TCL_ERROR;
-    }
-    if (vPtr->flush) {
-        Blt_Vec_FlushCache(vPtr);
-    }
-    Blt_Vec_UpdateClients(vPtr);
-    return TCL_OK;
+    return Blt_Vec_ExprObj(interp, objv[2], vPtr);
 }
 
 /*
@@ -3708,7 +3782,7 @@ ArithOp(ClientData clientData, Tcl_Interp *interp, int objc,
 {
     Vector *vPtr = clientData;
     double value;
-    int i;
+    long i;
     Vector *srcPtr;
     double scalar;
     Tcl_Obj *listObjPtr;
@@ -3717,7 +3791,7 @@ ArithOp(ClientData clientData, Tcl_Interp *interp, int objc,
     srcPtr = Blt_Vec_ParseElement((Tcl_Interp *)NULL, vPtr->dataPtr, 
         Tcl_GetString(objv[2]), NULL, NS_SEARCH_BOTH);
     if (srcPtr != NULL) {
-        int j;
+        long j;
 
         if (srcPtr->length != vPtr->length) {
             Tcl_AppendResult(interp, "vectors \"", Tcl_GetString(objv[0]), 
@@ -3834,7 +3908,8 @@ static Blt_OpSpec vectorInstOps[] =
     {"fft",       2, FFTOp,       3, 0, "vecName ?switches?",},
     {"frequency", 2, FrequencyOp, 4, 4, "vecName numBins",},
     {"indices",   3, IndicesOp,   3, 3, "what",},
-    {"inversefft",3, InverseFFTOp,4, 4, "vecName vecName",},
+    {"inversefft",3, InverseFFTOp,5, 0, 
+        "srcImag destReal destImag ?switches?",},
     {"length",    2, LengthOp,    2, 3, "?newSize?",},
     {"limits",    3, LimitsOp,    2, 2, "",},
     {"linspace",  3, LinspaceOp, 4, 5, "first last ?numSteps?",},
@@ -3855,6 +3930,7 @@ static Blt_OpSpec vectorInstOps[] =
     {"simplify",  2, SimplifyOp,  4, 5, "x y ?tol?" },
     {"sort",      2, SortOp,      2, 0, "?switches? ?vecName...?",},
     {"split",     2, SplitOp,     2, 0, "?vecName...?",},
+    {"stats",     2, StatsOp,     2, 2, "",},
     {"value",     5, ValueOp,     2, 0, "oper",},
     {"values",    6, ValuesOp,    2, 0, "?switches?",},
     {"variable",  3, MapOp,       2, 3, "?varName?",},
@@ -3898,7 +3974,7 @@ Blt_Vec_VarTrace(ClientData clientData, Tcl_Interp *interp, const char *part1,
 {
     Blt_VectorIndexProc *indexProc;
     Vector *vPtr = clientData;
-    int first, last;
+    long first, last;
     int varFlags;
 #define MAX_ERR_MSG     1023
     static char message[MAX_ERR_MSG + 1];
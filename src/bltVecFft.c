@@ -37,7 +37,24 @@
  *
  */
 
-/* spinellia@acm.org START */
+/*
+ * Transforms are computed from plans.  A plan holds everything that
+ * depends only on the length of the transform: its factorization, the
+ * twiddle factors of each pass, and scratch space.  Plans are cached per
+ * interpreter by length, so repeated transforms of the same length (the
+ * usual case for successive frames of a signal) pay for the setup once.
+ *
+ * Lengths that factor into 2, 3, 5, 7, 11, and 13 are transformed by a
+ * mixed-radix Stockham algorithm.  Each pass reads and writes separate
+ * arrays of real and imaginary parts, so there is no bit-reversal and the
+ * inner loops run over contiguous memory.  Other lengths are handled by
+ * Bluestein's algorithm, which recasts the transform as a convolution
+ * computed with a power of two transform.  Real input is packed into a
+ * complex transform of half the length.
+ *
+ * The radix-2 and radix-4 passes have AVX2 versions.  Like the statistics
+ * routines, the version is picked at runtime from the cpu feature flags.
+ */
 
 #include "bltVecInt.h"
 
@@ -49,21 +66,6 @@
   #include <string.h>
 #endif /* HAVE_STRING_H */
 
-#ifdef HAVE_CTYPE_H
-  #include <ctype.h>
-#endif /* HAVE_CTYPE_H */
-
-#ifdef TIME_WITH_SYS_TIME
-  #include <sys/time.h>
-  #include <time.h>
-#else
-  #ifdef HAVE_SYS_TIME_H
-    #include <sys/time.h>
-  #else
-    #include <time.h>
-  #endif /* HAVE_SYS_TIME_H */
-#endif /* TIME_WITH_SYS_TIME */
-
 #include "bltAlloc.h"
 #include <bltMath.h>
 #include "bltNsUtil.h"
@@ -71,68 +73,891 @@
 #include "bltOp.h"
 #include "bltInitCmd.h"
 
-#define SWAP(a,b) tempr=(a);(a)=(b);(b)=tempr
+#if defined(HAVE_X86_ASM) && defined(__x86_64__)
+#  define HAVE_VEC_SIMD 1
+#  include <immintrin.h>
+#endif  /* HAVE_X86_ASM && __x86_64__ */
+
+#define FFT_MAX_PASSES          64      /* Enough for any factorization of
+                                         * a long. */
+#define FFT_MAX_RADIX           13      /* Largest radix with its own
+                                         * pass. Lengths with larger prime
+                                         * factors use Bluestein's
+                                         * algorithm. */
+#define FFT_PLAN_CACHE_SIZE     16      /* # of cached plans kept once
+                                         * they are no longer used. */
+
+#define FFT_PLAN_BLUESTEIN      (1<<1)  /* Plan computes the transform by
+                                         * Bluestein's algorithm. */
 
-/* routine by Brenner
- * data is the array of complex data points, perversely
- * starting at 1
- * nn is the number of complex points, i.e. half the length of data
- * isign is 1 for forward, -1 for inverse
+typedef void (FftPassProc)(long m, long s, const double *xr, const double *xi,
+        double *yr, double *yi, const double *wr, const double *wi);
+
+typedef struct {
+    FftPassProc *radix2Proc;
+    FftPassProc *radix4Proc;
+} FftPassProcs;
+
+typedef struct {
+    int radix;                          /* Radix of the pass. */
+    long m;                             /* # of butterflies per
+                                         * sub-transform. */
+    long s;                             /* Stride between the inputs of a
+                                         * butterfly. */
+    double *twRe, *twIm;                /* Twiddle factors, (radix - 1) *
+                                         * m of each. */
+} FftPass;
+
+struct _FftPlan {
+    long length;                        /* Length of the transform. */
+    unsigned int flags;                 /* FFT_PLAN_REAL or
+                                         * FFT_PLAN_BLUESTEIN. */
+    int refCount;                       /* # of users of the plan. */
+    Blt_HashEntry *hashPtr;             /* Entry in the plan cache. NULL
+                                         * if the plan is private to
+                                         * another plan. */
+    int numPasses;
+    FftPass passes[FFT_MAX_PASSES];
+    FftPlan *subPlanPtr;                /* Complex plan used by real and
+                                         * Bluestein plans. */
+    double *tables;                     /* Twiddle factors, chirp and
+                                         * filter (malloc-ed). */
+    double *chirpRe, *chirpIm;          /* Bluestein chirp. */
+    double *filterRe, *filterIm;        /* Transform of the Bluestein
+                                         * filter, scaled by 1/m. */
+    double *rotRe, *rotIm;              /* Twiddle factors that untangle
+                                         * the half length transform of a
+                                         * real plan. */
+    double *work;                       /* Scratch space (malloc-ed). */
+};
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Radix2Std, Radix4Std, Radix3Std, RadixOdd --
+ *
+ *      A single Stockham pass.  Each of the m butterflies combines radix
+ *      inputs spaced m * s apart, multiplies the outputs by the twiddle
+ *      factors, and writes them s apart.  The inner loop runs over the s
+ *      interleaved sub-transforms.
+ *
+ *---------------------------------------------------------------------------
  */
-static void 
-four1(double *data, unsigned long nn, int isign)
+static void
+Radix2Std(long m, long s, const double *xr, const double *xi, double *yr, 
+          double *yi, const double *wr, const double *wi)
 {
-    unsigned long n, mmax, m, j, i;
-    double tempr, tempi;
-    
-    n=nn << 1;
-    j=1;
-    for (i = 1; i < n; i += 2) {
-        int m;
-        
-        if (j > i) {
-            SWAP(data[j],data[i]);
-            SWAP(data[j+1],data[i+1]);
-        }
-        m = n >> 1;
-        while ((m >= 2) && (j > m)) {
-            j -= m;
-            m >>= 1;
-        }
-        j += m;
-    }
-    mmax = 2;
-    while (n > mmax) {
-        double wr, wi, wpr, wpi;
-        int istep;
-        double theta, wtemp;
-        
-        istep=mmax << 1;
-        theta = isign * (6.28318530717959 / mmax);
-        wtemp = sin(0.5*theta);
-        wpr = -2.0 * wtemp*wtemp;
-        wpi = sin(theta);
-        wr = 1.0;
-        wi = 0.0;
-        for (m = 1; m < mmax; m += 2) {
-            for (i=m;i<=n;i+=istep) {
-                int j;
-                
-                j=i+mmax;
-                tempr=wr*data[j]-wi*data[j+1];
-                tempi=wr*data[j+1]+wi*data[j];
-                data[j]=data[i]-tempr;
-                data[j+1]=data[i+1]-tempi;
-                data[i] += tempr;
-                data[i+1] += tempi;
+    long p;
+
+    for (p = 0; p < m; p++) {
+        long i0, i1, o0, o1, q;
+        double w1r, w1i;
+
+        i0 = s * p, i1 = s * (p + m);
+        o0 = s * 2 * p, o1 = o0 + s;
+        w1r = wr[p], w1i = wi[p];
+        for (q = 0; q < s; q++) {
+            double ar, ai, br, bi, dr, di;
+
+            ar = xr[i0 + q], ai = xi[i0 + q];
+            br = xr[i1 + q], bi = xi[i1 + q];
+            yr[o0 + q] = ar + br;
+            yi[o0 + q] = ai + bi;
+            dr = ar - br, di = ai - bi;
+            yr[o1 + q] = dr * w1r - di * w1i;
+            yi[o1 + q] = dr * w1i + di * w1r;
+        }
+    }
+}
+
+static void
+Radix4Std(long m, long s, const double *xr, const double *xi, double *yr, 
+          double *yi, const double *wr, const double *wi)
+{
+    long p;
+
+    for (p = 0; p < m; p++) {
+        long i0, i1, i2, i3, o0, o1, o2, o3, q;
+        double w1r, w1i, w2r, w2i, w3r, w3i;
+
+        i0 = s * p, i1 = s * (p + m), i2 = s * (p + 2 * m); 
+        i3 = s * (p + 3 * m);
+        o0 = s * 4 * p, o1 = o0 + s, o2 = o1 + s, o3 = o2 + s;
+        w1r = wr[p], w1i = wi[p];
+        w2r = wr[m + p], w2i = wi[m + p];
+        w3r = wr[2 * m + p], w3i = wi[2 * m + p];
+        for (q = 0; q < s; q++) {
+            double t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i;
+            double br, bi;
+
+            t0r = xr[i0 + q] + xr[i2 + q], t0i = xi[i0 + q] + xi[i2 + q];
+            t1r = xr[i0 + q] - xr[i2 + q], t1i = xi[i0 + q] - xi[i2 + q];
+            t2r = xr[i1 + q] + xr[i3 + q], t2i = xi[i1 + q] + xi[i3 + q];
+            /* -i * (x1 - x3) */
+            t3r = xi[i1 + q] - xi[i3 + q], t3i = xr[i3 + q] - xr[i1 + q];
+            yr[o0 + q] = t0r + t2r;
+            yi[o0 + q] = t0i + t2i;
+            br = t1r + t3r, bi = t1i + t3i;
+            yr[o1 + q] = br * w1r - bi * w1i;
+            yi[o1 + q] = br * w1i + bi * w1r;
+            br = t0r - t2r, bi = t0i - t2i;
+            yr[o2 + q] = br * w2r - bi * w2i;
+            yi[o2 + q] = br * w2i + bi * w2r;
+            br = t1r - t3r, bi = t1i - t3i;
+            yr[o3 + q] = br * w3r - bi * w3i;
+            yi[o3 + q] = br * w3i + bi * w3r;
+        }
+    }
+}
+
+static void
+Radix3Std(long m, long s, const double *xr, const double *xi, double *yr, 
+          double *yi, const double *wr, const double *wi)
+{
+    const double sin60 = 0.86602540378443864676;
+    long p;
+
+    for (p = 0; p < m; p++) {
+        long i0, i1, i2, o0, o1, o2, q;
+        double w1r, w1i, w2r, w2i;
+
+        i0 = s * p, i1 = s * (p + m), i2 = s * (p + 2 * m);
+        o0 = s * 3 * p, o1 = o0 + s, o2 = o1 + s;
+        w1r = wr[p], w1i = wi[p];
+        w2r = wr[m + p], w2i = wi[m + p];
+        for (q = 0; q < s; q++) {
+            double t1r, t1i, t2r, t2i, t3r, t3i, br, bi;
+
+            t1r = xr[i1 + q] + xr[i2 + q], t1i = xi[i1 + q] + xi[i2 + q];
+            t2r = xr[i0 + q] - 0.5 * t1r, t2i = xi[i0 + q] - 0.5 * t1i;
+            /* -i * sin(60) * (x1 - x2) */
+            t3r = sin60 * (xi[i1 + q] - xi[i2 + q]);
+            t3i = sin60 * (xr[i2 + q] - xr[i1 + q]);
+            yr[o0 + q] = xr[i0 + q] + t1r;
+            yi[o0 + q] = xi[i0 + q] + t1i;
+            br = t2r + t3r, bi = t2i + t3i;
+            yr[o1 + q] = br * w1r - bi * w1i;
+            yi[o1 + q] = br * w1i + bi * w1r;
+            br = t2r - t3r, bi = t2i - t3i;
+            yr[o2 + q] = br * w2r - bi * w2i;
+            yi[o2 + q] = br * w2i + bi * w2r;
+        }
+    }
+}
+
+static void
+RadixOdd(int radix, long m, long s, const double *xr, const double *xi, 
+         double *yr, double *yi, const double *wr, const double *wi)
+{
+    double cr[FFT_MAX_RADIX], ci[FFT_MAX_RADIX];
+    double ar[FFT_MAX_RADIX], ai[FFT_MAX_RADIX];
+    long p;
+    int j;
+
+    for (j = 0; j < radix; j++) {
+        cr[j] = cos(2.0 * M_PI * j / radix);
+        ci[j] = -sin(2.0 * M_PI * j / radix);
+    }
+    for (p = 0; p < m; p++) {
+        long q;
+
+        for (q = 0; q < s; q++) {
+            long o0;
+            int k;
+
+            for (k = 0; k < radix; k++) {
+                ar[k] = xr[s * (p + k * m) + q];
+                ai[k] = xi[s * (p + k * m) + q];
+            }
+            o0 = s * radix * p + q;
+            for (j = 0; j < radix; j++) {
+                double br, bi;
+                int index;
+
+                br = bi = 0.0;
+                for (k = index = 0; k < radix; k++) {
+                    br += ar[k] * cr[index] - ai[k] * ci[index];
+                    bi += ar[k] * ci[index] + ai[k] * cr[index];
+                    index += j;
+                    if (index >= radix) {
+                        index -= radix;
+                    }
+                }
+                if (j > 0) {
+                    double tr, ti;
+
+                    tr = wr[(j - 1) * m + p], ti = wi[(j - 1) * m + p];
+                    yr[o0 + j * s] = br * tr - bi * ti;
+                    yi[o0 + j * s] = br * ti + bi * tr;
+                } else {
+                    yr[o0] = br;
+                    yi[o0] = bi;
+                }
             }
-            wr=(wtemp=wr)*wpr-wi*wpi+wr;
-            wi=wi*wpr+wtemp*wpi+wi;
         }
-        mmax=istep;
     }
 }
-#undef SWAP
+
+#ifdef HAVE_VEC_SIMD
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Radix2Avx2, Radix4Avx2 --
+ *
+ *      AVX2 versions of the radix-2 and radix-4 passes.  Four of the
+ *      interleaved sub-transforms are done at once.  The radix-4 and
+ *      radix-2 passes come first in a plan, so the stride is always a
+ *      power of two.  Strides of one and two are left to the standard
+ *      versions.
+ *
+ *---------------------------------------------------------------------------
+ */
+__attribute__((target("avx2")))
+static void
+Radix2Avx2(long m, long s, const double *xr, const double *xi, double *yr, 
+           double *yi, const double *wr, const double *wi)
+{
+    long p;
+
+    if (s & 3) {
+        Radix2Std(m, s, xr, xi, yr, yi, wr, wi);
+        return;
+    }
+    for (p = 0; p < m; p++) {
+        long i0, i1, o0, o1, q;
+        __m256d w1r, w1i;
+
+        i0 = s * p, i1 = s * (p + m);
+        o0 = s * 2 * p, o1 = o0 + s;
+        w1r = _mm256_set1_pd(wr[p]), w1i = _mm256_set1_pd(wi[p]);
+        for (q = 0; q < s; q += 4) {
+            __m256d ar, ai, br, bi, dr, di;
+
+            ar = _mm256_loadu_pd(xr + i0 + q);
+            ai = _mm256_loadu_pd(xi + i0 + q);
+            br = _mm256_loadu_pd(xr + i1 + q);
+            bi = _mm256_loadu_pd(xi + i1 + q);
+            _mm256_storeu_pd(yr + o0 + q, _mm256_add_pd(ar, br));
+            _mm256_storeu_pd(yi + o0 + q, _mm256_add_pd(ai, bi));
+            dr = _mm256_sub_pd(ar, br), di = _mm256_sub_pd(ai, bi);
+            _mm256_storeu_pd(yr + o1 + q, _mm256_sub_pd(
+                _mm256_mul_pd(dr, w1r), _mm256_mul_pd(di, w1i)));
+            _mm256_storeu_pd(yi + o1 + q, _mm256_add_pd(
+                _mm256_mul_pd(dr, w1i), _mm256_mul_pd(di, w1r)));
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static INLINE void
+CMulStoreAvx2(double *yr, double *yi, __m256d br, __m256d bi, __m256d wr, 
+              __m256d wi)
+{
+    _mm256_storeu_pd(yr, _mm256_sub_pd(_mm256_mul_pd(br, wr), 
+                                       _mm256_mul_pd(bi, wi)));
+    _mm256_storeu_pd(yi, _mm256_add_pd(_mm256_mul_pd(br, wi), 
+                                       _mm256_mul_pd(bi, wr)));
+}
+
+__attribute__((target("avx2")))
+static void
+Radix4Avx2(long m, long s, const double *xr, const double *xi, double *yr, 
+           double *yi, const double *wr, const double *wi)
+{
+    long p;
+
+    if (s & 3) {
+        Radix4Std(m, s, xr, xi, yr, yi, wr, wi);
+        return;
+    }
+    for (p = 0; p < m; p++) {
+        long i0, i1, i2, i3, o0, o1, o2, o3, q;
+        __m256d w1r, w1i, w2r, w2i, w3r, w3i;
+
+        i0 = s * p, i1 = s * (p + m), i2 = s * (p + 2 * m); 
+        i3 = s * (p + 3 * m);
+        o0 = s * 4 * p, o1 = o0 + s, o2 = o1 + s, o3 = o2 + s;
+        w1r = _mm256_set1_pd(wr[p]), w1i = _mm256_set1_pd(wi[p]);
+        w2r = _mm256_set1_pd(wr[m + p]), w2i = _mm256_set1_pd(wi[m + p]);
+        w3r = _mm256_set1_pd(wr[2 * m + p]);
+        w3i = _mm256_set1_pd(wi[2 * m + p]);
+        for (q = 0; q < s; q += 4) {
+            __m256d x0r, x0i, x1r, x1i, x2r, x2i, x3r, x3i;
+            __m256d t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i;
+
+            x0r = _mm256_loadu_pd(xr + i0 + q);
+            x0i = _mm256_loadu_pd(xi + i0 + q);
+            x1r = _mm256_loadu_pd(xr + i1 + q);
+            x1i = _mm256_loadu_pd(xi + i1 + q);
+            x2r = _mm256_loadu_pd(xr + i2 + q);
+            x2i = _mm256_loadu_pd(xi + i2 + q);
+            x3r = _mm256_loadu_pd(xr + i3 + q);
+            x3i = _mm256_loadu_pd(xi + i3 + q);
+            t0r = _mm256_add_pd(x0r, x2r), t0i = _mm256_add_pd(x0i, x2i);
+            t1r = _mm256_sub_pd(x0r, x2r), t1i = _mm256_sub_pd(x0i, x2i);
+            t2r = _mm256_add_pd(x1r, x3r), t2i = _mm256_add_pd(x1i, x3i);
+            t3r = _mm256_sub_pd(x1i, x3i), t3i = _mm256_sub_pd(x3r, x1r);
+            _mm256_storeu_pd(yr + o0 + q, _mm256_add_pd(t0r, t2r));
+            _mm256_storeu_pd(yi + o0 + q, _mm256_add_pd(t0i, t2i));
+            CMulStoreAvx2(yr + o1 + q, yi + o1 + q, _mm256_add_pd(t1r, t3r),
+                _mm256_add_pd(t1i, t3i), w1r, w1i);
+            CMulStoreAvx2(yr + o2 + q, yi + o2 + q, _mm256_sub_pd(t0r, t2r),
+                _mm256_sub_pd(t0i, t2i), w2r, w2i);
+            CMulStoreAvx2(yr + o3 + q, yi + o3 + q, _mm256_sub_pd(t1r, t3r),
+                _mm256_sub_pd(t1i, t3i), w3r, w3i);
+        }
+    }
+}
+
+#endif  /* HAVE_VEC_SIMD */
+
+static FftPassProcs stdPassProcs = {
+    Radix2Std, Radix4Std
+};
+
+#ifdef HAVE_VEC_SIMD
+static FftPassProcs avx2PassProcs = {
+    Radix2Avx2, Radix4Avx2
+};
+#endif  /* HAVE_VEC_SIMD */
+
+static FftPassProcs *passProcsPtr = &stdPassProcs;
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_InitFftProcs --
+ *
+ *      Selects the versions of the FFT passes for this cpu.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_InitFftProcs(void)
+{
+#ifdef HAVE_VEC_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        passProcsPtr = &avx2PassProcs;
+    }
+#endif  /* HAVE_VEC_SIMD */
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RunPasses --
+ *
+ *      Computes the complex transform of a mixed-radix plan.  The passes
+ *      alternate between the output and the scratch arrays, starting with
+ *      the one that leaves the last pass writing the output.  The input
+ *      is never written, but it can not be the output.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+RunPasses(FftPlan *planPtr, const double *inRe, const double *inIm,
+          double *outRe, double *outIm)
+{
+    const double *xr, *xi;
+    int i;
+
+    if (planPtr->numPasses == 0) {
+        memcpy(outRe, inRe, planPtr->length * sizeof(double));
+        memcpy(outIm, inIm, planPtr->length * sizeof(double));
+        return;
+    }
+    xr = inRe, xi = inIm;
+    for (i = 0; i < planPtr->numPasses; i++) {
+        FftPass *passPtr;
+        double *yr, *yi;
+
+        passPtr = planPtr->passes + i;
+        if ((planPtr->numPasses - 1 - i) & 1) {
+            yr = planPtr->work, yi = planPtr->work + planPtr->length;
+        } else {
+            yr = outRe, yi = outIm;
+        }
+        switch (passPtr->radix) {
+        case 2:
+            (*passProcsPtr->radix2Proc)(passPtr->m, passPtr->s, xr, xi, 
+                yr, yi, passPtr->twRe, passPtr->twIm);
+            break;
+        case 3:
+            Radix3Std(passPtr->m, passPtr->s, xr, xi, yr, yi, passPtr->twRe, 
+                passPtr->twIm);
+            break;
+        case 4:
+            (*passProcsPtr->radix4Proc)(passPtr->m, passPtr->s, xr, xi, 
+                yr, yi, passPtr->twRe, passPtr->twIm);
+            break;
+        default:
+            RadixOdd(passPtr->radix, passPtr->m, passPtr->s, xr, xi, yr, yi,
+                passPtr->twRe, passPtr->twIm);
+            break;
+        }
+        xr = yr, xi = yi;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ComplexTransform --
+ *
+ *      Computes the forward complex transform of a complex plan.  The
+ *      unscaled inverse is the same transform with the real and imaginary
+ *      parts swapped in both the input and the output.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ComplexTransform(FftPlan *planPtr, const double *inRe, const double *inIm,
+                 double *outRe, double *outIm)
+{
+    FftPlan *subPtr;
+    double *aRe, *aIm, *bRe, *bIm;
+    long i, n, m;
+
+    if ((planPtr->flags & FFT_PLAN_BLUESTEIN) == 0) {
+        RunPasses(planPtr, inRe, inIm, outRe, outIm);
+        return;
+    }
+    /* 
+     * Bluestein's algorithm: X[k] = w[k] * sum(x[j] * w[j] * conj(w[k-j]))
+     * where w[k] = exp(-i * pi * k * k / n).  The convolution is done by
+     * a power of two transform at least 2n - 1 long.
+     */
+    subPtr = planPtr->subPlanPtr;
+    n = planPtr->length;
+    m = subPtr->length;
+    aRe = planPtr->work, aIm = aRe + m, bRe = aIm + m, bIm = bRe + m;
+    for (i = 0; i < n; i++) {
+        aRe[i] = inRe[i] * planPtr->chirpRe[i] - inIm[i] * planPtr->chirpIm[i];
+        aIm[i] = inRe[i] * planPtr->chirpIm[i] + inIm[i] * planPtr->chirpRe[i];
+    }
+    memset(aRe + n, 0, (m - n) * sizeof(double));
+    memset(aIm + n, 0, (m - n) * sizeof(double));
+    RunPasses(subPtr, aRe, aIm, bRe, bIm);
+    for (i = 0; i < m; i++) {
+        double re, im;
+
+        re = bRe[i] * planPtr->filterRe[i] - bIm[i] * planPtr->filterIm[i];
+        im = bRe[i] * planPtr->filterIm[i] + bIm[i] * planPtr->filterRe[i];
+        bRe[i] = re, bIm[i] = im;
+    }
+    RunPasses(subPtr, bIm, bRe, aIm, aRe);
+    for (i = 0; i < n; i++) {
+        outRe[i] = aRe[i] * planPtr->chirpRe[i] - aIm[i] * planPtr->chirpIm[i];
+        outIm[i] = aRe[i] * planPtr->chirpIm[i] + aIm[i] * planPtr->chirpRe[i];
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RealForward --
+ *
+ *      Computes the first n/2 + 1 terms of the transform of n real
+ *      values.  For even lengths, the even and odd values are packed as
+ *      the real and imaginary parts of a complex transform of half the
+ *      length, whose terms are then separated.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+RealForward(FftPlan *planPtr, const double *in, double *outRe, double *outIm)
+{
+    FftPlan *subPtr;
+    double *zr, *zi, *Zr, *Zi;
+    long k, n, h;
+
+    subPtr = planPtr->subPlanPtr;
+    n = planPtr->length;
+    h = n / 2;
+    if (subPtr->length == n) {
+        double *zeros;
+
+        /* Odd length: use the full complex transform. */
+        zeros = planPtr->work, Zr = zeros + n, Zi = Zr + n;
+        memset(zeros, 0, n * sizeof(double));
+        ComplexTransform(subPtr, in, zeros, Zr, Zi);
+        memcpy(outRe, Zr, (h + 1) * sizeof(double));
+        memcpy(outIm, Zi, (h + 1) * sizeof(double));
+        return;
+    }
+    zr = planPtr->work, zi = zr + h, Zr = zi + h, Zi = Zr + h;
+    for (k = 0; k < h; k++) {
+        zr[k] = in[2 * k];
+        zi[k] = in[2 * k + 1];
+    }
+    ComplexTransform(subPtr, zr, zi, Zr, Zi);
+    for (k = 0; k <= h; k++) {
+        long k1, k2;
+        double er, ei, or, oi;
+
+        k1 = (k == h) ? 0 : k;
+        k2 = (k == 0) ? 0 : h - k;
+        /* E = (Z[k] + conj(Z[h-k])) / 2, O = (Z[k] - conj(Z[h-k])) / 2i */
+        er = 0.5 * (Zr[k1] + Zr[k2]), ei = 0.5 * (Zi[k1] - Zi[k2]);
+        or = 0.5 * (Zi[k1] + Zi[k2]), oi = 0.5 * (Zr[k2] - Zr[k1]);
+        outRe[k] = er + or * planPtr->rotRe[k] - oi * planPtr->rotIm[k];
+        outIm[k] = ei + or * planPtr->rotIm[k] + oi * planPtr->rotRe[k];
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * RealInverse --
+ *
+ *      Computes the n real values whose transform has the given first
+ *      n/2 + 1 terms.  This reverses the steps of RealForward.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+RealInverse(FftPlan *planPtr, const double *inRe, const double *inIm, 
+            double *out)
+{
+    FftPlan *subPtr;
+    double *zr, *zi, *Zr, *Zi;
+    double scale;
+    long k, n, h;
+
+    subPtr = planPtr->subPlanPtr;
+    n = planPtr->length;
+    h = n / 2;
+    if (subPtr->length == n) {
+        /* Odd length: rebuild the whole symmetric spectrum. */
+        Zr = planPtr->work, Zi = Zr + n, zr = Zi + n, zi = zr + n;
+        Zr[0] = inRe[0], Zi[0] = 0.0;
+        for (k = 1; k <= h; k++) {
+            Zr[k] = Zr[n - k] = inRe[k];
+            Zi[k] = inIm[k];
+            Zi[n - k] = -inIm[k];
+        }
+        ComplexTransform(subPtr, Zi, Zr, zi, zr);
+        scale = 1.0 / n;
+        for (k = 0; k < n; k++) {
+            out[k] = zr[k] * scale;
+        }
+        return;
+    }
+    Zr = planPtr->work, Zi = Zr + h, zr = Zi + h, zi = zr + h;
+    for (k = 0; k < h; k++) {
+        double er, ei, dr, di;
+
+        /* E = (X[k] + conj(X[h-k])) / 2, O = (X[k] - conj(X[h-k])) / 2W */
+        er = 0.5 * (inRe[k] + inRe[h - k]), ei = 0.5 * (inIm[k] - inIm[h - k]);
+        dr = 0.5 * (inRe[k] - inRe[h - k]), di = 0.5 * (inIm[k] + inIm[h - k]);
+        /* Z = E + iO */
+        Zr[k] = er - (di * planPtr->rotRe[k] - dr * planPtr->rotIm[k]);
+        Zi[k] = ei + (dr * planPtr->rotRe[k] + di * planPtr->rotIm[k]);
+    }
+    ComplexTransform(subPtr, Zi, Zr, zi, zr);
+    scale = 1.0 / h;
+    for (k = 0; k < h; k++) {
+        out[2 * k] = zr[k] * scale;
+        out[2 * k + 1] = zi[k] * scale;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NewFftPlan --
+ *
+ *      Creates a plan for transforms of the given length.  Complex lengths
+ *      are factored into passes of radix 4, 2, 3, 5, 7, 11, and 13 (in that
+ *      order).  If that fails, the plan uses Bluestein's algorithm.  Real
+ *      plans wrap a complex plan of half the length (or the full length
+ *      if the length is odd).
+ *
+ *---------------------------------------------------------------------------
+ */
+static FftPlan *
+NewFftPlan(long length, unsigned int flags)
+{
+    static int radices[] = { 4, 2, 3, 5, 7, 11, 13 };
+    FftPlan *planPtr;
+    long i, n, s, numTwiddles;
+    double *twPtr;
+    int j;
+
+    planPtr = Blt_AssertCalloc(1, sizeof(FftPlan));
+    planPtr->length = length;
+    planPtr->flags = flags;
+    if (flags & FFT_PLAN_REAL) {
+        long h;
+
+        h = length / 2;
+        if ((length & 1) || (length < 2)) {
+            planPtr->subPlanPtr = NewFftPlan(length, 0);
+            planPtr->work = Blt_AssertMalloc(4 * length * sizeof(double));
+            return planPtr;
+        }
+        planPtr->subPlanPtr = NewFftPlan(h, 0);
+        planPtr->work = Blt_AssertMalloc(2 * length * sizeof(double));
+        planPtr->tables = Blt_AssertMalloc(2 * (h + 1) * sizeof(double));
+        planPtr->rotRe = planPtr->tables;
+        planPtr->rotIm = planPtr->rotRe + h + 1;
+        for (i = 0; i <= h; i++) {
+            double theta;
+
+            theta = -2.0 * M_PI * i / length;
+            planPtr->rotRe[i] = cos(theta);
+            planPtr->rotIm[i] = sin(theta);
+        }
+        return planPtr;
+    }
+
+    /* Factor the length into passes. */
+    n = length;
+    numTwiddles = 0;
+    for (j = 0; j < (int)(sizeof(radices) / sizeof(int)); j++) {
+        while ((n % radices[j]) == 0) {
+            FftPass *passPtr;
+
+            passPtr = planPtr->passes + planPtr->numPasses;
+            passPtr->radix = radices[j];
+            planPtr->numPasses++;
+            n /= radices[j];
+        }
+    }
+    if (n != 1) {
+        FftPlan *subPtr;
+        double *bRe, *bIm;
+        long m;
+
+        /* Some factor is too large.  Use Bluestein's algorithm. */
+        planPtr->numPasses = 0;
+        planPtr->flags |= FFT_PLAN_BLUESTEIN;
+        for (m = 1; m < (2 * length - 1); m <<= 1) {
+            /*empty*/
+        }
+        subPtr = planPtr->subPlanPtr = NewFftPlan(m, 0);
+        planPtr->work = Blt_AssertMalloc(4 * m * sizeof(double));
+        planPtr->tables = Blt_AssertMalloc(2 * (length + m) * sizeof(double));
+        planPtr->chirpRe = planPtr->tables;
+        planPtr->chirpIm = planPtr->chirpRe + length;
+        planPtr->filterRe = planPtr->chirpIm + length;
+        planPtr->filterIm = planPtr->filterRe + m;
+        for (i = 0; i < length; i++) {
+            double theta;
+            unsigned long long k2;
+            
+            /* Reduce k * k modulo 2n to keep the angle accurate. */
+            k2 = ((unsigned long long)i * i) % (2ULL * length);
+            theta = -M_PI * (double)k2 / length;
+            planPtr->chirpRe[i] = cos(theta);
+            planPtr->chirpIm[i] = sin(theta);
+        }
+        bRe = planPtr->work, bIm = bRe + m;
+        memset(bRe, 0, 2 * m * sizeof(double));
+        bRe[0] = planPtr->chirpRe[0], bIm[0] = -planPtr->chirpIm[0];
+        for (i = 1; i < length; i++) {
+            bRe[i] = bRe[m - i] = planPtr->chirpRe[i];
+            bIm[i] = bIm[m - i] = -planPtr->chirpIm[i];
+        }
+        RunPasses(subPtr, bRe, bIm, planPtr->filterRe, planPtr->filterIm);
+        for (i = 0; i < m; i++) {
+            planPtr->filterRe[i] /= m;
+            planPtr->filterIm[i] /= m;
+        }
+        return planPtr;
+    }
+
+    /* Compute the twiddle factors of each pass. */
+    n = length;
+    s = 1;
+    for (j = 0; j < planPtr->numPasses; j++) {
+        FftPass *passPtr;
+
+        passPtr = planPtr->passes + j;
+        passPtr->m = n / passPtr->radix;
+        passPtr->s = s;
+        numTwiddles += (passPtr->radix - 1) * passPtr->m;
+        s *= passPtr->radix;
+        n = passPtr->m;
+    }
+    planPtr->work = Blt_AssertMalloc(2 * length * sizeof(double));
+    if (numTwiddles > 0) {
+        planPtr->tables = Blt_AssertMalloc(2 * numTwiddles * sizeof(double));
+    }
+    twPtr = planPtr->tables;
+    for (j = 0; j < planPtr->numPasses; j++) {
+        FftPass *passPtr;
+        long p, count;
+        int r;
+
+        passPtr = planPtr->passes + j;
+        count = (passPtr->radix - 1) * passPtr->m;
+        passPtr->twRe = twPtr;
+        passPtr->twIm = twPtr + count;
+        twPtr += 2 * count;
+        n = passPtr->radix * passPtr->m;
+        for (r = 1; r < passPtr->radix; r++) {
+            for (p = 0; p < passPtr->m; p++) {
+                double theta;
+
+                theta = -2.0 * M_PI * (double)((r * p) % n) / n;
+                passPtr->twRe[(r - 1) * passPtr->m + p] = cos(theta);
+                passPtr->twIm[(r - 1) * passPtr->m + p] = sin(theta);
+            }
+        }
+    }
+    return planPtr;
+}
+
+static void
+FreeFftPlan(FftPlan *planPtr)
+{
+    if (planPtr->subPlanPtr != NULL) {
+        FreeFftPlan(planPtr->subPlanPtr);
+    }
+    if (planPtr->tables != NULL) {
+        Blt_Free(planPtr->tables);
+    }
+    if (planPtr->work != NULL) {
+        Blt_Free(planPtr->work);
+    }
+    Blt_Free(planPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_GetFftPlan --
+ *
+ *      Returns a plan for transforms of the given length, creating it if
+ *      it's not already in the interpreter's cache.  The caller must
+ *      release the plan with Blt_Vec_ReleaseFftPlan.
+ *
+ *---------------------------------------------------------------------------
+ */
+FftPlan *
+Blt_Vec_GetFftPlan(VectorCmdInterpData *dataPtr, long length, 
+                   unsigned int flags)
+{
+    Blt_HashEntry *hPtr;
+    FftPlan *planPtr;
+    uintptr_t key;
+    int isNew;
+
+    flags &= FFT_PLAN_REAL;
+    key = ((uintptr_t)length << 1) | flags;
+    hPtr = Blt_CreateHashEntry(&dataPtr->fftPlanTable, (char *)key, &isNew);
+    if (!isNew) {
+        planPtr = Blt_GetHashValue(hPtr);
+        planPtr->refCount++;
+        return planPtr;
+    }
+    planPtr = NewFftPlan(length, flags);
+    planPtr->hashPtr = hPtr;
+    planPtr->refCount = 1;
+    Blt_SetHashValue(hPtr, planPtr);
+    return planPtr;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_ReleaseFftPlan --
+ *
+ *      Releases a plan.  Unused plans stay in the cache until there are
+ *      more than FFT_PLAN_CACHE_SIZE plans.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_ReleaseFftPlan(VectorCmdInterpData *dataPtr, FftPlan *planPtr)
+{
+    Blt_HashEntry *hPtr, *nextPtr;
+    Blt_HashSearch iter;
+
+    planPtr->refCount--;
+    if (dataPtr->fftPlanTable.numEntries <= FFT_PLAN_CACHE_SIZE) {
+        return;
+    }
+    for (hPtr = Blt_FirstHashEntry(&dataPtr->fftPlanTable, &iter); 
+         hPtr != NULL; hPtr = nextPtr) {
+        FftPlan *cachePtr;
+
+        nextPtr = Blt_NextHashEntry(&iter);
+        cachePtr = Blt_GetHashValue(hPtr);
+        if (cachePtr->refCount <= 0) {
+            Blt_DeleteHashEntry(&dataPtr->fftPlanTable, hPtr);
+            FreeFftPlan(cachePtr);
+        }
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_FreeFftPlans --
+ *
+ *      Frees all the plans of the interpreter, named or cached.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_FreeFftPlans(VectorCmdInterpData *dataPtr)
+{
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+
+    Blt_DeleteHashTable(&dataPtr->fftNameTable);
+    for (hPtr = Blt_FirstHashEntry(&dataPtr->fftPlanTable, &iter); 
+         hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+        FreeFftPlan(Blt_GetHashValue(hPtr));
+    }
+    Blt_DeleteHashTable(&dataPtr->fftPlanTable);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_ExecuteFft --
+ *
+ *      Computes a transform with the plan.  The forward transform is
+ *
+ *              X[k] = sum(x[j] * exp(-2 * pi * i * j * k / n))
+ *
+ *      and the inverse is scaled by 1/n.  A complex plan transforms n
+ *      complex values into n complex values.  A real plan transforms n
+ *      real values (inRe) into the first n/2 + 1 complex terms, and its
+ *      inverse does the opposite (the result is in outRe).  The input and
+ *      output arrays can not overlap.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_ExecuteFft(FftPlan *planPtr, int inverse, const double *inRe, 
+                   const double *inIm, double *outRe, double *outIm)
+{
+    if (planPtr->flags & FFT_PLAN_REAL) {
+        if (inverse) {
+            RealInverse(planPtr, inRe, inIm, outRe);
+        } else {
+            RealForward(planPtr, inRe, outRe, outIm);
+        }
+    } else if (inverse) {
+        double scale;
+        long i;
+
+        ComplexTransform(planPtr, inIm, inRe, outIm, outRe);
+        scale = 1.0 / planPtr->length;
+        for (i = 0; i < planPtr->length; i++) {
+            outRe[i] *= scale;
+            outIm[i] *= scale;
+        }
+    } else {
+        ComplexTransform(planPtr, inRe, inIm, outRe, outIm);
+    }
+}
 
 static long 
 smallest_power_of_2_not_less_than(long x)
@@ -145,6 +970,7 @@ smallest_power_of_2_not_less_than(long x)
     return pow2;
 }
 
+/* spinellia@acm.org START */
 
 int
 Blt_Vec_FFT(
@@ -153,7 +979,7 @@ Blt_Vec_FFT(
     Vector *realVecPtr,                 /* If non-NULL, indicates to
                                          * compute and store the real
                                          * values in this vector.  */
-    Vector *phasesVecPtr,                  /* If non-NULL, indicates to
+    Vector *phasesVecPtr,               /* If non-NULL, indicates to
                                          * compute and store the imaginary
                                          * values in this vector. */
     Vector *freqVecPtr,                 /* If non-NULL, indicates to
@@ -162,26 +988,30 @@ Blt_Vec_FFT(
     double delta,                       /*  */
     int flags,                          /* Bit mask representing various
                                          * flags: FFT_NO_CONSTANT,
-                                         * FFT_SPECTRUM, and
-                                         * FFT_BARTLETT. */
+                                         * FFT_SPECTRUM, FFT_BARTLETT,
+                                         * and FFT_NO_PAD. */
     Vector *srcPtr) 
 {
-    long length;
-    long pow2len;
-    double *pad;
-    long i;
+    FftPlan *planPtr;
+    double *pad, *outRe, *outIm;
+    const double *values;
+    long i, length, n, numTerms, numValues;
     double Wss = 0.0;
-    /* TENTATIVE */
-    long middle = 1;
     int noconstant;
 
     noconstant = (flags & FFT_NO_CONSTANT) ? 1 : 0;
 
     /* Length of the original vector. */
     length = srcPtr->last - srcPtr->first;
-
-    /* New length */
-    pow2len = smallest_power_of_2_not_less_than(length);
+    if (length < 1) {
+        Tcl_AppendResult(interp, "can't transform empty vector \"", 
+                srcPtr->name, "\"", (char *)NULL);
+        return TCL_ERROR;
+    }
+    /* Length of the transform. */
+    n = (flags & FFT_NO_PAD) ? length : 
+        smallest_power_of_2_not_less_than(length);
+    numTerms = n / 2 + 1;
 
     /* We do not do in-place FFTs */
     if (realVecPtr == srcPtr) {
@@ -189,14 +1019,20 @@ Blt_Vec_FFT(
                  "\" can't be the same as the source", (char *)NULL);
         return TCL_ERROR;
     }
+    numValues = (flags & FFT_SPECTRUM) ? n / 2 - noconstant : 
+        numTerms - noconstant;
+    if (Blt_Vec_ChangeLength(interp, realVecPtr, MAX(numValues, 0)) 
+        != TCL_OK) {
+        return TCL_ERROR;
+    }
     if (phasesVecPtr != NULL) {
         if (phasesVecPtr == srcPtr) {
             Tcl_AppendResult(interp, "imaginary vector \"", phasesVecPtr->name, 
                         "\" can't be the same as the source", (char *)NULL);
             return TCL_ERROR;
         }
-        if (Blt_Vec_ChangeLength(interp, phasesVecPtr, 
-                pow2len/2-noconstant+middle) != TCL_OK) {
+        if (Blt_Vec_ChangeLength(interp, phasesVecPtr, numTerms - noconstant)
+            != TCL_OK) {
             return TCL_ERROR;
         }
     }
@@ -206,97 +1042,83 @@ Blt_Vec_FFT(
                      "\" can't be the same as the source", (char *)NULL);
             return TCL_ERROR;
         }
-        if (Blt_Vec_ChangeLength(interp, freqVecPtr, 
-                           pow2len/2-noconstant+middle) != TCL_OK) {
+        if (Blt_Vec_ChangeLength(interp, freqVecPtr, numTerms - noconstant)
+            != TCL_OK) {
             return TCL_ERROR;
         }
     }
 
-    /* Allocate memory zero-filled array. */
-    pad = Blt_Calloc(pow2len * 2, sizeof(double));
+    /* Zero-filled input followed by the real and imaginary terms. */
+    pad = Blt_Calloc(n + 2 * numTerms, sizeof(double));
     if (pad == NULL) {
         Tcl_AppendResult(interp, "can't allocate memory for padded data",
                  (char *)NULL);
         return TCL_ERROR;
     }
-    
-    /*
-     * Since we just do real transforms, only even locations will be
-     * filled with data.
-     */
+    outRe = pad + n;
+    outIm = outRe + numTerms;
+    values = srcPtr->valueArr + srcPtr->first;
     if (flags & FFT_BARTLETT) {
         /* Bartlett window 1 - ( (x - N/2) / (N/2) ) */
-        double Nhalf = pow2len*0.5;
+        double Nhalf = n * 0.5;
         double Nhalf_1 = 1.0 / Nhalf;
         double w;
 
         for (i = 0; i < length; i++) {
             w = 1.0 - fabs( (i-Nhalf) * Nhalf_1 );
             Wss += w;
-            pad[2*i] = w * srcPtr->valueArr[i];
+            pad[i] = w * values[i];
         }
-        for(/*empty*/; i < pow2len; i++) {
+        for(/*empty*/; i < n; i++) {
             w = 1.0 - fabs((i-Nhalf) * Nhalf_1);
             Wss += w;
         }
     } else {
         /* Squared window, i.e. no data windowing. */
-        for (i = 0; i < length; i++) { 
-            pad[2*i] = srcPtr->valueArr[i]; 
-        }
-        Wss = pow2len;
+        memcpy(pad, values, length * sizeof(double));
+        Wss = n;
     }
     
-    /* Fourier */
-    four1(pad-1, pow2len, 1);
-    
-    /*
-      for(i=0;i<pow2len;i++){
-      printf( "(%f %f) ", pad[2*i], pad[2*i+1] );
-      }
-    */
+    /* Fourier.  Only the first n/2 + 1 terms of a real transform are
+     * computed, the others are their conjugates. */
+    planPtr = Blt_Vec_GetFftPlan(srcPtr->dataPtr, n, FFT_PLAN_REAL);
+    Blt_Vec_ExecuteFft(planPtr, FALSE, pad, NULL, outRe, outIm);
+    Blt_Vec_ReleaseFftPlan(srcPtr->dataPtr, planPtr);
     
     /* the spectrum is the modulus of the transforms, scaled by 1/N^2 */
     /* or 1/(N * Wss) for windowed data */
     if (flags & FFT_SPECTRUM) {
-        double factor = 1.0 / (pow2len*Wss);
+        double factor = 1.0 / (n * Wss);
         double *v = realVecPtr->valueArr;
         
-        for (i = 0 + noconstant; i < pow2len / 2; i++) {
+        for (i = 0 + noconstant; i < n / 2; i++) {
             double re, im, reS, imS;
 
-            re = pad[2*i];
-            im = pad[2*i+1];
-            reS = pad[2*pow2len-2*i-2];
-            imS = pad[2*pow2len-2*i-1];
-# if 0
-            v[i - noconstant] = factor *
-                (hypot(pad[2*i], pad[2*i+1]) +
-                 hypot(pad[pow2len*2-2*i-2], pad[pow2len*2-2*i-1]));
-# else
-            v[i - noconstant] = factor * (sqrt(re*re + im*im) + sqrt(reS*reS + imS*imS));
-# endif
+            /* The term n-1-i is the conjugate of the term i+1. */
+            re = outRe[i];
+            im = outIm[i];
+            reS = outRe[i+1];
+            imS = outIm[i+1];
+            v[i - noconstant] = factor * (sqrt(re*re + im*im) + 
+                                          sqrt(reS*reS + imS*imS));
         }
     } else {
-        for(i = 0 + noconstant; i < pow2len / 2 + middle; i++) {
-            realVecPtr->valueArr[i - noconstant] = pad[2*i];
-        }
+        memcpy(realVecPtr->valueArr, outRe + noconstant, 
+               (numTerms - noconstant) * sizeof(double));
     }
     if (phasesVecPtr != NULL) {
-        for (i = 0 + noconstant; i < pow2len / 2 + middle; i++) {
-            phasesVecPtr->valueArr[i-noconstant] = pad[2*i+1];
-        }
+        memcpy(phasesVecPtr->valueArr, outIm + noconstant, 
+               (numTerms - noconstant) * sizeof(double));
     }
     
     /* Compute frequencies */
     if (freqVecPtr != NULL) {
-        double N = pow2len;
-        double denom = 1.0 / N / delta;
-        for( i=0+noconstant; i<pow2len/2+middle; i++ ){
+        double denom = 1.0 / n / delta;
+
+        for (i = 0 + noconstant; i < numTerms; i++) {
             freqVecPtr->valueArr[i-noconstant] = ((double) i) * denom;
         }
     }
-    /* Memory is necessarily dynamic, because nobody touched it ! */
     Blt_Free(pad);
     
     realVecPtr->offset = 0;
@@ -306,76 +1128,679 @@ Blt_Vec_FFT(
 
 int
 Blt_Vec_InverseFFT(Tcl_Interp *interp, Vector *srcImagPtr, Vector *destRealPtr, 
-                   Vector *destImagPtr, Vector *srcPtr)
+                   Vector *destImagPtr, int flags, Vector *srcPtr)
 {
-    double *pad;
-    double oneOverN;
-    long i, length, pow2len;
+    FftPlan *planPtr;
+    double *pad, *re, *im;
+    long i, length, n;
 
-    if ((destRealPtr == srcPtr) || (destImagPtr == srcPtr )){
+    if ((destRealPtr == srcPtr) || (destImagPtr == srcPtr) ||
+        (destRealPtr == srcImagPtr) || (destImagPtr == srcImagPtr)) {
         Tcl_AppendResult(interp,
                 "real or imaginary vectors can't be same as source",
                 (char *)NULL);
         return TCL_ERROR;               /* We do not do in-place FFTs */
     }
+    if (destRealPtr == destImagPtr) {
+        Tcl_AppendResult(interp, "real and imaginary vectors can't be the ",
+                "same", (char *)NULL);
+        return TCL_ERROR;
+    }
     length = srcPtr->last - srcPtr->first;
+    if (length != (srcImagPtr->last - srcImagPtr->first)) {
+        Tcl_AppendResult(interp, "the length of the imagPart vector must ",
+                "be the same as the real one", (char *)NULL);
+        return TCL_ERROR;
+    }
+    if (length < 1) {
+        Tcl_AppendResult(interp, "can't transform empty vector \"", 
+                srcPtr->name, "\"", (char *)NULL);
+        return TCL_ERROR;
+    }
 
     /* Minus one because of the magical middle element! */
-    pow2len = smallest_power_of_2_not_less_than( (length-1)*2 );
-    oneOverN = 1.0 / pow2len;
+    n = (length - 1) * 2;
+    if (n < 1) {
+        n = 1;
+    }
+    if ((flags & FFT_NO_PAD) == 0) {
+        n = smallest_power_of_2_not_less_than(n);
+    }
+    if ((Blt_Vec_ChangeLength(interp, destRealPtr, n) != TCL_OK) ||
+        (Blt_Vec_ChangeLength(interp, destImagPtr, n) != TCL_OK)) {
+        return TCL_ERROR;
+    }
+    pad = Blt_Calloc(2 * n, sizeof(double));
+    if (pad == NULL) {
+        Tcl_AppendResult(interp, "can't allocate memory for padded data",
+                 (char *)NULL);
+        return TCL_ERROR;
+    }
+    re = srcPtr->valueArr + srcPtr->first;
+    im = srcImagPtr->valueArr + srcImagPtr->first;
+    for (i = 0; i < (length - 1); i++) {
+        pad[i] = re[i];
+        pad[n + i] = im[i];
+        pad[n - i - 1] = re[i + 1];
+        pad[2 * n - i - 1] = -im[i + 1];
+    }
 
-    if (Blt_Vec_ChangeLength(interp, destRealPtr, pow2len) != TCL_OK) {
+    /* Mythical middle element */
+    pad[length - 1] = re[length - 1];
+    pad[n + length - 1] = im[length - 1];
+
+    /* Fourier, normalised by 1/N */
+    planPtr = Blt_Vec_GetFftPlan(srcPtr->dataPtr, n, 0);
+    Blt_Vec_ExecuteFft(planPtr, TRUE, pad, pad + n, destRealPtr->valueArr, 
+        destImagPtr->valueArr);
+    Blt_Vec_ReleaseFftPlan(srcPtr->dataPtr, planPtr);
+    Blt_Free(pad);
+    return TCL_OK;
+}
+
+/* spinellia@acm.org STOP */
+
+typedef struct {
+    long length;                        /* Length of the transform. */
+    unsigned int flags;
+} PlanSwitches;
+
+#define PLAN_COMPLEX            (1<<0)
+
+static Blt_SwitchSpec planSwitches[] = 
+{
+    {BLT_SWITCH_BITS_NOARG, "-complex", "", (char *)NULL,
+        Blt_Offset(PlanSwitches, flags), 0, PLAN_COMPLEX},
+    {BLT_SWITCH_LONG_POS, "-length", "number", (char *)NULL,
+        Blt_Offset(PlanSwitches, length), 0},
+    {BLT_SWITCH_END}
+};
+
+typedef struct {
+    Tcl_Obj *imagObjPtr;                /* List of vectors holding the
+                                         * imaginary parts of the input
+                                         * (forward) or output
+                                         * (inverse). */
+} ExecuteSwitches;
+
+static Blt_SwitchSpec executeSwitches[] = 
+{
+    {BLT_SWITCH_OBJ, "-imagpart", "vecList", (char *)NULL,
+        Blt_Offset(ExecuteSwitches, imagObjPtr), 0},
+    {BLT_SWITCH_END}
+};
+
+static int
+GetPlanFromObj(Tcl_Interp *interp, VectorCmdInterpData *dataPtr, 
+               Tcl_Obj *objPtr, FftPlan **planPtrPtr)
+{
+    Blt_HashEntry *hPtr;
+    const char *name;
+
+    name = Tcl_GetString(objPtr);
+    hPtr = Blt_FindHashEntry(&dataPtr->fftNameTable, name);
+    if (hPtr == NULL) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't find fft plan \"", name, "\"",
+                (char *)NULL);
+        }
         return TCL_ERROR;
     }
-    if (Blt_Vec_ChangeLength(interp, destImagPtr, pow2len) != TCL_OK) {
+    *planPtrPtr = Blt_GetHashValue(hPtr);
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetVectorsFromObj --
+ *
+ *      Converts a list of vector names into an array of vectors.  The
+ *      array must be freed by the caller.  
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+GetVectorsFromObj(Tcl_Interp *interp, VectorCmdInterpData *dataPtr, 
+                  Tcl_Obj *objPtr, int *numVectorsPtr, Vector ***vecsPtr)
+{
+    Tcl_Obj **objv;
+    Vector **vecs;
+    int i, objc;
+
+    if (Tcl_ListObjGetElements(interp, objPtr, &objc, &objv) != TCL_OK) {
         return TCL_ERROR;
     }
+    vecs = Blt_AssertMalloc(sizeof(Vector *) * (objc + 1));
+    for (i = 0; i < objc; i++) {
+        if (Blt_Vec_Find(dataPtr, Tcl_GetString(objv[i]), vecs + i) 
+            != TCL_OK) {
+            Blt_Free(vecs);
+            return TCL_ERROR;
+        }
+    }
+    *numVectorsPtr = objc;
+    *vecsPtr = vecs;
+    return TCL_OK;
+}
 
-    if( length != (srcImagPtr->last - srcImagPtr->first) ){
-        Tcl_AppendResult(srcPtr->interp,
-                "the length of the imagPart vector must ",
-                "be the same as the real one", (char *)NULL);
+static int
+CheckLength(Tcl_Interp *interp, Vector *vPtr, long length)
+{
+    if ((vPtr->last - vPtr->first) != length) {
+        Tcl_AppendResult(interp, "vector \"", vPtr->name, "\" must have ",
+                Blt_Ltoa(length), " points", (char *)NULL);
         return TCL_ERROR;
     }
+    return TCL_OK;
+}
 
-    pad = Blt_AssertMalloc( pow2len*2*sizeof(double) );
-    if( pad == NULL ){
-        if (interp != NULL) {
-            Tcl_AppendResult(interp, "memory allocation failed", (char *)NULL);
+static void
+UpdateVector(Vector *vPtr)
+{
+    if (vPtr->flush) {
+        Blt_Vec_FlushCache(vPtr);
+    }
+    Blt_Vec_UpdateClients(vPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ExecuteBatch --
+ *
+ *      Transforms each vector (or pair of vectors) of the source lists
+ *      with the plan, putting the results in the vectors of the
+ *      destination lists.  All the lists must have the same number of
+ *      vectors.  The lengths of the source vectors are checked before any
+ *      transform is computed, so that nothing is changed on an error.
+ *
+ *      Forward transforms take n points and return n complex terms, or
+ *      n/2 + 1 terms for real plans.  Inverse transforms go the other
+ *      way.  The imaginary parts of complex input are zero if they are
+ *      not given.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ExecuteBatch(Tcl_Interp *interp, VectorCmdInterpData *dataPtr, 
+             FftPlan *planPtr, int inverse, Tcl_Obj *srcReObjPtr, 
+             Tcl_Obj *srcImObjPtr, Tcl_Obj *destReObjPtr, 
+             Tcl_Obj *destImObjPtr)
+{
+    Vector **srcRe, **srcIm, **destRe, **destIm;
+    double *scratch;
+    long inLength, outLength;
+    int numSrcRe, numSrcIm, numDestRe, numDestIm;
+    int i, isReal, result;
+
+    srcRe = srcIm = destRe = destIm = NULL;
+    numSrcIm = numDestIm = 0;
+    scratch = NULL;
+    result = TCL_ERROR;
+    if ((GetVectorsFromObj(interp, dataPtr, srcReObjPtr, &numSrcRe, &srcRe) 
+         != TCL_OK) ||
+        (GetVectorsFromObj(interp, dataPtr, destReObjPtr, &numDestRe, &destRe)
+         != TCL_OK)) {
+        goto done;
+    }
+    if ((srcImObjPtr != NULL) &&
+        (GetVectorsFromObj(interp, dataPtr, srcImObjPtr, &numSrcIm, &srcIm) 
+         != TCL_OK)) {
+        goto done;
+    }
+    if ((destImObjPtr != NULL) &&
+        (GetVectorsFromObj(interp, dataPtr, destImObjPtr, &numDestIm, &destIm)
+         != TCL_OK)) {
+        goto done;
+    }
+    if ((numDestRe != numSrcRe) || ((srcIm != NULL) && (numSrcIm != numSrcRe))
+        || ((destIm != NULL) && (numDestIm != numSrcRe))) {
+        Tcl_AppendResult(interp, "vector lists must have the same number ",
+                "of vectors", (char *)NULL);
+        goto done;
+    }
+    isReal = (planPtr->flags & FFT_PLAN_REAL);
+    inLength = outLength = planPtr->length;
+    if (isReal) {
+        if (inverse) {
+            inLength = planPtr->length / 2 + 1;
+        } else {
+            outLength = planPtr->length / 2 + 1;
+        }
+    }
+    for (i = 0; i < numSrcRe; i++) {
+        int j;
+
+        if (CheckLength(interp, srcRe[i], inLength) != TCL_OK) {
+            goto done;
+        }
+        if ((srcIm != NULL) && (CheckLength(interp, srcIm[i], inLength) 
+                != TCL_OK)) {
+            goto done;
+        }
+        /* We do not do in-place FFTs */
+        for (j = 0; j < 2; j++) {
+            Vector *vPtr;
+
+            vPtr = (j == 0) ? destRe[i] : 
+                ((destIm != NULL) ? destIm[i] : NULL);
+            if (vPtr == NULL) {
+                continue;
+            }
+            if ((vPtr == srcRe[i]) || ((srcIm != NULL) && (vPtr == srcIm[i]))) {
+                Tcl_AppendResult(interp, "vector \"", vPtr->name, 
+                        "\" can't be the same as the source", (char *)NULL);
+                goto done;
+            }
+        }
+        if ((destIm != NULL) && (destRe[i] == destIm[i])) {
+            Tcl_AppendResult(interp, "real and imaginary vectors can't be ",
+                "the same", (char *)NULL);
+            goto done;
+        }
+    }
+    /* Zeros for missing imaginary input and a sink for unwanted
+     * imaginary output. */
+    scratch = Blt_Calloc(2 * planPtr->length + 2, sizeof(double));
+    if (scratch == NULL) {
+        Tcl_AppendResult(interp, "can't allocate scratch space", (char *)NULL);
+        goto done;
+    }
+    for (i = 0; i < numSrcRe; i++) {
+        const double *inRe, *inIm;
+        double *outRe, *outIm;
+        long outImLength;
+
+        /* Real plans take or return only the real parts of the points. */
+        outImLength = (isReal && inverse) ? 0 : outLength;
+        if (Blt_Vec_ChangeLength(interp, destRe[i], outLength) != TCL_OK) {
+            goto done;
+        }
+        if ((destIm != NULL) && 
+            (Blt_Vec_ChangeLength(interp, destIm[i], outImLength) != TCL_OK)) {
+            goto done;
+        }
+        inRe = srcRe[i]->valueArr + srcRe[i]->first;
+        inIm = (srcIm != NULL) ? srcIm[i]->valueArr + srcIm[i]->first : 
+            scratch;
+        outRe = destRe[i]->valueArr;
+        outIm = ((destIm != NULL) && (outImLength > 0)) ? 
+            destIm[i]->valueArr : scratch + planPtr->length + 1;
+        Blt_Vec_ExecuteFft(planPtr, inverse, inRe, inIm, outRe, outIm);
+        destRe[i]->offset = 0;
+        UpdateVector(destRe[i]);
+        if (destIm != NULL) {
+            destIm[i]->offset = 0;
+            UpdateVector(destIm[i]);
+        }
+    }
+    result = TCL_OK;
+ done:
+    if (scratch != NULL) {
+        Blt_Free(scratch);
+    }
+    if (srcRe != NULL) {
+        Blt_Free(srcRe);
+    }
+    if (srcIm != NULL) {
+        Blt_Free(srcIm);
+    }
+    if (destRe != NULL) {
+        Blt_Free(destRe);
+    }
+    if (destIm != NULL) {
+        Blt_Free(destIm);
+    }
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PlanCreateOp --
+ *
+ *      Creates a named plan for transforms of a given length.  Real plans
+ *      (the default) transform real values.
+ *
+ * Results:
+ *      A standard TCL result.  The name of the plan is returned.
+ *
+ *      blt::fft plan create ?planName? ?-length n? ?-complex?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+PlanCreateOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
+{
+    VectorCmdInterpData *dataPtr = clientData;
+    Blt_HashEntry *hPtr;
+    PlanSwitches switches;
+    const char *name;
+    char ident[200];
+    int isNew;
+
+    name = NULL;
+    if (objc > 3) {
+        const char *string;
+
+        string = Tcl_GetString(objv[3]);
+        if (string[0] != '-') {
+            name = string;
+            objc--, objv++;
         }
+    }
+    memset(&switches, 0, sizeof(switches));
+    if (Blt_ParseSwitches(interp, planSwitches, objc - 3, objv + 3, &switches, 
+        BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    if (switches.length <= 0) {
+        Tcl_AppendResult(interp, "missing -length switch", (char *)NULL);
         return TCL_ERROR;
     }
-    for(i=0;i<pow2len*2;i++) { pad[i] = 0.0; }
-    for(i=0;i<length-1;i++){
-        pad[2*i] = srcPtr->valueArr[i];
-        pad[2*i+1] = srcImagPtr->valueArr[i];
-        pad[pow2len*2 - 2*i - 2 ] = srcPtr->valueArr[i+1];
-        pad[pow2len*2 - 2*i - 1 ] = - srcImagPtr->valueArr[i+1];
+    if (name == NULL) {
+        do {
+            Blt_FmtString(ident, 200, "fft%d", dataPtr->nextFftId++);
+        } while (Blt_FindHashEntry(&dataPtr->fftNameTable, ident) != NULL);
+        name = ident;
     }
+    hPtr = Blt_CreateHashEntry(&dataPtr->fftNameTable, name, &isNew);
+    if (!isNew) {
+        Tcl_AppendResult(interp, "fft plan \"", name, "\" already exists",
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    Blt_SetHashValue(hPtr, Blt_Vec_GetFftPlan(dataPtr, switches.length, 
+        (switches.flags & PLAN_COMPLEX) ? 0 : FFT_PLAN_REAL));
+    Tcl_SetStringObj(Tcl_GetObjResult(interp), name, -1);
+    return TCL_OK;
+}
 
-    /* Mythical middle element */
-    pad[(length-1)*2] = srcPtr->valueArr[length-1];
-    pad[(length-1)*2+1] = srcImagPtr->valueArr[length-1];
-
-    /*
-      for(i=0;i<pow2len;i++){
-      printf( "(%f %f) ", pad[2*i], pad[2*i+1] );
-      }
-    */
-    
-    /* Fourier */
-    four1( pad-1, pow2len, -1 );
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PlanDeleteOp --
+ *
+ *      Deletes one or more named plans.  The plan itself stays in the
+ *      interpreter's plan cache while it's in use.
+ *
+ *      blt::fft plan delete ?planName ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+PlanDeleteOp(ClientData clientData, Tcl_Interp *interp, int objc,
+             Tcl_Obj *const *objv)
+{
+    VectorCmdInterpData *dataPtr = clientData;
+    int i;
+
+    for (i = 3; i < objc; i++) {
+        Blt_HashEntry *hPtr;
+        const char *name;
 
-    /* Put values in their places, normalising by 1/N */
-    for(i=0;i<pow2len;i++){
-        destRealPtr->valueArr[i] = pad[2*i] * oneOverN;
-        destImagPtr->valueArr[i] = pad[2*i+1] * oneOverN;
+        name = Tcl_GetString(objv[i]);
+        hPtr = Blt_FindHashEntry(&dataPtr->fftNameTable, name);
+        if (hPtr == NULL) {
+            Tcl_AppendResult(interp, "can't find fft plan \"", name, "\"",
+                (char *)NULL);
+            return TCL_ERROR;
+        }
+        Blt_Vec_ReleaseFftPlan(dataPtr, Blt_GetHashValue(hPtr));
+        Blt_DeleteHashEntry(&dataPtr->fftNameTable, hPtr);
     }
+    return TCL_OK;
+}
 
-    /* Memory is necessarily dynamic, because nobody touched it ! */
-    Blt_Free(pad);
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PlanInfoOp --
+ *
+ *      Returns a list of name-value pairs describing the plan: its
+ *      length, type (real or complex), algorithm (mixedradix or
+ *      bluestein), and the radices of its passes.
+ *
+ *      blt::fft plan info planName
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+PlanInfoOp(ClientData clientData, Tcl_Interp *interp, int objc,
+           Tcl_Obj *const *objv)
+{
+    VectorCmdInterpData *dataPtr = clientData;
+    FftPlan *planPtr, *cplxPtr;
+    Tcl_Obj *listObjPtr, *radixObjPtr;
+    int i;
+
+    if (GetPlanFromObj(interp, dataPtr, objv[3], &planPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    cplxPtr = planPtr;
+    if (planPtr->flags & FFT_PLAN_REAL) {
+        cplxPtr = planPtr->subPlanPtr;
+    }
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+        Tcl_NewStringObj("length", 6));
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+        Tcl_NewLongObj(planPtr->length));
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj("type", 4));
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj(
+        (planPtr->flags & FFT_PLAN_REAL) ? "real" : "complex", -1));
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+        Tcl_NewStringObj("algorithm", 9));
+    Tcl_ListObjAppendElement(interp, listObjPtr, Tcl_NewStringObj(
+        (cplxPtr->flags & FFT_PLAN_BLUESTEIN) ? "bluestein" : "mixedradix",
+        -1));
+    if (cplxPtr->flags & FFT_PLAN_BLUESTEIN) {
+        cplxPtr = cplxPtr->subPlanPtr;
+    }
+    radixObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    for (i = 0; i < cplxPtr->numPasses; i++) {
+        Tcl_ListObjAppendElement(interp, radixObjPtr, 
+                Tcl_NewIntObj(cplxPtr->passes[i].radix));
+    }
+    Tcl_ListObjAppendElement(interp, listObjPtr, 
+        Tcl_NewStringObj("radices", 7));
+    Tcl_ListObjAppendElement(interp, listObjPtr, radixObjPtr);
+    Tcl_SetObjResult(interp, listObjPtr);
     return TCL_OK;
 }
 
-/* spinellia@acm.org STOP */
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PlanNamesOp --
+ *
+ *      Returns the names of the plans matching any of the patterns.
+ *
+ *      blt::fft plan names ?pattern ...?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+PlanNamesOp(ClientData clientData, Tcl_Interp *interp, int objc,
+            Tcl_Obj *const *objv)
+{
+    VectorCmdInterpData *dataPtr = clientData;
+    Blt_HashEntry *hPtr;
+    Blt_HashSearch iter;
+    Tcl_Obj *listObjPtr;
+
+    listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **)NULL);
+    for (hPtr = Blt_FirstHashEntry(&dataPtr->fftNameTable, &iter); 
+         hPtr != NULL; hPtr = Blt_NextHashEntry(&iter)) {
+        const char *name;
+        int i, match;
+
+        name = Blt_GetHashKey(&dataPtr->fftNameTable, hPtr);
+        match = (objc == 3);
+        for (i = 3; i < objc; i++) {
+            if (Tcl_StringMatch(name, Tcl_GetString(objv[i]))) {
+                match = TRUE;
+                break;
+            }
+        }
+        if (match) {
+            Tcl_ListObjAppendElement(interp, listObjPtr, 
+                Tcl_NewStringObj(name, -1));
+        }
+    }
+    Tcl_SetObjResult(interp, listObjPtr);
+    return TCL_OK;
+}
+
+static Blt_OpSpec planOps[] =
+{
+    {"create", 1, PlanCreateOp, 3, 0, "?planName? ?switches?",},
+    {"delete", 1, PlanDeleteOp, 3, 0, "?planName ...?",},
+    {"info",   1, PlanInfoOp,   4, 4, "planName",},
+    {"names",  1, PlanNamesOp,  3, 0, "?pattern ...?",},
+};
+
+static int numPlanOps = sizeof(planOps) / sizeof(Blt_OpSpec);
+
+static int
+PlanOp(ClientData clientData, Tcl_Interp *interp, int objc,
+       Tcl_Obj *const *objv)
+{
+    Tcl_ObjCmdProc *proc;
+
+    proc = Blt_GetOpFromObj(interp, numPlanOps, planOps, BLT_OP_ARG2, objc, 
+        objv, 0);
+    if (proc == NULL) {
+        return TCL_ERROR;
+    }
+    return (*proc) (clientData, interp, objc, objv);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ForwardOp --
+ *
+ *      Computes the forward transforms of a list of vectors.  For real
+ *      plans, only the first n/2 + 1 terms are returned.  The imaginary
+ *      parts of the input of complex plans are given by the -imagpart
+ *      switch.
+ *
+ *      blt::fft forward planName srcList realList imagList ?-imagpart list?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+ForwardOp(ClientData clientData, Tcl_Interp *interp, int objc,
+          Tcl_Obj *const *objv)
+{
+    VectorCmdInterpData *dataPtr = clientData;
+    ExecuteSwitches switches;
+    FftPlan *planPtr;
+    int result;
+
+    if (GetPlanFromObj(interp, dataPtr, objv[2], &planPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    memset(&switches, 0, sizeof(switches));
+    if (Blt_ParseSwitches(interp, executeSwitches, objc - 6, objv + 6, 
+        &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    if ((switches.imagObjPtr != NULL) && (planPtr->flags & FFT_PLAN_REAL)) {
+        Tcl_AppendResult(interp, "fft plan \"", Tcl_GetString(objv[2]), 
+                "\" is real: can't use -imagpart", (char *)NULL);
+        Blt_FreeSwitches(executeSwitches, &switches, 0);
+        return TCL_ERROR;
+    }
+    result = ExecuteBatch(interp, dataPtr, planPtr, FALSE, objv[3], 
+        switches.imagObjPtr, objv[4], objv[5]);
+    Blt_FreeSwitches(executeSwitches, &switches, 0);
+    return result;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * InverseOp --
+ *
+ *      Computes the inverse transforms of a list of vectors, scaled by
+ *      1/n.  For real plans, the input has n/2 + 1 terms and the output n
+ *      real values.  The imaginary parts of the output of complex plans
+ *      are returned in the vectors of the -imagpart switch.
+ *
+ *      blt::fft inverse planName realList imagList destList ?-imagpart list?
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+InverseOp(ClientData clientData, Tcl_Interp *interp, int objc,
+          Tcl_Obj *const *objv)
+{
+    VectorCmdInterpData *dataPtr = clientData;
+    ExecuteSwitches switches;
+    FftPlan *planPtr;
+    int result;
+
+    if (GetPlanFromObj(interp, dataPtr, objv[2], &planPtr) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    memset(&switches, 0, sizeof(switches));
+    if (Blt_ParseSwitches(interp, executeSwitches, objc - 6, objv + 6, 
+        &switches, BLT_SWITCH_DEFAULTS) < 0) {
+        return TCL_ERROR;
+    }
+    if ((switches.imagObjPtr != NULL) && (planPtr->flags & FFT_PLAN_REAL)) {
+        Tcl_AppendResult(interp, "fft plan \"", Tcl_GetString(objv[2]), 
+                "\" is real: can't use -imagpart", (char *)NULL);
+        Blt_FreeSwitches(executeSwitches, &switches, 0);
+        return TCL_ERROR;
+    }
+    result = ExecuteBatch(interp, dataPtr, planPtr, TRUE, objv[3], objv[4],
+        objv[5], switches.imagObjPtr);
+    Blt_FreeSwitches(executeSwitches, &switches, 0);
+    return result;
+}
 
+static Blt_OpSpec fftOps[] =
+{
+    {"forward", 1, ForwardOp, 6, 0, 
+        "planName srcList realList imagList ?switches?",},
+    {"inverse", 1, InverseOp, 6, 0, 
+        "planName realList imagList destList ?switches?",},
+    {"plan",    1, PlanOp,    3, 0, "args...",},
+};
+
+static int numFftOps = sizeof(fftOps) / sizeof(Blt_OpSpec);
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_FftCmd --
+ *
+ *      Implements the "blt::fft" command.  Plans are created once and
+ *      used to transform many vectors of the same length.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+Blt_Vec_FftCmd(ClientData clientData, Tcl_Interp *interp, int objc,
+               Tcl_Obj *const *objv)
+{
+    Tcl_ObjCmdProc *proc;
+
+    proc = Blt_GetOpFromObj(interp, numFftOps, fftOps, BLT_OP_ARG1, objc, 
+        objv, 0);
+    if (proc == NULL) {
+        return TCL_ERROR;
+    }
+    return (*proc) (clientData, interp, objc, objv);
+}
@@ -59,13 +59,31 @@
 #define FFT_NO_CONSTANT         (1<<0)
 #define FFT_BARTLETT            (1<<1)
 #define FFT_SPECTRUM            (1<<2)
+#define FFT_NO_PAD              (1<<3)  /* Transform at the vector's own
+                                         * length, not the next power of
+                                         * two. */
+
+#define FFT_PLAN_REAL           (1<<0)  /* Plan transforms real values. */
+
+typedef struct _FftPlan FftPlan;
+
+/* Formats of the values in files mapped as vectors. */
+#define VECTOR_FORMAT_FLOAT64   0
+#define VECTOR_FORMAT_FLOAT32   1
+#define VECTOR_FORMAT_INT16     2
+
+typedef struct _MappedFile MappedFile;
 
 typedef struct {
     Blt_HashTable vectorTable;  /* Table of vectors */
     Blt_HashTable mathProcTable; /* Table of vector math functions */
     Blt_HashTable indexProcTable;
+    Blt_HashTable fftPlanTable; /* Cache of FFT plans, keyed by length
+                                 * and type. */
+    Blt_HashTable fftNameTable; /* Plans named by "blt::fft plan". */
     Tcl_Interp *interp;
     unsigned int nextId;
+    unsigned int nextFftId;
 } VectorCmdInterpData;
 
 /*
@@ -93,9 +111,9 @@ typedef struct {
      */
 
     double *valueArr;                   /* Array of values (malloc-ed) */
-    int length;                         /* Current number of values in the
+    long length;                        /* Current number of values in the
                                          * array. */
-    int size;                           /* Maximum number of values that
+    long size;                          /* Maximum number of values that
                                          * can be stored in the value
                                          * array. */
     double min, max;                    /* Minimum and maximum values in
@@ -126,7 +144,7 @@ typedef struct {
                                          * any variable */
     Tcl_Namespace *nsPtr;               /* Namespace context of the vector
                                          * itself. */
-    int offset;                         /* Offset from zero of the vector's
+    long offset;                        /* Offset from zero of the vector's
                                          * starting index */
     Tcl_Command cmdToken;               /* Token for vector's TCL
                                          * command. */
@@ -140,11 +158,22 @@ typedef struct {
     int freeOnUnset;                    /* For backward compatibility only:
                                          * If non-zero, free the vector
                                          * when its variable is unset. */
-    int first, last;                    /* Selected region of vector. This
+    long first, last;                   /* Selected region of vector. This
                                          * is used mostly for the math
                                          * routines */
+    size_t mapSize;                     /* # of bytes mapped for the value
+                                         * array if freeProc is
+                                         * VECTOR_MAPPED. */
+    MappedFile *filePtr;                /* File backing the value array if
+                                         * freeProc is
+                                         * VECTOR_FILE_MAPPED. */
 } Vector;
 
+#define VECTOR_MAPPED   ((Tcl_FreeProc *)4) /* The value array was mapped
+                                         * with mmap, not malloc-ed. */
+#define VECTOR_FILE_MAPPED ((Tcl_FreeProc *)5) /* The value array is backed
+                                         * by a mapped file. */
+
 #define NOTIFY_UPDATED          ((int)BLT_VECTOR_NOTIFY_UPDATE)
 #define NOTIFY_DESTROYED        ((int)BLT_VECTOR_NOTIFY_DESTROY)
 
@@ -166,6 +195,27 @@ typedef struct {
                                          * Update the min and max limits when
                                          * they are needed */
 
+/*
+ * VectorStats --
+ *
+ *      Summary statistics of the finite values of a vector, as computed by
+ *      Blt_Vec_GetStats.
+ */
+typedef struct {
+    long count;                         /* # of finite values. */
+    double sum;                         /* Sum of the values. */
+    double min, max;                    /* Smallest and largest values. */
+    double mean;
+    double var, sdev, adev;             /* Variance, standard deviation,
+                                         * and average deviation. */
+    double skew, kurtosis;
+    double q1, median, q3;              /* Quartiles. */
+} VectorStats;
+
+#define STATS_MOMENTS           (1<<0)  /* Compute the variance, deviations,
+                                         * skew, and kurtosis. */
+#define STATS_QUARTILES         (1<<1)  /* Compute the quartiles. */
+
 #define FindRange(array, first, last, min, max) \
 { \
     min = max = 0.0; \
@@ -198,13 +248,13 @@ BLT_EXTERN Vector *Blt_Vec_New(VectorCmdInterpData *dataPtr);
 BLT_EXTERN int Blt_Vec_Duplicate(Vector *destPtr, Vector *srcPtr);
 
 BLT_EXTERN int Blt_Vec_SetLength(Tcl_Interp *interp, Vector *vPtr, 
-        int length);
+        long length);
 
 BLT_EXTERN int Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, 
-        int size);
+        long size);
 
 BLT_EXTERN int Blt_Vec_ChangeLength(Tcl_Interp *interp, Vector *vPtr, 
-        int length);
+        long length);
 
 BLT_EXTERN Vector *Blt_Vec_ParseElement(Tcl_Interp *interp, 
         VectorCmdInterpData *dataPtr, const char *start, const char **endPtr, 
@@ -214,7 +264,7 @@ BLT_EXTERN void Blt_Vec_Free(Vector *vPtr);
 
 BLT_EXTERN void Blt_Vec_SortMap(Vector **vectors, int numVectors,long **mapPtr);
 
-BLT_EXTERN int Blt_Vec_NonemptySortMap(Vector *vPtr, long **mapPtr);
+BLT_EXTERN long Blt_Vec_NonemptySortMap(Vector *vPtr, long **mapPtr);
 
 BLT_EXTERN int Blt_Vec_Find(VectorCmdInterpData *dataPtr, const char *vecName,
         Vector **vPtrPtr);
@@ -230,13 +280,13 @@ BLT_EXTERN void Blt_Vec_UpdateClients(Vector *vPtr);
 BLT_EXTERN void Blt_Vec_FlushCache(Vector *vPtr);
 
 BLT_EXTERN int Blt_Vec_Reset(Vector *vPtr, double *dataArr,
-        int numValues, int arraySize, Tcl_FreeProc *freeProc);
+        long numValues, long arraySize, Tcl_FreeProc *freeProc);
 
 BLT_EXTERN int Blt_Vec_GetSpecialIndex(Tcl_Interp *interp, Vector *vPtr,
         const char *string, Blt_VectorIndexProc **procPtrPtr);
 
 BLT_EXTERN int  Blt_Vec_GetIndex(Tcl_Interp *interp, Vector *vPtr, 
-        const char *string, int *indexPtr);
+        const char *string, long *indexPtr);
 
 BLT_EXTERN int  Blt_Vec_GetRange(Tcl_Interp *interp, Vector *vPtr, 
         const char *string);
@@ -244,12 +294,49 @@ BLT_EXTERN int  Blt_Vec_GetRange(Tcl_Interp *interp, Vector *vPtr,
 BLT_EXTERN int Blt_Vec_MapVariable(Tcl_Interp *interp, Vector *vPtr, 
         const char *name);
 
+BLT_EXTERN int Blt_Vec_ExprObj(Tcl_Interp *interp, Tcl_Obj *objPtr, 
+        Vector *vPtr);
+
+BLT_EXTERN void Blt_Vec_InitStatsProcs(void);
+
+BLT_EXTERN long Blt_Vec_Sums(const double *values, long numValues, 
+        double *sumPtr, double *minPtr, double *maxPtr);
+
+BLT_EXTERN void Blt_Vec_Moments(const double *values, long numValues, 
+        double mean, double *moments);
+
+BLT_EXTERN long Blt_Vec_Quartiles(const double *values, long numValues, 
+        double *q1Ptr, double *medianPtr, double *q3Ptr);
+
+BLT_EXTERN void Blt_Vec_GetStats(Vector *vPtr, unsigned int flags, 
+        VectorStats *statsPtr);
+
 BLT_EXTERN int Blt_Vec_FFT(Tcl_Interp *interp, Vector *realPtr,
         Vector *phasesPtr, Vector *freqPtr, double delta, 
         int flags, Vector *srcPtr);
 
 BLT_EXTERN int Blt_Vec_InverseFFT(Tcl_Interp *interp, Vector *iSrcPtr, 
-        Vector *rDestPtr, Vector *iDestPtr, Vector *srcPtr);
+        Vector *rDestPtr, Vector *iDestPtr, int flags, Vector *srcPtr);
+
+BLT_EXTERN void Blt_Vec_InitFftProcs(void);
+
+BLT_EXTERN FftPlan *Blt_Vec_GetFftPlan(VectorCmdInterpData *dataPtr, 
+        long length, unsigned int flags);
+
+BLT_EXTERN void Blt_Vec_ReleaseFftPlan(VectorCmdInterpData *dataPtr, 
+        FftPlan *planPtr);
+
+BLT_EXTERN void Blt_Vec_FreeFftPlans(VectorCmdInterpData *dataPtr);
+
+BLT_EXTERN void Blt_Vec_ExecuteFft(FftPlan *planPtr, int inverse, 
+        const double *inRe, const double *inIm, double *outRe, double *outIm);
+
+BLT_EXTERN Tcl_ObjCmdProc Blt_Vec_FftCmd;
+
+BLT_EXTERN int Blt_Vec_MapFile(Tcl_Interp *interp, Vector *vPtr, 
+        const char *fileName, int format, long offset, long length);
+
+BLT_EXTERN void Blt_Vec_UnmapFile(Vector *vPtr);
 
 BLT_EXTERN Tcl_ObjCmdProc Blt_Vec_InstCmd;
 
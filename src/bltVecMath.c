@@ -125,12 +125,19 @@ typedef struct {
   #define IS_INF(v) 0
 #endif
 
-/* The data structure below is used to describe an expression value,
- * which can be either a double-precision floating-point value, or a
- * string.  A given number has only one value at a time.  */
+/* Size of the buffer used to hold strings from command and variable
+ * substitutions while parsing an expression. */
 
 #define STATIC_STRING_SPACE 150
 
+/*
+ * Expressions are evaluated in blocks of EXPR_BLOCK_SIZE points.  The
+ * block of each operator stays in the L1 cache while it's consumed by the
+ * next operator, so evaluating an expression makes only one pass over the
+ * operand vectors no matter how many operators it has.
+ */
+#define EXPR_BLOCK_SIZE 256
+
 /*
  * Tokens --
  *
@@ -147,11 +154,96 @@ enum Tokens {
     AND, OR, UNARY_MINUS, OLD_UNARY_PLUS, NOT, OLD_BIT_NOT
 };
 
+/*
+ * ExprNode --
+ *
+ *      Describes a node of a compiled expression.  Leaf nodes are numbers
+ *      and vectors.  Operator and point function nodes are computed a
+ *      block at a time into their slot in the expression's scratch arena.
+ *      Other math functions and the shift operators need the entire
+ *      operand, so they are computed before the block evaluation starts.
+ */
+typedef enum {
+    NODE_CONSTANT,                      /* Number. */
+    NODE_VECTOR,                        /* Vector or range of a vector. */
+    NODE_UNARY,                         /* Unary minus or not. */
+    NODE_BINARY,                        /* Binary operator. */
+    NODE_POINTFUNC,                     /* Math function applied to each
+                                         * point, such as sin or sqrt. */
+    NODE_FUNCTION                       /* Any other math function. */
+} NodeType;
+
+typedef struct _ExprNode ExprNode;
+
+struct _ExprNode {
+    NodeType type;
+    enum Tokens op;                     /* Operator of unary and binary
+                                         * nodes. */
+    ExprNode *leftPtr, *rightPtr;       /* Operands.  Unary and function
+                                         * nodes only have a left
+                                         * operand. */
+    char *name;                         /* Vector name and optional range
+                                         * of a vector node. The vector is
+                                         * looked up each time the
+                                         * expression is evaluated. */
+    MathFunction *mathPtr;              /* Math function of function
+                                         * nodes. */
+    int slot;                           /* Index of the node's block in
+                                         * the scratch arena or -1. */
+
+    /* 
+     * The fields below are valid only while the expression is being
+     * evaluated.
+     */
+    long length;                        /* # of points in the node's
+                                         * value.  A length of 1 means the
+                                         * value is a scalar, stored in
+                                         * the "scalar" field. */
+    long offset;                        /* Index offset of the value. */
+    double scalar;                      /* Value of constants and scalar
+                                         * nodes. */
+    double *values;                     /* If non-NULL, points to the
+                                         * already computed values of the
+                                         * node. */
+    double *scratch;                    /* Block of the scratch arena where
+                                         * the node's values are computed. */
+    int mode;                           /* Indicates which operand of a
+                                         * binary node is a scalar. See
+                                         * below. */
+    Vector *tmpPtr;                     /* Temporary vector holding the
+                                         * result of a math function or
+                                         * shift. */
+};
+
+#define OPERANDS_VV     0               /* Both operands are vectors. */
+#define OPERANDS_VS     1               /* Second operand is a scalar. */
+#define OPERANDS_SV     2               /* First operand is a scalar. */
+
+/*
+ * VecExpr --
+ *
+ *      A compiled vector expression.  Expressions without variable or
+ *      command substitutions are cached in the internal representation
+ *      of the expression's Tcl_Obj, so they are parsed only once.
+ */
 typedef struct {
-    Vector *vPtr;
-    char staticSpace[STATIC_STRING_SPACE];
-    ParseValue pv;              /* Used to hold a string value, if any. */
-} Value;
+    ExprNode *rootPtr;                  /* Root of the expression tree. */
+    double *arena;                      /* Scratch space for the blocks of
+                                         * the operator nodes. Allocated
+                                         * when first evaluated and reused
+                                         * thereafter. */
+    int numSlots;                       /* # of blocks in the arena. */
+    int refCount;                       /* # of references to the
+                                         * expression.  Freed when zero. */
+    unsigned int flags;
+    VectorCmdInterpData *dataPtr;       /* Interpreter-specific data of the
+                                         * interpreter the expression was
+                                         * compiled in. */
+} VecExpr;
+
+#define EXPR_VOLATILE   (1<<0)          /* Expression contains variable or
+                                         * command substitutions and can't
+                                         * be cached. */
 
 /*
  * ParseInfo --
@@ -173,6 +265,11 @@ typedef struct {
                                  * definitions.  Corresponds to the
                                  * characters just before nextPtr. */
 
+    VectorCmdInterpData *dataPtr;
+    VecExpr *exprPtr;           /* Expression being compiled. */
+    ParseValue pv;              /* Holds the string result of command
+                                 * and variable substitutions. */
+    char staticSpace[STATIC_STRING_SPACE];
 } ParseInfo;
 
 /*
@@ -197,16 +294,52 @@ static int precTable[] =
                                  * OLD_BIT_NOT */
 };
 
+/*
+ * vecExprObjType --
+ *
+ *      Caches a compiled vector expression in a Tcl_Obj.  The string
+ *      representation is always valid.
+ */
+static Tcl_DupInternalRepProc DupExprInternalRep;
+static Tcl_FreeInternalRepProc FreeExprInternalRep;
+
+static Tcl_ObjType vecExprObjType = {
+    (char *)"blt_vecexpr",
+    FreeExprInternalRep,                /* Called when an object is
+                                         * freed. */
+    DupExprInternalRep,                 /* Copies an internal
+                                         * representation from one object
+                                         * to another. */
+    NULL,                               /* The string representation is
+                                         * never invalidated. */
+    NULL,                               /* Expressions are only compiled
+                                         * through Blt_Vec_ExprObj. */
+};
 
 /*
  * Forward declarations.
  */
 
 static int NextValue(Tcl_Interp *interp, ParseInfo *piPtr, int prec, 
-        Value *valuePtr);
+        ExprNode **nodePtrPtr);
+static int PrepareNode(Tcl_Interp *interp, VecExpr *exprPtr, ExprNode *np);
+static int PointFunc(ClientData clientData, Tcl_Interp *interp, 
+        Vector *vPtr);
+static int ScalarFunc(ClientData clientData, Tcl_Interp *interp, 
+        Vector *vPtr);
 
 #include <bltMath.h>
 
+/*
+ * IS_FINITE tests for a finite value without calling a library routine,
+ * so that the element loops below can be vectorized.
+ */
+#ifdef DBL_MAX
+  #define IS_FINITE(v) (fabs(v) <= DBL_MAX)
+#else
+  #define IS_FINITE(v) FINITE(v)
+#endif
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -285,232 +418,85 @@ Product(Blt_Vector *vectorPtr)
 }
 
 static double
-GetSum(Blt_Vector *vectorPtr, long *nonEmptyPtr)
+Sum(Blt_Vector *vectorPtr)
 {
     Vector *vPtr = (Vector *)vectorPtr;
-    double sum;
-    long i, count;
+    double sum, min, max;
 
-    /* Kahan summation algorithm */
-
-    for (i = 0; i < vPtr->length; i++) {
-        if (FINITE(vPtr->valueArr[i])) {
-            break;
-        }
-    }
-    sum = 0.0;
-    count = 0;
-    if (i < vPtr->length) {
-        double c;
-        c = 0.0;                        /* A running compensation for lost
-                                         * low-order bits.*/
-        count = 1;
-        for (/*empty*/; i < vPtr->length; i++) {
-            double y, t;
-            
-            if (!FINITE(vPtr->valueArr[i])) {
-                continue;
-            }
-            count++;
-            y = vPtr->valueArr[i] - c;  /* So far, so good: c is zero.*/
-            t = sum + y;                /* Alas, sum is big, y small, so
-                                         * low-order digits of y are lost.*/
-            c = (t - sum) - y;          /* (t - sum) recovers the high-order
-                                         * part of y; subtracting y recovers
-                                         * -(low part of y) */
-            sum = t;
-        }
-    }
-    *nonEmptyPtr = count;
+    Blt_Vec_Sums(vPtr->valueArr, vPtr->length, &sum, &min, &max);
     return sum;
 }
 
-static double
-Sum(Blt_Vector *vectorPtr)
-{
-    long count;
-
-    return GetSum(vectorPtr, &count);
-}
-
 static double
 Mean(Blt_Vector *vectorPtr)
 {
-    double sum;
-    long n;
+    VectorStats stats;
 
-    sum = GetSum(vectorPtr, &n);
-    if (n == 0) {
-        return Blt_NaN();
-    }
-    return sum / (double)n;
+    Blt_Vec_GetStats((Vector *)vectorPtr, 0, &stats);
+    return stats.mean;
 }
 
 /*
- *  var = 1/N Sum( (x[i] - mean)^2 )
+ *  var = 1/(N-1) Sum( (x[i] - mean)^2 )
  */
 static double
 Variance(Blt_Vector *vectorPtr)
 {
-    Vector *vPtr = (Vector *)vectorPtr;
-    double var, mean;
-    long i, count;
-
-    mean = Mean(vectorPtr);
-    var = 0.0;
-    count = 0;
-    for(i = 0; i < vPtr->length; i++) {
-        double dx;
+    VectorStats stats;
 
-        if (!FINITE(vPtr->valueArr[i])) {
-            continue;
-        }
-        dx = vPtr->valueArr[i] - mean;
-        var += dx * dx;
-        count++;
-    }
-    if (count < 2) {
-        return 0.0;
-    }
-    var /= (double)(count - 1);
-    return var;
+    Blt_Vec_GetStats((Vector *)vectorPtr, STATS_MOMENTS, &stats);
+    return stats.var;
 }
 
 /*
- *  skew = Sum( (x[i] - mean)^3 ) / (var^3/2)
+ *  skew = Sum( |x[i] - mean|^3 ) / (N var^3/2)
  */
 static double
 Skew(Blt_Vector *vectorPtr)
 {
-    Vector *vPtr = (Vector *)vectorPtr;
-    double var, skew, mean;
-    long i, count;
+    VectorStats stats;
 
-    mean = Mean(vectorPtr);
-    var = skew = 0.0;
-    count = 0;
-    for(i = 0; i < vPtr->length; i++) {
-        double dx, dx2;
-
-        if (!FINITE(vPtr->valueArr[i])) {
-            continue;
-        }
-        dx = vPtr->valueArr[i] - mean;
-        dx = FABS(dx);
-        dx2 = dx * dx;
-        var += dx2;
-        skew += dx2 * dx;
-        count++;
-    }
-    if (count < 2) {
-        return 0.0;
-    }
-    var /= (double)(count - 1);
-    skew /= count * var * sqrt(var);
-    return skew;
+    Blt_Vec_GetStats((Vector *)vectorPtr, STATS_MOMENTS, &stats);
+    return stats.skew;
 }
 
 static double
 StdDeviation(Blt_Vector *vectorPtr)
 {
-    double var;
+    VectorStats stats;
 
-    var = Variance(vectorPtr);
-    if (var > 0.0) {
-        return sqrt(var);
-    }
-    return 0.0;
+    Blt_Vec_GetStats((Vector *)vectorPtr, STATS_MOMENTS, &stats);
+    return stats.sdev;
 }
 
-
 static double
 AvgDeviation(Blt_Vector *vectorPtr)
 {
-    Vector *vPtr = (Vector *)vectorPtr;
-    double sum, mean;
-    long i, count;
-
-    mean = Mean(vectorPtr);
-    sum = 0.0;
-    count = 0;
-    for(i = 0; i < vPtr->length; i++) {
-        double dx;
+    VectorStats stats;
 
-        if (!FINITE(vPtr->valueArr[i])) {
-            continue;
-        }
-        dx = vPtr->valueArr[i] - mean;
-        sum += FABS(dx);
-        count++;
-    }
-    if (count < 2) {
-        return 0.0;
-    }
-    return sum / (double)count;
+    Blt_Vec_GetStats((Vector *)vectorPtr, STATS_MOMENTS, &stats);
+    return stats.adev;
 }
 
-
 static double
 Kurtosis(Blt_Vector *vectorPtr)
 {
-    Vector *vPtr = (Vector *)vectorPtr;
-    double kurt, var, mean;
-    long i, count;
-
-    mean = Mean(vectorPtr);
-    var = kurt = 0.0;
-    count = 0;
-    for(i = 0; i < vPtr->length; i++) {
-        double diff, diffsq;
+    VectorStats stats;
 
-        if (!FINITE(vPtr->valueArr[i])) {
-            continue;
-        }
-        diff = vPtr->valueArr[i] - mean;
-        diffsq = diff * diff;
-        var += diffsq;
-        kurt += diffsq * diffsq;
-        count++;
-    }
-    if (count < 2) {
-        return 0.0;
-    }
-    var /= (double)(count - 1);
-    if (var == 0.0) {
-        return 0.0;
-    }
-    kurt /= (count * var * var);
-    return kurt - 3.0;                  /* Fisher Kurtosis */
+    Blt_Vec_GetStats((Vector *)vectorPtr, STATS_MOMENTS, &stats);
+    return stats.kurtosis;
 }
 
-
 static double
 Median(Blt_Vector *vectorPtr)
 {
     Vector *vPtr = (Vector *)vectorPtr;
     double q2;
-    long mid;
-    long *map;
-    long sortLength;
-    
+
     if (vPtr->length == 0) {
         return -DBL_MAX;
     }
-    sortLength = Blt_Vec_NonemptySortMap(vPtr, &map);
-    mid = (sortLength - 1) / 2;
-
-    /*  
-     * Determine Q2 by checking if the number of elements [0..n-1] is odd
-     * or even.  If even, we must take the average of the two middle
-     * values.
-     */
-    if (sortLength & 1) { /* Odd */
-        q2 = vPtr->valueArr[map[mid]];
-    } else {                    /* Even */
-        q2 = (vPtr->valueArr[map[mid]] + 
-              vPtr->valueArr[map[mid + 1]]) * 0.5;
-    }
-    Blt_Free(map);
+    Blt_Vec_Quartiles(vPtr->valueArr, vPtr->length, NULL, &q2, NULL);
     return q2;
 }
 
@@ -519,34 +505,11 @@ Q1(Blt_Vector *vectorPtr)
 {
     Vector *vPtr = (Vector *)vectorPtr;
     double q1;
-    long *map;
-    long sortLength;
 
     if (vPtr->length == 0) {
         return -DBL_MAX;
     } 
-    sortLength = Blt_Vec_NonemptySortMap(vPtr, &map);
-    if (sortLength < 4) {
-        q1 = vPtr->valueArr[map[0]];
-    } else {
-        long mid, q;
-
-        mid = (sortLength - 1) / 2;
-        q = mid / 2;
-
-        /* 
-         * Determine Q1 by checking if the number of elements in the
-         * bottom half [0..mid) is odd or even.   If even, we must
-         * take the average of the two middle values.
-         */
-        if (mid & 1) {          /* Odd */
-            q1 = vPtr->valueArr[map[q]]; 
-        } else {                /* Even */
-            q1 = (vPtr->valueArr[map[q]] + 
-                  vPtr->valueArr[map[q + 1]]) * 0.5; 
-        }
-    }
-    Blt_Free(map);
+    Blt_Vec_Quartiles(vPtr->valueArr, vPtr->length, &q1, NULL, NULL);
     return q1;
 }
 
@@ -555,34 +518,11 @@ Q3(Blt_Vector *vectorPtr)
 {
     Vector *vPtr = (Vector *)vectorPtr;
     double q3;
-    long *map;
-    long sortLength;
 
     if (vPtr->length == 0) {
         return -DBL_MAX;
     } 
-    sortLength = Blt_Vec_NonemptySortMap(vPtr, &map);
-    if (sortLength < 4) {
-        q3 = vPtr->valueArr[map[sortLength - 1]];
-    } else {
-        long mid, q;
-
-        mid = (sortLength - 1) / 2;
-        q = (sortLength + mid) / 2;
-
-        /* 
-         * Determine Q3 by checking if the number of elements in the
-         * upper half (mid..n-1] is odd or even.   If even, we must
-         * take the average of the two middle values.
-         */
-        if (mid & 1) {          /* Odd */
-            q3 = vPtr->valueArr[map[q]];
-        } else {                /* Even */
-            q3 = (vPtr->valueArr[map[q]] + 
-                  vPtr->valueArr[map[q + 1]]) * 0.5; 
-        }
-    }
-    Blt_Free(map);
+    Blt_Vec_Quartiles(vPtr->valueArr, vPtr->length, NULL, NULL, &q3);
     return q3;
 }
 
@@ -591,21 +531,10 @@ static int
 Norm(Blt_Vector *vector)
 {
     Vector *vPtr = (Vector *)vector;
-    double min, max;
-    long i;
+    double sum, min, max;
 
-    min = DBL_MAX;
-    max = -DBL_MAX;
-    for (i = 0; i < vPtr->length; i++) {
-        if (!FINITE(vPtr->valueArr[i])) {
-            continue;
-        }
-        if (min > vPtr->valueArr[i]) {
-            min = vPtr->valueArr[i];
-        }
-        if (max < vPtr->valueArr[i]) {
-            max = vPtr->valueArr[i];
-        }
+    if (Blt_Vec_Sums(vPtr->valueArr, vPtr->length, &sum, &min, &max) == 0) {
+        return TCL_OK;
     }
     if (min < max) {
         double range;
@@ -628,15 +557,10 @@ static double
 Count(Blt_Vector *vector)
 {
     Vector *vPtr = (Vector *)vector;
-    long i, count;
+    double sum, min, max;
 
-    count = 0;
-    for (i = 0; i < vPtr->length; i++) {
-        if (FINITE(vPtr->valueArr[i])) {
-            count++;
-        }
-    }
-    return (double)count;
+    return (double)Blt_Vec_Sums(vPtr->valueArr, vPtr->length, &sum, &min,
+                                &max);
 }
 
 
@@ -808,35 +732,133 @@ MathConvertError(
 }
 
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * NewNode --
+ *
+ *      Allocates a new node for the expression being compiled.  Operator
+ *      and point function nodes are assigned a block in the scratch arena.
+ *
+ * Results:
+ *      Returns a pointer to the new node.
+ *
+ *---------------------------------------------------------------------------
+ */
+static ExprNode *
+NewNode(ParseInfo *piPtr, NodeType type, enum Tokens op)
+{
+    ExprNode *np;
+
+    np = Blt_AssertCalloc(1, sizeof(ExprNode));
+    np->type = type;
+    np->op = op;
+    np->slot = -1;
+    switch (type) {
+    case NODE_BINARY:
+        if ((op == LEFT_SHIFT) || (op == RIGHT_SHIFT)) {
+            break;                      /* Shifts need the whole operand. */
+        }
+        /*FALLTHRU*/
+    case NODE_UNARY:
+    case NODE_POINTFUNC:
+        np->slot = piPtr->exprPtr->numSlots++;
+        break;
+    default:
+        break;
+    }
+    return np;
+}
+
+static void
+FreeNode(ExprNode *np)
+{
+    if (np == NULL) {
+        return;
+    }
+    FreeNode(np->leftPtr);
+    FreeNode(np->rightPtr);
+    if (np->tmpPtr != NULL) {
+        Blt_Vec_Free(np->tmpPtr);
+    }
+    if (np->name != NULL) {
+        Blt_Free(np->name);
+    }
+    Blt_Free(np);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ParseVector --
+ *
+ *      Parses a vector name, including an optional index or range, and
+ *      creates a vector node for it.  The vector must already exist.
+ *
+ * Results:
+ *      A standard TCL result.  The new node is returned in *nodePtrPtr
+ *      and *endPtrPtr points to the character after the vector name.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ParseVector(
+    Tcl_Interp *interp,                 /* Where to store error message. */
+    ParseInfo *piPtr,
+    const char *string,                 /* Start of the vector name. */
+    const char **endPtrPtr,
+    ExprNode **nodePtrPtr)
+{
+    ExprNode *np;
+    Vector *vPtr;
+    const char *endPtr;
+    size_t numBytes;
+
+    while (isspace(UCHAR(*string))) {
+        string++;                       /* Skip spaces leading the vector
+                                         * name. */
+    }
+    vPtr = Blt_Vec_ParseElement(interp, piPtr->dataPtr, string, &endPtr,
+        NS_SEARCH_BOTH);
+    if (vPtr == NULL) {
+        return TCL_ERROR;
+    }
+    np = NewNode(piPtr, NODE_VECTOR, VALUE);
+    numBytes = endPtr - string;
+    np->name = Blt_AssertMalloc(numBytes + 1);
+    memcpy(np->name, string, numBytes);
+    np->name[numBytes] = '\0';
+    *endPtrPtr = endPtr;
+    *nodePtrPtr = np;
+    return TCL_OK;
+}
+
 /*
  *---------------------------------------------------------------------------
  *
  * ParseString --
  *
  *      Given a string (such as one coming from command or variable
- *      substitution), make a Value based on the string.  The value will be
- *      a floating-point or integer, if possible, or else it will just be a
- *      copy of the string.
+ *      substitution), make a node based on the string.  The node will be
+ *      a floating-point constant, if possible, or else a vector.
  *
  * Results:
  *      TCL_OK is returned under normal circumstances, and TCL_ERROR is
  *      returned if a floating-point overflow or underflow occurred while
- *      reading in a number.  The value at *valuePtr is modified to hold a
- *      number, if possible.
+ *      reading in a number or the string isn't a vector.  The new node
+ *      is returned in *nodePtrPtr.
  *
  * Side effects:
  *      None.
  *
  *---------------------------------------------------------------------------
  */
-
 static int
 ParseString(
     Tcl_Interp *interp,                 /* Where to store error message. */
+    ParseInfo *piPtr,
     const char *string,                 /* String to turn into value. */
-    Value *valuePtr)                    /* Where to store value
-                                         * information.  Caller must have
-                                         * initialized pv field. */
+    ExprNode **nodePtrPtr)              /* Where to store the node. */
 {
     const char *endPtr;
     double value;
@@ -851,35 +873,29 @@ ParseString(
 
     value = strtod(string, (char **)&endPtr);
     if ((endPtr != string) && (*endPtr == '\0')) {
+        ExprNode *np;
+
         if (errno != 0) {
             Tcl_ResetResult(interp);
             MathConvertError(interp, string, value);
             return TCL_ERROR;
         }
-        /* Numbers are stored as single element vectors. */
-        if (Blt_Vec_ChangeLength(interp, valuePtr->vPtr, 1) != TCL_OK) {
-            return TCL_ERROR;
-        }
-        valuePtr->vPtr->valueArr[0] = value;
-        return TCL_OK;
+        /* Numbers are stored as constants. */
+        np = NewNode(piPtr, NODE_CONSTANT, VALUE);
+        np->scalar = value;
+        *nodePtrPtr = np;
     } else {
-        Vector *vPtr;
-
-        while (isspace(UCHAR(*string))) {
-            string++;           /* Skip spaces leading the vector name. */    
-        }
-        vPtr = Blt_Vec_ParseElement(interp, valuePtr->vPtr->dataPtr, 
-                string, &endPtr, NS_SEARCH_BOTH);
-        if (vPtr == NULL) {
+        if (ParseVector(interp, piPtr, string, &endPtr, nodePtrPtr) 
+            != TCL_OK) {
             return TCL_ERROR;
         }
         if (*endPtr != '\0') {
+            FreeNode(*nodePtrPtr);
+            *nodePtrPtr = NULL;
             Tcl_AppendResult(interp, "extra characters after vector", 
                              (char *)NULL);
             return TCL_ERROR;
         }
-        /* Copy the designated vector to our temporary. */
-        Blt_Vec_Duplicate(valuePtr->vPtr, vPtr);
     }
     return TCL_OK;
 }
@@ -890,19 +906,17 @@ ParseString(
  * ParseMathFunction --
  *
  *      This procedure is invoked to parse a math function from an
- *      expression string, carry out the function, and return the value
- *      computed.
+ *      expression string.
  *
  * Results:
- *      TCL_OK is returned if all went well and the function's value was
- *      computed successfully.  If the name doesn't match any known math
- *      function, returns TCL_RETURN. And if a format error was found,
- *      TCL_ERROR is returned and an error message is left in
- *      interp->result.
+ *      TCL_OK is returned if all went well and the function was parsed
+ *      successfully.  If the name doesn't match any known math function,
+ *      returns TCL_RETURN. And if a format error was found, TCL_ERROR is
+ *      returned and an error message is left in interp->result.
  *
  *      After a successful return piPtr will be updated to point to the
  *      character just after the function call, the token is set to VALUE,
- *      and the value is stored in valuePtr.
+ *      and the function's node is stored in *nodePtrPtr.
  *
  * Side effects:
  *      Embedded commands could have arbitrary side-effects.
@@ -918,16 +932,13 @@ ParseMathFunction(
                                          * parse.  piPtr->nextPtr must
                                          * point to the first character of
                                          * the function's name. */
-    Value *valuePtr)                    /* Where to store value, if that is
-                                         * what's parsed from string.
-                                         * Caller must have initialized pv
-                                         * field correctly. */
+    ExprNode **nodePtrPtr)              /* Where to store the function's
+                                         * node. */
 {
     Blt_HashEntry *hPtr;
     MathFunction *mathPtr;              /* Info about math function. */
     char *p;
-    VectorCmdInterpData *dataPtr;          /* Interpreter-specific data. */
-    GenericMathProc *proc;
+    ExprNode *np, *argPtr;
 
     /*
      * Find the end of the math function's name and lookup the record for
@@ -945,9 +956,8 @@ ParseMathFunction(
         return TCL_RETURN;              /* Must start with open
                                          * parenthesis */
     }
-    dataPtr = valuePtr->vPtr->dataPtr;
     *p = '\0';
-    hPtr = Blt_FindHashEntry(&dataPtr->mathProcTable, piPtr->nextPtr);
+    hPtr = Blt_FindHashEntry(&piPtr->dataPtr->mathProcTable, piPtr->nextPtr);
     *p = '(';
     if (hPtr == NULL) {
         return TCL_RETURN;              /* Name doesn't match any known
@@ -956,20 +966,22 @@ ParseMathFunction(
     /* Pick up the single value as the argument to the function */
     piPtr->token = OPEN_PAREN;
     piPtr->nextPtr = p + 1;
-    valuePtr->pv.next = valuePtr->pv.buffer;
-    if (NextValue(interp, piPtr, -1, valuePtr) != TCL_OK) {
+    argPtr = NULL;
+    if (NextValue(interp, piPtr, -1, &argPtr) != TCL_OK) {
         return TCL_ERROR;               /* Parse error */
     }
     if (piPtr->token != CLOSE_PAREN) {
+        FreeNode(argPtr);
         Tcl_AppendResult(interp, "unmatched parentheses in expression \"",
             piPtr->expr, "\"", (char *)NULL);
         return TCL_ERROR;               /* Missing right parenthesis */
     }
     mathPtr = Blt_GetHashValue(hPtr);
-    proc = mathPtr->proc;
-    if ((*proc) (mathPtr->clientData, interp, valuePtr->vPtr) != TCL_OK) {
-        return TCL_ERROR;               /* Function invocation error */
-    }
+    np = NewNode(piPtr, (mathPtr->proc == (void *)PointFunc) ? 
+                 NODE_POINTFUNC : NODE_FUNCTION, VALUE);
+    np->mathPtr = mathPtr;
+    np->leftPtr = argPtr;
+    *nodePtrPtr = np;
     piPtr->token = VALUE;
     return TCL_OK;
 }
@@ -989,10 +1001,12 @@ ParseMathFunction(
  *      message.  In the event of a successful return, the token and field
  *      in piPtr is updated to refer to the next symbol in the expression
  *      string, and the expr field is advanced past that token; if the
- *      token is a value, then the value is stored at valuePtr.
+ *      token is a value, then the value's node is stored at *nodePtrPtr.
  *
  * Side effects:
- *      None.
+ *      Variable and command substitutions are performed while the
+ *      expression is compiled.  Expressions containing them are marked
+ *      as volatile and aren't cached.
  *
  *---------------------------------------------------------------------------
  */
@@ -1002,10 +1016,8 @@ NextToken(
                                          * reporting. */
     ParseInfo *piPtr,                   /* Describes the state of the
                                          * parser. */
-    Value *valuePtr)                    /* Where to store value, if that is
-                                         * what's parsed from string.
-                                         * Caller must have initialized pv
-                                         * field correctly. */
+    ExprNode **nodePtrPtr)              /* Where to store the node, if the
+                                         * token is a value. */
 {
     const char *p;
     const char *endPtr;
@@ -1034,6 +1046,8 @@ NextToken(
         errno = 0;
         value = strtod(p, (char **)&endPtr);
         if (endPtr != p) {
+            ExprNode *np;
+
             if (errno != 0) {
                 MathConvertError(interp, p, value);
                 return TCL_ERROR;
@@ -1041,60 +1055,60 @@ NextToken(
             piPtr->token = VALUE;
             piPtr->nextPtr = endPtr;
 
-            /*
-             * Save the single floating-point value as an 1-point vector.
-             */
-            if (Blt_Vec_ChangeLength(interp, valuePtr->vPtr, 1) != TCL_OK) {
-                return TCL_ERROR;
-            }
-            valuePtr->vPtr->valueArr[0] = value;
+            np = NewNode(piPtr, NODE_CONSTANT, VALUE);
+            np->scalar = value;
+            *nodePtrPtr = np;
             return TCL_OK;
         }
     }
     piPtr->nextPtr = p + 1;
+    piPtr->pv.next = piPtr->pv.buffer;
     switch (*p) {
     case '$':
         piPtr->token = VALUE;
+        piPtr->exprPtr->flags |= EXPR_VOLATILE;
         var = Tcl_ParseVar(interp, p, &endPtr);
         if (var == NULL) {
             return TCL_ERROR;
         }
         piPtr->nextPtr = endPtr;
         Tcl_ResetResult(interp);
-        result = ParseString(interp, var, valuePtr);
+        result = ParseString(interp, piPtr, var, nodePtrPtr);
         return result;
 
     case '[':
         piPtr->token = VALUE;
-        result = Blt_ParseNestedCmd(interp, p + 1, 0, &endPtr, &valuePtr->pv);
+        piPtr->exprPtr->flags |= EXPR_VOLATILE;
+        result = Blt_ParseNestedCmd(interp, p + 1, 0, &endPtr, &piPtr->pv);
         if (result != TCL_OK) {
             return result;
         }
         piPtr->nextPtr = endPtr;
         Tcl_ResetResult(interp);
-        result = ParseString(interp, valuePtr->pv.buffer, valuePtr);
+        result = ParseString(interp, piPtr, piPtr->pv.buffer, nodePtrPtr);
         return result;
 
     case '"':
         piPtr->token = VALUE;
-        result = Blt_ParseQuotes(interp, p + 1, '"', 0, &endPtr, &valuePtr->pv);
+        piPtr->exprPtr->flags |= EXPR_VOLATILE;
+        result = Blt_ParseQuotes(interp, p + 1, '"', 0, &endPtr, &piPtr->pv);
         if (result != TCL_OK) {
             return result;
         }
         piPtr->nextPtr = endPtr;
         Tcl_ResetResult(interp);
-        result = ParseString(interp, valuePtr->pv.buffer, valuePtr);
+        result = ParseString(interp, piPtr, piPtr->pv.buffer, nodePtrPtr);
         return result;
 
     case '{':
         piPtr->token = VALUE;
-        result = Blt_ParseBraces(interp, p + 1, &endPtr, &valuePtr->pv);
+        result = Blt_ParseBraces(interp, p + 1, &endPtr, &piPtr->pv);
         if (result != TCL_OK) {
             return result;
         }
         piPtr->nextPtr = endPtr;
         Tcl_ResetResult(interp);
-        result = ParseString(interp, valuePtr->pv.buffer, valuePtr);
+        result = ParseString(interp, piPtr, piPtr->pv.buffer, nodePtrPtr);
         return result;
 
     case '(':
@@ -1203,23 +1217,14 @@ NextToken(
 
     default:
         piPtr->token = VALUE;
-        result = ParseMathFunction(interp, p, piPtr, valuePtr);
+        result = ParseMathFunction(interp, p, piPtr, nodePtrPtr);
         if ((result == TCL_OK) || (result == TCL_ERROR)) {
             return result;
-        } else {
-            Vector *vPtr;
-
-            while (isspace(UCHAR(*p))) {
-                p++;            /* Skip spaces leading the vector name. */    
-            }
-            vPtr = Blt_Vec_ParseElement(interp, valuePtr->vPtr->dataPtr, 
-                        p, &endPtr, NS_SEARCH_BOTH);
-            if (vPtr == NULL) {
-                return TCL_ERROR;
-            }
-            Blt_Vec_Duplicate(valuePtr->vPtr, vPtr);
-            piPtr->nextPtr = endPtr;
         }
+        if (ParseVector(interp, piPtr, p, &endPtr, nodePtrPtr) != TCL_OK) {
+            return TCL_ERROR;
+        }
+        piPtr->nextPtr = endPtr;
     }
     return TCL_OK;
 }
@@ -1232,12 +1237,12 @@ NextToken(
  *      Parse a "value" from the remainder of the expression in piPtr.
  *
  * Results:
- *      Normally TCL_OK is returned.  The value of the expression is
- *      returned in *valuePtr.  If an error occurred, then interp->result
- *      contains an error message and TCL_ERROR is returned.
- *      InfoPtr->token will be left pointing to the token AFTER the
- *      expression, and piPtr->nextPtr will point to the character just
- *      after the terminating token.
+ *      Normally TCL_OK is returned.  The tree of the parsed expression is
+ *      returned in *nodePtrPtr.  If an error occurred, then
+ *      interp->result contains an error message and TCL_ERROR is
+ *      returned.  InfoPtr->token will be left pointing to the token AFTER
+ *      the expression, and piPtr->nextPtr will point to the character
+ *      just after the terminating token.
  *
  * Side effects:
  *      None.
@@ -1252,130 +1257,97 @@ NextValue(
                                          * just before the value
                                          * (i.e. NextToken will be called to
                                          * get first token of value). */
-    int prec,                           /* Treat any un-parenthesized operator
-                                         * with precedence <= this as the end
-                                         * of the expression. */
-    Value *valuePtr)                    /* Where to store the value of the
-                                         * expression.  Caller must have
-                                         * initialized * pv field. */
+    int prec,                           /* Treat any un-parenthesized
+                                         * operator with precedence <=
+                                         * this as the end of the
+                                         * expression. */
+    ExprNode **nodePtrPtr)              /* Where to store the parsed
+                                         * expression. */
 {
-    Value value2;                       /* Second operand for current
-                                         * operator.  */
+    ExprNode *np, *rightPtr;
     int operator;                       /* Current operator (either unary or
                                          * binary). */
     int gotOp;                          /* Non-zero means already lexed the
                                          * operator (while picking up value
                                          * for unary operator).  Don't lex
                                          * again. */
-    int result;
-    Vector *vPtr, *v2Ptr;
-    long i;
-    double *values;
 
     /*
      * There are two phases to this procedure.  First, pick off an initial
      * value.  Then, parse (binary operator, value) pairs until done.
      */
-
-    vPtr = valuePtr->vPtr;
-    v2Ptr = Blt_Vec_New(vPtr->dataPtr);
+    np = rightPtr = NULL;
     gotOp = FALSE;
-    value2.vPtr = v2Ptr;
-    value2.pv.buffer = value2.pv.next = value2.staticSpace;
-    value2.pv.end = value2.pv.buffer + STATIC_STRING_SPACE - 1;
-    value2.pv.expandProc = Blt_ExpandParseValue;
-    value2.pv.clientData = NULL;
-
-    values = NULL;
-    result = NextToken(interp, piPtr, valuePtr);
-    if (result != TCL_OK) {
-        goto done;
+    if (NextToken(interp, piPtr, &np) != TCL_OK) {
+        goto error;
     }
     if (piPtr->token == OPEN_PAREN) {
 
         /* Parenthesized sub-expression. */
 
-        result = NextValue(interp, piPtr, -1, valuePtr);
-        if (result != TCL_OK) {
-            goto done;
+        if (NextValue(interp, piPtr, -1, &np) != TCL_OK) {
+            goto error;
         }
         if (piPtr->token != CLOSE_PAREN) {
             Tcl_AppendResult(interp, "unmatched parentheses in expression \"",
                 piPtr->expr, "\"", (char *)NULL);
-            result = TCL_ERROR;
-            goto done;
+            goto error;
         }
     } else {
         if (piPtr->token == MINUS) {
             piPtr->token = UNARY_MINUS;
         }
         if (piPtr->token >= UNARY_MINUS) {
+            ExprNode *argPtr;
+
             operator = piPtr->token;
-            result = NextValue(interp, piPtr, precTable[operator], valuePtr);
-            if (result != TCL_OK) {
-                goto done;
+            argPtr = NULL;
+            if (NextValue(interp, piPtr, precTable[operator], &argPtr) 
+                != TCL_OK) {
+                goto error;
             }
             gotOp = TRUE;
-            /* Process unary operators. */
-            switch (operator) {
-            case UNARY_MINUS:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(vPtr->valueArr[i])) {
-                        continue;
-                    }
-                    vPtr->valueArr[i] = -(vPtr->valueArr[i]);
-                }
-                break;
-
-            case NOT:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(vPtr->valueArr[i])) {
-                        continue;
-                    }
-                    vPtr->valueArr[i] = (double)(!vPtr->valueArr[i]);
-                }
-                break;
-            default:
+            if ((operator != UNARY_MINUS) && (operator != NOT)) {
+                FreeNode(argPtr);
                 Tcl_AppendResult(interp, "unknown operator", (char *)NULL);
                 goto error;
             }
+            np = NewNode(piPtr, NODE_UNARY, operator);
+            np->leftPtr = argPtr;
         } else if (piPtr->token != VALUE) {
             Tcl_AppendResult(interp, "missing operand", (char *)NULL);
             goto error;
         }
     }
     if (!gotOp) {
-        result = NextToken(interp, piPtr, &value2);
-        if (result != TCL_OK) {
-            goto done;
+        if (NextToken(interp, piPtr, &rightPtr) != TCL_OK) {
+            goto error;
         }
     }
     /*
      * Got the first operand.  Now fetch (operator, operand) pairs.
      */
     for (;;) {
-        operator = piPtr->token;
-        int length;
+        ExprNode *opPtr;
 
-        values = NULL;
-        value2.pv.next = value2.pv.buffer;
+        operator = piPtr->token;
+        FreeNode(rightPtr);             /* Discard a value where an
+                                         * operator was expected. */
+        rightPtr = NULL;
         if ((operator < MULT) || (operator >= UNARY_MINUS)) {
             if ((operator == END) || (operator == CLOSE_PAREN) || 
                 (operator == COMMA)) {
-                result = TCL_OK;
-                goto done;
-            } else {
-                Tcl_AppendResult(interp, "bad operator", (char *)NULL);
-                goto error;
+                break;
             }
+            Tcl_AppendResult(interp, "bad operator", (char *)NULL);
+            goto error;
         }
         if (precTable[operator] <= prec) {
-            result = TCL_OK;
-            goto done;
+            break;
         }
-        result = NextValue(interp, piPtr, precTable[operator], &value2);
-        if (result != TCL_OK) {
-            goto done;
+        if (NextValue(interp, piPtr, precTable[operator], &rightPtr) 
+            != TCL_OK) {
+            goto error;
         }
         if ((piPtr->token < MULT) && (piPtr->token != VALUE) &&
             (piPtr->token != END) && (piPtr->token != CLOSE_PAREN) &&
@@ -1384,663 +1356,837 @@ NextValue(
                 (char *)NULL);
             goto error;
         }
-        /*
-         * At this point we have two vectors and an operator.
-         */
-        errno = 0;
-        if (v2Ptr->length == 1) {
-            double scalar;
-
-            /*
-             * 2nd operand is a scalar.
-             */
-            scalar = v2Ptr->valueArr[0];
-            length = vPtr->length;
-            values = Blt_AssertMalloc(sizeof(double) * vPtr->length);
-            memcpy(values, vPtr->valueArr, sizeof(double) * vPtr->length);
-            switch (operator) {
-            case MULT:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] *= scalar;
-                    if ((!FINITE(values[i])) || (errno != 0)) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
-
-            case DIVIDE:
-                if (scalar == 0.0) {
-                    Tcl_AppendResult(interp, "divide by zero", (char *)NULL);
-                    goto error;
-                }
-                for(i = 0; i < vPtr->length; i++) {
-                    if (FINITE(values[i])) {
-                        values[i] /= scalar;
-                        if ((!FINITE(values[i])) || (errno != 0)) {
-                            MathError(interp, values[i]);
-                            goto error;
-                        }
-                    }
-                }
-                break;
+        switch (operator) {
+        case OLD_BIT_AND:
+        case OLD_BIT_OR:
+        case OLD_QUESTY:
+        case OLD_COLON:
+            Tcl_AppendResult(interp, "unknown operator in expression",
+                (char *)NULL);
+            goto error;
+        default:
+            break;
+        }
+        opPtr = NewNode(piPtr, NODE_BINARY, operator);
+        opPtr->leftPtr = np;
+        opPtr->rightPtr = rightPtr;
+        np = opPtr;
+        rightPtr = NULL;
+    }
+    *nodePtrPtr = np;
+    return TCL_OK;
 
-            case PLUS:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] += scalar;
-                    if ((!FINITE(values[i])) || (errno != 0)) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+  error:
+    FreeNode(np);
+    FreeNode(rightPtr);
+    return TCL_ERROR;
+}
 
-            case MINUS:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] -= scalar;
-                    if ((!FINITE(values[i])) || (errno != 0)) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * CompileExpr --
+ *
+ *      Parses a vector expression into a tree of nodes.  Variable and
+ *      command substitutions are performed while the expression is
+ *      compiled, but vectors are looked up again each time the expression
+ *      is evaluated.
+ *
+ * Results:
+ *      Returns the compiled expression or NULL if the expression is
+ *      invalid.  In that case an error message is left in
+ *      interp->result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static VecExpr *
+CompileExpr(
+    Tcl_Interp *interp,
+    VectorCmdInterpData *dataPtr,
+    const char *string)                 /* Expression to compile. */
+{
+    ParseInfo info;
+    VecExpr *exprPtr;
+    ExprNode *rootPtr;
+    int result;
 
-            case EXPONENT:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = pow(values[i], scalar);
-                    if ((!FINITE(values[i])) || (errno != 0)) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    exprPtr = Blt_AssertCalloc(1, sizeof(VecExpr));
+    exprPtr->dataPtr = dataPtr;
+    exprPtr->refCount = 1;
 
-            case MOD:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = Fmod(values[i], scalar);
-                    if ((!FINITE(values[i])) || (errno != 0)) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    errno = 0;
+    info.expr = info.nextPtr = string;
+    info.dataPtr = dataPtr;
+    info.exprPtr = exprPtr;
+    info.pv.buffer = info.pv.next = info.staticSpace;
+    info.pv.end = info.pv.buffer + STATIC_STRING_SPACE - 1;
+    info.pv.expandProc = Blt_ExpandParseValue;
+    info.pv.clientData = NULL;
+
+    rootPtr = NULL;
+    result = NextValue(interp, &info, -1, &rootPtr);
+    if (info.pv.buffer != info.staticSpace) {
+        Blt_Free(info.pv.buffer);
+    }
+    if ((result == TCL_OK) && (info.token != END)) {
+        FreeNode(rootPtr);
+        Tcl_AppendResult(interp, ": syntax error in expression \"",
+            string, "\"", (char *)NULL);
+        result = TCL_ERROR;
+    }
+    if (result != TCL_OK) {
+        Blt_Free(exprPtr);
+        return NULL;
+    }
+    exprPtr->rootPtr = rootPtr;
+    return exprPtr;
+}
 
-            case LESS:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] < scalar);
-                }
-                break;
+static void
+ReleaseExpr(VecExpr *exprPtr)
+{
+    exprPtr->refCount--;
+    if (exprPtr->refCount <= 0) {
+        FreeNode(exprPtr->rootPtr);
+        if (exprPtr->arena != NULL) {
+            Blt_Free(exprPtr->arena);
+        }
+        Blt_Free(exprPtr);
+    }
+}
 
-            case GREATER:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] > scalar);
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * UnaryBlock --
+ *
+ *      Computes a block of points of a unary operator or point function
+ *      node.  Holes (non-finite points) in the operand are passed through
+ *      unchanged.
+ *
+ * Results:
+ *      A standard TCL result.  The points are stored in r.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+UnaryBlock(Tcl_Interp *interp, ExprNode *np, const double *a, double *r,
+           long n)
+{
+    long i;
 
-            case LEQ:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] <= scalar);
-                }
-                break;
+    if (np->type == NODE_POINTFUNC) {
+        PointProc1 *procPtr = (PointProc1 *)np->mathPtr->clientData;
 
-            case GEQ:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] >= scalar);
-                }
-                break;
+        errno = 0;
+        for (i = 0; i < n; i++) {
+            if (!IS_FINITE(a[i])) {
+                r[i] = a[i];            /* There is a hole in the vector. */
+                continue;
+            }
+            r[i] = (*procPtr)(a[i]);
+            if ((!IS_FINITE(r[i])) || (errno != 0)) {
+                MathError(interp, r[i]);
+                return TCL_ERROR;
+            }
+        }
+        return TCL_OK;
+    }
+    switch (np->op) {
+    case UNARY_MINUS:
+        for (i = 0; i < n; i++) {
+            double x = a[i];
 
-            case EQUAL:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] == scalar);
-                }
-                break;
+            r[i] = IS_FINITE(x) ? -x : x;
+        }
+        break;
 
-            case NEQ:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] != scalar);
-                }
-                break;
+    case NOT:
+        for (i = 0; i < n; i++) {
+            double x = a[i];
 
-            case AND:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] && scalar);
-                }
-                break;
+            r[i] = IS_FINITE(x) ? (double)(x == 0.0) : x;
+        }
+        break;
 
-            case OR:
-                for(i = 0; i < vPtr->length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] || scalar);
-                }
-                break;
+    default:
+        Tcl_AppendResult(interp, "unknown operator", (char *)NULL);
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
 
-            case LEFT_SHIFT:
-                {
-                    int offset;
-
-                    offset = (int)scalar % vPtr->length;
-                    if (offset > 0) {
-                        double *hold;
-                        int j;
-
-                        hold = Blt_AssertMalloc(sizeof(double) * offset);
-                        for (i = 0; i < offset; i++) {
-                            hold[i] = values[i];
-                        }
-                        for (i = offset, j = 0; i < vPtr->length; i++, j++) {
-                            values[j] = values[i];
-                        }
-                        for (i = 0, j = vPtr->length - offset;
-                             j < vPtr->length; i++, j++) {
-                            values[j] = hold[i];
-                        }
-                        Blt_Free(hold);
-                    }
-                }
-                break;
+/*
+ * BINARY_LOOP --
+ *
+ *      Element loop of a binary operator.  Holes (non-finite points) are
+ *      skipped: a hole in the first operand is passed through, as is the
+ *      vector operand when either operand is a hole and the other is a
+ *      scalar.  When both operands are vectors, the first operand is
+ *      passed through.  The result is computed unconditionally and then
+ *      selected, so that the compiler can vectorize the loop.
+ */
+#define BINARY_LOOP(expr) \
+    switch (np->mode) { \
+    case OPERANDS_VV: \
+        for (i = 0; i < n; i++) { \
+            double x = a[i], y = b[i], z = (expr); \
+            r[i] = (IS_FINITE(x) & IS_FINITE(y)) ? z : x; \
+        } \
+        break; \
+    case OPERANDS_VS: \
+        { \
+            double y = np->rightPtr->scalar; \
+            for (i = 0; i < n; i++) { \
+                double x = a[i], z = (expr); \
+                r[i] = IS_FINITE(x) ? z : x; \
+            } \
+        } \
+        break; \
+    case OPERANDS_SV: \
+        { \
+            double x = np->leftPtr->scalar; \
+            for (i = 0; i < n; i++) { \
+                double y = b[i], z = (expr); \
+                r[i] = IS_FINITE(y) ? z : y; \
+            } \
+        } \
+        break; \
+    }
 
-            case RIGHT_SHIFT:
-                {
-                    long offset;
-
-                    offset = (int)scalar % vPtr->length;
-                    if (offset > 0) {
-                        double *hold;
-                        long j;
-                        
-                        hold = Blt_AssertMalloc(sizeof(double) * offset);
-                        for (i = vPtr->length - offset, j = 0; 
-                             i < vPtr->length; i++, j++) {
-                            hold[j] = values[i];
-                        }
-                        for (i = vPtr->length - offset - 1, 
-                                 j = vPtr->length - 1; i >= 0; i--, j--) {
-                            values[j] = values[i];
-                        }
-                        for (i = 0; i < offset; i++) {
-                            values[i] = hold[i];
-                        }
-                        Blt_Free(hold);
-                    }
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * CheckBlock --
+ *
+ *      Verifies that the arithmetic results in a block are finite.  Holes
+ *      that were passed through from the operands are ignored.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+CheckBlock(Tcl_Interp *interp, ExprNode *np, const double *a, 
+           const double *b, const double *r, long n)
+{
+    long i;
+    int numHoles;
 
-            default:
-                Tcl_AppendResult(interp, "unknown operator in expression",
-                    (char *)NULL);
-                goto error;
-            }
+    /* Quick check, without branches, that all the results are finite. */
+    numHoles = 0;
+    for (i = 0; i < n; i++) {
+        numHoles += !IS_FINITE(r[i]);
+    }
+    if (numHoles == 0) {
+        return TCL_OK;
+    }
+    for (i = 0; i < n; i++) {
+        int computed;
 
-        } else if (vPtr->length == 1) {
-            double scalar;
-
-            /*
-             * 1st operand is a scalar.
-             */
-            scalar = vPtr->valueArr[0];
-            length = v2Ptr->length;
-            values = Blt_AssertMalloc(sizeof(double) * length);
-            memcpy(values, v2Ptr->valueArr, sizeof(double) * length);
-            switch (operator) {
-            case MULT:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] *= scalar;
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+        if (IS_FINITE(r[i])) {
+            continue;
+        }
+        switch (np->mode) {
+        case OPERANDS_VV:
+            computed = (IS_FINITE(a[i]) && IS_FINITE(b[i]));
+            break;
+        case OPERANDS_VS:
+            computed = IS_FINITE(a[i]);
+            break;
+        default:
+            computed = IS_FINITE(b[i]);
+            break;
+        }
+        if (computed) {
+            MathError(interp, r[i]);
+            return TCL_ERROR;
+        }
+    }
+    return TCL_OK;
+}
 
-            case PLUS:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] += scalar;
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * BinaryBlock --
+ *
+ *      Computes a block of points of a binary operator node.  Depending
+ *      upon the mode of the node, either a or b is ignored and the
+ *      scalar value of the operand is used instead.
+ *
+ * Results:
+ *      A standard TCL result.  The points are stored in r.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+BinaryBlock(Tcl_Interp *interp, ExprNode *np, const double *a, 
+            const double *b, double *r, long n)
+{
+    long i;
 
-            case DIVIDE:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    if (values[i] == 0.0) {
-                        Tcl_AppendResult(interp, "divide by zero", 
-                                         (char *)NULL);
-                        goto error;
-                    }
-                    values[i] = scalar / values[i];
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    errno = 0;
+    switch (np->op) {
+    case MULT:
+        BINARY_LOOP(x * y);
+        break;
 
-            case MINUS:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = scalar - values[i];
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    case DIVIDE:
+        if (np->mode != OPERANDS_VS) {
+            int numZeros;
 
-            case EXPONENT:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = pow(scalar, values[i]);
-                    if ((!FINITE(values[i])) || (errno != 0)) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
+            numZeros = 0;
+            if (np->mode == OPERANDS_VV) {
+                for (i = 0; i < n; i++) {
+                    numZeros += (IS_FINITE(a[i]) & (b[i] == 0.0));
                 }
-                break;
-
-            case MOD:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = Fmod(scalar, values[i]);
-                    if ((!FINITE(values[i])) || (errno != 0)) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
+            } else {
+                for (i = 0; i < n; i++) {
+                    numZeros += (b[i] == 0.0);
                 }
-                break;
+            }
+            if (numZeros > 0) {
+                Tcl_AppendResult(interp, (np->mode == OPERANDS_VV) ? 
+                        "can't divide by 0.0 vector point" : "divide by zero",
+                        (char *)NULL);
+                return TCL_ERROR;
+            }
+        }
+        BINARY_LOOP(x / y);
+        break;
 
-            case LESS:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(scalar < values[i]);
-                }
-                break;
+    case PLUS:
+        BINARY_LOOP(x + y);
+        break;
 
-            case GREATER:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(scalar > values[i]);
-                }
-                break;
+    case MINUS:
+        BINARY_LOOP(x - y);
+        break;
 
-            case LEQ:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(scalar >= values[i]);
-                }
-                break;
+    case MOD:
+        BINARY_LOOP(Fmod(x, y));
+        break;
 
-            case GEQ:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(scalar <= values[i]);
+    case EXPONENT:
+        if (np->mode == OPERANDS_VV) {
+            BINARY_LOOP(pow(x, y));
+            break;
+        }
+        /* With a scalar operand, also check for underflows. */
+        for (i = 0; i < n; i++) {
+            double x, y;
+
+            if (np->mode == OPERANDS_VS) {
+                x = a[i], y = np->rightPtr->scalar;
+                if (!IS_FINITE(x)) {
+                    r[i] = x;
+                    continue;
                 }
-                break;
-
-            case EQUAL:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] == scalar);
+            } else {
+                x = np->leftPtr->scalar, y = b[i];
+                if (!IS_FINITE(y)) {
+                    r[i] = y;
+                    continue;
                 }
-                break;
+            }
+            r[i] = pow(x, y);
+            if ((!IS_FINITE(r[i])) || (errno != 0)) {
+                MathError(interp, r[i]);
+                return TCL_ERROR;
+            }
+        }
+        return TCL_OK;
 
-            case NEQ:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] != scalar);
-                }
-                break;
+    case LESS:
+        BINARY_LOOP((double)(x < y));
+        return TCL_OK;
 
-            case AND:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] && scalar);
-                }
-                break;
+    case GREATER:
+        BINARY_LOOP((double)(x > y));
+        return TCL_OK;
 
-            case OR:
-                for(i = 0; i < length; i++) {
-                    if (!FINITE(values[i])) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] || scalar);
-                }
-                break;
+    case LEQ:
+        BINARY_LOOP((double)(x <= y));
+        return TCL_OK;
 
-            case LEFT_SHIFT:
-            case RIGHT_SHIFT:
-                Tcl_AppendResult(interp, "second shift operand must be scalar",
-                    (char *)NULL);
-                goto error;
+    case GEQ:
+        BINARY_LOOP((double)(x >= y));
+        return TCL_OK;
 
-            default:
-                Tcl_AppendResult(interp, "unknown operator in expression",
-                    (char *)NULL);
-                goto error;
-            }
-        } else {
-            double *opnd2;
-            /*
-             * Carry out the function of the specified operator.
-             */
-            if (vPtr->length != v2Ptr->length) {
-                Tcl_AppendResult(interp, "vectors are different lengths",
-                    (char *)NULL);
-                goto error;
-            }
-            errno = 0;
-            opnd2 = v2Ptr->valueArr;
-            length = vPtr->length;
-            values = Blt_AssertMalloc(sizeof(double) * length);
-            memcpy(values, vPtr->valueArr, sizeof(double) * length);
-            switch (operator) {
-            case MULT:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] *= opnd2[i];
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    case EQUAL:
+        BINARY_LOOP((double)(x == y));
+        return TCL_OK;
 
-            case DIVIDE:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    if (opnd2[i] == 0.0) {
-                        Tcl_AppendResult(interp,
-                                "can't divide by 0.0 vector point",
-                                (char *)NULL);
-                        goto error;
-                    }
-                    values[i] /= opnd2[i];
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    case NEQ:
+        BINARY_LOOP((double)(x != y));
+        return TCL_OK;
 
-            case PLUS:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] += opnd2[i];
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    case AND:
+        BINARY_LOOP((double)((x != 0.0) & (y != 0.0)));
+        return TCL_OK;
 
-            case MINUS:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] -= opnd2[i];
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    case OR:
+        BINARY_LOOP((double)((x != 0.0) | (y != 0.0)));
+        return TCL_OK;
 
-            case MOD:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = Fmod(values[i], opnd2[i]);
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+    default:
+        Tcl_AppendResult(interp, "unknown operator in expression",
+                (char *)NULL);
+        return TCL_ERROR;
+    }
+    return CheckBlock(interp, np, a, b, r, n);
+}
 
-            case EXPONENT:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = pow(values[i], opnd2[i]);
-                    if (!FINITE(values[i])) {
-                        MathError(interp, values[i]);
-                        goto error;
-                    }
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * EvalBlock --
+ *
+ *      Computes the points start through start + n - 1 of a vector node.
+ *      Children are evaluated into their own blocks of the scratch arena
+ *      and consumed immediately, so no temporary vectors are needed.
+ *
+ * Results:
+ *      A standard TCL result.  *blockPtr points to the computed points.
+ *      This is dest, if non-NULL, unless the node's values were already
+ *      computed.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+EvalBlock(Tcl_Interp *interp, ExprNode *np, long start, long n, double *dest,
+          double **blockPtr)
+{
+    double *a, *b, *r;
 
-            case LESS:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] < opnd2[i]);
-                }
-                break;
+    if (np->values != NULL) {
+        *blockPtr = np->values + start;
+        return TCL_OK;
+    }
+    r = (dest != NULL) ? dest : np->scratch;
+    a = b = NULL;
+    if ((np->leftPtr->length != 1) &&
+        (EvalBlock(interp, np->leftPtr, start, n, NULL, &a) != TCL_OK)) {
+        return TCL_ERROR;
+    }
+    if (np->type == NODE_BINARY) {
+        if ((np->rightPtr->length != 1) &&
+            (EvalBlock(interp, np->rightPtr, start, n, NULL, &b) != TCL_OK)) {
+            return TCL_ERROR;
+        }
+        if (BinaryBlock(interp, np, a, b, r, n) != TCL_OK) {
+            return TCL_ERROR;
+        }
+    } else if (UnaryBlock(interp, np, a, r, n) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    *blockPtr = r;
+    return TCL_OK;
+}
 
-            case GREATER:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] > opnd2[i]);
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * EvaluateNode --
+ *
+ *      Computes all the points of a vector node into the given array.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+EvaluateNode(Tcl_Interp *interp, ExprNode *np, double *values)
+{
+    long start;
 
-            case LEQ:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] <= opnd2[i]);
-                }
-                break;
+    for (start = 0; start < np->length; start += EXPR_BLOCK_SIZE) {
+        double *block;
+        long n;
 
-            case GEQ:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] >= opnd2[i]);
-                }
-                break;
+        n = np->length - start;
+        if (n > EXPR_BLOCK_SIZE) {
+            n = EXPR_BLOCK_SIZE;
+        }
+        if (EvalBlock(interp, np, start, n, values + start, &block) 
+            != TCL_OK) {
+            return TCL_ERROR;
+        }
+        if (block != values + start) {
+            memcpy(values + start, block, n * sizeof(double));
+        }
+    }
+    return TCL_OK;
+}
 
-            case EQUAL:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] == opnd2[i]);
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * MaterializeNode --
+ *
+ *      Computes the value of a node into a temporary vector.  This is
+ *      used for the operands of math functions and shifts, which need
+ *      the entire operand.
+ *
+ * Results:
+ *      A standard TCL result.  The temporary vector is saved in the
+ *      tmpPtr field of the parent node, np, and is freed after the
+ *      expression is evaluated.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+MaterializeNode(Tcl_Interp *interp, VecExpr *exprPtr, ExprNode *np, 
+                ExprNode *argPtr)
+{
+    Vector *vPtr;
 
-            case NEQ:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] != opnd2[i]);
-                }
-                break;
+    vPtr = Blt_Vec_New(exprPtr->dataPtr);
+    np->tmpPtr = vPtr;
+    if (Blt_Vec_ChangeLength(interp, vPtr, argPtr->length) != TCL_OK) {
+        return TCL_ERROR;
+    }
+    vPtr->offset = argPtr->offset;
+    if (argPtr->length == 1) {
+        vPtr->valueArr[0] = argPtr->scalar;
+        return TCL_OK;
+    }
+    return EvaluateNode(interp, argPtr, vPtr->valueArr);
+}
 
-            case AND:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] && opnd2[i]);
-                }
-                break;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ReduceNode --
+ *
+ *      Invokes a reduction (sum, mean, median, ...) directly on the values
+ *      of a vector operand.  The reductions only read the vector, so a
+ *      view of the operand is passed instead of a temporary copy.
+ *
+ * Results:
+ *      A standard TCL result.  The scalar result is left in the node.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ReduceNode(Tcl_Interp *interp, ExprNode *np, ExprNode *argPtr)
+{
+    Vector view;
+    ScalarProc *procPtr = (ScalarProc *)np->mathPtr->clientData;
+    double value;
 
-            case OR:
-                for (i = 0; i < length; i++) {
-                    if ((!FINITE(values[i])) || (!FINITE(opnd2[i]))) {
-                        continue;
-                    }
-                    values[i] = (double)(values[i] || opnd2[i]);
-                }
-                break;
+    memset(&view, 0, sizeof(Vector));
+    view.valueArr = (argPtr->length == 1) ? &argPtr->scalar : argPtr->values;
+    view.length = view.size = view.last = argPtr->length;
+    view.offset = argPtr->offset;
+    errno = 0;
+    value = (*procPtr) (&view);
+    if ((errno != 0) || (!FINITE(value))) {
+        MathError(interp, value);
+        return TCL_ERROR;
+    }
+    np->length = 1;
+    np->offset = argPtr->offset;
+    np->scalar = value;
+    return TCL_OK;
+}
 
-            case LEFT_SHIFT:
-            case RIGHT_SHIFT:
-                Tcl_AppendResult(interp, "second shift operand must be scalar",
-                    (char *)NULL);
-                goto error;
+static void
+RotateValues(double *values, long length, long offset)
+{
+    double *hold;
 
-            default:
-                Tcl_AppendResult(interp, "unknown operator in expression",
-                    (char *)NULL);
-                goto error;
+    hold = Blt_AssertMalloc(sizeof(double) * offset);
+    memcpy(hold, values, sizeof(double) * offset);
+    memmove(values, values + offset, sizeof(double) * (length - offset));
+    memcpy(values + length - offset, hold, sizeof(double) * offset);
+    Blt_Free(hold);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * PrepareNode --
+ *
+ *      Prepares a node and its children to be evaluated.  Vectors are
+ *      looked up, math functions (other than point functions) and shifts
+ *      are computed, and operands are checked.  Scalar nodes are computed
+ *      here too, so that only vector nodes are evaluated a block at a
+ *      time.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+PrepareNode(Tcl_Interp *interp, VecExpr *exprPtr, ExprNode *np)
+{
+    ExprNode *leftPtr, *rightPtr;
+
+    np->values = NULL;
+    np->offset = 0;
+    if (np->slot >= 0) {
+        np->scratch = exprPtr->arena + (np->slot * EXPR_BLOCK_SIZE);
+    }
+    leftPtr = np->leftPtr;
+    rightPtr = np->rightPtr;
+    switch (np->type) {
+    case NODE_CONSTANT:
+        np->length = 1;
+        break;
+
+    case NODE_VECTOR:
+        {
+            Vector *vPtr;
+            const char *endPtr;
+
+            vPtr = Blt_Vec_ParseElement(interp, exprPtr->dataPtr, np->name,
+                &endPtr, NS_SEARCH_BOTH);
+            if (vPtr == NULL) {
+                return TCL_ERROR;
+            }
+            np->length = vPtr->last - vPtr->first;
+            np->offset = vPtr->offset;
+            if (np->length == 1) {
+                np->scalar = vPtr->valueArr[vPtr->first];
+            } else {
+                np->values = vPtr->valueArr + vPtr->first;
             }
         }
-        if (values != NULL) {
-            Blt_Vec_Reset(vPtr, values, length, length, TCL_DYNAMIC);
+        break;
+
+    case NODE_UNARY:
+    case NODE_POINTFUNC:
+        if (PrepareNode(interp, exprPtr, leftPtr) != TCL_OK) {
+            return TCL_ERROR;
         }
+        np->length = leftPtr->length;
+        np->offset = leftPtr->offset;
+        if (np->length == 1) {
+            return UnaryBlock(interp, np, &leftPtr->scalar, &np->scalar, 1);
+        }
+        break;
+
+    case NODE_FUNCTION:
+        {
+            GenericMathProc *proc;
+            Vector *vPtr;
+
+            if (PrepareNode(interp, exprPtr, leftPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            if ((np->mathPtr->proc == (void *)ScalarFunc) &&
+                (leftPtr->type == NODE_VECTOR)) {
+                return ReduceNode(interp, np, leftPtr);
+            }
+            if (MaterializeNode(interp, exprPtr, np, leftPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            vPtr = np->tmpPtr;
+            proc = np->mathPtr->proc;
+            if ((*proc) (np->mathPtr->clientData, interp, vPtr) != TCL_OK) {
+                return TCL_ERROR;       /* Function invocation error */
+            }
+            np->length = vPtr->length;
+            np->offset = vPtr->offset;
+            if (np->length == 1) {
+                np->scalar = vPtr->valueArr[0];
+            } else {
+                np->values = vPtr->valueArr;
+            }
+        }
+        break;
+
+    case NODE_BINARY:
+        if ((PrepareNode(interp, exprPtr, leftPtr) != TCL_OK) ||
+            (PrepareNode(interp, exprPtr, rightPtr) != TCL_OK)) {
+            return TCL_ERROR;
+        }
+        np->offset = leftPtr->offset;
+        if ((np->op == LEFT_SHIFT) || (np->op == RIGHT_SHIFT)) {
+            long offset;
+
+            if (rightPtr->length != 1) {
+                if ((leftPtr->length != 1) && 
+                    (leftPtr->length != rightPtr->length)) {
+                    Tcl_AppendResult(interp, "vectors are different lengths",
+                        (char *)NULL);
+                } else {
+                    Tcl_AppendResult(interp, 
+                        "second shift operand must be scalar", (char *)NULL);
+                }
+                return TCL_ERROR;
+            }
+            np->length = leftPtr->length;
+            if (np->length == 1) {
+                np->scalar = leftPtr->scalar;
+                break;
+            }
+            if (MaterializeNode(interp, exprPtr, np, leftPtr) != TCL_OK) {
+                return TCL_ERROR;
+            }
+            np->values = np->tmpPtr->valueArr;
+            offset = (np->length > 0) ? (long)rightPtr->scalar % np->length : 0;
+            if (offset > 0) {
+                if (np->op == RIGHT_SHIFT) {
+                    offset = np->length - offset;
+                }
+                RotateValues(np->values, np->length, offset);
+            }
+            break;
+        }
+        if (rightPtr->length == 1) {
+            if ((np->op == DIVIDE) && (rightPtr->scalar == 0.0)) {
+                Tcl_AppendResult(interp, "divide by zero", (char *)NULL);
+                return TCL_ERROR;
+            }
+            np->mode = OPERANDS_VS;
+            np->length = leftPtr->length;
+            if (np->length == 1) {
+                return BinaryBlock(interp, np, &leftPtr->scalar, NULL, 
+                                   &np->scalar, 1);
+            }
+        } else if (leftPtr->length == 1) {
+            np->mode = OPERANDS_SV;
+            np->length = rightPtr->length;
+        } else {
+            if (leftPtr->length != rightPtr->length) {
+                Tcl_AppendResult(interp, "vectors are different lengths",
+                        (char *)NULL);
+                return TCL_ERROR;
+            }
+            np->mode = OPERANDS_VV;
+            np->length = leftPtr->length;
+        }
+        break;
     }
-  done:
-    if (value2.pv.buffer != value2.staticSpace) {
-        Blt_Free(value2.pv.buffer);
-    }
-    Blt_Vec_Free(v2Ptr);
-    return result;
+    return TCL_OK;
+}
 
-  error:
-    if (value2.pv.buffer != value2.staticSpace) {
-        Blt_Free(value2.pv.buffer);
+/* Frees the temporary vectors created while evaluating the expression. */
+static void
+ReleaseNode(ExprNode *np)
+{
+    if (np == NULL) {
+        return;
     }
-    Blt_Vec_Free(v2Ptr);
-    if (values != NULL) {
-        Blt_Free(values);
+    ReleaseNode(np->leftPtr);
+    ReleaseNode(np->rightPtr);
+    if (np->tmpPtr != NULL) {
+        Blt_Vec_Free(np->tmpPtr);
+        np->tmpPtr = NULL;
     }
-    return TCL_ERROR;
+    np->values = NULL;
 }
 
 /*
  *---------------------------------------------------------------------------
  *
- * EvaluateExpression --
+ * EvaluateExpr --
  *
- *      This procedure provides top-level functionality shared by
- *      procedures like Tcl_ExprInt, Tcl_ExprDouble, etc.
+ *      Evaluates a compiled expression.  If vPtr is non-NULL, the vector
+ *      is reset with the result.  Otherwise the values are returned as a
+ *      list in interp->result.
  *
  * Results:
- *      The result is a standard TCL return value.  If an error occurs then
- *      an error message is left in interp->result.  The value of the
- *      expression is returned in *valuePtr, in whatever form it ends up in
- *      (could be string or integer or double).  Caller may need to convert
- *      result.  Caller is also responsible for freeing string memory in
- *      *valuePtr, if any was allocated.
+ *      The result is a standard TCL return value.  If an error occurs
+ *      then an error message is left in interp->result and the vector is
+ *      left unchanged.
  *
  * Side effects:
- *      None.
+ *      Clients of the vector are notified of the new values.
  *
  *---------------------------------------------------------------------------
  */
 static int
-EvaluateExpression(
-    Tcl_Interp *interp,                 /* Context in which to evaluate the
-                                         * expression. */
-    char *string,                       /* Expression to evaluate. */
-    Value *valuePtr)                    /* Where to store result.  Should
-                                         * not be initialized by caller. */
+EvaluateExpr(Tcl_Interp *interp, VecExpr *exprPtr, Vector *vPtr)
 {
-    ParseInfo info;
+    ExprNode *rootPtr = exprPtr->rootPtr;
+    double *values;
+    long length;
     int result;
 
-    errno = 0;
-    info.expr = info.nextPtr = string;
-    valuePtr->pv.buffer = valuePtr->pv.next = valuePtr->staticSpace;
-    valuePtr->pv.end = valuePtr->pv.buffer + STATIC_STRING_SPACE - 1;
-    valuePtr->pv.expandProc = Blt_ExpandParseValue;
-    valuePtr->pv.clientData = NULL;
-
-    result = NextValue(interp, &info, -1, valuePtr);
+    if ((exprPtr->arena == NULL) && (exprPtr->numSlots > 0)) {
+        exprPtr->arena = Blt_Malloc(sizeof(double) * EXPR_BLOCK_SIZE * 
+                                    exprPtr->numSlots);
+        if (exprPtr->arena == NULL) {
+            Tcl_AppendResult(interp, "can't allocate scratch space for ",
+                "vector expression", (char *)NULL);
+            return TCL_ERROR;
+        }
+    }
+    values = NULL;
+    result = PrepareNode(interp, exprPtr, rootPtr);
     if (result != TCL_OK) {
-        return result;
+        goto done;
     }
-    if (info.token != END) {
-        Tcl_AppendResult(interp, ": syntax error in expression \"",
-            string, "\"", (char *)NULL);
-        return TCL_ERROR;
+    length = rootPtr->length;
+    if (vPtr == NULL) {
+        Tcl_Obj *listObjPtr;
+        long start;
+
+        /* No result vector.  Put values in interp->result.  */
+        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
+        if (length == 1) {
+            Tcl_ListObjAppendElement(interp, listObjPtr, 
+                Tcl_NewDoubleObj(rootPtr->scalar));
+        }
+        for (start = 0; (length != 1) && (start < length); 
+             start += EXPR_BLOCK_SIZE) {
+            double *block;
+            long i, n;
+
+            n = length - start;
+            if (n > EXPR_BLOCK_SIZE) {
+                n = EXPR_BLOCK_SIZE;
+            }
+            result = EvalBlock(interp, rootPtr, start, n, NULL, &block);
+            if (result != TCL_OK) {
+                Tcl_DecrRefCount(listObjPtr);
+                goto done;
+            }
+            for (i = 0; i < n; i++) {
+                Tcl_ListObjAppendElement(interp, listObjPtr, 
+                        Tcl_NewDoubleObj(block[i]));
+            }
+        }
+        Tcl_SetObjResult(interp, listObjPtr);
+        goto done;
     }
-    return TCL_OK;
+    /* 
+     * Compute the values into a new array, then swap it into the vector.
+     * The vector may be an operand of the expression and must be left
+     * unchanged if there's an error.
+     */
+    if (length > 0) {
+        values = Blt_Malloc(sizeof(double) * length);
+        if (values == NULL) {
+            Tcl_AppendResult(interp, "can't allocate ", Blt_Ltoa(length), 
+                " elements for vector \"", vPtr->name, "\"", (char *)NULL);
+            result = TCL_ERROR;
+            goto done;
+        }
+        if (length == 1) {
+            values[0] = rootPtr->scalar;
+        } else {
+            result = EvaluateNode(interp, rootPtr, values);
+            if (result != TCL_OK) {
+                Blt_Free(values);
+                goto done;
+            }
+        }
+    }
+    vPtr->offset = rootPtr->offset;
+    result = Blt_Vec_Reset(vPtr, values, length, length, TCL_DYNAMIC);
+    vPtr->first = 0;
+    vPtr->last = vPtr->length;
+ done:
+    ReleaseNode(rootPtr);
+    return result;
 }
 
 /*
@@ -2266,6 +2412,83 @@ Blt_Vec_InstallSpecialIndices(Blt_HashTable *tablePtr)
 }
 
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * DupExprInternalRep --
+ *
+ *      Shares the compiled expression of one object with another.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+DupExprInternalRep(Tcl_Obj *srcObjPtr, Tcl_Obj *destObjPtr)
+{
+    VecExpr *exprPtr;
+
+    exprPtr = srcObjPtr->internalRep.twoPtrValue.ptr1;
+    exprPtr->refCount++;
+    destObjPtr->internalRep.twoPtrValue.ptr1 = exprPtr;
+    destObjPtr->typePtr = &vecExprObjType;
+}
+
+static void
+FreeExprInternalRep(Tcl_Obj *objPtr)
+{
+    VecExpr *exprPtr;
+
+    exprPtr = objPtr->internalRep.twoPtrValue.ptr1;
+    ReleaseExpr(exprPtr);
+    objPtr->internalRep.twoPtrValue.ptr1 = NULL;
+    objPtr->typePtr = NULL;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetExprFromObj --
+ *
+ *      Returns the compiled expression of an object, compiling it if
+ *      necessary.  Expressions without variable or command substitutions
+ *      are saved in the object's internal representation.
+ *
+ * Results:
+ *      A standard TCL result.  The expression is returned in *exprPtrPtr
+ *      and must be released by the caller with ReleaseExpr.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+GetExprFromObj(Tcl_Interp *interp, VectorCmdInterpData *dataPtr, 
+               Tcl_Obj *objPtr, VecExpr **exprPtrPtr)
+{
+    VecExpr *exprPtr;
+
+    if (objPtr->typePtr == &vecExprObjType) {
+        exprPtr = objPtr->internalRep.twoPtrValue.ptr1;
+        if (exprPtr->dataPtr == dataPtr) {
+            exprPtr->refCount++;
+            *exprPtrPtr = exprPtr;
+            return TCL_OK;
+        }
+    }
+    exprPtr = CompileExpr(interp, dataPtr, Tcl_GetString(objPtr));
+    if (exprPtr == NULL) {
+        return TCL_ERROR;
+    }
+    if ((exprPtr->flags & EXPR_VOLATILE) == 0) {
+        if ((objPtr->typePtr != NULL) && 
+            (objPtr->typePtr->freeIntRepProc != NULL)) {
+            (*objPtr->typePtr->freeIntRepProc)(objPtr);
+        }
+        exprPtr->refCount++;
+        objPtr->internalRep.twoPtrValue.ptr1 = exprPtr;
+        objPtr->typePtr = &vecExprObjType;
+    }
+    *exprPtrPtr = exprPtr;
+    return TCL_OK;
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -2281,7 +2504,7 @@ Blt_Vec_InstallSpecialIndices(Blt_HashTable *tablePtr)
  *      incompatible with the desired form then an error is returned.
  *
  * Side effects:
- *      None.
+ *      Clients of the result vector are notified.
  *
  *---------------------------------------------------------------------------
  */
@@ -2294,31 +2517,53 @@ Blt_ExprVector(
 {
     VectorCmdInterpData *dataPtr;       /* Interpreter-specific data. */
     Vector *vPtr = (Vector *)vector;
-    Value value;
+    VecExpr *exprPtr;
+    int result;
 
     dataPtr = (vPtr != NULL) ? vPtr->dataPtr : Blt_Vec_GetInterpData(interp);
-    value.vPtr = Blt_Vec_New(dataPtr);
-    if (EvaluateExpression(interp, string, &value) != TCL_OK) {
-        Blt_Vec_Free(value.vPtr);
+    exprPtr = CompileExpr(interp, dataPtr, string);
+    if (exprPtr == NULL) {
         return TCL_ERROR;
     }
-    if (vPtr != NULL) {
-        Blt_Vec_Duplicate(vPtr, value.vPtr);
-    } else {
-        Tcl_Obj *listObjPtr;
-        long i;
+    result = EvaluateExpr(interp, exprPtr, vPtr);
+    ReleaseExpr(exprPtr);
+    return result;
+}
 
-        /* No result vector.  Put values in interp->result.  */
-        listObjPtr = Tcl_NewListObj(0, (Tcl_Obj **) NULL);
-        for (i = 0; i < value.vPtr->length; i++) {
-            Tcl_Obj *objPtr;
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_ExprObj --
+ *
+ *      Like Blt_ExprVector, but the compiled expression is cached in the
+ *      object, so evaluating the same expression again doesn't reparse
+ *      it.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ * Side effects:
+ *      Clients of the result vector are notified.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+Blt_Vec_ExprObj(
+    Tcl_Interp *interp,                 /* Context in which to evaluate the
+                                         * expression. */
+    Tcl_Obj *objPtr,                    /* Expression to evaluate. */
+    Vector *vPtr)                       /* If non-NULL, where to store
+                                         * result. */
+{
+    VectorCmdInterpData *dataPtr;       /* Interpreter-specific data. */
+    VecExpr *exprPtr;
+    int result;
 
-            objPtr = Tcl_NewDoubleObj(value.vPtr->valueArr[i]);
-            Tcl_ListObjAppendElement(interp, listObjPtr, objPtr);
-        }
-        Tcl_SetObjResult(interp, listObjPtr);
+    dataPtr = (vPtr != NULL) ? vPtr->dataPtr : Blt_Vec_GetInterpData(interp);
+    if (GetExprFromObj(interp, dataPtr, objPtr, &exprPtr) != TCL_OK) {
+        return TCL_ERROR;
     }
-    Blt_Vec_Free(value.vPtr);
-    return TCL_OK;
+    result = EvaluateExpr(interp, exprPtr, vPtr);
+    ReleaseExpr(exprPtr);
+    return result;
 }
-
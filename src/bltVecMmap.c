@@ -0,0 +1,379 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * bltVecMmap.c --
+ *
+ * This module implements vectors whose values are backed by binary
+ * files.
+ *
+ * Copyright 2015 George A. Howlett. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are
+ *   met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *   4) Products derived from this software may not be called "BLT" nor may
+ *      "BLT" appear in their names without specific prior written
+ *      permission from the author.
+ *
+ *   THIS SOFTWARE IS PROVIDED ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ *   WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ *   BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ *   OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ *   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * A file of native doubles is mapped privately and used as the vector's
+ * array of values as is.  Changes to the values are never written back
+ * to the file.
+ *
+ * Files of other formats (float32, int16) can't be used directly.  Their
+ * values are all converted into a new array of doubles when the file is
+ * mapped, and the file is unmapped again.  So these vectors take as much
+ * memory as ordinary vectors of the same length.  The mapping is only
+ * used to read the file without an intermediate buffer.
+ */
+
+#include "bltVecInt.h"
+
+#ifdef HAVE_STRING_H
+  #include <string.h>
+#endif /* HAVE_STRING_H */
+
+#ifdef HAVE_SYS_MMAN_H
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif /* HAVE_SYS_MMAN_H */
+
+#include "bltAlloc.h"
+
+static int formatSizes[] = {
+    sizeof(double),                     /* VECTOR_FORMAT_FLOAT64 */
+    sizeof(float),                      /* VECTOR_FORMAT_FLOAT32 */
+    sizeof(short),                      /* VECTOR_FORMAT_INT16 */
+};
+
+struct _MappedFile {
+    int format;                         /* Format of the values in the
+                                         * file. */
+    long numValues;                     /* # of values mapped. */
+    char *base;                         /* Start of the file mapping.  It's
+                                         * page aligned, so it may be
+                                         * before the first value. */
+    size_t mapSize;                     /* # of bytes in the file
+                                         * mapping. */
+    const char *data;                   /* First value in the file. */
+};
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ConvertValues --
+ *
+ *      Converts values from the format of the file into doubles.  The
+ *      file values may not be aligned, so they are copied out one at a
+ *      time.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+ConvertValues(int format, const char *src, long numValues, double *dest)
+{
+    long i;
+
+    switch (format) {
+    case VECTOR_FORMAT_FLOAT64:
+        memcpy(dest, src, numValues * sizeof(double));
+        break;
+    case VECTOR_FORMAT_FLOAT32:
+        for (i = 0; i < numValues; i++, src += sizeof(float)) {
+            float f;
+
+            memcpy(&f, src, sizeof(float));
+            dest[i] = (double)f;
+        }
+        break;
+    case VECTOR_FORMAT_INT16:
+        for (i = 0; i < numValues; i++, src += sizeof(short)) {
+            short s;
+
+            memcpy(&s, src, sizeof(short));
+            dest[i] = (double)s;
+        }
+        break;
+    }
+}
+
+#ifdef HAVE_SYS_MMAN_H
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * MapFile --
+ *
+ *      Maps the portion of the file holding the values.  Mappings must
+ *      start on a page boundary, so the mapping may start before the
+ *      offset.  The mapping is private: changes to a native array of
+ *      values are never written back to the file.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+MapFile(Tcl_Interp *interp, MappedFile *mfPtr, const char *fileName,
+        long offset, long *lengthPtr)
+{
+    Tcl_DString ds;
+    const char *path;
+    struct stat info;
+    long pageSize, skip, numValues;
+    int fd, elemSize;
+    void *base;
+
+    path = Tcl_TranslateFileName(interp, fileName, &ds);
+    if (path == NULL) {
+        return TCL_ERROR;
+    }
+    fd = open(path, O_RDONLY);
+    Tcl_DStringFree(&ds);
+    if ((fd < 0) || (fstat(fd, &info) < 0)) {
+        Tcl_AppendResult(interp, "can't open \"", fileName, "\": ",
+                Tcl_PosixError(interp), (char *)NULL);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return TCL_ERROR;
+    }
+    elemSize = formatSizes[mfPtr->format];
+    if (offset > info.st_size) {
+        Tcl_AppendResult(interp, "offset ", Blt_Ltoa(offset),
+                " is beyond the end of \"", fileName, "\"", (char *)NULL);
+        close(fd);
+        return TCL_ERROR;
+    }
+    numValues = (info.st_size - offset) / elemSize;
+    if (*lengthPtr > 0) {
+        if (*lengthPtr > numValues) {
+            Tcl_AppendResult(interp, "\"", fileName, "\" has only ",
+                Blt_Ltoa(numValues), (char *)NULL);
+            Tcl_AppendResult(interp, " values after offset ",
+                Blt_Ltoa(offset), (char *)NULL);
+            close(fd);
+            return TCL_ERROR;
+        }
+        numValues = *lengthPtr;
+    }
+    *lengthPtr = numValues;
+    if (numValues == 0) {
+        close(fd);
+        return TCL_OK;                  /* Nothing to map. */
+    }
+    pageSize = sysconf(_SC_PAGESIZE);
+    skip = offset % pageSize;
+    mfPtr->mapSize = skip + numValues * elemSize;
+    base = mmap(NULL, mfPtr->mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                offset - skip);
+    close(fd);
+    if (base == MAP_FAILED) {
+        Tcl_AppendResult(interp, "can't map \"", fileName, "\": ",
+                Tcl_PosixError(interp), (char *)NULL);
+        return TCL_ERROR;
+    }
+    mfPtr->base = base;
+    mfPtr->data = mfPtr->base + skip;
+    mfPtr->numValues = numValues;
+    return TCL_OK;
+}
+
+#else
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ReadFile --
+ *
+ *      Reads and converts the values of the file into a new array.  This
+ *      is used where files can't be mapped.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+ReadFile(Tcl_Interp *interp, Vector *vPtr, const char *fileName, int format,
+         long offset, long length)
+{
+    Tcl_Channel channel;
+    Tcl_WideInt size;
+    long numValues, numBytes;
+    char *bytes;
+    double *valueArr;
+    int elemSize;
+
+    channel = Tcl_OpenFileChannel(interp, fileName, "r", 0);
+    if (channel == NULL) {
+        return TCL_ERROR;
+    }
+    Tcl_SetChannelOption(NULL, channel, "-translation", "binary");
+    size = Tcl_Seek(channel, 0, SEEK_END);
+    elemSize = formatSizes[format];
+    if ((size < 0) || (offset > size)) {
+        Tcl_AppendResult(interp, "offset ", Blt_Ltoa(offset),
+                " is beyond the end of \"", fileName, "\"", (char *)NULL);
+        Tcl_Close(NULL, channel);
+        return TCL_ERROR;
+    }
+    numValues = (long)(size - offset) / elemSize;
+    if (length > 0) {
+        if (length > numValues) {
+            Tcl_AppendResult(interp, "\"", fileName, "\" has only ",
+                Blt_Ltoa(numValues), (char *)NULL);
+            Tcl_AppendResult(interp, " values after offset ",
+                Blt_Ltoa(offset), (char *)NULL);
+            Tcl_Close(NULL, channel);
+            return TCL_ERROR;
+        }
+        numValues = length;
+    }
+    numBytes = numValues * elemSize;
+    bytes = Blt_AssertMalloc(numBytes + 1);
+    Tcl_Seek(channel, offset, SEEK_SET);
+    if (Tcl_Read(channel, bytes, numBytes) != numBytes) {
+        Tcl_AppendResult(interp, "error reading \"", fileName, "\": ",
+                Tcl_PosixError(interp), (char *)NULL);
+        Tcl_Close(NULL, channel);
+        Blt_Free(bytes);
+        return TCL_ERROR;
+    }
+    Tcl_Close(NULL, channel);
+    valueArr = Blt_AssertMalloc(sizeof(double) * MAX(numValues, 1));
+    ConvertValues(format, bytes, numValues, valueArr);
+    Blt_Free(bytes);
+    return Blt_Vec_Reset(vPtr, valueArr, numValues, MAX(numValues, 1),
+                TCL_DYNAMIC);
+}
+
+#endif /* HAVE_SYS_MMAN_H */
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_MapFile --
+ *
+ *      Replaces the values of the vector with the values of a binary
+ *      file.  The values start at *offset* bytes into the file.  If
+ *      *length* is zero, all the values after the offset are used.
+ *
+ *      Native doubles that are suitably aligned are used in place.  Other
+ *      formats, and files that can't be mapped, are converted into a new
+ *      array of values.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ * Side effects:
+ *      The vector's old array of values is released.
+ *
+ *---------------------------------------------------------------------------
+ */
+int
+Blt_Vec_MapFile(Tcl_Interp *interp, Vector *vPtr, const char *fileName,
+                int format, long offset, long length)
+{
+#ifdef HAVE_SYS_MMAN_H
+    MappedFile *mfPtr;
+    double *valueArr;
+
+    mfPtr = Blt_AssertCalloc(1, sizeof(MappedFile));
+    mfPtr->format = format;
+    if (MapFile(interp, mfPtr, fileName, offset, &length) != TCL_OK) {
+        Blt_Free(mfPtr);
+        return TCL_ERROR;
+    }
+    if (length == 0) {
+        Blt_Free(mfPtr);
+        return Blt_Vec_Reset(vPtr, NULL, 0, 0, TCL_STATIC);
+    }
+    if ((format != VECTOR_FORMAT_FLOAT64) ||
+        (((size_t)mfPtr->data % sizeof(double)) != 0)) {
+        int result;
+
+        /* Convert the values into a new array and release the file. */
+        valueArr = Blt_Malloc(sizeof(double) * length);
+        if (valueArr == NULL) {
+            Tcl_AppendResult(interp, "can't allocate ", Blt_Ltoa(length),
+                " values for \"", fileName, "\"", (char *)NULL);
+            munmap(mfPtr->base, mfPtr->mapSize);
+            Blt_Free(mfPtr);
+            return TCL_ERROR;
+        }
+#ifdef MADV_SEQUENTIAL
+        madvise(mfPtr->base, mfPtr->mapSize, MADV_SEQUENTIAL);
+#endif /* MADV_SEQUENTIAL */
+        ConvertValues(format, mfPtr->data, length, valueArr);
+        munmap(mfPtr->base, mfPtr->mapSize);
+        Blt_Free(mfPtr);
+        result = Blt_Vec_Reset(vPtr, valueArr, length, length, TCL_DYNAMIC);
+        if (result != TCL_OK) {
+            Blt_Free(valueArr);
+        }
+        return result;
+    }
+    valueArr = (double *)mfPtr->data;
+    if (Blt_Vec_Reset(vPtr, valueArr, length, length, VECTOR_FILE_MAPPED)
+        != TCL_OK) {
+        munmap(mfPtr->base, mfPtr->mapSize);
+        Blt_Free(mfPtr);
+        return TCL_ERROR;
+    }
+    vPtr->filePtr = mfPtr;
+    return TCL_OK;
+#else
+    return ReadFile(interp, vPtr, fileName, format, offset, length);
+#endif /* HAVE_SYS_MMAN_H */
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_UnmapFile --
+ *
+ *      Releases the file mapping that backs the vector's array of values.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_UnmapFile(Vector *vPtr)
+{
+#ifdef HAVE_SYS_MMAN_H
+    MappedFile *mfPtr = vPtr->filePtr;
+
+    if (mfPtr == NULL) {
+        return;
+    }
+    munmap(mfPtr->base, mfPtr->mapSize);
+    Blt_Free(mfPtr);
+    vPtr->filePtr = NULL;
+#endif /* HAVE_SYS_MMAN_H */
+}
@@ -0,0 +1,759 @@
+/* -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ * bltVecStats.c --
+ *
+ * This module implements the reductions and summary statistics of
+ * vectors.
+ *
+ * Copyright 2015 George A. Howlett. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions are
+ *   met:
+ *
+ *   1) Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2) Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the
+ *      distribution.
+ *   3) Neither the name of the authors nor the names of its contributors
+ *      may be used to endorse or promote products derived from this
+ *      software without specific prior written permission.
+ *   4) Products derived from this software may not be called "BLT" nor may
+ *      "BLT" appear in their names without specific prior written
+ *      permission from the author.
+ *
+ *   THIS SOFTWARE IS PROVIDED ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ *   WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *   MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *   DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *   LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *   CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *   SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ *   BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ *   WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ *   OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ *   IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * The statistics are computed in two sweeps over the values.  The first
+ * sweep counts the finite values and finds their sum, minimum, and
+ * maximum.  The second sweep computes all the central moments about the
+ * mean together.  Quantiles are found by selection (introselect) on a
+ * copy of the finite values rather than by sorting them.
+ *
+ * Both sweeps have SSE2 and AVX2 versions.  Like the picture routines,
+ * the version is picked at runtime from the cpu feature flags.  Values
+ * that are not finite (holes in the vector) are masked out of each lane.
+ */
+
+#include "bltVecInt.h"
+
+#ifdef HAVE_STDLIB_H
+  #include <stdlib.h>
+#endif /* HAVE_STDLIB_H */
+
+#ifdef HAVE_STRING_H
+  #include <string.h>
+#endif /* HAVE_STRING_H */
+
+#include "bltAlloc.h"
+#include <bltMath.h>
+
+#if defined(HAVE_X86_ASM) && defined(__x86_64__)
+#  define HAVE_VEC_SIMD 1
+#  include <immintrin.h>
+#endif  /* HAVE_X86_ASM && __x86_64__ */
+
+#define SELECT_THRESHOLD        16      /* Subarrays smaller than this are
+                                         * finished by insertion sort. */
+
+typedef long (VecSumsProc)(const double *values, long numValues,
+        double *sumPtr, double *minPtr, double *maxPtr);
+typedef void (VecMomentsProc)(const double *values, long numValues,
+        double mean, double *moments);
+
+typedef struct {
+    VecSumsProc *sumsProc;
+    VecMomentsProc *momentsProc;
+} VecStatsProcs;
+
+/*
+ * Running compensated (Kahan) sum.
+ */
+typedef struct {
+    double sum;
+    double c;                           /* A running compensation for lost
+                                         * low-order bits.*/
+} KahanSum;
+
+static INLINE void
+KahanAdd(KahanSum *ksPtr, double x)
+{
+    double y, t;
+
+    y = x - ksPtr->c;                   /* So far, so good: c is zero.*/
+    t = ksPtr->sum + y;                 /* Alas, sum is big, y small, so
+                                         * low-order digits of y are lost.*/
+    ksPtr->c = (t - ksPtr->sum) - y;    /* (t - sum) recovers the high-order
+                                         * part of y; subtracting y recovers
+                                         * -(low part of y) */
+    ksPtr->sum = t;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * SumsStd --
+ *
+ *      Counts the finite values in the array and computes their sum,
+ *      minimum, and maximum.
+ *
+ * Results:
+ *      Returns the number of finite values.  If there are none, the sum
+ *      is 0.0 and the minimum and maximum are NaN.
+ *
+ *---------------------------------------------------------------------------
+ */
+static long
+SumsStd(const double *values, long numValues, double *sumPtr, double *minPtr,
+        double *maxPtr)
+{
+    KahanSum ks;
+    double min, max;
+    long i, count;
+
+    ks.sum = ks.c = 0.0;
+    min = DBL_MAX, max = -DBL_MAX;
+    count = 0;
+    for (i = 0; i < numValues; i++) {
+        double x;
+
+        x = values[i];
+        if (!FINITE(x)) {
+            continue;
+        }
+        KahanAdd(&ks, x);
+        if (x < min) {
+            min = x;
+        }
+        if (x > max) {
+            max = x;
+        }
+        count++;
+    }
+    if (count == 0) {
+        min = max = Blt_NaN();
+    }
+    *sumPtr = ks.sum;
+    *minPtr = min;
+    *maxPtr = max;
+    return count;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * MomentsStd --
+ *
+ *      Computes the sums of the absolute, squared, absolute cubed, and
+ *      fourth power deviations of the finite values from the given mean.
+ *
+ * Results:
+ *      The four sums are returned in the array *moments*.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+MomentsStd(const double *values, long numValues, double mean, double *moments)
+{
+    double m1, m2, m3, m4;
+    long i;
+
+    m1 = m2 = m3 = m4 = 0.0;
+    for (i = 0; i < numValues; i++) {
+        double dx, dx2;
+
+        if (!FINITE(values[i])) {
+            continue;
+        }
+        dx = FABS(values[i] - mean);
+        dx2 = dx * dx;
+        m1 += dx;
+        m2 += dx2;
+        m3 += dx2 * dx;
+        m4 += dx2 * dx2;
+    }
+    moments[0] = m1;
+    moments[1] = m2;
+    moments[2] = m3;
+    moments[3] = m4;
+}
+
+static VecStatsProcs stdStatsProcs = {
+    SumsStd,
+    MomentsStd
+};
+
+static VecStatsProcs *statsProcsPtr = &stdStatsProcs;
+
+#ifdef HAVE_VEC_SIMD
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FinishSums --
+ *
+ *      Combines the per-lane partial results of a SIMD sweep with the
+ *      leftover values at the end of the array.
+ *
+ *---------------------------------------------------------------------------
+ */
+static long
+FinishSums(int numLanes, const double *sums, const double *comps,
+           const double *counts, const double *mins, const double *maxs,
+           const double *values, long numValues, double *sumPtr,
+           double *minPtr, double *maxPtr)
+{
+    KahanSum ks;
+    double min, max, sum, tailMin, tailMax;
+    long count, tailCount;
+    int i;
+
+    ks.sum = ks.c = 0.0;
+    min = DBL_MAX, max = -DBL_MAX;
+    count = 0;
+    for (i = 0; i < numLanes; i++) {
+        KahanAdd(&ks, sums[i]);
+        KahanAdd(&ks, -comps[i]);
+        if (mins[i] < min) {
+            min = mins[i];
+        }
+        if (maxs[i] > max) {
+            max = maxs[i];
+        }
+        count += (long)counts[i];
+    }
+    tailCount = SumsStd(values, numValues, &sum, &tailMin, &tailMax);
+    if (tailCount > 0) {
+        KahanAdd(&ks, sum);
+        if (tailMin < min) {
+            min = tailMin;
+        }
+        if (tailMax > max) {
+            max = tailMax;
+        }
+        count += tailCount;
+    }
+    if (count == 0) {
+        min = max = Blt_NaN();
+    }
+    *sumPtr = ks.sum;
+    *minPtr = min;
+    *maxPtr = max;
+    return count;
+}
+
+__attribute__((target("sse2")))
+static long
+SumsSse2(const double *values, long numValues, double *sumPtr, double *minPtr,
+         double *maxPtr)
+{
+    __m128d absMask, big, one, posInf, negInf;
+    __m128d sum, comp, count, min, max;
+    double sums[2], comps[2], counts[2], mins[2], maxs[2];
+    long i;
+
+    absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    big = _mm_set1_pd(DBL_MAX);
+    one = _mm_set1_pd(1.0);
+    posInf = _mm_set1_pd(HUGE_VAL);
+    negInf = _mm_set1_pd(-HUGE_VAL);
+    sum = comp = count = _mm_setzero_pd();
+    min = posInf, max = negInf;
+    for (i = 0; (i + 2) <= numValues; i += 2) {
+        __m128d x, mask, y, t, c;
+
+        x = _mm_loadu_pd(values + i);
+        mask = _mm_cmple_pd(_mm_and_pd(x, absMask), big);
+        count = _mm_add_pd(count, _mm_and_pd(mask, one));
+        y = _mm_sub_pd(_mm_and_pd(x, mask), comp);
+        t = _mm_add_pd(sum, y);
+        c = _mm_sub_pd(_mm_sub_pd(t, sum), y);
+        /* Lanes holding a hole keep their previous sum and compensation. */
+        sum = _mm_or_pd(_mm_and_pd(mask, t), _mm_andnot_pd(mask, sum));
+        comp = _mm_or_pd(_mm_and_pd(mask, c), _mm_andnot_pd(mask, comp));
+        min = _mm_min_pd(min,
+                _mm_or_pd(_mm_and_pd(mask, x), _mm_andnot_pd(mask, posInf)));
+        max = _mm_max_pd(max,
+                _mm_or_pd(_mm_and_pd(mask, x), _mm_andnot_pd(mask, negInf)));
+    }
+    _mm_storeu_pd(sums, sum);
+    _mm_storeu_pd(comps, comp);
+    _mm_storeu_pd(counts, count);
+    _mm_storeu_pd(mins, min);
+    _mm_storeu_pd(maxs, max);
+    return FinishSums(2, sums, comps, counts, mins, maxs, values + i,
+                      numValues - i, sumPtr, minPtr, maxPtr);
+}
+
+__attribute__((target("sse2")))
+static void
+MomentsSse2(const double *values, long numValues, double mean,
+            double *moments)
+{
+    __m128d absMask, big, m, m1, m2, m3, m4;
+    double tail[4], lanes[2];
+    long i;
+
+    absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    big = _mm_set1_pd(DBL_MAX);
+    m = _mm_set1_pd(mean);
+    m1 = m2 = m3 = m4 = _mm_setzero_pd();
+    for (i = 0; (i + 2) <= numValues; i += 2) {
+        __m128d x, mask, dx, dx2;
+
+        x = _mm_loadu_pd(values + i);
+        mask = _mm_cmple_pd(_mm_and_pd(x, absMask), big);
+        dx = _mm_and_pd(_mm_and_pd(_mm_sub_pd(x, m), absMask), mask);
+        dx2 = _mm_mul_pd(dx, dx);
+        m1 = _mm_add_pd(m1, dx);
+        m2 = _mm_add_pd(m2, dx2);
+        m3 = _mm_add_pd(m3, _mm_mul_pd(dx2, dx));
+        m4 = _mm_add_pd(m4, _mm_mul_pd(dx2, dx2));
+    }
+    MomentsStd(values + i, numValues - i, mean, tail);
+    _mm_storeu_pd(lanes, m1);
+    moments[0] = lanes[0] + lanes[1] + tail[0];
+    _mm_storeu_pd(lanes, m2);
+    moments[1] = lanes[0] + lanes[1] + tail[1];
+    _mm_storeu_pd(lanes, m3);
+    moments[2] = lanes[0] + lanes[1] + tail[2];
+    _mm_storeu_pd(lanes, m4);
+    moments[3] = lanes[0] + lanes[1] + tail[3];
+}
+
+__attribute__((target("avx2")))
+static long
+SumsAvx2(const double *values, long numValues, double *sumPtr, double *minPtr,
+         double *maxPtr)
+{
+    __m256d absMask, big, one, posInf, negInf;
+    __m256d sum, comp, count, min, max;
+    double sums[4], comps[4], counts[4], mins[4], maxs[4];
+    long i;
+
+    absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    big = _mm256_set1_pd(DBL_MAX);
+    one = _mm256_set1_pd(1.0);
+    posInf = _mm256_set1_pd(HUGE_VAL);
+    negInf = _mm256_set1_pd(-HUGE_VAL);
+    sum = comp = count = _mm256_setzero_pd();
+    min = posInf, max = negInf;
+    for (i = 0; (i + 4) <= numValues; i += 4) {
+        __m256d x, mask, y, t, c;
+
+        x = _mm256_loadu_pd(values + i);
+        mask = _mm256_cmp_pd(_mm256_and_pd(x, absMask), big, _CMP_LE_OQ);
+        count = _mm256_add_pd(count, _mm256_and_pd(mask, one));
+        y = _mm256_sub_pd(_mm256_and_pd(x, mask), comp);
+        t = _mm256_add_pd(sum, y);
+        c = _mm256_sub_pd(_mm256_sub_pd(t, sum), y);
+        /* Lanes holding a hole keep their previous sum and compensation. */
+        sum = _mm256_blendv_pd(sum, t, mask);
+        comp = _mm256_blendv_pd(comp, c, mask);
+        min = _mm256_min_pd(min, _mm256_blendv_pd(posInf, x, mask));
+        max = _mm256_max_pd(max, _mm256_blendv_pd(negInf, x, mask));
+    }
+    _mm256_storeu_pd(sums, sum);
+    _mm256_storeu_pd(comps, comp);
+    _mm256_storeu_pd(counts, count);
+    _mm256_storeu_pd(mins, min);
+    _mm256_storeu_pd(maxs, max);
+    return FinishSums(4, sums, comps, counts, mins, maxs, values + i,
+                      numValues - i, sumPtr, minPtr, maxPtr);
+}
+
+__attribute__((target("avx2")))
+static void
+MomentsAvx2(const double *values, long numValues, double mean,
+            double *moments)
+{
+    __m256d absMask, big, m, m1, m2, m3, m4;
+    double tail[4], lanes[4];
+    long i;
+
+    absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    big = _mm256_set1_pd(DBL_MAX);
+    m = _mm256_set1_pd(mean);
+    m1 = m2 = m3 = m4 = _mm256_setzero_pd();
+    for (i = 0; (i + 4) <= numValues; i += 4) {
+        __m256d x, mask, dx, dx2;
+
+        x = _mm256_loadu_pd(values + i);
+        mask = _mm256_cmp_pd(_mm256_and_pd(x, absMask), big, _CMP_LE_OQ);
+        dx = _mm256_and_pd(_mm256_and_pd(_mm256_sub_pd(x, m), absMask), mask);
+        dx2 = _mm256_mul_pd(dx, dx);
+        m1 = _mm256_add_pd(m1, dx);
+        m2 = _mm256_add_pd(m2, dx2);
+        m3 = _mm256_add_pd(m3, _mm256_mul_pd(dx2, dx));
+        m4 = _mm256_add_pd(m4, _mm256_mul_pd(dx2, dx2));
+    }
+    MomentsStd(values + i, numValues - i, mean, tail);
+    _mm256_storeu_pd(lanes, m1);
+    moments[0] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + tail[0];
+    _mm256_storeu_pd(lanes, m2);
+    moments[1] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + tail[1];
+    _mm256_storeu_pd(lanes, m3);
+    moments[2] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + tail[2];
+    _mm256_storeu_pd(lanes, m4);
+    moments[3] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + tail[3];
+}
+
+static VecStatsProcs sse2StatsProcs = {
+    SumsSse2,
+    MomentsSse2
+};
+
+static VecStatsProcs avx2StatsProcs = {
+    SumsAvx2,
+    MomentsAvx2
+};
+
+#endif  /* HAVE_VEC_SIMD */
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_InitStatsProcs --
+ *
+ *      Checks the cpu feature flags and overrides the standard reduction
+ *      routines with faster SIMD versions.
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_InitStatsProcs(void)
+{
+#ifdef HAVE_VEC_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        statsProcsPtr = &avx2StatsProcs;
+    } else if (__builtin_cpu_supports("sse2")) {
+        statsProcsPtr = &sse2StatsProcs;
+    }
+#endif  /* HAVE_VEC_SIMD */
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_Sums --
+ *
+ *      Counts the finite values in the array and computes their sum
+ *      (using Kahan summation), minimum, and maximum in a single sweep.
+ *
+ * Results:
+ *      Returns the number of finite values.  If there are none, the sum
+ *      is 0.0 and the minimum and maximum are NaN.
+ *
+ *---------------------------------------------------------------------------
+ */
+long
+Blt_Vec_Sums(const double *values, long numValues, double *sumPtr,
+             double *minPtr, double *maxPtr)
+{
+    return (*statsProcsPtr->sumsProc)(values, numValues, sumPtr, minPtr,
+                                      maxPtr);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_Moments --
+ *
+ *      Computes the sums of |x - mean|, (x - mean)^2, |x - mean|^3, and
+ *      (x - mean)^4 over the finite values of the array in a single
+ *      sweep.
+ *
+ * Results:
+ *      The four sums are returned in the array *moments*.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_Moments(const double *values, long numValues, double mean,
+                double *moments)
+{
+    (*statsProcsPtr->momentsProc)(values, numValues, mean, moments);
+}
+
+static void
+InsertionSort(double *a, long lo, long hi)
+{
+    long i;
+
+    for (i = lo + 1; i < hi; i++) {
+        double x;
+        long j;
+
+        x = a[i];
+        for (j = i; (j > lo) && (a[j - 1] > x); j--) {
+            a[j] = a[j - 1];
+        }
+        a[j] = x;
+    }
+}
+
+static int
+CompareValues(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Select --
+ *
+ *      Partially orders the subarray [lo, hi) so that a[k] is the value
+ *      that would be there if the subarray were sorted.  Values before k
+ *      are less than or equal to a[k], values after are greater than or
+ *      equal to it.  The subarray must not contain NaNs.
+ *
+ *      This is introselect: quickselect using a median-of-three pivot.
+ *      If the partitions shrink too slowly (more than 2 log2 n rounds),
+ *      the remaining subarray is sorted instead so that the worst case
+ *      stays O(n log n).
+ *
+ * Results:
+ *      None.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+Select(double *a, long lo, long hi, long k)
+{
+    int depth;
+    long n;
+
+    depth = 0;
+    for (n = hi - lo; n > 1; n >>= 1) {
+        depth += 2;
+    }
+    while ((hi - lo) > SELECT_THRESHOLD) {
+        double pivot, t;
+        long i, j, mid;
+
+        if (depth-- == 0) {
+            qsort(a + lo, hi - lo, sizeof(double), CompareValues);
+            return;
+        }
+        /* Median of three.  Order a[lo], a[mid], a[hi-1]. */
+        mid = lo + (hi - lo) / 2;
+        if (a[mid] < a[lo]) {
+            t = a[mid], a[mid] = a[lo], a[lo] = t;
+        }
+        if (a[hi - 1] < a[mid]) {
+            t = a[hi - 1], a[hi - 1] = a[mid], a[mid] = t;
+            if (a[mid] < a[lo]) {
+                t = a[mid], a[mid] = a[lo], a[lo] = t;
+            }
+        }
+        pivot = a[mid];
+
+        /* Hoare partition: [lo, j] <= pivot <= [j + 1, hi) */
+        i = lo - 1;
+        j = hi;
+        for (;;) {
+            do {
+                i++;
+            } while (a[i] < pivot);
+            do {
+                j--;
+            } while (a[j] > pivot);
+            if (i >= j) {
+                break;
+            }
+            t = a[i], a[i] = a[j], a[j] = t;
+        }
+        if (k <= j) {
+            hi = j + 1;
+        } else {
+            lo = j + 1;
+        }
+    }
+    InsertionSort(a, lo, hi);
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * OrderStat --
+ *
+ *      Returns the k-th smallest value of the subarray [lo, hi).  If
+ *      *average* is set, returns the mean of the k-th and (k+1)-th
+ *      smallest values.  The subarray is left partitioned around k.
+ *
+ *---------------------------------------------------------------------------
+ */
+static double
+OrderStat(double *a, long lo, long hi, long k, int average)
+{
+    double next;
+    long i;
+
+    Select(a, lo, hi, k);
+    if (!average) {
+        return a[k];
+    }
+    /* After selection, the next value is the smallest one above k. */
+    next = a[k + 1];
+    for (i = k + 2; i < hi; i++) {
+        if (a[i] < next) {
+            next = a[i];
+        }
+    }
+    return (a[k] + next) * 0.5;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_Quartiles --
+ *
+ *      Computes the first quartile, median, and third quartile of the
+ *      finite values in the array.  The values are copied and only the
+ *      order statistics needed are selected; nothing is sorted.  Any of
+ *      the result pointers may be NULL.
+ *
+ *      The quartiles follow the convention used by the "q1" and "q3"
+ *      vector math functions: with fewer than 4 values they are the
+ *      minimum and maximum.  Otherwise each is the median of the lower
+ *      or upper half of the values.
+ *
+ * Results:
+ *      Returns the number of finite values.  If there are none, the
+ *      quartiles are NaN.
+ *
+ *---------------------------------------------------------------------------
+ */
+long
+Blt_Vec_Quartiles(const double *values, long numValues, double *q1Ptr,
+                  double *medianPtr, double *q3Ptr)
+{
+    double *a;
+    double q1, q2, q3;
+    long i, n, mid;
+
+    a = Blt_AssertMalloc(sizeof(double) * (numValues + 1));
+    n = 0;
+    for (i = 0; i < numValues; i++) {
+        if (FINITE(values[i])) {
+            a[n++] = values[i];
+        }
+    }
+    if (n == 0) {
+        Blt_Free(a);
+        q1 = q2 = q3 = Blt_NaN();
+        goto done;
+    }
+    /*
+     * Determine Q2 by checking if the number of elements [0..n-1] is odd
+     * or even.  If even, we must take the average of the two middle
+     * values.
+     */
+    mid = (n - 1) / 2;
+    q2 = OrderStat(a, 0, n, mid, (n & 1) == 0);
+    /*
+     * The array is now partitioned around mid: the lower half is in
+     * [0, mid] and the upper half in [mid, n).  The quartiles are
+     * selected within those halves.
+     */
+    if (n < 4) {
+        q1 = q3 = a[0];
+        for (i = 1; i < n; i++) {
+            if (a[i] < q1) {
+                q1 = a[i];
+            }
+            if (a[i] > q3) {
+                q3 = a[i];
+            }
+        }
+    } else {
+        /* Q1 before Q3: selecting in the upper half may move a larger
+         * value into a[mid], which Q1 can need. */
+        q1 = OrderStat(a, 0, mid + 1, mid / 2, (mid & 1) == 0);
+        q3 = OrderStat(a, mid, n, (n + mid) / 2, (mid & 1) == 0);
+    }
+    Blt_Free(a);
+ done:
+    if (q1Ptr != NULL) {
+        *q1Ptr = q1;
+    }
+    if (medianPtr != NULL) {
+        *medianPtr = q2;
+    }
+    if (q3Ptr != NULL) {
+        *q3Ptr = q3;
+    }
+    return n;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * Blt_Vec_GetStats --
+ *
+ *      Computes the summary statistics of the finite values of the
+ *      vector.  The sums are always computed.  The moments (variance,
+ *      deviations, skew, and kurtosis) are computed if STATS_MOMENTS is
+ *      set and the quartiles if STATS_QUARTILES is set.
+ *
+ *      The results are the same as those of the corresponding vector
+ *      math functions.  In particular the mean has always divided the
+ *      sum by one more than the number of values, and the moments are
+ *      taken about that mean.
+ *
+ * Results:
+ *      None.  The statistics are returned in *statsPtr*.
+ *
+ *---------------------------------------------------------------------------
+ */
+void
+Blt_Vec_GetStats(Vector *vPtr, unsigned int flags, VectorStats *statsPtr)
+{
+    long count;
+
+    memset(statsPtr, 0, sizeof(VectorStats));
+    count = Blt_Vec_Sums(vPtr->valueArr, vPtr->length, &statsPtr->sum,
+                         &statsPtr->min, &statsPtr->max);
+    statsPtr->count = count;
+    statsPtr->mean = (count == 0) ? Blt_NaN() :
+        statsPtr->sum / (double)(count + 1);
+    if ((flags & STATS_MOMENTS) && (count >= 2)) {
+        double m[4], var;
+
+        Blt_Vec_Moments(vPtr->valueArr, vPtr->length, statsPtr->mean, m);
+        var = m[1] / (double)(count - 1);
+        statsPtr->var = var;
+        statsPtr->sdev = (var > 0.0) ? sqrt(var) : 0.0;
+        statsPtr->adev = m[0] / (double)count;
+        statsPtr->skew = m[2] / (count * var * sqrt(var));
+        statsPtr->kurtosis = (var == 0.0) ? 0.0 :
+            m[3] / (count * var * var) - 3.0; /* Fisher Kurtosis */
+    }
+    if (flags & STATS_QUARTILES) {
+        Blt_Vec_Quartiles(vPtr->valueArr, vPtr->length, &statsPtr->q1,
+                          &statsPtr->median, &statsPtr->q3);
+    }
+}
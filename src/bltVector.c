@@ -53,6 +53,7 @@
  *              x notify reorder #1 #2
  */
 
+#define _GNU_SOURCE                     /* For mremap. */
 #include "bltVecInt.h"
 
 #ifdef HAVE_STDLIB_H
@@ -78,6 +79,12 @@
   #endif /* HAVE_SYS_TIME_H */
 #endif /* TIME_WITH_SYS_TIME */
 
+#include <limits.h>
+
+#ifdef HAVE_SYS_MMAN_H
+  #include <sys/mman.h>
+#endif /* HAVE_SYS_MMAN_H */
+
 #include "bltAlloc.h"
 #include <bltMath.h>
 #include "bltNsUtil.h"
@@ -90,6 +97,20 @@
 #endif
 
 #define DEF_ARRAY_SIZE          64
+
+/* 
+ * Arrays of VECTOR_HUGE_SIZE or more values are grown by a quarter
+ * (rounded up to VECTOR_GROWTH_CHUNK values) instead of being doubled.
+ * Where mremap is available, they are also mapped instead of malloc-ed,
+ * so that growing them moves pages rather than copying values.
+ */
+#define VECTOR_HUGE_SIZE        (1L<<22)        /* 32 MB of values. */
+#define VECTOR_GROWTH_CHUNK     (1L<<18)        /* 2 MB of values. */
+#define VECTOR_MAX_SIZE         ((long)(LONG_MAX / sizeof(double)))
+
+#if defined(HAVE_SYS_MMAN_H) && defined(MREMAP_MAYMOVE)
+  #define HAVE_MREMAP 1
+#endif /* HAVE_SYS_MMAN_H && MREMAP_MAYMOVE */
 #define TRACE_ALL  (TCL_TRACE_WRITES | TCL_TRACE_READS | TCL_TRACE_UNSETS)
 
 
@@ -134,10 +155,20 @@ typedef struct {
     const char *cmdName;                /* Requested command name. */
     int flush;                          /* Flush */
     int watchUnset;                     /* Watch when variable is unset. */
-    int size;
-    int first, last;
+    long size;
+    long first, last;
+    const char *fileName;               /* File to map as the values. */
+    int format;                         /* Format of the values in the
+                                         * file. */
+    long offset;                        /* Byte offset of the values in
+                                         * the file. */
 } CreateSwitches;
 
+static Blt_SwitchParseProc ObjToFormat;
+static Blt_SwitchCustom formatSwitch = {
+    ObjToFormat, NULL, NULL, (ClientData)0
+};
+
 static Blt_SwitchSpec createSwitches[] = 
 {
     {BLT_SWITCH_STRING, "-variable", "varName", (char *)NULL,
@@ -150,6 +181,12 @@ static Blt_SwitchSpec createSwitches[] =
         Blt_Offset(CreateSwitches, flush), 0},
     {BLT_SWITCH_LONG_POS, "-length", "length", (char *)NULL,
         Blt_Offset(CreateSwitches, size), 0},
+    {BLT_SWITCH_STRING, "-mmap", "fileName", (char *)NULL,
+        Blt_Offset(CreateSwitches, fileName), 0},
+    {BLT_SWITCH_CUSTOM, "-format", "float64|float32|int16", (char *)NULL,
+        Blt_Offset(CreateSwitches, format), 0, 0, &formatSwitch},
+    {BLT_SWITCH_LONG_NNEG, "-offset", "numBytes", (char *)NULL,
+        Blt_Offset(CreateSwitches, offset), 0},
     {BLT_SWITCH_END}
 };
 
@@ -221,21 +258,10 @@ GetVectorObject(
 void
 Blt_Vec_UpdateRange(Vector *vPtr)
 {
-    double min, max;
-    double *vp, *vend;
-
-    vp = vPtr->valueArr + vPtr->first;
-    vend = vPtr->valueArr + vPtr->last;
-    min = max = *vp++;
-    for (/* empty */; vp < vend; vp++) {
-        if (min > *vp) {
-            min = *vp; 
-        } else if (max < *vp) { 
-            max = *vp; 
-        } 
-    } 
-    vPtr->min = min;
-    vPtr->max = max;
+    double sum;
+
+    Blt_Vec_Sums(vPtr->valueArr + vPtr->first, vPtr->last - vPtr->first, 
+        &sum, &vPtr->min, &vPtr->max);
     vPtr->notifyFlags &= ~UPDATE_RANGE;
 }
 
@@ -291,10 +317,10 @@ Blt_Vec_GetSpecialIndex(Tcl_Interp *interp, Vector *vPtr, const char *string,
  */
 int
 Blt_Vec_GetIndex(Tcl_Interp *interp, Vector *vPtr, const char *string,
-                 int *indexPtr)
+                 long *indexPtr)
 {
     char c;
-    int index;
+    long index;
     
     c = string[0];
 
@@ -312,16 +338,15 @@ Blt_Vec_GetIndex(Tcl_Interp *interp, Vector *vPtr, const char *string,
         return TCL_OK;
     }
     /* Try to process the index as a number. May be negative. */
-    if (Tcl_GetInt(interp, string, &index) != TCL_OK) {
-        long lval;
+    if (Blt_GetLong(interp, string, &index) != TCL_OK) {
         /*   
          * Try to process the index as a numeric expression. 
          *
-         * Unlike Tcl_GetInt, Tcl_ExprLong needs a valid interpreter, but
+         * Unlike Blt_GetLong, Tcl_ExprLong needs a valid interpreter, but
          * the interp passed in may be NULL.  So we have to use
          * vPtr->interp and then reset the result.
          */
-        if (Tcl_ExprLong(vPtr->interp, (char *)string, &lval) != TCL_OK) {
+        if (Tcl_ExprLong(vPtr->interp, (char *)string, &index) != TCL_OK) {
             Tcl_ResetResult(vPtr->interp);
             if (interp != NULL) {
                 Tcl_AppendResult(interp, "bad index \"", string, "\"", 
@@ -329,7 +354,6 @@ Blt_Vec_GetIndex(Tcl_Interp *interp, Vector *vPtr, const char *string,
             }
             return TCL_ERROR;
         }
-        index = lval;
     }
     /*
      * Correct the index by the current value of the offset. This makes all
@@ -380,7 +404,7 @@ Blt_Vec_GetRange(Tcl_Interp *interp, Vector *vPtr, const char *string)
                                          * index is defaults to 0. */
         } else {
             int result;
-            int index;
+            long index;
 
             *colon = '\0';
             result = Blt_Vec_GetIndex(interp, vPtr, string, &index);
@@ -394,7 +418,7 @@ Blt_Vec_GetRange(Tcl_Interp *interp, Vector *vPtr, const char *string)
             /* Default to the last index */
             vPtr->last = vPtr->length;
         } else {
-            int index;
+            long index;
 
             if (Blt_Vec_GetIndex(interp, vPtr, colon + 1, &index) != TCL_OK) {
                 return TCL_ERROR;
@@ -412,7 +436,7 @@ Blt_Vec_GetRange(Tcl_Interp *interp, Vector *vPtr, const char *string)
         vPtr->first = 0;
         vPtr->last = vPtr->length;
     } else {
-        int index;
+        long index;
 
         if (Blt_Vec_GetIndex(interp, vPtr, string, &index) != TCL_OK) {
             return TCL_ERROR;
@@ -673,54 +697,20 @@ Blt_Vec_Find(VectorCmdInterpData *dataPtr, const char *vecName,
 double
 Blt_Vec_Min(Vector *vPtr)
 {
-    long i;
-    double min;
+    double sum, max;
 
-    for (i = vPtr->first; i < vPtr->last; i++) {
-        if (FINITE(vPtr->valueArr[i])) {
-            break;
-        }
-    }
-    if (i == vPtr->last) {
-        return Blt_NaN();
-    }
-    min = vPtr->valueArr[i];
-    for (/* empty */; i < vPtr->last; i++) {
-        if (!FINITE(vPtr->valueArr[i])) {
-            continue;
-        }
-        if (min > vPtr->valueArr[i]) {
-            min = vPtr->valueArr[i]; 
-        } 
-    } 
-    vPtr->min = min;
+    Blt_Vec_Sums(vPtr->valueArr + vPtr->first, vPtr->last - vPtr->first, 
+        &sum, &vPtr->min, &max);
     return vPtr->min;
 }
 
 double
 Blt_Vec_Max(Vector *vPtr)
 {
-    long i;
-    double max;
+    double sum, min;
 
-    for (i = vPtr->first; i < vPtr->last; i++) {
-        if (FINITE(vPtr->valueArr[i])) {
-            break;
-        }
-    }
-    if (i == vPtr->last) {
-        return Blt_NaN();
-    }
-    max = vPtr->valueArr[i];
-    for (/* empty */; i < vPtr->last; i++) {
-        if (!FINITE(vPtr->valueArr[i])) {
-            continue;
-        }
-        if (max < vPtr->valueArr[i]) {
-            max = vPtr->valueArr[i]; 
-        } 
-    } 
-    vPtr->max = max;
+    Blt_Vec_Sums(vPtr->valueArr + vPtr->first, vPtr->last - vPtr->first, 
+        &sum, &min, &vPtr->max);
     return vPtr->max;
 }
 
@@ -878,6 +868,91 @@ Blt_Vec_MapVariable(
     return TCL_OK;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FreeValues --
+ *
+ *      Releases the vector's array of values, according to how it was
+ *      allocated.
+ *
+ *---------------------------------------------------------------------------
+ */
+static void
+FreeValues(Vector *vPtr)
+{
+    if ((vPtr->valueArr == NULL) || (vPtr->freeProc == TCL_STATIC)) {
+        return;
+    }
+    if (vPtr->freeProc == TCL_DYNAMIC) {
+        Blt_Free(vPtr->valueArr);
+#ifdef HAVE_SYS_MMAN_H
+    } else if (vPtr->freeProc == VECTOR_MAPPED) {
+        munmap(vPtr->valueArr, vPtr->mapSize);
+        vPtr->mapSize = 0;
+#endif /* HAVE_SYS_MMAN_H */
+    } else if (vPtr->freeProc == VECTOR_FILE_MAPPED) {
+        Blt_Vec_UnmapFile(vPtr);
+    } else {
+        (*vPtr->freeProc) ((char *)vPtr->valueArr);
+    }
+}
+
+#ifdef HAVE_MREMAP
+/*
+ *---------------------------------------------------------------------------
+ *
+ * MapValues --
+ *
+ *      Resizes the array of values of a huge vector using anonymous memory
+ *      maps.  An array that is already mapped is resized with mremap,
+ *      which moves the pages of the array instead of copying the values.
+ *      Otherwise a new mapping is made and the values are copied into it.
+ *
+ * Results:
+ *      A standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+static int
+MapValues(Tcl_Interp *interp, Vector *vPtr, long newSize)
+{
+    size_t numBytes;
+    void *newArr;
+
+    numBytes = (size_t)newSize * sizeof(double);
+    if (vPtr->freeProc == VECTOR_MAPPED) {
+        newArr = mremap(vPtr->valueArr, vPtr->mapSize, numBytes, 
+                MREMAP_MAYMOVE);
+    } else {
+        newArr = mmap(NULL, numBytes, PROT_READ | PROT_WRITE, 
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (newArr == MAP_FAILED) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "can't map ", Blt_Ltoa(newSize), 
+                " elements for vector \"", vPtr->name, "\": ", 
+                Tcl_PosixError(interp), (char *)NULL); 
+        }
+        return TCL_ERROR;
+    }
+    if (vPtr->freeProc != VECTOR_MAPPED) {
+        long used;
+
+        used = MIN(vPtr->length, newSize);
+        if (used > 0) {
+            memcpy(newArr, vPtr->valueArr, used * sizeof(double));
+        }
+        FreeValues(vPtr);
+        vPtr->freeProc = VECTOR_MAPPED;
+    }
+    vPtr->valueArr = newArr;
+    vPtr->mapSize = numBytes;
+    vPtr->size = newSize;
+    return TCL_OK;
+}
+#endif /* HAVE_MREMAP */
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -901,7 +976,7 @@ Blt_Vec_MapVariable(
  *---------------------------------------------------------------------------
  */
 int
-Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, int newSize)
+Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, long newSize)
 {
     if (newSize == 0) {
         newSize = DEF_ARRAY_SIZE;
@@ -910,6 +985,19 @@ Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, int newSize)
         /* Same size, use the current array. */
         return TCL_OK;
     } 
+    if ((newSize < 0) || (newSize > VECTOR_MAX_SIZE)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "bad size \"", Blt_Ltoa(newSize), 
+                "\" for vector \"", vPtr->name, "\"", (char *)NULL); 
+        }
+        return TCL_ERROR;
+    }
+#ifdef HAVE_MREMAP
+    if ((newSize >= VECTOR_HUGE_SIZE) && 
+        ((vPtr->freeProc == TCL_DYNAMIC) || (vPtr->freeProc == VECTOR_MAPPED))) {
+        return MapValues(interp, vPtr, newSize);
+    }
+#endif /* HAVE_MREMAP */
     if (vPtr->freeProc == TCL_DYNAMIC) {
         double *newArr;
 
@@ -931,8 +1019,9 @@ Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, int newSize)
     {
         double *newArr;
 
-        /* Old memory was created specially (static or special allocator).
-         * Replace with dynamically allocated memory (malloc-ed). */
+        /* Old memory was created specially (static, mapped, or special
+         * allocator).  Replace with dynamically allocated memory
+         * (malloc-ed). */
 
         newArr = Blt_Calloc(newSize, sizeof(double));
         if (newArr == NULL) {
@@ -944,7 +1033,7 @@ Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, int newSize)
             return TCL_ERROR;
         }
         {
-            int used, wanted;
+            long used, wanted;
             
             /* Copy the contents of the old memory into the new. */
             used = vPtr->length;
@@ -967,13 +1056,7 @@ Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, int newSize)
          * vector with a statically allocated array (setting freeProc to
          * TCL_STATIC).
          */
-        if (vPtr->freeProc != TCL_STATIC) {
-            if (vPtr->freeProc == TCL_DYNAMIC) {
-                Blt_Free(vPtr->valueArr);
-            } else {
-                (*vPtr->freeProc) ((char *)vPtr->valueArr);
-            }
-        }
+        FreeValues(vPtr);
         vPtr->freeProc = TCL_DYNAMIC;   /* Set the type of the new
                                          * storage */
         vPtr->valueArr = newArr;
@@ -1001,7 +1084,7 @@ Blt_Vec_SetSize(Tcl_Interp *interp, Vector *vPtr, int newSize)
  *---------------------------------------------------------------------------
  */
 int
-Blt_Vec_SetLength(Tcl_Interp *interp, Vector *vPtr, int newLength)
+Blt_Vec_SetLength(Tcl_Interp *interp, Vector *vPtr, long newLength)
 {
     if (vPtr->size < newLength) {
         if (Blt_Vec_SetSize(interp, vPtr, newLength) != TCL_OK) {
@@ -1032,7 +1115,8 @@ Blt_Vec_SetLength(Tcl_Interp *interp, Vector *vPtr, int newLength)
  *
  *      The new size of the vector is computed by doubling the size of the
  *      vector until it fits the number of slots needed (designated by
- *      *length*).
+ *      *length*).  Huge vectors grow by a quarter of their size instead,
+ *      so that they don't overshoot by gigabytes.
  *
  *      If the new size is the same as the old, simply adjust the length of
  *      the vector.  Otherwise we're copying the data from one memory
@@ -1053,19 +1137,35 @@ Blt_Vec_SetLength(Tcl_Interp *interp, Vector *vPtr, int newLength)
  */
 
 int
-Blt_Vec_ChangeLength(Tcl_Interp *interp, Vector *vPtr, int newLength)
+Blt_Vec_ChangeLength(Tcl_Interp *interp, Vector *vPtr, long newLength)
 {
     double emptyValue;
     long i;
 
+    if ((newLength < 0) || (newLength > VECTOR_MAX_SIZE)) {
+        if (interp != NULL) {
+            Tcl_AppendResult(interp, "bad length \"", Blt_Ltoa(newLength), 
+                "\" for vector \"", vPtr->name, "\"", (char *)NULL); 
+        }
+        return TCL_ERROR;
+    }
     if (newLength > vPtr->size) {
-        int newSize;                    /* Size of array in elements */
+        long newSize;                   /* Size of array in elements */
     
-        /* Compute the new size of the array.  It's a multiple of
-         * DEF_ARRAY_SIZE. */
-        newSize = DEF_ARRAY_SIZE;
-        while (newSize < newLength) {
-            newSize += newSize;
+        if (newLength < VECTOR_HUGE_SIZE) {
+            /* Compute the new size of the array.  It's a multiple of
+             * DEF_ARRAY_SIZE. */
+            newSize = DEF_ARRAY_SIZE;
+            while (newSize < newLength) {
+                newSize += newSize;
+            }
+        } else {
+            newSize = MAX(newLength, vPtr->size + vPtr->size / 4);
+            newSize = ((newSize + VECTOR_GROWTH_CHUNK - 1) / 
+                       VECTOR_GROWTH_CHUNK) * VECTOR_GROWTH_CHUNK;
+            if (newSize > VECTOR_MAX_SIZE) {
+                newSize = newLength;
+            }
         }
         if (newSize != vPtr->size) {
             if (Blt_Vec_SetSize(interp, vPtr, newSize) != TCL_OK) {
@@ -1112,9 +1212,9 @@ Blt_Vec_Reset(
                                          * the vector. If NULL, indicates
                                          * to reset the vector size to the
                                          * default. */
-    int length,                         /* # of elements that the vector
+    long length,                        /* # of elements that the vector
                                          * currently holds. */
-    int size,                           /* The # of elements that the
+    long size,                          /* The # of elements that the
                                          * array can hold. */
     Tcl_FreeProc *freeProc)             /* Address of memory deallocation
                                          * routine for the array of values.
@@ -1153,15 +1253,8 @@ Blt_Vec_Reset(
             freeProc = TCL_DYNAMIC;
         } 
 
-        if (vPtr->freeProc != TCL_STATIC) {
-            /* Old data was dynamically allocated. Free it before attaching
-             * new data.  */
-            if (vPtr->freeProc == TCL_DYNAMIC) {
-                Blt_Free(vPtr->valueArr);
-            } else {
-                (*freeProc) ((char *)vPtr->valueArr);
-            }
-        }
+        /* Free the old data before attaching new data.  */
+        FreeValues(vPtr);
         vPtr->freeProc = freeProc;
         vPtr->valueArr = valueArr;
     }
@@ -1250,13 +1343,7 @@ Blt_Vec_Free(Vector *vPtr)
         Blt_Free(clientPtr);
     }
     Blt_Chain_Destroy(vPtr->chain);
-    if ((vPtr->valueArr != NULL) && (vPtr->freeProc != TCL_STATIC)) {
-        if (vPtr->freeProc == TCL_DYNAMIC) {
-            Blt_Free(vPtr->valueArr);
-        } else {
-            (*vPtr->freeProc) ((char *)vPtr->valueArr);
-        }
-    }
+    FreeValues(vPtr);
     if (vPtr->hashPtr != NULL) {
         Blt_DeleteHashEntry(&vPtr->dataPtr->vectorTable, vPtr->hashPtr);
     }
@@ -1430,8 +1517,8 @@ Blt_Vec_Create(
 int
 Blt_Vec_Duplicate(Vector *destPtr, Vector *srcPtr)
 {
-    int numBytes;
-    int length;
+    size_t numBytes;
+    long length;
     
     if (destPtr == srcPtr) {
         /* Copying the same vector. */
@@ -1499,6 +1586,47 @@ VectorNamesOp(ClientData clientData, Tcl_Interp *interp, int objc,
     return TCL_OK;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * ObjToFormat --
+ *
+ *      Converts the name of the format of the values in a mapped file.
+ *
+ * Results:
+ *      The return value is a standard TCL result.
+ *
+ *---------------------------------------------------------------------------
+ */
+/*ARGSUSED*/
+static int
+ObjToFormat(
+    ClientData clientData,              /* Not used. */
+    Tcl_Interp *interp,                 /* Interpreter to report results */
+    const char *switchName,             /* Not used. */
+    Tcl_Obj *objPtr,                    /* Name of format. */
+    char *record,                       /* Structure record */
+    int offset,                         /* Offset to field in structure */
+    int flags)                          /* Not used. */
+{
+    int *formatPtr = (int *)(record + offset);
+    const char *string;
+
+    string = Tcl_GetString(objPtr);
+    if (strcmp(string, "float64") == 0) {
+        *formatPtr = VECTOR_FORMAT_FLOAT64;
+    } else if (strcmp(string, "float32") == 0) {
+        *formatPtr = VECTOR_FORMAT_FLOAT32;
+    } else if (strcmp(string, "int16") == 0) {
+        *formatPtr = VECTOR_FORMAT_INT16;
+    } else {
+        Tcl_AppendResult(interp, "unknown format \"", string, 
+                "\": should be float64, float32, or int16", (char *)NULL);
+        return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -1571,12 +1699,18 @@ OldVectorCreate(ClientData clientData, Tcl_Interp *interp, int argStart,
                 (char *)NULL);
             goto error;
         }
+        if (switches.fileName != NULL) {
+            Tcl_AppendResult(interp,
+                "can't specify more than one vector with \"-mmap\" switch",
+                (char *)NULL);
+            goto error;
+        }
     }
     for (i = 0; i < count; i++) {
         char *leftParen, *rightParen;
         char *string;
         int isNew;
-        int size, first, last;
+        long size, first, last;
 
         size = first = last = 0;
         string = Tcl_GetString(objv[i + argStart]);
@@ -1599,9 +1733,9 @@ OldVectorCreate(ClientData clientData, Tcl_Interp *interp, int argStart,
 
                 /* Specification is in the form vecName(first:last) */
                 *colon = '\0';
-                result = Tcl_GetInt(interp, leftParen+1, &first);
+                result = Blt_GetLong(interp, leftParen+1, &first);
                 if ((*(colon + 1) != '\0') && (result == TCL_OK)) {
-                    result = Tcl_GetInt(interp, colon + 1, &last);
+                    result = Blt_GetLong(interp, colon + 1, &last);
                     if (first >= last) {
                         Tcl_AppendResult(interp, "bad vector range \"",
                             string, "\"", (char *)NULL);
@@ -1612,7 +1746,7 @@ OldVectorCreate(ClientData clientData, Tcl_Interp *interp, int argStart,
                 *colon = ':';
             } else {
                 /* Specification is in the form vecName(size) */
-                result = Tcl_GetInt(interp, leftParen + 1, &size);
+                result = Blt_GetLong(interp, leftParen + 1, &size);
             }
             *rightParen = ')';
             if (result != TCL_OK) {
@@ -1635,7 +1769,12 @@ OldVectorCreate(ClientData clientData, Tcl_Interp *interp, int argStart,
         vPtr->freeOnUnset = switches.watchUnset;
         vPtr->flush = switches.flush;
         vPtr->offset = first;
-        if (size > 0) {
+        if (switches.fileName != NULL) {
+            if (Blt_Vec_MapFile(interp, vPtr, switches.fileName, 
+                switches.format, switches.offset, switches.size) != TCL_OK) {
+                goto error;
+            }
+        } else if (size > 0) {
             if (Blt_Vec_ChangeLength(interp, vPtr, size) != TCL_OK) {
                 goto error;
             }
@@ -1831,10 +1970,16 @@ VectorCreateOp(ClientData clientData, Tcl_Interp *interp, int objc,
         }
         varName = Blt_MakeQualifiedName(&objName, &ds3);
     } 
+    vPtr = Blt_Vec_New(dataPtr);
+    if ((switches.fileName != NULL) &&
+        (Blt_Vec_MapFile(interp, vPtr, switches.fileName, switches.format,
+                switches.offset, switches.size) != TCL_OK)) {
+        Blt_Vec_Free(vPtr);
+        goto error;
+    }
     /* By default, the TCL command is the name of the vector. */
     hPtr = Blt_CreateHashEntry(&dataPtr->vectorTable, qualName, &isNew);
     assert(isNew);
-    vPtr = Blt_Vec_New(dataPtr);
     vPtr->hashPtr = hPtr;
     vPtr->nsPtr = objName.nsPtr;
 
@@ -1852,7 +1997,7 @@ VectorCreateOp(ClientData clientData, Tcl_Interp *interp, int objc,
     vPtr->freeOnUnset = switches.watchUnset;
     vPtr->flush = switches.flush;
     vPtr->offset = 0;
-    if (switches.size > 0) {
+    if ((switches.fileName == NULL) && (switches.size > 0)) {
         if (Blt_Vec_ChangeLength(interp, vPtr, switches.size) != TCL_OK) {
             goto error;
         }
@@ -1924,7 +2069,7 @@ static int
 VectorExprOp(ClientData clientData, Tcl_Interp *interp, int objc,
              Tcl_Obj *const *objv)
 {
-    return Blt_ExprVector(interp, Tcl_GetString(objv[2]), (Blt_Vector *)NULL);
+    return Blt_Vec_ExprObj(interp, objv[2], (Vector *)NULL);
 }
 
 static Blt_OpSpec vectorCmdOps[] =
@@ -2015,6 +2160,7 @@ VectorInterpDeleteProc(ClientData clientData, Tcl_Interp *interp)
     Blt_DeleteHashTable(&dataPtr->mathProcTable);
 
     Blt_DeleteHashTable(&dataPtr->indexProcTable);
+    Blt_Vec_FreeFftPlans(dataPtr);
     Tcl_DeleteAssocData(interp, VECTOR_THREAD_KEY);
     Blt_Free(dataPtr);
 }
@@ -2031,13 +2177,18 @@ Blt_Vec_GetInterpData(Tcl_Interp *interp)
         dataPtr = Blt_AssertMalloc(sizeof(VectorCmdInterpData));
         dataPtr->interp = interp;
         dataPtr->nextId = 0;
+        dataPtr->nextFftId = 0;
         Tcl_SetAssocData(interp, VECTOR_THREAD_KEY, VectorInterpDeleteProc,
                  dataPtr);
         Blt_InitHashTable(&dataPtr->vectorTable, BLT_STRING_KEYS);
         Blt_InitHashTable(&dataPtr->mathProcTable, BLT_STRING_KEYS);
         Blt_InitHashTable(&dataPtr->indexProcTable, BLT_STRING_KEYS);
+        Blt_InitHashTable(&dataPtr->fftPlanTable, BLT_ONE_WORD_KEYS);
+        Blt_InitHashTable(&dataPtr->fftNameTable, BLT_STRING_KEYS);
         Blt_Vec_InstallMathFunctions(&dataPtr->mathProcTable);
         Blt_Vec_InstallSpecialIndices(&dataPtr->indexProcTable);
+        Blt_Vec_InitStatsProcs();
+        Blt_Vec_InitFftProcs();
 #ifdef HAVE_SRAND48
         srand48(time((time_t *) NULL));
 #endif
@@ -2156,12 +2307,14 @@ SimplifyCmd(ClientData clientData, Tcl_Interp *interp, int objc,
 int
 Blt_VectorCmdInitProc(Tcl_Interp *interp)
 {
-    static Blt_CmdSpec cmdSpecs[2] = {
+    static Blt_CmdSpec cmdSpecs[3] = {
         {"vector", VectorCmd },
-        {"simplify", SimplifyCmd }
+        {"simplify", SimplifyCmd },
+        {"fft", Blt_Vec_FftCmd }
     };
     cmdSpecs[0].clientData = Blt_Vec_GetInterpData(interp);
-    return Blt_InitCmds(interp, "::blt", cmdSpecs, 2);
+    cmdSpecs[2].clientData = cmdSpecs[0].clientData;
+    return Blt_InitCmds(interp, "::blt", cmdSpecs, 3);
 }
 
 
@@ -2192,7 +2345,7 @@ int
 Blt_CreateVector2(
     Tcl_Interp *interp,
     const char *vecName, const char *cmdName, const char *varName,
-    int initialSize,
+    long initialSize,
     Blt_Vector **vecPtrPtr)
 {
     VectorCmdInterpData *dataPtr;       /* Interpreter-specific data. */
@@ -2221,7 +2374,7 @@ Blt_CreateVector2(
 }
 
 int
-Blt_CreateVector(Tcl_Interp *interp, const char *name, int size,
+Blt_CreateVector(Tcl_Interp *interp, const char *name, long size,
                  Blt_Vector **vecPtrPtr)
 {
     return Blt_CreateVector2(interp, name, name, name, size, vecPtrPtr);
@@ -2455,9 +2608,9 @@ Blt_ResetVector(
     double *valueArr,                   /* Array containing the elements of
                                          * the vector. If NULL, indicates
                                          * to reset the vector.*/
-    int length,                         /* The number of elements that the
+    long length,                        /* The number of elements that the
                                          * vector currently holds. */
-    int size,                           /* The maximum number of elements
+    long size,                          /* The maximum number of elements
                                          * that the array can hold. */
     Tcl_FreeProc *freeProc)             /* Address of memory deallocation
                                          * routine for the array of values.
@@ -2488,7 +2641,7 @@ Blt_ResetVector(
  *---------------------------------------------------------------------------
  */
 int
-Blt_ResizeVector(Blt_Vector *vecPtr, int length)
+Blt_ResizeVector(Blt_Vector *vecPtr, long length)
 {
     Vector *vPtr = (Vector *)vecPtr;
 
@@ -53,8 +53,8 @@ typedef void (Blt_VectorChangedProc)(Tcl_Interp *interp, ClientData clientData,
 typedef struct {
     double *valueArr;                   /* Array of values (possibly
                                          * malloc-ed) */
-    int numValues;                      /* Number of values in the array */
-    int arraySize;                      /* Size of the allocated space */
+    long numValues;                     /* Number of values in the array */
+    long arraySize;                     /* Size of the allocated space */
     double min, max;                    /* Minimum and maximum values in
                                          * the vector */
     int dirty;                          /* Indicates if the vector has been
@@ -114,10 +114,10 @@ BLT_EXTERN const char *Blt_NameOfVector(Blt_Vector *vecPtr);
 BLT_EXTERN int Blt_VectorNotifyPending(Blt_VectorId clientId);
 
 BLT_EXTERN int Blt_CreateVector(Tcl_Interp *interp, const char *vecName, 
-        int size, Blt_Vector ** vecPtrPtr);
+        long size, Blt_Vector ** vecPtrPtr);
 
 BLT_EXTERN int Blt_CreateVector2(Tcl_Interp *interp, const char *vecName, 
-        const char *cmdName, const char *varName, int initialSize, 
+        const char *cmdName, const char *varName, long initialSize, 
         Blt_Vector **vecPtrPtr);
 
 BLT_EXTERN int Blt_GetVector(Tcl_Interp *interp, const char *vecName, 
@@ -128,10 +128,10 @@ BLT_EXTERN int Blt_GetVectorFromObj(Tcl_Interp *interp, Tcl_Obj *objPtr,
 
 BLT_EXTERN int Blt_VectorExists(Tcl_Interp *interp, const char *vecName);
 
-BLT_EXTERN int Blt_ResetVector(Blt_Vector *vecPtr, double *dataArr, int n, 
-        int arraySize, Tcl_FreeProc *freeProc);
+BLT_EXTERN int Blt_ResetVector(Blt_Vector *vecPtr, double *dataArr, long n, 
+        long arraySize, Tcl_FreeProc *freeProc);
 
-BLT_EXTERN int Blt_ResizeVector(Blt_Vector *vecPtr, int n);
+BLT_EXTERN int Blt_ResizeVector(Blt_Vector *vecPtr, long n);
 
 BLT_EXTERN int Blt_DeleteVectorByName(Tcl_Interp *interp, const char *vecName);
 
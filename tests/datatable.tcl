@@ -12,6 +12,7 @@ if [file exists ../library] {
 test datatable.1 {datatable no args} {
     list [catch {blt::datatable} msg] $msg
 } {1 {wrong # args: should be one of...
+  blt::datatable configure ?option value ...?
   blt::datatable create ?tableName?
   blt::datatable destroy ?tableName ...?
   blt::datatable exists tableName
@@ -170,8 +171,10 @@ test datatable.28 {datatable0} {
     } msg] $msg
 } {1 {wrong # args: should be one of...
   datatable0 add tableName ?switches?
+  datatable0 aggregate ?switches?
   datatable0 append rowName columnName ?value ...?
   datatable0 attach tableName
+  datatable0 batch script
   datatable0 column op args...
   datatable0 copy tableName
   datatable0 clear 
@@ -184,6 +187,8 @@ test datatable.28 {datatable0} {
   datatable0 find exprString ?switches?
   datatable0 get rowName columnName ?defValue?
   datatable0 import formatName args...
+  datatable0 index op args...
+  datatable0 join tableName ?switches?
   datatable0 keys ?columnName ...?
   datatable0 lappend rowName columnName ?value ...?
   datatable0 limits ?columnName?
@@ -196,6 +201,7 @@ test datatable.28 {datatable0} {
   datatable0 restore ?switches?
   datatable0 row op args...
   datatable0 set ?rowName columnName value ...?
+  datatable0 snapshot 
   datatable0 sort ?flags ...?
   datatable0 trace op args...
   datatable0 unset ?rowName columnName ...?
@@ -207,8 +213,10 @@ test datatable.29 {datatable0 badOp} {
     } msg] $msg
 } {1 {bad operation "badOp": should be one of...
   datatable0 add tableName ?switches?
+  datatable0 aggregate ?switches?
   datatable0 append rowName columnName ?value ...?
   datatable0 attach tableName
+  datatable0 batch script
   datatable0 column op args...
   datatable0 copy tableName
   datatable0 clear 
@@ -221,6 +229,8 @@ test datatable.29 {datatable0 badOp} {
   datatable0 find exprString ?switches?
   datatable0 get rowName columnName ?defValue?
   datatable0 import formatName args...
+  datatable0 index op args...
+  datatable0 join tableName ?switches?
   datatable0 keys ?columnName ...?
   datatable0 lappend rowName columnName ?value ...?
   datatable0 limits ?columnName?
@@ -233,6 +243,7 @@ test datatable.29 {datatable0 badOp} {
   datatable0 restore ?switches?
   datatable0 row op args...
   datatable0 set ?rowName columnName value ...?
+  datatable0 snapshot 
   datatable0 sort ?flags ...?
   datatable0 trace op args...
   datatable0 unset ?rowName columnName ...?
@@ -250,11 +261,13 @@ test datatable.31 {datatable0 column badOp} {
 	datatable0 column badOp
     } msg] $msg
 } {1 {bad operation "badOp": should be one of...
+  datatable0 column bind columnName ?vecName?
   datatable0 column copy destColumn srcColumn ?switches?
   datatable0 column create ?switches?
   datatable0 column delete ?columnName ...?
   datatable0 column duplicate ?columnName ...?
   datatable0 column empty columnName
+  datatable0 column encoded columnName ?boolean?
   datatable0 column exists columnName
   datatable0 column extend numColumns ?switches?
   datatable0 column get columnName ?switches?
@@ -266,7 +279,9 @@ test datatable.31 {datatable0 column badOp} {
   datatable0 column move destColumn firstColumn lastColumn ?switches?
   datatable0 column names ?pattern ...?
   datatable0 column nonempty columnName
+  datatable0 column packed columnName ?boolean?
   datatable0 column set columnName rowName ?value ...?
+  datatable0 column stats columnName
   datatable0 column tag op args...
   datatable0 column type columnName ?typeName columnName typeName ...?
   datatable0 column unset columnName ?indices ...?
@@ -323,11 +338,13 @@ test datatable.36 {datatable0 numcolumns badArg} {
 test datatable.37 {datatable0 column -label xyz create} {
     list [catch {datatable0 column -label xyz create} msg] $msg
 } {1 {bad operation "-label": should be one of...
+  datatable0 column bind columnName ?vecName?
   datatable0 column copy destColumn srcColumn ?switches?
   datatable0 column create ?switches?
   datatable0 column delete ?columnName ...?
   datatable0 column duplicate ?columnName ...?
   datatable0 column empty columnName
+  datatable0 column encoded columnName ?boolean?
   datatable0 column exists columnName
   datatable0 column extend numColumns ?switches?
   datatable0 column get columnName ?switches?
@@ -339,7 +356,9 @@ test datatable.37 {datatable0 column -label xyz create} {
   datatable0 column move destColumn firstColumn lastColumn ?switches?
   datatable0 column names ?pattern ...?
   datatable0 column nonempty columnName
+  datatable0 column packed columnName ?boolean?
   datatable0 column set columnName rowName ?value ...?
+  datatable0 column stats columnName
   datatable0 column tag op args...
   datatable0 column type columnName ?typeName columnName typeName ...?
   datatable0 column unset columnName ?indices ...?
@@ -3025,6 +3044,7 @@ test datatable.538 {datatable0 dump -badSwitch} {
     list [catch {datatable0 dump -badSwitch} msg] $msg
 } {1 {unknown switch "-badSwitch"
 The following switches are available:
+   -binary 
    -rows rows
    -columns columns
    -file fileName}}
@@ -3215,6 +3235,1654 @@ test datatable.552 {dirtest dir /tmp} {
 "defs","file",420
 }}
 
+test datatable.553 {find compiled typed and string comparisons} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label price -type double
+	$t column create -label qty -type long
+	$t column create -label region -type string
+	$t row extend 4
+	$t row values 0 {150.5 3 EU}
+	$t row values 1 {99 10 US}
+	$t row values 2 {300 7 EU}
+	$t row values 3 {100 1 APAC}
+	set out {}
+	lappend out [$t find { $price > 100 && $region == "EU" }]
+	lappend out [$t find { 5 < $qty || $region eq "APAC" }]
+	lappend out [$t find { !($price >= 100) }]
+	lappend out [$t find { $region < {EU} }]
+	lappend out [$t find { $qty != 7 && $price <= 1e2 } -invert]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{0 2} {1 2 3} 1 3 {0 2}}}
+
+test datatable.554 {find compiled with empty values} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type long
+	$t column create -label s -type string
+	$t row extend 3
+	$t set 0 x 1 0 s a 1 s b 2 x 3
+	set out {}
+	lappend out [$t find { $x > 0 } -emptyvalue 0]
+	lappend out [$t find { $s == "b" || $x >= 3 } -emptyvalue ""]
+	lappend out [catch { $t find { $x > 0 } } msg2] $msg2
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{0 2} {1 2} 1 {can't read "x": no such variable}}}
+
+test datatable.555 {find uncompiled expression with string column} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label s -type string
+	$t row extend 3
+	$t column values s {10 9.0 abc}
+	set out [$t find { $s == 9 || [string match a* $s] }]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {1 2}}
+
+test datatable.556 {index create hash and lookup} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label region -type string
+	$t column create -label qty -type long
+	$t row extend 5
+	$t column values region {EU US EU APAC EU}
+	$t column values qty {3 10 7 1 3}
+	$t index create region
+	$t index create qty -type hash
+	set out {}
+	lappend out [$t index lookup region EU]
+	lappend out [$t index lookup qty 3]
+	$t set 1 region EU 0 region US
+	$t unset 4 region
+	lappend out [$t index lookup region EU]
+	lappend out [$t index lookup region US]
+	$t row delete 2
+	lappend out [$t index lookup region EU]
+	lappend out [$t index names] [$t index type qty]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{0 2 4} {0 4} {1 2} 0 1 {region qty} hash}}
+
+test datatable.557 {index ordered range} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label price -type double
+	$t row extend 6
+	$t column values price {5.5 1.0 3.25 9.0 3.25 7.0}
+	$t index create price -type ordered
+	set out {}
+	lappend out [$t index range price -min 3 -max 7]
+	lappend out [$t index range price -max 3.25]
+	lappend out [$t index lookup price 3.25]
+	$t set 1 price 8.0 
+	$t row extend 1
+	$t set 6 price 0.5
+	lappend out [$t index range price]
+	lappend out [$t index range price -min 7.5]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{2 4 0 5} {1 2 4} {2 4} {6 2 4 0 5 1 3} {1 3}}}
+
+test datatable.558 {index range after many updates} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type long
+	$t row extend 200
+	$t index create x -type ordered
+	for { set i 0 } { $i < 200 } { incr i } {
+	    $t set $i x [expr 199 - $i]
+	}
+	set out [$t index range x -min 10 -max 12]
+	lappend out [$t index type x]
+	$t index delete x
+	lappend out [$t index type x]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {189 188 187 ordered {}}}
+
+test datatable.559 {index errors} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type long
+	set out {}
+	lappend out [catch {$t index range x} msg2] $msg2
+	lappend out [catch {$t index create x -type bad} msg2] $msg2
+	$t index create x
+	lappend out [catch {$t index range x} msg2] $msg2
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {1 {column "x" doesn't have an ordered index} 1 {unknown index type "bad": should be hash or ordered} 1 {column "x" doesn't have an ordered index}}}
+
+test datatable.560 {column packed get and set} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t column create -label n -type int64
+	$t row extend 4
+	$t set 0 x 1.5 1 x 2 3 x -7 0 n 10 2 n -3
+	$t column packed @all 1
+	set out [$t column packed @all]
+	$t set 1 n 99
+	$t unset 0 x
+	lappend out [$t column values x] [$t column values n] [$t get 0 x none]
+	lappend out [$t column packed x]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {1 1 {{} 2.0 {} -7.0} {10 99 -3 {}} none 1}}
+
+test datatable.561 {column packed sort, limits, and find} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type long
+	$t row extend 5
+	$t column packed x 1
+	$t set 0 x 5 1 x -2 3 x 7 4 x 0
+	set out [$t sort -columns x -indices]
+	lappend out [$t limits x]
+	lappend out [$t find {$x > 0} -emptyvalue 0]
+	$t row delete 1
+	$t pack
+	lappend out [$t column values x] [$t column packed x]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {1 4 0 3 2 {-2 7} {0 3} {5 {} 7 0} 1}}
+
+test datatable.562 {column packed conversions} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t column create -label s -type string
+	$t row extend 2
+	$t set 0 x 1 0 s a
+	$t column packed x 1
+	set out {}
+	lappend out [catch {$t column packed s 1} msg2] $msg2
+	lappend out [catch {$t set 1 x abc} msg2] [$t column packed x]
+	$t column type x string
+	lappend out [$t column packed x] [$t column values x]
+	$t column type x double
+	$t column packed x 1
+	$t index create x
+	lappend out [$t column packed x]
+	lappend out [catch {$t column packed x 1} msg2] $msg2
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {1 {can't pack column "s": type "string" isn't numeric} 1 1 0 {1.0 {}} 0 1 {can't pack column "x": column is indexed}}}
+
+test datatable.563 {sort multiple columns with empty values} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t column create -label s -type string
+	$t row extend 7
+	$t set 0 x 2.5 1 x -1 2 x 2.5 3 x -0.0 5 x 1e10 6 x -1
+	$t set 0 s b 1 s a 2 s a 3 s B 4 s abcdefghij 5 s abcdefghiJ 6 s a
+	set out {}
+	lappend out [$t sort -columns {x s} -indices]
+	lappend out [$t sort -columns {x s} -indices -decreasing]
+	lappend out [$t sort -columns x -indices -rows {6 5 4 1 0}]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{1 6 3 2 0 5 4} {4 5 0 2 3 6 1} {1 6 0 5 4}}}
+
+test datatable.564 {sort strings -ascii, -nocase, and -dictionary} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label s -type string
+	$t row extend 7
+	$t set 0 s b 1 s a 2 s a 3 s B 4 s abcdefghij 5 s abcdefghiJ 6 s a
+	set out {}
+	lappend out [$t sort -columns s -indices -ascii]
+	lappend out [$t sort -columns s -indices -ascii -nocase]
+	lappend out [$t sort -columns s -indices]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{3 1 2 6 5 4 0} {1 2 6 4 5 0 3} {1 2 6 5 4 3 0}}}
+
+test datatable.565 {sort -alter with packed column} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label n -type int64
+	$t column create -label s -type string
+	$t row extend 5
+	$t set 0 n 3 1 n -9223372036854775807 2 n 3 4 n 9223372036854775807
+	$t set 0 s c 1 s d 2 s a 3 s e 4 s b
+	$t column packed n 1
+	$t sort -columns n -alter
+	set out [list [$t column values s] [$t column packed n]]
+	lappend out [$t sort -columns n -indices -ascii] [$t column packed n]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{d c a b e} 1 {0 1 2 3 4} 0}}
+
+test datatable.566 {datatable configure -threads} {
+    list [catch {
+	set out [blt::datatable configure]
+	blt::datatable configure -threads 4
+	lappend out [blt::datatable configure -threads]
+	lappend out [catch {blt::datatable configure -threads 0} msg2] $msg2
+	lappend out [catch {blt::datatable configure -bogus} msg2] $msg2
+	blt::datatable configure -threads 1
+	set out
+    } msg] $msg
+} {0 {-threads 1 4 1 {bad value "0": must be positive} 1 {unknown option "-bogus": should be -threads}}}
+
+test datatable.567 {sort, limits, and find are the same with threads} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t column create -label s -type string
+	$t row extend 50000
+	set values {}
+	for {set i 0} {$i < 50000} {incr i} {
+	    lappend values [expr {($i * 7919) % 1000}]
+	}
+	$t column values x $values
+	for {set i 0} {$i < 50000} {incr i 7} {
+	    $t set $i s [lindex {b a c B} [expr {$i % 4}]]
+	}
+	set out {}
+	foreach n {1 3} {
+	    blt::datatable configure -threads $n
+	    lappend out [list \
+		[$t sort -columns {x s} -indices] \
+		[$t sort -columns {s x} -indices -decreasing] \
+		[$t sort -columns s -indices -ascii -nocase] \
+		[$t limits x] \
+		[$t find {$x > 500 && $s == "a"} -emptyvalue z]]
+	}
+	blt::datatable configure -threads 1
+	blt::datatable destroy $t
+	expr {[lindex $out 0] eq [lindex $out 1]}
+    } msg] $msg
+} {0 1}
+
+test datatable.568 {dump -binary and restore} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t column create -label n -type long
+	$t column create -label s -type string
+	$t row create -label alpha -tags {t1 t2}
+	$t row create -label beta
+	$t row create -label gamma
+	$t set alpha x 1.5 alpha n 10 alpha s "hello world"
+	$t set beta x -2.25 beta s {} gamma n 30 gamma s "a longer string value"
+	$t column tag add someTag x
+	$t dump -binary -file tmpdata.snap
+	set t2 [blt::datatable create]
+	$t2 restore -file tmpdata.snap
+	set out [list [$t2 column packed x] [$t2 column packed n] \
+		     [$t2 column type s] [$t2 column values n] \
+		     [expr {[$t dump] eq [$t2 dump]}]]
+	blt::datatable destroy $t $t2
+	set out
+    } msg] $msg
+} {0 {1 1 string {10 {} 30} 1}}
+
+test datatable.569 {change and extend restored snapshot} {
+    list [catch {
+	set t [blt::datatable create]
+	$t restore -file tmpdata.snap
+	$t set beta x 7.5
+	$t row extend 40
+	$t set 42 x 3.0
+	set out [list [$t get beta x] [$t get 42 x] [$t numrows]]
+	set t2 [blt::datatable create]
+	$t2 restore -file tmpdata.snap
+	lappend out [$t2 column values x]
+	blt::datatable destroy $t $t2
+	set out
+    } msg] $msg
+} {0 {7.5 3.0 43 {1.5 -2.25 {}}}}
+
+test datatable.570 {restore snapshot into a table with rows} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row create -label delta
+	$t set delta x 9.0
+	$t restore -file tmpdata.snap -overwrite
+	set out [list [$t row names] [$t column names] [$t column values x]]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{delta alpha beta gamma} {x n s} {9.0 1.5 -2.25 {}}}}
+
+test datatable.571 {dump -binary -rows -columns} {
+    list [catch {
+	set t [blt::datatable create]
+	$t restore -file tmpdata.snap
+	$t dump -binary -file tmpdata.snap -rows {beta gamma} -columns {n s}
+	set t2 [blt::datatable create]
+	$t2 restore -file tmpdata.snap -notags
+	set out [$t2 dump]
+	blt::datatable destroy $t $t2
+	file delete tmpdata.snap
+	set out
+    } msg] $msg
+} {0 {i 2 2 0 0
+c 0 n long {}
+c 1 s string {}
+r 0 beta {}
+r 1 gamma {}
+d 1 0 30
+d 0 1 {}
+d 1 1 {a longer string value}
+}}
+
+test datatable.572 {dump -binary without -file} {
+    list [catch {
+	set t [blt::datatable create]
+	set result [catch {$t dump -binary} msg]
+	blt::datatable destroy $t
+	list $result $msg
+    } msg] $msg
+} {0 {1 {-binary requires the -file switch with a file name}}}
+
+test datatable.573 {import csv -file with quoted fields} {
+    list [catch {
+	set f [open tmpdata.csv "w"]
+	puts -nonewline $f "a, \"x,\ny\" ,b\n  c  ,,\"\"\"q\"\"\"\nlast,row"
+	close $f
+	set t [blt::datatable create]
+	$t import csv -file tmpdata.csv
+	set out [list [$t numrows] [$t row values 0] [$t row values 1] \
+		     [$t row values 2]]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {3 {a {x,
+y } b} {c {} {"q"}} {last row {}}}}
+
+test datatable.574 {import csv -file larger than the read block} {
+    list [catch {
+	set f [open tmpdata.csv "w"]
+	for {set i 0} {$i < 10000} {incr i} {
+	    puts $f "$i,\"value $i\",[expr {$i * 0.5}]"
+	}
+	close $f
+	set t [blt::datatable create]
+	$t import csv -file tmpdata.csv
+	set out [list [$t numrows] [$t numcolumns] [$t row values 4567] \
+		     [$t row values 9999]]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {10000 3 {4567 {value 4567} 2283.5} {9999 {value 9999} 4999.5}}}
+
+test datatable.575 {import csv -infertypes} {
+    list [catch {
+	set t [blt::datatable create]
+	$t import csv -file tmpdata.csv -infertypes
+	set out [list [$t column type 0] [$t column type 1] \
+		     [$t column type 2] [$t get 10 0] [$t get 10 2]]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {long string double 10 5.0}}
+
+test datatable.576 {import csv -infertypes with a later non-number} {
+    list [catch {
+	set f [open tmpdata.csv "a"]
+	puts $f "n/a,x,1e3"
+	close $f
+	set t [blt::datatable create]
+	$t import csv -file tmpdata.csv -infertypes
+	set out [list [$t column type 0] [$t column type 2] \
+		     [$t get 10000 0] [$t get 10000 2]]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {string double n/a 1000.0}}
+
+test datatable.577 {import csv -maxrows} {
+    list [catch {
+	set t [blt::datatable create]
+	$t import csv -file tmpdata.csv -maxrows 5000
+	set n [$t numrows]
+	$t import csv -data "a,b\nc,d\ne,f\n" -maxrows 5002
+	set out [list $n [$t numrows] [$t row values 5001]]
+	blt::datatable destroy $t
+	file delete tmpdata.csv
+	set out
+    } msg] $msg
+} {0 {5000 5002 {c d {}}}}
+
+test datatable.578 {import csv -threads} {
+    list [catch {
+	set data ""
+	for {set i 0} {$i < 5000} {incr i} {
+	    append data "$i,a\n"
+	}
+	append data "# comment\nstart,\"[string repeat "x,y\n" 50000]\",end\n"
+	for {set i 0} {$i < 20000} {incr i} {
+	    append data "$i,\"b\n c\"\"\",NA\n"
+	}
+	set out {}
+	foreach n { 1 4 } {
+	    set t [blt::datatable create]
+	    $t import csv -data $data -threads $n -comment "#" -emptyvalue NA \
+		-infertypes
+	    lappend out [$t numrows] [$t column type 0] [$t get 5000 2] \
+		[$t get 25000 1] [string length [$t get 5000 1]] [$t dump]
+	    blt::datatable destroy $t
+	}
+	list [lrange $out 0 4] [string equal [lindex $out 5] [lindex $out 11]] \
+	    [string equal [lrange $out 0 4] [lrange $out 6 10]]
+    } msg] $msg
+} {0 {{25001 string end {b
+c"} 200000} 1 1}}
+
+test datatable.579 {import csv -threads 0} {
+    list [catch {
+	set t [blt::datatable create]
+	set result [catch {$t import csv -data "a,b\n" -threads 0} msg]
+	blt::datatable destroy $t
+	list $result $msg
+    } msg] $msg
+} {0 {1 {bad value "0": must be positive}}}
+
+test datatable.580 {batch (wrong # args)} {
+    list [catch {
+	set t [blt::datatable create batchTable]
+	set result [catch {$t batch} msg]
+	blt::datatable destroy $t
+	list $result $msg
+    } msg] $msg
+} {0 {1 {wrong # args: should be "::batchTable batch script"}}}
+
+test datatable.581 {batch coalesces cell traces} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x
+	$t row create -label a
+	set ::batchLog {}
+	proc BatchTrace { args } {
+	    lappend ::batchLog [lrange $args 1 end]
+	}
+	set id [$t trace cell @all @all wc BatchTrace]
+	$t batch {
+	    $t set a x 1
+	    $t set a x 2
+	    $t set a x 3
+	    $t row create -label b
+	    $t set b x 5
+	    lappend ::batchLog inside
+	}
+	$t trace delete $id
+	blt::datatable destroy $t
+	set ::batchLog
+    } msg] $msg
+} {0 {inside {0 0 wc} {1 0 wc}}}
+
+test datatable.582 {batch returns the script result} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x
+	$t row create -label a
+	set id [$t trace cell @all @all w BatchTrace]
+	set result [$t batch {
+	    $t set a x 1
+	    string length "batch"
+	}]
+	$t trace delete $id
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 5}
+
+test datatable.583 {batch defers watch events} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x
+	set ::batchLog {}
+	proc BatchWatch { args } {
+	    lappend ::batchLog $args
+	}
+	set id [$t watch row @all -create -delete BatchWatch]
+	$t batch {
+	    $t row create -label a
+	    $t row create -label b
+	    $t row delete b
+	    lappend ::batchLog inside
+	}
+	$t watch delete $id
+	blt::datatable destroy $t
+	set ::batchLog
+    } msg] $msg
+} {0 {inside {-create 0}}}
+
+test datatable.584 {batch delivers traces after an error} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x
+	$t row create -label a
+	set ::batchLog {}
+	set id [$t trace cell @all @all w BatchTrace]
+	set result [catch {
+	    $t batch {
+		$t set a x 1
+		error "batch failed"
+	    }
+	} msg]
+	$t trace delete $id
+	blt::datatable destroy $t
+	list $result $msg $::batchLog
+    } msg] $msg
+} {0 {1 {batch failed} {{0 0 wc}}}}
+
+test datatable.585 {nested batches deliver at the outermost end} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x
+	$t row create -label a
+	set ::batchLog {}
+	set id [$t trace cell @all @all w BatchTrace]
+	$t batch {
+	    $t batch {
+		$t set a x 1
+	    }
+	    lappend ::batchLog inner
+	    $t set a x 2
+	}
+	$t trace delete $id
+	blt::datatable destroy $t
+	set ::batchLog
+    } msg] $msg
+} {0 {inner {0 0 wc}}}
+
+test datatable.586 {column bind (wrong \# args)} {
+    list [catch {
+	datatable0 column bind
+    } msg] $msg
+} {1 {wrong # args: should be "datatable0 column bind columnName ?vecName?"}}
+
+test datatable.587 {column bind returns the vector values} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 3
+	$t set 0 x 1.0 1 x 2.0
+	blt::vector create ::bindVec
+	set name [$t column bind x ::bindVec]
+	set result [list $name [$t column bind x] [::bindVec range 0 end]]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set result
+    } msg] $msg
+} {0 {::bindVec ::bindVec {1.0 2.0 NaN}}}
+
+test datatable.588 {column bind table sets seen by the vector} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 3
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	$t set 2 x 5.5
+	set result [::bindVec range 0 end]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set result
+    } msg] $msg
+} {0 {NaN NaN 5.5}}
+
+test datatable.589 {column bind vector writes flow to the table} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 2
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	set ::bindVec(1) 42
+	::bindVec append 7
+	update
+	set result [list [$t numrows] [$t column values x]]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set result
+    } msg] $msg
+} {0 {3 {{} 42.0 7.0}}}
+
+test datatable.590 {column bind non-double column} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label y -type string
+	blt::vector create ::bindVec
+	set code [catch {$t column bind y ::bindVec} result]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set result
+    } msg] $msg
+} {0 {can't bind column "y": type "string" isn't double}}
+
+test datatable.591 {column bind vector already bound} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t column create -label z -type double
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	set code [catch {$t column bind z ::bindVec} result]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set result
+    } msg] $msg
+} {0 {vector "::bindVec" is already bound to column "x"}}
+
+test datatable.592 {column bind "" unbinds, vector keeps its values} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 2
+	$t set 0 x 3.0 1 x 4.0
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	$t column bind x ""
+	$t set 0 x 9.0
+	set result [list [$t column bind x] [::bindVec range 0 end]]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set result
+    } msg] $msg
+} {0 {{} {3.0 4.0}}}
+
+test datatable.593 {column bind column delete leaves the vector values} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 2
+	$t set 0 x 3.0 1 x 4.0
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	$t column delete x
+	set result [::bindVec range 0 end]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set result
+    } msg] $msg
+} {0 {3.0 4.0}}
+
+test datatable.594 {column stats (wrong \# args)} {
+    list [catch {
+	datatable0 column stats
+    } msg] $msg
+} {1 {wrong # args: should be "datatable0 column stats columnName"}}
+
+test datatable.595 {column stats double column} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 6
+	foreach i {0 1 2 3 4} v {3 1 4 1 5} {
+	    $t set $i x $v
+	}
+	set result [$t column stats x]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {count 5 empty 1 distinct 4 min 1.0 max 5.0 sum 14.0}}
+
+test datatable.596 {column stats string column has no sum} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label s -type string
+	$t row extend 4
+	foreach i {0 1 2 3} v {b a c a} {
+	    $t set $i s $v
+	}
+	set result [$t column stats s]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {count 4 empty 0 distinct 3 min a max c}}
+
+test datatable.597 {column stats updated by set, unset, and row delete} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 4
+	foreach i {0 1 2 3} v {3 1 4 2} {
+	    $t set $i x $v
+	}
+	set result {}
+	lappend result [$t column stats x]
+	$t set 0 x -1
+	lappend result [$t column stats x]
+	$t unset 2 x
+	lappend result [$t column stats x]
+	$t row delete 0
+	lappend result [$t column stats x]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {{count 4 empty 0 distinct 4 min 1.0 max 4.0 sum 10.0} {count 4 empty 0 distinct 4 min -1.0 max 4.0 sum 6.0} {count 3 empty 1 distinct 3 min -1.0 max 2.0 sum 2.0} {count 2 empty 1 distinct 2 min 1.0 max 2.0 sum 3.0}}}
+
+test datatable.598 {column stats packed column} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label n -type long
+	$t row extend 5
+	$t column packed n yes
+	foreach i {0 1 2 3 4} v {7 7 -3 10 7} {
+	    $t set $i n $v
+	}
+	set result [list [$t column stats n] [$t limits n]]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {{count 5 empty 0 distinct 3 min -3 max 10 sum 28.0} {-3 10}}}
+
+test datatable.599 {column stats empty column} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 2
+	set result [$t column stats x]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {count 0 empty 2 distinct 0 min {} max {} sum 0.0}}
+
+proc MakeJoinTables {} {
+    set a [blt::datatable create]
+    $a column create -label id -type long
+    $a column create -label name
+    $a set 0 id 1 0 name a
+    $a set 1 id 2 1 name b
+    $a set 2 id 1 2 name c
+    set b [blt::datatable create]
+    $b column create -label id -type long
+    $b column create -label name
+    $b column create -label score -type double
+    $b set 0 id 1 0 name X 0 score 10.0
+    $b set 1 id 3 1 name Y 1 score 11.0
+    $b set 2 id 1 2 name Z 2 score 12.0
+    return [list $a $b]
+}
+
+test datatable.600 {join (no args)} {
+    list [catch {datatable0 join} msg] $msg
+} {1 {wrong # args: should be "datatable0 join tableName ?switches?"}}
+
+test datatable.601 {join inner} {
+    list [catch {
+	lassign [MakeJoinTables] a b
+	set j [$a join $b -on id]
+	set result [list [$j column labels] [$j export csv]]
+	blt::datatable destroy $a $b $j
+	set result
+    } msg] $msg
+} {0 {{id name name_2 score} {"id","name","name_2","score"
+1,"a","X",10.0
+1,"a","Z",12.0
+1,"c","X",10.0
+1,"c","Z",12.0
+}}}
+
+test datatable.602 {join left with suffix} {
+    list [catch {
+	lassign [MakeJoinTables] a b
+	set j [$a join $b -on id -how left -suffix _b]
+	set result [list [$j column labels] [$j column type score] \
+			[$j export csv]]
+	blt::datatable destroy $a $b $j
+	set result
+    } msg] $msg
+} {0 {{id name name_b score} double {"id","name","name_b","score"
+1,"a","X",10.0
+1,"a","Z",12.0
+2,"b",,
+1,"c","X",10.0
+1,"c","Z",12.0
+}}}
+
+test datatable.603 {join on column pairs} {
+    list [catch {
+	lassign [MakeJoinTables] a b
+	$b set 2 name c
+	set j [$a join $b -on {id {name name}}]
+	set result [list [$j column labels] [$j export csv]]
+	blt::datatable destroy $a $b $j
+	set result
+    } msg] $msg
+} {0 {{id name score} {"id","name","score"
+1,"c",12.0
+}}}
+
+test datatable.604 {join -how badType} {
+    lassign [MakeJoinTables] a b
+    set result [list [catch {$a join $b -on id -how outer} msg] $msg]
+    blt::datatable destroy $a $b
+    set result
+} {1 {bad join type "outer": should be inner or left}}
+
+test datatable.605 {join (no -on switch)} {
+    lassign [MakeJoinTables] a b
+    set result [list [catch {$a join $b} msg] $msg]
+    blt::datatable destroy $a $b
+    set result
+} {1 {no columns to join on: the -on switch is required}}
+
+test datatable.606 {aggregate} {
+    list [catch {
+	lassign [MakeJoinTables] a b
+	$b set 3 id 3 3 name W
+	set g [$b aggregate -by id -sum score -mean score -count name \
+		   -min name -max score]
+	set result [list [$g column labels] [$g export csv]]
+	blt::datatable destroy $a $b $g
+	set result
+    } msg] $msg
+} {0 {{id score_sum score_mean name_count name_min score_max} {"id","score_sum","score_mean","name_count","name_min","score_max"
+1,22.0,11.0,2,"X",12.0
+3,11.0,11.0,2,"W",11.0
+}}}
+
+test datatable.607 {aggregate packed columns} {
+    list [catch {
+	lassign [MakeJoinTables] a b
+	$b column packed id 1
+	$b column packed score 1
+	set g [$b aggregate -by id -sum score -min score]
+	set result [list [$g column packed score_min] [$g export csv]]
+	blt::datatable destroy $a $b $g
+	set result
+    } msg] $msg
+} {0 {1 {"id","score_sum","score_min"
+1,22.0,10.0
+3,11.0,11.0
+}}}
+
+test datatable.608 {aggregate -sum stringColumn} {
+    lassign [MakeJoinTables] a b
+    set result [list [catch {$b aggregate -by id -sum name} msg] $msg]
+    blt::datatable destroy $a $b
+    set result
+} {1 {can't sum column "name": type "string" isn't numeric}}
+
+test datatable.609 {aggregate (no -by switch)} {
+    list [catch {datatable0 aggregate -count 0} msg] $msg
+} {1 {no columns to group by: the -by switch is required}}
+
+proc MakeSnapshotTable {} {
+    set t [blt::datatable create]
+    $t column create -type double -label x
+    $t column create -type string -label name
+    $t row create -label r1
+    $t row create -label r2
+    $t row create -label r3
+    $t set r1 x 1.5 r2 x 2.5 r3 x 3.5
+    $t set r1 name a r2 name b r3 name c
+    return $t
+}
+
+test datatable.610 {snapshot unchanged by later writes} {
+    list [catch {
+	set t [MakeSnapshotTable]
+	$t column packed x 1
+	set s [$t snapshot]
+	$t set r1 x 9.0 r2 name z
+	$t unset r3 x
+	$t row delete r2
+	$t row create -label r4
+	$t set r4 x 4.5
+	set result [list [$s row labels] [$s column values x] \
+			[$s column values name] [$t column values x]]
+	blt::datatable destroy $t $s
+	set result
+    } msg] $msg
+} {0 {{r1 r2 r3} {1.5 2.5 3.5} {a b c} {9.0 {} 4.5}}}
+
+test datatable.611 {snapshot outlives table} {
+    list [catch {
+	set t [MakeSnapshotTable]
+	set s [$t snapshot]
+	blt::datatable destroy $t
+	set result [list [$s column labels] [$s export csv]]
+	blt::datatable destroy $s
+	set result
+    } msg] $msg
+} {0 {{x name} {"x","name"
+1.5,"a"
+2.5,"b"
+3.5,"c"
+}}}
+
+test datatable.612 {snapshot of snapshot} {
+    list [catch {
+	set t [MakeSnapshotTable]
+	set s1 [$t snapshot]
+	set s2 [$s1 snapshot]
+	blt::datatable destroy $s1
+	$t set r2 x 0.0
+	set result [$s2 column values x]
+	blt::datatable destroy $t $s2
+	set result
+    } msg] $msg
+} {0 {1.5 2.5 3.5}}
+
+test datatable.613 {snapshot set (read-only)} {
+    set t [MakeSnapshotTable]
+    set s [$t snapshot]
+    set result [list [catch {$s set r1 x 0.0} msg] [string match *read-only* $msg]]
+    blt::datatable destroy $t $s
+    set result
+} {1 1}
+
+test datatable.614 {snapshot row create (read-only)} {
+    set t [MakeSnapshotTable]
+    set s [$t snapshot]
+    set result [list [catch {$s row create} msg] [string match *read-only* $msg]]
+    blt::datatable destroy $t $s
+    set result
+} {1 1}
+
+test datatable.615 {snapshot badArg} {
+    list [catch {datatable0 snapshot badArg} msg] $msg
+} {1 {wrong # args: should be "datatable0 snapshot "}}
+
+test datatable.616 {values across chunk boundary} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -type string -label s
+	$t row extend 65530
+	$t set 65535 s a 65536 s b
+	$t row delete 0 1 2
+	$t pack
+	set result [list [$t numrows] [$t get 65531 s] [$t get 65532 s] \
+			[$t get 65533 s]]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {65534 {} a b}}
+
+proc MakeEncodedTable {} {
+    set t [blt::datatable create]
+    $t column create -type string -label s
+    $t column create -type long -label n
+    $t row extend 6
+    $t set 0 s pear 1 s apple 2 s Pear 3 s apple 5 s fig
+    $t set 0 n 1 1 n 2 2 n 3 3 n 4 4 n 5 5 n 6
+    $t column encoded s 1
+    return $t
+}
+
+test datatable.617 {column encoded get and set} {
+    list [catch {
+	set t [MakeEncodedTable]
+	set result [list [$t column encoded s] [$t get 0 s] [$t get 4 s -]]
+	$t set 4 s kiwi 0 s plum
+	$t append 3 s sauce
+	$t unset 5 s
+	lappend result [$t column values s]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {1 pear - {plum apple Pear applesauce kiwi {}}}}
+
+test datatable.618 {column encoded sort, aggregate, and join} {
+    list [catch {
+	set t [MakeEncodedTable]
+	set result [list [$t sort -columns s -indices] \
+			[$t sort -columns s -indices -ascii] \
+			[$t sort -columns s -indices -nocase -decreasing]]
+	set g [$t aggregate -by s -sum n]
+	lappend result [$g export csv]
+	set j [$t join $g -on s]
+	lappend result [$j column values n_sum]
+	blt::datatable destroy $t $g $j
+	set result
+    } msg] $msg
+} {0 {{1 3 5 2 0 4} {2 1 3 5 0 4} {4 0 2 5 3 1} {"s","n_sum"
+"pear",1.0
+"apple",6.0
+"Pear",3.0
+,5.0
+"fig",6.0
+} {1.0 6.0 3.0 6.0 6.0}}}
+
+test datatable.619 {column encoded with snapshot and pack} {
+    list [catch {
+	set t [MakeEncodedTable]
+	set s [$t snapshot]
+	$t set 0 s grape
+	$t row delete 1 2
+	$t pack
+	set result [list [$s column values s] [$t column values s] \
+			[$t column encoded s]]
+	$t column encoded s 0
+	lappend result [$t column encoded s] [$t column values s]
+	blt::datatable destroy $t $s
+	set result
+    } msg] $msg
+} {0 {{pear apple Pear apple {} fig} {grape apple {} fig} 1 0 {grape apple {} fig}}}
+
+test datatable.620 {column encoded nonStringColumn} {
+    list [catch {
+	set t [MakeEncodedTable]
+	set result [list [catch {$t column encoded n 1} msg] $msg]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {1 {can't encode column "n": type "long" isn't string}}}
+
+proc MakeTaggedTable {} {
+    set t [blt::datatable create]
+    $t row extend 6
+    $t column extend 1
+    $t row labels {a b c d e f}
+    $t row tag add x 1 3 5
+    return $t
+}
+
+test datatable.621 {row label shared by several rows} {
+    list [catch {
+	set t [MakeTaggedTable]
+	foreach r {0 2 4} {
+	    $t row label $r dup
+	}
+	set result [list [lsort -integer [$t row indices dup]]]
+	$t row label 0 a
+	lappend result [lsort -integer [$t row indices dup]]
+	$t row delete 2
+	lappend result [$t row indices dup] [$t row index dup]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {{0 2 4} {2 4} 3 3}}
+
+test datatable.622 {row tags of deleted rows aren't reused} {
+    list [catch {
+	set t [MakeTaggedTable]
+	$t row delete b d
+	$t row extend 2
+	set result [list [$t row tag indices x] [$t numrows]]
+	foreach r [$t row tag indices x] {
+	    lappend result [$t row label $r]
+	}
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {3 6 f}}
+
+test datatable.623 {row tags after pack} {
+    list [catch {
+	set t [MakeTaggedTable]
+	$t row tag add y 0 1
+	$t row delete a c
+	$t row extend 1
+	$t row tag add y 4
+	$t pack
+	set result {}
+	foreach tag {x y} {
+	    set labels {}
+	    foreach r [$t row tag indices $tag] {
+		lappend labels [$t row label $r]
+	    }
+	    lappend result $labels
+	}
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {{b d f} {b r7}}}
+
+test datatable.624 {row delete @tag} {
+    list [catch {
+	set t [MakeTaggedTable]
+	$t row delete @x
+	set result [list [$t row names] [$t row tag indices x] \
+			[$t row tag names x]]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {{a c e} {} x}}
+
+if {![catch {package require blt_datatable_sqlite}]} {
+
+proc MakeSqliteTable {} {
+    set t [blt::datatable create]
+    $t column create -label i -type long
+    $t column create -label d -type double
+    $t column create -label s -type string
+    for {set r 0} {$r < 7} {incr r} {
+	$t set $r i [expr {$r * 10}] $r d [expr {$r + 0.5}] $r s s$r
+    }
+    $t unset 3 s
+    return $t
+}
+
+test datatable.625 {export/import sqlite -batchsize -rowlabels} {
+    list [catch {
+	set t [MakeSqliteTable]
+	set file [file join [pwd] datatable625.db]
+	$t export sqlite -file $file -table t1 -batchsize 3 -rowlabels
+	set t2 [blt::datatable create]
+	$t2 import sqlite -file $file -query "SELECT * FROM t1" -batchsize 4
+	set result [list [$t2 numrows] [$t2 column names]]
+	foreach c {i d s} {
+	    lappend result [$t2 column type $c]
+	}
+	lappend result [$t2 row values 3] [$t2 row values @end]
+	blt::datatable destroy $t $t2
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {7 {_rowId i d s} long double string {r4 30 3.5 {}} {r7 60 6.5 s6}}}
+
+test datatable.626 {import sqlite over existing rows} {
+    list [catch {
+	set t [MakeSqliteTable]
+	set file [file join [pwd] datatable626.db]
+	$t export sqlite -file $file -table t1 -transaction no \
+	    -pragma {synchronous=OFF} -columns {i s}
+	set t2 [blt::datatable create]
+	$t2 row extend 2
+	$t2 import sqlite -file $file -query "SELECT * FROM t1 WHERE i > 20" \
+	    -batchsize 100
+	set result [list [$t2 numrows] [$t2 column values i]]
+	blt::datatable destroy $t $t2
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {4 {30 40 50 60}}}
+
+test datatable.627 {export sqlite -pragma badPragma} {
+    list [catch {
+	set t [MakeSqliteTable]
+	set file [file join [pwd] datatable627.db]
+	set result [list [catch {
+	    $t export sqlite -file $file -pragma {{synchronous = = 1}}
+	} msg] $msg]
+	blt::datatable destroy $t
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {1 {error in statement "PRAGMA synchronous = = 1;": near "=": syntax error}}}
+
+}
+
+if {![catch {package require blt_datatable_arrow}]} {
+
+proc MakeArrowTable {} {
+    set t [blt::datatable create]
+    $t column create -label d -type double
+    $t column create -label n -type int64
+    $t column create -label s -type string
+    $t column create -label b -type boolean
+    $t column create -label tm -type time
+    $t column create -label x -type blob
+    $t row extend 3
+    $t set 0 d 1.5 0 n 10 0 s hello 0 b 1 0 tm "2015-01-02 03:04:05.25"
+    $t set 1 d -2.25 1 s "" 1 b 0
+    $t set 2 n -7 2 s "w\u00f6rld" 2 tm "1970-01-01"
+    $t column packed d 1
+    $t column packed n 1
+    return $t
+}
+
+test datatable.628 {export/import arrow -data} {
+    list [catch {
+	set t [MakeArrowTable]
+	set t2 [blt::datatable create]
+	$t2 import arrow -data [$t export arrow]
+	set result [list [$t2 numrows] [$t2 column names]]
+	foreach c [$t2 column names] {
+	    lappend result [$t2 column type $c]
+	}
+	foreach r {0 1 2} {
+	    lappend result [$t2 row values $r]
+	}
+	blt::datatable destroy $t $t2
+	set result
+    } msg] $msg
+} [list 0 [list 3 {d n s b tm x} double int64 string boolean time blob \
+	       {1.5 10 hello 1 1420167845.25 {}} {-2.25 {} {} 0 {} {}} \
+	       [list {} -7 "w\u00f6rld" {} 0.0 {}]]]
+
+test datatable.629 {export arrow -file -batchsize -columns -rows} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label i -type long
+	$t column create -label s -type string
+	for {set r 0} {$r < 10} {incr r} {
+	    $t set $r i [expr {$r * $r}] $r s s$r
+	}
+	$t unset 4 i
+	set file [file join [pwd] datatable629.arrow]
+	$t export arrow -file $file -batchsize 3 -rows {1 2 3 4 5 6 7} \
+	    -columns i
+	set t2 [blt::datatable create]
+	$t2 import arrow -file $file
+	set result [list [$t2 numrows] [$t2 column names] \
+			[$t2 column type i] [$t2 column values i]]
+	blt::datatable destroy $t $t2
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {7 i int64 {1 4 9 {} 25 36 49}}}
+
+test datatable.630 {import arrow packs numeric columns} {
+    list [catch {
+	set t [MakeArrowTable]
+	set data [$t export arrow -columns {d n}]
+	set t2 [blt::datatable create]
+	$t2 import arrow -data $data
+	set result [list [$t2 numrows] [$t2 column packed 0] \
+			[$t2 column packed 1] [$t2 column values 1]]
+	blt::datatable destroy $t $t2
+	set result
+    } msg] $msg
+} {0 {3 1 1 {10 {} -7}}}
+
+test datatable.631 {import arrow -data badData} {
+    list [catch {
+	set t [MakeArrowTable]
+	set data [$t export arrow]
+	set t2 [blt::datatable create]
+	set result [list [catch {
+	    $t2 import arrow -data [string range $data 0 end-1]
+	} msg] $msg]
+	lappend result [catch {$t2 import arrow -data "ARROW"} msg] $msg
+	blt::datatable destroy $t $t2
+	set result
+    } msg] $msg
+} {0 {1 {bad arrow file: missing trailer} 1 {bad arrow data: message is truncated}}}
+
+test datatable.632 {import arrow -file @channel} {
+    list [catch {
+	set t [MakeArrowTable]
+	set file [file join [pwd] datatable632.arrow]
+	set f [open $file w]
+	$t export arrow -file @$f -columns {s x}
+	close $f
+	set f [open $file r]
+	set t2 [blt::datatable create]
+	$t2 import arrow -file @$f
+	close $f
+	set result [list [$t2 numrows] [$t2 column values s]]
+	blt::datatable destroy $t $t2
+	file delete $file
+	set result
+    } msg] $msg
+} [list 0 [list 3 [list hello {} "w\u00f6rld"]]]
+
+}
+
+if {![catch {package require blt_datatable_txt}]} {
+
+proc TxtRows { t } {
+    set rows {}
+    foreach r [$t row indices @all] {
+	lappend rows [$t row values $r]
+    }
+    return $rows
+}
+
+test datatable.633 {import txt -data (quotes, escapes, comments)} {
+    list [catch {
+	set t [blt::datatable create]
+	$t import txt -data "  a   b\n\n# comment\nc \"d e\" f\ng\\ h \"i\nj\"\n"
+	set result [list [$t numcolumns] [TxtRows $t]]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {3 {{a b {}} {c {d e} f} {{g h} {i
+j} {}}}}}
+
+test datatable.634 {import txt -widths} {
+    list [catch {
+	set t [blt::datatable create]
+	$t import txt -widths {4 8 5} \
+	    -data "1   alpha     2.5\n22  b\u00f6ta    10\n\n333 gamma w \"x\"  7extra\n"
+	set result [list [$t numcolumns] [TxtRows $t]]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} [list 0 [list 3 [list {1 alpha 2.5} "22 b\u00f6ta 10" {333 {gamma w} {"x"}}]]]
+
+test datatable.635 {import txt -widths 0} {
+    list [catch {
+	set t [blt::datatable create]
+	$t import txt -widths {4 0} -data "abc\n"
+    } msg] $msg
+} {1 {bad column width "0": must be positive}}
+
+test datatable.636 {import txt -infertypes -maxrows} {
+    list [catch {
+	set t [blt::datatable create]
+	$t import txt -infertypes -maxrows 2 -data "1 2.5 x\n3 4 y\n5 6 z\n"
+	set result [list [$t numrows] [$t column type 0] [$t column type 1] \
+			[$t column type 2] [$t column values 1]]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {2 long double string {2.5 4.0}}}
+
+test datatable.637 {import txt -file -threads} {
+    list [catch {
+	set file [file join [pwd] datatable637.txt]
+	set f [open $file w]
+	for { set i 0 } { $i < 20000 } { incr i } {
+	    puts $f "$i \"row $i\" [expr $i * 2]"
+	}
+	close $f
+	set t1 [blt::datatable create]
+	set t2 [blt::datatable create]
+	$t1 import txt -file $file -threads 1
+	$t2 import txt -file $file -threads 4
+	set result [list [$t1 numrows] [$t1 row values 19999] \
+			[expr {[TxtRows $t1] eq [TxtRows $t2]}]]
+	blt::datatable destroy $t1 $t2
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {20000 {19999 {row 19999} 39998} 1}}
+
+}
+
+proc FollowWrite { file mode data } {
+    set f [open $file $mode]
+    fconfigure $f -translation binary
+    puts -nonewline $f $data
+    close $f
+}
+
+test datatable.638 {import csv -follow} {
+    list [catch {
+	set file [file join [pwd] datatable638.csv]
+	set t [blt::datatable create]
+	FollowWrite $file w "1,a\n2,b\n3,"
+	$t import csv -file $file -follow
+	set result [list [$t numrows]]
+	FollowWrite $file a "c\n4,d\n"
+	$t import csv -file $file -follow
+	$t import csv -file $file -follow
+	lappend result [$t numrows] [$t column values 1]
+	blt::datatable destroy $t
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {2 4 {a b c d}}}
+
+test datatable.639 {import csv -follow (open quoted field)} {
+    list [catch {
+	set file [file join [pwd] datatable639.csv]
+	set t [blt::datatable create]
+	FollowWrite $file w "1,\"x\ny"
+	$t import csv -file $file -follow
+	set result [list [$t numrows]]
+	FollowWrite $file a "z\"\n"
+	$t import csv -file $file -follow
+	lappend result [$t numrows] [$t get 0 1]
+	blt::datatable destroy $t
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {0 1 {x
+yz}}}
+
+test datatable.640 {import csv -follow (truncated file)} {
+    list [catch {
+	set file [file join [pwd] datatable640.csv]
+	set t [blt::datatable create]
+	FollowWrite $file w "1,a\n2,b\n"
+	$t import csv -file $file -follow
+	FollowWrite $file w "3,c\n"
+	$t import csv -file $file -follow
+	set result [$t column values 1]
+	blt::datatable destroy $t
+	file delete $file
+	set result
+    } msg] $msg
+} {0 {a b c}}
+
+test datatable.641 {import csv -follow -data} {
+    list [catch {
+	set t [blt::datatable create]
+	set result [catch {$t import csv -data "1,a\n" -follow} msg]
+	blt::datatable destroy $t
+	list $result $msg
+    } msg] $msg
+} {0 {1 {can't use -follow with -data switch.}}}
+
+test datatable.642 {import csv -follow defers watch events} {
+    list [catch {
+	set file [file join [pwd] datatable642.csv]
+	set t [blt::datatable create]
+	FollowWrite $file w "1,a\n"
+	$t import csv -file $file -follow
+	set ::followLog {}
+	proc FollowWatch { args } {
+	    lappend ::followLog [$::t numrows]
+	}
+	set id [$t watch row @all -create FollowWatch]
+	FollowWrite $file a "2,b\n3,c\n"
+	$t import csv -file $file -follow
+	$t watch delete $id
+	blt::datatable destroy $t
+	file delete $file
+	set ::followLog
+    } msg] $msg
+} {0 {3 3}}
+
+test datatable.643 {find compiled on encoded column keeps it encoded} {
+    list [catch {
+	set t [MakeEncodedTable]
+	set result [list [$t find {$s == "apple"}] \
+			[$t find {$s > "fig" && $n < 6} -emptyvalue ""] \
+			[$t column encoded s]]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {{1 3} 0 1}}
+
+test datatable.644 {index ordered with NaN values} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label price -type double
+	$t row extend 7
+	$t column values price {5.5 NaN 3.25 9.0 NaN 3.25 7.0}
+	$t index create price -type ordered
+	set out {}
+	lappend out [$t index range price -min 3 -max 7]
+	lappend out [$t index lookup price 3.25]
+	lappend out [$t index lookup price 9.0]
+	$t set 3 price NaN
+	lappend out [$t index range price -min 6]
+	lappend out [$t index range price]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{2 5 0 6} {2 5} 3 6 {2 5 0 6 1 3 4}}}
+
+test datatable.645 {find falls back to TCL for uncompilable expressions} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label s -type string
+	$t row extend 2
+	$t column values s {a b}
+	set out [list [$t find 1] [$t find {$s eq "a"}] [$t find {$s ne "a"}] \
+		     [$t find {$s == "a" && [string length $s] == 1}]]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {{0 1} 0 1 0}}
+
+test datatable.646 {"c" abbreviates create, "co" configure} {
+    list [catch {
+	set t [blt::datatable c]
+	set out [list [blt::datatable exists $t] \
+		     [catch {blt::datatable co -threads}]]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {1 0}}
+
+test datatable.647 {dump and append keep a column packed} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 2
+	$t set 0 x 2 1 x 1.5
+	$t column packed x 1
+	set out [string match "*d 0 0 2.0*" [$t dump]]
+	lappend out [$t column packed x]
+	$t append 0 x 5
+	lappend out [$t get 0 x] [$t column packed x]
+	lappend out [catch {$t append 1 x abc}] [$t get 1 x]
+	blt::datatable destroy $t
+	set out
+    } msg] $msg
+} {0 {1 1 2.05 1 1 1.5}}
+
+test datatable.648 {packed column spanning chunks stays bound} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 70000
+	$t column packed x 1
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	$t set 65535 x 1.5 65536 x 2.5
+	set out [list [::bindVec length] [::bindVec range 65535 65537]]
+	set ::bindVec(65537) 4.5
+	update
+	lappend out [$t get 65537 x] [$t limits x]
+	$t row extend 70000
+	$t set 139999 x -1
+	update
+	lappend out [::bindVec length] [::bindVec range end end] [$t limits x]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set out
+    } msg] $msg
+} {0 {70000 {1.5 2.5 NaN} 4.5 {1.5 4.5} 140000 -1.0 {-1.0 4.5}}}
+
+test datatable.649 {dump -binary and restore packed column spanning chunks} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 70000
+	$t set 0 x 1.0 65535 x 2.0 65536 x 3.0 69999 x 4.0
+	$t dump -binary -file tmpchunks.snap
+	set t2 [blt::datatable create]
+	$t2 restore -file tmpchunks.snap
+	set out [list [$t2 column packed x] [$t2 get 65535 x] \
+		     [$t2 get 65536 x] [$t2 get 69999 x] [$t2 limits x]]
+	$t2 row extend 10
+	$t2 set 65536 x 5.0 70009 x 6.0
+	lappend out [$t2 get 65536 x] [$t2 get 70009 x] [$t get 65536 x]
+	blt::datatable destroy $t $t2
+	file delete tmpchunks.snap
+	set out
+    } msg] $msg
+} {0 {1 2.0 3.0 4.0 {1.0 4.0} 5.0 6.0 3.0}}
+
+test datatable.650 {column bind append seen by the vector, not undone} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 3
+	$t set 0 x 1.0 1 x 2.0
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	update
+	set dump [$t dump]
+	$t append 0 x 5
+	set out [list [::bindVec range 0 end]]
+	set ::bindVec(1) 9
+	update
+	lappend out [$t get 0 x] [$t get 1 x] [$t column packed x]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set out
+    } msg] $msg
+} {0 {{1.05 2.0 NaN} 1.05 9.0 1}}
+
+test datatable.651 {column bind keeps the column packed} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t row extend 3
+	$t set 0 x 10.0 1 x 9.0 2 x 2.5
+	blt::vector create ::bindVec
+	$t column bind x ::bindVec
+	set out {}
+	lappend out [catch {$t column packed x 0} msg] $msg
+	lappend out [catch {$t index create x} msg] $msg
+	lappend out [catch {$t column type x string} msg] $msg
+	lappend out [$t sort -columns x -ascii -values]
+	lappend out [$t column packed x]
+	$t set 2 x 7.5
+	update
+	lappend out [::bindVec range 0 end]
+	blt::datatable destroy $t
+	blt::vector destroy ::bindVec
+	set out
+    } msg] $msg
+} {0 {1 {can't unpack column "x": column is bound to vector "::bindVec"} 1 {can't index column "x": column is bound to vector "::bindVec"} 1 {can't change the type of column "x": column is bound to vector "::bindVec"} {10.0 2.5 9.0} 1 {10.0 9.0 7.5}}}
+
+test datatable.652 {snapshots share chunks until written} {
+    list [catch {
+	set t [blt::datatable create]
+	$t column create -label x -type double
+	$t column create -label name -type string
+	$t row extend 70000
+	$t set 0 x 1.0 0 name a 65536 x 2.0 65536 name b
+	$t column packed x 1
+	set s1 [$t snapshot]
+	$t set 65536 x 3.0 65536 name c
+	set s2 [$t snapshot]
+	$t set 0 x 4.0 0 name d
+	$t row extend 10
+	$t set 70009 x 5.0 70009 name e
+	set out {}
+	foreach table [list $s1 $s2 $t] {
+	    lappend out [$table get 0 x] [$table get 0 name] \
+		[$table get 65536 x] [$table get 65536 name]
+	}
+	blt::datatable destroy $s1
+	$t set 65536 x 6.0
+	lappend out [$s2 get 65536 x] [$t get 65536 x] [$t get 70009 name]
+	blt::datatable destroy $t $s2
+	set out
+    } msg] $msg
+} {0 {1.0 a 2.0 b 1.0 a 3.0 c 4.0 d 3.0 c 3.0 6.0 e}}
+
+test datatable.653 {column encoded find compares codes} {
+    list [catch {
+	set t [MakeEncodedTable]
+	set result [list [$t find {$s == "apple"}] \
+			[$t find {$s != "kiwi"} -emptyvalue ""] \
+			[$t find {$s == "kiwi"}] \
+			[$t find {$s < "apple"} -emptyvalue ""] \
+			[$t find {$s >= "figs"}] \
+			[$t find {$s <= "pea"} -emptyvalue ""] \
+			[$t get 2 s]]
+	lappend result [$t column encoded s]
+	blt::datatable destroy $t
+	set result
+    } msg] $msg
+} {0 {{1 3} {0 1 2 3 4 5} {} {2 4} 0 {1 2 3 4 5} Pear 1}}
+
 #----------------------
 
 foreach table [blt::datatable names] {
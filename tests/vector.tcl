@@ -80,7 +80,10 @@ The following switches are available:
    -command command
    -watchunset bool
    -flush bool
-   -length length}}
+   -length length
+   -mmap fileName
+   -format float64|float32|int16
+   -offset numBytes}}
 
 
 test vector.15 {vector names} {
@@ -149,7 +152,7 @@ test vector.27 {myVec} {
   myVec fft vecName ?switches?
   myVec frequency vecName numBins
   myVec indices what
-  myVec inversefft vecName vecName
+  myVec inversefft srcImag destReal destImag ?switches?
   myVec length ?newSize?
   myVec limits 
   myVec linspace first last ?numSteps?
@@ -192,7 +195,7 @@ test vector.28 {myVec badOp} {
   myVec fft vecName ?switches?
   myVec frequency vecName numBins
   myVec indices what
-  myVec inversefft vecName vecName
+  myVec inversefft srcImag destReal destImag ?switches?
   myVec length ?newSize?
   myVec limits 
   myVec linspace first last ?numSteps?
@@ -1102,5 +1105,293 @@ test vector.237 {sum} {
 } {0 10.0}
 
 
+test vector.238 {expr reuses compiled expression after values change} {
+    list [catch {
+	blt::vector create myVec10
+	myVec10 set { 1 2 3 }
+	set expr {myVec10 * 2 + 1}
+	set a [blt::vector expr $expr]
+	myVec10 set { 4 5 6 7 }
+	set b [blt::vector expr $expr]
+	list $a $b
+    } msg] $msg
+} {0 {{3.0 5.0 7.0} {9.0 11.0 13.0 15.0}}}
+
+test vector.239 {expr scalar <= vector} {
+    list [catch {
+	myVec10 set { 1 2 3 }
+	blt::vector expr {2 <= myVec10}
+    } msg] $msg
+} {0 {0.0 1.0 1.0}}
+
+test vector.240 {expr scalar >= vector} {
+    list [catch {
+	blt::vector expr {2 >= myVec10}
+    } msg] $msg
+} {0 {1.0 1.0 0.0}}
+
+test vector.241 {myVec10 expr referencing itself} {
+    list [catch {
+	myVec10 set { 1 2 3 }
+	myVec10 expr {myVec10 * myVec10 + myVec10}
+	myVec10 values
+    } msg] $msg
+} {0 {2.0 6.0 12.0}}
+
+test vector.242 {expr shift} {
+    list [catch {
+	myVec10 set { 1 2 3 4 }
+	list [blt::vector expr {myVec10 << 1}] [blt::vector expr {myVec10 >> 1}]
+    } msg] $msg
+} {0 {{2.0 3.0 4.0 1.0} {4.0 1.0 2.0 3.0}}}
+
+test vector.243 {expr shift by vector} {
+    list [catch {
+	myVec10 set { 1 2 3 4 }
+	blt::vector expr {myVec10 << myVec10}
+    } msg] $msg
+} {1 {second shift operand must be scalar}}
+
+test vector.244 {expr with variable substitution} {
+    list [catch {
+	myVec10 set { 1 2 3 }
+	set out {}
+	foreach k { 1 2 } {
+	    lappend out [blt::vector expr {myVec10 * $k}]
+	}
+	set out
+    } msg] $msg
+} {0 {{1.0 2.0 3.0} {2.0 4.0 6.0}}}
+
+test vector.245 {expr after vector is recreated} {
+    list [catch {
+	set expr {sum(myVec10)}
+	myVec10 set { 1 2 3 }
+	set a [blt::vector expr $expr]
+	blt::vector destroy myVec10
+	blt::vector create myVec10
+	myVec10 set { 10 20 }
+	list $a [blt::vector expr $expr]
+    } msg] $msg
+} {0 {6.0 30.0}}
+
+test vector.246 {expr different lengths} {
+    list [catch {
+	blt::vector create myVec11
+	myVec11 set { 1 2 3 }
+	blt::vector expr {myVec10 + myVec11}
+    } msg] $msg
+} {1 {vectors are different lengths}}
+
+test vector.247 {myVec11 stats} {
+    list [catch {
+	myVec11 set { 1 2 3 4 10 }
+	myVec11 stats
+    } msg] $msg
+} {0 {count 5 sum 20.0 mean 3.3333333333333335 min 1.0 max 10.0 var 13.055555555555554 sdev 3.6132472314464663 adev 2.2666666666666666 skew 1.321535769663165 kurtosis -0.6434730647351747 q1 2.5 median 3.0 q3 7.0}}
+
+test vector.248 {myVec11 stats (empty points)} {
+    list [catch {
+	myVec11 length 0
+	myVec11 length 3
+	myVec11 stats
+    } msg] $msg
+} {0 {count 0 sum 0.0 mean NaN min NaN max NaN var 0.0 sdev 0.0 adev 0.0 skew 0.0 kurtosis 0.0 q1 NaN median NaN q3 NaN}}
+
+test vector.249 {myVec11 stats badArg} {
+    list [catch {myVec11 stats badArg} msg] $msg
+} {1 {wrong # args: should be "myVec11 stats "}}
+
+test vector.250 {quartiles of unsorted values} {
+    list [catch {
+	myVec11 set { 9 1 8 2 7 3 6 4 5 0 19 11 18 12 17 13 16 14 15 10 }
+	list [blt::vector expr q1(myVec11)] [blt::vector expr median(myVec11)] \
+	    [blt::vector expr q3(myVec11)]
+    } msg] $msg
+} {0 {4.0 9.5 14.0}}
+
+test vector.251 {median of range} {
+    list [catch {
+	blt::vector expr median(myVec11(0:4))
+    } msg] $msg
+} {0 7.0}
+
+proc RoundValues { vec } {
+    set list {}
+    foreach x [$vec values] {
+	lappend list [expr {round($x * 1e6) / 1e6}]
+    }
+    return $list
+}
+
+test vector.252 {fft plan create} {
+    list [catch {
+	blt::fft plan create -length 48000
+    } msg] $msg
+} {0 fft0}
+
+test vector.253 {fft plan info} {
+    list [catch {
+	blt::fft plan info fft0
+    } msg] $msg
+} {0 {length 48000 type real algorithm mixedradix radices {4 4 4 3 5 5 5}}}
+
+test vector.254 {fft plan info (bluestein)} {
+    list [catch {
+	blt::fft plan create myPlan -length 17 -complex
+	blt::fft plan info myPlan
+    } msg] $msg
+} {0 {length 17 type complex algorithm bluestein radices {4 4 4}}}
+
+test vector.255 {fft plan create (no length)} {
+    list [catch {blt::fft plan create} msg] $msg
+} {1 {missing -length switch}}
+
+test vector.256 {fft forward} {
+    list [catch {
+	blt::fft plan create fft4 -length 4
+	foreach name { fftA fftB fftRe1 fftIm1 fftRe2 fftIm2 } {
+	    blt::vector create $name
+	}
+	fftA set { 1 2 3 4 }
+	fftB set { 1 0 0 0 }
+	blt::fft forward fft4 {fftA fftB} {fftRe1 fftRe2} {fftIm1 fftIm2}
+	list [RoundValues fftRe1] [RoundValues fftIm1] \
+	    [RoundValues fftRe2] [RoundValues fftIm2]
+    } msg] $msg
+} {0 {{10.0 -2.0 -2.0} {0.0 2.0 0.0} {1.0 1.0 1.0} {0.0 0.0 0.0}}}
+
+test vector.257 {fft inverse} {
+    list [catch {
+	blt::fft inverse fft4 {fftRe1 fftRe2} {fftIm1 fftIm2} {fftA fftB}
+	list [RoundValues fftA] [RoundValues fftB]
+    } msg] $msg
+} {0 {{1.0 2.0 3.0 4.0} {1.0 0.0 0.0 0.0}}}
+
+test vector.258 {fft forward (wrong length)} {
+    list [catch {
+	fftA set { 1 2 3 }
+	blt::fft forward fft4 fftA fftRe1 fftIm1
+    } msg] $msg
+} {1 {vector "::fftA" must have 4 points}}
+
+test vector.259 {fft plan names} {
+    list [catch {
+	blt::fft plan delete fft0 myPlan
+	blt::fft plan names fft*
+    } msg] $msg
+} {0 fft4}
+
+test vector.260 {fftA fft -nopad} {
+    list [catch {
+	fftA set { 1 2 3 4 5 6 }
+	fftA fft fftRe1 -imagpart fftIm1 -nopad
+	list [RoundValues fftRe1] [RoundValues fftIm1]
+    } msg] $msg
+} {0 {{21.0 -3.0 -3.0 -3.0} {0.0 5.196152 1.732051 0.0}}}
+
+test vector.261 {fftA fft (padded)} {
+    list [catch {
+	fftA fft fftRe1
+	fftRe1 length
+    } msg] $msg
+} {0 5}
+
+test vector.262 {bigVec length (past huge threshold)} {
+    list [catch {
+	blt::vector create bigVec
+	bigVec length 5000000
+	bigVec value set end 1.0
+	bigVec append 2.0 3.0
+	list [bigVec length] [bigVec range 4999999 5000001]
+    } msg] $msg
+} {0 {5000002 {1.0 2.0 3.0}}}
+
+test vector.263 {bigVec length (shrink from huge)} {
+    list [catch {
+	bigVec length 3
+	bigVec set { 4 5 6 }
+	list [bigVec length] [bigVec values]
+    } msg] $msg
+} {0 {3 {4.0 5.0 6.0}}}
+
+test vector.264 {bigVec binread (negative count)} {
+    list [catch {
+	set f [open [info script] r]
+	catch { bigVec binread $f -1 } msg
+	close $f
+	set msg
+    } msg] $msg
+} {0 {invalid count "-1": can't be negative}}
+
+set f [open "mmapFile" "w"]
+fconfigure $f -translation binary
+puts -nonewline $f [binary format x8d5 { 1.5 2.5 3.5 4.5 5.5 }]
+puts -nonewline $f [binary format f3s4 { 0.5 1.5 2.5 } { 10 -20 30 -40 }]
+close $f
+
+test vector.265 {vector create -mmap (float64)} {
+    list [catch {
+	blt::vector create mmapVec -mmap mmapFile -offset 8 -length 5
+	mmapVec values
+    } msg] $msg
+} {0 {1.5 2.5 3.5 4.5 5.5}}
+
+test vector.266 {mmapVec set (not written to file)} {
+    list [catch {
+	mmapVec value set 0 100.0
+	blt::vector create mmapVec2 -mmap mmapFile -offset 8 -length 5
+	list [mmapVec value get 0] [mmapVec2 value get 0]
+    } msg] $msg
+} {0 {100.0 1.5}}
+
+test vector.267 {vector create -mmap -format float32} {
+    list [catch {
+	blt::vector create mmapVec3 -mmap mmapFile -offset 48 -length 3 \
+	    -format float32
+	mmapVec3 values
+    } msg] $msg
+} {0 {0.5 1.5 2.5}}
+
+test vector.268 {vector create -mmap -format int16} {
+    list [catch {
+	blt::vector create mmapVec4 -mmap mmapFile -offset 60 -format int16
+	mmapVec4 append 50
+	mmapVec4 values
+    } msg] $msg
+} {0 {10.0 -20.0 30.0 -40.0 50.0}}
+
+test vector.269 {vector create -mmap -format badFormat} {
+    list [catch {
+	blt::vector create mmapVec5 -mmap mmapFile -format int8
+    } msg] $msg
+} {1 {unknown format "int8": should be float64, float32, or int16}}
+
+test vector.270 {vector create -mmap (too many values)} {
+    list [catch {
+	blt::vector create mmapVec5 -mmap mmapFile -offset 60 -length 10 \
+	    -format int16
+    } msg] $msg
+} {1 {"mmapFile" has only 4 values after offset 60}}
+
+test vector.271 {vector create -mmap (bad offset)} {
+    list [catch {
+	blt::vector create mmapVec5 -mmap mmapFile -offset 1000
+    } msg] $msg
+} {1 {offset 1000 is beyond the end of "mmapFile"}}
+
+test vector.272 {vector create -mmap (no vector left behind)} {
+    list [catch {
+	blt::vector names *mmapVec5*
+    } msg] $msg
+} {0 {}}
+
+test vector.273 {blt::vector destroy mmapVec...} {
+    list [catch {
+	blt::vector destroy mmapVec mmapVec2 mmapVec3 mmapVec4
+	file delete mmapFile
+    } msg] $msg
+} {0 {}}
+
 exit 0
 